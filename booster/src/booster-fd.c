@@ -28,6 +28,7 @@
 #include <string.h>
 
 #include <assert.h>
+#include <sched.h>
 
 extern fd_t *
 fd_ref (fd_t *fd);
@@ -54,34 +55,63 @@ gf_roundup_power_of_two (uint nr)
         return result;
 }
 
-#define BOOSTER_NFDBITS (sizeof (unsigned long))
+#define BOOSTER_NFDBITS (8 * sizeof (unsigned long))
 
 #define BOOSTER_FDMASK(d)             (1UL << ((d) % BOOSTER_NFDBITS))
-#define BOOSTER_FDELT(d)              (d / BOOSTER_NFDBITS)
-#define BOOSTER_FD_SET(set, d)        (set->fd_bits[BOOSTER_FDELT(d)] |= BOOSTER_FDMASK(d))
-#define BOOSTER_FD_CLR(set, d)        (set->fd_bits[BOOSTER_FDELT(d)] &= ~BOOSTER_FDMASK(d))
+#define BOOSTER_FDELT(d)              ((d) / BOOSTER_NFDBITS)
+#define BOOSTER_FD_SET(set, d)        (__sync_fetch_and_or (&set->fd_bits[BOOSTER_FDELT(d)], BOOSTER_FDMASK(d)))
+#define BOOSTER_FD_CLR(set, d)        (__sync_fetch_and_and (&set->fd_bits[BOOSTER_FDELT(d)], ~BOOSTER_FDMASK(d)))
 #define BOOSTER_FD_ISSET(set, d)      (set->fd_bits[BOOSTER_FDELT(d)] & BOOSTER_FDMASK(d))
 
+#define BOOSTER_FDSET_BYTES(nr)       ((((nr) + BOOSTER_NFDBITS - 1) / BOOSTER_NFDBITS) * sizeof (unsigned long))
+
+/* the generation a lookup may use, or NULL if the table is gone */
+static inline booster_fdarray_t *
+booster_fdarray_get (booster_fdtable_t *fdtable)
+{
+        booster_fdarray_t *array = NULL;
+
+        /* no barrier needed here: everything read through @array
+           depends on this load, and expand fills a generation in before
+           publishing it */
+        array = *(booster_fdarray_t * volatile *)&fdtable->array;
+
+        return array;
+}
+
 inline int
 booster_get_close_on_exec (booster_fdtable_t *fdtable, int fd)
 {
-        return BOOSTER_FD_ISSET(fdtable->close_on_exec, fd);
+        booster_fdarray_t *array = booster_fdarray_get (fdtable);
+
+        if (!array || fd < 0 || !(fd < array->max_fds))
+                return 0;
+
+        return BOOSTER_FD_ISSET(array->close_on_exec, fd) ? 1 : 0;
 }
 
 inline void
 booster_set_close_on_exec (booster_fdtable_t *fdtable, int fd)
 {
-        BOOSTER_FD_SET(fdtable->close_on_exec, fd);
+        booster_fdarray_t *array = NULL;
+
+        LOCK (&fdtable->lock);
+        {
+                array = fdtable->array;
+                if (array && fd >= 0 && fd < array->max_fds)
+                        BOOSTER_FD_SET(array->close_on_exec, fd);
+        }
+        UNLOCK (&fdtable->lock);
 }
 
+/* Assumes fdtable->lock is held */
 int
 booster_fdtable_expand (booster_fdtable_t *fdtable, uint nr)
 {
-        fd_t    **oldfds = NULL, **tmp = NULL;
-        uint    oldmax_fds = -1;
-        uint    cpy = 0;
-        int32_t ret = -1, bytes = 0;
-        booster_fd_set_t *oldclose_on_exec = NULL;
+        booster_fdarray_t *oldarray = NULL, *array = NULL;
+        uint    oldmax_fds = 0;
+        size_t  setbytes = 0;
+        int32_t ret = -1;
 
         if (fdtable == NULL || nr < 0) {
                 gf_log ("booster-fd", GF_LOG_ERROR, "Invalid argument");
@@ -94,53 +124,48 @@ booster_fdtable_expand (booster_fdtable_t *fdtable, uint nr)
         nr = gf_roundup_power_of_two (nr + 1);
         nr *= (1024 / sizeof (fd_t *));
 
-        oldfds = fdtable->fds;
-        oldmax_fds = fdtable->max_fds;
-        oldclose_on_exec = fdtable->close_on_exec;
+        oldarray = fdtable->array;
+        if (oldarray)
+                oldmax_fds = oldarray->max_fds;
 
-        fdtable->fds = CALLOC (nr, sizeof (fd_t *));
-        if (fdtable->fds == NULL) {
+        /* the generation, its fds, both bitmaps and the reader counts
+           in one chunk */
+        setbytes = BOOSTER_FDSET_BYTES (nr);
+        array = CALLOC (1, sizeof (*array) + nr * sizeof (fd_t *)
+                        + 2 * setbytes + nr * sizeof (int));
+        if (array == NULL) {
                 gf_log ("booster-fd", GF_LOG_ERROR, "Memory allocation failed");
-                fdtable->fds = oldfds;
-                oldfds = NULL;
                 ret = -1;
                 goto out;
         }
 
-        fdtable->max_fds = nr;
-
-        if (oldfds) {
-                cpy = oldmax_fds * sizeof (fd_t *);
-                memcpy (fdtable->fds, oldfds, cpy);
+        array->max_fds = nr;
+        array->fds = (fd_t **)(array + 1);
+        array->gluster_fds = (booster_fd_set_t *)(array->fds + nr);
+        array->close_on_exec = (booster_fd_set_t *)
+                ((char *)array->gluster_fds + setbytes);
+        array->readers = (int *)((char *)array->close_on_exec + setbytes);
+
+        if (oldarray) {
+                memcpy (array->fds, oldarray->fds,
+                        oldmax_fds * sizeof (fd_t *));
+                memcpy (array->gluster_fds, oldarray->gluster_fds,
+                        BOOSTER_FDSET_BYTES (oldmax_fds));
+                memcpy (array->close_on_exec, oldarray->close_on_exec,
+                        BOOSTER_FDSET_BYTES (oldmax_fds));
         }
+        /* readers of the old generation stay counted there */
+        array->retired = oldarray;
 
-        /* nr will be either less than 8 or a multiple of 8 */
-        bytes = nr/8;
-        bytes = bytes ? bytes : 1;
-        fdtable->close_on_exec = CALLOC (bytes, 1);
-        if (fdtable->close_on_exec == NULL) {
-                gf_log ("booster-fd", GF_LOG_ERROR, "Memory allocation "
-                        "failed");
-                tmp = fdtable->fds;
-                fdtable->fds = oldfds;
-                oldfds = tmp;
-                ret = -1;
-                goto out;
-        }
+        /* contents before the pointer, see booster_fdarray_get */
+        __sync_synchronize ();
+        fdtable->array = array;
 
-        if (oldclose_on_exec != NULL) {
-                bytes = oldmax_fds/8;
-                cpy = bytes ? bytes : 1;
-                memcpy (fdtable->close_on_exec, oldclose_on_exec, cpy);
-        }
         gf_log ("booster-fd", GF_LOG_TRACE, "FD-table expanded: Old: %d,New: %d"
                 , oldmax_fds, nr);
         ret = 0;
 
 out:
-        FREE (oldfds);
-        FREE (oldclose_on_exec);
-
         return ret;
 }
 
@@ -164,6 +189,7 @@ booster_fdtable_alloc (void)
         if (ret == -1) {
                 gf_log ("booster-fd", GF_LOG_ERROR, "FD-table allocation "
                         "failed");
+                LOCK_DESTROY (&fdtable->lock);
                 FREE (fdtable);
                 fdtable = NULL;
         }
@@ -172,44 +198,25 @@ out:
         return fdtable;
 }
 
-fd_t **
-__booster_fdtable_get_all_fds (booster_fdtable_t *fdtable, uint *count)
+/* wait until no lookup can still be taking a ref on slot @fd, cleared in
+   @array before this call. A lookup counts itself in the generation it
+   found the slot through, which is @array or one retired by it. */
+static void
+booster_fdtable_sync_slot (booster_fdarray_t *array, int fd)
 {
-        fd_t **fds = NULL;
-
-        if (count == NULL)
-                goto out;
-
-        fds = fdtable->fds;
-        fdtable->fds = calloc (fdtable->max_fds, sizeof (fd_t *));
-        *count = fdtable->max_fds;
-
-out:
-        return fds;
-}
-
-fd_t **
-booster_fdtable_get_all_fds (booster_fdtable_t *fdtable, uint *count)
-{
-        fd_t **fds = NULL;
-        if (!fdtable)
-                return NULL;
-
-        LOCK (&fdtable->lock);
-        {
-                fds = __booster_fdtable_get_all_fds (fdtable, count);
+        __sync_synchronize ();
+        /* generations only grow, the older ones end below @fd */
+        for (; array && (fd < array->max_fds); array = array->retired) {
+                while (*(volatile int *)&array->readers[fd])
+                        sched_yield ();
         }
-        UNLOCK (&fdtable->lock);
-
-        return fds;
 }
 
 void
 booster_fdtable_destroy (booster_fdtable_t *fdtable)
 {
+        booster_fdarray_t       *array = NULL, *retired = NULL;
         fd_t                    *fd = NULL;
-        fd_t                    **fds = NULL;
-        uint                    fd_count = 0;
         int                     i = 0;
 
         if (!fdtable)
@@ -217,21 +224,26 @@ booster_fdtable_destroy (booster_fdtable_t *fdtable)
 
         LOCK (&fdtable->lock);
         {
-                fds = __booster_fdtable_get_all_fds (fdtable, &fd_count);
-                FREE (fdtable->fds);
+                array = fdtable->array;
+                fdtable->array = NULL;
         }
         UNLOCK (&fdtable->lock);
 
-        if (!fds)
-                goto free_table;
-        
-        for (i = 0; i < fd_count; i++) {
-                fd = fds[i];
-                if (fd != NULL)
-                        fd_unref (fd);
+        if (array) {
+                for (i = 0; i < array->max_fds; i++) {
+                        booster_fdtable_sync_slot (array, i);
+                        fd = array->fds[i];
+                        if (fd != NULL)
+                                fd_unref (fd);
+                }
+        }
+
+        while (array) {
+                retired = array->retired;
+                FREE (array);
+                array = retired;
         }
-        FREE (fds);
-free_table:
+
         LOCK_DESTROY (&fdtable->lock);
         FREE (fdtable);
 }
@@ -239,6 +251,7 @@ free_table:
 int
 booster_fd_unused_get (booster_fdtable_t *fdtable, fd_t *fdptr, int fd)
 {
+        booster_fdarray_t *array = NULL;
         int ret = -1;
         int error = 0;
 
@@ -251,21 +264,24 @@ booster_fd_unused_get (booster_fdtable_t *fdtable, fd_t *fdptr, int fd)
         gf_log ("booster-fd", GF_LOG_TRACE, "Requested fd: %d", fd);
         LOCK (&fdtable->lock);
         {
-                while (fdtable->max_fds < fd) {
+                while (!(fd < fdtable->array->max_fds)) {
                         error = 0;
-                        error = booster_fdtable_expand (fdtable,
-                                                        fdtable->max_fds + 1);
+                        error = booster_fdtable_expand (fdtable, fd);
                         if (error) {
                                 gf_log ("booster-fd", GF_LOG_ERROR,
                                         "Cannot expand fdtable:%s",
-                                        strerror (error));
+                                        strerror (errno));
                                 goto err;
                         }
                 }
 
-                if (!fdtable->fds[fd]) {
-                        fdtable->fds[fd] = fdptr;
+                array = fdtable->array;
+                if (!array->fds[fd]) {
                         fd_ref (fdptr);
+                        array->fds[fd] = fdptr;
+                        /* slot before bit, a lookup seeing the bit
+                           finds the fd */
+                        BOOSTER_FD_SET (array->gluster_fds, fd);
                         ret = fd;
                 } else
                         gf_log ("booster-fd", GF_LOG_ERROR, "Cannot allocate fd"
@@ -280,33 +296,44 @@ err:
 void
 booster_fd_put (booster_fdtable_t *fdtable, int fd)
 {
+        booster_fdarray_t *array = NULL;
         fd_t *fdptr = NULL;
+
         if (fdtable == NULL || fd < 0) {
                 gf_log ("booster-fd", GF_LOG_ERROR, "invalid argument");
                 return;
         }
 
         gf_log ("booster-fd", GF_LOG_TRACE, "FD put: %d", fd);
-        if (!(fd < fdtable->max_fds)) {
-                gf_log ("booster-fd", GF_LOG_ERROR, "FD not in booster fd"
-                        " table");
-                return;
-        }
 
         LOCK (&fdtable->lock);
         {
-                fdptr = fdtable->fds[fd];
-                fdtable->fds[fd] = NULL;
+                array = fdtable->array;
+                if (array && fd < array->max_fds) {
+                        fdptr = array->fds[fd];
+                        BOOSTER_FD_CLR (array->gluster_fds, fd);
+                        BOOSTER_FD_CLR (array->close_on_exec, fd);
+                        array->fds[fd] = NULL;
+                }
         }
         UNLOCK (&fdtable->lock);
 
-        if (fdptr)
+        if (fdptr) {
+                /* a lookup may have read the slot just before it was
+                   cleared and not have its ref yet */
+                booster_fdtable_sync_slot (array, fd);
                 fd_unref (fdptr);
+        }
 }
 
+/* Called for every intercepted call on an fd, most of them sockets,
+ * pipes and local files. Those are answered from the bitmap without
+ * locking or writing anything shared.
+ */
 fd_t *
 booster_fdptr_get (booster_fdtable_t *fdtable, int fd)
 {
+        booster_fdarray_t *array = NULL, *current = NULL;
         fd_t *fdptr = NULL;
 
         if (fdtable == NULL || fd < 0) {
@@ -315,21 +342,23 @@ booster_fdptr_get (booster_fdtable_t *fdtable, int fd)
                 return NULL;
         }
 
-        gf_log ("booster-fd", GF_LOG_TRACE, "FD ptr request: %d", fd);
-        if (!(fd < fdtable->max_fds)) {
-                gf_log ("booster-fd", GF_LOG_ERROR, "FD not in booster fd"
-                        " table");
-                errno = EINVAL;
+        array = booster_fdarray_get (fdtable);
+        if (!array || !(fd < array->max_fds)
+            || !BOOSTER_FD_ISSET (array->gluster_fds, fd))
                 return NULL;
-        }
 
-        LOCK (&fdtable->lock);
+        __sync_add_and_fetch (&array->readers[fd], 1);
         {
-                fdptr = fdtable->fds[fd];
-                if (fdptr)
-                        fd_ref (fdptr);
+                /* the slot of the current generation, an older one may
+                   still hold an fd closed since */
+                current = booster_fdarray_get (fdtable);
+                if (current && fd < current->max_fds) {
+                        fdptr = *(fd_t * volatile *)&current->fds[fd];
+                        if (fdptr)
+                                fd_ref (fdptr);
+                }
         }
-        UNLOCK (&fdtable->lock);
+        __sync_sub_and_fetch (&array->readers[fd], 1);
 
         return fdptr;
 }
@@ -47,12 +47,29 @@ struct _booster_fd_set {
 };
 typedef struct _booster_fd_set booster_fd_set_t;
 
+/* One generation of the fd table. Lookups find it through
+ * fdtable->array without taking any lock. Expanding the table publishes
+ * a copy and keeps the old generation on the retired list until the
+ * table is destroyed, so a lookup still using it reads stale but valid
+ * memory. readers[fd] counts the lookups of fd that found the slot
+ * through this generation and may not have their ref on it yet;
+ * booster_fd_put waits for them on the slot it clears only.
+ */
+struct _booster_fdarray {
+        struct _booster_fdarray *retired;
+        unsigned int             max_fds;
+        fd_t                   **fds;
+        booster_fd_set_t        *gluster_fds;   /* bit set while fds[fd]
+                                                   is */
+        booster_fd_set_t        *close_on_exec;
+        int                     *readers;
+};
+typedef struct _booster_fdarray booster_fdarray_t;
+
 struct _booster_fdtable {
-        booster_fd_set_t *close_on_exec;
-        int               refcount;
-        unsigned int      max_fds;
-        gf_lock_t         lock;
-        fd_t            **fds;
+        booster_fdarray_t *array;
+        int                refcount;
+        gf_lock_t          lock;        /* serializes updates */
 };
 typedef struct _booster_fdtable booster_fdtable_t;
 
@@ -0,0 +1,281 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/* booster-bm: each thread issues cheap syscalls on an fd booster does
+   not own (pread of /dev/zero, fstat or lseek of a local file) in a
+   loop, for thread counts 1 to --threads doubling each time, and prints
+   the nanoseconds per call. Run it once natively and once with
+   LD_PRELOAD=glusterfs-booster.so: the difference is what booster's
+   interposition costs every call of the application. */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <errno.h>
+#include <string.h>
+#include <pthread.h>
+#include <argp.h>
+
+enum bb_ops {
+	BB_OP_PREAD,
+	BB_OP_FSTAT,
+	BB_OP_LSEEK,
+};
+
+struct bb_config {
+	char file[PATH_MAX];
+	int threads;
+	long count;
+	enum bb_ops op;
+};
+static struct bb_config bb_config;
+
+struct bb_thread {
+	pthread_t thread;
+	int fd;
+	uint64_t nsecs;
+	int error;
+};
+
+enum bb_keys {
+	BB_THREADS_KEY = 1,
+	BB_COUNT_KEY,
+	BB_OP_KEY,
+};
+
+static pthread_barrier_t bb_barrier;
+
+
+static int
+bb_parse_long (const char *arg, const char *what, long *val)
+{
+	char *tmp = NULL;
+	long  v = 0;
+
+	v = strtol (arg, &tmp, 10);
+	if ((v == LONG_MAX) || (v == LONG_MIN) || (tmp && *tmp) || (v <= 0)) {
+		fprintf (stderr, "invalid argument for %s (%s)\n", what, arg);
+		return -1;
+	}
+
+	*val = v;
+	return 0;
+}
+
+
+static error_t
+bb_parse_opts (int key, char *arg, struct argp_state *_state)
+{
+	long val = 0;
+
+	switch (key) {
+	case 'f':
+		if (strlen (arg) >= sizeof (bb_config.file)) {
+			fprintf (stderr, "file name too long (%s)\n", arg);
+			return -1;
+		}
+		strcpy (bb_config.file, arg);
+		break;
+	case BB_THREADS_KEY:
+		if (bb_parse_long (arg, "threads", &val))
+			return -1;
+		bb_config.threads = val;
+		break;
+	case BB_COUNT_KEY:
+		if (bb_parse_long (arg, "count", &val))
+			return -1;
+		bb_config.count = val;
+		break;
+	case BB_OP_KEY:
+		if (!strcmp (arg, "pread"))
+			bb_config.op = BB_OP_PREAD;
+		else if (!strcmp (arg, "fstat"))
+			bb_config.op = BB_OP_FSTAT;
+		else if (!strcmp (arg, "lseek"))
+			bb_config.op = BB_OP_LSEEK;
+		else {
+			fprintf (stderr, "unknown op (%s)\n", arg);
+			return -1;
+		}
+		break;
+	}
+
+	return 0;
+}
+
+static struct argp_option bb_options[] = {
+	{"file", 'f', "FILE", 0, "local file to work on "
+	 "(defaults to /dev/zero)"},
+	{"threads", BB_THREADS_KEY, "N", 0, "most threads (defaults to 64)"},
+	{"count", BB_COUNT_KEY, "N", 0, "calls per thread "
+	 "(defaults to 1000000)"},
+	{"op", BB_OP_KEY, "OP", 0, "pread, fstat or lseek (defaults to pread)"},
+	{0, 0, 0, 0, 0}
+};
+
+static struct argp argp = {
+	bb_options,
+	bb_parse_opts,
+	"",
+	"booster-bm - cost of a syscall on a non-gluster fd per thread count"
+};
+
+
+static uint64_t
+bb_nsec_now (void)
+{
+	struct timespec ts = {0, };
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+static void *
+bb_worker (void *data)
+{
+	struct bb_thread *t = data;
+	struct stat       stbuf;
+	char              buf[8];
+	uint64_t          start = 0;
+	long              i = 0;
+	int               ret = 0;
+
+	pthread_barrier_wait (&bb_barrier);
+
+	start = bb_nsec_now ();
+	for (i = 0; i < bb_config.count; i++) {
+		switch (bb_config.op) {
+		case BB_OP_PREAD:
+			ret = pread (t->fd, buf, sizeof (buf), 0);
+			break;
+		case BB_OP_FSTAT:
+			ret = fstat (t->fd, &stbuf);
+			break;
+		case BB_OP_LSEEK:
+			ret = lseek (t->fd, 0, SEEK_SET);
+			break;
+		}
+		if (ret == -1) {
+			t->error = errno;
+			break;
+		}
+	}
+	t->nsecs = bb_nsec_now () - start;
+
+	return NULL;
+}
+
+
+static int
+bb_run (int nthreads)
+{
+	struct bb_thread *threads = NULL;
+	uint64_t          nsecs = 0;
+	int               ret = -1;
+	int               i = 0;
+
+	threads = calloc (nthreads, sizeof (*threads));
+	if (!threads) {
+		fprintf (stderr, "out of memory\n");
+		return -1;
+	}
+
+	/* one fd each, as separate connections or files would be */
+	for (i = 0; i < nthreads; i++) {
+		threads[i].fd = open (bb_config.file, O_RDONLY);
+		if (threads[i].fd == -1) {
+			fprintf (stderr, "cannot open %s (%s)\n",
+				 bb_config.file, strerror (errno));
+			nthreads = i;
+			goto out;
+		}
+	}
+
+	pthread_barrier_init (&bb_barrier, NULL, nthreads);
+	for (i = 0; i < nthreads; i++) {
+		if (pthread_create (&threads[i].thread, NULL, bb_worker,
+				    &threads[i])) {
+			/* the barrier would never open */
+			fprintf (stderr, "cannot start thread %d\n", i);
+			exit (1);
+		}
+	}
+
+	ret = 0;
+	for (i = 0; i < nthreads; i++) {
+		pthread_join (threads[i].thread, NULL);
+		if (threads[i].error) {
+			fprintf (stderr, "thread %d failed (%s)\n", i,
+				 strerror (threads[i].error));
+			ret = -1;
+		}
+		nsecs += threads[i].nsecs;
+	}
+	pthread_barrier_destroy (&bb_barrier);
+
+	if (ret == 0)
+		printf ("%-8d %14.1f %16.0f\n", nthreads,
+			(double)nsecs / nthreads / bb_config.count,
+			nthreads * bb_config.count
+			/ ((double)nsecs / nthreads / 1000000000));
+out:
+	for (i = 0; i < nthreads; i++)
+		close (threads[i].fd);
+	free (threads);
+
+	return ret;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+	int ret = -1;
+	int n = 0;
+
+	strcpy (bb_config.file, "/dev/zero");
+	bb_config.threads = 64;
+	bb_config.count = 1000000;
+	bb_config.op = BB_OP_PREAD;
+
+	ret = argp_parse (&argp, argc, argv, 0, 0, NULL);
+	if (ret != 0) {
+		fprintf (stderr, "%s: argp_parse() failed\n", argv[0]);
+		return 1;
+	}
+
+	printf ("%-8s %14s %16s\n", "threads", "ns per call", "calls/s");
+
+	for (n = 1; n <= bb_config.threads; n *= 2) {
+		if (bb_run (n))
+			return 1;
+		if ((n < bb_config.threads) && (n * 2 > bb_config.threads))
+			n = bb_config.threads / 2;
+	}
+
+	return 0;
+}
@@ -0,0 +1,303 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/* falloc-bm: reserve, zero or punch a large range of a file (a VM image,
+   say) with fallocate(2) and compare it with writing the zeros by hand.
+   Run it on a mount to time the FALLOCATE/DISCARD/ZEROFILL fops end to
+   end, and on the brick filesystem for the baseline. */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <errno.h>
+#include <string.h>
+#include <argp.h>
+
+#ifndef UNIX_PATH_MAX
+#define UNIX_PATH_MAX 108
+#endif
+
+#ifndef FALLOC_FL_KEEP_SIZE
+#define FALLOC_FL_KEEP_SIZE     0x01
+#endif
+#ifndef FALLOC_FL_PUNCH_HOLE
+#define FALLOC_FL_PUNCH_HOLE    0x02
+#endif
+#ifndef FALLOC_FL_ZERO_RANGE
+#define FALLOC_FL_ZERO_RANGE    0x10
+#endif
+
+enum fb_mode {
+	FB_FALLOCATE = 0,       /* extend the file, blocks reserved */
+	FB_KEEP_SIZE,           /* reserve blocks past EOF */
+	FB_ZEROFILL,            /* zero an existing range */
+	FB_PUNCH,               /* deallocate a range */
+	FB_WRITE_ZEROS,         /* baseline: pwrite() zeros */
+};
+
+static const char *fb_mode_names[] = {
+	"fallocate", "keep-size", "zerofill", "punch", "write-zeros", NULL
+};
+
+struct fb_config {
+	char path[UNIX_PATH_MAX];
+	off_t size;
+	off_t chunk;           /* bytes per call, 0 = the whole range at once */
+	enum fb_mode mode;
+	int keep;              /* don't unlink the file at exit */
+};
+static struct fb_config fb_config;
+
+enum fb_keys {
+	FB_SIZE_KEY = 1,
+	FB_CHUNK_KEY,
+	FB_KEEP_KEY,
+};
+
+
+static int
+fb_parse_long (const char *arg, const char *what, long *val)
+{
+	char *tmp = NULL;
+	long  v = 0;
+
+	v = strtol (arg, &tmp, 10);
+	if ((v == LONG_MAX) || (v == LONG_MIN) || (tmp && *tmp) || (v < 0)) {
+		fprintf (stderr, "invalid argument for %s (%s)\n", what, arg);
+		return -1;
+	}
+
+	*val = v;
+	return 0;
+}
+
+
+static error_t
+fb_parse_opts (int key, char *arg, struct argp_state *_state)
+{
+	long val = 0;
+	int  i = 0;
+
+	switch (key) {
+	case 'f':
+		if (strlen (arg) >= UNIX_PATH_MAX) {
+			fprintf (stderr, "file name too long (%s)\n", arg);
+			return -1;
+		}
+		strcpy (fb_config.path, arg);
+		break;
+	case 'm':
+		for (i = 0; fb_mode_names[i]; i++)
+			if (!strcmp (arg, fb_mode_names[i]))
+				break;
+		if (!fb_mode_names[i]) {
+			fprintf (stderr, "unknown mode (%s)\n", arg);
+			return -1;
+		}
+		fb_config.mode = i;
+		break;
+	case FB_SIZE_KEY:
+		if (fb_parse_long (arg, "size (GB)", &val))
+			return -1;
+		fb_config.size = (off_t)val * 1073741824;
+		break;
+	case FB_CHUNK_KEY:
+		if (fb_parse_long (arg, "chunk (MB)", &val))
+			return -1;
+		fb_config.chunk = (off_t)val * 1048576;
+		break;
+	case FB_KEEP_KEY:
+		fb_config.keep = 1;
+		break;
+	case ARGP_KEY_END:
+		if (_state->argc == 1)
+			argp_usage (_state);
+		break;
+	}
+
+	return 0;
+}
+
+static struct argp_option fb_options[] = {
+	{"file", 'f', "FILE", 0, "file to allocate (created if needed)"},
+	{"mode", 'm', "MODE", 0,
+	 "fallocate, keep-size, zerofill, punch or write-zeros "
+	 "(defaults to fallocate)"},
+	{"size", FB_SIZE_KEY, "GB", 0, "range size in GB (defaults to 100)"},
+	{"chunk", FB_CHUNK_KEY, "MB", 0,
+	 "bytes per call in MB (defaults to 0, the whole range in one call; "
+	 "write-zeros always uses 1MB writes)"},
+	{"keep", FB_KEEP_KEY, 0, 0, "leave the file behind"},
+	{0, 0, 0, 0, 0}
+};
+
+static struct argp argp = {
+	fb_options,
+	fb_parse_opts,
+	"",
+	"falloc-bm - time fallocate(2) against writing zeros"
+};
+
+
+static uint64_t
+fb_usec_now (void)
+{
+	struct timeval tv = {0, };
+
+	gettimeofday (&tv, NULL);
+	return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+static int
+fb_write_zeros (int fd, off_t size)
+{
+	char  *buf = NULL;
+	off_t  off = 0;
+	size_t len = 0;
+	int    ret = -1;
+
+	buf = calloc (1, 1048576);
+	if (!buf)
+		return -1;
+
+	for (off = 0; off < size; off += len) {
+		len = ((size - off) < 1048576) ? (size - off) : 1048576;
+		if (pwrite (fd, buf, len, off) != len)
+			goto out;
+	}
+	ret = 0;
+out:
+	free (buf);
+	return ret;
+}
+
+
+static int
+fb_fallocate (int fd, int mode, off_t size)
+{
+	off_t off = 0;
+	off_t len = 0;
+
+	if (!fb_config.chunk)
+		return fallocate (fd, mode, 0, size);
+
+	for (off = 0; off < size; off += len) {
+		len = ((size - off) < fb_config.chunk) ? (size - off)
+			: fb_config.chunk;
+		if (fallocate (fd, mode, off, len) == -1)
+			return -1;
+	}
+
+	return 0;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+	struct stat st = {0, };
+	uint64_t    start = 0;
+	double      secs = 0;
+	int         fd = -1;
+	int         ret = -1;
+
+	fb_config.size = 100 * 1073741824LL;
+
+	ret = argp_parse (&argp, argc, argv, 0, 0, NULL);
+	if (ret != 0) {
+		fprintf (stderr, "%s: argp_parse() failed\n", argv[0]);
+		return 1;
+	}
+
+	if (!strlen (fb_config.path) || !fb_config.size) {
+		fprintf (stderr, "%s: configuration validation failed\n",
+			 argv[0]);
+		return 1;
+	}
+
+	fd = open (fb_config.path, O_RDWR | O_CREAT, 0644);
+	if (fd == -1) {
+		fprintf (stderr, "cannot open %s (%s)\n", fb_config.path,
+			 strerror (errno));
+		return 1;
+	}
+
+	/* zerofill and punch work on allocated data, lay it out first */
+	if ((fb_config.mode == FB_ZEROFILL) || (fb_config.mode == FB_PUNCH)) {
+		if (fallocate (fd, 0, 0, fb_config.size) == -1) {
+			fprintf (stderr, "cannot preallocate %s (%s)\n",
+				 fb_config.path, strerror (errno));
+			goto out;
+		}
+		fsync (fd);
+	}
+
+	start = fb_usec_now ();
+	switch (fb_config.mode) {
+	case FB_FALLOCATE:
+		ret = fb_fallocate (fd, 0, fb_config.size);
+		break;
+	case FB_KEEP_SIZE:
+		ret = fb_fallocate (fd, FALLOC_FL_KEEP_SIZE, fb_config.size);
+		break;
+	case FB_ZEROFILL:
+		ret = fb_fallocate (fd, FALLOC_FL_ZERO_RANGE, fb_config.size);
+		break;
+	case FB_PUNCH:
+		ret = fb_fallocate (fd, FALLOC_FL_PUNCH_HOLE |
+				    FALLOC_FL_KEEP_SIZE, fb_config.size);
+		break;
+	case FB_WRITE_ZEROS:
+		ret = fb_write_zeros (fd, fb_config.size);
+		break;
+	}
+	if (ret == 0)
+		ret = fsync (fd);
+	secs = (fb_usec_now () - start) / 1000000.0;
+
+	if (ret == -1) {
+		fprintf (stderr, "%s failed (%s)\n",
+			 fb_mode_names[fb_config.mode], strerror (errno));
+		goto out;
+	}
+
+	fstat (fd, &st);
+	printf ("%s %.1f GB: %.3f secs, %.2f GB/s, size %"PRId64
+		" blocks %"PRId64" (%.1f GB allocated)\n",
+		fb_mode_names[fb_config.mode],
+		fb_config.size / 1073741824.0, secs,
+		fb_config.size / 1073741824.0 / (secs ? secs : 1e-6),
+		(int64_t)st.st_size, (int64_t)st.st_blocks,
+		st.st_blocks * 512.0 / 1073741824);
+	ret = 0;
+out:
+	close (fd);
+	if (!fb_config.keep)
+		unlink (fb_config.path);
+
+	return ret ? 1 : 0;
+}
@@ -0,0 +1,353 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/* glfs-handle-bm: for each directory depth from 1 to --depth, create a
+   file at the end of a chain of directories and stat and open/close it
+   --count times through libglusterfsclient, once by absolute path and
+   once through objects (glusterfs_lookup_at() from the parent directory
+   object, glusterfs_object_stat(), glusterfs_open_at()). Prints
+   operations per second for both against the depth. */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <errno.h>
+#include <string.h>
+#include <argp.h>
+#include <libglusterfsclient.h>
+
+struct hb_config {
+	char volfile[PATH_MAX];
+	char volume[256];
+	char dir[PATH_MAX];
+	int depth;
+	int count;
+	int timeout;                    /* lookup/stat cache, seconds */
+};
+static struct hb_config hb_config;
+
+enum hb_keys {
+	HB_VOLUME_KEY = 1,
+	HB_DIR_KEY,
+	HB_DEPTH_KEY,
+	HB_COUNT_KEY,
+	HB_TIMEOUT_KEY,
+};
+
+
+static int
+hb_parse_long (const char *arg, const char *what, long min, long *val)
+{
+	char *tmp = NULL;
+	long  v = 0;
+
+	v = strtol (arg, &tmp, 10);
+	if ((v == LONG_MAX) || (v == LONG_MIN) || (tmp && *tmp) || (v < min)) {
+		fprintf (stderr, "invalid argument for %s (%s)\n", what, arg);
+		return -1;
+	}
+
+	*val = v;
+	return 0;
+}
+
+
+static int
+hb_copy_arg (char *dst, size_t size, const char *arg, const char *what)
+{
+	if (strlen (arg) >= size) {
+		fprintf (stderr, "%s too long (%s)\n", what, arg);
+		return -1;
+	}
+	strcpy (dst, arg);
+	return 0;
+}
+
+
+static error_t
+hb_parse_opts (int key, char *arg, struct argp_state *_state)
+{
+	long val = 0;
+
+	switch (key) {
+	case 'f':
+		return hb_copy_arg (hb_config.volfile,
+				    sizeof (hb_config.volfile), arg, "volfile");
+	case HB_VOLUME_KEY:
+		return hb_copy_arg (hb_config.volume,
+				    sizeof (hb_config.volume), arg, "volume");
+	case HB_DIR_KEY:
+		if (arg[0] != '/') {
+			fprintf (stderr, "directory must be absolute (%s)\n",
+				 arg);
+			return -1;
+		}
+		return hb_copy_arg (hb_config.dir, sizeof (hb_config.dir) / 2,
+				    arg, "directory");
+	case HB_DEPTH_KEY:
+		if (hb_parse_long (arg, "depth", 1, &val))
+			return -1;
+		hb_config.depth = val;
+		break;
+	case HB_COUNT_KEY:
+		if (hb_parse_long (arg, "count", 1, &val))
+			return -1;
+		hb_config.count = val;
+		break;
+	case HB_TIMEOUT_KEY:
+		if (hb_parse_long (arg, "timeout", 0, &val))
+			return -1;
+		hb_config.timeout = val;
+		break;
+	case ARGP_KEY_END:
+		if (_state->argc == 1)
+			argp_usage (_state);
+		break;
+	}
+
+	return 0;
+}
+
+static struct argp_option hb_options[] = {
+	{"volfile", 'f', "VOLFILE", 0, "client volume file"},
+	{"volume", HB_VOLUME_KEY, "NAME", 0,
+	 "volume of the volfile to use (defaults to the top one)"},
+	{"dir", HB_DIR_KEY, "DIR", 0,
+	 "directory of the volume to work in (defaults to /)"},
+	{"depth", HB_DEPTH_KEY, "N", 0, "deepest directory chain "
+	 "(defaults to 16)"},
+	{"count", HB_COUNT_KEY, "N", 0, "operations per depth and mode "
+	 "(defaults to 10000)"},
+	{"timeout", HB_TIMEOUT_KEY, "SECS", 0, "lookup and stat cache "
+	 "timeout of the library (defaults to 0, every call goes out)"},
+	{0, 0, 0, 0, 0}
+};
+
+static struct argp argp = {
+	hb_options,
+	hb_parse_opts,
+	"",
+	"glfs-handle-bm - path based against object based calls by depth"
+};
+
+
+static uint64_t
+hb_usec_now (void)
+{
+	struct timeval tv = {0, };
+
+	gettimeofday (&tv, NULL);
+	return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+static double
+hb_rate (int ops, uint64_t start)
+{
+	uint64_t elapsed = hb_usec_now () - start;
+
+	return elapsed ? ops / (elapsed / 1000000.0) : 0.0;
+}
+
+
+static int
+hb_by_path (glusterfs_handle_t handle, const char *file, double *stat_rate,
+	    double *open_rate)
+{
+	struct stat      stbuf;
+	glusterfs_file_t fd = NULL;
+	uint64_t         start = 0;
+	int              i = 0;
+
+	start = hb_usec_now ();
+	for (i = 0; i < hb_config.count; i++)
+		if (glusterfs_glh_stat (handle, file, &stbuf) == -1)
+			return -1;
+	*stat_rate = hb_rate (hb_config.count, start);
+
+	start = hb_usec_now ();
+	for (i = 0; i < hb_config.count; i++) {
+		fd = glusterfs_glh_open (handle, file, O_RDONLY);
+		if (!fd)
+			return -1;
+		glusterfs_close (fd);
+	}
+	*open_rate = hb_rate (hb_config.count, start);
+
+	return 0;
+}
+
+
+static int
+hb_by_object (glusterfs_handle_t handle, glusterfs_object_t parent,
+	      double *stat_rate, double *open_rate)
+{
+	struct stat        stbuf;
+	glusterfs_object_t object = NULL;
+	glusterfs_file_t   fd = NULL;
+	uint64_t           start = 0;
+	int                ret = -1;
+	int                i = 0;
+
+	/* what an application walking a tree does: name lookup from the
+	   directory it already holds, then work on the object */
+	start = hb_usec_now ();
+	for (i = 0; i < hb_config.count; i++) {
+		object = glusterfs_lookup_at (handle, parent, "file", NULL);
+		if (!object)
+			return -1;
+		ret = glusterfs_object_stat (handle, object, &stbuf);
+		glusterfs_object_unref (object);
+		if (ret == -1)
+			return -1;
+	}
+	*stat_rate = hb_rate (hb_config.count, start);
+
+	object = glusterfs_lookup_at (handle, parent, "file", NULL);
+	if (!object)
+		return -1;
+
+	start = hb_usec_now ();
+	for (i = 0; i < hb_config.count; i++) {
+		fd = glusterfs_open_at (handle, object, O_RDONLY);
+		if (!fd)
+			break;
+		glusterfs_close (fd);
+	}
+	glusterfs_object_unref (object);
+	if (i < hb_config.count)
+		return -1;
+	*open_rate = hb_rate (hb_config.count, start);
+
+	return 0;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+	glusterfs_init_params_t ipars = {0, };
+	glusterfs_handle_t      handle = NULL;
+	glusterfs_object_t      parent = NULL;
+	glusterfs_file_t        fd = NULL;
+	char                    path[PATH_MAX] = {0, };
+	char                    file[PATH_MAX] = {0, };
+	size_t                  len = 0;
+	double                  rates[4] = {0, };
+	int                     depth = 0;
+	int                     ret = -1;
+
+	hb_config.depth = 16;
+	hb_config.count = 10000;
+	strcpy (hb_config.dir, "/");
+
+	ret = argp_parse (&argp, argc, argv, 0, 0, NULL);
+	if (ret != 0) {
+		fprintf (stderr, "%s: argp_parse() failed\n", argv[0]);
+		return 1;
+	}
+
+	if (!strlen (hb_config.volfile)) {
+		fprintf (stderr, "%s: configuration validation failed\n",
+			 argv[0]);
+		return 1;
+	}
+
+	ipars.specfile = hb_config.volfile;
+	ipars.volume_name = strlen (hb_config.volume) ? hb_config.volume : NULL;
+	ipars.logfile = "/dev/stderr";
+	ipars.loglevel = "error";
+	ipars.lookup_timeout = hb_config.timeout;
+	ipars.stat_timeout = hb_config.timeout;
+
+	handle = glusterfs_init (&ipars, getpid ());
+	if (!handle) {
+		fprintf (stderr, "%s: glusterfs_init() failed\n", argv[0]);
+		return 1;
+	}
+
+	len = strlen (hb_config.dir);
+	while (len > 1 && hb_config.dir[len - 1] == '/')
+		hb_config.dir[--len] = '\0';
+	strcpy (path, (len == 1) ? "" : hb_config.dir);
+
+	printf ("%-6s %14s %14s %14s %14s\n", "depth", "stat path/s",
+		"stat obj/s", "open path/s", "open obj/s");
+
+	ret = 0;
+	for (depth = 1; depth <= hb_config.depth; depth++) {
+		len = strlen (path);
+		if (len + 32 >= sizeof (path)) {
+			fprintf (stderr, "path too long at depth %d\n", depth);
+			ret = -1;
+			break;
+		}
+		snprintf (path + len, sizeof (path) - len, "/glfs-hbm.%d",
+			  depth);
+		if ((glusterfs_glh_mkdir (handle, path, 0755) == -1)
+		    && (errno != EEXIST)) {
+			fprintf (stderr, "cannot create %s (%s)\n", path,
+				 strerror (errno));
+			ret = -1;
+			break;
+		}
+
+		snprintf (file, sizeof (file), "%s/file", path);
+		fd = glusterfs_glh_open (handle, file, O_RDWR | O_CREAT, 0644);
+		if (!fd) {
+			fprintf (stderr, "cannot create %s (%s)\n", file,
+				 strerror (errno));
+			ret = -1;
+			break;
+		}
+		glusterfs_close (fd);
+
+		parent = glusterfs_glh_object (handle, path, NULL);
+		if (!parent) {
+			fprintf (stderr, "cannot get object of %s (%s)\n",
+				 path, strerror (errno));
+			ret = -1;
+			break;
+		}
+
+		ret = hb_by_path (handle, file, &rates[0], &rates[2]);
+		if (ret == 0)
+			ret = hb_by_object (handle, parent, &rates[1],
+					    &rates[3]);
+		glusterfs_object_unref (parent);
+		if (ret == -1) {
+			fprintf (stderr, "depth %d failed (%s)\n", depth,
+				 strerror (errno));
+			break;
+		}
+
+		printf ("%-6d %14.0f %14.0f %14.0f %14.0f\n", depth, rates[0],
+			rates[1], rates[2], rates[3]);
+	}
+
+	glusterfs_fini (handle);
+	return ret ? 1 : 0;
+}
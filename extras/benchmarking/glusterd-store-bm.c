@@ -0,0 +1,405 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/* glusterd-store-bm: lay out a glusterd working directory holding many
+   volumes (info, rbstate and brick files in the format glusterd-store.c
+   writes), then optionally start glusterd on it and report how long it
+   takes until it answers, i.e. how long glusterd_restore() takes.
+   --start is run with sh -c and killed at the end, --ready is run
+   every 10ms until it exits 0. */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <errno.h>
+#include <string.h>
+#include <signal.h>
+#include <argp.h>
+
+#define GB_MAX_CMD 1024
+
+struct gb_config {
+	char workdir[PATH_MAX];
+	char host[256];
+	int volumes;
+	int bricks;
+	int options;
+	char start[GB_MAX_CMD];
+	char ready[GB_MAX_CMD];
+	int timeout;                    /* seconds */
+};
+static struct gb_config gb_config;
+
+enum gb_keys {
+	GB_VOLUMES_KEY = 1,
+	GB_BRICKS_KEY,
+	GB_OPTIONS_KEY,
+	GB_HOST_KEY,
+	GB_START_KEY,
+	GB_READY_KEY,
+	GB_TIMEOUT_KEY,
+};
+
+/* volume set keys glusterd knows, written with their defaults */
+static const char *gb_options[] = {
+	"performance.cache-size=32MB",
+	"performance.write-behind-window-size=1MB",
+	"performance.io-thread-count=16",
+	"network.ping-timeout=42",
+	"auth.allow=*",
+	"nfs.disable=off",
+	"diagnostics.brick-log-level=INFO",
+	"diagnostics.client-log-level=INFO",
+	"performance.quick-read=on",
+	"performance.stat-prefetch=on",
+	NULL
+};
+
+
+static int
+gb_parse_long (const char *arg, const char *what, long min, long *val)
+{
+	char *tmp = NULL;
+	long  v = 0;
+
+	v = strtol (arg, &tmp, 10);
+	if ((v == LONG_MAX) || (v == LONG_MIN) || (tmp && *tmp) || (v < min)) {
+		fprintf (stderr, "invalid argument for %s (%s)\n", what, arg);
+		return -1;
+	}
+
+	*val = v;
+	return 0;
+}
+
+
+static int
+gb_copy_arg (char *dst, size_t size, const char *arg, const char *what)
+{
+	if (strlen (arg) >= size) {
+		fprintf (stderr, "%s too long (%s)\n", what, arg);
+		return -1;
+	}
+	strcpy (dst, arg);
+	return 0;
+}
+
+
+static error_t
+gb_parse_opts (int key, char *arg, struct argp_state *_state)
+{
+	long val = 0;
+
+	switch (key) {
+	case 'w':
+		return gb_copy_arg (gb_config.workdir,
+				    sizeof (gb_config.workdir), arg, "workdir");
+	case GB_VOLUMES_KEY:
+		if (gb_parse_long (arg, "volumes", 1, &val))
+			return -1;
+		gb_config.volumes = val;
+		break;
+	case GB_BRICKS_KEY:
+		if (gb_parse_long (arg, "bricks", 1, &val))
+			return -1;
+		gb_config.bricks = val;
+		break;
+	case GB_OPTIONS_KEY:
+		if (gb_parse_long (arg, "options", 0, &val))
+			return -1;
+		gb_config.options = val;
+		break;
+	case GB_HOST_KEY:
+		return gb_copy_arg (gb_config.host, sizeof (gb_config.host),
+				    arg, "host");
+	case GB_START_KEY:
+		return gb_copy_arg (gb_config.start, sizeof (gb_config.start),
+				    arg, "start command");
+	case GB_READY_KEY:
+		return gb_copy_arg (gb_config.ready, sizeof (gb_config.ready),
+				    arg, "ready command");
+	case GB_TIMEOUT_KEY:
+		if (gb_parse_long (arg, "timeout", 1, &val))
+			return -1;
+		gb_config.timeout = val;
+		break;
+	case ARGP_KEY_END:
+		if (_state->argc == 1)
+			argp_usage (_state);
+		break;
+	}
+
+	return 0;
+}
+
+static struct argp_option gb_options_argp[] = {
+	{"workdir", 'w', "DIR", 0, "glusterd working directory to populate "
+	 "(must not hold volumes yet)"},
+	{"volumes", GB_VOLUMES_KEY, "N", 0, "volumes (defaults to 1000)"},
+	{"bricks", GB_BRICKS_KEY, "N", 0, "bricks per volume (defaults to 4)"},
+	{"options", GB_OPTIONS_KEY, "N", 0,
+	 "volume set options per volume (defaults to 4, at most 10)"},
+	{"host", GB_HOST_KEY, "HOST", 0,
+	 "brick host, must be this machine (defaults to the hostname)"},
+	{"start", GB_START_KEY, "CMD", 0, "starts glusterd on the workdir"},
+	{"ready", GB_READY_KEY, "CMD", 0, "exits 0 once glusterd answers"},
+	{"timeout", GB_TIMEOUT_KEY, "SECS", 0,
+	 "give up on --ready after that long (defaults to 600)"},
+	{0, 0, 0, 0, 0}
+};
+
+static struct argp argp = {
+	gb_options_argp,
+	gb_parse_opts,
+	"",
+	"glusterd-store-bm - glusterd startup time with many volumes"
+};
+
+
+static uint64_t
+gb_usec_now (void)
+{
+	struct timeval tv = {0, };
+
+	gettimeofday (&tv, NULL);
+	return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+static int
+gb_mkdir (const char *path)
+{
+	if ((mkdir (path, 0755) == -1) && (errno != EEXIST)) {
+		fprintf (stderr, "cannot create %s (%s)\n", path,
+			 strerror (errno));
+		return -1;
+	}
+	return 0;
+}
+
+
+static FILE *
+gb_create (const char *path)
+{
+	FILE *fp = NULL;
+
+	fp = fopen (path, "w");
+	if (!fp)
+		fprintf (stderr, "cannot create %s (%s)\n", path,
+			 strerror (errno));
+	return fp;
+}
+
+
+static void
+gb_uuid (char *buf, size_t size)
+{
+	snprintf (buf, size, "%08lx-%04lx-4%03lx-8%03lx-%04lx%08lx",
+		  random (), random () & 0xffff, random () & 0xfff,
+		  random () & 0xfff, random () & 0xffff, random ());
+}
+
+
+static int
+gb_populate_volume (const char *voldir, int vol)
+{
+	char  path[PATH_MAX] = {0, };
+	char  brickpath[PATH_MAX] = {0, };
+	char  brickfname[PATH_MAX] = {0, };
+	char  uuid[64] = {0, };
+	char *ptr = NULL;
+	FILE *info = NULL;
+	FILE *fp = NULL;
+	int   i = 0;
+	int   ret = -1;
+
+	snprintf (path, sizeof (path), "%s/vol%d", voldir, vol);
+	if (gb_mkdir (path))
+		goto out;
+	snprintf (path, sizeof (path), "%s/vol%d/bricks", voldir, vol);
+	if (gb_mkdir (path))
+		goto out;
+
+	snprintf (path, sizeof (path), "%s/vol%d/info", voldir, vol);
+	info = gb_create (path);
+	if (!info)
+		goto out;
+
+	gb_uuid (uuid, sizeof (uuid));
+	fprintf (info, "type=0\ncount=%d\nstatus=0\nsub_count=0\n"
+		 "stripe_count=0\nversion=1\ntransport-type=0\n"
+		 "volume-id=%s\n", gb_config.bricks, uuid);
+	for (i = 0; i < gb_config.options && gb_options[i]; i++)
+		fprintf (info, "%s\n", gb_options[i]);
+
+	for (i = 0; i < gb_config.bricks; i++) {
+		snprintf (brickpath, sizeof (brickpath),
+			  "/export/vol%d/brick%d", vol, i);
+		snprintf (brickfname, sizeof (brickfname), "%s:%s",
+			  gb_config.host, brickpath);
+		for (ptr = strchr (brickfname, '/'); ptr;
+		     ptr = strchr (ptr, '/'))
+			*ptr = '-';
+		fprintf (info, "brick-%d=%s\n", i, brickfname);
+
+		snprintf (path, sizeof (path), "%s/vol%d/bricks/%s", voldir,
+			  vol, brickfname);
+		fp = gb_create (path);
+		if (!fp)
+			goto out;
+		fprintf (fp, "hostname=%s\npath=%s\nlisten-port=0\n"
+			 "rdma.listen-port=0\n", gb_config.host, brickpath);
+		fclose (fp);
+	}
+
+	snprintf (path, sizeof (path), "%s/vol%d/rbstate", voldir, vol);
+	fp = gb_create (path);
+	if (!fp)
+		goto out;
+	fprintf (fp, "rb_status=0\n");
+	fclose (fp);
+
+	ret = 0;
+out:
+	if (info)
+		fclose (info);
+
+	return ret;
+}
+
+
+static int
+gb_populate (void)
+{
+	char     voldir[PATH_MAX] = {0, };
+	uint64_t start = 0;
+	int      i = 0;
+
+	if (gb_mkdir (gb_config.workdir))
+		return -1;
+
+	snprintf (voldir, sizeof (voldir), "%s/peers", gb_config.workdir);
+	if (gb_mkdir (voldir))
+		return -1;
+
+	snprintf (voldir, sizeof (voldir), "%s/vols", gb_config.workdir);
+	if (gb_mkdir (voldir))
+		return -1;
+
+	start = gb_usec_now ();
+	for (i = 0; i < gb_config.volumes; i++)
+		if (gb_populate_volume (voldir, i))
+			return -1;
+
+	printf ("populated %d volumes x %d bricks, %d options each in %.2fs\n",
+		gb_config.volumes, gb_config.bricks, gb_config.options,
+		(gb_usec_now () - start) / 1000000.0);
+	return 0;
+}
+
+
+static int
+gb_time_startup (void)
+{
+	uint64_t start = 0;
+	uint64_t deadline = 0;
+	pid_t    pid = -1;
+	int      status = 0;
+	int      ret = -1;
+
+	start = gb_usec_now ();
+	deadline = start + (uint64_t)gb_config.timeout * 1000000;
+
+	pid = fork ();
+	if (pid == -1) {
+		fprintf (stderr, "fork failed (%s)\n", strerror (errno));
+		return -1;
+	}
+	if (pid == 0) {
+		setpgid (0, 0);
+		execl ("/bin/sh", "sh", "-c", gb_config.start, (char *)NULL);
+		_exit (127);
+	}
+
+	while (gb_usec_now () < deadline) {
+		status = system (gb_config.ready);
+		if ((status != -1) && WIFEXITED (status) &&
+		    (WEXITSTATUS (status) == 0)) {
+			ret = 0;
+			break;
+		}
+		usleep (10000);
+	}
+
+	if (ret == 0)
+		printf ("glusterd answered after %.2fs\n",
+			(gb_usec_now () - start) / 1000000.0);
+	else
+		fprintf (stderr, "glusterd did not answer within %ds\n",
+			 gb_config.timeout);
+
+	kill (-pid, SIGTERM);
+	waitpid (pid, NULL, 0);
+
+	return ret;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+	int ret = -1;
+
+	gb_config.volumes = 1000;
+	gb_config.bricks = 4;
+	gb_config.options = 4;
+	gb_config.timeout = 600;
+	gethostname (gb_config.host, sizeof (gb_config.host) - 1);
+
+	ret = argp_parse (&argp, argc, argv, 0, 0, NULL);
+	if (ret != 0) {
+		fprintf (stderr, "%s: argp_parse() failed\n", argv[0]);
+		return 1;
+	}
+
+	if (!strlen (gb_config.workdir) ||
+	    (!!strlen (gb_config.start) != !!strlen (gb_config.ready))) {
+		fprintf (stderr, "%s: configuration validation failed\n",
+			 argv[0]);
+		return 1;
+	}
+
+	srandom (getpid ());
+
+	if (gb_populate ())
+		return 1;
+
+	if (strlen (gb_config.start) && gb_time_startup ())
+		return 1;
+
+	return 0;
+}
@@ -0,0 +1,306 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/* inode-bm: hammer one inode table with inode_grep()/inode_find() and
+   ref/unref from several threads, the way the resolvers of a busy
+   brick do, and report lookups per second. Build it against an
+   installed libglusterfs:
+
+     gcc -o inode-bm inode-bm.c -I<glusterfs>/libglusterfs/src \
+         -I<glusterfs>/contrib/uuid \
+         -DHAVE_CONFIG_H -I<glusterfs> -lglusterfs -lpthread */
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <argp.h>
+
+#include "glusterfs.h"
+#include "globals.h"
+#include "xlator.h"
+#include "inode.h"
+
+struct ib_config {
+	long threads;
+	long inodes;
+	long runtime;          /* seconds */
+	long find_pct;         /* gfid lookups, the rest are name lookups */
+	int active;            /* keep a ref on every inode */
+	volatile int stop;
+	inode_table_t *table;
+	uuid_t *gfids;
+};
+static struct ib_config ib_config;
+
+struct ib_stats {
+	uint64_t ops;
+	uint64_t misses;
+};
+
+
+static int
+ib_parse_long (const char *arg, const char *what, long *val)
+{
+	char *tmp = NULL;
+	long  v = 0;
+
+	v = strtol (arg, &tmp, 10);
+	if ((v == LONG_MAX) || (v == LONG_MIN) || (tmp && *tmp) || (v < 0)) {
+		fprintf (stderr, "invalid argument for %s (%s)\n", what, arg);
+		return -1;
+	}
+
+	*val = v;
+	return 0;
+}
+
+
+static error_t
+ib_parse_opts (int key, char *arg, struct argp_state *_state)
+{
+	switch (key) {
+	case 't':
+		if (ib_parse_long (arg, "threads", &ib_config.threads))
+			return -1;
+		break;
+	case 'n':
+		if (ib_parse_long (arg, "inodes", &ib_config.inodes))
+			return -1;
+		break;
+	case 'r':
+		if (ib_parse_long (arg, "runtime", &ib_config.runtime))
+			return -1;
+		break;
+	case 'g':
+		if (ib_parse_long (arg, "gfid percentage", &ib_config.find_pct)
+		    || (ib_config.find_pct > 100))
+			return -1;
+		break;
+	case 'a':
+		ib_config.active = 1;
+		break;
+	}
+
+	return 0;
+}
+
+static struct argp_option ib_options[] = {
+	{"threads", 't', "COUNT", 0, "number of threads (defaults to 8)"},
+	{"inodes", 'n', "COUNT", 0,
+	 "inodes linked under the root (defaults to 100000)"},
+	{"runtime", 'r', "SECS", 0, "duration of the run (defaults to 10)"},
+	{"gfid-mix", 'g', "PERCENT", 0,
+	 "percentage of inode_find() lookups, the rest are inode_grep() "
+	 "(defaults to 50)"},
+	{"active", 'a', 0, 0,
+	 "keep every inode referenced, as with open fds, instead of "
+	 "leaving them on the lru list"},
+	{0, 0, 0, 0, 0}
+};
+
+static struct argp argp = {
+	ib_options,
+	ib_parse_opts,
+	"",
+	"inode-bm - concurrent lookups against one inode table"
+};
+
+
+static uint64_t
+ib_usec_now (void)
+{
+	struct timeval tv = {0, };
+
+	gettimeofday (&tv, NULL);
+	return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+static void *
+ib_worker (void *arg)
+{
+	struct ib_stats *stats = arg;
+	unsigned int     seed = 0;
+	inode_t         *inode = NULL;
+	char             name[32];
+	long             idx = 0;
+
+	seed = (unsigned int)(ib_usec_now () ^ (uintptr_t)stats);
+
+	while (!ib_config.stop) {
+		idx = rand_r (&seed) % ib_config.inodes;
+
+		if ((rand_r (&seed) % 100) < ib_config.find_pct) {
+			inode = inode_find (ib_config.table,
+					    ib_config.gfids[idx]);
+		} else {
+			snprintf (name, sizeof (name), "f%ld", idx);
+			inode = inode_grep (ib_config.table,
+					    ib_config.table->root, name);
+		}
+
+		if (inode) {
+			/* what a resolver does with the result */
+			inode_ref (inode);
+			inode_unref (inode);
+			inode_unref (inode);
+		} else {
+			stats->misses++;
+		}
+		stats->ops++;
+	}
+
+	return NULL;
+}
+
+
+static int
+ib_populate (void)
+{
+	struct iatt  iatt = {0, };
+	inode_t     *inode = NULL;
+	inode_t     *linked = NULL;
+	char         name[32];
+	long         i = 0;
+
+	ib_config.gfids = calloc (ib_config.inodes, sizeof (uuid_t));
+	if (!ib_config.gfids)
+		return -1;
+
+	for (i = 0; i < ib_config.inodes; i++) {
+		uuid_generate (ib_config.gfids[i]);
+		uuid_copy (iatt.ia_gfid, ib_config.gfids[i]);
+		iatt.ia_ino = i + 2;
+		iatt.ia_type = IA_IFREG;
+		snprintf (name, sizeof (name), "f%ld", i);
+
+		inode = inode_new (ib_config.table);
+		if (!inode)
+			return -1;
+
+		linked = inode_link (inode, ib_config.table->root, name,
+				     &iatt);
+		if (!linked)
+			return -1;
+
+		/* nlookup keeps it on the lru once unreferenced, like a
+		   looked up inode the kernel still remembers */
+		inode_lookup (linked);
+		if (!ib_config.active)
+			inode_unref (linked);
+		if (linked != inode)
+			inode_unref (inode);
+	}
+
+	return 0;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+	xlator_t          xl = {0, };
+	glusterfs_graph_t graph = {{0, }, };
+	struct ib_stats  *stats = NULL;
+	pthread_t        *threads = NULL;
+	uint64_t          start = 0;
+	uint64_t          ops = 0;
+	uint64_t          misses = 0;
+	double            secs = 0;
+	int               i = 0;
+	int               ret = -1;
+
+	ib_config.threads = 8;
+	ib_config.inodes = 100000;
+	ib_config.runtime = 10;
+	ib_config.find_pct = 50;
+
+	ret = argp_parse (&argp, argc, argv, 0, 0, NULL);
+	if (ret != 0) {
+		fprintf (stderr, "%s: argp_parse() failed\n", argv[0]);
+		return 1;
+	}
+
+	if (!ib_config.threads || !ib_config.inodes) {
+		fprintf (stderr, "%s: configuration validation failed\n",
+			 argv[0]);
+		return 1;
+	}
+
+	glusterfs_globals_init ();
+
+	graph.xl_count = 1;
+	xl.name = "inode-bm";
+	xl.graph = &graph;
+
+	/* lru limit above the working set, only the lookups are measured */
+	ib_config.table = inode_table_new (ib_config.inodes * 2, &xl);
+	if (!ib_config.table || ib_populate ()) {
+		fprintf (stderr, "%s: cannot set up the inode table\n",
+			 argv[0]);
+		return 1;
+	}
+
+	stats = calloc (ib_config.threads, sizeof (*stats));
+	threads = calloc (ib_config.threads, sizeof (*threads));
+	if (!stats || !threads) {
+		fprintf (stderr, "calloc() failed (%s)\n", strerror (errno));
+		return 1;
+	}
+
+	start = ib_usec_now ();
+	for (i = 0; i < ib_config.threads; i++) {
+		ret = pthread_create (&threads[i], NULL, ib_worker, &stats[i]);
+		if (ret != 0) {
+			fprintf (stderr, "pthread_create failed (%s)\n",
+				 strerror (ret));
+			return 1;
+		}
+	}
+
+	sleep (ib_config.runtime);
+	ib_config.stop = 1;
+
+	for (i = 0; i < ib_config.threads; i++) {
+		pthread_join (threads[i], NULL);
+		ops += stats[i].ops;
+		misses += stats[i].misses;
+	}
+	secs = (ib_usec_now () - start) / 1000000.0;
+
+	printf ("threads %ld inodes %ld gfid-mix %ld%%: %.0f lookups/s "
+		"(%.0f per thread), %"PRIu64" misses\n",
+		ib_config.threads, ib_config.inodes, ib_config.find_pct,
+		ops / secs, ops / secs / ib_config.threads, misses);
+
+	free (stats);
+	free (threads);
+	free (ib_config.gfids);
+
+	return misses ? 1 : 0;
+}
@@ -0,0 +1,362 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/* qdepth-bm: keep a fixed number of random reads/writes outstanding
+   against one file and report IOPS, bandwidth and latency. Run it on a
+   mount of a single-brick volume with and without "option io-uring on"
+   in storage/posix to compare the two I/O engines. */
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <errno.h>
+#include <string.h>
+#include <argp.h>
+
+#ifndef UNIX_PATH_MAX
+#define UNIX_PATH_MAX 108
+#endif
+
+struct qd_config {
+	char path[UNIX_PATH_MAX];
+	int fd;
+	long depth;            /* outstanding I/Os == worker threads */
+	size_t bs;
+	off_t file_size;
+	long runtime;          /* seconds */
+	long read_pct;
+	long fsync_every;      /* fsync after every N writes, 0 = never */
+	volatile int stop;
+	pthread_t *threads;
+};
+static struct qd_config qd_config;
+
+struct qd_stats {
+	uint64_t reads;
+	uint64_t writes;
+	uint64_t fsyncs;
+	uint64_t bytes;
+	uint64_t lat_usec;
+	uint64_t max_lat_usec;
+	int err;
+};
+
+enum qd_keys {
+	QD_SIZE_KEY = 1,
+	QD_FSYNC_KEY,
+};
+
+
+static int
+qd_parse_long (const char *arg, const char *what, long *val)
+{
+	char *tmp = NULL;
+	long  v = 0;
+
+	v = strtol (arg, &tmp, 10);
+	if ((v == LONG_MAX) || (v == LONG_MIN) || (tmp && *tmp) || (v < 0)) {
+		fprintf (stderr, "invalid argument for %s (%s)\n", what, arg);
+		return -1;
+	}
+
+	*val = v;
+	return 0;
+}
+
+
+static error_t
+qd_parse_opts (int key, char *arg, struct argp_state *_state)
+{
+	long val = 0;
+
+	switch (key) {
+	case 'f':
+		if (strlen (arg) >= UNIX_PATH_MAX) {
+			fprintf (stderr, "file name too long (%s)\n", arg);
+			return -1;
+		}
+		strcpy (qd_config.path, arg);
+		break;
+	case 'd':
+		if (qd_parse_long (arg, "queue depth", &qd_config.depth))
+			return -1;
+		break;
+	case 'b':
+		if (qd_parse_long (arg, "block size", &val))
+			return -1;
+		qd_config.bs = val;
+		break;
+	case QD_SIZE_KEY:
+		if (qd_parse_long (arg, "file size (MB)", &val))
+			return -1;
+		qd_config.file_size = (off_t)val * 1048576;
+		break;
+	case 'r':
+		if (qd_parse_long (arg, "runtime", &qd_config.runtime))
+			return -1;
+		break;
+	case 'm':
+		if (qd_parse_long (arg, "read percentage", &qd_config.read_pct)
+		    || (qd_config.read_pct > 100))
+			return -1;
+		break;
+	case QD_FSYNC_KEY:
+		if (qd_parse_long (arg, "fsync interval",
+				   &qd_config.fsync_every))
+			return -1;
+		break;
+	case ARGP_KEY_END:
+		if (_state->argc == 1)
+			argp_usage (_state);
+		break;
+	}
+
+	return 0;
+}
+
+static struct argp_option qd_options[] = {
+	{"file", 'f', "FILE", 0, "file to run I/O against (created if needed)"},
+	{"depth", 'd', "COUNT", 0,
+	 "number of outstanding I/Os (defaults to 32)"},
+	{"bs", 'b', "BYTES", 0, "block size in bytes (defaults to 4096)"},
+	{"size", QD_SIZE_KEY, "MB", 0, "file size in MB (defaults to 1024)"},
+	{"runtime", 'r', "SECS", 0, "duration of the run (defaults to 30)"},
+	{"read-mix", 'm', "PERCENT", 0,
+	 "percentage of reads, the rest are writes (defaults to 70)"},
+	{"fsync-every", QD_FSYNC_KEY, "COUNT", 0,
+	 "fsync after every COUNT writes of a thread (defaults to 0, never)"},
+	{0, 0, 0, 0, 0}
+};
+
+static struct argp argp = {
+	qd_options,
+	qd_parse_opts,
+	"",
+	"qdepth-bm - random read/write load at a fixed queue depth"
+};
+
+
+static uint64_t
+qd_usec_now (void)
+{
+	struct timeval tv = {0, };
+
+	gettimeofday (&tv, NULL);
+	return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+static void *
+qd_worker (void *arg)
+{
+	struct qd_stats *stats = arg;
+	unsigned int     seed = 0;
+	char            *buf = NULL;
+	off_t            blocks = 0;
+	off_t            offset = 0;
+	uint64_t         start = 0;
+	uint64_t         lat = 0;
+	ssize_t          ret = 0;
+	long             writes = 0;
+
+	seed = (unsigned int)(qd_usec_now () ^ (uintptr_t)stats);
+	blocks = qd_config.file_size / qd_config.bs;
+
+	if (posix_memalign ((void **)&buf, 4096, qd_config.bs)) {
+		stats->err = ENOMEM;
+		return NULL;
+	}
+	memset (buf, 0xa5, qd_config.bs);
+
+	while (!qd_config.stop) {
+		offset = (off_t)(rand_r (&seed) % blocks) * qd_config.bs;
+
+		start = qd_usec_now ();
+		if ((rand_r (&seed) % 100) < qd_config.read_pct) {
+			ret = pread (qd_config.fd, buf, qd_config.bs, offset);
+			stats->reads++;
+		} else {
+			ret = pwrite (qd_config.fd, buf, qd_config.bs, offset);
+			stats->writes++;
+			writes++;
+			if ((ret >= 0) && qd_config.fsync_every &&
+			    !(writes % qd_config.fsync_every)) {
+				if (fsync (qd_config.fd) == -1)
+					ret = -1;
+				stats->fsyncs++;
+			}
+		}
+		if (ret == -1) {
+			stats->err = errno;
+			break;
+		}
+
+		lat = qd_usec_now () - start;
+		stats->lat_usec += lat;
+		if (lat > stats->max_lat_usec)
+			stats->max_lat_usec = lat;
+		stats->bytes += ret;
+	}
+
+	free (buf);
+	return NULL;
+}
+
+
+static int
+qd_prepare_file (void)
+{
+	struct stat st = {0, };
+	char       *buf = NULL;
+	off_t       off = 0;
+	int         ret = -1;
+
+	qd_config.fd = open (qd_config.path, O_RDWR | O_CREAT, 0644);
+	if (qd_config.fd == -1) {
+		fprintf (stderr, "cannot open %s (%s)\n", qd_config.path,
+			 strerror (errno));
+		return -1;
+	}
+
+	if (fstat (qd_config.fd, &st) == -1) {
+		fprintf (stderr, "cannot stat %s (%s)\n", qd_config.path,
+			 strerror (errno));
+		return -1;
+	}
+
+	if (st.st_size >= qd_config.file_size)
+		return 0;
+
+	/* lay the file out so reads hit real blocks, not holes */
+	buf = calloc (1, 1048576);
+	if (!buf)
+		return -1;
+
+	for (off = st.st_size; off < qd_config.file_size; off += 1048576) {
+		if (pwrite (qd_config.fd, buf, 1048576, off) != 1048576) {
+			fprintf (stderr, "write failed (%s)\n",
+				 strerror (errno));
+			goto out;
+		}
+	}
+	fsync (qd_config.fd);
+	ret = 0;
+out:
+	free (buf);
+	return ret;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+	struct qd_stats *stats = NULL;
+	struct qd_stats  total = {0, };
+	uint64_t         start = 0;
+	double           secs = 0;
+	uint64_t         ops = 0;
+	int              i = 0;
+	int              ret = -1;
+
+	qd_config.depth = 32;
+	qd_config.bs = 4096;
+	qd_config.file_size = 1024 * 1048576LL;
+	qd_config.runtime = 30;
+	qd_config.read_pct = 70;
+
+	ret = argp_parse (&argp, argc, argv, 0, 0, NULL);
+	if (ret != 0) {
+		fprintf (stderr, "%s: argp_parse() failed\n", argv[0]);
+		return 1;
+	}
+
+	if (!strlen (qd_config.path) || !qd_config.depth || !qd_config.bs ||
+	    (qd_config.file_size < qd_config.bs)) {
+		fprintf (stderr, "%s: configuration validation failed\n",
+			 argv[0]);
+		return 1;
+	}
+
+	if (qd_prepare_file ())
+		return 1;
+
+	stats = calloc (qd_config.depth, sizeof (*stats));
+	qd_config.threads = calloc (qd_config.depth, sizeof (pthread_t));
+	if (!stats || !qd_config.threads) {
+		fprintf (stderr, "calloc() failed (%s)\n", strerror (errno));
+		return 1;
+	}
+
+	start = qd_usec_now ();
+	for (i = 0; i < qd_config.depth; i++) {
+		ret = pthread_create (&qd_config.threads[i], NULL, qd_worker,
+				      &stats[i]);
+		if (ret != 0) {
+			fprintf (stderr, "pthread_create failed (%s)\n",
+				 strerror (ret));
+			return 1;
+		}
+	}
+
+	sleep (qd_config.runtime);
+	qd_config.stop = 1;
+
+	for (i = 0; i < qd_config.depth; i++) {
+		pthread_join (qd_config.threads[i], NULL);
+		total.reads  += stats[i].reads;
+		total.writes += stats[i].writes;
+		total.fsyncs += stats[i].fsyncs;
+		total.bytes  += stats[i].bytes;
+		total.lat_usec += stats[i].lat_usec;
+		if (stats[i].max_lat_usec > total.max_lat_usec)
+			total.max_lat_usec = stats[i].max_lat_usec;
+		if (stats[i].err && !total.err)
+			total.err = stats[i].err;
+	}
+	secs = (qd_usec_now () - start) / 1000000.0;
+	ops = total.reads + total.writes;
+
+	printf ("depth %ld bs %zu read-mix %ld%%: %.0f IOPS (%.0f read, "
+		"%.0f write), %.2f MB/s, avg lat %.1f usec, max lat %"PRIu64
+		" usec, %"PRIu64" fsyncs\n",
+		qd_config.depth, qd_config.bs, qd_config.read_pct,
+		ops / secs, total.reads / secs, total.writes / secs,
+		total.bytes / secs / 1048576,
+		ops ? (double)total.lat_usec / ops : 0.0,
+		total.max_lat_usec, total.fsyncs);
+
+	if (total.err) {
+		fprintf (stderr, "I/O error during run (%s)\n",
+			 strerror (total.err));
+		return 1;
+	}
+
+	close (qd_config.fd);
+	free (stats);
+	free (qd_config.threads);
+
+	return 0;
+}
@@ -0,0 +1,333 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/* readdir-bm: fills --dir with --entries empty files from --threads
+   threads (unless --skip-create), then lists it --passes times and
+   prints for each pass the time to the first entry, the total time and
+   the entries per second. Run it on distribute volumes of 10, 50 and 100
+   bricks with cluster.readdir-prefetch-subvols set to 0 and to its
+   default to see what the parallel readdirp gains. */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <errno.h>
+#include <string.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <argp.h>
+
+struct rb_config {
+	char dir[PATH_MAX];
+	int threads;
+	long entries;
+	long passes;
+	int skip_create;
+	int stat;
+	int cleanup;
+};
+static struct rb_config rb_config;
+
+struct rb_thread {
+	pthread_t thread;
+	int id;
+	int error;
+};
+
+enum rb_keys {
+	RB_DIR_KEY = 1,
+	RB_THREADS_KEY,
+	RB_ENTRIES_KEY,
+	RB_PASSES_KEY,
+	RB_SKIP_CREATE_KEY,
+	RB_STAT_KEY,
+	RB_CLEANUP_KEY,
+};
+
+
+static int
+rb_parse_long (const char *arg, const char *what, long *val)
+{
+	char *tmp = NULL;
+	long  v = 0;
+
+	v = strtol (arg, &tmp, 10);
+	if ((v == LONG_MAX) || (v == LONG_MIN) || (tmp && *tmp) || (v <= 0)) {
+		fprintf (stderr, "invalid argument for %s (%s)\n", what, arg);
+		return -1;
+	}
+
+	*val = v;
+	return 0;
+}
+
+
+static error_t
+rb_parse_opts (int key, char *arg, struct argp_state *_state)
+{
+	long val = 0;
+
+	switch (key) {
+	case RB_DIR_KEY:
+		if (strlen (arg) >= sizeof (rb_config.dir) / 2) {
+			fprintf (stderr, "directory name too long (%s)\n", arg);
+			return -1;
+		}
+		strcpy (rb_config.dir, arg);
+		break;
+	case RB_THREADS_KEY:
+		if (rb_parse_long (arg, "threads", &val))
+			return -1;
+		rb_config.threads = val;
+		break;
+	case RB_ENTRIES_KEY:
+		if (rb_parse_long (arg, "entries", &val))
+			return -1;
+		rb_config.entries = val;
+		break;
+	case RB_PASSES_KEY:
+		if (rb_parse_long (arg, "passes", &val))
+			return -1;
+		rb_config.passes = val;
+		break;
+	case RB_SKIP_CREATE_KEY:
+		rb_config.skip_create = 1;
+		break;
+	case RB_STAT_KEY:
+		rb_config.stat = 1;
+		break;
+	case RB_CLEANUP_KEY:
+		rb_config.cleanup = 1;
+		break;
+	case ARGP_KEY_END:
+		if (!strlen (rb_config.dir)) {
+			fprintf (stderr, "--dir is needed\n");
+			return -1;
+		}
+		break;
+	}
+
+	return 0;
+}
+
+static struct argp_option rb_options[] = {
+	{"dir", RB_DIR_KEY, "DIR", 0, "directory of the mount to list"},
+	{"threads", RB_THREADS_KEY, "N", 0, "threads creating the entries "
+	 "(defaults to 16)"},
+	{"entries", RB_ENTRIES_KEY, "N", 0, "entries in the directory "
+	 "(defaults to 1000000)"},
+	{"passes", RB_PASSES_KEY, "N", 0, "times the directory is listed "
+	 "(defaults to 3)"},
+	{"skip-create", RB_SKIP_CREATE_KEY, 0, 0, "list what --dir already "
+	 "holds"},
+	{"stat", RB_STAT_KEY, 0, 0, "stat every entry while listing"},
+	{"cleanup", RB_CLEANUP_KEY, 0, 0, "remove the entries at the end"},
+	{0, 0, 0, 0, 0}
+};
+
+static struct argp argp = {
+	rb_options,
+	rb_parse_opts,
+	"",
+	"readdir-bm - time to list a directory with many entries"
+};
+
+
+static uint64_t
+rb_usec_now (void)
+{
+	struct timeval tv = {0, };
+
+	gettimeofday (&tv, NULL);
+	return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+static void *
+rb_creator (void *data)
+{
+	struct rb_thread *t = data;
+	char              path[PATH_MAX];
+	long              n = 0;
+	int               fd = -1;
+
+	for (n = t->id; n < rb_config.entries; n += rb_config.threads) {
+		snprintf (path, sizeof (path), "%s/e.%ld", rb_config.dir, n);
+		fd = open (path, O_WRONLY | O_CREAT, 0644);
+		if ((fd == -1) || close (fd)) {
+			t->error = errno;
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+
+static void *
+rb_remover (void *data)
+{
+	struct rb_thread *t = data;
+	char              path[PATH_MAX];
+	long              n = 0;
+
+	for (n = t->id; n < rb_config.entries; n += rb_config.threads) {
+		snprintf (path, sizeof (path), "%s/e.%ld", rb_config.dir, n);
+		if (unlink (path) && (errno != ENOENT)) {
+			t->error = errno;
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+
+static int
+rb_run_threads (void *(*fn) (void *), const char *what)
+{
+	struct rb_thread *threads = NULL;
+	uint64_t          start = 0, elapsed = 0;
+	int               ret = 0;
+	int               i = 0;
+
+	threads = calloc (rb_config.threads, sizeof (*threads));
+	if (!threads) {
+		fprintf (stderr, "out of memory\n");
+		return -1;
+	}
+
+	start = rb_usec_now ();
+	for (i = 0; i < rb_config.threads; i++) {
+		threads[i].id = i;
+		if (pthread_create (&threads[i].thread, NULL, fn, &threads[i])) {
+			fprintf (stderr, "cannot start thread %d\n", i);
+			exit (1);
+		}
+	}
+
+	for (i = 0; i < rb_config.threads; i++) {
+		pthread_join (threads[i].thread, NULL);
+		if (threads[i].error) {
+			fprintf (stderr, "%s: thread %d failed (%s)\n", what, i,
+				 strerror (threads[i].error));
+			ret = -1;
+		}
+	}
+	elapsed = rb_usec_now () - start;
+	free (threads);
+
+	if (ret == 0)
+		printf ("%s %ld entries: %.3f seconds\n", what,
+			rb_config.entries, elapsed / 1000000.0);
+
+	return ret;
+}
+
+
+static int
+rb_list (int pass)
+{
+	char           path[PATH_MAX];
+	struct stat    stbuf;
+	struct dirent *entry = NULL;
+	DIR           *dir = NULL;
+	uint64_t       start = 0, first = 0, elapsed = 0;
+	long           count = 0;
+
+	start = rb_usec_now ();
+
+	dir = opendir (rb_config.dir);
+	if (!dir) {
+		fprintf (stderr, "cannot open %s (%s)\n", rb_config.dir,
+			 strerror (errno));
+		return -1;
+	}
+
+	while ((entry = readdir (dir))) {
+		if (!count)
+			first = rb_usec_now () - start;
+		count++;
+
+		if (!rb_config.stat || !strcmp (entry->d_name, ".")
+		    || !strcmp (entry->d_name, ".."))
+			continue;
+
+		snprintf (path, sizeof (path), "%s/%s", rb_config.dir,
+			  entry->d_name);
+		if (stat (path, &stbuf)) {
+			fprintf (stderr, "cannot stat %s (%s)\n", path,
+				 strerror (errno));
+			closedir (dir);
+			return -1;
+		}
+	}
+
+	closedir (dir);
+	elapsed = rb_usec_now () - start;
+
+	printf ("%-6d %10ld %14.3f %12.3f %12.0f\n", pass, count,
+		first / 1000.0, elapsed / 1000000.0,
+		elapsed ? count / (elapsed / 1000000.0) : 0.0);
+
+	return 0;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+	int ret = 0;
+	int i = 0;
+
+	rb_config.threads = 16;
+	rb_config.entries = 1000000;
+	rb_config.passes = 3;
+
+	ret = argp_parse (&argp, argc, argv, 0, 0, NULL);
+	if (ret != 0) {
+		fprintf (stderr, "%s: argp_parse() failed\n", argv[0]);
+		return 1;
+	}
+
+	if (!rb_config.skip_create && rb_run_threads (rb_creator, "create"))
+		return 1;
+
+	printf ("%-6s %10s %14s %12s %12s\n", "pass", "entries",
+		"first (ms)", "seconds", "entries/s");
+
+	for (i = 0; i < rb_config.passes; i++) {
+		if (rb_list (i + 1)) {
+			ret = 1;
+			break;
+		}
+	}
+
+	if (rb_config.cleanup && rb_run_threads (rb_remover, "unlink"))
+		ret = 1;
+
+	return ret;
+}
@@ -0,0 +1,286 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/* rpc-small-bm: several threads issue small metadata operations on
+   their own file of a mount as fast as they can, so that the client
+   connection carries a dense stream of small requests and replies.
+   getxattr and setxattr are not cached by fuse, every call is one RPC.
+   Prints operations per second and the mean latency; the socket
+   read-calls-per-msg counters of a statedump tell how many read
+   syscalls each of those messages cost. */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/xattr.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <errno.h>
+#include <string.h>
+#include <pthread.h>
+#include <argp.h>
+
+#define RB_XATTR "user.rpc-small-bm"
+
+enum rb_ops {
+	RB_OP_GETXATTR,
+	RB_OP_SETXATTR,
+	RB_OP_STAT,
+};
+
+struct rb_config {
+	char dir[PATH_MAX];
+	int threads;
+	int runtime;                    /* seconds */
+	enum rb_ops op;
+};
+static struct rb_config rb_config;
+
+struct rb_thread {
+	pthread_t thread;
+	int id;
+	uint64_t ops;
+	uint64_t usecs;
+	int error;
+};
+
+enum rb_keys {
+	RB_THREADS_KEY = 1,
+	RB_RUNTIME_KEY,
+	RB_OP_KEY,
+};
+
+static volatile int rb_stop;
+
+
+static int
+rb_parse_long (const char *arg, const char *what, long *val)
+{
+	char *tmp = NULL;
+	long  v = 0;
+
+	v = strtol (arg, &tmp, 10);
+	if ((v == LONG_MAX) || (v == LONG_MIN) || (tmp && *tmp) || (v <= 0)) {
+		fprintf (stderr, "invalid argument for %s (%s)\n", what, arg);
+		return -1;
+	}
+
+	*val = v;
+	return 0;
+}
+
+
+static error_t
+rb_parse_opts (int key, char *arg, struct argp_state *_state)
+{
+	long val = 0;
+
+	switch (key) {
+	case 'd':
+		if (strlen (arg) >= sizeof (rb_config.dir) - 32) {
+			fprintf (stderr, "directory name too long (%s)\n", arg);
+			return -1;
+		}
+		strcpy (rb_config.dir, arg);
+		break;
+	case RB_THREADS_KEY:
+		if (rb_parse_long (arg, "threads", &val))
+			return -1;
+		rb_config.threads = val;
+		break;
+	case RB_RUNTIME_KEY:
+		if (rb_parse_long (arg, "runtime", &val))
+			return -1;
+		rb_config.runtime = val;
+		break;
+	case RB_OP_KEY:
+		if (!strcmp (arg, "getxattr"))
+			rb_config.op = RB_OP_GETXATTR;
+		else if (!strcmp (arg, "setxattr"))
+			rb_config.op = RB_OP_SETXATTR;
+		else if (!strcmp (arg, "stat"))
+			rb_config.op = RB_OP_STAT;
+		else {
+			fprintf (stderr, "unknown op (%s)\n", arg);
+			return -1;
+		}
+		break;
+	case ARGP_KEY_END:
+		if (_state->argc == 1)
+			argp_usage (_state);
+		break;
+	}
+
+	return 0;
+}
+
+static struct argp_option rb_options[] = {
+	{"dir", 'd', "DIR", 0, "directory on the mount to work in"},
+	{"threads", RB_THREADS_KEY, "N", 0, "threads (defaults to 16)"},
+	{"runtime", RB_RUNTIME_KEY, "SECS", 0, "run time (defaults to 30)"},
+	{"op", RB_OP_KEY, "OP", 0,
+	 "getxattr, setxattr or stat (defaults to getxattr)"},
+	{0, 0, 0, 0, 0}
+};
+
+static struct argp argp = {
+	rb_options,
+	rb_parse_opts,
+	"",
+	"rpc-small-bm - throughput of small requests over one connection"
+};
+
+
+static uint64_t
+rb_usec_now (void)
+{
+	struct timeval tv = {0, };
+
+	gettimeofday (&tv, NULL);
+	return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+static void *
+rb_worker (void *data)
+{
+	struct rb_thread *t = data;
+	struct stat       stbuf;
+	char              path[PATH_MAX] = {0, };
+	char              value[64] = {0, };
+	uint64_t          start = 0;
+	int               fd = -1;
+	int               ret = 0;
+
+	snprintf (path, sizeof (path), "%s/rpc-small-bm.%d", rb_config.dir,
+		  t->id);
+	fd = open (path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1) {
+		t->error = errno;
+		return NULL;
+	}
+
+	if (fsetxattr (fd, RB_XATTR, "0", 1, 0) == -1) {
+		t->error = errno;
+		goto out;
+	}
+
+	while (!rb_stop) {
+		start = rb_usec_now ();
+		switch (rb_config.op) {
+		case RB_OP_GETXATTR:
+			ret = fgetxattr (fd, RB_XATTR, value, sizeof (value));
+			break;
+		case RB_OP_SETXATTR:
+			snprintf (value, sizeof (value), "%"PRIu64, t->ops);
+			ret = fsetxattr (fd, RB_XATTR, value, strlen (value), 0);
+			break;
+		case RB_OP_STAT:
+			ret = stat (path, &stbuf);
+			break;
+		}
+		if (ret == -1) {
+			t->error = errno;
+			break;
+		}
+		t->usecs += rb_usec_now () - start;
+		t->ops++;
+	}
+
+out:
+	close (fd);
+	unlink (path);
+	return NULL;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+	struct rb_thread *threads = NULL;
+	uint64_t          start = 0;
+	uint64_t          elapsed = 0;
+	uint64_t          ops = 0;
+	uint64_t          usecs = 0;
+	int               ret = -1;
+	int               i = 0;
+
+	rb_config.threads = 16;
+	rb_config.runtime = 30;
+	rb_config.op = RB_OP_GETXATTR;
+
+	ret = argp_parse (&argp, argc, argv, 0, 0, NULL);
+	if (ret != 0) {
+		fprintf (stderr, "%s: argp_parse() failed\n", argv[0]);
+		return 1;
+	}
+
+	if (!strlen (rb_config.dir)) {
+		fprintf (stderr, "%s: configuration validation failed\n",
+			 argv[0]);
+		return 1;
+	}
+
+	threads = calloc (rb_config.threads, sizeof (*threads));
+	if (!threads) {
+		fprintf (stderr, "out of memory\n");
+		return 1;
+	}
+
+	start = rb_usec_now ();
+	for (i = 0; i < rb_config.threads; i++) {
+		threads[i].id = i;
+		if (pthread_create (&threads[i].thread, NULL, rb_worker,
+				    &threads[i])) {
+			fprintf (stderr, "cannot start thread %d\n", i);
+			rb_stop = 1;
+			rb_config.threads = i;
+			break;
+		}
+	}
+
+	sleep (rb_config.runtime);
+	rb_stop = 1;
+
+	ret = 0;
+	for (i = 0; i < rb_config.threads; i++) {
+		pthread_join (threads[i].thread, NULL);
+		if (threads[i].error) {
+			fprintf (stderr, "thread %d failed (%s)\n", i,
+				 strerror (threads[i].error));
+			ret = -1;
+		}
+		ops += threads[i].ops;
+		usecs += threads[i].usecs;
+	}
+	elapsed = rb_usec_now () - start;
+
+	printf ("%-8s %8s %12s %14s\n", "threads", "ops", "ops/s",
+		"latency (us)");
+	printf ("%-8d %8"PRIu64" %12.0f %14.1f\n", rb_config.threads, ops,
+		ops / (elapsed / 1000000.0), ops ? (double)usecs / ops : 0.0);
+
+	free (threads);
+	return ret ? 1 : 0;
+}
@@ -0,0 +1,412 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/* smallfile-bm: each thread creates --files files of --size bytes spread
+   over --dirs directories of its own under --dir, then reads them all
+   back, lists and stats each directory (what readdirp serves) and
+   removes them. Prints files per second for every phase. Run it on a
+   mount of a storage/bdb volume and on one of a storage/posix volume
+   to compare the two. */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <errno.h>
+#include <string.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <argp.h>
+
+enum sb_phases {
+	SB_CREATE,
+	SB_READ,
+	SB_LIST,
+	SB_UNLINK,
+	SB_PHASES,
+};
+
+static const char *sb_phase_names[SB_PHASES] = {
+	"create", "read", "list+stat", "unlink"
+};
+
+struct sb_config {
+	char dir[PATH_MAX];
+	int threads;
+	long files;
+	long dirs;
+	long size;
+	int keep;
+};
+static struct sb_config sb_config;
+
+struct sb_thread {
+	pthread_t thread;
+	int id;
+	char *buf;
+	int error;
+};
+
+enum sb_keys {
+	SB_DIR_KEY = 1,
+	SB_THREADS_KEY,
+	SB_FILES_KEY,
+	SB_DIRS_KEY,
+	SB_SIZE_KEY,
+	SB_KEEP_KEY,
+};
+
+static pthread_barrier_t sb_barrier;
+
+
+static int
+sb_parse_long (const char *arg, const char *what, long *val)
+{
+	char *tmp = NULL;
+	long  v = 0;
+
+	v = strtol (arg, &tmp, 10);
+	if ((v == LONG_MAX) || (v == LONG_MIN) || (tmp && *tmp) || (v <= 0)) {
+		fprintf (stderr, "invalid argument for %s (%s)\n", what, arg);
+		return -1;
+	}
+
+	*val = v;
+	return 0;
+}
+
+
+static error_t
+sb_parse_opts (int key, char *arg, struct argp_state *_state)
+{
+	long val = 0;
+
+	switch (key) {
+	case SB_DIR_KEY:
+		if (strlen (arg) >= sizeof (sb_config.dir) / 2) {
+			fprintf (stderr, "directory name too long (%s)\n", arg);
+			return -1;
+		}
+		strcpy (sb_config.dir, arg);
+		break;
+	case SB_THREADS_KEY:
+		if (sb_parse_long (arg, "threads", &val))
+			return -1;
+		sb_config.threads = val;
+		break;
+	case SB_FILES_KEY:
+		if (sb_parse_long (arg, "files", &val))
+			return -1;
+		sb_config.files = val;
+		break;
+	case SB_DIRS_KEY:
+		if (sb_parse_long (arg, "dirs", &val))
+			return -1;
+		sb_config.dirs = val;
+		break;
+	case SB_SIZE_KEY:
+		if (sb_parse_long (arg, "size", &val))
+			return -1;
+		sb_config.size = val;
+		break;
+	case SB_KEEP_KEY:
+		sb_config.keep = 1;
+		break;
+	case ARGP_KEY_END:
+		if (!strlen (sb_config.dir)) {
+			fprintf (stderr, "--dir is needed\n");
+			return -1;
+		}
+		break;
+	}
+
+	return 0;
+}
+
+static struct argp_option sb_options[] = {
+	{"dir", SB_DIR_KEY, "DIR", 0, "directory of the mount to work in"},
+	{"threads", SB_THREADS_KEY, "N", 0, "threads (defaults to 8)"},
+	{"files", SB_FILES_KEY, "N", 0, "files per thread "
+	 "(defaults to 10000)"},
+	{"dirs", SB_DIRS_KEY, "N", 0, "directories per thread the files are "
+	 "spread over (defaults to 10)"},
+	{"size", SB_SIZE_KEY, "BYTES", 0, "file size (defaults to 2048)"},
+	{"keep", SB_KEEP_KEY, 0, 0, "skip the unlink phase, leave the files"},
+	{0, 0, 0, 0, 0}
+};
+
+static struct argp argp = {
+	sb_options,
+	sb_parse_opts,
+	"",
+	"smallfile-bm - small file create, read, list and unlink rates"
+};
+
+
+static uint64_t
+sb_usec_now (void)
+{
+	struct timeval tv = {0, };
+
+	gettimeofday (&tv, NULL);
+	return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+static void
+sb_path (char *path, size_t len, int id, long n, int file)
+{
+	if (file)
+		snprintf (path, len, "%s/sb.%d.%ld/f.%ld", sb_config.dir, id,
+			  n % sb_config.dirs, n);
+	else
+		snprintf (path, len, "%s/sb.%d.%ld", sb_config.dir, id, n);
+}
+
+
+static int
+sb_create (struct sb_thread *t, const char *path)
+{
+	ssize_t ret = 0;
+	int     fd = -1;
+
+	fd = open (path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1)
+		return -1;
+
+	ret = write (fd, t->buf, sb_config.size);
+	if (ret != sb_config.size) {
+		if (ret >= 0)
+			errno = EIO;
+		close (fd);
+		return -1;
+	}
+
+	return close (fd);
+}
+
+
+static int
+sb_read (struct sb_thread *t, const char *path)
+{
+	ssize_t ret = 0;
+	int     fd = -1;
+
+	fd = open (path, O_RDONLY);
+	if (fd == -1)
+		return -1;
+
+	ret = read (fd, t->buf, sb_config.size);
+	if (ret != sb_config.size) {
+		if (ret >= 0)
+			errno = EIO;
+		close (fd);
+		return -1;
+	}
+
+	return close (fd);
+}
+
+
+static int
+sb_list (const char *dirpath)
+{
+	char           path[PATH_MAX];
+	struct stat    stbuf;
+	struct dirent *entry = NULL;
+	DIR           *dir = NULL;
+	int            ret = 0;
+
+	dir = opendir (dirpath);
+	if (!dir)
+		return -1;
+
+	while ((entry = readdir (dir))) {
+		if (!strcmp (entry->d_name, ".") || !strcmp (entry->d_name, ".."))
+			continue;
+		snprintf (path, sizeof (path), "%s/%s", dirpath, entry->d_name);
+		ret = stat (path, &stbuf);
+		if (ret == -1)
+			break;
+	}
+
+	closedir (dir);
+	return ret;
+}
+
+
+static int
+sb_do_phase (struct sb_thread *t, int phase)
+{
+	char path[PATH_MAX];
+	long n = 0;
+
+	if (phase == SB_LIST) {
+		for (n = 0; n < sb_config.dirs; n++) {
+			sb_path (path, sizeof (path), t->id, n, 0);
+			if (sb_list (path))
+				return -1;
+		}
+		return 0;
+	}
+
+	for (n = 0; n < sb_config.files; n++) {
+		sb_path (path, sizeof (path), t->id, n, 1);
+		switch (phase) {
+		case SB_CREATE:
+			if (sb_create (t, path))
+				return -1;
+			break;
+		case SB_READ:
+			if (sb_read (t, path))
+				return -1;
+			break;
+		case SB_UNLINK:
+			if (unlink (path))
+				return -1;
+			break;
+		}
+	}
+
+	if (phase == SB_UNLINK) {
+		for (n = 0; n < sb_config.dirs; n++) {
+			sb_path (path, sizeof (path), t->id, n, 0);
+			rmdir (path);
+		}
+	}
+
+	return 0;
+}
+
+
+static void *
+sb_worker (void *data)
+{
+	struct sb_thread *t = data;
+	int               phase = 0;
+
+	for (phase = 0; phase < SB_PHASES; phase++) {
+		/* the main thread times each phase between two barriers */
+		pthread_barrier_wait (&sb_barrier);
+		if ((phase == SB_UNLINK) && sb_config.keep) {
+			pthread_barrier_wait (&sb_barrier);
+			continue;
+		}
+		if (!t->error && sb_do_phase (t, phase))
+			t->error = errno ? errno : EIO;
+		pthread_barrier_wait (&sb_barrier);
+	}
+
+	return NULL;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+	struct sb_thread *threads = NULL;
+	char              path[PATH_MAX];
+	uint64_t          start = 0, elapsed = 0;
+	long              n = 0;
+	int               phase = 0;
+	int               ret = 0;
+	int               i = 0;
+
+	sb_config.threads = 8;
+	sb_config.files = 10000;
+	sb_config.dirs = 10;
+	sb_config.size = 2048;
+
+	ret = argp_parse (&argp, argc, argv, 0, 0, NULL);
+	if (ret != 0) {
+		fprintf (stderr, "%s: argp_parse() failed\n", argv[0]);
+		return 1;
+	}
+
+	threads = calloc (sb_config.threads, sizeof (*threads));
+	if (!threads) {
+		fprintf (stderr, "out of memory\n");
+		return 1;
+	}
+
+	for (i = 0; i < sb_config.threads; i++) {
+		threads[i].id = i;
+		threads[i].buf = malloc (sb_config.size);
+		if (!threads[i].buf) {
+			fprintf (stderr, "out of memory\n");
+			return 1;
+		}
+		memset (threads[i].buf, 'a' + i % 26, sb_config.size);
+
+		for (n = 0; n < sb_config.dirs; n++) {
+			sb_path (path, sizeof (path), i, n, 0);
+			if (mkdir (path, 0755) && (errno != EEXIST)) {
+				fprintf (stderr, "cannot create %s (%s)\n", path,
+					 strerror (errno));
+				return 1;
+			}
+		}
+	}
+
+	pthread_barrier_init (&sb_barrier, NULL, sb_config.threads + 1);
+	for (i = 0; i < sb_config.threads; i++) {
+		if (pthread_create (&threads[i].thread, NULL, sb_worker,
+				    &threads[i])) {
+			/* the barrier would never open */
+			fprintf (stderr, "cannot start thread %d\n", i);
+			exit (1);
+		}
+	}
+
+	printf ("%-10s %12s %12s\n", "phase", "seconds", "files/s");
+
+	for (phase = 0; phase < SB_PHASES; phase++) {
+		pthread_barrier_wait (&sb_barrier);
+		start = sb_usec_now ();
+		pthread_barrier_wait (&sb_barrier);
+		elapsed = sb_usec_now () - start;
+
+		if ((phase == SB_UNLINK) && sb_config.keep)
+			continue;
+
+		printf ("%-10s %12.3f %12.0f\n", sb_phase_names[phase],
+			elapsed / 1000000.0, elapsed ? (double)sb_config.threads
+			* sb_config.files / (elapsed / 1000000.0) : 0.0);
+	}
+
+	for (i = 0; i < sb_config.threads; i++) {
+		pthread_join (threads[i].thread, NULL);
+		if (threads[i].error) {
+			fprintf (stderr, "thread %d failed (%s)\n", i,
+				 strerror (threads[i].error));
+			ret = 1;
+		}
+		free (threads[i].buf);
+	}
+	pthread_barrier_destroy (&sb_barrier);
+	free (threads);
+
+	return ret;
+}
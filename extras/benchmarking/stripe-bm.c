@@ -0,0 +1,334 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/* stripe-bm: write a file, then read it back sequentially and at random
+   offsets with a range of record sizes, and print one line of throughput
+   per record size. Run it on mounts of striped volumes of different
+   widths and block sizes (see the README) to tabulate how stripe scales;
+   --width and --block only label the output. */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <errno.h>
+#include <string.h>
+#include <argp.h>
+
+#ifndef UNIX_PATH_MAX
+#define UNIX_PATH_MAX 108
+#endif
+
+#define SB_MAX_RECORDS 16
+
+struct sb_config {
+	char path[UNIX_PATH_MAX];
+	off_t size;
+	size_t records[SB_MAX_RECORDS];  /* bytes */
+	int nrecords;
+	int width;                       /* labels only */
+	char block[32];
+	int keep;
+};
+static struct sb_config sb_config;
+
+enum sb_keys {
+	SB_SIZE_KEY = 1,
+	SB_RECORD_KEY,
+	SB_WIDTH_KEY,
+	SB_BLOCK_KEY,
+	SB_KEEP_KEY,
+};
+
+
+static int
+sb_parse_long (const char *arg, const char *what, long *val)
+{
+	char *tmp = NULL;
+	long  v = 0;
+
+	v = strtol (arg, &tmp, 10);
+	if ((v == LONG_MAX) || (v == LONG_MIN) || (tmp && *tmp) || (v <= 0)) {
+		fprintf (stderr, "invalid argument for %s (%s)\n", what, arg);
+		return -1;
+	}
+
+	*val = v;
+	return 0;
+}
+
+
+/* "4,64,128,1024" */
+static int
+sb_parse_records (char *arg)
+{
+	char *tok = NULL;
+	char *save = NULL;
+	long  val = 0;
+
+	sb_config.nrecords = 0;
+	for (tok = strtok_r (arg, ",", &save); tok;
+	     tok = strtok_r (NULL, ",", &save)) {
+		if (sb_config.nrecords == SB_MAX_RECORDS) {
+			fprintf (stderr, "at most %d record sizes\n",
+				 SB_MAX_RECORDS);
+			return -1;
+		}
+		if (sb_parse_long (tok, "record (KB)", &val))
+			return -1;
+		sb_config.records[sb_config.nrecords++] = (size_t)val * 1024;
+	}
+
+	return 0;
+}
+
+
+static error_t
+sb_parse_opts (int key, char *arg, struct argp_state *_state)
+{
+	long val = 0;
+
+	switch (key) {
+	case 'f':
+		if (strlen (arg) >= UNIX_PATH_MAX) {
+			fprintf (stderr, "file name too long (%s)\n", arg);
+			return -1;
+		}
+		strcpy (sb_config.path, arg);
+		break;
+	case SB_SIZE_KEY:
+		if (sb_parse_long (arg, "size (MB)", &val))
+			return -1;
+		sb_config.size = (off_t)val * 1048576;
+		break;
+	case SB_RECORD_KEY:
+		if (sb_parse_records (arg))
+			return -1;
+		break;
+	case SB_WIDTH_KEY:
+		if (sb_parse_long (arg, "width", &val))
+			return -1;
+		sb_config.width = val;
+		break;
+	case SB_BLOCK_KEY:
+		if (strlen (arg) >= sizeof (sb_config.block)) {
+			fprintf (stderr, "block label too long (%s)\n", arg);
+			return -1;
+		}
+		strcpy (sb_config.block, arg);
+		break;
+	case SB_KEEP_KEY:
+		sb_config.keep = 1;
+		break;
+	case ARGP_KEY_END:
+		if (_state->argc == 1)
+			argp_usage (_state);
+		break;
+	}
+
+	return 0;
+}
+
+static struct argp_option sb_options[] = {
+	{"file", 'f', "FILE", 0, "file to write and read back"},
+	{"size", SB_SIZE_KEY, "MB", 0, "file size in MB (defaults to 1024)"},
+	{"record", SB_RECORD_KEY, "KB[,KB..]", 0,
+	 "record sizes in KB (defaults to 4,64,128,1024)"},
+	{"width", SB_WIDTH_KEY, "N", 0, "stripe count of the volume (label)"},
+	{"block", SB_BLOCK_KEY, "SIZE", 0, "stripe block size (label)"},
+	{"keep", SB_KEEP_KEY, 0, 0, "leave the file behind"},
+	{0, 0, 0, 0, 0}
+};
+
+static struct argp argp = {
+	sb_options,
+	sb_parse_opts,
+	"",
+	"stripe-bm - sequential and random throughput of a striped file"
+};
+
+
+static uint64_t
+sb_usec_now (void)
+{
+	struct timeval tv = {0, };
+
+	gettimeofday (&tv, NULL);
+	return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+static double
+sb_mbps (off_t bytes, uint64_t usecs)
+{
+	return (bytes / 1048576.0) / ((usecs ? usecs : 1) / 1000000.0);
+}
+
+
+static int
+sb_write (int fd, char *buf, size_t record, double *mbps)
+{
+	uint64_t start = 0;
+	off_t    off = 0;
+	size_t   len = 0;
+
+	start = sb_usec_now ();
+	for (off = 0; off < sb_config.size; off += len) {
+		len = ((sb_config.size - off) < record) ?
+			(sb_config.size - off) : record;
+		if (pwrite (fd, buf, len, off) != len)
+			return -1;
+	}
+	if (fsync (fd) == -1)
+		return -1;
+
+	*mbps = sb_mbps (sb_config.size, sb_usec_now () - start);
+	return 0;
+}
+
+
+static int
+sb_read_seq (int fd, char *buf, size_t record, double *mbps)
+{
+	uint64_t start = 0;
+	off_t    off = 0;
+	ssize_t  ret = 0;
+
+	start = sb_usec_now ();
+	for (off = 0; off < sb_config.size; off += ret) {
+		ret = pread (fd, buf, record, off);
+		if (ret <= 0)
+			return -1;
+	}
+
+	*mbps = sb_mbps (sb_config.size, sb_usec_now () - start);
+	return 0;
+}
+
+
+/* as many bytes as the sequential pass, at record aligned random offsets */
+static int
+sb_read_rand (int fd, char *buf, size_t record, double *mbps)
+{
+	uint64_t start = 0;
+	off_t    done = 0;
+	off_t    off = 0;
+	off_t    nrecords = 0;
+
+	nrecords = sb_config.size / record;
+	if (!nrecords)
+		nrecords = 1;
+
+	start = sb_usec_now ();
+	for (done = 0; done < sb_config.size; done += record) {
+		off = (random () % nrecords) * record;
+		if (pread (fd, buf, record, off) < 0)
+			return -1;
+	}
+
+	*mbps = sb_mbps (done, sb_usec_now () - start);
+	return 0;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+	char    *buf = NULL;
+	char     label[32] = {0, };
+	size_t   record = 0;
+	size_t   max_record = 0;
+	double   wr = 0, seq = 0, rnd = 0;
+	int      fd = -1;
+	int      ret = -1;
+	int      i = 0;
+
+	sb_config.size = 1024 * 1048576LL;
+	sb_config.records[0] = 4 * 1024;
+	sb_config.records[1] = 64 * 1024;
+	sb_config.records[2] = 128 * 1024;
+	sb_config.records[3] = 1024 * 1024;
+	sb_config.nrecords = 4;
+	strcpy (sb_config.block, "-");
+
+	ret = argp_parse (&argp, argc, argv, 0, 0, NULL);
+	if (ret != 0) {
+		fprintf (stderr, "%s: argp_parse() failed\n", argv[0]);
+		return 1;
+	}
+
+	if (!strlen (sb_config.path) || !sb_config.nrecords) {
+		fprintf (stderr, "%s: configuration validation failed\n",
+			 argv[0]);
+		return 1;
+	}
+
+	for (i = 0; i < sb_config.nrecords; i++)
+		if (sb_config.records[i] > max_record)
+			max_record = sb_config.records[i];
+
+	buf = malloc (max_record);
+	if (!buf) {
+		fprintf (stderr, "out of memory\n");
+		return 1;
+	}
+	memset (buf, 0x5a, max_record);
+	srandom (getpid ());
+
+	printf ("%-6s %-8s %-10s %12s %12s %12s\n", "width", "block",
+		"record", "write MB/s", "seq MB/s", "random MB/s");
+
+	for (i = 0; i < sb_config.nrecords; i++) {
+		record = sb_config.records[i];
+
+		fd = open (sb_config.path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (fd == -1) {
+			fprintf (stderr, "cannot open %s (%s)\n",
+				 sb_config.path, strerror (errno));
+			goto out;
+		}
+
+		if (sb_write (fd, buf, record, &wr) ||
+		    sb_read_seq (fd, buf, record, &seq) ||
+		    sb_read_rand (fd, buf, record, &rnd)) {
+			fprintf (stderr, "I/O on %s failed (%s)\n",
+				 sb_config.path, strerror (errno));
+			close (fd);
+			goto out;
+		}
+		close (fd);
+
+		snprintf (label, sizeof (label), "%zuKB", record / 1024);
+		printf ("%-6d %-8s %-10s %12.2f %12.2f %12.2f\n",
+			sb_config.width, sb_config.block, label, wr, seq, rnd);
+	}
+	ret = 0;
+out:
+	free (buf);
+	if (!sb_config.keep)
+		unlink (sb_config.path);
+
+	return ret ? 1 : 0;
+}
@@ -2094,6 +2094,169 @@ out:
         return stub;
 }
 
+call_stub_t *
+fop_fallocate_stub (call_frame_t *frame,
+                   fop_fallocate_t fn,
+                   fd_t *fd,
+                   int32_t keep_size,
+                   off_t offset,
+                   size_t len)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", fn, out);
+
+        stub = stub_new (frame, 1, GF_FOP_FALLOCATE);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.fallocate.fn = fn;
+
+        if (fd)
+                stub->args.fallocate.fd = fd_ref (fd);
+
+        stub->args.fallocate.keep_size = keep_size;
+        stub->args.fallocate.offset = offset;
+        stub->args.fallocate.len = len;
+
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_fallocate_cbk_stub (call_frame_t *frame,
+                       fop_fallocate_cbk_t fn,
+                       int32_t op_ret,
+                       int32_t op_errno,
+                       struct iatt *prebuf,
+                       struct iatt *postbuf)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_FALLOCATE);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.fallocate_cbk.fn = fn;
+        stub->args.fallocate_cbk.op_ret = op_ret;
+        stub->args.fallocate_cbk.op_errno = op_errno;
+        if (prebuf)
+                stub->args.fallocate_cbk.prebuf = *prebuf;
+        if (postbuf)
+                stub->args.fallocate_cbk.postbuf = *postbuf;
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_discard_stub (call_frame_t *frame,
+                 fop_discard_t fn,
+                 fd_t *fd,
+                 off_t offset,
+                 size_t len)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", fn, out);
+
+        stub = stub_new (frame, 1, GF_FOP_DISCARD);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.discard.fn = fn;
+
+        if (fd)
+                stub->args.discard.fd = fd_ref (fd);
+
+        stub->args.discard.offset = offset;
+        stub->args.discard.len = len;
+
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_discard_cbk_stub (call_frame_t *frame,
+                     fop_discard_cbk_t fn,
+                     int32_t op_ret,
+                     int32_t op_errno,
+                     struct iatt *prebuf,
+                     struct iatt *postbuf)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_DISCARD);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.discard_cbk.fn = fn;
+        stub->args.discard_cbk.op_ret = op_ret;
+        stub->args.discard_cbk.op_errno = op_errno;
+        if (prebuf)
+                stub->args.discard_cbk.prebuf = *prebuf;
+        if (postbuf)
+                stub->args.discard_cbk.postbuf = *postbuf;
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_zerofill_stub (call_frame_t *frame,
+                  fop_zerofill_t fn,
+                  fd_t *fd,
+                  int32_t keep_size,
+                  off_t offset,
+                  size_t len)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", fn, out);
+
+        stub = stub_new (frame, 1, GF_FOP_ZEROFILL);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.zerofill.fn = fn;
+
+        if (fd)
+                stub->args.zerofill.fd = fd_ref (fd);
+
+        stub->args.zerofill.keep_size = keep_size;
+        stub->args.zerofill.offset = offset;
+        stub->args.zerofill.len = len;
+
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_zerofill_cbk_stub (call_frame_t *frame,
+                      fop_zerofill_cbk_t fn,
+                      int32_t op_ret,
+                      int32_t op_errno,
+                      struct iatt *prebuf,
+                      struct iatt *postbuf)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_ZEROFILL);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.zerofill_cbk.fn = fn;
+        stub->args.zerofill_cbk.op_ret = op_ret;
+        stub->args.zerofill_cbk.op_errno = op_errno;
+        if (prebuf)
+                stub->args.zerofill_cbk.prebuf = *prebuf;
+        if (postbuf)
+                stub->args.zerofill_cbk.postbuf = *postbuf;
+out:
+        return stub;
+}
+
 static void
 call_resume_wind (call_stub_t *stub)
 {
@@ -2480,6 +2643,35 @@ call_resume_wind (call_stub_t *stub)
                                         stub->args.fsetattr.valid);
                 break;
         }
+        case GF_FOP_FALLOCATE:
+        {
+                stub->args.fallocate.fn (stub->frame,
+                                         stub->frame->this,
+                                         stub->args.fallocate.fd,
+                                         stub->args.fallocate.keep_size,
+                                         stub->args.fallocate.offset,
+                                         stub->args.fallocate.len);
+                break;
+        }
+        case GF_FOP_DISCARD:
+        {
+                stub->args.discard.fn (stub->frame,
+                                       stub->frame->this,
+                                       stub->args.discard.fd,
+                                       stub->args.discard.offset,
+                                       stub->args.discard.len);
+                break;
+        }
+        case GF_FOP_ZEROFILL:
+        {
+                stub->args.zerofill.fn (stub->frame,
+                                        stub->frame->this,
+                                        stub->args.zerofill.fd,
+                                        stub->args.zerofill.keep_size,
+                                        stub->args.zerofill.offset,
+                                        stub->args.zerofill.len);
+                break;
+        }
         default:
         {
                 gf_log_callingfn ("call-stub", GF_LOG_ERROR,
@@ -3274,6 +3466,63 @@ call_resume_unwind (call_stub_t *stub)
                                 &stub->args.fsetattr_cbk.statpost);
                 break;
         }
+        case GF_FOP_FALLOCATE:
+        {
+                if (!stub->args.fallocate_cbk.fn)
+                        STACK_UNWIND (stub->frame,
+                                      stub->args.fallocate_cbk.op_ret,
+                                      stub->args.fallocate_cbk.op_errno,
+                                      &stub->args.fallocate_cbk.prebuf,
+                                      &stub->args.fallocate_cbk.postbuf);
+                else
+                        stub->args.fallocate_cbk.fn (
+                                stub->frame,
+                                stub->frame->cookie,
+                                stub->frame->this,
+                                stub->args.fallocate_cbk.op_ret,
+                                stub->args.fallocate_cbk.op_errno,
+                                &stub->args.fallocate_cbk.prebuf,
+                                &stub->args.fallocate_cbk.postbuf);
+                break;
+        }
+        case GF_FOP_DISCARD:
+        {
+                if (!stub->args.discard_cbk.fn)
+                        STACK_UNWIND (stub->frame,
+                                      stub->args.discard_cbk.op_ret,
+                                      stub->args.discard_cbk.op_errno,
+                                      &stub->args.discard_cbk.prebuf,
+                                      &stub->args.discard_cbk.postbuf);
+                else
+                        stub->args.discard_cbk.fn (
+                                stub->frame,
+                                stub->frame->cookie,
+                                stub->frame->this,
+                                stub->args.discard_cbk.op_ret,
+                                stub->args.discard_cbk.op_errno,
+                                &stub->args.discard_cbk.prebuf,
+                                &stub->args.discard_cbk.postbuf);
+                break;
+        }
+        case GF_FOP_ZEROFILL:
+        {
+                if (!stub->args.zerofill_cbk.fn)
+                        STACK_UNWIND (stub->frame,
+                                      stub->args.zerofill_cbk.op_ret,
+                                      stub->args.zerofill_cbk.op_errno,
+                                      &stub->args.zerofill_cbk.prebuf,
+                                      &stub->args.zerofill_cbk.postbuf);
+                else
+                        stub->args.zerofill_cbk.fn (
+                                stub->frame,
+                                stub->frame->cookie,
+                                stub->frame->this,
+                                stub->args.zerofill_cbk.op_ret,
+                                stub->args.zerofill_cbk.op_errno,
+                                &stub->args.zerofill_cbk.prebuf,
+                                &stub->args.zerofill_cbk.postbuf);
+                break;
+        }
         default:
         {
                 gf_log_callingfn ("call-stub", GF_LOG_ERROR,
@@ -3586,6 +3835,24 @@ call_stub_destroy_wind (call_stub_t *stub)
                         fd_unref (stub->args.fsetattr.fd);
                 break;
         }
+        case GF_FOP_FALLOCATE:
+        {
+                if (stub->args.fallocate.fd)
+                        fd_unref (stub->args.fallocate.fd);
+                break;
+        }
+        case GF_FOP_DISCARD:
+        {
+                if (stub->args.discard.fd)
+                        fd_unref (stub->args.discard.fd);
+                break;
+        }
+        case GF_FOP_ZEROFILL:
+        {
+                if (stub->args.zerofill.fd)
+                        fd_unref (stub->args.zerofill.fd);
+                break;
+        }
         default:
         {
                 gf_log_callingfn ("call-stub", GF_LOG_ERROR,
@@ -3808,6 +4075,13 @@ call_stub_destroy_unwind (call_stub_t *stub)
                 break;
         }
 
+        case GF_FOP_FALLOCATE:
+        case GF_FOP_DISCARD:
+        case GF_FOP_ZEROFILL:
+        {
+                break;
+        }
+
         default:
         {
                 gf_log_callingfn ("call-stub", GF_LOG_ERROR,
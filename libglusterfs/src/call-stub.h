@@ -581,6 +581,53 @@ typedef struct {
                         struct iatt statpost;
                 } fsetattr_cbk;
 
+                /* fallocate */
+                struct {
+                        fop_fallocate_t fn;
+                        fd_t *fd;
+                        int32_t keep_size;
+                        off_t offset;
+                        size_t len;
+                } fallocate;
+                struct {
+                        fop_fallocate_cbk_t fn;
+                        int32_t op_ret;
+                        int32_t op_errno;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } fallocate_cbk;
+
+                /* discard */
+                struct {
+                        fop_discard_t fn;
+                        fd_t *fd;
+                        off_t offset;
+                        size_t len;
+                } discard;
+                struct {
+                        fop_discard_cbk_t fn;
+                        int32_t op_ret;
+                        int32_t op_errno;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } discard_cbk;
+
+                /* zerofill */
+                struct {
+                        fop_zerofill_t fn;
+                        fd_t *fd;
+                        int32_t keep_size;
+                        off_t offset;
+                        size_t len;
+                } zerofill;
+                struct {
+                        fop_zerofill_cbk_t fn;
+                        int32_t op_ret;
+                        int32_t op_errno;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } zerofill_cbk;
+
 	} args;
 } call_stub_t;
 
@@ -1111,6 +1158,53 @@ fop_fsetattr_cbk_stub (call_frame_t *frame,
                        struct iatt *statpre,
                        struct iatt *statpost);
 
+call_stub_t *
+fop_fallocate_stub (call_frame_t *frame,
+                    fop_fallocate_t fn,
+                    fd_t *fd,
+                    int32_t keep_size,
+                    off_t offset,
+                    size_t len);
+
+call_stub_t *
+fop_fallocate_cbk_stub (call_frame_t *frame,
+                        fop_fallocate_cbk_t fn,
+                        int32_t op_ret,
+                        int32_t op_errno,
+                        struct iatt *prebuf,
+                        struct iatt *postbuf);
+
+call_stub_t *
+fop_discard_stub (call_frame_t *frame,
+                  fop_discard_t fn,
+                  fd_t *fd,
+                  off_t offset,
+                  size_t len);
+
+call_stub_t *
+fop_discard_cbk_stub (call_frame_t *frame,
+                      fop_discard_cbk_t fn,
+                      int32_t op_ret,
+                      int32_t op_errno,
+                      struct iatt *prebuf,
+                      struct iatt *postbuf);
+
+call_stub_t *
+fop_zerofill_stub (call_frame_t *frame,
+                   fop_zerofill_t fn,
+                   fd_t *fd,
+                   int32_t keep_size,
+                   off_t offset,
+                   size_t len);
+
+call_stub_t *
+fop_zerofill_cbk_stub (call_frame_t *frame,
+                       fop_zerofill_cbk_t fn,
+                       int32_t op_ret,
+                       int32_t op_errno,
+                       struct iatt *prebuf,
+                       struct iatt *postbuf);
+
 void call_resume (call_stub_t *stub);
 void call_stub_destroy (call_stub_t *stub);
 #endif
@@ -1524,6 +1524,32 @@ get_checksum_for_file (int fd, uint32_t *checksum)
 }
 
 
+/* The checksum get_checksum_for_file() returns for a file holding the
+ * len bytes at data, without writing them out first.
+ */
+int
+get_checksum_for_buf (char *data, size_t len, uint32_t *checksum)
+{
+        char   buf[GF_CHECKSUM_BUF_SIZE] = {0,};
+        size_t off = 0;
+        size_t chunk = 0;
+
+        GF_ASSERT (checksum);
+
+        /* like read(2) into the same buffer, a short last chunk leaves
+           the tail of the one before it in place */
+        for (off = 0; off < len; off += chunk) {
+                chunk = len - off;
+                if (chunk > GF_CHECKSUM_BUF_SIZE)
+                        chunk = GF_CHECKSUM_BUF_SIZE;
+                memcpy (buf, data + off, chunk);
+                compute_checksum (buf, GF_CHECKSUM_BUF_SIZE, checksum);
+        }
+
+        return 0;
+}
+
+
 int
 get_checksum_for_path (char *path, uint32_t *checksum)
 {
@@ -366,6 +366,8 @@ int log_base2 (unsigned long x);
 
 int get_checksum_for_path (char *path, uint32_t *checksum);
 
+int get_checksum_for_buf (char *data, size_t len, uint32_t *checksum);
+
 char *strtail (char *str, const char *pattern);
 
 char valid_host_name (char *address, int length);
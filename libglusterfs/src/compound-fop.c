@@ -0,0 +1,391 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "compound-fop.h"
+#include "mem-types.h"
+
+typedef struct {
+        compound_args_t *args;
+        int              index;        /* op being run */
+        int              failed;
+        int32_t          op_errno;     /* of the first op which failed */
+} compound_local_t;
+
+
+compound_args_t *
+compound_args_new (void)
+{
+        compound_args_t *args = NULL;
+
+        args = GF_CALLOC (1, sizeof (*args), gf_common_mt_compound_args_t);
+
+        return args;
+}
+
+
+void
+compound_args_destroy (compound_args_t *args)
+{
+        compound_op_t  *op  = NULL;
+        compound_rsp_t *rsp = NULL;
+        int             i   = 0;
+
+        if (!args)
+                return;
+
+        for (i = 0; i < args->count; i++) {
+                op  = &args->ops[i];
+                rsp = &args->rsp[i];
+
+                loc_wipe (&op->loc);
+                if (op->fd)
+                        fd_unref (op->fd);
+                if (op->dict)
+                        dict_unref (op->dict);
+                if (op->volume)
+                        GF_FREE (op->volume);
+                if (op->basename)
+                        GF_FREE (op->basename);
+                if (op->name)
+                        GF_FREE (op->name);
+
+                if (rsp->dict)
+                        dict_unref (rsp->dict);
+        }
+
+        GF_FREE (args);
+}
+
+
+int
+compound_fop_supported (glusterfs_fop_t fop)
+{
+        switch (fop) {
+        case GF_FOP_STAT:
+        case GF_FOP_FSTAT:
+        case GF_FOP_SETXATTR:
+        case GF_FOP_FSETXATTR:
+        case GF_FOP_GETXATTR:
+        case GF_FOP_FGETXATTR:
+        case GF_FOP_XATTROP:
+        case GF_FOP_FXATTROP:
+        case GF_FOP_INODELK:
+        case GF_FOP_FINODELK:
+        case GF_FOP_ENTRYLK:
+        case GF_FOP_FENTRYLK:
+                return 1;
+        default:
+                return 0;
+        }
+}
+
+
+compound_op_t *
+compound_args_add (compound_args_t *args, glusterfs_fop_t fop,
+                   int32_t cflags)
+{
+        compound_op_t *op = NULL;
+
+        if (!args || (args->count == GF_COMPOUND_MAX_OPS) ||
+            !compound_fop_supported (fop))
+                goto out;
+
+        /* an op the compound never got to reports ECANCELED */
+        args->rsp[args->count].op_ret   = -1;
+        args->rsp[args->count].op_errno = ECANCELED;
+
+        op = &args->ops[args->count++];
+        op->fop    = fop;
+        op->cflags = cflags;
+out:
+        return op;
+}
+
+
+compound_op_t *
+compound_add_fxattrop (compound_args_t *args, int32_t cflags, fd_t *fd,
+                       gf_xattrop_flags_t optype, dict_t *dict)
+{
+        compound_op_t *op = NULL;
+
+        op = compound_args_add (args, GF_FOP_FXATTROP, cflags);
+        if (!op)
+                goto out;
+
+        op->fd     = fd_ref (fd);
+        op->optype = optype;
+        if (dict)
+                op->dict = dict_ref (dict);
+out:
+        return op;
+}
+
+
+compound_op_t *
+compound_add_xattrop (compound_args_t *args, int32_t cflags, loc_t *loc,
+                      gf_xattrop_flags_t optype, dict_t *dict)
+{
+        compound_op_t *op = NULL;
+
+        op = compound_args_add (args, GF_FOP_XATTROP, cflags);
+        if (!op)
+                goto out;
+
+        loc_copy (&op->loc, loc);
+        op->optype = optype;
+        if (dict)
+                op->dict = dict_ref (dict);
+out:
+        return op;
+}
+
+
+compound_op_t *
+compound_add_finodelk (compound_args_t *args, int32_t cflags,
+                       const char *volume, fd_t *fd, int32_t cmd,
+                       struct gf_flock *flock)
+{
+        compound_op_t *op = NULL;
+
+        op = compound_args_add (args, GF_FOP_FINODELK, cflags);
+        if (!op)
+                goto out;
+
+        op->volume = gf_strdup (volume);
+        op->fd     = fd_ref (fd);
+        op->cmd    = cmd;
+        op->flock  = *flock;
+out:
+        return op;
+}
+
+
+compound_op_t *
+compound_add_inodelk (compound_args_t *args, int32_t cflags,
+                      const char *volume, loc_t *loc, int32_t cmd,
+                      struct gf_flock *flock)
+{
+        compound_op_t *op = NULL;
+
+        op = compound_args_add (args, GF_FOP_INODELK, cflags);
+        if (!op)
+                goto out;
+
+        op->volume = gf_strdup (volume);
+        loc_copy (&op->loc, loc);
+        op->cmd    = cmd;
+        op->flock  = *flock;
+out:
+        return op;
+}
+
+
+static int
+compound_fop_next (call_frame_t *frame, xlator_t *this);
+
+
+static void
+compound_fop_op_done (call_frame_t *frame, xlator_t *this, int32_t op_ret,
+                      int32_t op_errno, struct iatt *stat, dict_t *dict)
+{
+        compound_local_t *local = NULL;
+        compound_rsp_t   *rsp   = NULL;
+
+        local = frame->local;
+        rsp   = &local->args->rsp[local->index];
+
+        rsp->op_ret   = op_ret;
+        rsp->op_errno = op_errno;
+        if (stat)
+                rsp->stat = *stat;
+        if (dict)
+                rsp->dict = dict_ref (dict);
+
+        if ((op_ret == -1) && !local->failed) {
+                local->failed   = 1;
+                local->op_errno = op_errno;
+        }
+
+        local->index++;
+        compound_fop_next (frame, this);
+}
+
+
+static int32_t
+compound_fop_stat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, struct iatt *buf)
+{
+        compound_fop_op_done (frame, this, op_ret, op_errno,
+                              (op_ret == 0) ? buf : NULL, NULL);
+        return 0;
+}
+
+
+static int32_t
+compound_fop_common_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                         int32_t op_ret, int32_t op_errno)
+{
+        compound_fop_op_done (frame, this, op_ret, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+static int32_t
+compound_fop_dict_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, dict_t *dict)
+{
+        compound_fop_op_done (frame, this, op_ret, op_errno, NULL,
+                              (op_ret >= 0) ? dict : NULL);
+        return 0;
+}
+
+
+static int
+compound_fop_next (call_frame_t *frame, xlator_t *this)
+{
+        compound_local_t *local    = NULL;
+        compound_args_t  *args     = NULL;
+        compound_op_t    *op       = NULL;
+        int32_t           op_ret   = 0;
+        int32_t           op_errno = 0;
+
+        local = frame->local;
+        args  = local->args;
+
+        while (local->index < args->count) {
+                op = &args->ops[local->index];
+                if (!local->failed || (op->cflags & GF_COMPOUND_ALWAYS))
+                        break;
+
+                args->rsp[local->index].op_ret   = -1;
+                args->rsp[local->index].op_errno = ECANCELED;
+                local->index++;
+        }
+
+        if (local->index == args->count) {
+                op_ret   = local->failed ? -1 : 0;
+                op_errno = local->op_errno;
+
+                frame->local = NULL;
+                GF_FREE (local);
+
+                STACK_UNWIND_STRICT (compound, frame, op_ret, op_errno, args);
+                return 0;
+        }
+
+        switch (op->fop) {
+        case GF_FOP_STAT:
+                STACK_WIND (frame, compound_fop_stat_cbk,
+                            this, this->fops->stat, &op->loc);
+                break;
+        case GF_FOP_FSTAT:
+                STACK_WIND (frame, compound_fop_stat_cbk,
+                            this, this->fops->fstat, op->fd);
+                break;
+        case GF_FOP_SETXATTR:
+                STACK_WIND (frame, compound_fop_common_cbk,
+                            this, this->fops->setxattr, &op->loc, op->dict,
+                            op->flags);
+                break;
+        case GF_FOP_FSETXATTR:
+                STACK_WIND (frame, compound_fop_common_cbk,
+                            this, this->fops->fsetxattr, op->fd, op->dict,
+                            op->flags);
+                break;
+        case GF_FOP_GETXATTR:
+                STACK_WIND (frame, compound_fop_dict_cbk,
+                            this, this->fops->getxattr, &op->loc, op->name);
+                break;
+        case GF_FOP_FGETXATTR:
+                STACK_WIND (frame, compound_fop_dict_cbk,
+                            this, this->fops->fgetxattr, op->fd, op->name);
+                break;
+        case GF_FOP_XATTROP:
+                STACK_WIND (frame, compound_fop_dict_cbk,
+                            this, this->fops->xattrop, &op->loc, op->optype,
+                            op->dict);
+                break;
+        case GF_FOP_FXATTROP:
+                STACK_WIND (frame, compound_fop_dict_cbk,
+                            this, this->fops->fxattrop, op->fd, op->optype,
+                            op->dict);
+                break;
+        case GF_FOP_INODELK:
+                STACK_WIND (frame, compound_fop_common_cbk,
+                            this, this->fops->inodelk, op->volume, &op->loc,
+                            op->cmd, &op->flock);
+                break;
+        case GF_FOP_FINODELK:
+                STACK_WIND (frame, compound_fop_common_cbk,
+                            this, this->fops->finodelk, op->volume, op->fd,
+                            op->cmd, &op->flock);
+                break;
+        case GF_FOP_ENTRYLK:
+                STACK_WIND (frame, compound_fop_common_cbk,
+                            this, this->fops->entrylk, op->volume, &op->loc,
+                            op->basename, op->entrylk_cmd, op->entrylk_type);
+                break;
+        case GF_FOP_FENTRYLK:
+                STACK_WIND (frame, compound_fop_common_cbk,
+                            this, this->fops->fentrylk, op->volume, op->fd,
+                            op->basename, op->entrylk_cmd, op->entrylk_type);
+                break;
+        default:
+                compound_fop_op_done (frame, this, -1, EOPNOTSUPP, NULL,
+                                      NULL);
+                break;
+        }
+
+        return 0;
+}
+
+
+/* Runs the ops of args one after the other as plain fops of this, and
+ * unwinds the compound once the last one returns. Used by translators
+ * which have no better way of handling the compound as a whole.
+ */
+int
+compound_fop_execute (call_frame_t *frame, xlator_t *this,
+                      compound_args_t *args)
+{
+        compound_local_t *local = NULL;
+
+        if (!args || !args->count) {
+                STACK_UNWIND_STRICT (compound, frame, -1, EINVAL, args);
+                goto out;
+        }
+
+        local = GF_CALLOC (1, sizeof (*local), gf_common_mt_compound_local_t);
+        if (!local) {
+                STACK_UNWIND_STRICT (compound, frame, -1, ENOMEM, args);
+                goto out;
+        }
+
+        local->args  = args;
+        frame->local = local;
+
+        compound_fop_next (frame, this);
+out:
+        return 0;
+}
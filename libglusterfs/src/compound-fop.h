@@ -0,0 +1,118 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _COMPOUND_FOP_H_
+#define _COMPOUND_FOP_H_
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "xlator.h"
+
+/* A compound carries an ordered list of fops on (usually) one inode and
+ * returns all their results at once. protocol/client sends it to the
+ * server in a single request, every other translator runs the ops one
+ * after the other through its own fops (see default_compound).
+ *
+ * Only fops without a data payload and without an fd to open are
+ * supported: stat, fstat, [f]setxattr, [f]getxattr, [f]xattrop,
+ * [f]inodelk and [f]entrylk.
+ */
+
+#define GF_COMPOUND_MAX_OPS     8
+
+/* Run the op even when an op before it failed (an unlock ending the
+ * compound, say). Any other op is skipped with ECANCELED once one has
+ * failed.
+ */
+#define GF_COMPOUND_ALWAYS      0x1
+
+typedef struct {
+        glusterfs_fop_t     fop;
+        int32_t             cflags;      /* GF_COMPOUND_* */
+        loc_t               loc;
+        fd_t               *fd;
+        char               *volume;      /* [f]inodelk, [f]entrylk */
+        char               *basename;    /* [f]entrylk */
+        char               *name;        /* [f]getxattr */
+        int32_t             cmd;         /* [f]inodelk */
+        struct gf_flock     flock;       /* [f]inodelk */
+        entrylk_cmd         entrylk_cmd;
+        entrylk_type        entrylk_type;
+        gf_xattrop_flags_t  optype;      /* [f]xattrop */
+        int32_t             flags;       /* [f]setxattr */
+        dict_t             *dict;        /* [f]setxattr, [f]xattrop */
+} compound_op_t;
+
+typedef struct {
+        int32_t             op_ret;
+        int32_t             op_errno;
+        struct iatt         stat;        /* stat, fstat */
+        dict_t             *dict;        /* [f]getxattr, [f]xattrop */
+} compound_rsp_t;
+
+struct _compound_args {
+        int                 count;
+        compound_op_t       ops[GF_COMPOUND_MAX_OPS];
+        compound_rsp_t      rsp[GF_COMPOUND_MAX_OPS];
+};
+
+compound_args_t *
+compound_args_new (void);
+
+void
+compound_args_destroy (compound_args_t *args);
+
+int
+compound_fop_supported (glusterfs_fop_t fop);
+
+/* Appends an op to args, the caller fills in its arguments taking a ref
+ * on whatever it stores (loc_copy, fd_ref, dict_ref, gf_strdup), they
+ * are released by compound_args_destroy. Returns NULL when args is full.
+ * The result of the op reads -1/ECANCELED until the op has been run.
+ */
+compound_op_t *
+compound_args_add (compound_args_t *args, glusterfs_fop_t fop,
+                   int32_t cflags);
+
+compound_op_t *
+compound_add_fxattrop (compound_args_t *args, int32_t cflags, fd_t *fd,
+                       gf_xattrop_flags_t optype, dict_t *dict);
+
+compound_op_t *
+compound_add_xattrop (compound_args_t *args, int32_t cflags, loc_t *loc,
+                      gf_xattrop_flags_t optype, dict_t *dict);
+
+compound_op_t *
+compound_add_finodelk (compound_args_t *args, int32_t cflags,
+                       const char *volume, fd_t *fd, int32_t cmd,
+                       struct gf_flock *flock);
+
+compound_op_t *
+compound_add_inodelk (compound_args_t *args, int32_t cflags,
+                      const char *volume, loc_t *loc, int32_t cmd,
+                      struct gf_flock *flock);
+
+int
+compound_fop_execute (call_frame_t *frame, xlator_t *this,
+                      compound_args_t *args);
+
+#endif /* _COMPOUND_FOP_H_ */
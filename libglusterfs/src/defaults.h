@@ -246,6 +246,30 @@ int32_t default_fsetattr (call_frame_t *frame,
                           struct iatt *stbuf,
                           int32_t valid);
 
+int32_t default_fallocate (call_frame_t *frame,
+                           xlator_t *this,
+                           fd_t *fd,
+                           int32_t keep_size,
+                           off_t offset,
+                           size_t len);
+
+int32_t default_discard (call_frame_t *frame,
+                         xlator_t *this,
+                         fd_t *fd,
+                         off_t offset,
+                         size_t len);
+
+int32_t default_zerofill (call_frame_t *frame,
+                          xlator_t *this,
+                          fd_t *fd,
+                          int32_t keep_size,
+                          off_t offset,
+                          size_t len);
+
+int32_t default_compound (call_frame_t *frame,
+                          xlator_t *this,
+                          compound_args_t *args);
+
 /* Resume */
 int32_t default_getspec (call_frame_t *frame,
                          xlator_t *this,
@@ -464,6 +488,26 @@ int32_t default_fsetattr_resume (call_frame_t *frame,
                           struct iatt *stbuf,
                           int32_t valid);
 
+int32_t default_fallocate_resume (call_frame_t *frame,
+                                  xlator_t *this,
+                                  fd_t *fd,
+                                  int32_t keep_size,
+                                  off_t offset,
+                                  size_t len);
+
+int32_t default_discard_resume (call_frame_t *frame,
+                                xlator_t *this,
+                                fd_t *fd,
+                                off_t offset,
+                                size_t len);
+
+int32_t default_zerofill_resume (call_frame_t *frame,
+                                 xlator_t *this,
+                                 fd_t *fd,
+                                 int32_t keep_size,
+                                 off_t offset,
+                                 size_t len);
+
 /* _cbk */
 
 int32_t
@@ -674,6 +718,26 @@ int32_t
 default_getspec_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                      int32_t op_ret, int32_t op_errno, char *spec_data);
 
+int32_t
+default_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                       struct iatt *postbuf);
+
+int32_t
+default_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                     struct iatt *postbuf);
+
+int32_t
+default_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                      struct iatt *postbuf);
+
+int32_t
+default_compound_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno,
+                      compound_args_t *args);
+
 int32_t
 default_mem_acct_init (xlator_t *this);
 
@@ -58,11 +58,25 @@ inode_table_prune (inode_table_t *table);
 void
 fd_dump (struct list_head *head, char *prefix);
 
-static int
-hash_dentry (inode_t *parent, const char *name, int mod)
+/* the bucket arrays are power of two sized and indexed by the low bits,
+   so spread the input over all of them */
+static uint32_t
+hash_mix (uint32_t hash)
 {
-        int hash = 0;
-        int ret = 0;
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6b;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35;
+        hash ^= hash >> 16;
+
+        return hash;
+}
+
+
+static uint32_t
+hash_dentry (inode_t *parent, const char *name)
+{
+        uint32_t hash = 0;
 
         hash = *name;
         if (hash) {
@@ -70,20 +84,260 @@ hash_dentry (inode_t *parent, const char *name, int mod)
                         hash = (hash << 5) - hash + *name;
                 }
         }
-        ret = (hash + (unsigned long)parent) % mod;
 
-        return ret;
+        return hash_mix (hash + (unsigned long)parent);
+}
+
+
+static uint32_t
+hash_gfid (uuid_t uuid)
+{
+        uint32_t hash = 0;
+
+        hash = uuid[15] + (uuid[14] << 8) + (uuid[13] << 16) +
+                ((uint32_t)uuid[12] << 24);
+
+        return hash_mix (hash);
+}
+
+
+#define INODE_HASH_LOCK(table, hash)                                    \
+        (&(table)->hash_lock[(hash) % INODE_TABLE_LOCK_STRIPES])
+
+#define INODE_HASH_BUCKET(ihash, hash)                                  \
+        (&(ihash)->buckets[(hash) & ((ihash)->size - 1)])
+
+#define INODE_HASH_OLD_BUCKET(ihash, hash)                              \
+        (&(ihash)->old_buckets[(hash) & ((ihash)->old_size - 1)])
+
+
+static uint32_t
+inode_hash_entry (struct list_head *entry)
+{
+        inode_t *inode = NULL;
+
+        inode = list_entry (entry, inode_t, hash);
+
+        return hash_gfid (inode->gfid);
+}
+
+
+static uint32_t
+dentry_hash_entry (struct list_head *entry)
+{
+        dentry_t *dentry = NULL;
+
+        dentry = list_entry (entry, dentry_t, hash);
+
+        return hash_dentry (dentry->parent, dentry->name);
 }
 
 
+static struct list_head *
+inode_hash_buckets_new (uint32_t size)
+{
+        struct list_head *buckets = NULL;
+        uint32_t          i = 0;
+
+        buckets = GF_CALLOC (size, sizeof (struct list_head),
+                             gf_common_mt_list_head);
+        if (!buckets)
+                return NULL;
+
+        for (i = 0; i < size; i++) {
+                INIT_LIST_HEAD (&buckets[i]);
+        }
+
+        return buckets;
+}
+
+
+static void
+__inode_table_lock_stripes (inode_table_t *table)
+{
+        int i = 0;
+
+        for (i = 0; i < INODE_TABLE_LOCK_STRIPES; i++)
+                LOCK (&table->hash_lock[i]);
+}
+
+
+static void
+__inode_table_unlock_stripes (inode_table_t *table)
+{
+        int i = 0;
+
+        for (i = INODE_TABLE_LOCK_STRIPES - 1; i >= 0; i--)
+                UNLOCK (&table->hash_lock[i]);
+}
+
+
+/* move the next few buckets of a draining array into the current one,
+   and drop the old array once it is empty. Only the stripe of the
+   bucket being moved is held, lookups elsewhere carry on. */
+static void
+__inode_hash_rehash_step (inode_table_t *table, struct _inode_hash *ihash,
+                          uint32_t (*hashfn) (struct list_head *entry))
+{
+        struct list_head *old = NULL;
+        struct list_head *entry = NULL;
+        uint32_t          idx = 0;
+        int               step = 0;
+
+        if (!ihash->old_buckets)
+                return;
+
+        for (step = 0; (step < INODE_REHASH_STEP) &&
+                     (ihash->rehash_idx < ihash->old_size); step++) {
+                idx = ihash->rehash_idx++;
+                old = &ihash->old_buckets[idx];
+
+                LOCK (INODE_HASH_LOCK (table, idx));
+                {
+                        while (!list_empty (old)) {
+                                entry = old->next;
+                                list_move (entry,
+                                           INODE_HASH_BUCKET (ihash,
+                                                              hashfn (entry)));
+                        }
+                }
+                UNLOCK (INODE_HASH_LOCK (table, idx));
+        }
+
+        if (ihash->rehash_idx < ihash->old_size)
+                return;
+
+        __inode_table_lock_stripes (table);
+        {
+                old = ihash->old_buckets;
+                ihash->old_buckets = NULL;
+                ihash->old_size = 0;
+                ihash->rehash_idx = 0;
+        }
+        __inode_table_unlock_stripes (table);
+
+        GF_FREE (old);
+}
+
+
+/* start doubling the hash once it is loaded past INODE_HASH_LOAD_FACTOR.
+   Only the pointer swap is done with all stripes held, the entries are
+   moved later by __inode_hash_rehash_step(). */
+static void
+__inode_hash_grow (inode_table_t *table, struct _inode_hash *ihash,
+                   uint32_t count)
+{
+        struct list_head *buckets = NULL;
+
+        if (ihash->old_buckets || (ihash->size >= INODE_HASH_MAX_SIZE))
+                return;
+
+        if (count <= ihash->size * INODE_HASH_LOAD_FACTOR)
+                return;
+
+        buckets = inode_hash_buckets_new (ihash->size * 2);
+        if (!buckets) {
+                /* not fatal, chains just get longer */
+                gf_log (THIS->name, GF_LOG_DEBUG,
+                        "%s: could not grow hash from %u buckets",
+                        table->name, ihash->size);
+                return;
+        }
+
+        __inode_table_lock_stripes (table);
+        {
+                ihash->old_buckets = ihash->buckets;
+                ihash->old_size = ihash->size;
+                ihash->rehash_idx = 0;
+                ihash->buckets = buckets;
+                ihash->size *= 2;
+        }
+        __inode_table_unlock_stripes (table);
+
+        gf_log (THIS->name, GF_LOG_DEBUG, "%s: growing hash to %u buckets",
+                table->name, ihash->size);
+}
+
+
+static void
+__inode_hash_insert (inode_table_t *table, struct _inode_hash *ihash,
+                     uint32_t (*hashfn) (struct list_head *entry),
+                     struct list_head *entry)
+{
+        uint32_t hash = 0;
+
+        __inode_hash_grow (table, ihash,
+                           table->active_size + table->lru_size);
+        __inode_hash_rehash_step (table, ihash, hashfn);
+
+        hash = hashfn (entry);
+
+        LOCK (INODE_HASH_LOCK (table, hash));
+        {
+                list_del_init (entry);
+                list_add (entry, INODE_HASH_BUCKET (ihash, hash));
+        }
+        UNLOCK (INODE_HASH_LOCK (table, hash));
+}
+
+
+static void
+__inode_hash_remove (inode_table_t *table,
+                     uint32_t (*hashfn) (struct list_head *entry),
+                     struct list_head *entry)
+{
+        uint32_t hash = 0;
+
+        if (list_empty (entry))
+                return;
+
+        /* the entry may still sit in the old array, list_del does not
+           care, and the stripe is the same either way */
+        hash = hashfn (entry);
+
+        LOCK (INODE_HASH_LOCK (table, hash));
+        {
+                list_del_init (entry);
+        }
+        UNLOCK (INODE_HASH_LOCK (table, hash));
+}
+
+
+/* take a reference only if the inode already holds one. The 0 -> 1
+   transition moves the inode off the lru list and needs table->lock,
+   every other change of ->ref is a plain atomic update. */
 static int
-hash_gfid (uuid_t uuid, int mod)
+__inode_ref_if_active (inode_t *inode)
 {
-        int ret = 0;
+        uint32_t ref = 0;
 
-        ret = uuid[15] + (uuid[14] << 8);
+        do {
+                ref = inode->ref;
+                if (!ref)
+                        return 0;
+        } while (!__sync_bool_compare_and_swap (&inode->ref, ref, ref + 1));
 
-        return ret;
+        return 1;
+}
+
+
+/* drop a reference unless it is the last one, which again needs
+   table->lock to passivate or retire the inode. */
+static int
+__inode_unref_if_not_last (inode_t *inode)
+{
+        uint32_t ref = 0;
+
+        if (inode->ino == 1)
+                return 1;
+
+        do {
+                ref = inode->ref;
+                if (ref <= 1)
+                        return 0;
+        } while (!__sync_bool_compare_and_swap (&inode->ref, ref, ref - 1));
+
+        return 1;
 }
 
 
@@ -91,7 +345,6 @@ static void
 __dentry_hash (dentry_t *dentry)
 {
         inode_table_t   *table = NULL;
-        int              hash = 0;
 
         if (!dentry) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "dentry not found");
@@ -99,11 +352,9 @@ __dentry_hash (dentry_t *dentry)
         }
 
         table = dentry->inode->table;
-        hash = hash_dentry (dentry->parent, dentry->name,
-                            table->hashsize);
 
-        list_del_init (&dentry->hash);
-        list_add (&dentry->hash, &table->name_hash[hash]);
+        __inode_hash_insert (table, &table->name_hash, dentry_hash_entry,
+                             &dentry->hash);
 }
 
 
@@ -127,7 +378,8 @@ __dentry_unhash (dentry_t *dentry)
                 return;
         }
 
-        list_del_init (&dentry->hash);
+        __inode_hash_remove (dentry->inode->table, dentry_hash_entry,
+                             &dentry->hash);
 }
 
 
@@ -244,7 +496,7 @@ __inode_unhash (inode_t *inode)
                 return;
         }
 
-        list_del_init (&inode->hash);
+        __inode_hash_remove (inode->table, inode_hash_entry, &inode->hash);
 }
 
 
@@ -264,7 +516,6 @@ static void
 __inode_hash (inode_t *inode)
 {
         inode_table_t *table = NULL;
-        int            hash = 0;
 
         if (!inode) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "inode not found");
@@ -272,10 +523,9 @@ __inode_hash (inode_t *inode)
         }
 
         table = inode->table;
-        hash = hash_gfid (inode->gfid, 65536);
 
-        list_del_init (&inode->hash);
-        list_add (&inode->hash, &table->inode_hash[hash]);
+        __inode_hash_insert (table, &table->inode_hash, inode_hash_entry,
+                             &inode->hash);
 }
 
 
@@ -407,9 +657,7 @@ __inode_unref (inode_t *inode)
 
         GF_ASSERT (inode->ref);
 
-        --inode->ref;
-
-        if (!inode->ref) {
+        if (!__sync_sub_and_fetch (&inode->ref, 1)) {
                 inode->table->active_size--;
 
                 if (inode->nlookup)
@@ -428,11 +676,12 @@ __inode_ref (inode_t *inode)
         if (!inode)
                 return NULL;
 
+        /* with table->lock held nobody else can move ->ref away from 0 */
         if (!inode->ref) {
                 inode->table->lru_size--;
                 __inode_activate (inode);
         }
-        inode->ref++;
+        __sync_add_and_fetch (&inode->ref, 1);
 
         return inode;
 }
@@ -446,6 +695,9 @@ inode_unref (inode_t *inode)
         if (!inode)
                 return NULL;
 
+        if (__inode_unref_if_not_last (inode))
+                return inode;
+
         table = inode->table;
 
         pthread_mutex_lock (&table->lock);
@@ -468,6 +720,9 @@ inode_ref (inode_t *inode)
         if (!inode)
                 return NULL;
 
+        if (__inode_ref_if_active (inode))
+                return inode;
+
         table = inode->table;
 
         pthread_mutex_lock (&table->lock);
@@ -613,19 +868,14 @@ __inode_forget (inode_t *inode, uint64_t nlookup)
 }
 
 
-dentry_t *
-__dentry_grep (inode_table_t *table, inode_t *parent, const char *name)
+static dentry_t *
+__dentry_grep_chain (struct list_head *chain, inode_t *parent,
+                     const char *name)
 {
-        int       hash = 0;
         dentry_t *dentry = NULL;
         dentry_t *tmp = NULL;
 
-        if (!table || !name || !parent)
-                return NULL;
-
-        hash = hash_dentry (parent, name, table->hashsize);
-
-        list_for_each_entry (tmp, &table->name_hash[hash], hash) {
+        list_for_each_entry (tmp, chain, hash) {
                 if (tmp->parent == parent && !strcmp (tmp->name, name)) {
                         dentry = tmp;
                         break;
@@ -636,11 +886,45 @@ __dentry_grep (inode_table_t *table, inode_t *parent, const char *name)
 }
 
 
+static dentry_t *
+__dentry_grep_bucket (inode_table_t *table, uint32_t hash, inode_t *parent,
+                      const char *name)
+{
+        struct _inode_hash *ihash = &table->name_hash;
+        dentry_t           *dentry = NULL;
+
+        dentry = __dentry_grep_chain (INODE_HASH_BUCKET (ihash, hash),
+                                      parent, name);
+        if (!dentry && ihash->old_buckets)
+                dentry = __dentry_grep_chain (INODE_HASH_OLD_BUCKET (ihash,
+                                                                     hash),
+                                              parent, name);
+
+        return dentry;
+}
+
+
+dentry_t *
+__dentry_grep (inode_table_t *table, inode_t *parent, const char *name)
+{
+        uint32_t  hash = 0;
+
+        if (!table || !name || !parent)
+                return NULL;
+
+        hash = hash_dentry (parent, name);
+
+        return __dentry_grep_bucket (table, hash, parent, name);
+}
+
+
 inode_t *
 inode_grep (inode_table_t *table, inode_t *parent, const char *name)
 {
         inode_t   *inode = NULL;
         dentry_t  *dentry = NULL;
+        uint32_t   hash = 0;
+        int        found = 0;
 
         if (!table || !parent || !name) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING,
@@ -648,6 +932,26 @@ inode_grep (inode_table_t *table, inode_t *parent, const char *name)
                 return NULL;
         }
 
+        /* fast path: a hashed dentry cannot be freed while its chain is
+           locked, so an active inode can be referenced right here */
+        hash = hash_dentry (parent, name);
+
+        LOCK (INODE_HASH_LOCK (table, hash));
+        {
+                dentry = __dentry_grep_bucket (table, hash, parent, name);
+                if (dentry) {
+                        inode = dentry->inode;
+                        found = __inode_ref_if_active (inode);
+                }
+        }
+        UNLOCK (INODE_HASH_LOCK (table, hash));
+
+        if (!dentry || found)
+                return inode;
+
+        inode = NULL;
+        dentry = NULL;
+
         pthread_mutex_lock (&table->lock);
         {
                 dentry = __dentry_grep (table, parent, name);
@@ -678,12 +982,44 @@ __is_root_gfid (uuid_t gfid)
 }
 
 
+static inode_t *
+__inode_find_chain (struct list_head *chain, uuid_t gfid)
+{
+        inode_t   *inode = NULL;
+        inode_t   *tmp = NULL;
+
+        list_for_each_entry (tmp, chain, hash) {
+                if (uuid_compare (tmp->gfid, gfid) == 0) {
+                        inode = tmp;
+                        break;
+                }
+        }
+
+        return inode;
+}
+
+
+static inode_t *
+__inode_find_bucket (inode_table_t *table, uint32_t hash, uuid_t gfid)
+{
+        struct _inode_hash *ihash = &table->inode_hash;
+        inode_t            *inode = NULL;
+
+        inode = __inode_find_chain (INODE_HASH_BUCKET (ihash, hash), gfid);
+        if (!inode && ihash->old_buckets)
+                inode = __inode_find_chain (INODE_HASH_OLD_BUCKET (ihash,
+                                                                   hash),
+                                            gfid);
+
+        return inode;
+}
+
+
 inode_t *
 __inode_find (inode_table_t *table, uuid_t gfid)
 {
         inode_t   *inode = NULL;
-        inode_t   *tmp = NULL;
-        int        hash = 0;
+        uint32_t   hash = 0;
 
         if (!table) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "table not found");
@@ -693,14 +1029,9 @@ __inode_find (inode_table_t *table, uuid_t gfid)
         if (__is_root_gfid (gfid) == 0)
                 return table->root;
 
-        hash = hash_gfid (gfid, 65536);
+        hash = hash_gfid (gfid);
 
-        list_for_each_entry (tmp, &table->inode_hash[hash], hash) {
-                if (uuid_compare (tmp->gfid, gfid) == 0) {
-                        inode = tmp;
-                        break;
-                }
-        }
+        inode = __inode_find_bucket (table, hash, gfid);
 
 out:
         return inode;
@@ -711,12 +1042,38 @@ inode_t *
 inode_find (inode_table_t *table, uuid_t gfid)
 {
         inode_t   *inode = NULL;
+        uint32_t   hash = 0;
+        int        found = 0;
 
         if (!table) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "table not found");
                 return NULL;
         }
 
+        if (__is_root_gfid (gfid) == 0) {
+                inode = table->root;
+                found = __inode_ref_if_active (inode);
+        } else {
+                /* fast path, see inode_grep() */
+                hash = hash_gfid (gfid);
+
+                LOCK (INODE_HASH_LOCK (table, hash));
+                {
+                        inode = __inode_find_bucket (table, hash, gfid);
+                        if (inode)
+                                found = __inode_ref_if_active (inode);
+                }
+                UNLOCK (INODE_HASH_LOCK (table, hash));
+
+                if (!inode)
+                        return NULL;
+        }
+
+        if (found)
+                return inode;
+
+        inode = NULL;
+
         pthread_mutex_lock (&table->lock);
         {
                 inode = __inode_find (table, gfid);
@@ -997,15 +1354,19 @@ inode_parent (inode_t *inode, ino_t par, const char *name)
 }
 
 
-int
-__inode_path (inode_t *inode, const char *name, char **bufp)
+static int
+__inode_path_anchor (inode_t *inode, const char *name, char **bufp,
+                     gf_boolean_t anchor)
 {
-        inode_table_t *table = NULL;
-        dentry_t      *trav  = NULL;
-        size_t         i     = 0, size = 0;
-        int64_t        ret   = 0;
-        int            len   = 0;
-        char          *buf   = NULL;
+        inode_table_t *table    = NULL;
+        dentry_t      *trav     = NULL;
+        inode_t       *top      = NULL;
+        size_t         i        = 0, size = 0;
+        int64_t        ret      = 0;
+        int            len      = 0;
+        char          *buf      = NULL;
+        gf_boolean_t   anchored = _gf_false;
+        char           gfid_path[INODE_GFID_PATH_LEN + 1];
 
         if (!inode) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "inode not found");
@@ -1014,6 +1375,7 @@ __inode_path (inode_t *inode, const char *name, char **bufp)
 
         table = inode->table;
 
+        top = inode;
         for (trav = __dentry_search_arbit (inode); trav;
              trav = __dentry_search_arbit (trav->parent)) {
                 i ++; /* "/" */
@@ -1025,10 +1387,17 @@ __inode_path (inode_t *inode, const char *name, char **bufp)
                         ret = -ENOENT;
                         goto out;
                 }
+                top = trav->parent;
         }
 
-        if ((inode->ino != 1) &&
-            (i == 0)) {
+        if ((top->ino != 1) && anchor && !uuid_is_null (top->gfid)) {
+                /* the dentry chain stops short of the root at an inode
+                   linked by a nameless (gfid) lookup, anchor the path
+                   on its gfid */
+                anchored = _gf_true;
+                i += INODE_GFID_PATH_LEN;
+        } else if ((inode->ino != 1) &&
+                   (i == 0)) {
                 gf_log (table->name, GF_LOG_WARNING,
                         "no dentry for non-root inode %"PRId64": %s",
                         inode->ino, uuid_utoa (inode->gfid));
@@ -1062,6 +1431,13 @@ __inode_path (inode_t *inode, const char *name, char **bufp)
                         buf[i-len-1] = '/';
                         i -= (len + 1);
                 }
+
+                if (anchored) {
+                        snprintf (gfid_path, sizeof (gfid_path),
+                                  INODE_GFID_PATH_PREFIX "%s>",
+                                  uuid_utoa (top->gfid));
+                        memcpy (buf, gfid_path, INODE_GFID_PATH_LEN);
+                }
                 *bufp = buf;
         } else {
                 ret = -ENOMEM;
@@ -1086,6 +1462,13 @@ out:
 }
 
 
+int
+__inode_path (inode_t *inode, const char *name, char **bufp)
+{
+        return __inode_path_anchor (inode, name, bufp, _gf_false);
+}
+
+
 int
 inode_path (inode_t *inode, const char *name, char **bufp)
 {
@@ -1107,6 +1490,31 @@ inode_path (inode_t *inode, const char *name, char **bufp)
 }
 
 
+/* inode_path(), except that a dentry chain stopping short of the root at
+   an inode linked by gfid alone yields a path anchored on that gfid
+   instead of failing. For the callers that link inodes by nameless
+   lookups, no other path consumer has to know about anchors. */
+int
+inode_anchored_path (inode_t *inode, const char *name, char **bufp)
+{
+        inode_table_t *table = NULL;
+        int            ret   = -1;
+
+        if (!inode)
+                return -1;
+
+        table = inode->table;
+
+        pthread_mutex_lock (&table->lock);
+        {
+                ret = __inode_path_anchor (inode, name, bufp, _gf_true);
+        }
+        pthread_mutex_unlock (&table->lock);
+
+        return ret;
+}
+
+
 static int
 inode_table_prune (inode_table_t *table)
 {
@@ -1121,6 +1529,14 @@ inode_table_prune (inode_table_t *table)
 
         INIT_LIST_HEAD (&purge);
 
+        /* unlocked peek: let the lru overshoot by a batch before taking
+           table->lock, so unrefs don't all serialize here. A stale read
+           only delays the prune to the next call. */
+        if (!table->purge_size && (!table->lru_limit ||
+                                   (table->lru_size <= table->lru_limit +
+                                    INODE_LRU_PRUNE_BATCH)))
+                return 0;
+
         pthread_mutex_lock (&table->lock);
         {
                 while (table->lru_limit
@@ -1186,8 +1602,6 @@ inode_table_new (size_t lru_limit, xlator_t *xl)
 
         new->lru_limit = lru_limit;
 
-        new->hashsize = 14057; /* TODO: Random Number?? */
-
         /* In case FUSE is initing the inode table. */
         if (lru_limit == 0)
                 lru_limit = DEFAULT_INODE_MEMPOOL_ENTRIES;
@@ -1202,16 +1616,14 @@ inode_table_new (size_t lru_limit, xlator_t *xl)
         if (!new->dentry_pool)
                 goto out;
 
-        new->inode_hash = (void *)GF_CALLOC (65536,
-                                             sizeof (struct list_head),
-                                             gf_common_mt_list_head);
-        if (!new->inode_hash)
+        new->inode_hash.size = INODE_HASH_INIT_SIZE;
+        new->inode_hash.buckets = inode_hash_buckets_new (INODE_HASH_INIT_SIZE);
+        if (!new->inode_hash.buckets)
                 goto out;
 
-        new->name_hash = (void *)GF_CALLOC (new->hashsize,
-                                            sizeof (struct list_head),
-                                            gf_common_mt_list_head);
-        if (!new->name_hash)
+        new->name_hash.size = DENTRY_HASH_INIT_SIZE;
+        new->name_hash.buckets = inode_hash_buckets_new (DENTRY_HASH_INIT_SIZE);
+        if (!new->name_hash.buckets)
                 goto out;
 
         new->fd_mem_pool = mem_pool_new (fd_t, 16384);
@@ -1219,19 +1631,14 @@ inode_table_new (size_t lru_limit, xlator_t *xl)
         if (!new->fd_mem_pool)
                 goto out;
 
-        for (i = 0; i < 65536; i++) {
-                INIT_LIST_HEAD (&new->inode_hash[i]);
-        }
-
-
-        for (i = 0; i < new->hashsize; i++) {
-                INIT_LIST_HEAD (&new->name_hash[i]);
-        }
-
         INIT_LIST_HEAD (&new->active);
         INIT_LIST_HEAD (&new->lru);
         INIT_LIST_HEAD (&new->purge);
 
+        for (i = 0; i < INODE_TABLE_LOCK_STRIPES; i++) {
+                LOCK_INIT (&new->hash_lock[i]);
+        }
+
         ret = gf_asprintf (&new->name, "%s/inode", xl->name);
         if (-1 == ret) {
                 /* TODO: This should be ok to continue, check with avati */
@@ -1246,10 +1653,10 @@ inode_table_new (size_t lru_limit, xlator_t *xl)
 out:
         if (ret) {
                 if (new) {
-                        if (new->inode_hash)
-                                GF_FREE (new->inode_hash);
-                        if (new->name_hash)
-                                GF_FREE (new->name_hash);
+                        if (new->inode_hash.buckets)
+                                GF_FREE (new->inode_hash.buckets);
+                        if (new->name_hash.buckets)
+                                GF_FREE (new->name_hash.buckets);
                         if (new->dentry_pool)
                                 mem_pool_destroy (new->dentry_pool);
                         if (new->inode_pool)
@@ -1600,6 +2007,62 @@ unlock:
         return;
 }
 
+static void
+inode_hash_chain_stats (struct list_head *buckets, uint32_t size,
+                        uint64_t *entries, uint32_t *used, uint32_t *longest)
+{
+        struct list_head *pos = NULL;
+        uint32_t          chain = 0;
+        uint32_t          i = 0;
+
+        for (i = 0; i < size; i++) {
+                chain = 0;
+                list_for_each (pos, &buckets[i])
+                        chain++;
+
+                if (!chain)
+                        continue;
+
+                (*used)++;
+                *entries += chain;
+                if (chain > *longest)
+                        *longest = chain;
+        }
+}
+
+
+static void
+inode_hash_dump (struct _inode_hash *ihash, char *key, char *prefix,
+                 char *name)
+{
+        uint64_t entries = 0;
+        uint32_t used = 0;
+        uint32_t longest = 0;
+
+        inode_hash_chain_stats (ihash->buckets, ihash->size, &entries,
+                                &used, &longest);
+        if (ihash->old_buckets)
+                inode_hash_chain_stats (ihash->old_buckets, ihash->old_size,
+                                        &entries, &used, &longest);
+
+        gf_proc_dump_build_key(key, prefix, "%s.size", name);
+        gf_proc_dump_write(key, "%u", ihash->size);
+        if (ihash->old_buckets) {
+                gf_proc_dump_build_key(key, prefix, "%s.rehash", name);
+                gf_proc_dump_write(key, "%u/%u", ihash->rehash_idx,
+                                   ihash->old_size);
+        }
+        gf_proc_dump_build_key(key, prefix, "%s.entries", name);
+        gf_proc_dump_write(key, "%"PRIu64, entries);
+        gf_proc_dump_build_key(key, prefix, "%s.used_buckets", name);
+        gf_proc_dump_write(key, "%u", used);
+        gf_proc_dump_build_key(key, prefix, "%s.max_chain", name);
+        gf_proc_dump_write(key, "%u", longest);
+        gf_proc_dump_build_key(key, prefix, "%s.avg_chain", name);
+        gf_proc_dump_write(key, "%.2f", used ? (double)entries / used : 0.0);
+}
+
+
 void
 inode_table_dump (inode_table_t *itable, char *prefix)
 {
@@ -1617,8 +2080,6 @@ inode_table_dump (inode_table_t *itable, char *prefix)
                 return;
         }
 
-        gf_proc_dump_build_key(key, prefix, "hashsize");
-        gf_proc_dump_write(key, "%d", itable->hashsize);
         gf_proc_dump_build_key(key, prefix, "name");
         gf_proc_dump_write(key, "%s", itable->name);
 
@@ -1630,6 +2091,12 @@ inode_table_dump (inode_table_t *itable, char *prefix)
         gf_proc_dump_write(key, "%d", itable->lru_size);
         gf_proc_dump_build_key(key, prefix, "purge_size");
         gf_proc_dump_write(key, "%d", itable->purge_size);
+        gf_proc_dump_build_key(key, prefix, "lock_stripes");
+        gf_proc_dump_write(key, "%d", INODE_TABLE_LOCK_STRIPES);
+
+        /* the hashes only change under itable->lock, which is held */
+        inode_hash_dump (&itable->inode_hash, key, prefix, "inode_hash");
+        inode_hash_dump (&itable->name_hash, key, prefix, "name_hash");
 
         INODE_DUMP_LIST(&itable->active, key, prefix, "active");
         INODE_DUMP_LIST(&itable->lru, key, prefix, "lru");
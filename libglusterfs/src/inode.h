@@ -29,6 +29,18 @@
 #include <sys/types.h>
 
 #define DEFAULT_INODE_MEMPOOL_ENTRIES   16384
+#define INODE_TABLE_LOCK_STRIPES        256   /* locks over the hash chains */
+#define INODE_LRU_PRUNE_BATCH           64    /* lru overshoot before pruning */
+#define INODE_HASH_INIT_SIZE            65536 /* buckets, gfid hash */
+#define DENTRY_HASH_INIT_SIZE           16384 /* buckets, name hash */
+#define INODE_HASH_MAX_SIZE             (1 << 24) /* buckets, per hash */
+#define INODE_HASH_LOAD_FACTOR          2     /* entries per bucket to grow at */
+#define INODE_REHASH_STEP               16    /* buckets moved per insert */
+
+/* inode_anchored_path() of an inode linked by gfid alone, without a dentry
+   chain up to the root: "<gfid:xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx>[/name]" */
+#define INODE_GFID_PATH_PREFIX          "<gfid:"
+#define INODE_GFID_PATH_LEN             43    /* "<gfid:" + 36 + ">" */
 struct _inode_table;
 typedef struct _inode_table inode_table_t;
 
@@ -44,15 +56,33 @@ typedef struct _dentry dentry_t;
 #include "uuid.h"
 
 
+/* a chained hash which doubles in size without a stop-the-world rehash:
+   after a resize the old bucket array is drained a few buckets at a
+   time by later inserts, and lookups check both arrays until it is
+   gone. Sizes are powers of two of at least INODE_TABLE_LOCK_STRIPES,
+   so a bucket maps to the same hash_lock stripe in either array. */
+struct _inode_hash {
+        struct list_head  *buckets;     /* current bucket array */
+        uint32_t           size;        /* number of buckets in it */
+        struct list_head  *old_buckets; /* array being drained, or NULL */
+        uint32_t           old_size;
+        uint32_t           rehash_idx;  /* next old bucket to drain */
+};
+
+
 struct _inode_table {
-        pthread_mutex_t    lock;
-        size_t             hashsize;    /* bucket size of inode hash and dentry hash */
+        pthread_mutex_t    lock;        /* lists, dentry tree and ref 0<->1 */
+        gf_lock_t          hash_lock[INODE_TABLE_LOCK_STRIPES];
+                                        /* striped locks over the chains of
+                                           inode_hash and name_hash, taken
+                                           after 'lock' by writers, alone by
+                                           inode_find/inode_grep */
         char              *name;        /* name of the inode table, just for gf_log() */
         inode_t           *root;        /* root directory inode, with number 1 */
         xlator_t          *xl;          /* xlator to be called to do purge */
         uint32_t           lru_limit;   /* maximum LRU cache size */
-        struct list_head  *inode_hash;  /* buckets for inode hash table */
-        struct list_head  *name_hash;   /* buckets for dentry hash table */
+        struct _inode_hash inode_hash;  /* inode hash table, by gfid */
+        struct _inode_hash name_hash;   /* dentry hash table, by parent and name */
         struct list_head   active;      /* list of inodes currently active (in an fop) */
         uint32_t           active_size; /* count of inodes in active list */
         struct list_head   lru;         /* list of inodes recently used.
@@ -95,7 +125,8 @@ struct _inode {
         uuid_t               gfid;
         gf_lock_t            lock;
         uint64_t             nlookup;
-        uint32_t             ref;           /* reference count on this inode */
+        uint32_t             ref;           /* reference count on this inode,
+                                               updated atomically */
         ino_t                ino;           /* inode number in the storage (persistent) */
         ia_type_t            ia_type;       /* what kind of file */
         struct list_head     fd_list;       /* list of open files on this inode */
@@ -152,6 +183,9 @@ inode_path (inode_t *inode, const char *name, char **bufp);
 int
 __inode_path (inode_t *inode, const char *name, char **bufp);
 
+int
+inode_anchored_path (inode_t *inode, const char *name, char **bufp);
+
 inode_t *
 inode_from_path (inode_table_t *table, const char *path);
 
@@ -106,6 +106,14 @@ enum gf_common_mem_types_ {
         gf_common_mt_trie_end             = 81,
         gf_common_mt_run_argv             = 82,
         gf_common_mt_run_logbuf           = 83,
-        gf_common_mt_end                  = 84
+        gf_common_mt_rpcsvc_drc_t         = 84,
+        gf_common_mt_rpcsvc_drc_client_t  = 85,
+        gf_common_mt_rpcsvc_drc_entry_t   = 86,
+        gf_common_mt_rpcsvc_drc_reply     = 87,
+        gf_common_mt_rpcsvc_fq_t          = 88,
+        gf_common_mt_rpcsvc_fq_client_t   = 89,
+        gf_common_mt_compound_args_t      = 90,
+        gf_common_mt_compound_local_t     = 91,
+        gf_common_mt_end                  = 92
 };
 #endif
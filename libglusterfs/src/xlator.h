@@ -61,6 +61,8 @@ struct _gf_dirent_t;
 typedef struct _gf_dirent_t gf_dirent_t;
 struct _loc;
 typedef struct _loc loc_t;
+struct _compound_args;
+typedef struct _compound_args compound_args_t;
 
 
 typedef int32_t (*event_notify_fn_t) (xlator_t *this, int32_t event, void *data,
@@ -163,6 +165,40 @@ typedef int32_t (*fop_ftruncate_cbk_t) (call_frame_t *frame,
                                         struct iatt *prebuf,
                                         struct iatt *postbuf);
 
+typedef int32_t (*fop_fallocate_cbk_t) (call_frame_t *frame,
+                                        void *cookie,
+                                        xlator_t *this,
+                                        int32_t op_ret,
+                                        int32_t op_errno,
+                                        struct iatt *prebuf,
+                                        struct iatt *postbuf);
+
+typedef int32_t (*fop_discard_cbk_t) (call_frame_t *frame,
+                                      void *cookie,
+                                      xlator_t *this,
+                                      int32_t op_ret,
+                                      int32_t op_errno,
+                                      struct iatt *prebuf,
+                                      struct iatt *postbuf);
+
+typedef int32_t (*fop_zerofill_cbk_t) (call_frame_t *frame,
+                                       void *cookie,
+                                       xlator_t *this,
+                                       int32_t op_ret,
+                                       int32_t op_errno,
+                                       struct iatt *prebuf,
+                                       struct iatt *postbuf);
+
+/* op_ret is 0 when every op of the compound succeeded, the result of
+ * each op is in args->rsp.
+ */
+typedef int32_t (*fop_compound_cbk_t) (call_frame_t *frame,
+                                       void *cookie,
+                                       xlator_t *this,
+                                       int32_t op_ret,
+                                       int32_t op_errno,
+                                       compound_args_t *args);
+
 typedef int32_t (*fop_access_cbk_t) (call_frame_t *frame,
                                      void *cookie,
                                      xlator_t *this,
@@ -445,6 +481,38 @@ typedef int32_t (*fop_ftruncate_t) (call_frame_t *frame,
                                     fd_t *fd,
                                     off_t offset);
 
+/* Allocate the blocks of [offset, offset + len) of @fd; with @keep_size
+ * the file size is left alone when the range goes beyond it.
+ */
+typedef int32_t (*fop_fallocate_t) (call_frame_t *frame,
+                                    xlator_t *this,
+                                    fd_t *fd,
+                                    int32_t keep_size,
+                                    off_t offset,
+                                    size_t len);
+
+/* Deallocate the blocks of the range, it reads back as zeros. */
+typedef int32_t (*fop_discard_t) (call_frame_t *frame,
+                                  xlator_t *this,
+                                  fd_t *fd,
+                                  off_t offset,
+                                  size_t len);
+
+/* Make the range read back as zeros, keeping it allocated; @keep_size
+ * as for fallocate.
+ */
+typedef int32_t (*fop_zerofill_t) (call_frame_t *frame,
+                                   xlator_t *this,
+                                   fd_t *fd,
+                                   int32_t keep_size,
+                                   off_t offset,
+                                   size_t len);
+
+/* Run the ops of args in order, see compound-fop.h. */
+typedef int32_t (*fop_compound_t) (call_frame_t *frame,
+                                   xlator_t *this,
+                                   compound_args_t *args);
+
 typedef int32_t (*fop_access_t) (call_frame_t *frame,
                                  xlator_t *this,
                                  loc_t *loc,
@@ -678,6 +746,10 @@ struct xlator_fops {
         fop_setattr_t        setattr;
         fop_fsetattr_t       fsetattr;
         fop_getspec_t        getspec;
+        fop_fallocate_t      fallocate;
+        fop_discard_t        discard;
+        fop_zerofill_t       zerofill;
+        fop_compound_t       compound;
 
         /* these entries are used for a typechecking hack in STACK_WIND _only_ */
         fop_lookup_cbk_t         lookup_cbk;
@@ -721,6 +793,10 @@ struct xlator_fops {
         fop_setattr_cbk_t        setattr_cbk;
         fop_fsetattr_cbk_t       fsetattr_cbk;
         fop_getspec_cbk_t        getspec_cbk;
+        fop_fallocate_cbk_t      fallocate_cbk;
+        fop_discard_cbk_t        discard_cbk;
+        fop_zerofill_cbk_t       zerofill_cbk;
+        fop_compound_cbk_t       compound_cbk;
 };
 
 typedef int32_t (*cbk_forget_t) (xlator_t *this,
@@ -0,0 +1,511 @@
+/*
+   Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+   This file is part of GlusterFS.
+
+   GlusterFS is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published
+   by the Free Software Foundation; either version 3 of the License,
+   or (at your option) any later version.
+
+   GlusterFS is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see
+   <http://www.gnu.org/licenses/>.
+*/
+
+/* Object (gfid handle) interface. An object is an inode of the client
+ * context's table with a reference held for the application. Locations
+ * are built from the object itself rather than from an absolute path:
+ * inode_anchored_path() yields the full path while the dentry chain up to
+ * the root is known and "<gfid:X>[/name]" otherwise, which the servers
+ * resolve from X without walking the path.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "libglusterfsclient.h"
+#include "libglusterfsclient-internals.h"
+
+#define LIBGF_XL_NAME "libglusterfsclient"
+
+
+/* fill @loc for @name in @parent, or for @inode itself if @name is NULL */
+static int
+libgf_object_loc_fill (libglusterfs_client_ctx_t *ctx, loc_t *loc,
+                       inode_t *parent, const char *name, inode_t *inode)
+{
+        char *path = NULL;
+        int   ret = -1;
+
+        if (name) {
+                loc->parent = inode_ref (parent);
+                uuid_copy (loc->pargfid, parent->gfid);
+                loc->inode = inode_grep (ctx->itable, parent, name);
+                ret = inode_anchored_path (parent, name, &path);
+        } else {
+                loc->inode = inode_ref (inode);
+                uuid_copy (loc->gfid, inode->gfid);
+                if (!__is_root_gfid (inode->gfid))
+                        loc->parent = inode_parent (inode, 0, NULL);
+                ret = inode_anchored_path (inode, NULL, &path);
+        }
+
+        if (ret <= 0) {
+                gf_log (LIBGF_XL_NAME, GF_LOG_ERROR,
+                        "inode_path failed for %s%s%s",
+                        uuid_utoa (name ? parent->gfid : inode->gfid),
+                        name ? "/" : "", name ? name : "");
+                errno = EINVAL;
+                return -1;
+        }
+
+        loc->path = path;
+        loc->name = strrchr (loc->path, '/');
+        if (loc->name)
+                loc->name++;
+        else
+                loc->name = "";
+
+        if (loc->inode)
+                loc->ino = loc->inode->ino;
+
+        return 0;
+}
+
+
+/* the inode looked up into @loc, revalidated only once the lookup cache
+ * of the context has expired */
+static int
+libgf_object_lookup (libglusterfs_client_ctx_t *ctx, loc_t *loc,
+                     struct stat *stbuf)
+{
+        struct iatt iatt = {0, };
+        int         op_ret = -1;
+
+        if (loc->inode && libgf_get_inode_ctx (loc->inode)
+            && libgf_is_iattr_cache_valid (ctx, loc->inode, NULL,
+                                           LIBGF_VALIDATE_LOOKUP)) {
+                op_ret = 0;
+                if (stbuf)
+                        op_ret = libgf_client_stat (ctx, loc, &iatt);
+        } else {
+                op_ret = libgf_client_lookup (ctx, loc, &iatt, NULL, NULL);
+        }
+
+        if ((op_ret == 0) && stbuf)
+                iatt_to_stat (&iatt, stbuf);
+
+        return op_ret;
+}
+
+
+glusterfs_object_t
+glusterfs_glh_object (glusterfs_handle_t handle, const char *path,
+                      struct stat *stbuf)
+{
+        libglusterfs_client_ctx_t *ctx = handle;
+        loc_t                      loc = {0, };
+        struct iatt                iatt = {0, };
+        inode_t                   *object = NULL;
+        int                        op_ret = -1;
+
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, ctx, out);
+        GF_VALIDATE_ABSOLUTE_PATH_OR_GOTO (LIBGF_XL_NAME, path, out);
+
+        loc.path = strdup (path);
+        if (!loc.path) {
+                errno = ENOMEM;
+                goto out;
+        }
+
+        op_ret = libgf_client_path_lookup (&loc, ctx, 1);
+        if (op_ret == -1) {
+                gf_log (LIBGF_XL_NAME, GF_LOG_DEBUG,
+                        "path lookup failed for (%s)", path);
+                goto out;
+        }
+
+        if (stbuf) {
+                op_ret = libgf_client_stat (ctx, &loc, &iatt);
+                if (op_ret == -1)
+                        goto out;
+                iatt_to_stat (&iatt, stbuf);
+        }
+
+        object = inode_ref (loc.inode);
+out:
+        libgf_client_loc_wipe (&loc);
+
+        return object;
+}
+
+
+glusterfs_object_t
+glusterfs_object_find (glusterfs_handle_t handle, const unsigned char *gfid,
+                       struct stat *stbuf)
+{
+        libglusterfs_client_ctx_t *ctx = handle;
+        loc_t                      loc = {0, };
+        inode_t                   *inode = NULL;
+        inode_t                   *object = NULL;
+        char                      *path = NULL;
+        int                        op_ret = -1;
+
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, ctx, out);
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, gfid, out);
+
+        inode = inode_find (ctx->itable, (unsigned char *)gfid);
+        if (inode) {
+                op_ret = libgf_object_loc_fill (ctx, &loc, NULL, NULL, inode);
+                inode_unref (inode);
+                if (op_ret == -1)
+                        goto out;
+        } else {
+                /* not known here: nameless lookup, the servers find it
+                   through their gfid handles */
+                path = CALLOC (1, INODE_GFID_PATH_LEN + 1);
+                if (!path) {
+                        errno = ENOMEM;
+                        goto out;
+                }
+                snprintf (path, INODE_GFID_PATH_LEN + 1, "%s%s>",
+                          INODE_GFID_PATH_PREFIX,
+                          uuid_utoa ((unsigned char *)gfid));
+                loc.path = path;
+                uuid_copy (loc.gfid, (unsigned char *)gfid);
+        }
+
+        op_ret = libgf_object_lookup (ctx, &loc, stbuf);
+        if (op_ret == -1)
+                goto out;
+
+        object = inode_ref (loc.inode);
+out:
+        libgf_client_loc_wipe (&loc);
+
+        return object;
+}
+
+
+glusterfs_object_t
+glusterfs_lookup_at (glusterfs_handle_t handle, glusterfs_object_t parent,
+                     const char *name, struct stat *stbuf)
+{
+        libglusterfs_client_ctx_t *ctx = handle;
+        loc_t                      loc = {0, };
+        inode_t                   *object = NULL;
+        int                        op_ret = -1;
+
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, ctx, out);
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, parent, out);
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, name, out);
+
+        if (!name[0] || strchr (name, '/')) {
+                errno = EINVAL;
+                goto out;
+        }
+
+        op_ret = libgf_object_loc_fill (ctx, &loc, parent, name, NULL);
+        if (op_ret == -1)
+                goto out;
+
+        op_ret = libgf_object_lookup (ctx, &loc, stbuf);
+        if (op_ret == -1)
+                goto out;
+
+        object = inode_ref (loc.inode);
+out:
+        libgf_client_loc_wipe (&loc);
+
+        return object;
+}
+
+
+glusterfs_file_t
+glusterfs_open_at (glusterfs_handle_t handle, glusterfs_object_t object,
+                   int flags)
+{
+        libglusterfs_client_ctx_t       *ctx = handle;
+        libglusterfs_client_inode_ctx_t *inode_ctx = NULL;
+        inode_t                         *inode = object;
+        loc_t                            loc = {0, };
+        fd_t                            *fd = NULL;
+        int                              op_ret = -1;
+
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, ctx, out);
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, inode, out);
+
+        if (flags & O_CREAT) {
+                errno = EINVAL;
+                goto out;
+        }
+
+        op_ret = libgf_object_loc_fill (ctx, &loc, NULL, NULL, inode);
+        if (op_ret == -1)
+                goto out;
+
+        fd = fd_create (loc.inode, ctx->pid);
+        if (!fd) {
+                errno = ENOMEM;
+                goto out;
+        }
+        fd->flags = flags;
+
+        if (IA_ISDIR (loc.inode->ia_type))
+                op_ret = libgf_client_opendir (ctx, &loc, fd);
+        else
+                op_ret = libgf_client_open (ctx, &loc, fd, flags);
+
+        if (op_ret == -1) {
+                fd_unref (fd);
+                fd = NULL;
+                goto out;
+        }
+
+        if (!libgf_get_fd_ctx (fd) && !libgf_alloc_fd_ctx (ctx, fd, NULL)) {
+                gf_log (LIBGF_XL_NAME, GF_LOG_ERROR, "Failed to"
+                        " allocate fd context");
+                fd_unref (fd);
+                fd = NULL;
+                errno = EINVAL;
+                goto out;
+        }
+
+        if ((flags & O_TRUNC) && (((flags & O_ACCMODE) == O_RDWR)
+                                  || ((flags & O_ACCMODE) == O_WRONLY))) {
+                inode_ctx = libgf_get_inode_ctx (fd->inode);
+                if (inode_ctx && IA_ISREG (inode_ctx->stbuf.ia_type)) {
+                        inode_ctx->stbuf.ia_size = 0;
+                        inode_ctx->stbuf.ia_blocks = 0;
+                }
+        }
+
+out:
+        libgf_client_loc_wipe (&loc);
+
+        return fd;
+}
+
+
+glusterfs_file_t
+glusterfs_create_at (glusterfs_handle_t handle, glusterfs_object_t parent,
+                     const char *name, int flags, mode_t mode,
+                     glusterfs_object_t *object)
+{
+        libglusterfs_client_ctx_t *ctx = handle;
+        loc_t                      loc = {0, };
+        fd_t                      *fd = NULL;
+        int                        op_ret = -1;
+
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, ctx, out);
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, parent, out);
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, name, out);
+
+        if (!name[0] || strchr (name, '/')) {
+                errno = EINVAL;
+                goto out;
+        }
+
+        op_ret = libgf_object_loc_fill (ctx, &loc, parent, name, NULL);
+        if (op_ret == -1)
+                goto out;
+
+        /* a stale dentry of ours must not stand in for the new file */
+        if (loc.inode)
+                inode_unref (loc.inode);
+        loc.inode = inode_new (ctx->itable);
+        loc.ino = 0;
+
+        flags |= O_CREAT;
+        fd = fd_create (loc.inode, ctx->pid);
+        if (!fd) {
+                errno = ENOMEM;
+                goto out;
+        }
+        fd->flags = flags;
+
+        op_ret = libgf_client_creat (ctx, &loc, fd, flags, mode);
+        if (op_ret == -1) {
+                fd_unref (fd);
+                fd = NULL;
+                goto out;
+        }
+
+        if (!libgf_get_fd_ctx (fd) && !libgf_alloc_fd_ctx (ctx, fd, NULL)) {
+                gf_log (LIBGF_XL_NAME, GF_LOG_ERROR, "Failed to"
+                        " allocate fd context");
+                fd_unref (fd);
+                fd = NULL;
+                errno = EINVAL;
+                goto out;
+        }
+
+        if (object)
+                *object = inode_ref (fd->inode);
+out:
+        libgf_client_loc_wipe (&loc);
+
+        return fd;
+}
+
+
+int
+glusterfs_object_stat (glusterfs_handle_t handle, glusterfs_object_t object,
+                       struct stat *buf)
+{
+        libglusterfs_client_ctx_t *ctx = handle;
+        loc_t                      loc = {0, };
+        struct iatt                iatt = {0, };
+        int                        op_ret = -1;
+
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, ctx, out);
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, object, out);
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, buf, out);
+
+        op_ret = libgf_object_loc_fill (ctx, &loc, NULL, NULL, object);
+        if (op_ret == -1)
+                goto out;
+
+        op_ret = libgf_client_stat (ctx, &loc, &iatt);
+        if (op_ret == 0)
+                iatt_to_stat (&iatt, buf);
+out:
+        libgf_client_loc_wipe (&loc);
+
+        return op_ret;
+}
+
+
+/* link the entry readdirp returned under its directory, as lookup would */
+static inode_t *
+libgf_object_link_dirent (libglusterfs_client_ctx_t *ctx, inode_t *parent,
+                          const char *name, struct iatt *iatt)
+{
+        inode_t *inode = NULL;
+        inode_t *linked = NULL;
+
+        if (uuid_is_null (iatt->ia_gfid)) {
+                errno = ENODATA;
+                return NULL;
+        }
+
+        inode = inode_new (ctx->itable);
+        if (!inode) {
+                errno = ENOMEM;
+                return NULL;
+        }
+
+        linked = inode_link (inode, parent, name, iatt);
+        inode_unref (inode);
+        if (!linked) {
+                errno = EINVAL;
+                return NULL;
+        }
+
+        inode_lookup (linked);
+
+        if (!libgf_get_inode_ctx (linked))
+                libgf_alloc_inode_ctx (ctx, linked);
+        libgf_transform_iattr (ctx, linked, iatt);
+        libgf_update_iattr_cache (linked, LIBGF_UPDATE_ALL, iatt);
+
+        return linked;
+}
+
+
+int
+glusterfs_readdirplus (glusterfs_dir_t dirfd, struct dirent *entry,
+                       struct stat *stbuf, glusterfs_object_t *object)
+{
+        libglusterfs_client_fd_ctx_t *fd_ctx = NULL;
+        libglusterfs_client_ctx_t    *ctx = NULL;
+        fd_t                         *fd = dirfd;
+        struct iatt                   iatt = {0, };
+        off_t                         offset = 0;
+        int                           op_ret = -1;
+
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, fd, out);
+        GF_VALIDATE_OR_GOTO (LIBGF_XL_NAME, entry, out);
+
+        if (object)
+                *object = NULL;
+
+        fd_ctx = libgf_get_fd_ctx (fd);
+        if (!fd_ctx) {
+                gf_log (LIBGF_XL_NAME, GF_LOG_ERROR, "fd context not present");
+                errno = EBADF;
+                goto out;
+        }
+
+        pthread_mutex_lock (&fd_ctx->lock);
+        {
+                ctx = fd_ctx->ctx;
+                offset = fd_ctx->offset;
+
+                memset (entry, 0, sizeof (*entry));
+                op_ret = libgf_client_readdir (ctx, fd, entry, &offset,
+                                               &iatt);
+                if (op_ret > 0)
+                        fd_ctx->offset = offset;
+        }
+        pthread_mutex_unlock (&fd_ctx->lock);
+
+        if (op_ret <= 0)
+                goto out;
+
+        op_ret = 1;
+
+        if (stbuf)
+                iatt_to_stat (&iatt, stbuf);
+
+        if (!object || !strcmp (entry->d_name, ".")
+            || !strcmp (entry->d_name, ".."))
+                goto out;
+
+        *object = libgf_object_link_dirent (ctx, fd->inode, entry->d_name,
+                                            &iatt);
+        if (!*object)
+                op_ret = -1;
+out:
+        return op_ret;
+}
+
+
+int
+glusterfs_object_gfid (glusterfs_object_t object, unsigned char *gfid)
+{
+        inode_t *inode = object;
+
+        if (!inode || !gfid) {
+                errno = EINVAL;
+                return -1;
+        }
+
+        uuid_copy (gfid, inode->gfid);
+        return 0;
+}
+
+
+glusterfs_object_t
+glusterfs_object_ref (glusterfs_object_t object)
+{
+        if (!object)
+                return NULL;
+
+        return inode_ref ((inode_t *)object);
+}
+
+
+void
+glusterfs_object_unref (glusterfs_object_t object)
+{
+        if (object)
+                inode_unref ((inode_t *)object);
+}
@@ -161,6 +161,31 @@ typedef struct libglusterfs_client_async_local {
         }fop;
 }libglusterfs_client_async_local_t;
 
+typedef struct libgf_client_cq libgf_client_cq_t;
+
+/* A request of a completion queue, on the free list, in flight (frame
+ * local of its fop) or on the done list until reaped.
+ */
+typedef struct {
+        struct list_head      list;
+        libgf_client_cq_t    *cq;
+        glusterfs_cq_req_t    req;
+        glusterfs_cq_event_t  event;
+} libgf_client_cq_entry_t;
+
+struct libgf_client_cq {
+        pthread_mutex_t          lock;
+        pthread_cond_t           cond;
+        int                      notify[2];     /* readable while done is
+                                                   not empty */
+        unsigned int             depth;
+        unsigned int             inflight;
+        unsigned int             ndone;
+        struct list_head         free;
+        struct list_head         done;
+        libgf_client_cq_entry_t *entries;
+};
+
 #define LIBGF_STACK_WIND_AND_WAIT(frame, rfn, obj, fn, params ...)      \
         do {                                                            \
                 STACK_WIND (frame, rfn, obj, fn, params);               \
@@ -295,4 +320,40 @@ libgf_is_iattr_cache_valid (libglusterfs_client_ctx_t *ctx, inode_t *inode,
 int
 libgf_update_iattr_cache (inode_t *inode, int flags, struct iatt *buf);
 
+int
+libgf_transform_iattr (libglusterfs_client_ctx_t *libctx, inode_t *inode,
+                       struct iatt *buf);
+
+libglusterfs_client_inode_ctx_t *
+libgf_get_inode_ctx (inode_t *inode);
+
+libglusterfs_client_inode_ctx_t *
+libgf_alloc_inode_ctx (libglusterfs_client_ctx_t *ctx, inode_t *inode);
+
+libglusterfs_client_fd_ctx_t *
+libgf_get_fd_ctx (fd_t *fd);
+
+libglusterfs_client_fd_ctx_t *
+libgf_alloc_fd_ctx (libglusterfs_client_ctx_t *ctx, fd_t *fd, char *vpath);
+
+int
+libgf_client_open (libglusterfs_client_ctx_t *ctx, loc_t *loc, fd_t *fd,
+                   int flags);
+
+int
+libgf_client_creat (libglusterfs_client_ctx_t *ctx, loc_t *loc, fd_t *fd,
+                    int flags, mode_t mode);
+
+int
+libgf_client_opendir (libglusterfs_client_ctx_t *ctx, loc_t *loc, fd_t *fd);
+
+int32_t
+libgf_client_stat (libglusterfs_client_ctx_t *ctx, loc_t *loc,
+                   struct iatt *stbuf);
+
+/* @stbuf, if not NULL, receives the iatt readdirp returned for the entry */
+int
+libgf_client_readdir (libglusterfs_client_ctx_t *ctx, fd_t *fd,
+                      struct dirent *dirp, off_t *offset, struct iatt *stbuf);
+
 #endif
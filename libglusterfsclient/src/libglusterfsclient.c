@@ -57,7 +57,8 @@
 
 #define LIBGF_XL_NAME "libglusterfsclient"
 #define LIBGLUSTERFS_INODE_TABLE_LRU_LIMIT 1000 //14057
-#define LIBGF_SENDFILE_BLOCK_SIZE 4096
+#define LIBGF_SENDFILE_BLOCK_SIZE LIBGF_IOBUF_SIZE
+#define LIBGF_SENDFILE_WINDOW   16
 #define LIBGF_READDIR_BLOCK     4096
 #define libgf_path_absolute(path) ((path)[0] == '/')
 
@@ -335,7 +336,7 @@ out:
 
 int
 libgf_dcache_readdir (libglusterfs_client_ctx_t *ctx, fd_t *fd,
-                      struct dirent *dirp, off_t *offset)
+                      struct dirent *dirp, off_t *offset, struct iatt *stbuf)
 {
         libglusterfs_client_fd_ctx_t    *fd_ctx = NULL;
         int                             cachevalid = 0;
@@ -406,6 +407,8 @@ libgf_dcache_readdir (libglusterfs_client_ctx_t *ctx, fd_t *fd,
         dirp->d_ino = fd_ctx->dcache->next->d_ino;
         strncpy (dirp->d_name, fd_ctx->dcache->next->d_name,
                  fd_ctx->dcache->next->d_len);
+        if (stbuf)
+                *stbuf = fd_ctx->dcache->next->d_stat;
 
         *offset = fd_ctx->dcache->next->d_off;
         dirp->d_off = *offset;
@@ -4292,13 +4295,13 @@ libgf_client_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
 int 
 libgf_client_readdir (libglusterfs_client_ctx_t *ctx, fd_t *fd,
-                      struct dirent *dirp, off_t *offset)
+                      struct dirent *dirp, off_t *offset, struct iatt *stbuf)
 {  
         call_stub_t *stub = NULL;
         int op_ret = -1;
         libgf_client_local_t *local = NULL;
 
-        if (libgf_dcache_readdir (ctx, fd, dirp, offset))
+        if (libgf_dcache_readdir (ctx, fd, dirp, offset, stbuf))
                 return 1;
         local = CALLOC (1, sizeof (*local));
         ERR_ABORT (local);
@@ -4308,7 +4311,7 @@ libgf_client_readdir (libglusterfs_client_ctx_t *ctx, fd_t *fd,
 
         errno = stub->args.readdir_cbk.op_errno;
 
-        op_ret = libgf_dcache_readdir (ctx, fd, dirp, offset);
+        op_ret = libgf_dcache_readdir (ctx, fd, dirp, offset, stbuf);
 	call_stub_destroy (stub);
         return op_ret;
 }
@@ -4342,7 +4345,7 @@ glusterfs_readdir_r (glusterfs_dir_t dirfd, struct dirent *entry,
                 gf_log (LIBGF_XL_NAME, GF_LOG_DEBUG, "offset %"PRIu64, offset);
                 memset (dirp, 0, sizeof (struct dirent));
                 op_ret = libgf_client_readdir (ctx, (fd_t *)dirfd, dirp,
-                                               &offset);
+                                               &offset, NULL);
                 if (op_ret <= 0) {
                         gf_log (LIBGF_XL_NAME, GF_LOG_DEBUG, "readdir failed:"
                                 " %s", strerror (errno));
@@ -4400,7 +4403,8 @@ glusterfs_readdir (glusterfs_dir_t dirfd)
 
         gf_log (LIBGF_XL_NAME, GF_LOG_DEBUG, "offset %"PRIu64, offset);
         memset (dirp, 0, sizeof (struct dirent));
-        op_ret = libgf_client_readdir (ctx, (fd_t *)dirfd, dirp, &offset);
+        op_ret = libgf_client_readdir (ctx, (fd_t *)dirfd, dirp, &offset,
+                                       NULL);
 
         if (op_ret <= 0) {
                 gf_log (LIBGF_XL_NAME, GF_LOG_DEBUG, "readdir failed: %s",
@@ -4444,7 +4448,7 @@ glusterfs_getdents (glusterfs_file_t fd, struct dirent *dirp,
         }
         pthread_mutex_unlock (&fd_ctx->lock);
 
-        op_ret = libgf_client_readdir (ctx, (fd_t *)fd, dirp, &offset);
+        op_ret = libgf_client_readdir (ctx, (fd_t *)fd, dirp, &offset, NULL);
 
         if (op_ret > 0) {
                 pthread_mutex_lock (&fd_ctx->lock);
@@ -4685,6 +4689,427 @@ out:
         return op_ret;
 }
 
+/* Completion queues */
+
+static void
+libgf_client_cq_complete (libgf_client_cq_entry_t *entry, int32_t op_ret,
+                          int32_t op_errno)
+{
+        libgf_client_cq_t *cq = entry->cq;
+        char               byte = 0;
+
+        entry->event.cookie = entry->req.cookie;
+        entry->event.op_ret = op_ret;
+        entry->event.op_errno = op_errno;
+
+        pthread_mutex_lock (&cq->lock);
+        {
+                list_add_tail (&entry->list, &cq->done);
+                cq->inflight--;
+                /* the pipe carries one byte as long as done is not
+                   empty, reap takes it back */
+                if (cq->ndone++ == 0)
+                        write (cq->notify[1], &byte, 1);
+                pthread_cond_broadcast (&cq->cond);
+        }
+        pthread_mutex_unlock (&cq->lock);
+}
+
+
+static int32_t
+libgf_client_cq_readv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int32_t op_ret, int32_t op_errno,
+                           struct iovec *vector, int32_t count,
+                           struct iatt *stbuf, struct iobref *iobref)
+{
+        libgf_client_cq_entry_t *entry = frame->local;
+        libglusterfs_client_ctx_t *ctx = frame->root->state;
+        fd_t                    *fd = entry->req.fd;
+        glusterfs_iobuf_t       *buf = NULL;
+
+        frame->local = NULL;
+
+        if (op_ret >= 0) {
+                libgf_transform_iattr (ctx, fd->inode, stbuf);
+                libgf_invalidate_iattr_cache (fd->inode,
+                                              LIBGF_INVALIDATE_STAT);
+        }
+
+        if ((op_ret > 0) && entry->req.buf) {
+                iov_unload (entry->req.buf, vector, count);
+        } else if ((op_ret >= 0) && !entry->req.buf) {
+                buf = CALLOC (1, sizeof (*buf));
+                ERR_ABORT (buf);
+                if (vector)
+                        buf->vector = iov_dup (vector, count);
+                buf->count = count;
+                if (iobref)
+                        buf->iobref = iobref_ref (iobref);
+                entry->event.iobuf = buf;
+        }
+
+        libgf_client_cq_complete (entry, op_ret, op_errno);
+        STACK_DESTROY (frame->root);
+
+        return 0;
+}
+
+
+static int32_t
+libgf_client_cq_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                            int32_t op_ret, int32_t op_errno,
+                            struct iatt *prebuf, struct iatt *postbuf)
+{
+        libgf_client_cq_entry_t *entry = frame->local;
+        fd_t                    *fd = entry->req.fd;
+
+        frame->local = NULL;
+
+        /* write-behind may return a stat filled with zeroes */
+        libgf_invalidate_iattr_cache (fd->inode, LIBGF_INVALIDATE_STAT);
+
+        libgf_client_cq_complete (entry, op_ret, op_errno);
+        STACK_DESTROY (frame->root);
+
+        return 0;
+}
+
+
+static int32_t
+libgf_client_cq_fstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int32_t op_ret, int32_t op_errno, struct iatt *buf)
+{
+        libgf_client_cq_entry_t   *entry = frame->local;
+        libglusterfs_client_ctx_t *ctx = frame->root->state;
+        fd_t                      *fd = entry->req.fd;
+
+        frame->local = NULL;
+
+        if (op_ret == 0) {
+                libgf_transform_iattr (ctx, fd->inode, buf);
+                iatt_to_stat (buf, entry->req.stbuf);
+                libgf_update_iattr_cache (fd->inode, LIBGF_UPDATE_STAT, buf);
+        }
+
+        libgf_client_cq_complete (entry, op_ret, op_errno);
+        STACK_DESTROY (frame->root);
+
+        return 0;
+}
+
+
+glusterfs_cq_t
+glusterfs_cq_create (unsigned int depth)
+{
+        libgf_client_cq_t *cq = NULL;
+        unsigned int       i = 0;
+
+        if (depth == 0) {
+                errno = EINVAL;
+                goto out;
+        }
+
+        cq = CALLOC (1, sizeof (*cq));
+        if (!cq) {
+                errno = ENOMEM;
+                goto out;
+        }
+
+        cq->entries = CALLOC (depth, sizeof (*cq->entries));
+        if (!cq->entries) {
+                errno = ENOMEM;
+                goto free_cq;
+        }
+
+        /* a pipe rather than an eventfd, libglusterfsclient is not
+           linux only */
+        if (pipe (cq->notify) == -1)
+                goto free_entries;
+
+        fcntl (cq->notify[0], F_SETFL,
+               fcntl (cq->notify[0], F_GETFL) | O_NONBLOCK);
+
+        pthread_mutex_init (&cq->lock, NULL);
+        pthread_cond_init (&cq->cond, NULL);
+        INIT_LIST_HEAD (&cq->free);
+        INIT_LIST_HEAD (&cq->done);
+        cq->depth = depth;
+
+        for (i = 0; i < depth; i++) {
+                cq->entries[i].cq = cq;
+                list_add_tail (&cq->entries[i].list, &cq->free);
+        }
+
+        goto out;
+
+free_entries:
+        FREE (cq->entries);
+free_cq:
+        FREE (cq);
+        cq = NULL;
+out:
+        return cq;
+}
+
+
+static void
+libgf_client_cq_entry_release (libgf_client_cq_entry_t *entry)
+{
+        if (entry->event.iobuf)
+                glusterfs_free (entry->event.iobuf);
+        if (entry->req.fd)
+                fd_unref ((fd_t *)entry->req.fd);
+
+        memset (&entry->req, 0, sizeof (entry->req));
+        memset (&entry->event, 0, sizeof (entry->event));
+}
+
+
+int
+glusterfs_cq_destroy (glusterfs_cq_t handle)
+{
+        libgf_client_cq_t       *cq = handle;
+        libgf_client_cq_entry_t *entry = NULL;
+        unsigned int             i = 0;
+
+        if (!cq) {
+                errno = EINVAL;
+                return -1;
+        }
+
+        pthread_mutex_lock (&cq->lock);
+        {
+                while (cq->inflight)
+                        pthread_cond_wait (&cq->cond, &cq->lock);
+        }
+        pthread_mutex_unlock (&cq->lock);
+
+        for (i = 0; i < cq->depth; i++) {
+                entry = &cq->entries[i];
+                libgf_client_cq_entry_release (entry);
+        }
+
+        close (cq->notify[0]);
+        close (cq->notify[1]);
+        pthread_cond_destroy (&cq->cond);
+        pthread_mutex_destroy (&cq->lock);
+        FREE (cq->entries);
+        FREE (cq);
+
+        return 0;
+}
+
+
+int
+glusterfs_cq_fd (glusterfs_cq_t handle)
+{
+        libgf_client_cq_t *cq = handle;
+
+        if (!cq) {
+                errno = EINVAL;
+                return -1;
+        }
+
+        return cq->notify[0];
+}
+
+
+/* validate the request of @local and wind it, or complete it at once
+   from the stat cache */
+static int
+libgf_client_cq_start (libgf_client_cq_entry_t *local)
+{
+        libglusterfs_client_ctx_t    *ctx = NULL;
+        libglusterfs_client_fd_ctx_t *fd_ctx = NULL;
+        glusterfs_cq_req_t           *req = &local->req;
+        fd_t                         *fd = req->fd;
+        struct iatt                   cachedbuf = {0, };
+        struct iovec                  vector = {0, };
+        struct iobref                *iobref = NULL;
+
+        fd_ctx = libgf_get_fd_ctx (fd);
+        if (!fd_ctx) {
+                errno = EBADF;
+                return -1;
+        }
+        ctx = fd_ctx->ctx;
+
+        switch (req->op) {
+        case GLUSTERFS_CQ_READ:
+        case GLUSTERFS_CQ_WRITE:
+                if ((req->offset < 0) || (req->nbytes == 0)
+                    || ((req->op == GLUSTERFS_CQ_WRITE) && !req->buf)) {
+                        errno = EINVAL;
+                        return -1;
+                }
+                break;
+        case GLUSTERFS_CQ_FSTAT:
+                if (!req->stbuf) {
+                        errno = EINVAL;
+                        return -1;
+                }
+                break;
+        default:
+                errno = EINVAL;
+                return -1;
+        }
+
+        /* the request holds its own ref until it is reaped */
+        req->fd = fd_ref (fd);
+
+        pthread_mutex_lock (&local->cq->lock);
+        {
+                local->cq->inflight++;
+        }
+        pthread_mutex_unlock (&local->cq->lock);
+
+        switch (req->op) {
+        case GLUSTERFS_CQ_READ:
+                LIBGF_CLIENT_FOP_ASYNC (ctx, local, libgf_client_cq_readv_cbk,
+                                        readv, fd, req->nbytes, req->offset);
+                break;
+
+        case GLUSTERFS_CQ_WRITE:
+                vector.iov_base = req->buf;
+                vector.iov_len = req->nbytes;
+                iobref = iobref_new ();
+                LIBGF_CLIENT_FOP_ASYNC (ctx, local,
+                                        libgf_client_cq_writev_cbk, writev,
+                                        fd, &vector, 1, req->offset, iobref);
+                iobref_unref (iobref);
+                break;
+
+        case GLUSTERFS_CQ_FSTAT:
+                if (libgf_is_iattr_cache_valid (ctx, fd->inode, &cachedbuf,
+                                                LIBGF_VALIDATE_STAT)) {
+                        iatt_to_stat (&cachedbuf, req->stbuf);
+                        libgf_client_cq_complete (local, 0, 0);
+                        break;
+                }
+                LIBGF_CLIENT_FOP_ASYNC (ctx, local, libgf_client_cq_fstat_cbk,
+                                        fstat, fd);
+                break;
+        }
+
+        return 0;
+}
+
+
+int
+glusterfs_cq_submit (glusterfs_cq_t handle, glusterfs_cq_req_t *reqs,
+                     int count)
+{
+        libgf_client_cq_t       *cq = handle;
+        libgf_client_cq_entry_t *entry = NULL;
+        struct list_head         batch;
+        int                      submitted = 0;
+        int                      op_errno = 0;
+
+        if (!cq || !reqs || (count <= 0)) {
+                errno = EINVAL;
+                return -1;
+        }
+
+        INIT_LIST_HEAD (&batch);
+
+        /* take the entries of the whole batch at once */
+        pthread_mutex_lock (&cq->lock);
+        {
+                while ((submitted < count) && !list_empty (&cq->free)) {
+                        entry = list_entry (cq->free.next,
+                                            libgf_client_cq_entry_t, list);
+                        list_move_tail (&entry->list, &batch);
+                        submitted++;
+                }
+        }
+        pthread_mutex_unlock (&cq->lock);
+
+        if (submitted == 0) {
+                errno = EAGAIN;
+                return -1;
+        }
+
+        count = submitted;
+        submitted = 0;
+        while (!list_empty (&batch)) {
+                entry = list_entry (batch.next, libgf_client_cq_entry_t,
+                                    list);
+                list_del_init (&entry->list);
+                entry->req = reqs[submitted];
+
+                if (libgf_client_cq_start (entry) == -1) {
+                        op_errno = errno;
+                        entry->req.fd = NULL;
+                        list_add (&entry->list, &batch);
+                        break;
+                }
+                submitted++;
+        }
+
+        if (!list_empty (&batch)) {
+                pthread_mutex_lock (&cq->lock);
+                {
+                        list_splice_init (&batch, &cq->free);
+                }
+                pthread_mutex_unlock (&cq->lock);
+        }
+
+        if (submitted == 0) {
+                errno = op_errno;
+                return -1;
+        }
+
+        return submitted;
+}
+
+
+int
+glusterfs_cq_reap (glusterfs_cq_t handle, glusterfs_cq_event_t *events,
+                   int max, int min)
+{
+        libgf_client_cq_t       *cq = handle;
+        libgf_client_cq_entry_t *entry = NULL;
+        char                     byte = 0;
+        int                      reaped = -1;
+
+        if (!cq || !events || (max <= 0) || (min < 0) || (min > max)) {
+                errno = EINVAL;
+                goto out;
+        }
+
+        pthread_mutex_lock (&cq->lock);
+        {
+                if (min > (cq->inflight + cq->ndone)) {
+                        errno = EINVAL;
+                        goto unlock;
+                }
+
+                while (cq->ndone < min)
+                        pthread_cond_wait (&cq->cond, &cq->lock);
+
+                reaped = 0;
+                while ((reaped < max) && !list_empty (&cq->done)) {
+                        entry = list_entry (cq->done.next,
+                                            libgf_client_cq_entry_t, list);
+                        events[reaped++] = entry->event;
+
+                        /* the iobuf now belongs to the application */
+                        entry->event.iobuf = NULL;
+                        libgf_client_cq_entry_release (entry);
+                        list_move_tail (&entry->list, &cq->free);
+                        cq->ndone--;
+                }
+
+                if (reaped && (cq->ndone == 0))
+                        read (cq->notify[0], &byte, 1);
+        }
+unlock:
+        pthread_mutex_unlock (&cq->lock);
+out:
+        return reaped;
+}
+
+
 off_t
 glusterfs_lseek (glusterfs_file_t fd, off_t offset, int whence)
 {
@@ -7570,76 +7995,51 @@ out:
         return off;
 }
 
-struct libgf_client_sendfile_data {
-        int                reads_sent;
-        int                reads_completed;
-        int                out_fd;
-        int32_t            op_ret;
-        int32_t            op_errno;
-        pthread_mutex_t    lock;
-        pthread_cond_t     cond;
+/* Reads of sendfile complete in any order, those that arrive ahead of
+ * the next block to write wait in the window.
+ */
+struct libgf_client_sendfile_slot {
+        char               done;
+        int                op_ret;
+        int                op_errno;
+        glusterfs_iobuf_t *iobuf;
 };
 
-int
-libgf_client_sendfile_read_cbk (int op_ret, int op_errno,
-                                glusterfs_iobuf_t *buf, void *cbk_data)
-{
-        struct libgf_client_sendfile_data *sendfile_data = cbk_data;
-        int                                bytes = 0;
-
-        if (op_ret > 0) {
-                bytes = writev (sendfile_data->out_fd, buf->vector, buf->count);
-                if (bytes != op_ret) {
-                        op_ret = -1;
-                        op_errno = errno;
-                }
-
-                glusterfs_free (buf);
-        }
-
-        pthread_mutex_lock (&sendfile_data->lock);
-        {
-                if (sendfile_data->op_ret != -1) {
-                        if (op_ret == -1) {
-                                sendfile_data->op_ret = -1;
-                                sendfile_data->op_errno = op_errno;
-                        } else {
-                                sendfile_data->op_ret += op_ret;
-                        }
-                }
-
-                sendfile_data->reads_completed++;
-
-                if (sendfile_data->reads_completed
-                    == sendfile_data->reads_sent) {
-                        pthread_cond_broadcast (&sendfile_data->cond);
-                } 
-        }
-        pthread_mutex_unlock (&sendfile_data->lock);
-
-        return 0;
-}
-
-
 ssize_t
 glusterfs_sendfile (int out_fd, glusterfs_file_t in_fd, off_t *offset,
                     size_t count)
 {
-        ssize_t                           ret = -1;
-        struct libgf_client_sendfile_data cbk_data = {0, };
-        off_t                             off = -1;
-        size_t                            size = 0;
-        int                               flags = 0;
-        int                               non_block = 0;
+        struct libgf_client_sendfile_slot  window[LIBGF_SENDFILE_WINDOW];
+        struct libgf_client_sendfile_slot *slot = NULL;
+        glusterfs_cq_event_t               events[LIBGF_SENDFILE_WINDOW];
+        glusterfs_cq_req_t                 req = {0, };
+        glusterfs_cq_t                     cq = NULL;
+        ssize_t                            ret = -1;
+        ssize_t                            bytes = 0;
+        size_t                             written = 0;
+        uint64_t                           sent = 0;
+        uint64_t                           next = 0;
+        off_t                              start = -1;
+        off_t                              off = -1;
+        int                                op_errno = 0;
+        int                                eof = 0;
+        int                                flags = 0;
+        int                                non_block = 0;
+        int                                i = 0;
+        int                                n = 0;
+
+        memset (window, 0, sizeof (window));
+
+        if (offset)
+                start = *offset;
+        else
+                start = glusterfs_lseek (in_fd, 0, SEEK_CUR);
+        if (start == -1)
+                return -1;
 
-        
-        pthread_mutex_init (&cbk_data.lock, NULL);
-        pthread_cond_init (&cbk_data.cond, NULL);
-        cbk_data.out_fd = out_fd;
-        
-        if (offset) {
-                off = *offset;
-        }
+        cq = glusterfs_cq_create (LIBGF_SENDFILE_WINDOW);
+        if (!cq)
+                return -1;
 
         flags = fcntl (out_fd, F_GETFL);
 
@@ -7651,59 +8051,93 @@ glusterfs_sendfile (int out_fd, glusterfs_file_t in_fd, off_t *offset,
                 }
         }
 
-        while (count != 0) {
-                /* 
-                 * FIXME: what's the optimal size for reads and writes?
-                 */
-                size = (count > LIBGF_SENDFILE_BLOCK_SIZE) ? 
-                        LIBGF_SENDFILE_BLOCK_SIZE : count;
+        /* keep LIBGF_SENDFILE_WINDOW reads outstanding, write the blocks
+           out in file order as they come in */
+        off = start;
+        while (!op_errno) {
+                while (!eof && count
+                       && ((sent - next) < LIBGF_SENDFILE_WINDOW)) {
+                        req.op = GLUSTERFS_CQ_READ;
+                        req.fd = in_fd;
+                        req.nbytes = (count > LIBGF_SENDFILE_BLOCK_SIZE) ?
+                                LIBGF_SENDFILE_BLOCK_SIZE : count;
+                        req.offset = off;
+                        req.cookie = (void *)(long)(sent
+                                                    % LIBGF_SENDFILE_WINDOW);
+
+                        if (glusterfs_cq_submit (cq, &req, 1) != 1) {
+                                op_errno = errno;
+                                break;
+                        }
 
-                /* 
-                 * we don't wait for reply to previous read, we just send all
-                 * reads in a single go.
-                 */
-                ret = glusterfs_read_async (in_fd, size, off,
-                                            libgf_client_sendfile_read_cbk,
-                                            &cbk_data);
-                if (ret == -1) {
-                        break;
+                        sent++;
+                        off += req.nbytes;
+                        count -= req.nbytes;
                 }
 
-                pthread_mutex_lock (&cbk_data.lock);
-                {
-                        cbk_data.reads_sent++;
+                if (op_errno || (next == sent))
+                        break;
+
+                n = glusterfs_cq_reap (cq, events, LIBGF_SENDFILE_WINDOW, 1);
+                if (n == -1) {
+                        op_errno = errno;
+                        break;
                 }
-                pthread_mutex_unlock (&cbk_data.lock);
 
-                if (offset) {
-                        off += size;
+                for (i = 0; i < n; i++) {
+                        slot = &window[(long)events[i].cookie];
+                        slot->done = 1;
+                        slot->op_ret = events[i].op_ret;
+                        slot->op_errno = events[i].op_errno;
+                        slot->iobuf = events[i].iobuf;
                 }
 
-                count -= size;
-        }
+                while ((next < sent) && !op_errno) {
+                        slot = &window[next % LIBGF_SENDFILE_WINDOW];
+                        if (!slot->done)
+                                break;
 
-        pthread_mutex_lock (&cbk_data.lock);
-        {
-                /* 
-                 * if we've not received replies to all the reads we've sent,
-                 * wait for them
-                 */
-                if (cbk_data.reads_sent > cbk_data.reads_completed) {
-                        pthread_cond_wait (&cbk_data.cond,
-                                           &cbk_data.lock);
+                        if (slot->op_ret == -1) {
+                                op_errno = slot->op_errno;
+                        } else if (slot->op_ret > 0 && !eof) {
+                                bytes = writev (out_fd, slot->iobuf->vector,
+                                                slot->iobuf->count);
+                                if (bytes != slot->op_ret)
+                                        op_errno = (bytes == -1) ? errno : EIO;
+                                else
+                                        written += bytes;
+                        }
+
+                        /* a short read is the end of file, what was read
+                           beyond it is dropped */
+                        if ((slot->op_ret >= 0)
+                            && (slot->op_ret < LIBGF_SENDFILE_BLOCK_SIZE))
+                                eof = 1;
+
+                        if (slot->iobuf)
+                                glusterfs_free (slot->iobuf);
+                        memset (slot, 0, sizeof (*slot));
+                        next++;
                 }
         }
-        pthread_mutex_unlock (&cbk_data.lock);
 
-        if (offset != NULL) {
-                *offset = off;
-        }
- 
-        /* if we were able to stack_wind all the reads */
+        /* waits for the reads still out */
+        glusterfs_cq_destroy (cq);
 
-        if (ret == 0) {
-                ret = cbk_data.op_ret;
-                errno = cbk_data.op_errno;
+        for (i = 0; i < LIBGF_SENDFILE_WINDOW; i++)
+                if (window[i].iobuf)
+                        glusterfs_free (window[i].iobuf);
+
+        if (offset)
+                *offset = start + written;
+        else
+                glusterfs_lseek (in_fd, start + written, SEEK_SET);
+
+        if (op_errno && !written) {
+                errno = op_errno;
+                ret = -1;
+        } else {
+                ret = written;
         }
 
         if (non_block) {
@@ -130,6 +130,13 @@ typedef void * glusterfs_handle_t;
 typedef void * glusterfs_file_t;
 typedef void * glusterfs_dir_t;
 
+/* Handle on a file or directory, identified on the servers by its gfid
+ * rather than by its path. It stays valid across calls, and while the
+ * application holds a reference on it the object is kept in the
+ * library's inode table. Opaque to users.
+ */
+typedef void * glusterfs_object_t;
+
 
 /* Function Call Interface */
 /* libglusterfsclient initialization function.
@@ -514,6 +521,94 @@ glusterfs_writev_async (glusterfs_file_t fd, const struct iovec *vector,
 
 
 
+/* Completion queues
+ * An alternative to the callback based async calls above. Requests are
+ * submitted in batches and their results are collected by the
+ * application, on its own threads, with glusterfs_cq_reap. Nothing of
+ * the application runs on the library's event thread.
+ */
+typedef void * glusterfs_cq_t;
+
+typedef enum {
+        GLUSTERFS_CQ_READ,
+        GLUSTERFS_CQ_WRITE,
+        GLUSTERFS_CQ_FSTAT,
+} glusterfs_cq_op_t;
+
+typedef struct {
+        glusterfs_cq_op_t  op;
+        glusterfs_file_t   fd;
+        void              *buf;         /* READ: buffer of nbytes to read
+                                           into, or NULL to get the data
+                                           back in the event's iobuf.
+                                           WRITE: data to write, must stay
+                                           untouched until completion.
+                                           */
+        size_t             nbytes;
+        off_t              offset;      /* READ/WRITE: absolute offset, the
+                                           file offset of fd is neither
+                                           used nor moved.
+                                           */
+        struct stat       *stbuf;       /* FSTAT: filled on completion. */
+        void              *cookie;      /* Returned as is in the event. */
+} glusterfs_cq_req_t;
+
+typedef struct {
+        void              *cookie;
+        int                op_ret;      /* As for the synchronous call. */
+        int                op_errno;
+        glusterfs_iobuf_t *iobuf;       /* READ with a NULL buf: the data,
+                                           release with glusterfs_free.
+                                           */
+} glusterfs_cq_event_t;
+
+
+/* Creates a completion queue.
+ *
+ * @depth       : Most requests submitted and not yet reaped at any time.
+ *              The requests are allocated once, here.
+ *
+ * Returns NULL on error with errno set appropriately.
+ */
+glusterfs_cq_t
+glusterfs_cq_create (unsigned int depth);
+
+
+/* Destroys a completion queue, waiting for the requests still in
+ * flight. Events not reaped are dropped and their iobufs released.
+ */
+int
+glusterfs_cq_destroy (glusterfs_cq_t cq);
+
+
+/* Returns a file descriptor that polls readable while completions are
+ * waiting to be reaped. Do not read from it or close it.
+ */
+int
+glusterfs_cq_fd (glusterfs_cq_t cq);
+
+
+/* Submits @count requests. Requests are copied, @reqs can be reused as
+ * soon as the call returns.
+ *
+ * Returns the number of requests submitted, which is less than @count
+ * if the queue is full or a request is invalid, and -1 with errno set
+ * (EAGAIN when full, EBADF or EINVAL) if none was.
+ */
+int
+glusterfs_cq_submit (glusterfs_cq_t cq, glusterfs_cq_req_t *reqs, int count);
+
+
+/* Reaps at most @max completions into @events, waiting for at least
+ * @min of them (0 does not wait). Returns the number reaped or -1 with
+ * errno set, EINVAL if @min exceeds the requests in flight.
+ */
+int
+glusterfs_cq_reap (glusterfs_cq_t cq, glusterfs_cq_event_t *events, int max,
+                   int min);
+
+
+
 /* Read from a file starting at a given offset.
  *
  * @fd          : File handle returned from glusterfs_open or
@@ -1258,7 +1353,8 @@ glusterfs_telldir (glusterfs_dir_t dirfd);
 /* Write count bytes from in_fd to out_fd, starting at *offset.
  * glusterfs_sendfile aims at eliminating memory copy at the end of
  * each read from in_fd, copying the file directly to out_fd from the buffer 
- * provided by glusterfs.
+ * provided by glusterfs. Several reads are kept outstanding on in_fd
+ * while the data already received is written out.
  *
  * @out_fd: file descriptor opened for writing
  *
@@ -1351,6 +1447,142 @@ int
 glusterfs_truncate (const char *path, off_t length);
 
 
+/* Object (gfid handle) interface
+ *
+ * The calls below work relative to an object the application already
+ * holds rather than to an absolute path, so a lookup costs one round
+ * trip whatever the depth of the directory. Every object returned
+ * carries a reference the caller drops with glusterfs_object_unref.
+ */
+
+/* Get the object for a path.
+ *
+ * @handle      : The handle identifying a glusterfs client context.
+ * @path        : Absolute path of the file or directory.
+ * @stbuf       : If not NULL, the stat of the object is copied here.
+ *
+ * Returns the object on success, NULL on error with errno set.
+ */
+glusterfs_object_t
+glusterfs_glh_object (glusterfs_handle_t handle, const char *path,
+                      struct stat *stbuf);
+
+
+/* Get the object with a given gfid, for instance one the application
+ * stored earlier. It is looked up on the servers by gfid alone if the
+ * library does not know it yet.
+ *
+ * @handle      : The handle identifying a glusterfs client context.
+ * @gfid        : The 16 byte gfid, see glusterfs_object_gfid.
+ * @stbuf       : If not NULL, the stat of the object is copied here.
+ *
+ * Returns the object on success, NULL on error with errno set.
+ */
+glusterfs_object_t
+glusterfs_object_find (glusterfs_handle_t handle, const unsigned char *gfid,
+                       struct stat *stbuf);
+
+
+/* Look up an entry of a directory.
+ *
+ * @handle      : The handle identifying a glusterfs client context.
+ * @parent      : Object of the directory.
+ * @name        : Name of the entry in @parent, without any '/'.
+ * @stbuf       : If not NULL, the stat of the entry is copied here.
+ *
+ * Returns the object of the entry on success, NULL on error with errno
+ * set.
+ */
+glusterfs_object_t
+glusterfs_lookup_at (glusterfs_handle_t handle, glusterfs_object_t parent,
+                     const char *name, struct stat *stbuf);
+
+
+/* Open a file or directory by its object.
+ *
+ * @handle      : The handle identifying a glusterfs client context.
+ * @object      : The file or directory to open.
+ * @flags       : As for glusterfs_open, without O_CREAT.
+ *
+ * Returns a file handle on success, NULL on error with errno set.
+ */
+glusterfs_file_t
+glusterfs_open_at (glusterfs_handle_t handle, glusterfs_object_t object,
+                   int flags);
+
+
+/* Create and open a file in a directory.
+ *
+ * @handle      : The handle identifying a glusterfs client context.
+ * @parent      : Object of the directory.
+ * @name        : Name of the new file in @parent.
+ * @flags       : Open flags, O_CREAT is implied.
+ * @mode        : Permissions of the new file.
+ * @object      : If not NULL, receives the object of the new file.
+ *
+ * Returns a file handle on success, NULL on error with errno set.
+ */
+glusterfs_file_t
+glusterfs_create_at (glusterfs_handle_t handle, glusterfs_object_t parent,
+                     const char *name, int flags, mode_t mode,
+                     glusterfs_object_t *object);
+
+
+/* Get struct stat of an object. Symlinks are not followed.
+ *
+ * @handle      : The handle identifying a glusterfs client context.
+ * @object      : The file or directory.
+ * @buf         : The buffer into which the stat structure is copied.
+ *
+ * Returns 0 on success and -1 on error with errno set accordingly.
+ */
+int
+glusterfs_object_stat (glusterfs_handle_t handle, glusterfs_object_t object,
+                       struct stat *buf);
+
+
+/* Read the next entry of a directory opened with glusterfs_open_at or
+ * glusterfs_opendir, along with its stat and object, which come with
+ * the directory listing at no extra round trip.
+ *
+ * @dirfd       : The directory handle.
+ * @entry       : The dirent is copied here.
+ * @stbuf       : If not NULL, the stat of the entry is copied here.
+ * @object      : If not NULL, receives the object of the entry, which
+ *              the caller must unref. NULL for "." and "..".
+ *
+ * Returns 1 when an entry was read, 0 at the end of the directory and
+ * -1 on error with errno set.
+ */
+int
+glusterfs_readdirplus (glusterfs_dir_t dirfd, struct dirent *entry,
+                       struct stat *stbuf, glusterfs_object_t *object);
+
+
+/* Copy the gfid identifying an object on the servers.
+ *
+ * @object      : The file or directory.
+ * @gfid        : 16 bytes receiving the gfid.
+ *
+ * Returns 0 on success and -1 on error with errno set accordingly.
+ */
+int
+glusterfs_object_gfid (glusterfs_object_t object, unsigned char *gfid);
+
+
+/* Take a reference on an object, returns @object. */
+glusterfs_object_t
+glusterfs_object_ref (glusterfs_object_t object);
+
+
+/* Drop a reference taken by any call returning an object or by
+ * glusterfs_object_ref. The object must not be used afterwards unless
+ * other references remain.
+ */
+void
+glusterfs_object_unref (glusterfs_object_t object);
+
+
 /* FIXME: review the need for these apis */
 /* added for log related initialization in booster fork implementation */
 void
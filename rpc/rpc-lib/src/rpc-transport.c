@@ -418,6 +418,23 @@ fail:
 }
 
 
+/* Stop (@onoff true) or resume reading incoming messages from @this. */
+int32_t
+rpc_transport_throttle (rpc_transport_t *this, gf_boolean_t onoff)
+{
+	int32_t ret = -1;
+
+	GF_VALIDATE_OR_GOTO("rpc_transport", this, fail);
+
+	if (!this->ops->throttle)
+		goto fail;
+
+	ret = this->ops->throttle (this, onoff);
+fail:
+	return ret;
+}
+
+
 int32_t
 rpc_transport_destroy (rpc_transport_t *this)
 {
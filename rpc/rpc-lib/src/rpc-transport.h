@@ -211,9 +211,16 @@ struct rpc_transport {
 
         uint64_t                   total_bytes_read;
         uint64_t                   total_bytes_write;
+        uint64_t                   total_read_calls;  /* read syscalls */
+        uint64_t                   total_msgs_read;   /* complete records */
+        uint64_t                   total_write_calls; /* write syscalls */
+        uint64_t                   total_msgs_written;
 
         struct list_head           list;
         int                        bind_insecure;
+
+        /* rpcsvc admission control state of a server side connection */
+        struct rpcsvc_fq_client   *fq_client;
 };
 
 struct rpc_transport_ops {
@@ -237,6 +244,7 @@ struct rpc_transport_ops {
         int32_t (*get_myaddr)     (rpc_transport_t *this, char *peeraddr,
                                    int addrlen, struct sockaddr_storage *sa,
                                    socklen_t sasize);
+        int32_t (*throttle)       (rpc_transport_t *this, gf_boolean_t onoff);
 };
 
 
@@ -249,6 +257,9 @@ rpc_transport_connect (rpc_transport_t *this, int port);
 int32_t
 rpc_transport_disconnect (rpc_transport_t *this);
 
+int32_t
+rpc_transport_throttle (rpc_transport_t *this, gf_boolean_t onoff);
+
 int32_t
 rpc_transport_destroy (rpc_transport_t *this);
 
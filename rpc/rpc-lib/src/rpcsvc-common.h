@@ -76,6 +76,12 @@ typedef struct rpcsvc_state {
         void                    *mydata; /* This is xlator */
         rpcsvc_notify_t          notifyfn;
         struct mem_pool         *rxpool;
+
+        /* duplicate request cache, NULL when disabled */
+        struct rpcsvc_drc       *drc;
+
+        /* admission control and fair queuing, NULL when disabled */
+        struct rpcsvc_fq        *fq;
 } rpcsvc_t;
 
 
@@ -0,0 +1,643 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/* Duplicate request cache. A client that does not hear back in time
+ * retransmits the call with the same xid. Procedures registered with
+ * RPCSVC_DRC_INFLIGHT have such retransmits dropped while the original
+ * call is still being served, RPCSVC_DRC_REPLAY procedures additionally
+ * keep the encoded reply so that a retransmit arriving after the reply
+ * went out (and got lost) is answered from the cache instead of being
+ * executed a second time. Entries are kept per client address and keyed
+ * by xid, program, version, procedure and a checksum of the arguments.
+ * Every client keeps at most rpc.drc-size replies, all clients together
+ * at most rpc.drc-limit bytes of them, and the replies of a client that
+ * went away are dropped after a grace period (see RPCSVC_DRC_*).
+ */
+
+#include "rpcsvc.h"
+#include "logging.h"
+#include "dict.h"
+#include "checksum.h"
+#include "statedump.h"
+#include "mem-types.h"
+
+#include <netinet/in.h>
+
+
+static int
+rpcsvc_drc_addr_hash (struct sockaddr_storage *sa)
+{
+        struct sockaddr_in      *sin = NULL;
+        struct sockaddr_in6     *sin6 = NULL;
+        uint32_t                 hash = 0;
+        int                      i = 0;
+
+        switch (sa->ss_family) {
+        case AF_INET:
+                sin = (struct sockaddr_in *)sa;
+                hash = sin->sin_addr.s_addr ^ sin->sin_port;
+                break;
+        case AF_INET6:
+                sin6 = (struct sockaddr_in6 *)sa;
+                for (i = 0; i < 16; i++)
+                        hash = (hash * 31) + sin6->sin6_addr.s6_addr[i];
+                hash ^= sin6->sin6_port;
+                break;
+        default:
+                return -1;
+        }
+
+        hash ^= hash >> 16;
+        return hash % RPCSVC_DRC_CLIENT_BUCKETS;
+}
+
+
+static int
+rpcsvc_drc_addr_match (struct sockaddr_storage *a, struct sockaddr_storage *b)
+{
+        struct sockaddr_in      *ina = NULL, *inb = NULL;
+        struct sockaddr_in6     *in6a = NULL, *in6b = NULL;
+
+        if (a->ss_family != b->ss_family)
+                return 0;
+
+        if (a->ss_family == AF_INET) {
+                ina = (struct sockaddr_in *)a;
+                inb = (struct sockaddr_in *)b;
+                return ((ina->sin_addr.s_addr == inb->sin_addr.s_addr) &&
+                        (ina->sin_port == inb->sin_port));
+        }
+
+        in6a = (struct sockaddr_in6 *)a;
+        in6b = (struct sockaddr_in6 *)b;
+        return ((memcmp (&in6a->sin6_addr, &in6b->sin6_addr,
+                         sizeof (in6a->sin6_addr)) == 0) &&
+                (in6a->sin6_port == in6b->sin6_port));
+}
+
+
+static uint32_t
+rpcsvc_drc_checksum (rpcsvc_request_t *req, size_t *msglen)
+{
+        size_t  len = 0;
+        int     i = 0;
+
+        for (i = 0; i < req->count; i++)
+                len += req->msg[i].iov_len;
+        *msglen = len;
+
+        /* the head of the arguments is enough to tell a reused xid apart,
+           write payloads are not worth summing */
+        len = req->msg[0].iov_len;
+        if (len > RPCSVC_DRC_CSUM_BYTES)
+                len = RPCSVC_DRC_CSUM_BYTES;
+
+        return gf_rsync_weak_checksum (req->msg[0].iov_base, len);
+}
+
+
+static rpcsvc_drc_client_t *
+__rpcsvc_drc_client_find (rpcsvc_drc_t *drc, struct sockaddr_storage *sa,
+                          int bucket)
+{
+        rpcsvc_drc_client_t     *client = NULL;
+
+        list_for_each_entry (client, &drc->clients[bucket], list) {
+                if (rpcsvc_drc_addr_match (&client->addr, sa))
+                        return client;
+        }
+
+        return NULL;
+}
+
+
+static rpcsvc_drc_client_t *
+__rpcsvc_drc_client_get (rpcsvc_drc_t *drc, struct sockaddr_storage *sa,
+                         int bucket)
+{
+        rpcsvc_drc_client_t     *client = NULL;
+        int                      i = 0;
+
+        client = __rpcsvc_drc_client_find (drc, sa, bucket);
+        if (client)
+                return client;
+
+        client = GF_CALLOC (1, sizeof (*client),
+                            gf_common_mt_rpcsvc_drc_client_t);
+        if (!client)
+                return NULL;
+
+        memcpy (&client->addr, sa, sizeof (*sa));
+        INIT_LIST_HEAD (&client->lru);
+        for (i = 0; i < RPCSVC_DRC_XID_BUCKETS; i++)
+                INIT_LIST_HEAD (&client->xids[i]);
+
+        list_add (&client->list, &drc->clients[bucket]);
+        drc->client_count++;
+
+        return client;
+}
+
+
+static void
+__rpcsvc_drc_entry_destroy (rpcsvc_drc_t *drc, rpcsvc_drc_entry_t *entry)
+{
+        rpcsvc_drc_client_t     *client = NULL;
+
+        client = entry->client;
+
+        if (entry->state == RPCSVC_DRC_DONE) {
+                client->replies--;
+                drc->bytes -= entry->replylen;
+        }
+
+        list_del_init (&entry->hash);
+        list_del_init (&entry->lru);
+        list_del_init (&entry->glru);
+        if (entry->reply)
+                GF_FREE (entry->reply);
+        GF_FREE (entry);
+
+        client->count--;
+        if (client->count == 0) {
+                list_del_init (&client->list);
+                GF_FREE (client);
+                drc->client_count--;
+        }
+}
+
+
+/* Drop the replies of clients gone for good. A table with calls still in
+ * progress is freed once they are done.
+ */
+static void
+__rpcsvc_drc_reap (rpcsvc_drc_t *drc, time_t now)
+{
+        rpcsvc_drc_client_t     *client = NULL;
+        rpcsvc_drc_client_t     *tmp = NULL;
+        rpcsvc_drc_entry_t      *entry = NULL;
+        int                      last = 0;
+        int                      i = 0;
+
+        if ((now - drc->reaped) < RPCSVC_DRC_REAP_INTERVAL)
+                return;
+        drc->reaped = now;
+
+        for (i = 0; i < RPCSVC_DRC_CLIENT_BUCKETS; i++) {
+                list_for_each_entry_safe (client, tmp, &drc->clients[i],
+                                          list) {
+                        if (!(client->disconnected &&
+                              ((now - client->disconnected) >=
+                               RPCSVC_DRC_DISCONNECT_GRACE)) &&
+                            ((now - client->stamp) < RPCSVC_DRC_IDLE_TIMEOUT))
+                                continue;
+
+                        while (client->replies) {
+                                entry = list_entry (client->lru.next,
+                                                    rpcsvc_drc_entry_t, lru);
+                                /* the last entry going frees the client */
+                                last = (client->count == 1);
+                                drc->evictions++;
+                                __rpcsvc_drc_entry_destroy (drc, entry);
+                                if (last)
+                                        break;
+                        }
+                }
+        }
+}
+
+
+static rpcsvc_drc_entry_t *
+__rpcsvc_drc_entry_find (rpcsvc_drc_client_t *client, rpcsvc_request_t *req)
+{
+        rpcsvc_drc_entry_t      *entry = NULL;
+
+        list_for_each_entry (entry, &client->xids[req->xid %
+                                                  RPCSVC_DRC_XID_BUCKETS],
+                             hash) {
+                if ((entry->xid == req->xid) &&
+                    (entry->prognum == req->prognum) &&
+                    (entry->progver == req->progver) &&
+                    (entry->procnum == req->procnum))
+                        return entry;
+        }
+
+        return NULL;
+}
+
+
+static int
+rpcsvc_drc_replay (rpcsvc_request_t *req, char *reply, size_t replylen)
+{
+        struct iobuf    *iob = NULL;
+        struct iobref   *iobref = NULL;
+        struct iovec     vec = {0, };
+        int              ret = -1;
+
+        iob = iobuf_get (req->svc->ctx->iobuf_pool);
+        if (!iob)
+                goto out;
+
+        iobref = iobref_new ();
+        if (!iobref)
+                goto out;
+
+        memcpy (iobuf_ptr (iob), reply, replylen);
+        vec.iov_base = iobuf_ptr (iob);
+        vec.iov_len = replylen;
+        iobref_add (iobref, iob);
+
+        ret = rpcsvc_transport_submit (req->trans, &vec, 1, NULL, 0, NULL, 0,
+                                       iobref, req->trans_private);
+out:
+        if (iobref)
+                iobref_unref (iobref);
+        if (iob)
+                iobuf_unref (iob);
+
+        return ret;
+}
+
+
+/* Called before the actor runs. Returns 0 when the call has to be
+ * executed, in which case an entry may have been attached to @req, and 1
+ * when it was a retransmit that got dropped or answered from the cache,
+ * in which case @req has been destroyed.
+ */
+int
+rpcsvc_drc_check (rpcsvc_request_t *req, int mode)
+{
+        rpcsvc_drc_t            *drc = NULL;
+        rpcsvc_drc_client_t     *client = NULL;
+        rpcsvc_drc_entry_t      *entry = NULL;
+        struct sockaddr_storage *sa = NULL;
+        char                    *reply = NULL;
+        size_t                   replylen = 0;
+        size_t                   msglen = 0;
+        uint32_t                 csum = 0;
+        int                      bucket = 0;
+        int                      dup = 0;
+        time_t                   now = 0;
+
+        drc = req->svc->drc;
+        if (!drc || (mode == RPCSVC_DRC_NONE))
+                return 0;
+
+        sa = &req->trans->peerinfo.sockaddr;
+        bucket = rpcsvc_drc_addr_hash (sa);
+        if (bucket < 0)
+                return 0;
+
+        csum = rpcsvc_drc_checksum (req, &msglen);
+        now = time (NULL);
+
+        LOCK (&drc->lock);
+        {
+                __rpcsvc_drc_reap (drc, now);
+
+                client = __rpcsvc_drc_client_get (drc, sa, bucket);
+                if (!client)
+                        goto unlock;
+
+                client->stamp = now;
+                client->disconnected = 0;
+
+                entry = __rpcsvc_drc_entry_find (client, req);
+                if (entry && ((entry->csum != csum) ||
+                              (entry->msglen != msglen))) {
+                        /* the client wrapped its xids, a new call */
+                        if (entry->state == RPCSVC_DRC_INPROGRESS) {
+                                drc->misses++;
+                                goto unlock;
+                        }
+                        __rpcsvc_drc_entry_destroy (drc, entry);
+                        entry = NULL;
+                }
+
+                if (entry) {
+                        dup = 1;
+                        if (entry->state == RPCSVC_DRC_INPROGRESS) {
+                                drc->drops++;
+                                goto unlock;
+                        }
+
+                        reply = GF_CALLOC (1, entry->replylen,
+                                           gf_common_mt_rpcsvc_drc_reply);
+                        if (reply) {
+                                memcpy (reply, entry->reply, entry->replylen);
+                                replylen = entry->replylen;
+                        }
+                        /* recently answered, keep it around */
+                        list_move_tail (&entry->lru, &client->lru);
+                        list_move_tail (&entry->glru, &drc->lru);
+                        drc->hits++;
+                        goto unlock;
+                }
+
+                drc->misses++;
+
+                entry = GF_CALLOC (1, sizeof (*entry),
+                                   gf_common_mt_rpcsvc_drc_entry_t);
+                if (!entry) {
+                        if (client->count == 0) {
+                                list_del_init (&client->list);
+                                GF_FREE (client);
+                                drc->client_count--;
+                        }
+                        goto unlock;
+                }
+
+                entry->xid = req->xid;
+                entry->prognum = req->prognum;
+                entry->progver = req->progver;
+                entry->procnum = req->procnum;
+                entry->csum = csum;
+                entry->msglen = msglen;
+                entry->mode = mode;
+                entry->state = RPCSVC_DRC_INPROGRESS;
+                entry->client = client;
+                INIT_LIST_HEAD (&entry->lru);
+                INIT_LIST_HEAD (&entry->glru);
+                list_add (&entry->hash,
+                          &client->xids[req->xid % RPCSVC_DRC_XID_BUCKETS]);
+                client->count++;
+
+                req->drc_entry = entry;
+        }
+unlock:
+        UNLOCK (&drc->lock);
+
+        if (!dup)
+                return 0;
+
+        gf_log (GF_RPCSVC, GF_LOG_DEBUG, "%s retransmit (XID: 0x%x, "
+                "Program: %d, ProgVers: %d, Proc: %d) from rpc-transport (%s)",
+                reply ? "replaying reply for" : "dropping", req->xid,
+                req->prognum, req->progver, req->procnum, req->trans->name);
+
+        if (reply) {
+                rpcsvc_drc_replay (req, reply, replylen);
+                GF_FREE (reply);
+        }
+
+        rpcsvc_request_destroy (req);
+        return 1;
+}
+
+
+/* Called once the reply for @req has been handed to the transport. The
+ * reply is kept for RPCSVC_DRC_REPLAY procedures that succeeded at the RPC
+ * level, all other entries are done with.
+ */
+void
+rpcsvc_drc_complete (rpcsvc_request_t *req, struct iovec *rpchdr,
+                     struct iovec *proghdr, int hdrcount,
+                     struct iovec *payload, int payloadcount)
+{
+        rpcsvc_drc_t            *drc = NULL;
+        rpcsvc_drc_entry_t      *entry = NULL;
+        rpcsvc_drc_entry_t      *victim = NULL;
+        rpcsvc_drc_client_t     *client = NULL;
+        struct iobuf_pool       *iobuf_pool = NULL;
+        char                    *reply = NULL;
+        size_t                   replylen = 0;
+        size_t                   off = 0;
+        int                      i = 0;
+
+        entry = req->drc_entry;
+        if (!entry)
+                return;
+
+        req->drc_entry = NULL;
+        drc = req->svc->drc;
+        iobuf_pool = req->svc->ctx->iobuf_pool;
+
+        if ((entry->mode == RPCSVC_DRC_REPLAY) &&
+            rpcsvc_request_accepted (req) &&
+            rpcsvc_request_accepted_success (req)) {
+                replylen = rpchdr->iov_len + iov_length (proghdr, hdrcount) +
+                           iov_length (payload, payloadcount);
+                if (replylen <= iobpool_default_pagesize (iobuf_pool))
+                        reply = GF_CALLOC (1, replylen,
+                                           gf_common_mt_rpcsvc_drc_reply);
+        }
+
+        if (reply) {
+                memcpy (reply, rpchdr->iov_base, rpchdr->iov_len);
+                off = rpchdr->iov_len;
+                for (i = 0; i < hdrcount; i++) {
+                        memcpy (reply + off, proghdr[i].iov_base,
+                                proghdr[i].iov_len);
+                        off += proghdr[i].iov_len;
+                }
+                for (i = 0; i < payloadcount; i++) {
+                        memcpy (reply + off, payload[i].iov_base,
+                                payload[i].iov_len);
+                        off += payload[i].iov_len;
+                }
+        }
+
+        LOCK (&drc->lock);
+        {
+                if (!reply) {
+                        __rpcsvc_drc_entry_destroy (drc, entry);
+                        goto unlock;
+                }
+
+                entry->reply = reply;
+                entry->replylen = replylen;
+                entry->state = RPCSVC_DRC_DONE;
+
+                client = entry->client;
+                list_add_tail (&entry->lru, &client->lru);
+                list_add_tail (&entry->glru, &drc->lru);
+                client->replies++;
+                drc->bytes += replylen;
+
+                while (client->replies > drc->size) {
+                        victim = list_entry (client->lru.next,
+                                             rpcsvc_drc_entry_t, lru);
+                        drc->evictions++;
+                        __rpcsvc_drc_entry_destroy (drc, victim);
+                }
+
+                /* @entry itself may go if it alone is over the limit */
+                while (drc->bytes > drc->limit) {
+                        victim = list_entry (drc->lru.next,
+                                             rpcsvc_drc_entry_t, glru);
+                        drc->evictions++;
+                        __rpcsvc_drc_entry_destroy (drc, victim);
+                }
+        }
+unlock:
+        UNLOCK (&drc->lock);
+}
+
+
+/* Drop the entry of a call that will not be answered. */
+void
+rpcsvc_drc_forget (rpcsvc_request_t *req)
+{
+        rpcsvc_drc_t            *drc = NULL;
+
+        if (!req->drc_entry)
+                return;
+
+        drc = req->svc->drc;
+
+        LOCK (&drc->lock);
+        {
+                __rpcsvc_drc_entry_destroy (drc, req->drc_entry);
+        }
+        UNLOCK (&drc->lock);
+
+        req->drc_entry = NULL;
+}
+
+
+/* The client of @trans may come back from the same address and
+ * retransmit, its replies are kept for RPCSVC_DRC_DISCONNECT_GRACE
+ * seconds.
+ */
+void
+rpcsvc_drc_disconnect (rpcsvc_t *svc, rpc_transport_t *trans)
+{
+        rpcsvc_drc_t            *drc = NULL;
+        rpcsvc_drc_client_t     *client = NULL;
+        int                      bucket = 0;
+
+        drc = svc->drc;
+        if (!drc)
+                return;
+
+        bucket = rpcsvc_drc_addr_hash (&trans->peerinfo.sockaddr);
+        if (bucket < 0)
+                return;
+
+        LOCK (&drc->lock);
+        {
+                client = __rpcsvc_drc_client_find (drc,
+                                                   &trans->peerinfo.sockaddr,
+                                                   bucket);
+                if (client)
+                        client->disconnected = time (NULL);
+        }
+        UNLOCK (&drc->lock);
+}
+
+
+int
+rpcsvc_drc_init (rpcsvc_t *svc, dict_t *options)
+{
+        rpcsvc_drc_t    *drc = NULL;
+        gf_boolean_t     enable = _gf_true;
+        char            *optstr = NULL;
+        int32_t          size = RPCSVC_DRC_DEFAULT_SIZE;
+        uint64_t         limit = RPCSVC_DRC_DEFAULT_LIMIT;
+        int              ret = -1;
+        int              i = 0;
+
+        if (dict_get (options, "rpc.drc")) {
+                ret = dict_get_str (options, "rpc.drc", &optstr);
+                if ((ret < 0) || (gf_string2boolean (optstr, &enable) < 0)) {
+                        gf_log (GF_RPCSVC, GF_LOG_ERROR, "Failed to parse "
+                                "rpc.drc");
+                        return -1;
+                }
+        }
+
+        if (dict_get (options, "rpc.drc-size")) {
+                ret = dict_get_str (options, "rpc.drc-size", &optstr);
+                if ((ret < 0) || (gf_string2int32 (optstr, &size) < 0) ||
+                    (size <= 0)) {
+                        gf_log (GF_RPCSVC, GF_LOG_ERROR, "Failed to parse "
+                                "rpc.drc-size");
+                        return -1;
+                }
+        }
+
+        if (dict_get (options, "rpc.drc-limit")) {
+                ret = dict_get_str (options, "rpc.drc-limit", &optstr);
+                if ((ret < 0) || (gf_string2bytesize (optstr, &limit) < 0) ||
+                    (limit == 0)) {
+                        gf_log (GF_RPCSVC, GF_LOG_ERROR, "Failed to parse "
+                                "rpc.drc-limit");
+                        return -1;
+                }
+        }
+
+        if (!enable) {
+                gf_log (GF_RPCSVC, GF_LOG_DEBUG, "Duplicate request cache "
+                        "disabled");
+                return 0;
+        }
+
+        drc = GF_CALLOC (1, sizeof (*drc), gf_common_mt_rpcsvc_drc_t);
+        if (!drc)
+                return -1;
+
+        LOCK_INIT (&drc->lock);
+        drc->size = size;
+        drc->limit = limit;
+        INIT_LIST_HEAD (&drc->lru);
+        for (i = 0; i < RPCSVC_DRC_CLIENT_BUCKETS; i++)
+                INIT_LIST_HEAD (&drc->clients[i]);
+
+        svc->drc = drc;
+        gf_log (GF_RPCSVC, GF_LOG_DEBUG, "Duplicate request cache: %d "
+                "replies per client, %"PRIu64" bytes in total", size, limit);
+
+        return 0;
+}
+
+
+void
+rpcsvc_drc_priv_dump (rpcsvc_t *svc)
+{
+        rpcsvc_drc_t    *drc = NULL;
+        char             key[GF_DUMP_MAX_BUF_LEN];
+
+        if (!svc || !svc->drc)
+                return;
+
+        drc = svc->drc;
+
+        gf_proc_dump_add_section ("rpcsvc.drc");
+
+        LOCK (&drc->lock);
+        {
+                gf_proc_dump_build_key (key, "rpcsvc.drc", "size");
+                gf_proc_dump_write (key, "%d", drc->size);
+                gf_proc_dump_build_key (key, "rpcsvc.drc", "limit");
+                gf_proc_dump_write (key, "%zu", drc->limit);
+                gf_proc_dump_build_key (key, "rpcsvc.drc", "bytes");
+                gf_proc_dump_write (key, "%zu", drc->bytes);
+                gf_proc_dump_build_key (key, "rpcsvc.drc", "clients");
+                gf_proc_dump_write (key, "%d", drc->client_count);
+                gf_proc_dump_build_key (key, "rpcsvc.drc", "hits");
+                gf_proc_dump_write (key, "%"PRIu64, drc->hits);
+                gf_proc_dump_build_key (key, "rpcsvc.drc", "drops");
+                gf_proc_dump_write (key, "%"PRIu64, drc->drops);
+                gf_proc_dump_build_key (key, "rpcsvc.drc", "misses");
+                gf_proc_dump_write (key, "%"PRIu64, drc->misses);
+                gf_proc_dump_build_key (key, "rpcsvc.drc", "evictions");
+                gf_proc_dump_write (key, "%"PRIu64, drc->evictions);
+        }
+        UNLOCK (&drc->lock);
+}
@@ -0,0 +1,493 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/* Admission control and fair queuing of incoming calls.
+ *
+ * Every connection may have rpc.outstanding-rpc-limit calls received and
+ * not yet answered. Once a connection reaches it, the transport stops
+ * reading from it until half of those calls have been answered, so a
+ * client flooding the server is held back in its own socket buffers. The
+ * limit is off by default: a brick must not stop reading a client whose
+ * blocking inodelk/entrylk calls wait on an unlock still in the socket.
+ * nfs/server turns it on for its own service.
+ *
+ * With rpc.fair-queue-limit set, at most that many calls are handed to the
+ * actors at once. Calls beyond it are parked on a queue per connection and
+ * served weighted round robin: a connection gets as many calls in a row as
+ * its weight before the next connection's turn. Connections from the
+ * addresses in rpc.internal-clients (and unix sockets) are weighted with
+ * rpc.fair-queue-weight-internal, all others with
+ * rpc.fair-queue-weight-external. Calls of blocking actors (inodelk,
+ * entrylk and lk on a brick) bypass the limit: with every slot held by a
+ * waiting lock, the unlock that frees them would stay parked for good.
+ */
+
+#include "rpcsvc.h"
+#include "logging.h"
+#include "dict.h"
+#include "statedump.h"
+#include "mem-types.h"
+
+#include <fnmatch.h>
+#include <netdb.h>
+
+
+static int
+rpcsvc_fq_is_internal (rpcsvc_fq_t *fq, rpc_transport_t *trans)
+{
+        char    addr[NI_MAXHOST] = {0,};
+        char   *patterns = NULL;
+        char   *pattern = NULL;
+        char   *saveptr = NULL;
+        int     internal = 0;
+        int     ret = -1;
+
+        if (trans->peerinfo.sockaddr.ss_family == AF_UNIX)
+                return 1;
+
+        if (!fq->internal_clients)
+                return 0;
+
+        ret = getnameinfo ((struct sockaddr *)&trans->peerinfo.sockaddr,
+                           trans->peerinfo.sockaddr_len, addr, sizeof (addr),
+                           NULL, 0, NI_NUMERICHOST);
+        if (ret != 0)
+                return 0;
+
+        patterns = gf_strdup (fq->internal_clients);
+        if (!patterns)
+                return 0;
+
+        pattern = strtok_r (patterns, ",", &saveptr);
+        while (pattern) {
+                if (fnmatch (pattern, addr, 0) == 0) {
+                        internal = 1;
+                        break;
+                }
+                pattern = strtok_r (NULL, ",", &saveptr);
+        }
+
+        GF_FREE (patterns);
+        return internal;
+}
+
+
+void
+rpcsvc_fq_accept (rpcsvc_t *svc, rpc_transport_t *trans)
+{
+        rpcsvc_fq_t             *fq = NULL;
+        rpcsvc_fq_client_t      *client = NULL;
+
+        if (!svc || !svc->fq || !trans)
+                return;
+
+        fq = svc->fq;
+        client = GF_CALLOC (1, sizeof (*client),
+                            gf_common_mt_rpcsvc_fq_client_t);
+        if (!client)
+                return;
+
+        client->trans = trans;
+        INIT_LIST_HEAD (&client->list);
+        INIT_LIST_HEAD (&client->active);
+        INIT_LIST_HEAD (&client->calls);
+        client->internal = rpcsvc_fq_is_internal (fq, trans);
+        client->weight = (client->internal) ? fq->internal_weight
+                : fq->external_weight;
+
+        pthread_mutex_lock (&fq->lock);
+        {
+                list_add_tail (&client->list, &fq->clients);
+                fq->client_count++;
+        }
+        pthread_mutex_unlock (&fq->lock);
+
+        trans->fq_client = client;
+}
+
+
+/* The transport is being freed, none of its calls is left. */
+void
+rpcsvc_fq_cleanup (rpcsvc_t *svc, rpc_transport_t *trans)
+{
+        rpcsvc_fq_t             *fq = NULL;
+        rpcsvc_fq_client_t      *client = NULL;
+
+        if (!svc || !svc->fq || !trans || !trans->fq_client)
+                return;
+
+        fq = svc->fq;
+        client = trans->fq_client;
+        pthread_mutex_lock (&fq->lock);
+        {
+                list_del_init (&client->list);
+                list_del_init (&client->active);
+                fq->client_count--;
+        }
+        pthread_mutex_unlock (&fq->lock);
+
+        trans->fq_client = NULL;
+        GF_FREE (client);
+}
+
+
+/* Account a call about to be handed to @actor. Returns 1 when the call
+ * has been parked, it is then served by rpcsvc_fq_dispatch and must not
+ * be touched any more by the caller.
+ */
+int
+rpcsvc_fq_admit (rpcsvc_request_t *req, rpcsvc_actor_t *actor)
+{
+        rpcsvc_fq_t             *fq = NULL;
+        rpcsvc_fq_client_t      *client = NULL;
+        rpc_transport_t         *trans = NULL;
+        int                      throttle = 0;
+        int                      parked = 0;
+
+        fq = req->svc->fq;
+        trans = req->trans;
+        client = trans->fq_client;
+        if (!fq || !client)
+                return 0;
+
+        pthread_mutex_lock (&fq->lock);
+        {
+                client->outstanding++;
+                if ((fq->outstanding_limit) && (!client->throttled) &&
+                    (client->outstanding >= fq->outstanding_limit)) {
+                        client->throttled = 1;
+                        fq->throttles++;
+                        throttle = 1;
+                }
+
+                if (actor->blocking) {
+                        req->fq_state = RPCSVC_FQ_EXEMPT;
+                        goto unlock;
+                }
+
+                if ((!fq->inservice_limit) ||
+                    ((fq->inservice < fq->inservice_limit) &&
+                     (list_empty (&fq->active)))) {
+                        fq->inservice++;
+                        req->fq_state = RPCSVC_FQ_INSERVICE;
+                        goto unlock;
+                }
+
+                req->fq_state = RPCSVC_FQ_QUEUED;
+                req->actor = actor;
+                list_add_tail (&req->fq_list, &client->calls);
+                client->queued++;
+                fq->queued++;
+                fq->parked++;
+                if (list_empty (&client->active))
+                        list_add_tail (&client->active, &fq->active);
+                parked = 1;
+        }
+unlock:
+        pthread_mutex_unlock (&fq->lock);
+
+        if (throttle) {
+                gf_log (GF_RPCSVC, GF_LOG_DEBUG, "%d calls outstanding on %s,"
+                        " not reading from it", fq->outstanding_limit,
+                        trans->peerinfo.identifier);
+                rpc_transport_throttle (trans, _gf_true);
+        }
+
+        return parked;
+}
+
+
+/* Pick the next parked call: the connection at the head of the round
+ * gets up to its weight of calls before it goes to the tail.
+ */
+static rpcsvc_request_t *
+__rpcsvc_fq_next (rpcsvc_fq_t *fq)
+{
+        rpcsvc_fq_client_t      *client = NULL;
+        rpcsvc_request_t        *req = NULL;
+
+        if ((fq->inservice >= fq->inservice_limit) ||
+            (list_empty (&fq->active)))
+                return NULL;
+
+        client = list_entry (fq->active.next, rpcsvc_fq_client_t, active);
+        if (client->credit <= 0)
+                client->credit = client->weight;
+
+        req = list_entry (client->calls.next, rpcsvc_request_t, fq_list);
+        list_del_init (&req->fq_list);
+        client->queued--;
+        fq->queued--;
+        fq->inservice++;
+        req->fq_state = RPCSVC_FQ_INSERVICE;
+
+        list_del_init (&client->active);
+        if (--client->credit <= 0)
+                client->credit = 0;
+        if (client->queued) {
+                if (client->credit)
+                        list_add (&client->active, &fq->active);
+                else
+                        list_add_tail (&client->active, &fq->active);
+        } else
+                client->credit = 0;
+
+        return req;
+}
+
+
+/* Serve parked calls while there is room. Only one thread does it at a
+ * time, others freeing a slot meanwhile leave the call to that thread,
+ * which also keeps actors answering synchronously from recursing.
+ */
+void
+rpcsvc_fq_dispatch (rpcsvc_t *svc)
+{
+        rpcsvc_fq_t             *fq = NULL;
+        rpcsvc_request_t        *req = NULL;
+        xlator_t                *old_THIS = NULL;
+
+        fq = svc->fq;
+        if (!fq || !fq->inservice_limit)
+                return;
+
+        old_THIS = THIS;
+
+        pthread_mutex_lock (&fq->lock);
+        {
+                if (fq->dispatching)
+                        goto unlock;
+
+                fq->dispatching = 1;
+                while ((req = __rpcsvc_fq_next (fq)) != NULL) {
+                        pthread_mutex_unlock (&fq->lock);
+                        rpcsvc_request_dispatch (req, req->actor);
+                        pthread_mutex_lock (&fq->lock);
+                }
+                fq->dispatching = 0;
+        }
+unlock:
+        pthread_mutex_unlock (&fq->lock);
+
+        /* The actors set THIS to the service's xlator */
+        THIS = old_THIS;
+}
+
+
+/* The call is done with, give back its slot and, once half of the calls
+ * of a throttled connection have been answered, read from it again. Called
+ * for an ignored call and again when it is destroyed, only the first call
+ * counts.
+ */
+void
+rpcsvc_fq_release (rpcsvc_request_t *req)
+{
+        rpcsvc_fq_t             *fq = NULL;
+        rpcsvc_fq_client_t      *client = NULL;
+        int                      unthrottle = 0;
+        int                      dispatch = 0;
+
+        fq = req->svc->fq;
+        client = req->trans->fq_client;
+        if (!fq || !client)
+                return;
+
+        pthread_mutex_lock (&fq->lock);
+        {
+                /* Parked calls are only ever destroyed after being
+                 * dispatched.
+                 */
+                if ((req->fq_state != RPCSVC_FQ_INSERVICE) &&
+                    (req->fq_state != RPCSVC_FQ_EXEMPT))
+                        goto unlock;
+
+                if (req->fq_state == RPCSVC_FQ_INSERVICE) {
+                        fq->inservice--;
+                        dispatch = !list_empty (&fq->active);
+                }
+                req->fq_state = RPCSVC_FQ_NONE;
+                client->outstanding--;
+                if ((client->throttled) &&
+                    (client->outstanding <= fq->outstanding_limit / 2)) {
+                        client->throttled = 0;
+                        unthrottle = 1;
+                }
+        }
+unlock:
+        pthread_mutex_unlock (&fq->lock);
+
+        if (unthrottle)
+                rpc_transport_throttle (req->trans, _gf_false);
+
+        if (dispatch)
+                rpcsvc_fq_dispatch (req->svc);
+}
+
+
+int
+rpcsvc_fq_init (rpcsvc_t *svc, dict_t *options)
+{
+        rpcsvc_fq_t     *fq = NULL;
+        char            *optstr = NULL;
+        int32_t          outstanding = RPCSVC_DEFAULT_OUTSTANDING_RPC_LIMIT;
+        int32_t          inservice = 0;
+        int32_t          internal = RPCSVC_FQ_DEFAULT_INTERNAL_WEIGHT;
+        int32_t          external = RPCSVC_FQ_DEFAULT_EXTERNAL_WEIGHT;
+        int              ret = -1;
+
+        if (dict_get (options, "rpc.outstanding-rpc-limit")) {
+                ret = dict_get_str (options, "rpc.outstanding-rpc-limit",
+                                    &optstr);
+                if ((ret < 0) || (gf_string2int32 (optstr, &outstanding) < 0)
+                    || (outstanding < 0)) {
+                        gf_log (GF_RPCSVC, GF_LOG_ERROR, "Failed to parse "
+                                "rpc.outstanding-rpc-limit");
+                        return -1;
+                }
+        }
+
+        if (dict_get (options, "rpc.fair-queue-limit")) {
+                ret = dict_get_str (options, "rpc.fair-queue-limit", &optstr);
+                if ((ret < 0) || (gf_string2int32 (optstr, &inservice) < 0)
+                    || (inservice < 0)) {
+                        gf_log (GF_RPCSVC, GF_LOG_ERROR, "Failed to parse "
+                                "rpc.fair-queue-limit");
+                        return -1;
+                }
+        }
+
+        if (dict_get (options, "rpc.fair-queue-weight-internal")) {
+                ret = dict_get_str (options, "rpc.fair-queue-weight-internal",
+                                    &optstr);
+                if ((ret < 0) || (gf_string2int32 (optstr, &internal) < 0)
+                    || (internal <= 0)) {
+                        gf_log (GF_RPCSVC, GF_LOG_ERROR, "Failed to parse "
+                                "rpc.fair-queue-weight-internal");
+                        return -1;
+                }
+        }
+
+        if (dict_get (options, "rpc.fair-queue-weight-external")) {
+                ret = dict_get_str (options, "rpc.fair-queue-weight-external",
+                                    &optstr);
+                if ((ret < 0) || (gf_string2int32 (optstr, &external) < 0)
+                    || (external <= 0)) {
+                        gf_log (GF_RPCSVC, GF_LOG_ERROR, "Failed to parse "
+                                "rpc.fair-queue-weight-external");
+                        return -1;
+                }
+        }
+
+        optstr = NULL;
+        if (dict_get (options, "rpc.internal-clients")) {
+                ret = dict_get_str (options, "rpc.internal-clients", &optstr);
+                if (ret < 0) {
+                        gf_log (GF_RPCSVC, GF_LOG_ERROR, "Failed to parse "
+                                "rpc.internal-clients");
+                        return -1;
+                }
+        }
+
+        if (!outstanding && !inservice) {
+                gf_log (GF_RPCSVC, GF_LOG_DEBUG, "Admission control disabled");
+                return 0;
+        }
+
+        fq = GF_CALLOC (1, sizeof (*fq), gf_common_mt_rpcsvc_fq_t);
+        if (!fq)
+                return -1;
+
+        pthread_mutex_init (&fq->lock, NULL);
+        INIT_LIST_HEAD (&fq->clients);
+        INIT_LIST_HEAD (&fq->active);
+        fq->outstanding_limit = outstanding;
+        fq->inservice_limit = inservice;
+        fq->internal_weight = internal;
+        fq->external_weight = external;
+        if (optstr) {
+                fq->internal_clients = gf_strdup (optstr);
+                if (!fq->internal_clients) {
+                        GF_FREE (fq);
+                        return -1;
+                }
+        }
+
+        svc->fq = fq;
+        gf_log (GF_RPCSVC, GF_LOG_DEBUG, "Admission control: %d calls per "
+                "connection, %d calls served at once", outstanding, inservice);
+
+        return 0;
+}
+
+
+void
+rpcsvc_fq_priv_dump (rpcsvc_t *svc)
+{
+        rpcsvc_fq_t             *fq = NULL;
+        rpcsvc_fq_client_t      *client = NULL;
+        char                     key[GF_DUMP_MAX_BUF_LEN];
+        char                     key_prefix[GF_DUMP_MAX_BUF_LEN];
+        int                      i = 0;
+
+        if (!svc || !svc->fq)
+                return;
+
+        fq = svc->fq;
+
+        gf_proc_dump_add_section ("rpcsvc.fair-queue");
+
+        pthread_mutex_lock (&fq->lock);
+        {
+                gf_proc_dump_build_key (key, "rpcsvc.fair-queue",
+                                        "outstanding-rpc-limit");
+                gf_proc_dump_write (key, "%d", fq->outstanding_limit);
+                gf_proc_dump_build_key (key, "rpcsvc.fair-queue", "limit");
+                gf_proc_dump_write (key, "%d", fq->inservice_limit);
+                gf_proc_dump_build_key (key, "rpcsvc.fair-queue", "inservice");
+                gf_proc_dump_write (key, "%d", fq->inservice);
+                gf_proc_dump_build_key (key, "rpcsvc.fair-queue", "queued");
+                gf_proc_dump_write (key, "%d", fq->queued);
+                gf_proc_dump_build_key (key, "rpcsvc.fair-queue", "parked");
+                gf_proc_dump_write (key, "%"PRIu64, fq->parked);
+                gf_proc_dump_build_key (key, "rpcsvc.fair-queue", "throttles");
+                gf_proc_dump_write (key, "%"PRIu64, fq->throttles);
+                gf_proc_dump_build_key (key, "rpcsvc.fair-queue", "clients");
+                gf_proc_dump_write (key, "%d", fq->client_count);
+
+                list_for_each_entry (client, &fq->clients, list) {
+                        snprintf (key_prefix, GF_DUMP_MAX_BUF_LEN,
+                                  "rpcsvc.fair-queue.client.%d", i++);
+                        gf_proc_dump_build_key (key, key_prefix, "peer");
+                        gf_proc_dump_write (key, "%s",
+                                            client->trans->peerinfo.identifier);
+                        gf_proc_dump_build_key (key, key_prefix, "internal");
+                        gf_proc_dump_write (key, "%d", client->internal);
+                        gf_proc_dump_build_key (key, key_prefix, "weight");
+                        gf_proc_dump_write (key, "%d", client->weight);
+                        gf_proc_dump_build_key (key, key_prefix,
+                                                "outstanding");
+                        gf_proc_dump_write (key, "%d", client->outstanding);
+                        gf_proc_dump_build_key (key, key_prefix, "queued");
+                        gf_proc_dump_write (key, "%d", client->queued);
+                        gf_proc_dump_build_key (key, key_prefix, "throttled");
+                        gf_proc_dump_write (key, "%d", client->throttled);
+                }
+        }
+        pthread_mutex_unlock (&fq->lock);
+}
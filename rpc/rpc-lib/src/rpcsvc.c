@@ -256,6 +256,7 @@ rpcsvc_accept (rpcsvc_t *svc, rpc_transport_t *listen_trans,
                 goto out;
         }
 
+        rpcsvc_fq_accept (svc, new_trans);
         rpcsvc_program_notify (listener, RPCSVC_EVENT_ACCEPT, new_trans);
         ret = 0;
 out:
@@ -274,6 +275,11 @@ rpcsvc_request_destroy (rpcsvc_request_t *req)
                 iobref_unref (req->iobref);
         }
 
+        /* a call that goes away unanswered must not swallow retransmits */
+        rpcsvc_drc_forget (req);
+
+        rpcsvc_fq_release (req);
+
         rpc_transport_unref (req->trans);
 
         mem_put (req->svc->rxpool, req);
@@ -314,6 +320,7 @@ rpcsvc_request_init (rpcsvc_t *svc, rpc_transport_t *trans,
         req->trans_private = msg->private;
 
         INIT_LIST_HEAD (&req->txlist);
+        INIT_LIST_HEAD (&req->fq_list);
         req->payloadsize = 0;
 
         /* By this time, the data bytes for the auth scheme would have already
@@ -488,24 +495,21 @@ rpcsvc_handle_rpc_call (rpcsvc_t *svc, rpc_transport_t *trans,
                 goto err_reply;
 
         if (actor && (req->rpc_err == SUCCESS)) {
-                /* Before going to xlator code, set the THIS properly */
-                THIS = svc->mydata;
-
-                if (req->count == 2) {
-                        if (actor->vector_actor) {
-                                ret = actor->vector_actor (req, &req->msg[1], 1,
-                                                           req->iobref);
-                        } else {
-                                rpcsvc_request_seterr (req, PROC_UNAVAIL);
-                                /* LOG TODO: print more info about procnum,
-                                   prognum etc, also print transport info */
-                                gf_log (GF_RPCSVC, GF_LOG_ERROR,
-                                        "No vectored handler present");
-                                ret = RPCSVC_ACTOR_ERROR;
-                        }
-                } else if (actor->actor) {
-                        ret = actor->actor (req);
+                /* A retransmit is dropped or answered from the duplicate
+                 * request cache, the request is gone then.
+                 */
+                if (rpcsvc_drc_check (req, actor->drc)) {
+                        ret = 0;
+                        goto err;
                 }
+
+                /* Over the fair queuing limit, the call waits for its turn */
+                if (rpcsvc_fq_admit (req, actor)) {
+                        ret = 0;
+                        goto err;
+                }
+
+                return rpcsvc_request_dispatch (req, actor);
         }
 
 err_reply:
@@ -525,6 +529,51 @@ err:
 }
 
 
+/* Hand an accepted call to its actor. */
+int
+rpcsvc_request_dispatch (rpcsvc_request_t *req, rpcsvc_actor_t *actor)
+{
+        int                     ret = -1;
+
+        /* Before going to xlator code, set the THIS properly */
+        THIS = req->svc->mydata;
+
+        if (req->count == 2) {
+                if (actor->vector_actor) {
+                        ret = actor->vector_actor (req, &req->msg[1], 1,
+                                                   req->iobref);
+                } else {
+                        rpcsvc_request_seterr (req, PROC_UNAVAIL);
+                        /* LOG TODO: print more info about procnum,
+                           prognum etc, also print transport info */
+                        gf_log (GF_RPCSVC, GF_LOG_ERROR,
+                                "No vectored handler present");
+                        ret = RPCSVC_ACTOR_ERROR;
+                }
+        } else if (actor->actor) {
+                ret = actor->actor (req);
+        }
+
+        /* no reply will be sent, and @req stays with the actor: give back
+           its slot now, nothing else will */
+        if (ret == RPCSVC_ACTOR_IGNORE) {
+                rpcsvc_drc_forget (req);
+                rpcsvc_fq_release (req);
+        }
+
+        if (ret == RPCSVC_ACTOR_ERROR) {
+                ret = rpcsvc_error_reply (req);
+        }
+
+        if (ret)
+                gf_log ("rpcsvc", GF_LOG_WARNING, "failed to queue error reply");
+
+        /* No need to propagate error beyond this function since the reply
+         * has now been queued. */
+        return 0;
+}
+
+
 int
 rpcsvc_handle_disconnect (rpcsvc_t *svc, rpc_transport_t *trans)
 {
@@ -536,6 +585,9 @@ rpcsvc_handle_disconnect (rpcsvc_t *svc, rpc_transport_t *trans)
         event = (trans->listener == NULL) ? RPCSVC_EVENT_LISTENER_DEAD
                 : RPCSVC_EVENT_DISCONNECT;
 
+        if (event == RPCSVC_EVENT_DISCONNECT)
+                rpcsvc_drc_disconnect (svc, trans);
+
         pthread_mutex_lock (&svc->rpclock);
         {
                 wrappers = GF_CALLOC (svc->notify_count, sizeof (*wrapper),
@@ -618,6 +670,7 @@ rpcsvc_notify (rpc_transport_t *trans, void *mydata,
                 break;
 
         case RPC_TRANSPORT_CLEANUP:
+                rpcsvc_fq_cleanup (svc, trans);
                 listener = rpcsvc_get_listener (svc, -1, trans->listener);
                 if (listener == NULL) {
                         goto out;
@@ -1065,6 +1118,9 @@ rpcsvc_submit_generic (rpcsvc_request_t *req, struct iovec *proghdr,
                         "(%s)", req->xid, req->prog ? req->prog->progname: "-",
                         req->prog ? req->prog->progver : 0,
                         req->procnum, trans->name);
+
+                rpcsvc_drc_complete (req, &recordhdr, proghdr, hdrcount,
+                                     payload, payloadcount);
         }
 
 disconnect_exit:
@@ -1827,6 +1883,20 @@ rpcsvc_init (xlator_t *xl, glusterfs_ctx_t *ctx, dict_t *options)
                 goto free_svc;
         }
 
+        ret = rpcsvc_drc_init (svc, options);
+        if (ret == -1) {
+                gf_log (GF_RPCSVC, GF_LOG_ERROR, "Failed to init "
+                        "duplicate request cache");
+                goto free_svc;
+        }
+
+        ret = rpcsvc_fq_init (svc, options);
+        if (ret == -1) {
+                gf_log (GF_RPCSVC, GF_LOG_ERROR, "Failed to init "
+                        "admission control");
+                goto free_svc;
+        }
+
         ret = -1;
         svc->options = options;
         svc->ctx = ctx;
@@ -247,6 +247,16 @@ struct rpcsvc_request {
 
         /* Container for transport to store request-specific item */
         void                    *trans_private;
+
+        /* Duplicate request cache entry of the call, while it is served */
+        struct rpcsvc_drc_entry *drc_entry;
+
+        /* Admission control state of the call, and the actor and the hook
+         * on its connection's queue while it is parked.
+         */
+        int                     fq_state;
+        struct rpcsvc_actor_desc *actor;
+        struct list_head        fq_list;
 };
 
 #define rpcsvc_request_program(req) ((rpcsvc_program_t *)((req)->prog))
@@ -309,6 +319,15 @@ typedef void (*rpcsvc_deallocate_reply) (void *msg);
 
 
 #define RPCSVC_NAME_MAX            32
+
+/* Duplicate request cache modes of a procedure. Idempotent procedures
+ * use RPCSVC_DRC_INFLIGHT so that a retransmit of a call still being
+ * served is dropped, non-idempotent ones use RPCSVC_DRC_REPLAY so that a
+ * retransmit of a call already answered gets the same reply again.
+ */
+#define RPCSVC_DRC_NONE         0
+#define RPCSVC_DRC_INFLIGHT     1
+#define RPCSVC_DRC_REPLAY       2
 /* The descriptor for each procedure/actor that runs
  * over the RPC service.
  */
@@ -328,6 +347,17 @@ typedef struct rpcsvc_actor_desc {
         rpcsvc_vector_actor     vector_actor;
         rpcsvc_vector_sizer     vector_sizer;
 
+        /* How retransmits of this procedure are handled by the duplicate
+         * request cache, one of RPCSVC_DRC_NONE, RPCSVC_DRC_INFLIGHT or
+         * RPCSVC_DRC_REPLAY.
+         */
+        int                     drc;
+
+        /* Calls of this procedure may wait for a later call of the same
+         * service (blocking locks wait for the unlock). They go to the actor
+         * at once and take no slot of rpc.fair-queue-limit.
+         */
+        int                     blocking;
 } rpcsvc_actor_t;
 
 /* Describes a program and its version along with the function pointers
@@ -448,6 +478,9 @@ rpcsvc_submit_generic (rpcsvc_request_t *req, struct iovec *proghdr,
 extern int
 rpcsvc_error_reply (rpcsvc_request_t *req);
 
+void
+rpcsvc_request_destroy (rpcsvc_request_t *req);
+
 #define RPCSVC_PEER_STRLEN      1024
 #define RPCSVC_AUTH_ACCEPT      1
 #define RPCSVC_AUTH_REJECT      2
@@ -560,4 +593,159 @@ rpcsvc_vector_sizer
 rpcsvc_get_program_vector_sizer (rpcsvc_t *svc, uint32_t prognum,
                                  uint32_t progver, uint32_t procnum);
 
+extern int
+rpcsvc_transport_submit (rpc_transport_t *trans, struct iovec *hdrvec,
+                         int hdrcount, struct iovec *proghdr, int proghdrcount,
+                         struct iovec *progpayload, int progpayloadcount,
+                         struct iobref *iobref, void *priv);
+
+#define RPCSVC_DRC_DEFAULT_SIZE         128
+#define RPCSVC_DRC_DEFAULT_LIMIT        (32 * GF_UNIT_MB)
+#define RPCSVC_DRC_CLIENT_BUCKETS       64
+#define RPCSVC_DRC_XID_BUCKETS          64
+#define RPCSVC_DRC_CSUM_BYTES           256
+/* Seconds between two sweeps for client tables to drop, the replies of a
+ * client are dropped once it has been disconnected for
+ * RPCSVC_DRC_DISCONNECT_GRACE seconds, or idle for RPCSVC_DRC_IDLE_TIMEOUT.
+ */
+#define RPCSVC_DRC_REAP_INTERVAL        10
+#define RPCSVC_DRC_DISCONNECT_GRACE     120
+#define RPCSVC_DRC_IDLE_TIMEOUT         900
+
+#define RPCSVC_DRC_INPROGRESS   1
+#define RPCSVC_DRC_DONE         2
+
+typedef struct rpcsvc_drc_client rpcsvc_drc_client_t;
+
+typedef struct rpcsvc_drc_entry {
+        struct list_head         hash;          /* in client->xids */
+        struct list_head         lru;           /* in client->lru once done */
+        struct list_head         glru;          /* in drc->lru once done */
+        rpcsvc_drc_client_t     *client;
+        uint32_t                 xid;
+        int                      prognum;
+        int                      progver;
+        int                      procnum;
+        uint32_t                 csum;
+        size_t                   msglen;
+        int                      mode;
+        int                      state;
+        char                    *reply;         /* encoded reply, no fraghdr */
+        size_t                   replylen;
+} rpcsvc_drc_entry_t;
+
+struct rpcsvc_drc_client {
+        struct list_head         list;          /* in drc->clients */
+        struct sockaddr_storage  addr;
+        struct list_head         xids[RPCSVC_DRC_XID_BUCKETS];
+        struct list_head         lru;
+        int                      count;         /* all entries */
+        int                      replies;       /* entries on the lru */
+        time_t                   stamp;         /* last call */
+        time_t                   disconnected;  /* 0 while connected */
+};
+
+typedef struct rpcsvc_drc {
+        gf_lock_t                lock;
+        int                      size;          /* replies kept per client */
+        size_t                   limit;         /* bytes kept in total */
+        size_t                   bytes;
+        struct list_head         lru;           /* replies of all clients */
+        struct list_head         clients[RPCSVC_DRC_CLIENT_BUCKETS];
+        int                      client_count;
+        time_t                   reaped;        /* last sweep */
+        uint64_t                 hits;
+        uint64_t                 drops;
+        uint64_t                 misses;
+        uint64_t                 evictions;
+} rpcsvc_drc_t;
+
+extern int
+rpcsvc_drc_init (rpcsvc_t *svc, dict_t *options);
+
+extern int
+rpcsvc_drc_check (rpcsvc_request_t *req, int mode);
+
+extern void
+rpcsvc_drc_complete (rpcsvc_request_t *req, struct iovec *rpchdr,
+                     struct iovec *proghdr, int hdrcount,
+                     struct iovec *payload, int payloadcount);
+
+extern void
+rpcsvc_drc_forget (rpcsvc_request_t *req);
+
+extern void
+rpcsvc_drc_disconnect (rpcsvc_t *svc, rpc_transport_t *trans);
+
+extern void
+rpcsvc_drc_priv_dump (rpcsvc_t *svc);
+
+/* Off unless asked for: a brick must keep reading a client blocked on
+ * inodelk/entrylk, or the unlock freeing it is never read.
+ */
+#define RPCSVC_DEFAULT_OUTSTANDING_RPC_LIMIT    0
+#define RPCSVC_FQ_DEFAULT_INTERNAL_WEIGHT       1
+#define RPCSVC_FQ_DEFAULT_EXTERNAL_WEIGHT       4
+
+#define RPCSVC_FQ_NONE          0
+#define RPCSVC_FQ_QUEUED        1
+#define RPCSVC_FQ_INSERVICE     2
+#define RPCSVC_FQ_EXEMPT        3
+
+/* Admission control state of a connection, see rpcsvc-fq.c */
+typedef struct rpcsvc_fq_client {
+        struct list_head         list;          /* in fq->clients */
+        struct list_head         active;        /* in fq->active if queued */
+        rpc_transport_t         *trans;
+        int                      internal;
+        int                      weight;
+        int                      credit;        /* calls left in its turn */
+        int                      outstanding;   /* received, not answered */
+        int                      throttled;     /* not read from */
+        struct list_head         calls;         /* parked calls */
+        int                      queued;
+} rpcsvc_fq_client_t;
+
+typedef struct rpcsvc_fq {
+        pthread_mutex_t          lock;
+        int                      outstanding_limit;     /* per connection */
+        int                      inservice_limit;       /* 0: no queuing */
+        int                      internal_weight;
+        int                      external_weight;
+        char                    *internal_clients;
+        struct list_head         clients;
+        int                      client_count;
+        struct list_head         active;        /* connections with calls
+                                                   parked, in serving order */
+        int                      inservice;
+        int                      queued;
+        int                      dispatching;
+        uint64_t                 parked;
+        uint64_t                 throttles;
+} rpcsvc_fq_t;
+
+extern int
+rpcsvc_fq_init (rpcsvc_t *svc, dict_t *options);
+
+extern void
+rpcsvc_fq_accept (rpcsvc_t *svc, rpc_transport_t *trans);
+
+extern void
+rpcsvc_fq_cleanup (rpcsvc_t *svc, rpc_transport_t *trans);
+
+extern int
+rpcsvc_fq_admit (rpcsvc_request_t *req, rpcsvc_actor_t *actor);
+
+extern void
+rpcsvc_fq_dispatch (rpcsvc_t *svc);
+
+extern void
+rpcsvc_fq_release (rpcsvc_request_t *req);
+
+extern void
+rpcsvc_fq_priv_dump (rpcsvc_t *svc);
+
+extern int
+rpcsvc_request_dispatch (rpcsvc_request_t *req, rpcsvc_actor_t *actor);
+
 #endif
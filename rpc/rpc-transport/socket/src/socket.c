@@ -137,6 +137,16 @@
 
 int socket_init (rpc_transport_t *this);
 
+/* ioq entries of all the connections of the process */
+static struct mem_pool *socket_ioq_pool;
+static pthread_once_t   socket_ioq_pool_once = PTHREAD_ONCE_INIT;
+
+static void
+socket_ioq_pool_init (void)
+{
+        socket_ioq_pool = mem_pool_new (struct ioq, GF_SOCKET_IOQ_POOL_SIZE);
+}
+
 /*
  * return value:
  *   0 = success (completed)
@@ -172,6 +182,7 @@ __socket_rwv (rpc_transport_t *this, struct iovec *vector, int count,
         while (opcount) {
                 if (write) {
                         ret = writev (sock, opvector, opcount);
+                        this->total_write_calls++;
 
                         if (ret == 0 || (ret == -1 && errno == EAGAIN)) {
                                 /* done for now */
@@ -180,6 +191,7 @@ __socket_rwv (rpc_transport_t *this, struct iovec *vector, int count,
                         this->total_bytes_write += ret;
                 } else {
                         ret = readv (sock, opvector, opcount);
+                        this->total_read_calls++;
                         if (ret == -1 && errno == EAGAIN) {
                                 /* done for now */
                                 break;
@@ -241,15 +253,150 @@ out:
 }
 
 
+/* Fills vector first from whatever an earlier read left in priv->rbuf,
+ * then with a single readv which puts the bytes asked for straight into
+ * vector (large payloads land in their iobufs without a copy) and reads
+ * ahead into priv->rbuf whatever else the socket holds, which usually
+ * is the next few records on a stream of small messages.
+ */
+int
+__socket_buffered_readv (rpc_transport_t *this, struct iovec *vector,
+                         int count, struct iovec **pending_vector,
+                         int *pending_count, size_t *bytes)
+{
+        socket_private_t *priv = NULL;
+        struct iovec      iov[MAX_IOVEC + 1];
+        struct iovec     *opvector = NULL;
+        int               opcount = 0;
+        int               iovcnt = 0;
+        size_t            wanted = 0;
+        size_t            avail = 0;
+        size_t            copy = 0;
+        ssize_t           ret = 0;
+        int               i = 0;
+
+        priv = this->private;
+
+        opvector = vector;
+        opcount  = count;
+
+        if (bytes != NULL) {
+                *bytes = 0;
+        }
+
+        if (!priv->rbuf.buf) {
+                priv->rbuf.buf = GF_MALLOC (priv->rbuf.size,
+                                            gf_common_mt_char);
+                if (!priv->rbuf.buf) {
+                        opcount = -1;
+                        errno = ENOMEM;
+                        goto out;
+                }
+                priv->rbuf.start = priv->rbuf.end = 0;
+        }
+
+        while (opcount) {
+                avail = priv->rbuf.end - priv->rbuf.start;
+                if (avail) {
+                        copy = min (avail, opvector[0].iov_len);
+                        memcpy (opvector[0].iov_base,
+                                priv->rbuf.buf + priv->rbuf.start, copy);
+                        priv->rbuf.start += copy;
+                        opvector[0].iov_base += copy;
+                        opvector[0].iov_len -= copy;
+                        if (bytes != NULL) {
+                                *bytes += copy;
+                        }
+                } else {
+                        priv->rbuf.start = priv->rbuf.end = 0;
+
+                        wanted = 0;
+                        for (iovcnt = 0; (iovcnt < opcount)
+                                     && (iovcnt < MAX_IOVEC); iovcnt++) {
+                                iov[iovcnt] = opvector[iovcnt];
+                                wanted += opvector[iovcnt].iov_len;
+                        }
+                        iov[iovcnt].iov_base = priv->rbuf.buf;
+                        iov[iovcnt].iov_len  = priv->rbuf.size;
+                        iovcnt++;
+
+                        ret = readv (priv->sock, iov, iovcnt);
+                        this->total_read_calls++;
+
+                        if (ret == -1) {
+                                if (errno == EINTR)
+                                        continue;
+                                if (errno == EAGAIN)
+                                        break;
+
+                                gf_log (this->name, GF_LOG_WARNING,
+                                        "readv failed (%s)", strerror (errno));
+                                opcount = -1;
+                                break;
+                        }
+
+                        if (ret == 0) {
+                                gf_log (this->name, GF_LOG_DEBUG,
+                                        "EOF from peer %s",
+                                        this->peerinfo.identifier);
+                                opcount = -1;
+                                errno = ENOTCONN;
+                                break;
+                        }
+
+                        this->total_bytes_read += ret;
+
+                        if (ret > wanted) {
+                                priv->rbuf.end = ret - wanted;
+                                ret = wanted;
+                        }
+
+                        if (bytes != NULL) {
+                                *bytes += ret;
+                        }
+
+                        for (i = 0; ret && (i < opcount); i++) {
+                                copy = min ((size_t)ret, opvector[i].iov_len);
+                                opvector[i].iov_base += copy;
+                                opvector[i].iov_len -= copy;
+                                ret -= copy;
+                        }
+                }
+
+                while (opcount && !opvector[0].iov_len) {
+                        opvector++;
+                        opcount--;
+                }
+        }
+
+        if (pending_vector)
+                *pending_vector = opvector;
+
+        if (pending_count)
+                *pending_count = opcount;
+
+out:
+        return opcount;
+}
+
+
 int
 __socket_readv (rpc_transport_t *this, struct iovec *vector, int count,
                 struct iovec **pending_vector, int *pending_count,
                 size_t *bytes)
 {
-        int ret = -1;
+        socket_private_t *priv = NULL;
+        int               ret = -1;
 
-        ret = __socket_rwv (this, vector, count,
-                            pending_vector, pending_count, bytes, 0);
+        priv = this->private;
+
+        if (priv->rbuf.size)
+                ret = __socket_buffered_readv (this, vector, count,
+                                               pending_vector, pending_count,
+                                               bytes);
+        else
+                ret = __socket_rwv (this, vector, count,
+                                    pending_vector, pending_count, bytes, 0);
 
         return ret;
 }
@@ -483,6 +630,8 @@ __socket_reset (rpc_transport_t *this)
 
         memset (&priv->incoming, 0, sizeof (priv->incoming));
 
+        priv->rbuf.start = priv->rbuf.end = 0;
+
         event_unregister (this->ctx->event_pool, priv->sock, priv->idx);
 
         close (priv->sock);
@@ -525,8 +674,7 @@ __socket_ioq_new (rpc_transport_t *this, rpc_transport_msg_t *msg)
 
         GF_VALIDATE_OR_GOTO ("socket", this, out);
 
-        /* TODO: use mem-pool */
-        entry = GF_CALLOC (1, sizeof (*entry), gf_common_mt_ioq);
+        entry = mem_get0 (socket_ioq_pool);
         if (!entry)
                 return NULL;
 
@@ -542,7 +690,7 @@ __socket_ioq_new (rpc_transport_t *this, rpc_transport_msg_t *msg)
                 gf_log (this->name, GF_LOG_ERROR,
                         "msg size (%u) bigger than the maximum allowed size on "
                         "sockets (%u)", size, RPC_MAX_FRAGMENT_SIZE);
-                GF_FREE (entry);
+                mem_put (socket_ioq_pool, entry);
                 return NULL;
         }
 
@@ -592,8 +740,7 @@ __socket_ioq_entry_free (struct ioq *entry)
         if (entry->iobref)
                 iobref_unref (entry->iobref);
 
-        /* TODO: use mem-pool */
-        GF_FREE (entry);
+        mem_put (socket_ioq_pool, entry);
 
 out:
         return;
@@ -635,18 +782,104 @@ __socket_ioq_churn_entry (rpc_transport_t *this, struct ioq *entry)
                 /* current entry was completely written */
                 GF_ASSERT (entry->pending_count == 0);
                 __socket_ioq_entry_free (entry);
+                this->total_msgs_written++;
         }
 
         return ret;
 }
 
 
+/* Writes the pending vectors of as many queued entries as fit in one
+ * writev, and frees the entries which went out completely. Returns 0 once
+ * something was written, > 0 when the socket would block and -1 on error.
+ */
+int
+__socket_ioq_churn_batch (rpc_transport_t *this)
+{
+        socket_private_t *priv = NULL;
+        struct ioq       *entry = NULL;
+        struct ioq       *tmp = NULL;
+        struct msghdr     msg = {0, };
+        int               count = 0;
+        int               flags = 0;
+        ssize_t           ret = 0;
+        size_t            len = 0;
+
+        priv = this->private;
+
+        if (priv->ioq_next == priv->ioq_prev)
+                return __socket_ioq_churn_entry (this, priv->ioq_next);
+
+        if (!priv->wvec) {
+                priv->wvec = GF_CALLOC (GF_SOCKET_MAX_WRITEV,
+                                        sizeof (*priv->wvec),
+                                        gf_common_mt_iovec);
+                if (!priv->wvec)
+                        return __socket_ioq_churn_entry (this,
+                                                         priv->ioq_next);
+        }
+
+        list_for_each_entry (entry, &priv->ioq, list) {
+                if (count + entry->pending_count > GF_SOCKET_MAX_WRITEV) {
+#ifdef MSG_MORE
+                        /* the rest follows right after this one */
+                        flags = MSG_MORE;
+#endif
+                        break;
+                }
+                memcpy (&priv->wvec[count], entry->pending_vector,
+                        entry->pending_count * sizeof (struct iovec));
+                count += entry->pending_count;
+        }
+
+        msg.msg_iov    = priv->wvec;
+        msg.msg_iovlen = count;
+
+        do {
+                ret = sendmsg (priv->sock, &msg, flags);
+                this->total_write_calls++;
+        } while ((ret == -1) && (errno == EINTR));
+
+        if (ret == 0 || (ret == -1 && errno == EAGAIN))
+                return 1;
+
+        if (ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "writev failed (%s)",
+                        strerror (errno));
+                return -1;
+        }
+
+        this->total_bytes_write += ret;
+
+        list_for_each_entry_safe (entry, tmp, &priv->ioq, list) {
+                while (ret && entry->pending_count) {
+                        len = min ((size_t)ret,
+                                   entry->pending_vector[0].iov_len);
+                        entry->pending_vector[0].iov_base += len;
+                        entry->pending_vector[0].iov_len -= len;
+                        ret -= len;
+                        if (!entry->pending_vector[0].iov_len) {
+                                entry->pending_vector++;
+                                entry->pending_count--;
+                        }
+                }
+
+                if (entry->pending_count)
+                        break;
+
+                __socket_ioq_entry_free (entry);
+                this->total_msgs_written++;
+        }
+
+        return 0;
+}
+
+
 int
 __socket_ioq_churn (rpc_transport_t *this)
 {
         socket_private_t *priv = NULL;
         int               ret = 0;
-        struct ioq       *entry = NULL;
 
         GF_VALIDATE_OR_GOTO ("socket", this, out);
         GF_VALIDATE_OR_GOTO ("socket", this->private, out);
@@ -654,10 +887,7 @@ __socket_ioq_churn (rpc_transport_t *this)
         priv = this->private;
 
         while (!list_empty (&priv->ioq)) {
-                /* pick next entry */
-                entry = priv->ioq_next;
-
-                ret = __socket_ioq_churn_entry (this, entry);
+                ret = __socket_ioq_churn_batch (this);
 
                 if (ret != 0)
                         break;
@@ -1616,6 +1846,7 @@ __socket_proto_state_machine (rpc_transport_t *this,
 
                                 priv->incoming.request_info = NULL;
                         }
+                        this->total_msgs_read++;
                         priv->incoming.record_state = SP_STATE_COMPLETE;
                         break;
 
@@ -1664,20 +1895,119 @@ out:
 }
 
 
+/* With batch-writes on, the replies submitted while the records of one
+ * POLLIN are handled are queued and go out together once they all are. */
+void
+socket_cork (rpc_transport_t *this)
+{
+        socket_private_t *priv = NULL;
+
+        priv = this->private;
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                priv->corked = 1;
+        }
+        pthread_mutex_unlock (&priv->lock);
+}
+
+
+void
+socket_uncork (rpc_transport_t *this)
+{
+        socket_private_t *priv = NULL;
+        int               ret = 0;
+
+        priv = this->private;
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                priv->corked = 0;
+
+                if ((priv->connected == 1) && !list_empty (&priv->ioq)) {
+                        ret = __socket_ioq_churn (this);
+
+                        if (ret > 0)
+                                priv->idx = event_select_on (this->ctx->event_pool,
+                                                             priv->sock,
+                                                             priv->idx, -1, 1);
+                        if (ret == -1)
+                                __socket_disconnect (this);
+                }
+        }
+        pthread_mutex_unlock (&priv->lock);
+}
+
+
+/* records already read ahead into priv->rbuf raise no further POLLIN,
+ * so keep parsing until the buffer is drained, or until admission control
+ * throttles the transport; socket_throttle() resumes from there. Only one
+ * thread parses at a time, another one arriving asks it for a round more.
+ */
 int
 socket_event_poll_in (rpc_transport_t *this)
 {
         int                     ret    = -1;
+        socket_private_t       *priv   = NULL;
         rpc_transport_pollin_t *pollin = NULL;
+        size_t                  buffered = 0;
+        char                    throttled = 0;
+        char                    busy = 0;
+        char                    again = 0;
 
-        ret = socket_proto_state_machine (this, &pollin);
-
-        if (pollin != NULL) {
-                ret = rpc_transport_notify (this, RPC_TRANSPORT_MSG_RECEIVED,
-                                            pollin);
+        priv = this->private;
 
-                rpc_transport_pollin_destroy (pollin);
+        pthread_mutex_lock (&priv->lock);
+        {
+                busy = priv->draining;
+                if (busy)
+                        priv->redrain = 1;
+                else
+                        priv->draining = 1;
         }
+        pthread_mutex_unlock (&priv->lock);
+
+        if (busy)
+                return 0;
+
+        if (priv->batch_writes)
+                socket_cork (this);
+
+        do {
+                do {
+                        pollin = NULL;
+                        ret = socket_proto_state_machine (this, &pollin);
+
+                        if (pollin == NULL)
+                                break;
+
+                        ret = rpc_transport_notify (this,
+                                                    RPC_TRANSPORT_MSG_RECEIVED,
+                                                    pollin);
+
+                        rpc_transport_pollin_destroy (pollin);
+
+                        pthread_mutex_lock (&priv->lock);
+                        {
+                                buffered = priv->rbuf.end - priv->rbuf.start;
+                                throttled = priv->throttled;
+                        }
+                        pthread_mutex_unlock (&priv->lock);
+                } while (buffered && !throttled && (ret >= 0));
+
+                pthread_mutex_lock (&priv->lock);
+                {
+                        again = (priv->redrain && !priv->throttled
+                                 && (ret >= 0));
+                        priv->redrain = 0;
+                        if (!again)
+                                priv->draining = 0;
+                }
+                pthread_mutex_unlock (&priv->lock);
+        } while (again);
+
+        if (priv->batch_writes)
+                socket_uncork (this);
 
         return ret;
 }
@@ -1911,6 +2241,8 @@ socket_server_event_handler (int fd, int idx, void *data,
                         new_trans->notify = this->notify;
                         new_trans->listener = this;
                         new_priv = new_trans->private;
+                        new_priv->rbuf.size = priv->rbuf.size;
+                        new_priv->batch_writes = priv->batch_writes;
 
                         pthread_mutex_lock (&new_priv->lock);
                         {
@@ -1968,6 +2300,52 @@ out:
 }
 
 
+/* Admission control: stop or resume polling the socket for input. Writes
+ * still go out so that the calls being served can be answered. Records
+ * left in rbuf by a throttled drain raise no POLLIN, so they are parsed
+ * here on resuming.
+ */
+int32_t
+socket_throttle (rpc_transport_t *this, gf_boolean_t onoff)
+{
+        socket_private_t *priv = NULL;
+        int               ret = -1;
+        int               kick = 0;
+
+        GF_VALIDATE_OR_GOTO ("socket", this, out);
+        GF_VALIDATE_OR_GOTO ("socket", this->private, out);
+
+        priv = this->private;
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                if ((priv->sock == -1) || (priv->idx == -1))
+                        goto unlock;
+
+                priv->throttled = (onoff) ? 1 : 0;
+                priv->idx = event_select_on (this->ctx->event_pool,
+                                             priv->sock, priv->idx,
+                                             (onoff) ? 0 : 1, -1);
+                kick = (!onoff && (priv->rbuf.end > priv->rbuf.start));
+                ret = 0;
+        }
+unlock:
+        pthread_mutex_unlock (&priv->lock);
+
+        if (kick && (socket_event_poll_in (this) < 0)) {
+                /* the poll thread sees the shutdown and tears down */
+                pthread_mutex_lock (&priv->lock);
+                {
+                        __socket_disconnect (this);
+                }
+                pthread_mutex_unlock (&priv->lock);
+        }
+
+out:
+        return ret;
+}
+
+
 int
 socket_connect (rpc_transport_t *this, int port)
 {
@@ -2314,7 +2692,7 @@ socket_submit_request (rpc_transport_t *this, rpc_transport_req_t *req)
                 if (!entry)
                         goto unlock;
 
-                if (list_empty (&priv->ioq)) {
+                if (list_empty (&priv->ioq) && !priv->corked) {
                         ret = __socket_ioq_churn_entry (this, entry);
 
                         if (ret == 0)
@@ -2375,7 +2753,7 @@ socket_submit_reply (rpc_transport_t *this, rpc_transport_reply_t *reply)
                 entry = __socket_ioq_new (this, &reply->msg);
                 if (!entry)
                         goto unlock;
-                if (list_empty (&priv->ioq)) {
+                if (list_empty (&priv->ioq) && !priv->corked) {
                         ret = __socket_ioq_churn_entry (this, entry);
 
                         if (ret == 0)
@@ -2495,6 +2873,7 @@ struct rpc_transport_ops tops = {
         .get_peeraddr       = socket_getpeeraddr,
         .get_myname         = socket_getmyname,
         .get_myaddr         = socket_getmyaddr,
+        .throttle           = socket_throttle,
 };
 
 int
@@ -2543,6 +2922,7 @@ socket_init (rpc_transport_t *this)
         socket_private_t *priv = NULL;
         gf_boolean_t      tmp_bool = 0;
         uint64_t          windowsize = GF_DEFAULT_SOCKET_WINDOW_SIZE;
+        uint64_t          rbufsize = GF_DEFAULT_SOCKET_READ_BUFFER_SIZE;
         char             *optstr = NULL;
         uint32_t          keepalive = 0;
         uint32_t          backlog = 0;
@@ -2553,6 +2933,13 @@ socket_init (rpc_transport_t *this)
                 return -1;
         }
 
+        pthread_once (&socket_ioq_pool_once, socket_ioq_pool_init);
+        if (!socket_ioq_pool) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "could not allocate the ioq pool");
+                return -1;
+        }
+
         priv = GF_CALLOC (1, sizeof (*priv), gf_common_mt_socket_private_t);
         if (!priv) {
                 return -1;
@@ -2566,6 +2953,7 @@ socket_init (rpc_transport_t *this)
         priv->nodelay = 1;
         priv->bio = 0;
         priv->windowsize = GF_DEFAULT_SOCKET_WINDOW_SIZE;
+        priv->rbuf.size = GF_DEFAULT_SOCKET_READ_BUFFER_SIZE;
         INIT_LIST_HEAD (&priv->ioq);
 
         /* All the below section needs 'this->options' to be present */
@@ -2674,7 +3062,32 @@ socket_init (rpc_transport_t *this)
                 }
         }
 
+        optstr = NULL;
+        if (dict_get_str (this->options, "transport.socket.read-buffer-size",
+                          &optstr) == 0) {
+                if (gf_string2bytesize (optstr, &rbufsize) != 0) {
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "invalid number format: %s", optstr);
+                        return -1;
+                }
+                if (rbufsize > GF_MAX_SOCKET_READ_BUFFER_SIZE)
+                        rbufsize = GF_MAX_SOCKET_READ_BUFFER_SIZE;
+        }
+
+        optstr = NULL;
+        if (dict_get_str (this->options, "transport.socket.batch-writes",
+                          &optstr) == 0) {
+                if (gf_string2boolean (optstr, &tmp_bool) == -1) {
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "'transport.socket.batch-writes' takes only "
+                                "boolean options, not taking any action");
+                        tmp_bool = 0;
+                }
+                priv->batch_writes = tmp_bool;
+        }
+
         priv->windowsize = (int)windowsize;
+        priv->rbuf.size = rbufsize;
 out:
         this->private = priv;
 
@@ -2704,6 +3117,10 @@ fini (rpc_transport_t *this)
                         "transport %p destroyed", this);
 
                 pthread_mutex_destroy (&priv->lock);
+                if (priv->rbuf.buf)
+                        GF_FREE (priv->rbuf.buf);
+                if (priv->wvec)
+                        GF_FREE (priv->wvec);
                 GF_FREE (priv);
         }
 
@@ -2782,5 +3199,13 @@ struct volume_options options[] = {
         { .key   = {"transport.socket.read-fail-log"},
           .type  = GF_OPTION_TYPE_BOOL
         },
+        { .key   = {"transport.socket.read-buffer-size"},
+          .type  = GF_OPTION_TYPE_SIZET,
+          .min   = 0,
+          .max   = GF_MAX_SOCKET_READ_BUFFER_SIZE,
+        },
+        { .key   = {"transport.socket.batch-writes"},
+          .type  = GF_OPTION_TYPE_BOOL
+        },
         { .key = {NULL} }
 };
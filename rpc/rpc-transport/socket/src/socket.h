@@ -33,6 +33,8 @@
 #include "mem-pool.h"
 #include "globals.h"
 
+#include <limits.h>
+
 #ifndef MAX_IOVEC
 #define MAX_IOVEC 16
 #endif /* MAX_IOVEC */
@@ -54,6 +56,19 @@
 #define GF_DEFAULT_SOCKET_WINDOW_SIZE   (512 * GF_UNIT_KB)
 #define GF_MAX_SOCKET_WINDOW_SIZE       (1 * GF_UNIT_MB)
 #define GF_MIN_SOCKET_WINDOW_SIZE       (128 * GF_UNIT_KB)
+
+/* bytes read ahead of the record being parsed, 0 disables read-ahead */
+#define GF_DEFAULT_SOCKET_READ_BUFFER_SIZE   (64 * GF_UNIT_KB)
+#define GF_MAX_SOCKET_READ_BUFFER_SIZE       (1 * GF_UNIT_MB)
+
+/* queued messages written by one writev at most */
+#ifdef IOV_MAX
+#define GF_SOCKET_MAX_WRITEV            IOV_MAX
+#else
+#define GF_SOCKET_MAX_WRITEV            1024
+#endif
+
+#define GF_SOCKET_IOQ_POOL_SIZE         1024
 #define GF_USE_DEFAULT_KEEPALIVE        (-1)
 
 typedef enum {
@@ -188,6 +203,20 @@ typedef struct {
                 msg_type_t           msg_type;
                 size_t               total_bytes_read;
         } incoming;
+        /* bytes read off the socket past what the state machine asked
+         * for, [start, end) of buf is still to be parsed */
+        struct {
+                char                *buf;
+                size_t               size;
+                size_t               start;
+                size_t               end;
+        } rbuf;
+        char                   throttled;
+        char                   draining;  /* a thread is parsing rbuf */
+        char                   redrain;   /* input came in meanwhile */
+        struct iovec          *wvec;   /* GF_SOCKET_MAX_WRITEV entries */
+        char                   batch_writes;
+        char                   corked;
         pthread_mutex_t        lock;
         int                    windowsize;
         char                   lowlat;
@@ -608,6 +608,101 @@ struct gfs3_ftruncate_rsp {
 };
 typedef struct gfs3_ftruncate_rsp gfs3_ftruncate_rsp;
 
+struct gfs3_fallocate_req {
+	char gfid[16];
+	quad_t fd;
+	u_int flags;
+	u_quad_t offset;
+	u_quad_t size;
+};
+typedef struct gfs3_fallocate_req gfs3_fallocate_req;
+
+struct gfs3_fallocate_rsp {
+	int op_ret;
+	int op_errno;
+	struct gf_iatt statpre;
+	struct gf_iatt statpost;
+};
+typedef struct gfs3_fallocate_rsp gfs3_fallocate_rsp;
+
+struct gfs3_discard_req {
+	char gfid[16];
+	quad_t fd;
+	u_quad_t offset;
+	u_quad_t size;
+};
+typedef struct gfs3_discard_req gfs3_discard_req;
+
+struct gfs3_discard_rsp {
+	int op_ret;
+	int op_errno;
+	struct gf_iatt statpre;
+	struct gf_iatt statpost;
+};
+typedef struct gfs3_discard_rsp gfs3_discard_rsp;
+
+struct gfs3_zerofill_req {
+	char gfid[16];
+	quad_t fd;
+	u_int flags;
+	u_quad_t offset;
+	u_quad_t size;
+};
+typedef struct gfs3_zerofill_req gfs3_zerofill_req;
+
+struct gfs3_zerofill_rsp {
+	int op_ret;
+	int op_errno;
+	struct gf_iatt statpre;
+	struct gf_iatt statpost;
+};
+typedef struct gfs3_zerofill_rsp gfs3_zerofill_rsp;
+
+struct gfs3_compound_op {
+	u_int op;
+	u_int cflags;
+	char gfid[16];
+	quad_t fd;
+	char *path;
+	char *bname;
+	char *name;
+	char *volume;
+	u_int flags;
+	u_int cmd;
+	u_int type;
+	struct gf_proto_flock flock;
+	struct {
+		u_int dict_len;
+		char *dict_val;
+	} dict;
+	struct gfs3_compound_op *nextop;
+};
+typedef struct gfs3_compound_op gfs3_compound_op;
+
+struct gfs3_compound_req {
+	struct gfs3_compound_op *ops;
+};
+typedef struct gfs3_compound_req gfs3_compound_req;
+
+struct gfs3_compound_op_rsp {
+	int op_ret;
+	int op_errno;
+	struct gf_iatt stat;
+	struct {
+		u_int dict_len;
+		char *dict_val;
+	} dict;
+	struct gfs3_compound_op_rsp *nextrsp;
+};
+typedef struct gfs3_compound_op_rsp gfs3_compound_op_rsp;
+
+struct gfs3_compound_rsp {
+	int op_ret;
+	int op_errno;
+	struct gfs3_compound_op_rsp *rsps;
+};
+typedef struct gfs3_compound_rsp gfs3_compound_rsp;
+
 struct gfs3_fstat_req {
 	char gfid[16];
 	quad_t fd;
@@ -846,6 +941,16 @@ extern  bool_t xdr_gfs3_create_req (XDR *, gfs3_create_req*);
 extern  bool_t xdr_gfs3_create_rsp (XDR *, gfs3_create_rsp*);
 extern  bool_t xdr_gfs3_ftruncate_req (XDR *, gfs3_ftruncate_req*);
 extern  bool_t xdr_gfs3_ftruncate_rsp (XDR *, gfs3_ftruncate_rsp*);
+extern  bool_t xdr_gfs3_fallocate_req (XDR *, gfs3_fallocate_req*);
+extern  bool_t xdr_gfs3_fallocate_rsp (XDR *, gfs3_fallocate_rsp*);
+extern  bool_t xdr_gfs3_discard_req (XDR *, gfs3_discard_req*);
+extern  bool_t xdr_gfs3_discard_rsp (XDR *, gfs3_discard_rsp*);
+extern  bool_t xdr_gfs3_zerofill_req (XDR *, gfs3_zerofill_req*);
+extern  bool_t xdr_gfs3_zerofill_rsp (XDR *, gfs3_zerofill_rsp*);
+extern  bool_t xdr_gfs3_compound_op (XDR *, gfs3_compound_op*);
+extern  bool_t xdr_gfs3_compound_req (XDR *, gfs3_compound_req*);
+extern  bool_t xdr_gfs3_compound_op_rsp (XDR *, gfs3_compound_op_rsp*);
+extern  bool_t xdr_gfs3_compound_rsp (XDR *, gfs3_compound_rsp*);
 extern  bool_t xdr_gfs3_fstat_req (XDR *, gfs3_fstat_req*);
 extern  bool_t xdr_gfs3_fstat_rsp (XDR *, gfs3_fstat_rsp*);
 extern  bool_t xdr_gfs3_entrylk_req (XDR *, gfs3_entrylk_req*);
@@ -933,6 +1038,16 @@ extern bool_t xdr_gfs3_create_req ();
 extern bool_t xdr_gfs3_create_rsp ();
 extern bool_t xdr_gfs3_ftruncate_req ();
 extern bool_t xdr_gfs3_ftruncate_rsp ();
+extern bool_t xdr_gfs3_fallocate_req ();
+extern bool_t xdr_gfs3_fallocate_rsp ();
+extern bool_t xdr_gfs3_discard_req ();
+extern bool_t xdr_gfs3_discard_rsp ();
+extern bool_t xdr_gfs3_zerofill_req ();
+extern bool_t xdr_gfs3_zerofill_rsp ();
+extern bool_t xdr_gfs3_compound_op ();
+extern bool_t xdr_gfs3_compound_req ();
+extern bool_t xdr_gfs3_compound_op_rsp ();
+extern bool_t xdr_gfs3_compound_rsp ();
 extern bool_t xdr_gfs3_fstat_req ();
 extern bool_t xdr_gfs3_fstat_rsp ();
 extern bool_t xdr_gfs3_entrylk_req ();
@@ -470,6 +470,86 @@ struct   gfs3_ftruncate_rsp {
 } ;
 
 
+struct   gfs3_fallocate_req  {
+        opaque gfid[16];
+	hyper  fd;
+	unsigned int flags;
+	unsigned hyper offset;
+	unsigned hyper size;
+} ;
+struct   gfs3_fallocate_rsp {
+        int    op_ret;
+        int    op_errno;
+	struct gf_iatt statpre;
+        struct gf_iatt statpost;
+} ;
+
+
+struct   gfs3_discard_req  {
+        opaque gfid[16];
+	hyper  fd;
+	unsigned hyper offset;
+	unsigned hyper size;
+} ;
+struct   gfs3_discard_rsp {
+        int    op_ret;
+        int    op_errno;
+	struct gf_iatt statpre;
+        struct gf_iatt statpost;
+} ;
+
+
+struct   gfs3_zerofill_req  {
+        opaque gfid[16];
+	hyper  fd;
+	unsigned int flags;
+	unsigned hyper offset;
+	unsigned hyper size;
+} ;
+struct   gfs3_zerofill_rsp {
+        int    op_ret;
+        int    op_errno;
+	struct gf_iatt statpre;
+        struct gf_iatt statpost;
+} ;
+
+
+struct gfs3_compound_op {
+        unsigned int   op;       /* GFS3_OP_* */
+        unsigned int   cflags;
+        opaque         gfid[16];
+        hyper          fd;
+        string         path<>;
+        string         bname<>;
+        string         name<>;
+        string         volume<>;
+        unsigned int   flags;
+        unsigned int   cmd;
+        unsigned int   type;
+        struct gf_proto_flock flock;
+        opaque         dict<>;
+        struct gfs3_compound_op *nextop;
+};
+
+struct gfs3_compound_req {
+        struct gfs3_compound_op *ops;
+};
+
+struct gfs3_compound_op_rsp {
+        int            op_ret;
+        int            op_errno;
+        struct gf_iatt stat;
+        opaque         dict<>;
+        struct gfs3_compound_op_rsp *nextrsp;
+};
+
+struct gfs3_compound_rsp {
+        int    op_ret;
+        int    op_errno;
+        struct gfs3_compound_op_rsp *rsps;
+};
+
+
 struct gfs3_fstat_req {
         opaque gfid[16];
 	hyper  fd;
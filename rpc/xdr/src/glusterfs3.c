@@ -264,6 +264,34 @@ xdr_serialize_ftruncate_rsp (struct iovec outmsg, void *rsp)
                                       (xdrproc_t)xdr_gfs3_ftruncate_rsp);
 }
 
+ssize_t
+xdr_serialize_fallocate_rsp (struct iovec outmsg, void *rsp)
+{
+        return xdr_serialize_generic (outmsg, (void *)rsp,
+                                      (xdrproc_t)xdr_gfs3_fallocate_rsp);
+}
+
+ssize_t
+xdr_serialize_discard_rsp (struct iovec outmsg, void *rsp)
+{
+        return xdr_serialize_generic (outmsg, (void *)rsp,
+                                      (xdrproc_t)xdr_gfs3_discard_rsp);
+}
+
+ssize_t
+xdr_serialize_zerofill_rsp (struct iovec outmsg, void *rsp)
+{
+        return xdr_serialize_generic (outmsg, (void *)rsp,
+                                      (xdrproc_t)xdr_gfs3_zerofill_rsp);
+}
+
+ssize_t
+xdr_serialize_compound_rsp (struct iovec outmsg, void *rsp)
+{
+        return xdr_serialize_generic (outmsg, (void *)rsp,
+                                      (xdrproc_t)xdr_gfs3_compound_rsp);
+}
+
 
 ssize_t
 xdr_to_lookup_req (struct iovec inmsg, void *args)
@@ -466,6 +494,34 @@ xdr_to_ftruncate_req (struct iovec inmsg, void *args)
                                (xdrproc_t)xdr_gfs3_ftruncate_req);
 }
 
+ssize_t
+xdr_to_fallocate_req (struct iovec inmsg, void *args)
+{
+        return xdr_to_generic (inmsg, (void *)args,
+                               (xdrproc_t)xdr_gfs3_fallocate_req);
+}
+
+ssize_t
+xdr_to_discard_req (struct iovec inmsg, void *args)
+{
+        return xdr_to_generic (inmsg, (void *)args,
+                               (xdrproc_t)xdr_gfs3_discard_req);
+}
+
+ssize_t
+xdr_to_zerofill_req (struct iovec inmsg, void *args)
+{
+        return xdr_to_generic (inmsg, (void *)args,
+                               (xdrproc_t)xdr_gfs3_zerofill_req);
+}
+
+ssize_t
+xdr_to_compound_req (struct iovec inmsg, void *args)
+{
+        return xdr_to_generic (inmsg, (void *)args,
+                               (xdrproc_t)xdr_gfs3_compound_req);
+}
+
 ssize_t
 xdr_to_fsyncdir_req (struct iovec inmsg, void *args)
 {
@@ -802,6 +858,34 @@ xdr_from_ftruncate_req (struct iovec outmsg, void *req)
         return xdr_serialize_generic (outmsg, (void *)req,
                                       (xdrproc_t)xdr_gfs3_ftruncate_req);
 
+}
+ssize_t
+xdr_from_fallocate_req (struct iovec outmsg, void *req)
+{
+        return xdr_serialize_generic (outmsg, (void *)req,
+                                      (xdrproc_t)xdr_gfs3_fallocate_req);
+
+}
+ssize_t
+xdr_from_discard_req (struct iovec outmsg, void *req)
+{
+        return xdr_serialize_generic (outmsg, (void *)req,
+                                      (xdrproc_t)xdr_gfs3_discard_req);
+
+}
+ssize_t
+xdr_from_zerofill_req (struct iovec outmsg, void *req)
+{
+        return xdr_serialize_generic (outmsg, (void *)req,
+                                      (xdrproc_t)xdr_gfs3_zerofill_req);
+
+}
+ssize_t
+xdr_from_compound_req (struct iovec outmsg, void *req)
+{
+        return xdr_serialize_generic (outmsg, (void *)req,
+                                      (xdrproc_t)xdr_gfs3_compound_req);
+
 }
 ssize_t
 xdr_from_fsetattr_req (struct iovec outmsg, void *req)
@@ -1049,6 +1133,34 @@ xdr_to_ftruncate_rsp (struct iovec outmsg, void *rsp)
         return xdr_to_generic (outmsg, (void *)rsp,
                                       (xdrproc_t)xdr_gfs3_ftruncate_rsp);
 
+}
+ssize_t
+xdr_to_fallocate_rsp (struct iovec outmsg, void *rsp)
+{
+        return xdr_to_generic (outmsg, (void *)rsp,
+                                      (xdrproc_t)xdr_gfs3_fallocate_rsp);
+
+}
+ssize_t
+xdr_to_discard_rsp (struct iovec outmsg, void *rsp)
+{
+        return xdr_to_generic (outmsg, (void *)rsp,
+                                      (xdrproc_t)xdr_gfs3_discard_rsp);
+
+}
+ssize_t
+xdr_to_zerofill_rsp (struct iovec outmsg, void *rsp)
+{
+        return xdr_to_generic (outmsg, (void *)rsp,
+                                      (xdrproc_t)xdr_gfs3_zerofill_rsp);
+
+}
+ssize_t
+xdr_to_compound_rsp (struct iovec outmsg, void *rsp)
+{
+        return xdr_to_generic (outmsg, (void *)rsp,
+                                      (xdrproc_t)xdr_gfs3_compound_rsp);
+
 }
 ssize_t
 xdr_to_fsetattr_rsp (struct iovec outmsg, void *rsp)
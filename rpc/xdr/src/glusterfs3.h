@@ -327,6 +327,18 @@ xdr_serialize_truncate_rsp (struct iovec outmsg, void *rsp);
 ssize_t
 xdr_serialize_ftruncate_rsp (struct iovec outmsg, void *rsp);
 
+ssize_t
+xdr_serialize_fallocate_rsp (struct iovec outmsg, void *rsp);
+
+ssize_t
+xdr_serialize_discard_rsp (struct iovec outmsg, void *rsp);
+
+ssize_t
+xdr_serialize_zerofill_rsp (struct iovec outmsg, void *rsp);
+
+ssize_t
+xdr_serialize_compound_rsp (struct iovec outmsg, void *rsp);
+
 ssize_t
 xdr_serialize_statfs_rsp (struct iovec outmsg, void *rsp);
 
@@ -443,6 +455,18 @@ xdr_to_fsync_req (struct iovec inmsg, void *args);
 ssize_t
 xdr_to_ftruncate_req (struct iovec inmsg, void *args);
 
+ssize_t
+xdr_to_fallocate_req (struct iovec inmsg, void *args);
+
+ssize_t
+xdr_to_discard_req (struct iovec inmsg, void *args);
+
+ssize_t
+xdr_to_zerofill_req (struct iovec inmsg, void *args);
+
+ssize_t
+xdr_to_compound_req (struct iovec inmsg, void *args);
+
 ssize_t
 xdr_to_truncate_req (struct iovec inmsg, void *args);
 
@@ -524,6 +548,18 @@ xdr_from_truncate_req (struct iovec outmsg, void *args);
 ssize_t
 xdr_from_ftruncate_req (struct iovec outmsg, void *args);
 
+ssize_t
+xdr_from_fallocate_req (struct iovec outmsg, void *args);
+
+ssize_t
+xdr_from_discard_req (struct iovec outmsg, void *args);
+
+ssize_t
+xdr_from_zerofill_req (struct iovec outmsg, void *args);
+
+ssize_t
+xdr_from_compound_req (struct iovec outmsg, void *args);
+
 ssize_t
 xdr_from_readlink_req (struct iovec outmsg, void *args);
 
@@ -680,6 +716,18 @@ xdr_to_truncate_rsp (struct iovec inmsg, void *args);
 ssize_t
 xdr_to_ftruncate_rsp (struct iovec inmsg, void *args);
 
+ssize_t
+xdr_to_fallocate_rsp (struct iovec inmsg, void *args);
+
+ssize_t
+xdr_to_discard_rsp (struct iovec inmsg, void *args);
+
+ssize_t
+xdr_to_zerofill_rsp (struct iovec inmsg, void *args);
+
+ssize_t
+xdr_to_compound_rsp (struct iovec inmsg, void *args);
+
 
 ssize_t
 xdr_to_unlink_rsp (struct iovec inmsg, void *args);
@@ -1483,6 +1483,12 @@ afr_lookup_perform_self_heal_if_needed (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        if (!local->loc.parent && local->loc.name == NULL) {
+                /* nameless (gfid) lookup: self-heal needs the entry in
+                   its parent, leave it to the next named lookup */
+                goto out;
+        }
+
         afr_lookup_set_self_heal_data (local, this);
         if (afr_can_self_heal_proceed (&local->self_heal, priv)) {
                 if  (afr_is_transaction_running (local))
@@ -23,6 +23,7 @@
 
 #include "afr.h"
 #include "afr-transaction.h"
+#include "compound-fop.h"
 
 #include <signal.h>
 
@@ -230,6 +231,9 @@ __changelog_needed_pre_op (call_frame_t *frame, xlator_t *this)
 
                 case GF_FOP_WRITE:
                 case GF_FOP_FTRUNCATE:
+                case GF_FOP_FALLOCATE:
+                case GF_FOP_DISCARD:
+                case GF_FOP_ZEROFILL:
                         op_ret = 1;
                         break;
 
@@ -263,6 +267,9 @@ __changelog_needed_post_op (call_frame_t *frame, xlator_t *this)
 
                 case GF_FOP_WRITE:
                 case GF_FOP_FTRUNCATE:
+                case GF_FOP_FALLOCATE:
+                case GF_FOP_DISCARD:
+                case GF_FOP_ZEROFILL:
                         op_ret = 1;
                         break;
 
@@ -403,6 +410,99 @@ afr_changelog_post_op_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 }
 
 
+/* The post-op of a data transaction is the last thing done under the
+ * lock, so with compound-fops set it goes to the server together with
+ * the unlock: one round trip per child instead of two.
+ */
+static int
+afr_post_op_can_compound (xlator_t *this, afr_local_t *local)
+{
+        afr_private_t       *priv     = NULL;
+        afr_internal_lock_t *int_lock = NULL;
+        int                  i        = 0;
+
+        priv     = this->private;
+        int_lock = &local->internal_lock;
+
+        if (!priv->compound_fops || !local->fd ||
+            (local->transaction.type != AFR_DATA_TRANSACTION) ||
+            (int_lock->transaction_lk_type != AFR_TRANSACTION_LK))
+                return 0;
+
+        /* a child could otherwise be unlocked while the post-op of
+           another, which was never locked, is still going on */
+        for (i = 0; i < priv->child_count; i++) {
+                if (local->child_up[i] &&
+                    !(int_lock->inode_locked_nodes[i] & LOCKED_YES))
+                        return 0;
+        }
+
+        return 1;
+}
+
+
+int32_t
+afr_changelog_post_op_unlock_cbk (call_frame_t *frame, void *cookie,
+                                  xlator_t *this, int32_t op_ret,
+                                  int32_t op_errno, compound_args_t *args)
+{
+        afr_local_t         *local       = NULL;
+        afr_internal_lock_t *int_lock    = NULL;
+        int                  child_index = 0;
+
+        local    = frame->local;
+        int_lock = &local->internal_lock;
+
+        child_index = (long) cookie;
+
+        /* ops[0] is the fxattrop, ops[1] the unlock. A child whose unlock
+           did not go through stays locked for afr_unlock to retry */
+        if (args->rsp[1].op_ret == 0)
+                int_lock->inode_locked_nodes[child_index] &= LOCKED_NO;
+        else
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "%s: compound unlock failed on %d (%s)",
+                        local->loc.path, child_index,
+                        strerror (args->rsp[1].op_errno));
+
+        afr_changelog_post_op_cbk (frame, cookie, this, args->rsp[0].op_ret,
+                                   args->rsp[0].op_errno, args->rsp[0].dict);
+
+        compound_args_destroy (args);
+
+        return 0;
+}
+
+
+static compound_args_t *
+afr_post_op_unlock_args (xlator_t *this, afr_local_t *local, dict_t *xattr)
+{
+        afr_internal_lock_t *int_lock = NULL;
+        compound_args_t     *args     = NULL;
+        struct gf_flock      flock    = {0,};
+
+        int_lock = &local->internal_lock;
+
+        flock.l_start = int_lock->lk_flock.l_start;
+        flock.l_len   = int_lock->lk_flock.l_len;
+        flock.l_type  = F_UNLCK;
+
+        args = compound_args_new ();
+        if (!args)
+                goto out;
+
+        if (!compound_add_fxattrop (args, 0, local->fd, GF_XATTROP_ADD_ARRAY,
+                                    xattr) ||
+            !compound_add_finodelk (args, GF_COMPOUND_ALWAYS, this->name,
+                                    local->fd, F_SETLK, &flock)) {
+                compound_args_destroy (args);
+                args = NULL;
+        }
+out:
+        return args;
+}
+
+
 void
 afr_transaction_rm_stale_children (call_frame_t *frame, xlator_t *this,
                                    inode_t *inode, afr_transaction_type type)
@@ -510,6 +610,8 @@ afr_changelog_post_op (call_frame_t *frame, xlator_t *this)
         int            piggyback = 0;
         int            index = 0;
         int            nothing_failed = 1;
+        int            compound = 0;
+        compound_args_t *cargs = NULL;
 
         local    = frame->local;
         int_lock = &local->internal_lock;
@@ -557,6 +659,8 @@ afr_changelog_post_op (call_frame_t *frame, xlator_t *this)
                 }
         }
 
+        compound = afr_post_op_can_compound (this, local);
+
         index = afr_index_for_transaction_type (local->transaction.type);
         if (local->optimistic_change_log &&
             local->transaction.type != AFR_DATA_TRANSACTION) {
@@ -606,9 +710,21 @@ afr_changelog_post_op (call_frame_t *frame, xlator_t *this)
                                                               local->pending,
                                                               local->transaction.type);
 
+                        cargs = NULL;
+                        if (compound && !(nothing_failed && piggyback))
+                                cargs = afr_post_op_unlock_args (this, local,
+                                                                 xattr[i]);
+
                         if (nothing_failed && piggyback) {
                                 afr_changelog_post_op_cbk (frame, (void *)(long)i,
                                                            this, 1, 0, xattr[i]);
+                        } else if (cargs) {
+                                STACK_WIND_COOKIE (frame,
+                                                   afr_changelog_post_op_unlock_cbk,
+                                                   (void *) (long) i,
+                                                   priv->children[i],
+                                                   priv->children[i]->fops->compound,
+                                                   cargs);
                         } else {
                                 STACK_WIND_COOKIE (frame,
                                                    afr_changelog_post_op_cbk,
@@ -137,6 +137,9 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("entry-change-log", priv->entry_change_log, options,
                           bool, out);
 
+        GF_OPTION_RECONF ("compound-fops", priv->compound_fops, options, bool,
+                          out);
+
         GF_OPTION_RECONF ("data-self-heal-algorithm",
                           priv->data_self_heal_algorithm, options, str, out);
 
@@ -250,6 +253,8 @@ init (xlator_t *this)
         GF_OPTION_INIT ("optimistic-change-log", priv->optimistic_change_log,
                         bool, out);
 
+        GF_OPTION_INIT ("compound-fops", priv->compound_fops, bool, out);
+
         GF_OPTION_INIT ("inodelk-trace", priv->inodelk_trace, bool, out);
 
         GF_OPTION_INIT ("entrylk-trace", priv->entrylk_trace, bool, out);
@@ -367,6 +372,9 @@ struct xlator_fops fops = {
         .writev      = afr_writev,
         .truncate    = afr_truncate,
         .ftruncate   = afr_ftruncate,
+        .fallocate   = afr_fallocate,
+        .discard     = afr_discard,
+        .zerofill    = afr_zerofill,
         .setxattr    = afr_setxattr,
         .setattr     = afr_setattr,
         .fsetattr    = afr_fsetattr,
@@ -459,6 +467,13 @@ struct volume_options options[] = {
           .type = GF_OPTION_TYPE_BOOL,
           .default_value = "on",
         },
+        { .key  = {"compound-fops"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Send the post-op of a write together with the "
+                         "unlock in one request. Needs servers which know "
+                         "the COMPOUND fop."
+        },
         { .key  = {"strict-readdir"},
           .type = GF_OPTION_TYPE_BOOL,
           .default_value = "off",
@@ -130,6 +130,7 @@ typedef struct _afr_private {
         pthread_mutex_t  mutex;
         struct list_head saved_fds;   /* list of fds on which locks have succeeded */
         gf_boolean_t     optimistic_change_log;
+        gf_boolean_t     compound_fops;  /* post-op + unlock in one request */
 
         char                   vol_uuid[UUID_SIZE + 1];
         int32_t                *last_event;
@@ -519,6 +520,32 @@ typedef struct _afr_local {
                         struct iatt postbuf;
                 } ftruncate;
 
+                struct {
+                        ino_t ino;
+                        int32_t keep_size;
+                        off_t offset;
+                        size_t len;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } fallocate;
+
+                struct {
+                        ino_t ino;
+                        off_t offset;
+                        size_t len;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } discard;
+
+                struct {
+                        ino_t ino;
+                        int32_t keep_size;
+                        off_t offset;
+                        size_t len;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } zerofill;
+
                 struct {
                         ino_t ino;
                         struct iatt in_buf;
@@ -31,6 +31,7 @@
 #include "dht-common.h"
 #include "defaults.h"
 #include "byte-order.h"
+#include "call-stub.h"
 
 #include <sys/time.h>
 #include <libgen.h>
@@ -959,6 +960,154 @@ err:
 }
 
 
+int
+dht_lookup_nameless_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                         int op_ret, int op_errno, inode_t *inode,
+                         struct iatt *stbuf, dict_t *xattr,
+                         struct iatt *postparent)
+{
+        dht_local_t  *local         = NULL;
+        call_frame_t *prev          = NULL;
+        int           this_call_cnt = 0;
+        int           ret           = 0;
+
+        local = frame->local;
+        prev  = cookie;
+
+        LOCK (&frame->lock);
+        {
+                if (op_ret == -1) {
+                        if ((op_errno != ENOENT) && (op_errno != ESTALE))
+                                local->op_errno = op_errno;
+                        goto unlock;
+                }
+
+                /* linkfiles share the gfid of the file they point to */
+                if (check_is_linkfile (inode, stbuf, xattr))
+                        goto unlock;
+
+                if (check_is_dir (inode, stbuf, xattr)) {
+                        local->dir_count++;
+                        dht_layout_merge (this, local->layout, prev->this,
+                                          op_ret, op_errno, xattr);
+                } else if (local->cached_subvol) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "%s: found on %s and %s", local->loc.path,
+                                local->cached_subvol->name, prev->this->name);
+                        goto unlock;
+                } else {
+                        local->file_count++;
+                        local->cached_subvol = prev->this;
+                }
+
+                if (local->xattr == NULL)
+                        local->xattr = dict_ref (xattr);
+                else
+                        dht_aggregate_xattr (local->xattr, xattr);
+
+                dht_iatt_merge (this, &local->stbuf, stbuf, prev->this);
+                local->op_ret = 0;
+        }
+unlock:
+        UNLOCK (&frame->lock);
+
+        this_call_cnt = dht_frame_return (frame);
+        if (!is_last_call (this_call_cnt))
+                return 0;
+
+        if (local->op_ret == -1)
+                goto unwind;
+
+        if (local->file_count && local->dir_count) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "%s exists as a file on one subvolume and "
+                        "directory on another", local->loc.path);
+                local->op_ret   = -1;
+                local->op_errno = EIO;
+                goto unwind;
+        }
+
+        if (local->dir_count) {
+                /* no name to self-heal with, holes are fixed by the next
+                   named lookup */
+                dht_layout_normalize (this, &local->loc, local->layout);
+                dht_layout_set (this, local->inode, local->layout);
+        } else {
+                ret = dht_layout_preset (this, local->cached_subvol,
+                                         local->inode);
+                if (ret < 0) {
+                        local->op_ret   = -1;
+                        local->op_errno = EINVAL;
+                }
+        }
+
+unwind:
+        DHT_STACK_UNWIND (lookup, frame, local->op_ret, local->op_errno,
+                          local->inode, &local->stbuf, local->xattr,
+                          &local->postparent);
+        return 0;
+}
+
+
+/* lookup by gfid alone: no parent layout to hash the name into, ask every
+   subvolume */
+int
+dht_lookup_nameless (call_frame_t *frame, xlator_t *this, loc_t *loc)
+{
+        dht_conf_t   *conf  = NULL;
+        dht_local_t  *local = NULL;
+        int           i     = 0;
+        int           call_cnt = 0;
+        int           ret   = -1;
+
+        conf  = this->private;
+        local = frame->local;
+
+        local->layout = dht_layout_new (this, conf->subvolume_cnt);
+        if (!local->layout) {
+                DHT_STACK_UNWIND (lookup, frame, -1, ENOMEM, NULL, NULL, NULL,
+                                  NULL);
+                return 0;
+        }
+
+        local->inode    = inode_ref (loc->inode);
+        local->op_ret   = -1;
+        local->op_errno = ESTALE;
+
+        ret = dict_set_uint32 (local->xattr_req, "trusted.glusterfs.dht",
+                               4 * 4);
+        if (ret) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "%s: failed to request the layout xattr", loc->path);
+                goto err;
+        }
+
+        ret = dict_set_uint32 (local->xattr_req, "trusted.glusterfs.dht.linkto",
+                               256);
+        if (ret) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "%s: failed to request the linkto xattr", loc->path);
+                goto err;
+        }
+
+        call_cnt        = conf->subvolume_cnt;
+        local->call_cnt = call_cnt;
+
+        for (i = 0; i < call_cnt; i++) {
+                STACK_WIND (frame, dht_lookup_nameless_cbk,
+                            conf->subvolumes[i],
+                            conf->subvolumes[i]->fops->lookup,
+                            &local->loc, local->xattr_req);
+        }
+
+        return 0;
+
+err:
+        DHT_STACK_UNWIND (lookup, frame, -1, ENOMEM, NULL, NULL, NULL, NULL);
+        return 0;
+}
+
+
 int
 dht_lookup (call_frame_t *frame, xlator_t *this,
             loc_t *loc, dict_t *xattr_req)
@@ -1008,6 +1157,11 @@ dht_lookup (call_frame_t *frame, xlator_t *this,
                 local->xattr_req = dict_new ();
         }
 
+        if (!loc->parent && !is_fs_root (loc) && !is_revalidate (loc)) {
+                dht_lookup_nameless (frame, this, &local->loc);
+                return 0;
+        }
+
         if (!hashed_subvol)
                 hashed_subvol = dht_subvol_get_hashed (this, loc);
         cached_subvol = dht_subvol_get_cached (this, loc->inode);
@@ -1334,16 +1488,283 @@ dht_truncate (call_frame_t *frame, xlator_t *this,
         return 0;
 
 err:
-        op_errno = (op_errno == -1) ? errno : op_errno;
-        DHT_STACK_UNWIND (truncate, frame, -1, op_errno, NULL, NULL);
-
+        op_errno = (op_errno == -1) ? errno : op_errno;
+        DHT_STACK_UNWIND (truncate, frame, -1, op_errno, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+dht_ftruncate (call_frame_t *frame, xlator_t *this,
+               fd_t *fd, off_t offset)
+{
+        xlator_t     *subvol = NULL;
+        int           op_errno = -1;
+        dht_local_t  *local = NULL;
+
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+
+        subvol = dht_subvol_get_cached (this, fd->inode);
+        if (!subvol) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "no cached subvolume for fd=%p", fd);
+                op_errno = EINVAL;
+                goto err;
+        }
+
+        local = dht_local_init (frame);
+        if (!local) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+
+        local->inode = inode_ref (fd->inode);
+        local->call_cnt = 1;
+
+        STACK_WIND (frame, dht_truncate_cbk,
+                    subvol, subvol->fops->ftruncate,
+                    fd, offset);
+
+        return 0;
+
+err:
+        op_errno = (op_errno == -1) ? errno : op_errno;
+        DHT_STACK_UNWIND (ftruncate, frame, -1, op_errno, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+dht_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int op_ret, int op_errno, struct iatt *prebuf,
+                   struct iatt *postbuf)
+{
+        dht_local_t  *local = NULL;
+        int           this_call_cnt = 0;
+        call_frame_t *prev = NULL;
+
+        GF_VALIDATE_OR_GOTO ("dht", frame, err);
+        GF_VALIDATE_OR_GOTO ("dht", this, out);
+        GF_VALIDATE_OR_GOTO ("dht", frame->local, out);
+        GF_VALIDATE_OR_GOTO ("dht", cookie, out);
+
+        local = frame->local;
+        prev = cookie;
+
+        LOCK (&frame->lock);
+        {
+                if (op_ret == -1) {
+                        local->op_errno = op_errno;
+                        local->op_ret = -1;
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "subvolume %s returned -1 (%s)",
+                                prev->this->name, strerror (op_errno));
+                        goto unlock;
+                }
+
+                dht_iatt_merge (this, &local->prebuf, prebuf, prev->this);
+                dht_iatt_merge (this, &local->stbuf, postbuf, prev->this);
+
+                local->op_ret = 0;
+        }
+unlock:
+        UNLOCK (&frame->lock);
+out:
+        this_call_cnt = dht_frame_return (frame);
+        if (is_last_call (this_call_cnt))
+                DHT_STACK_UNWIND (fallocate, frame, local->op_ret, local->op_errno,
+                                  &local->prebuf, &local->stbuf);
+err:
+        return 0;
+}
+
+
+int
+dht_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+               int32_t keep_size, off_t offset, size_t len)
+{
+        xlator_t     *subvol = NULL;
+        int           op_errno = -1;
+        dht_local_t  *local = NULL;
+
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+
+        subvol = dht_subvol_get_cached (this, fd->inode);
+        if (!subvol) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "no cached subvolume for fd=%p", fd);
+                op_errno = EINVAL;
+                goto err;
+        }
+
+        local = dht_local_init (frame);
+        if (!local) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+
+        local->inode = inode_ref (fd->inode);
+        local->call_cnt = 1;
+
+        STACK_WIND (frame, dht_fallocate_cbk,
+                    subvol, subvol->fops->fallocate,
+                    fd, keep_size, offset, len);
+
+        return 0;
+
+err:
+        op_errno = (op_errno == -1) ? errno : op_errno;
+        DHT_STACK_UNWIND (fallocate, frame, -1, op_errno, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+dht_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int op_ret, int op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf)
+{
+        dht_local_t  *local = NULL;
+        int           this_call_cnt = 0;
+        call_frame_t *prev = NULL;
+
+        GF_VALIDATE_OR_GOTO ("dht", frame, err);
+        GF_VALIDATE_OR_GOTO ("dht", this, out);
+        GF_VALIDATE_OR_GOTO ("dht", frame->local, out);
+        GF_VALIDATE_OR_GOTO ("dht", cookie, out);
+
+        local = frame->local;
+        prev = cookie;
+
+        LOCK (&frame->lock);
+        {
+                if (op_ret == -1) {
+                        local->op_errno = op_errno;
+                        local->op_ret = -1;
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "subvolume %s returned -1 (%s)",
+                                prev->this->name, strerror (op_errno));
+                        goto unlock;
+                }
+
+                dht_iatt_merge (this, &local->prebuf, prebuf, prev->this);
+                dht_iatt_merge (this, &local->stbuf, postbuf, prev->this);
+
+                local->op_ret = 0;
+        }
+unlock:
+        UNLOCK (&frame->lock);
+out:
+        this_call_cnt = dht_frame_return (frame);
+        if (is_last_call (this_call_cnt))
+                DHT_STACK_UNWIND (discard, frame, local->op_ret, local->op_errno,
+                                  &local->prebuf, &local->stbuf);
+err:
+        return 0;
+}
+
+
+int
+dht_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             off_t offset, size_t len)
+{
+        xlator_t     *subvol = NULL;
+        int           op_errno = -1;
+        dht_local_t  *local = NULL;
+
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+
+        subvol = dht_subvol_get_cached (this, fd->inode);
+        if (!subvol) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "no cached subvolume for fd=%p", fd);
+                op_errno = EINVAL;
+                goto err;
+        }
+
+        local = dht_local_init (frame);
+        if (!local) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+
+        local->inode = inode_ref (fd->inode);
+        local->call_cnt = 1;
+
+        STACK_WIND (frame, dht_discard_cbk,
+                    subvol, subvol->fops->discard,
+                    fd, offset, len);
+
+        return 0;
+
+err:
+        op_errno = (op_errno == -1) ? errno : op_errno;
+        DHT_STACK_UNWIND (discard, frame, -1, op_errno, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+dht_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int op_ret, int op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf)
+{
+        dht_local_t  *local = NULL;
+        int           this_call_cnt = 0;
+        call_frame_t *prev = NULL;
+
+        GF_VALIDATE_OR_GOTO ("dht", frame, err);
+        GF_VALIDATE_OR_GOTO ("dht", this, out);
+        GF_VALIDATE_OR_GOTO ("dht", frame->local, out);
+        GF_VALIDATE_OR_GOTO ("dht", cookie, out);
+
+        local = frame->local;
+        prev = cookie;
+
+        LOCK (&frame->lock);
+        {
+                if (op_ret == -1) {
+                        local->op_errno = op_errno;
+                        local->op_ret = -1;
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "subvolume %s returned -1 (%s)",
+                                prev->this->name, strerror (op_errno));
+                        goto unlock;
+                }
+
+                dht_iatt_merge (this, &local->prebuf, prebuf, prev->this);
+                dht_iatt_merge (this, &local->stbuf, postbuf, prev->this);
+
+                local->op_ret = 0;
+        }
+unlock:
+        UNLOCK (&frame->lock);
+out:
+        this_call_cnt = dht_frame_return (frame);
+        if (is_last_call (this_call_cnt))
+                DHT_STACK_UNWIND (zerofill, frame, local->op_ret, local->op_errno,
+                                  &local->prebuf, &local->stbuf);
+err:
         return 0;
 }
 
 
 int
-dht_ftruncate (call_frame_t *frame, xlator_t *this,
-               fd_t *fd, off_t offset)
+dht_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              int32_t keep_size, off_t offset, size_t len)
 {
         xlator_t     *subvol = NULL;
         int           op_errno = -1;
@@ -1371,15 +1792,15 @@ dht_ftruncate (call_frame_t *frame, xlator_t *this,
         local->inode = inode_ref (fd->inode);
         local->call_cnt = 1;
 
-        STACK_WIND (frame, dht_truncate_cbk,
-                    subvol, subvol->fops->ftruncate,
-                    fd, offset);
+        STACK_WIND (frame, dht_zerofill_cbk,
+                    subvol, subvol->fops->zerofill,
+                    fd, keep_size, offset, len);
 
         return 0;
 
 err:
         op_errno = (op_errno == -1) ? errno : op_errno;
-        DHT_STACK_UNWIND (ftruncate, frame, -1, op_errno, NULL, NULL);
+        DHT_STACK_UNWIND (zerofill, frame, -1, op_errno, NULL, NULL);
 
         return 0;
 }
@@ -2835,62 +3256,53 @@ err:
 }
 
 
-int
-dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
-                  int op_errno, gf_dirent_t *orig_entries)
+/* Keeps the entries of a readdirp reply of @subvol which distribute
+   shows (no linkfiles, directories only from the first up subvolume) and
+   transforms their offsets. *next_p is left at the offset of the last
+   entry looked at, *size_p (if given) gets the bytes kept. */
+static int
+dht_readdirp_filter (xlator_t *this, xlator_t *subvol, dht_layout_t *layout,
+                     gf_dirent_t *orig_entries, gf_dirent_t *entries,
+                     off_t *next_p, size_t *size_p)
 {
-        dht_local_t  *local = NULL;
-        gf_dirent_t   entries;
         gf_dirent_t  *orig_entry = NULL;
         gf_dirent_t  *entry = NULL;
-        call_frame_t *prev = NULL;
-        xlator_t     *next_subvol = NULL;
-        off_t         next_offset = 0;
+        xlator_t     *first_up = NULL;
+        xlator_t     *hashed = NULL;
+        dht_conf_t   *conf = NULL;
         int           count = 0;
-        dht_layout_t *layout = 0;
-        dht_conf_t   *conf   = NULL;
-        xlator_t     *subvol = 0;
-
-        INIT_LIST_HEAD (&entries.list);
-        prev = cookie;
-        local = frame->local;
-        conf  = this->private;
-
-        if (op_ret < 0)
-                goto done;
-
-        if (!local->layout)
-                local->layout = dht_layout_get (this, local->fd->inode);
 
-        layout = local->layout;
+        conf = this->private;
+        first_up = dht_first_up_subvol (this);
 
         list_for_each_entry (orig_entry, (&orig_entries->list), list) {
-                next_offset = orig_entry->d_off;
-
                 if (check_is_linkfile (NULL, (&orig_entry->d_stat), NULL)
                     || (check_is_dir (NULL, (&orig_entry->d_stat), NULL)
-                        && (prev->this != dht_first_up_subvol (this)))) {
+                        && (subvol != first_up))) {
+                        *next_p = orig_entry->d_off;
                         continue;
                 }
 
                 entry = gf_dirent_for_name (orig_entry->d_name);
                 if (!entry) {
-
-                        goto unwind;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "memory allocation failed :(");
+                        break;
                 }
 
                 /* Do this if conf->search_unhashed is set to "auto" */
-                if (conf->search_unhashed == GF_DHT_LOOKUP_UNHASHED_AUTO) {
-                        subvol = dht_layout_search (this, layout,
+                if (layout &&
+                    (conf->search_unhashed == GF_DHT_LOOKUP_UNHASHED_AUTO)) {
+                        hashed = dht_layout_search (this, layout,
                                                     orig_entry->d_name);
-                        if (!subvol || (subvol != prev->this)) {
+                        if (!hashed || (hashed != subvol)) {
                                 /* TODO: Count the number of entries which need
                                    linkfile to prove its existance in fs */
                                 layout->search_unhashed++;
                         }
                 }
 
-                dht_itransform (this, prev->this, orig_entry->d_off,
+                dht_itransform (this, subvol, orig_entry->d_off,
                                 &entry->d_off);
 
                 entry->d_stat = orig_entry->d_stat;
@@ -2898,9 +3310,41 @@ dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
                 entry->d_type = orig_entry->d_type;
                 entry->d_len  = orig_entry->d_len;
 
-                list_add_tail (&entry->list, &entries.list);
+                list_add_tail (&entry->list, &entries->list);
+                if (size_p)
+                        *size_p += gf_dirent_size (entry->d_name);
+                *next_p = orig_entry->d_off;
                 count++;
         }
+
+        return count;
+}
+
+
+int
+dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+                  int op_errno, gf_dirent_t *orig_entries)
+{
+        dht_local_t  *local = NULL;
+        gf_dirent_t   entries;
+        call_frame_t *prev = NULL;
+        xlator_t     *next_subvol = NULL;
+        off_t         next_offset = 0;
+        int           count = 0;
+
+        INIT_LIST_HEAD (&entries.list);
+        prev = cookie;
+        local = frame->local;
+
+        if (op_ret < 0)
+                goto done;
+
+        if (!local->layout)
+                local->layout = dht_layout_get (this, local->fd->inode);
+
+        count = dht_readdirp_filter (this, prev->this, local->layout,
+                                     orig_entries, &entries, &next_offset,
+                                     NULL);
         op_ret = count;
         /* We need to ensure that only the last subvolume's end-of-directory
          * notification is respected so that directory reading does not stop
@@ -3043,6 +3487,468 @@ unwind:
 }
 
 
+static dht_fd_ctx_t *
+dht_fd_ctx_get (xlator_t *this, fd_t *fd)
+{
+        dht_conf_t   *conf = NULL;
+        dht_fd_ctx_t *ctx = NULL;
+        uint64_t      value = 0;
+        int           ret = 0;
+        int           i = 0;
+
+        conf = this->private;
+
+        LOCK (&fd->lock);
+        {
+                ret = __fd_ctx_get (fd, this, &value);
+                if (ret == 0) {
+                        ctx = (dht_fd_ctx_t *)(long)value;
+                        goto unlock;
+                }
+
+                ctx = GF_CALLOC (1, sizeof (*ctx) + conf->subvolume_cnt
+                                 * sizeof (dht_rd_buf_t), gf_dht_mt_fd_ctx_t);
+                if (!ctx)
+                        goto unlock;
+
+                LOCK_INIT (&ctx->lock);
+                for (i = 0; i < conf->subvolume_cnt; i++) {
+                        INIT_LIST_HEAD (&ctx->bufs[i].entries.list);
+                        INIT_LIST_HEAD (&ctx->bufs[i].waitq);
+                }
+
+                ret = __fd_ctx_set (fd, this, (uint64_t)(long)ctx);
+                if (ret) {
+                        LOCK_DESTROY (&ctx->lock);
+                        GF_FREE (ctx);
+                        ctx = NULL;
+                }
+        }
+unlock:
+        UNLOCK (&fd->lock);
+
+        return ctx;
+}
+
+
+static void
+__dht_rd_buf_reset (dht_fd_ctx_t *ctx, dht_rd_buf_t *buf, off_t off)
+{
+        gf_dirent_free (&buf->entries);
+        INIT_LIST_HEAD (&buf->entries.list);
+
+        ctx->size    -= buf->size;
+        buf->size     = 0;
+        buf->count    = 0;
+        buf->start    = off;
+        buf->next     = off;
+        buf->eof      = 0;
+        buf->op_errno = 0;
+}
+
+
+static int
+__dht_rd_buf_stale (dht_rd_buf_t *buf, struct timeval *now)
+{
+        int64_t age = 0;
+
+        if (!buf->count && !buf->eof)
+                return 0;
+
+        age = (now->tv_sec - buf->stamp.tv_sec) * 1000
+                + (now->tv_usec - buf->stamp.tv_usec) / 1000;
+
+        return (age > DHT_READDIR_PREFETCH_MAX_AGE);
+}
+
+
+/* Claims a readdirp of @batch bytes on subvolume @idx, which the caller
+   winds after dropping the lock. Without @force only as long as the fd
+   stays in its budget and the subvolume holds at most its share of it. */
+static int
+__dht_readdirp_prefetch_mark (xlator_t *this, dht_fd_ctx_t *ctx, int idx,
+                              size_t batch, int window, int force)
+{
+        dht_conf_t   *conf = NULL;
+        dht_rd_buf_t *buf = NULL;
+
+        conf = this->private;
+        buf = &ctx->bufs[idx];
+
+        if (buf->inflight || buf->eof)
+                return 0;
+
+        if (!force) {
+                if (!conf->subvolume_status[idx])
+                        return 0;
+                if ((ctx->size + batch) > conf->readdir_prefetch_size)
+                        return 0;
+                if (buf->size >= (conf->readdir_prefetch_size / (window + 1)))
+                        return 0;
+        }
+
+        buf->inflight = 1;
+        ctx->size += batch;
+
+        return 1;
+}
+
+
+static size_t
+dht_readdirp_prefetch_batch (xlator_t *this, size_t size, int window)
+{
+        dht_conf_t *conf = NULL;
+        size_t      batch = 0;
+
+        conf = this->private;
+
+        batch = min (conf->readdir_prefetch_size / (window + 1) / 2,
+                     DHT_READDIR_PREFETCH_BATCH);
+
+        return max (batch, size);
+}
+
+
+int dht_readdirp (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+                  off_t yoff);
+int dht_readdirp_prefetch_cbk (call_frame_t *frame, void *cookie,
+                               xlator_t *this, int op_ret, int op_errno,
+                               gf_dirent_t *orig_entries);
+
+
+/* @prefetch_frame is a copy of the triggering frame taken before any of
+   the winds, a queued readdirp may be answered by the first of them. */
+static void
+dht_readdirp_prefetch_wind (call_frame_t *prefetch_frame, xlator_t *this,
+                            fd_t *fd, dht_fd_ctx_t *ctx, int idx, size_t batch)
+{
+        dht_conf_t    *conf = NULL;
+        dht_local_t   *local = NULL;
+        dht_rd_buf_t  *buf = NULL;
+        call_stub_t   *stub = NULL;
+        call_stub_t   *tmp = NULL;
+        xlator_t      *subvol = NULL;
+        struct list_head waitq;
+
+        conf = this->private;
+        buf = &ctx->bufs[idx];
+        subvol = conf->subvolumes[idx];
+
+        if (!prefetch_frame)
+                goto err;
+
+        local = dht_local_init (prefetch_frame);
+        if (!local) {
+                STACK_DESTROY (prefetch_frame->root);
+                goto err;
+        }
+
+        local->fd = fd_ref (fd);
+        local->size = batch;
+
+        /* buf->next only moves with the reply of this very wind */
+        STACK_WIND (prefetch_frame, dht_readdirp_prefetch_cbk,
+                    subvol, subvol->fops->readdirp, fd, batch, buf->next);
+        return;
+
+err:
+        gf_log (this->name, GF_LOG_ERROR,
+                "cannot read ahead of %s, skipping it", subvol->name);
+
+        INIT_LIST_HEAD (&waitq);
+        LOCK (&ctx->lock);
+        {
+                buf->inflight = 0;
+                buf->eof = 1;
+                buf->op_errno = ENOMEM;
+                ctx->size -= batch;
+                list_splice_init (&buf->waitq, &waitq);
+        }
+        UNLOCK (&ctx->lock);
+
+        list_for_each_entry_safe (stub, tmp, &waitq, list) {
+                list_del_init (&stub->list);
+                call_resume (stub);
+        }
+}
+
+
+int
+dht_readdirp_prefetch_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int op_ret, int op_errno, gf_dirent_t *orig_entries)
+{
+        dht_local_t   *local = NULL;
+        dht_conf_t    *conf = NULL;
+        dht_fd_ctx_t  *ctx = NULL;
+        dht_rd_buf_t  *buf = NULL;
+        call_frame_t  *prev = NULL;
+        call_stub_t   *stub = NULL;
+        call_stub_t   *tmp = NULL;
+        gf_dirent_t    entries;
+        off_t          next_offset = 0;
+        size_t         size = 0;
+        size_t         batch = 0;
+        uint64_t       value = 0;
+        int            count = 0;
+        int            window = 0;
+        int            again = 0;
+        int            idx = 0;
+        struct timeval now = {0, };
+        struct list_head waitq;
+
+        INIT_LIST_HEAD (&entries.list);
+        INIT_LIST_HEAD (&waitq);
+        prev = cookie;
+        local = frame->local;
+        conf = this->private;
+
+        fd_ctx_get (local->fd, this, &value);
+        ctx = (dht_fd_ctx_t *)(long)value;
+        idx = dht_subvol_cnt (this, prev->this);
+        buf = &ctx->bufs[idx];
+
+        /* reconfigured to 0, let the fd drain what it holds */
+        window = min (conf->readdir_prefetch_subvols,
+                      DHT_READDIR_PREFETCH_MAX_SUBVOLS);
+        if (window > 0)
+                batch = dht_readdirp_prefetch_batch (this, local->size,
+                                                     window);
+
+        if (op_ret > 0) {
+                if (!local->layout)
+                        local->layout = dht_layout_get (this,
+                                                        local->fd->inode);
+                count = dht_readdirp_filter (this, prev->this, local->layout,
+                                             orig_entries, &entries,
+                                             &next_offset, &size);
+        }
+
+        gettimeofday (&now, NULL);
+
+        LOCK (&ctx->lock);
+        {
+                buf->inflight = 0;
+                ctx->size -= local->size;
+
+                if (!buf->count && !buf->eof)
+                        buf->stamp = now;
+
+                if (op_ret <= 0) {
+                        /* same as the direct path: an error on a subvolume
+                           skips it, an empty reply is its end */
+                        buf->eof = 1;
+                        buf->op_errno = op_errno;
+                } else {
+                        list_splice_init (&entries.list,
+                                          buf->entries.list.prev);
+                        buf->count += count;
+                        buf->size  += size;
+                        buf->next   = next_offset;
+                        ctx->size  += size;
+
+                        if (window > 0)
+                                again = __dht_readdirp_prefetch_mark (this,
+                                                                      ctx, idx,
+                                                                      batch,
+                                                                      window,
+                                                                      0);
+                }
+
+                list_splice_init (&buf->waitq, &waitq);
+        }
+        UNLOCK (&ctx->lock);
+
+        if (again)
+                dht_readdirp_prefetch_wind (copy_frame (frame), this,
+                                            local->fd, ctx, idx, batch);
+
+        list_for_each_entry_safe (stub, tmp, &waitq, list) {
+                list_del_init (&stub->list);
+                call_resume (stub);
+        }
+
+        DHT_STACK_DESTROY (frame);
+
+        return 0;
+}
+
+
+/* Serves a readdirp from the entries read ahead on the fd, queueing it
+   behind the outstanding readdirp of its subvolume if there are none yet,
+   and tops up the read-ahead of the next readdir-prefetch-subvols
+   subvolumes. The stream and its offsets are exactly the ones of the
+   direct path. Returns -1 when the readdirp has to be wound directly. */
+static int
+dht_readdirp_prefetched (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                         size_t size, off_t yoff)
+{
+        dht_conf_t    *conf = NULL;
+        dht_fd_ctx_t  *ctx = NULL;
+        dht_rd_buf_t  *buf = NULL;
+        gf_dirent_t   *entry = NULL;
+        gf_dirent_t   *tmp = NULL;
+        call_stub_t   *stub = NULL;
+        xlator_t      *xvol = NULL;
+        gf_dirent_t    entries;
+        off_t          xoff = 0;
+        off_t          last = 0;
+        size_t         filled = 0;
+        size_t         this_size = 0;
+        size_t         batch = 0;
+        call_frame_t  *frames[DHT_READDIR_PREFETCH_MAX_SUBVOLS + 1];
+        int            pick[DHT_READDIR_PREFETCH_MAX_SUBVOLS + 1];
+        int            picked = 0;
+        int            window = 0;
+        int            served = 0;
+        int            waiting = 0;
+        int            count = 0;
+        int            op_errno = 0;
+        int            idx = 0;
+        int            i = 0;
+        struct timeval now = {0, };
+
+        conf = this->private;
+        window = min (conf->readdir_prefetch_subvols,
+                      DHT_READDIR_PREFETCH_MAX_SUBVOLS);
+        if (window <= 0)
+                return -1;
+
+        ctx = dht_fd_ctx_get (this, fd);
+        if (!ctx)
+                return -1;
+
+        batch = dht_readdirp_prefetch_batch (this, size, window);
+
+        dht_deitransform (this, yoff, &xvol, (uint64_t *)&xoff);
+        idx = dht_subvol_cnt (this, xvol);
+
+        INIT_LIST_HEAD (&entries.list);
+        gettimeofday (&now, NULL);
+
+        LOCK (&ctx->lock);
+        {
+                /* rewinddir, do not hand out what was read before it */
+                if ((yoff == 0) && ctx->served) {
+                        ctx->served = 0;
+                        for (i = 0; i < conf->subvolume_cnt; i++) {
+                                if (!ctx->bufs[i].inflight)
+                                        __dht_rd_buf_reset (ctx,
+                                                            &ctx->bufs[i], 0);
+                        }
+                }
+
+                for (;;) {
+                        buf = &ctx->bufs[idx];
+
+                        if (buf->start != xoff) {
+                                /* a seek, or a reader of its own */
+                                if (buf->inflight)
+                                        break;
+                                __dht_rd_buf_reset (ctx, buf, xoff);
+                        }
+
+                        if (__dht_rd_buf_stale (buf, &now)) {
+                                /* the read-ahead of a reply still in flight
+                                   continues the stale one, go direct */
+                                if (buf->inflight)
+                                        break;
+                                __dht_rd_buf_reset (ctx, buf, xoff);
+                        }
+
+                        if (buf->count) {
+                                served = 1;
+                                break;
+                        }
+
+                        if (!buf->eof) {
+                                waiting = 1;
+                                break;
+                        }
+
+                        xvol = dht_subvol_next (this, xvol);
+                        if (!xvol) {
+                                op_errno = buf->op_errno;
+                                served = 1;
+                                break;
+                        }
+                        idx++;
+                        xoff = 0;
+                }
+
+                if (served && buf->count) {
+                        list_for_each_entry_safe (entry, tmp,
+                                                  &buf->entries.list, list) {
+                                this_size = gf_dirent_size (entry->d_name);
+                                if ((this_size + filled) > size)
+                                        break;
+
+                                list_del_init (&entry->list);
+                                list_add_tail (&entry->list, &entries.list);
+                                last = entry->d_off;
+                                filled += this_size;
+                                count++;
+                        }
+
+                        if (count)
+                                ctx->served = 1;
+                        buf->count -= count;
+                        buf->size  -= filled;
+                        ctx->size  -= filled;
+                        if (count)
+                                dht_deitransform (this, last, NULL,
+                                                  (uint64_t *)&buf->start);
+
+                        if (!buf->count && buf->eof
+                            && (xvol == dht_last_up_subvol (this)))
+                                op_errno = buf->op_errno;
+                }
+
+                if (waiting) {
+                        dht_itransform (this, xvol, xoff, (uint64_t *)&yoff);
+                        stub = fop_readdirp_stub (frame, dht_readdirp, fd,
+                                                  size, yoff);
+                        if (stub)
+                                list_add_tail (&stub->list, &buf->waitq);
+                        else
+                                waiting = 0;
+                }
+
+                if (served || waiting) {
+                        if (__dht_readdirp_prefetch_mark (this, ctx, idx,
+                                                          batch, window,
+                                                          waiting))
+                                pick[picked++] = idx;
+
+                        for (i = idx + 1; (i <= idx + window)
+                                     && (i < conf->subvolume_cnt); i++) {
+                                if (__dht_readdirp_prefetch_mark (this, ctx, i,
+                                                                  batch,
+                                                                  window, 0))
+                                        pick[picked++] = i;
+                        }
+                }
+        }
+        UNLOCK (&ctx->lock);
+
+        if (!served && !waiting)
+                return -1;
+
+        for (i = 0; i < picked; i++)
+                frames[i] = copy_frame (frame);
+
+        for (i = 0; i < picked; i++)
+                dht_readdirp_prefetch_wind (frames[i], this, fd, ctx, pick[i],
+                                            batch);
+
+        if (served) {
+                DHT_STACK_UNWIND (readdirp, frame, count, op_errno, &entries);
+                gf_dirent_free (&entries);
+        }
+
+        return 0;
+}
+
+
 int
 dht_do_readdir (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                 off_t yoff, int whichop)
@@ -3060,6 +3966,10 @@ dht_do_readdir (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
 
         conf = this->private;
 
+        if ((whichop == GF_FOP_READDIRP)
+            && (dht_readdirp_prefetched (frame, this, fd, size, yoff) == 0))
+                return 0;
+
         local = dht_local_init (frame);
         if (!local) {
 
@@ -4916,6 +5826,32 @@ dht_forget (xlator_t *this, inode_t *inode)
 
 
 
+int
+dht_releasedir (xlator_t *this, fd_t *fd)
+{
+        dht_conf_t   *conf = NULL;
+        dht_fd_ctx_t *ctx = NULL;
+        uint64_t      value = 0;
+        int           i = 0;
+
+        conf = this->private;
+
+        fd_ctx_del (fd, this, &value);
+        if (!value)
+                return 0;
+
+        /* every prefetch and queued readdirp holds a ref on the fd */
+        ctx = (dht_fd_ctx_t *)(long)value;
+        for (i = 0; i < conf->subvolume_cnt; i++)
+                gf_dirent_free (&ctx->bufs[i].entries);
+
+        LOCK_DESTROY (&ctx->lock);
+        GF_FREE (ctx);
+
+        return 0;
+}
+
+
 int
 dht_init_subvolumes (xlator_t *this, dht_conf_t *conf)
 {
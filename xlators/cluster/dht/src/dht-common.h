@@ -33,6 +33,9 @@
 #define GF_DHT_LOOKUP_UNHASHED_ON   1
 #define GF_DHT_LOOKUP_UNHASHED_AUTO 2
 #define DHT_PATHINFO_HEADER "DISTRIBUTE:"
+#define DHT_READDIR_PREFETCH_BATCH (64 * GF_UNIT_KB)
+#define DHT_READDIR_PREFETCH_MAX_SUBVOLS 64
+#define DHT_READDIR_PREFETCH_MAX_AGE 1000 /* msecs */
 
 #include <fnmatch.h>
 
@@ -64,6 +67,33 @@ struct dht_layout {
 typedef struct dht_layout dht_layout_t;
 
 
+/* readdirp prefetch state of one subvolume of a directory fd. The
+   buffered entries are already filtered and carry transformed offsets,
+   they continue the subvolume's stream from 'start' up to 'next'. Their
+   iatts are dropped once the oldest reply held is past the max age. */
+struct dht_rd_buf {
+        gf_dirent_t              entries;
+        int                      count;
+        size_t                   size;
+        off_t                    start;
+        off_t                    next;
+        int                      op_errno;  /* of the reply that hit EOD */
+        struct timeval           stamp;     /* of the oldest reply held */
+        char                     inflight;
+        char                     eof;
+        struct list_head         waitq;     /* stubs waiting for inflight */
+};
+typedef struct dht_rd_buf dht_rd_buf_t;
+
+struct dht_fd_ctx {
+        gf_lock_t                lock;
+        size_t                   size;      /* buffered + in flight, bytes */
+        char                     served;    /* since the last rewind */
+        dht_rd_buf_t             bufs[0];   /* one per subvolume */
+};
+typedef struct dht_fd_ctx dht_fd_ctx_t;
+
+
 typedef enum {
         DHT_HASH_TYPE_DM,
 } dht_hashfn_type_t;
@@ -184,6 +214,11 @@ struct dht_conf {
         /* Will be a global flag to control the layout spread count */
         uint32_t       dir_spread_cnt;
 
+        /* readdirp: subvolumes read ahead of the current one, and the
+           bytes of entries that may be buffered per directory fd */
+        int32_t        readdir_prefetch_subvols;
+        uint64_t       readdir_prefetch_size;
+
 	struct syncenv *env; /* The env pointer to the rebalance synctask */
 };
 typedef struct dht_conf dht_conf_t;
@@ -334,5 +369,7 @@ int dht_fix_directory_layout (call_frame_t *frame,
                               dht_selfheal_dir_cbk_t dir_cbk,
                               dht_layout_t *layout);
 
+int dht_releasedir (xlator_t *this, fd_t *fd);
+
 int dht_start_rebalance_task (xlator_t *this, call_frame_t *frame);
 #endif /* _DHT_H */
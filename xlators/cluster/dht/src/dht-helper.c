@@ -89,7 +89,7 @@ dht_filter_loc_subvol_key (xlator_t *this, loc_t *loc, loc_t *new_loc,
         int            ret       = 0; /* not found */
 
         /* Why do other tasks if first required 'char' itself is not there */
-        if (loc->name && !strchr (loc->name, '@'))
+        if (!loc->name || !strchr (loc->name, '@'))
                 goto out;
 
         trav = this->children;
@@ -331,6 +331,11 @@ dht_subvol_get_hashed (xlator_t *this, loc_t *loc)
                 goto out;
         }
 
+        if (!loc->parent) {
+                /* loc of a nameless (gfid) lookup, no name to hash */
+                goto out;
+        }
+
         layout = dht_layout_get (this, loc->parent);
 
         if (!layout) {
@@ -299,6 +299,12 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("directory-layout-spread", conf->dir_spread_cnt,
                           options, uint32, out);
 
+        GF_OPTION_RECONF ("readdir-prefetch-subvols",
+                          conf->readdir_prefetch_subvols, options, int32, out);
+
+        GF_OPTION_RECONF ("readdir-prefetch-size", conf->readdir_prefetch_size,
+                          options, size, out);
+
         ret = 0;
 out:
         return ret;
@@ -355,6 +361,12 @@ init (xlator_t *this)
         GF_OPTION_INIT ("assert-no-child-down", conf->assert_no_child_down,
                         bool, err);
 
+        GF_OPTION_INIT ("readdir-prefetch-subvols",
+                        conf->readdir_prefetch_subvols, int32, err);
+
+        GF_OPTION_INIT ("readdir-prefetch-size", conf->readdir_prefetch_size,
+                        size, err);
+
         ret = dht_init_subvolumes (this, conf);
         if (ret == -1) {
                 goto err;
@@ -423,6 +435,9 @@ struct xlator_fops fops = {
         .fstat       = dht_fstat,
         .truncate    = dht_truncate,
         .ftruncate   = dht_ftruncate,
+        .fallocate   = dht_fallocate,
+        .discard     = dht_discard,
+        .zerofill    = dht_zerofill,
         .access      = dht_access,
         .readlink    = dht_readlink,
         .setxattr    = dht_setxattr,
@@ -464,7 +479,7 @@ struct xlator_dumpops dumpops = {
 
 struct xlator_cbks cbks = {
 //      .release    = dht_release,
-//      .releasedir = dht_releasedir,
+        .releasedir = dht_releasedir,
         .forget     = dht_forget
 };
 
@@ -497,5 +512,22 @@ struct volume_options options[] = {
         { .key  = {"directory-layout-spread"},
           .type = GF_OPTION_TYPE_INT,
         },
+        { .key  = {"readdir-prefetch-subvols"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = DHT_READDIR_PREFETCH_MAX_SUBVOLS,
+          .default_value = "8",
+          .description = "Number of subvolumes past the one being listed "
+                         "that readdirp reads from in parallel. 0 lists "
+                         "the subvolumes one after the other."
+        },
+        { .key  = {"readdir-prefetch-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min  = 64 * GF_UNIT_KB,
+          .max  = 64 * GF_UNIT_MB,
+          .default_value = "1MB",
+          .description = "Bytes of directory entries read ahead per "
+                         "open directory."
+        },
         { .key  = {NULL} },
 };
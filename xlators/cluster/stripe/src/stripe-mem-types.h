@@ -35,6 +35,9 @@ enum gf_stripe_mem_types_ {
         gf_stripe_mt_stripe_private_t,
         gf_stripe_mt_stripe_options,
         gf_stripe_mt_xattr_sort_t,
+        gf_stripe_mt_space_child,
+        gf_stripe_mt_stripe_row_t,
+        gf_stripe_mt_stripe_inode_ctx_t,
         gf_stripe_mt_end
 };
 #endif
@@ -61,6 +61,9 @@ stripe_local_wipe (stripe_local_t *local)
         if (local->dict)
                 dict_unref (local->dict);
 
+        if (local->space)
+                GF_FREE (local->space);
+
 out:
         return;
 }
@@ -705,6 +708,8 @@ stripe_truncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         local->post_buf.ia_size   = local->postbuf_size;
                 }
 
+                stripe_row_invalidate (this, local->inode);
+
                 STRIPE_STACK_UNWIND (truncate, frame, local->op_ret,
                                      local->op_errno, &local->pre_buf,
                                      &local->post_buf);
@@ -735,6 +740,8 @@ stripe_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset)
                 goto err;
         }
 
+        stripe_row_invalidate (this, loc->inode);
+
         /* Initialization */
         local = GF_CALLOC (1, sizeof (stripe_local_t),
                            gf_stripe_mt_stripe_local_t);
@@ -744,6 +751,7 @@ stripe_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset)
         }
         local->op_ret = -1;
         frame->local = local;
+        local->inode = inode_ref (loc->inode);
         local->call_count = priv->child_count;
 
         while (trav) {
@@ -2989,6 +2997,8 @@ stripe_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
         priv = this->private;
         trav = this->children;
 
+        stripe_row_invalidate (this, fd->inode);
+
         /* Initialization */
         local = GF_CALLOC (1, sizeof (stripe_local_t),
                            gf_stripe_mt_stripe_local_t);
@@ -2998,6 +3008,7 @@ stripe_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
         }
         local->op_ret = -1;
         frame->local = local;
+        local->inode = inode_ref (fd->inode);
         local->call_count = priv->child_count;
 
         while (trav) {
@@ -3013,6 +3024,457 @@ err:
 }
 
 
+/* Holes of a striped file are holes on every child, and each child only
+ * ever holds data for its own blocks, so punching the whole range on all
+ * children discards exactly the blocks of the range.
+ */
+int32_t
+stripe_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                    struct iatt *postbuf)
+{
+        int32_t         callcnt = 0;
+        stripe_local_t *local = NULL;
+        call_frame_t   *prev = NULL;
+
+        if (!this || !frame || !frame->local || !cookie) {
+                gf_log ("stripe", GF_LOG_DEBUG, "possible NULL deref");
+                goto out;
+        }
+
+        prev  = cookie;
+        local = frame->local;
+
+        LOCK (&frame->lock);
+        {
+                callcnt = --local->call_count;
+
+                if (op_ret == -1) {
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "%s returned error %s",
+                                prev->this->name, strerror (op_errno));
+                        local->op_errno = op_errno;
+                        local->failed = 1;
+                }
+
+                if (op_ret == 0) {
+                        local->op_ret = 0;
+                        if (FIRST_CHILD(this) == prev->this) {
+                                local->pre_buf  = *prebuf;
+                                local->post_buf = *postbuf;
+                        }
+
+                        local->prebuf_blocks  += prebuf->ia_blocks;
+                        local->postbuf_blocks += postbuf->ia_blocks;
+
+                        if (local->prebuf_size < prebuf->ia_size)
+                                local->prebuf_size = prebuf->ia_size;
+
+                        if (local->postbuf_size < postbuf->ia_size)
+                                local->postbuf_size = postbuf->ia_size;
+                }
+        }
+        UNLOCK (&frame->lock);
+
+        if (!callcnt) {
+                if (local->failed)
+                        local->op_ret = -1;
+
+                if (local->op_ret != -1) {
+                        local->pre_buf.ia_blocks  = local->prebuf_blocks;
+                        local->pre_buf.ia_size    = local->prebuf_size;
+                        local->post_buf.ia_blocks = local->postbuf_blocks;
+                        local->post_buf.ia_size   = local->postbuf_size;
+                }
+
+                stripe_row_invalidate (this, local->inode);
+
+                STRIPE_STACK_UNWIND (discard, frame, local->op_ret,
+                                     local->op_errno, &local->pre_buf,
+                                     &local->post_buf);
+        }
+out:
+        return 0;
+}
+
+
+int32_t
+stripe_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                off_t offset, size_t len)
+{
+        stripe_local_t   *local = NULL;
+        stripe_private_t *priv = NULL;
+        xlator_list_t    *trav = NULL;
+        int32_t           op_errno = 1;
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+        VALIDATE_OR_GOTO (fd->inode, err);
+
+        priv = this->private;
+        trav = this->children;
+
+        stripe_row_invalidate (this, fd->inode);
+
+        local = GF_CALLOC (1, sizeof (stripe_local_t),
+                           gf_stripe_mt_stripe_local_t);
+        if (!local) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+        local->op_ret = -1;
+        frame->local = local;
+        local->inode = inode_ref (fd->inode);
+        local->call_count = priv->child_count;
+
+        while (trav) {
+                STACK_WIND (frame, stripe_discard_cbk, trav->xlator,
+                            trav->xlator->fops->discard, fd, offset, len);
+                trav = trav->next;
+        }
+
+        return 0;
+err:
+        STRIPE_STACK_UNWIND (discard, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+/* Allocating or zeroing the whole range on every child would cost each
+ * of them the space of the other children's blocks, so fallocate and
+ * zerofill go to each child as one fop per block of its own. All the
+ * children are sent their blocks in parallel, each with up to
+ * STRIPE_SPACE_WINDOW of them in flight, a reply sending the next one.
+ */
+static int
+__stripe_space_claim (stripe_local_t *local, int idx, off_t *start,
+                      size_t *len)
+{
+        struct stripe_space_child *child = NULL;
+        off_t                      block_end = 0;
+
+        child = &local->space[idx];
+        if (child->next >= local->space_end)
+                return 0;
+
+        *start    = child->next;
+        block_end = *start - (*start % local->stripe_size) +
+                local->stripe_size;
+        if (block_end > local->space_end)
+                block_end = local->space_end;
+        *len = block_end - *start;
+
+        /* the next block of this child, one full stripe further on */
+        child->next = *start - (*start % local->stripe_size) +
+                (local->stripe_size * local->fctx->stripe_count);
+        child->inflight++;
+
+        return 1;
+}
+
+
+static void
+stripe_space_wind (call_frame_t *frame, xlator_t *this, int idx,
+                   off_t start, size_t len);
+
+static void
+stripe_space_unwind (call_frame_t *frame, xlator_t *this)
+{
+        int                        idx     = 0;
+        stripe_local_t            *local   = NULL;
+        stripe_fd_ctx_t           *fctx    = NULL;
+        struct stripe_space_child *child   = NULL;
+
+        local = frame->local;
+        fctx  = local->fctx;
+
+        local->op_ret = -1;
+        if (!local->failed) {
+                local->op_ret = 0;
+                for (idx = 0; idx < fctx->stripe_count; idx++) {
+                        child = &local->space[idx];
+                        if (!child->started)
+                                continue;
+
+                        if (!local->pre_buf.ia_ino) {
+                                local->pre_buf  = child->prebuf;
+                                local->post_buf = child->postbuf;
+                        }
+
+                        local->prebuf_blocks  += child->prebuf.ia_blocks;
+                        local->postbuf_blocks += child->postbuf.ia_blocks;
+
+                        if (local->prebuf_size < child->prebuf.ia_size)
+                                local->prebuf_size = child->prebuf.ia_size;
+
+                        if (local->postbuf_size < child->postbuf.ia_size)
+                                local->postbuf_size = child->postbuf.ia_size;
+                }
+
+                local->pre_buf.ia_blocks  = local->prebuf_blocks;
+                local->pre_buf.ia_size    = local->prebuf_size;
+                local->post_buf.ia_blocks = local->postbuf_blocks;
+                local->post_buf.ia_size   = local->postbuf_size;
+        }
+
+        stripe_row_invalidate (this, local->fd->inode);
+
+        if (local->space_fop == GF_FOP_FALLOCATE)
+                STRIPE_STACK_UNWIND (fallocate, frame, local->op_ret,
+                                     local->op_errno, &local->pre_buf,
+                                     &local->post_buf);
+        else
+                STRIPE_STACK_UNWIND (zerofill, frame, local->op_ret,
+                                     local->op_errno, &local->pre_buf,
+                                     &local->post_buf);
+}
+
+
+int32_t
+stripe_space_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf)
+{
+        int32_t                    callcnt = 0;
+        int                        idx     = 0;
+        int                        more    = 0;
+        int                        done    = 0;
+        off_t                      start   = 0;
+        size_t                     len     = 0;
+        stripe_local_t            *local   = NULL;
+        stripe_fd_ctx_t           *fctx    = NULL;
+        struct stripe_space_child *child   = NULL;
+        call_frame_t              *prev    = NULL;
+
+        if (!this || !frame || !frame->local || !cookie) {
+                gf_log ("stripe", GF_LOG_DEBUG, "possible NULL deref");
+                goto out;
+        }
+
+        prev  = cookie;
+        local = frame->local;
+        fctx  = local->fctx;
+
+        for (idx = 0; idx < fctx->stripe_count; idx++)
+                if (fctx->xl_array[idx] == prev->this)
+                        break;
+        child = &local->space[idx];
+
+        LOCK (&frame->lock);
+        {
+                child->inflight--;
+
+                if (op_ret == -1) {
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "%s returned error %s",
+                                prev->this->name, strerror (op_errno));
+                        local->op_errno = op_errno;
+                        local->failed = 1;
+                } else {
+                        /* the replies of a child come in any order, its
+                           pre-op state is the first one seen and its
+                           post-op state the most allocated one */
+                        if (!child->started)
+                                child->prebuf = *prebuf;
+                        if (!child->started
+                            || (postbuf->ia_blocks
+                                >= child->postbuf.ia_blocks))
+                                child->postbuf = *postbuf;
+                        child->started = 1;
+                }
+
+                if (!local->failed)
+                        more = __stripe_space_claim (local, idx, &start,
+                                                     &len);
+                if (!more && !child->inflight) {
+                        callcnt = --local->call_count;
+                        done = 1;
+                }
+        }
+        UNLOCK (&frame->lock);
+
+        if (more) {
+                stripe_space_wind (frame, this, idx, start, len);
+                goto out;
+        }
+
+        if (done && !callcnt)
+                stripe_space_unwind (frame, this);
+out:
+        return 0;
+}
+
+
+static void
+stripe_space_wind (call_frame_t *frame, xlator_t *this, int idx,
+                   off_t start, size_t len)
+{
+        stripe_local_t  *local  = NULL;
+        xlator_t        *subvol = NULL;
+
+        local  = frame->local;
+        subvol = local->fctx->xl_array[idx];
+
+        if (local->space_fop == GF_FOP_FALLOCATE)
+                STACK_WIND (frame, stripe_space_cbk, subvol,
+                            subvol->fops->fallocate, local->fd,
+                            local->keep_size, start, len);
+        else
+                STACK_WIND (frame, stripe_space_cbk, subvol,
+                            subvol->fops->zerofill, local->fd,
+                            local->keep_size, start, len);
+}
+
+
+static int32_t
+stripe_space_op (call_frame_t *frame, xlator_t *this, glusterfs_fop_t fop,
+                 fd_t *fd, int32_t keep_size, off_t offset, size_t len)
+{
+        stripe_local_t   *local = NULL;
+        stripe_fd_ctx_t  *fctx = NULL;
+        uint64_t          tmp_fctx = 0;
+        off_t             block = 0;
+        off_t             first = 0;
+        off_t             starts[STRIPE_SPACE_WINDOW];
+        size_t            lens[STRIPE_SPACE_WINDOW];
+        int               idx = 0;
+        int               count = 0;
+        int               claimed = 0;
+        int               i = 0;
+        int32_t           callcnt = 0;
+        int32_t           op_errno = 1;
+
+        fd_ctx_get (fd, this, &tmp_fctx);
+        if (!tmp_fctx) {
+                op_errno = EINVAL;
+                goto err;
+        }
+        fctx = (stripe_fd_ctx_t *)(long)tmp_fctx;
+
+        stripe_row_invalidate (this, fd->inode);
+
+        local = GF_CALLOC (1, sizeof (stripe_local_t),
+                           gf_stripe_mt_stripe_local_t);
+        if (!local) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+        frame->local = local;
+        local->op_ret      = -1;
+        local->fctx        = fctx;
+        local->fd          = fd_ref (fd);
+        local->space_fop   = fop;
+        local->keep_size   = keep_size;
+        local->stripe_size = fctx->stripe_size;
+        local->offset      = offset;
+        local->space_end   = offset + len;
+
+        local->space = GF_CALLOC (fctx->stripe_count,
+                                  sizeof (struct stripe_space_child),
+                                  gf_stripe_mt_space_child);
+        if (!local->space) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+
+        /* first block of each child at or after the one holding offset */
+        block = offset / local->stripe_size;
+        for (idx = 0; idx < fctx->stripe_count; idx++) {
+                first = block + ((idx - (block % fctx->stripe_count) +
+                                  fctx->stripe_count) % fctx->stripe_count);
+                first *= local->stripe_size;
+                local->space[idx].next = max (first, offset);
+                if (local->space[idx].next < local->space_end)
+                        count++;
+        }
+
+        if (!count) {
+                op_errno = EINVAL;
+                goto err;
+        }
+
+        /* one more for this loop, the replies cannot finish the fop
+           before it is done with local */
+        local->call_count = count + 1;
+        for (idx = 0; idx < fctx->stripe_count; idx++) {
+                LOCK (&frame->lock);
+                {
+                        for (claimed = 0; claimed < STRIPE_SPACE_WINDOW;
+                             claimed++) {
+                                if (!__stripe_space_claim (local, idx,
+                                                           &starts[claimed],
+                                                           &lens[claimed]))
+                                        break;
+                        }
+                }
+                UNLOCK (&frame->lock);
+
+                for (i = 0; i < claimed; i++)
+                        stripe_space_wind (frame, this, idx, starts[i],
+                                           lens[i]);
+        }
+
+        LOCK (&frame->lock);
+        {
+                callcnt = --local->call_count;
+        }
+        UNLOCK (&frame->lock);
+
+        if (!callcnt)
+                stripe_space_unwind (frame, this);
+
+        return 0;
+err:
+        if (fop == GF_FOP_FALLOCATE)
+                STRIPE_STACK_UNWIND (fallocate, frame, -1, op_errno,
+                                     NULL, NULL);
+        else
+                STRIPE_STACK_UNWIND (zerofill, frame, -1, op_errno,
+                                     NULL, NULL);
+        return 0;
+}
+
+
+int32_t
+stripe_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  int32_t keep_size, off_t offset, size_t len)
+{
+        int32_t op_errno = 1;
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+        VALIDATE_OR_GOTO (fd->inode, err);
+
+        return stripe_space_op (frame, this, GF_FOP_FALLOCATE, fd,
+                                keep_size, offset, len);
+err:
+        STRIPE_STACK_UNWIND (fallocate, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+int32_t
+stripe_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                 int32_t keep_size, off_t offset, size_t len)
+{
+        int32_t op_errno = 1;
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+        VALIDATE_OR_GOTO (fd->inode, err);
+
+        return stripe_space_op (frame, this, GF_FOP_ZEROFILL, fd,
+                                keep_size, offset, len);
+err:
+        STRIPE_STACK_UNWIND (zerofill, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+
 int32_t
 stripe_fsyncdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                      int32_t op_ret, int32_t op_errno)
@@ -3098,6 +3560,456 @@ err:
 }
 
 
+void
+stripe_row_free (stripe_row_t *row)
+{
+        int i = 0;
+
+        if (row->replies) {
+                for (i = 0; i < row->fctx->stripe_count; i++) {
+                        if (row->replies[i].vector)
+                                GF_FREE (row->replies[i].vector);
+                }
+                GF_FREE (row->replies);
+        }
+
+        if (row->vector)
+                GF_FREE (row->vector);
+
+        if (row->iobref)
+                iobref_unref (row->iobref);
+
+        if (row->fd)
+                fd_unref (row->fd);
+
+        GF_FREE (row);
+}
+
+
+/* Lines the blocks of a row up one after the other, up to the first one
+ * which came back short: past it there is either the end of the file or
+ * a hole, and reads there take the usual path which tells them apart.
+ */
+static void
+__stripe_row_assemble (stripe_row_t *row)
+{
+        struct readv_replies *reply = NULL;
+        int32_t               count = 0;
+        int                   i     = 0;
+
+        for (i = 0; i < row->fctx->stripe_count; i++)
+                count += row->replies[i].count;
+
+        row->vector = GF_CALLOC (count ? count : 1, sizeof (struct iovec),
+                                 gf_stripe_mt_iovec);
+        if (!row->vector)
+                goto out;
+
+        for (i = 0; i < row->fctx->stripe_count; i++) {
+                reply = &row->replies[i];
+                if (reply->op_ret <= 0)
+                        break;
+
+                if (i == 0)
+                        row->stbuf = reply->stbuf;
+
+                memcpy (row->vector + row->count, reply->vector,
+                        reply->count * sizeof (struct iovec));
+                row->count += reply->count;
+                row->size  += reply->op_ret;
+
+                if (reply->op_ret < row->fctx->stripe_size)
+                        break;
+        }
+
+        row->valid = (row->size > 0);
+out:
+        for (i = 0; i < row->fctx->stripe_count; i++) {
+                if (row->replies[i].vector)
+                        GF_FREE (row->replies[i].vector);
+        }
+        GF_FREE (row->replies);
+        row->replies = NULL;
+}
+
+
+int32_t
+stripe_row_readv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iovec *vector,
+                      int32_t count, struct iatt *stbuf, struct iobref *iobref)
+{
+        stripe_row_t         *row     = NULL;
+        stripe_inode_ctx_t   *ictx    = NULL;
+        struct readv_replies *reply   = NULL;
+        call_stub_t          *stub    = NULL;
+        call_stub_t          *tmp     = NULL;
+        fd_t                 *fd      = NULL;
+        int32_t               pending = 0;
+        int                   drop    = 0;
+        int                   i       = 0;
+        struct list_head      waitq;
+
+        INIT_LIST_HEAD (&waitq);
+
+        row   = frame->local;
+        ictx  = row->ictx;
+        reply = &row->replies[(long)cookie];
+
+        LOCK (&ictx->lock);
+        {
+                reply->op_ret   = op_ret;
+                reply->op_errno = op_errno;
+                if (op_ret > 0) {
+                        reply->stbuf  = *stbuf;
+                        reply->count  = count;
+                        reply->vector = iov_dup (vector, count);
+                        if (reply->vector)
+                                iobref_merge (row->iobref, iobref);
+                        else
+                                reply->op_ret = -1;
+                }
+
+                pending = --row->pending;
+                if (pending)
+                        goto unlock;
+
+                __stripe_row_assemble (row);
+                list_splice_init (&row->waitq, &waitq);
+
+                fd = row->fd;
+                row->fd    = NULL;
+                row->frame = NULL;
+                row->fctx  = NULL;
+
+                /* a stale row was already taken out of the inode's rows */
+                drop = (row->stale || !row->valid);
+                if (drop && !row->stale) {
+                        for (i = 0; i < STRIPE_RA_ROWS; i++) {
+                                if (ictx->rows[i] == row)
+                                        ictx->rows[i] = NULL;
+                        }
+                }
+        }
+unlock:
+        UNLOCK (&ictx->lock);
+
+        if (pending)
+                goto out;
+
+        frame->local = NULL;
+        STACK_DESTROY (frame->root);
+
+        list_for_each_entry_safe (stub, tmp, &waitq, list) {
+                list_del_init (&stub->list);
+                call_resume (stub);
+        }
+
+        if (drop)
+                stripe_row_free (row);
+
+        fd_unref (fd);
+out:
+        return 0;
+}
+
+
+/* Answers a read from the rows already read ahead, if they hold all of
+ * it. Called with ictx->lock held.
+ */
+static int
+__stripe_row_gather (stripe_inode_ctx_t *ictx, off_t offset, size_t size,
+                     struct iovec **vector, int32_t *count,
+                     struct iobref **iobref, struct iatt *stbuf)
+{
+        stripe_row_t  *row    = NULL;
+        struct iovec  *vec    = NULL;
+        struct iobref *tmp    = NULL;
+        off_t          pos    = 0;
+        off_t          end    = 0;
+        off_t          upto   = 0;
+        int32_t        needed = 0;
+        int32_t        filled = 0;
+        int            i      = 0;
+        int            pass   = 0;
+
+        end = offset + size;
+
+        /* first pass counts the vectors, the second fills them in */
+        for (pass = 0; pass < 2; pass++) {
+                for (pos = offset; pos < end; pos = upto) {
+                        row = NULL;
+                        for (i = 0; i < STRIPE_RA_ROWS; i++) {
+                                if (ictx->rows[i] && ictx->rows[i]->valid &&
+                                    (pos >= ictx->rows[i]->offset) &&
+                                    (pos < (ictx->rows[i]->offset +
+                                            ictx->rows[i]->size))) {
+                                        row = ictx->rows[i];
+                                        break;
+                                }
+                        }
+                        if (!row)
+                                return -1;
+
+                        upto = min (end, row->offset + row->size);
+
+                        if (pass == 0) {
+                                needed += iov_subset (row->vector, row->count,
+                                                      pos - row->offset,
+                                                      upto - row->offset,
+                                                      NULL);
+                        } else {
+                                filled += iov_subset (row->vector, row->count,
+                                                      pos - row->offset,
+                                                      upto - row->offset,
+                                                      vec + filled);
+                                iobref_merge (tmp, row->iobref);
+                                if (pos == offset)
+                                        *stbuf = row->stbuf;
+                        }
+                }
+
+                if (pass == 0) {
+                        vec = GF_CALLOC (needed, sizeof (*vec),
+                                         gf_stripe_mt_iovec);
+                        tmp = iobref_new ();
+                        if (!vec || !tmp)
+                                goto err;
+                }
+        }
+
+        *vector = vec;
+        *count  = filled;
+        *iobref = tmp;
+
+        return 0;
+err:
+        if (vec)
+                GF_FREE (vec);
+        if (tmp)
+                iobref_unref (tmp);
+        return -1;
+}
+
+
+/* Pending row which the read falls in, if any. Called with ictx->lock
+ * held.
+ */
+static stripe_row_t *
+__stripe_row_pending (stripe_inode_ctx_t *ictx, stripe_fd_ctx_t *fctx,
+                      off_t offset, size_t size)
+{
+        stripe_row_t *row      = NULL;
+        off_t         row_size = 0;
+        int           i        = 0;
+
+        row_size = fctx->stripe_size * fctx->stripe_count;
+
+        for (i = 0; i < STRIPE_RA_ROWS; i++) {
+                row = ictx->rows[i];
+                if (row && row->pending &&
+                    (offset + size > row->offset) &&
+                    (offset < row->offset + row_size))
+                        return row;
+        }
+
+        return NULL;
+}
+
+
+/* Drops the rows a reader has moved away from and, for a sequential
+ * reader, starts on the row holding the end of this read and the one
+ * after it. Returns the new rows, to be sent once ictx->lock is
+ * released. Called with ictx->lock held.
+ */
+static int
+__stripe_row_advance (call_frame_t *frame, xlator_t *this,
+                      stripe_inode_ctx_t *ictx, stripe_fd_ctx_t *fctx,
+                      fd_t *fd, off_t offset, size_t size,
+                      stripe_row_t **start, stripe_row_t **drop)
+{
+        stripe_private_t *priv     = NULL;
+        stripe_row_t     *row      = NULL;
+        off_t             row_size = 0;
+        off_t             next     = 0;
+        int               seq      = 0;
+        int               nstart   = 0;
+        int               ndrop    = 0;
+        int               i        = 0;
+        int               j        = 0;
+
+        priv     = this->private;
+        row_size = fctx->stripe_size * fctx->stripe_count;
+
+        seq = (offset == fctx->ra_next);
+        fctx->ra_next = offset + size;
+
+        for (i = 0; i < STRIPE_RA_ROWS; i++) {
+                row = ictx->rows[i];
+                if (!row || row->pending)
+                        continue;
+                if ((row->offset + row_size <= offset) ||
+                    (row->offset >= offset + size +
+                     (row_size * STRIPE_RA_ROWS))) {
+                        ictx->rows[i] = NULL;
+                        drop[ndrop++] = row;
+                }
+        }
+
+        if (!seq || !priv->read_ahead)
+                goto out;
+
+        for (j = 0; j < STRIPE_RA_ROWS; j++) {
+                next = floor (offset + size, row_size) + (j * row_size);
+
+                for (i = 0; i < STRIPE_RA_ROWS; i++) {
+                        if (ictx->rows[i] && (ictx->rows[i]->offset == next))
+                                break;
+                }
+                if (i < STRIPE_RA_ROWS)
+                        continue;
+
+                for (i = 0; i < STRIPE_RA_ROWS; i++) {
+                        if (!ictx->rows[i])
+                                break;
+                }
+                if (i == STRIPE_RA_ROWS)
+                        break;
+
+                row = GF_CALLOC (1, sizeof (*row), gf_stripe_mt_stripe_row_t);
+                if (!row)
+                        break;
+
+                row->replies = GF_CALLOC (fctx->stripe_count,
+                                          sizeof (struct readv_replies),
+                                          gf_stripe_mt_readv_replies);
+                row->iobref = iobref_new ();
+                row->frame = copy_frame (frame);
+                if (!row->replies || !row->iobref || !row->frame) {
+                        if (row->replies)
+                                GF_FREE (row->replies);
+                        if (row->iobref)
+                                iobref_unref (row->iobref);
+                        if (row->frame)
+                                STACK_DESTROY (row->frame->root);
+                        GF_FREE (row);
+                        break;
+                }
+                row->frame->local = row;
+
+                INIT_LIST_HEAD (&row->waitq);
+                row->fctx    = fctx;
+                row->ictx    = ictx;
+                row->offset  = next;
+                row->pending = fctx->stripe_count;
+                row->fd      = fd_ref (fd);
+
+                ictx->rows[i] = row;
+                start[nstart++] = row;
+        }
+out:
+        return nstart;
+}
+
+
+/* Reads every block of a row, one per child, in parallel. */
+static void
+stripe_row_wind (xlator_t *this, stripe_row_t *row)
+{
+        stripe_fd_ctx_t *fctx   = NULL;
+        call_frame_t    *rframe = NULL;
+        int32_t          count  = 0;
+        int              i      = 0;
+
+        fctx   = row->fctx;
+        count  = fctx->stripe_count;
+        rframe = row->frame;
+
+        /* the row starts on the first child, so block i is on child i */
+        for (i = 0; i < count; i++) {
+                STACK_WIND_COOKIE (rframe, stripe_row_readv_cbk,
+                                   (void *)(long)i, fctx->xl_array[i],
+                                   fctx->xl_array[i]->fops->readv,
+                                   row->fd, fctx->stripe_size,
+                                   row->offset + (i * fctx->stripe_size));
+        }
+}
+
+
+/* Rows read ahead on inode, set up on the first read if create is set. */
+static stripe_inode_ctx_t *
+stripe_inode_ctx_get (xlator_t *this, inode_t *inode, int create)
+{
+        stripe_inode_ctx_t *ictx     = NULL;
+        uint64_t            tmp_ictx = 0;
+
+        LOCK (&inode->lock);
+        {
+                __inode_ctx_get (inode, this, &tmp_ictx);
+                ictx = (stripe_inode_ctx_t *)(long)tmp_ictx;
+                if (ictx || !create)
+                        goto unlock;
+
+                ictx = GF_CALLOC (1, sizeof (*ictx),
+                                  gf_stripe_mt_stripe_inode_ctx_t);
+                if (!ictx)
+                        goto unlock;
+
+                LOCK_INIT (&ictx->lock);
+                if (__inode_ctx_put (inode, this, (uint64_t)(long)ictx)) {
+                        LOCK_DESTROY (&ictx->lock);
+                        GF_FREE (ictx);
+                        ictx = NULL;
+                }
+        }
+unlock:
+        UNLOCK (&inode->lock);
+
+        return ictx;
+}
+
+
+/* Forgets the rows read ahead on inode, around a write to it through any
+ * fd. Called both before the write is sent and once it is back, which
+ * also drops rows read while it was in flight.
+ */
+void
+stripe_row_invalidate (xlator_t *this, inode_t *inode)
+{
+        stripe_inode_ctx_t *ictx = NULL;
+        stripe_row_t       *row  = NULL;
+        stripe_row_t       *drop[STRIPE_RA_ROWS] = {NULL, };
+        int                 i    = 0;
+
+        if (!inode)
+                return;
+
+        ictx = stripe_inode_ctx_get (this, inode, 0);
+        if (!ictx)
+                return;
+
+        LOCK (&ictx->lock);
+        {
+                for (i = 0; i < STRIPE_RA_ROWS; i++) {
+                        row = ictx->rows[i];
+                        if (!row)
+                                continue;
+                        ictx->rows[i] = NULL;
+                        /* its reads free it once they are back */
+                        if (row->pending)
+                                row->stale = 1;
+                        else
+                                drop[i] = row;
+                }
+        }
+        UNLOCK (&ictx->lock);
+
+        for (i = 0; i < STRIPE_RA_ROWS; i++) {
+                if (drop[i])
+                        stripe_row_free (drop[i]);
+        }
+}
+
+
 int32_t
 stripe_readv_fstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         int32_t op_ret, int32_t op_errno, struct iatt *buf)
@@ -3346,6 +4258,18 @@ stripe_readv (call_frame_t *frame, xlator_t *this, fd_t *fd,
         call_frame_t     *rframe = NULL;
         stripe_local_t   *rlocal = NULL;
         stripe_fd_ctx_t  *fctx = NULL;
+        stripe_inode_ctx_t *ictx = NULL;
+        stripe_row_t     *row = NULL;
+        stripe_row_t     *start[STRIPE_RA_ROWS] = {NULL, };
+        stripe_row_t     *drop[STRIPE_RA_ROWS] = {NULL, };
+        call_stub_t      *stub = NULL;
+        struct iovec     *vec = NULL;
+        struct iobref    *iobref = NULL;
+        struct iatt       stbuf = {0, };
+        int32_t           count = 0;
+        int               nstart = 0;
+        int               ret = -1;
+        int               i = 0;
 
         VALIDATE_OR_GOTO (frame, err);
         VALIDATE_OR_GOTO (this, err);
@@ -3365,6 +4289,61 @@ stripe_readv (call_frame_t *frame, xlator_t *this, fd_t *fd,
                         "Wrong stripe size for the file");
                 goto err;
         }
+
+        if (!size)
+                goto normal;
+
+        ictx = stripe_inode_ctx_get (this, fd->inode, 1);
+        if (!ictx)
+                goto normal;
+
+        LOCK (&ictx->lock);
+        {
+                ret = __stripe_row_gather (ictx, offset, size, &vec, &count,
+                                           &iobref, &stbuf);
+                if (ret == 0) {
+                        nstart = __stripe_row_advance (frame, this, ictx,
+                                                       fctx, fd, offset, size,
+                                                       start, drop);
+                        goto unlock;
+                }
+
+                row = __stripe_row_pending (ictx, fctx, offset, size);
+                if (row) {
+                        stub = fop_readv_stub (frame, stripe_readv, fd,
+                                               size, offset);
+                        if (stub) {
+                                list_add_tail (&stub->list, &row->waitq);
+                                goto unlock;
+                        }
+                }
+
+                nstart = __stripe_row_advance (frame, this, ictx, fctx, fd,
+                                               offset, size, start, drop);
+        }
+unlock:
+        UNLOCK (&ictx->lock);
+
+        for (i = 0; i < STRIPE_RA_ROWS; i++) {
+                if (drop[i])
+                        stripe_row_free (drop[i]);
+        }
+
+        for (i = 0; i < nstart; i++)
+                stripe_row_wind (this, start[i]);
+
+        if (ret == 0) {
+                STRIPE_STACK_UNWIND (readv, frame, size, 0, vec, count,
+                                     &stbuf, iobref);
+                iobref_unref (iobref);
+                GF_FREE (vec);
+                return 0;
+        }
+
+        if (stub)
+                return 0;
+
+normal:
         /* The file is stripe across the child nodes. Send the read request
          * to the child nodes appropriately after checking which region of
          * the file is in which child node. Always '0-<stripe_size>' part of
@@ -3468,6 +4447,8 @@ stripe_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         UNLOCK (&frame->lock);
 
         if ((callcnt == local->wind_count) && local->unwind) {
+                stripe_row_invalidate (this, local->inode);
+
                 STRIPE_STACK_UNWIND (writev, frame, local->op_ret,
                                      local->op_errno, &local->pre_buf,
                                      &local->post_buf);
@@ -3507,6 +4488,8 @@ stripe_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
         fctx = (stripe_fd_ctx_t *)(long)tmp_fctx;
         stripe_size = fctx->stripe_size;
 
+        stripe_row_invalidate (this, fd->inode);
+
         /* File has to be stripped across the child nodes */
         for (idx = 0; idx< count; idx ++) {
                 total_size += vector[idx].iov_len;
@@ -3521,6 +4504,7 @@ stripe_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
         }
         frame->local = local;
         local->stripe_size = stripe_size;
+        local->inode = inode_ref (fd->inode);
 
         while (1) {
                 /* Send striped chunk of the vector to child
@@ -3591,6 +4575,36 @@ err:
 	return 0;
 }
 
+int32_t
+stripe_forget (xlator_t *this, inode_t *inode)
+{
+        uint64_t            tmp_ictx = 0;
+        stripe_inode_ctx_t *ictx = NULL;
+        int                 i = 0;
+
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (inode, err);
+
+        inode_ctx_del (inode, this, &tmp_ictx);
+        if (!tmp_ictx)
+                goto err;
+
+        ictx = (stripe_inode_ctx_t *)(long)tmp_ictx;
+
+        /* a row still being read holds an fd, and so the inode, so none
+           is pending here */
+        for (i = 0; i < STRIPE_RA_ROWS; i++) {
+                if (ictx->rows[i])
+                        stripe_row_free (ictx->rows[i]);
+        }
+
+        LOCK_DESTROY (&ictx->lock);
+        GF_FREE (ictx);
+
+err:
+        return 0;
+}
+
 
 int32_t
 notify (xlator_t *this, int32_t event, void *data, ...)
@@ -3997,6 +5011,8 @@ reconfigure (xlator_t *this, dict_t *options)
 
         GF_OPTION_RECONF ("block-size", priv->block_size, options, size, out);
 
+        GF_OPTION_RECONF ("read-ahead", priv->read_ahead, options, bool, out);
+
         ret = 0;
 out:
 	return ret;
@@ -4090,6 +5106,8 @@ init (xlator_t *this)
 
         GF_OPTION_INIT ("use-xattr", priv->xattr_supported, bool, out);
 
+        GF_OPTION_INIT ("read-ahead", priv->read_ahead, bool, out);
+
         /* notify related */
         priv->nodes_down = priv->child_count;
         this->private = priv;
@@ -4531,6 +5549,9 @@ stripe_priv_dump (xlator_t *this)
         gf_proc_dump_build_key (key, key_prefix, "xatter_supported");
         gf_proc_dump_write (key, "%d", priv->xattr_supported);
 
+        gf_proc_dump_build_key (key, key_prefix, "read_ahead");
+        gf_proc_dump_write (key, "%d", priv->read_ahead);
+
         UNLOCK (&priv->lock);
 
 out:
@@ -4551,6 +5572,9 @@ struct xlator_fops fops = {
         .flush       = stripe_flush,
         .fsync       = stripe_fsync,
         .ftruncate   = stripe_ftruncate,
+        .fallocate   = stripe_fallocate,
+        .discard     = stripe_discard,
+        .zerofill    = stripe_zerofill,
         .fstat       = stripe_fstat,
         .mkdir       = stripe_mkdir,
         .rmdir       = stripe_rmdir,
@@ -4568,6 +5592,7 @@ struct xlator_fops fops = {
 
 struct xlator_cbks cbks = {
         .release = stripe_release,
+        .forget  = stripe_forget,
 };
 
 struct xlator_dumpops dumpops = {
@@ -4585,5 +5610,16 @@ struct volume_options options[] = {
           .type = GF_OPTION_TYPE_BOOL,
           .default_value = "true"
         },
+        { .key  = {"read-ahead"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Once a file is read sequentially, read the next "
+                         "stripe row (a block from each subvolume) ahead "
+                         "and answer reads falling in it from memory. Up to "
+                         "two rows are kept per file, and dropped on any "
+                         "write to it through this client. Writes from "
+                         "other clients are not seen, so only turn this on "
+                         "for files which are not shared while written."
+        },
         { .key  = {NULL} },
 };
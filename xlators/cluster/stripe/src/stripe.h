@@ -34,11 +34,19 @@
 #include "compat-errno.h"
 #include "stripe-mem-types.h"
 #include "libxlator.h"
+#include "call-stub.h"
 #include <fnmatch.h>
 #include <signal.h>
 
 #define STRIPE_PATHINFO_HEADER "STRIPE:"
 
+/* rows kept per file for sequential readers: the one being read and the
+   one after it */
+#define STRIPE_RA_ROWS 2
+
+/* blocks of one child a fallocate or zerofill keeps in flight */
+#define STRIPE_SPACE_WINDOW 16
+
 
 #define STRIPE_STACK_UNWIND(fop, frame, params ...) do {           \
                 stripe_local_t *__local = NULL;                    \
@@ -93,6 +101,7 @@ struct stripe_private {
         int8_t                  child_count;
         int8_t                 *state; /* Current state of child node */
         gf_boolean_t            xattr_supported;  /* default yes */
+        gf_boolean_t            read_ahead;       /* of stripe rows */
         char                    vol_uuid[UUID_SIZE + 1];
 };
 
@@ -108,14 +117,65 @@ struct readv_replies {
         struct iatt   stbuf;    /* 'stbuf' is also a part of reply */
 };
 
+struct _stripe_fd_ctx;
+struct _stripe_inode_ctx;
+
+/**
+ * A stripe row (one block on each child) read ahead for a sequential
+ * reader. Reads falling in it are answered from here, reads waiting for
+ * it to arrive are queued on waitq.
+ */
+typedef struct stripe_row {
+        off_t                  offset;    /* of the row's first block */
+        size_t                 size;      /* data available at offset */
+        int32_t                pending;   /* block reads not back yet */
+        int8_t                 valid;
+        int8_t                 stale;     /* written to while pending */
+        struct iatt            stbuf;
+        struct iovec          *vector;
+        int32_t                count;
+        struct iobref         *iobref;
+        struct readv_replies  *replies;   /* one per block while pending */
+        struct list_head       waitq;
+        call_frame_t          *frame;     /* reading the row */
+        fd_t                  *fd;        /* held while pending */
+        struct _stripe_fd_ctx *fctx;      /* of fd, while pending */
+        struct _stripe_inode_ctx *ictx;
+} stripe_row_t;
+
+/**
+ * Rows are kept per inode, so that a write through any fd of the file
+ * drops them.
+ */
+typedef struct _stripe_inode_ctx {
+        gf_lock_t     lock;
+        stripe_row_t *rows[STRIPE_RA_ROWS];
+} stripe_inode_ctx_t;
+
 typedef struct _stripe_fd_ctx {
-        off_t      stripe_size;
-        int        stripe_count;
-        int        static_array;
-        xlator_t **xl_array;
+        off_t         stripe_size;
+        int           stripe_count;
+        int           static_array;
+        xlator_t    **xl_array;
+
+        /* row read-ahead, under the inode ctx lock */
+        off_t         ra_next;    /* where a sequential reader goes next */
 } stripe_fd_ctx_t;
 
 
+/**
+ * Progress of one child through a fallocate or zerofill, which is sent to
+ * each child as one fop per stripe block, up to STRIPE_SPACE_WINDOW of
+ * them at a time.
+ */
+struct stripe_space_child {
+        off_t         next;     /* start of the next block to send */
+        int           inflight;
+        int           started;
+        struct iatt   prebuf;
+        struct iatt   postbuf;
+};
+
 /**
  * Local structure to be passed with all the frames in case of STACK_WIND
  */
@@ -194,10 +254,19 @@ struct stripe_local {
         gf_dirent_t          entries;
         dict_t              *xattr;
         uuid_t               ia_gfid;
+
+        /* fallocate and zerofill */
+        glusterfs_fop_t            space_fop;
+        int32_t                    keep_size;
+        off_t                      space_end;
+        struct stripe_space_child *space;
 };
 
 typedef struct stripe_local   stripe_local_t;
 typedef struct stripe_private stripe_private_t;
 
+void stripe_row_free (stripe_row_t *row);
+void stripe_row_invalidate (xlator_t *this, inode_t *inode);
+
 
 #endif /* _STRIPE_H_ */
@@ -126,6 +126,7 @@ quota_alloc_inode_ctx ()
         ctx->updation_status = _gf_false;
         LOCK_INIT (&ctx->lock);
         INIT_LIST_HEAD (&ctx->contribution_head);
+        INIT_LIST_HEAD (&ctx->journal_waiters);
 out:
         return ctx;
 }
@@ -374,6 +375,10 @@ quota_local_unref (xlator_t *this, quota_local_t *local)
         if (local->fd != NULL)
                 fd_unref (local->fd);
 
+        mq_journal_release (this, local);
+
+        mq_batch_put (this, local);
+
         loc_wipe (&local->loc);
 
         loc_wipe (&local->parent_loc);
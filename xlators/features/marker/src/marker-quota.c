@@ -304,6 +304,15 @@ mark_inode_undirty (call_frame_t *frame, void *cookie, xlator_t *this,
         UNLOCK (&local->ctx->lock);
 
 wind:
+        LOCK (&local->ctx->lock);
+        {
+                /* repaired, a mark the batched engine left behind is
+                   cleared with it */
+                if (local->ctx->journal != MQ_JOURNAL_MARKING)
+                        local->ctx->journal = MQ_JOURNAL_NONE;
+        }
+        UNLOCK (&local->ctx->lock);
+
         newdict = dict_new ();
         if (!newdict)
                 goto err;
@@ -735,8 +744,9 @@ check_if_still_dirty (call_frame_t *frame,
         if (ret)
                 goto err;
 
-        //the inode is not dirty anymore
-        if (dirty == 0) {
+        //the inode is not dirty anymore, or the mark is held by the
+        //batched engine
+        if (dirty == 0 || mq_journal_busy (local->ctx)) {
                 release_lock_on_dirty_inode (frame, NULL, this, 0, 0);
 
                 return 0;
@@ -1288,8 +1298,9 @@ quota_inodelk_cbk (call_frame_t *frame, void *cookie,
         gf_log (this->name, GF_LOG_DEBUG,
                 "inodelk released on %s", local->parent_loc.path);
 
+        /* a batched txn left the delta in the parent's pending_delta */
         if ((strcmp (local->parent_loc.path, "/") == 0)
-            || (local->delta == 0)) {
+            || (local->delta == 0) || local->batched) {
                 xattr_updation_done (frame, NULL, this, 0, 0, NULL);
         } else {
                 ret = get_parent_inode_local (this, local);
@@ -1371,6 +1382,12 @@ err:
 }
 
 
+static void
+mq_leaf_settle (call_frame_t *frame, xlator_t *this);
+
+static void
+mq_journal_break (xlator_t *this, inode_t *inode);
+
 int32_t
 quota_mark_undirty (call_frame_t *frame,
                     void *cookie,
@@ -1422,6 +1439,11 @@ quota_mark_undirty (call_frame_t *frame,
                 UNLOCK (&ctx->lock);
         }
 
+        if (local->batched) {
+                mq_leaf_settle (frame, this);
+                return 0;
+        }
+
         newdict = dict_new ();
         if (!newdict) {
                 op_errno = ENOMEM;
@@ -1445,6 +1467,11 @@ err:
         if (op_ret == -1 || ret == -1) {
                 local->err = op_errno;
 
+                /* the contribution went up but the size did not, leave the
+                   mark to the dirty inode scan */
+                if (local->batched && op_ret == -1)
+                        mq_journal_break (this, local->parent_loc.inode);
+
                 quota_release_parent_lock (frame, NULL, this, 0, 0);
         }
 
@@ -1788,6 +1815,13 @@ quota_markdirty (call_frame_t *frame, void *cookie,
 
         priv = this->private;
 
+        /* queued under the mark of the parent, which is on disk */
+        if ((local->journal != NULL)
+            && (local->journal == local->parent_loc.inode)) {
+                quota_fetch_child_size_and_contri (frame, NULL, this, 0, 0);
+                return 0;
+        }
+
         dict = dict_new ();
         if (!dict) {
                 ret = -1;
@@ -1859,250 +1893,1522 @@ fr_destroy:
 }
 
 
-int
-start_quota_txn (xlator_t *this, loc_t *loc,
-                 quota_inode_ctx_t *ctx,
-                 inode_contribution_t *contri)
-{
-        int32_t        ret      = -1;
-        call_frame_t  *frame    = NULL;
-        quota_local_t *local    = NULL;
+/* Batched propagation (option quota-flush-interval).
 
-        frame = create_frame (this, this->ctx->pool);
-        if (frame == NULL)
-                goto err;
+   An update of a file queues it, and a flush runs one txn per queued file,
+   which moves the difference between its size and contribution into the
+   size of the parent as the inline txn does, but stops there: the amount
+   is added to the parent's pending_delta and the parent is queued. A
+   queued directory is flushed with one xattrop on its contribution and
+   one on the size of its parent, whose pending_delta grows in turn, so a
+   directory sends its children's changes up once per flush however many
+   there were.
 
-        mq_assign_lk_owner (this, frame);
+   The dirty xattr is the journal. A directory is marked dirty on disk,
+   under its inodelk, before a child is queued under it and before its
+   size is changed by a flush, and is marked clean again, under the same
+   lock, once it holds no pending_delta and no queued child. A crash thus
+   leaves dirty the directories whose size may not match what was sent up
+   yet, and the dirty inode scan repairs them on their next lookup. */
 
-        local = quota_local_new ();
-        if (local == NULL)
-                goto fr_destroy;
+static void
+mq_pending_child_done (xlator_t *this, inode_t *parent)
+{
+        quota_inode_ctx_t *pctx = NULL;
 
-        frame->local = local;
+        if ((parent == NULL) || (quota_inode_ctx_get (parent, this, &pctx) < 0))
+                return;
 
-        ret = mq_loc_copy (&local->loc, loc);
-        if (ret < 0)
-                goto fr_destroy;
+        LOCK (&pctx->lock);
+        {
+                if (pctx->pending_children > 0)
+                        pctx->pending_children--;
+        }
+        UNLOCK (&pctx->lock);
+}
 
-        ret = quota_inode_loc_fill (NULL, local->loc.parent,
-                                    &local->parent_loc);
-        if (ret < 0)
-                goto fr_destroy;
 
-        local->ctx = ctx;
-        local->contri = contri;
+void
+mq_journal_release (xlator_t *this, quota_local_t *local)
+{
+        inode_t *journal = NULL;
 
-        ret = get_lock_on_parent (frame, this);
-        if (ret == -1)
-                goto err;
+        LOCK (&local->lock);
+        {
+                journal = local->journal;
+                local->journal = NULL;
+        }
+        UNLOCK (&local->lock);
 
-        return 0;
+        if (journal) {
+                mq_pending_child_done (this, journal);
+                inode_unref (journal);
+        }
+}
 
-fr_destroy:
-        QUOTA_STACK_DESTROY (frame, this);
-err:
-        mq_set_ctx_updation_status (ctx, _gf_false);
 
-        return -1;
+static void
+mq_batch_get (xlator_t *this, quota_local_t *local)
+{
+        marker_conf_t *priv = NULL;
+
+        priv = this->private;
+
+        local->batched = 1;
+        QUOTA_SAFE_INCREMENT (&priv->lock, priv->quota_batch_inflight);
 }
 
 
-int
-initiate_quota_txn (xlator_t *this, loc_t *loc)
+void
+mq_batch_put (xlator_t *this, quota_local_t *local)
 {
-        int32_t               ret          = -1;
-        gf_boolean_t          status       = _gf_false;
-        quota_inode_ctx_t    *ctx          = NULL;
-        inode_contribution_t *contribution = NULL;
+        marker_conf_t *priv = NULL;
 
-        GF_VALIDATE_OR_GOTO ("marker", this, out);
-        GF_VALIDATE_OR_GOTO ("marker", loc, out);
-        GF_VALIDATE_OR_GOTO ("marker", loc->inode, out);
+        if (!local->batched)
+                return;
 
-        ret = quota_inode_ctx_get (loc->inode, this, &ctx);
-        if (ret == -1) {
-                gf_log (this->name, GF_LOG_WARNING,
-                        "inode ctx get failed, aborting quota txn");
-                ret = -1;
-                goto out;
-        }
+        priv = this->private;
+        local->batched = 0;
 
-        contribution = get_contribution_node (loc->parent, ctx);
-        if (contribution == NULL)
-                goto out;
+        LOCK (&priv->lock);
+        {
+                priv->quota_batch_inflight--;
+        }
+        UNLOCK (&priv->lock);
+}
 
-        /* To improve performance, donot start another transaction
-         * if one is already in progress for same inode
-         */
-        status = _gf_true;
 
-        ret = mq_test_and_set_ctx_updation_status (ctx, &status);
-        if (ret < 0)
-                goto out;
+/* once updates go the batched way they keep doing so until the engine is
+   idle, a serial txn would send up again what pending_delta holds */
+static gf_boolean_t
+mq_batching (marker_conf_t *priv)
+{
+        gf_boolean_t batching = _gf_false;
 
-        if (status == _gf_false) {
-                start_quota_txn (this, loc, ctx, contribution);
+        LOCK (&priv->lock);
+        {
+                batching = (priv->quota_flush_interval
+                            || priv->quota_pending_count
+                            || priv->quota_batch_inflight);
         }
+        UNLOCK (&priv->lock);
 
-        ret = 0;
-out:
-        return ret;
+        return batching;
 }
 
 
-/* int32_t */
-/* validate_inode_size_contribution (xlator_t *this, loc_t *loc, int64_t size, */
-/*                                int64_t contribution) */
-/* { */
-/*   if (size != contribution) { */
-/*     initiate_quota_txn (this, loc); */
-/*   } */
+gf_boolean_t
+mq_journal_busy (quota_inode_ctx_t *ctx)
+{
+        gf_boolean_t busy = _gf_false;
 
-/*   return 0; */
-/* } */
+        LOCK (&ctx->lock);
+        {
+                busy = ((ctx->journal == MQ_JOURNAL_MARKING)
+                        || ctx->pending_children || ctx->pending_delta);
+        }
+        UNLOCK (&ctx->lock);
 
+        return busy;
+}
 
-int32_t
-inspect_directory_xattr (xlator_t *this,
-                         loc_t *loc,
-                         dict_t *dict,
-                         struct iatt buf)
+
+static void
+mq_journal_break (xlator_t *this, inode_t *inode)
 {
-        int32_t               ret                 = 0;
-        int8_t                dirty               = -1;
-        int64_t              *size                = NULL, size_int = 0;
-        int64_t              *contri              = NULL, contri_int = 0;
-        char                  contri_key [512]    = {0, };
-        marker_conf_t        *priv                = NULL;
-        gf_boolean_t          not_root            = _gf_false;
-        quota_inode_ctx_t    *ctx                 = NULL;
-        inode_contribution_t *contribution        = NULL;
+        quota_inode_ctx_t *ctx = NULL;
 
-        priv = this->private;
+        if ((inode == NULL) || (quota_inode_ctx_get (inode, this, &ctx) < 0))
+                return;
 
-        ret = quota_inode_ctx_get (loc->inode, this, &ctx);
-        if (ret < 0) {
-                ctx = quota_inode_ctx_new (loc->inode, this);
-                if (ctx == NULL) {
-                        gf_log (this->name, GF_LOG_WARNING,
-                                "quota_inode_ctx_new failed");
-                        ret = -1;
-                        goto out;
-                }
+        LOCK (&ctx->lock);
+        {
+                ctx->journal = MQ_JOURNAL_BROKEN;
         }
+        UNLOCK (&ctx->lock);
+}
 
-        ret = dict_get_bin (dict, QUOTA_SIZE_KEY, (void **) &size);
-        if (ret < 0)
-                goto out;
-
-        ret = dict_get_int8 (dict, QUOTA_DIRTY_KEY, &dirty);
-        if (ret < 0)
-                goto out;
 
-        if (strcmp (loc->path, "/") != 0) {
-                not_root = _gf_true;
+/* under the inodelk of the directory: whether the engine lets go of its
+   mark now */
+static gf_boolean_t
+__mq_journal_settle (quota_inode_ctx_t *ctx)
+{
+        if ((ctx->journal != MQ_JOURNAL_HELD) || ctx->pending_delta
+            || ctx->pending_children)
+                return _gf_false;
 
-                contribution = add_new_contribution_node (this, ctx, loc);
-                if (contribution == NULL) {
-                        gf_log (this->name, GF_LOG_DEBUG,
-                                "cannot add a new contributio node");
-                        goto out;
-                }
+        ctx->journal = MQ_JOURNAL_NONE;
 
-                GET_CONTRI_KEY (contri_key, contribution->gfid, ret);
-                if (ret < 0)
-                        goto out;
+        return _gf_true;
+}
 
-                ret = dict_get_bin (dict, contri_key, (void **) &contri);
-                if (ret < 0)
-                        goto out;
 
-                LOCK (&contribution->lock);
-                {
-                        contribution->contribution = ntoh64 (*contri);
-                        contri_int = contribution->contribution;
-                }
-                UNLOCK (&contribution->lock);
-        }
+static gf_boolean_t
+mq_journal_on_disk (quota_inode_ctx_t *ctx)
+{
+        gf_boolean_t marked = _gf_false;
 
         LOCK (&ctx->lock);
         {
-                ctx->size = ntoh64 (*size);
-                ctx->dirty = dirty;
-                size_int = ctx->size;
+                marked = ((ctx->journal == MQ_JOURNAL_HELD)
+                          || (ctx->journal == MQ_JOURNAL_BROKEN));
         }
         UNLOCK (&ctx->lock);
 
-        gf_log (this->name, GF_LOG_DEBUG, "size=%"PRId64
-                " contri=%"PRId64, size_int, contri_int);
+        return marked;
+}
 
-        if (dirty) {
-                ret = update_dirty_inode (this, loc, ctx, contribution);
-        }
 
-        if ((!dirty || ret == 0) && (not_root == _gf_true) &&
-            (size_int != contri_int)) {
-                initiate_quota_txn (this, loc);
-        }
+static void
+mq_inodelk (call_frame_t *frame, xlator_t *this, loc_t *loc, short type,
+            fop_inodelk_cbk_t done)
+{
+        struct gf_flock lock = {0, };
 
-        ret = 0;
-out:
-        if (ret)
-                quota_set_inode_xattr (this, loc);
+        lock.l_type   = type;
+        lock.l_whence = SEEK_SET;
+        lock.l_start  = 0;
+        lock.l_len    = 0;
+        lock.l_pid    = 0;
 
-        return 0;
+        STACK_WIND (frame, done,
+                    FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->inodelk,
+                    this->name, loc, F_SETLKW, &lock);
 }
 
-int32_t
-inspect_file_xattr (xlator_t *this,
-                    loc_t *loc,
-                    dict_t *dict,
-                    struct iatt buf)
+
+static void
+mq_setdirty (call_frame_t *frame, xlator_t *this, loc_t *loc, int8_t dirty,
+             fop_setxattr_cbk_t done)
 {
-        int32_t               ret              = -1;
-        uint64_t              contri_int       = 0, size = 0;
-        int64_t              *contri_ptr       = NULL;
-        char                  contri_key [512] = {0, };
-        marker_conf_t        *priv             = NULL;
-        quota_inode_ctx_t    *ctx              = NULL;
-        inode_contribution_t *contribution     = NULL;
+        int32_t  ret  = -1;
+        dict_t  *dict = NULL;
 
-        priv = this->private;
+        dict = dict_new ();
+        if (dict == NULL)
+                goto err;
 
-        ret = quota_inode_ctx_get (loc->inode, this, &ctx);
-        if (ret < 0) {
-                ctx = quota_inode_ctx_new (loc->inode, this);
-                if (ctx == NULL) {
-                        gf_log (this->name, GF_LOG_WARNING,
-                                "quota_inode_ctx_new failed");
-                        ret = -1;
-                        goto out;
-                }
-        }
+        ret = dict_set_int8 (dict, QUOTA_DIRTY_KEY, dirty);
+        if (ret < 0)
+                goto err;
 
-        contribution = add_new_contribution_node (this, ctx, loc);
-        if (contribution == NULL)
-                goto out;
+        STACK_WIND (frame, done,
+                    FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->setxattr,
+                    loc, dict, 0);
 
-        LOCK (&ctx->lock);
-        {
-                ctx->size = 512 * buf.ia_blocks;
-                size = ctx->size;
-        }
-        UNLOCK (&ctx->lock);
+        dict_unref (dict);
+        return;
+err:
+        if (dict)
+                dict_unref (dict);
 
-        list_for_each_entry (contribution, &ctx->contribution_head,
-                             contri_list) {
-                GET_CONTRI_KEY (contri_key, contribution->gfid, ret);
-                if (ret < 0)
-                        continue;
+        done (frame, NULL, this, -1, ENOMEM);
+}
 
-                ret = dict_get_bin (dict, contri_key, (void **) &contri_int);
-                if (ret == 0) {
-                        contri_ptr = (int64_t *)(unsigned long)contri_int;
 
-                        LOCK (&contribution->lock);
-                        {
+static void
+mq_xattrop_add (call_frame_t *frame, xlator_t *this, loc_t *loc, char *key,
+                int64_t delta, fop_xattrop_cbk_t done)
+{
+        int32_t  ret   = -1;
+        int64_t *value = NULL;
+        dict_t  *dict  = NULL;
+
+        dict = dict_new ();
+        if (dict == NULL)
+                goto err;
+
+        QUOTA_ALLOC_OR_GOTO (value, int64_t, ret, err);
+
+        *value = hton64 (delta);
+
+        ret = dict_set_bin (dict, key, value, 8);
+        if (ret < 0) {
+                GF_FREE (value);
+                goto err;
+        }
+
+        STACK_WIND (frame, done,
+                    FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->xattrop,
+                    loc, GF_XATTROP_ADD_ARRAY64, dict);
+
+        dict_unref (dict);
+        return;
+err:
+        if (dict)
+                dict_unref (dict);
+
+        done (frame, NULL, this, -1, ENOMEM, NULL);
+}
+
+
+/* drops the inodelks taken by a frame of the engine, the one on
+   parent_loc (locked == 2) first, and ends it */
+int32_t
+mq_unlock_all (call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno)
+{
+        quota_local_t *local = NULL;
+
+        local = frame->local;
+
+        switch (local->locked) {
+        case 2:
+                local->locked = 1;
+                mq_inodelk (frame, this, &local->parent_loc, F_UNLCK,
+                            mq_unlock_all);
+                break;
+        case 1:
+                local->locked = 0;
+                mq_inodelk (frame, this, &local->loc, F_UNLCK,
+                            mq_unlock_all);
+                break;
+        default:
+                QUOTA_STACK_DESTROY (frame, this);
+                break;
+        }
+
+        return 0;
+}
+
+
+static void
+quota_flush_pending (void *data);
+
+static void
+__quota_flush_arm (xlator_t *this, marker_conf_t *priv)
+{
+        struct timeval delta = {0, };
+
+        if (priv->quota_flush_timer || list_empty (&priv->quota_pending))
+                return;
+
+        delta.tv_sec  = priv->quota_flush_interval / 1000;
+        delta.tv_usec = (priv->quota_flush_interval % 1000) * 1000;
+
+        priv->quota_flush_timer = gf_timer_call_after (this->ctx, delta,
+                                                       quota_flush_pending,
+                                                       this);
+        if (priv->quota_flush_timer == NULL)
+                gf_log (this->name, GF_LOG_WARNING,
+                        "failed to schedule the quota flush, %u updates "
+                        "wait for the next one", priv->quota_pending_count);
+}
+
+
+static void
+mq_pending_add (xlator_t *this, quota_pending_t *pending)
+{
+        marker_conf_t *priv = NULL;
+
+        priv = this->private;
+
+        LOCK (&priv->lock);
+        {
+                list_add_tail (&pending->list, &priv->quota_pending);
+                priv->quota_pending_count++;
+                __quota_flush_arm (this, priv);
+        }
+        UNLOCK (&priv->lock);
+}
+
+
+static void
+mq_pending_free (xlator_t *this, quota_pending_t *pending)
+{
+        if (pending->parent) {
+                mq_pending_child_done (this, pending->parent);
+                inode_unref (pending->parent);
+        }
+
+        if (pending->inode)
+                inode_unref (pending->inode);
+
+        GF_FREE (pending);
+}
+
+
+/* queues directory @inode, whose pending flag its caller has just set */
+static void
+mq_queue_dir (xlator_t *this, inode_t *inode, quota_inode_ctx_t *ctx)
+{
+        int32_t          ret     = -1;
+        quota_pending_t *pending = NULL;
+
+        QUOTA_ALLOC (pending, quota_pending_t, ret);
+        if (ret < 0)
+                goto err;
+
+        INIT_LIST_HEAD (&pending->list);
+        pending->inode = inode_ref (inode);
+
+        mq_pending_add (this, pending);
+
+        return;
+err:
+        /* pending_delta waits for the next addition to queue it */
+        LOCK (&ctx->lock);
+        {
+                ctx->pending = _gf_false;
+        }
+        UNLOCK (&ctx->lock);
+}
+
+
+static void
+mq_pending_add_delta (xlator_t *this, inode_t *inode, quota_inode_ctx_t *ctx,
+                      int64_t delta)
+{
+        gf_boolean_t requeue = _gf_false;
+
+        LOCK (&ctx->lock);
+        {
+                ctx->pending_delta += delta;
+                requeue = !ctx->pending;
+                ctx->pending = _gf_true;
+        }
+        UNLOCK (&ctx->lock);
+
+        if (requeue)
+                mq_queue_dir (this, inode, ctx);
+}
+
+
+/* the mark of the directory of @ctx is on disk, or could not be set:
+   queue the children that waited for it */
+static void
+mq_journal_wake (xlator_t *this, quota_inode_ctx_t *ctx, gf_boolean_t marked)
+{
+        quota_pending_t  *pending = NULL;
+        quota_pending_t  *tmp     = NULL;
+        struct list_head  waiters;
+
+        INIT_LIST_HEAD (&waiters);
+
+        LOCK (&ctx->lock);
+        {
+                list_splice_init (&ctx->journal_waiters, &waiters);
+
+                if (ctx->journal == MQ_JOURNAL_MARKING)
+                        ctx->journal = (marked) ? MQ_JOURNAL_HELD
+                                : MQ_JOURNAL_NONE;
+
+                if (marked) {
+                        list_for_each_entry (pending, &waiters, list)
+                                ctx->pending_children++;
+                }
+        }
+        UNLOCK (&ctx->lock);
+
+        list_for_each_entry_safe (pending, tmp, &waiters, list) {
+                list_del_init (&pending->list);
+
+                if (!marked) {
+                        inode_unref (pending->parent);
+                        pending->parent = NULL;
+                }
+
+                mq_pending_add (this, pending);
+        }
+}
+
+
+int32_t
+mq_journal_marked (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno)
+{
+        quota_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (op_ret == -1)
+                gf_log (this->name, ((op_errno == ENOENT) ? GF_LOG_DEBUG
+                                     : GF_LOG_WARNING),
+                        "failed to mark %s dirty, the updates queued under "
+                        "it are not journaled (%s)", local->loc.path,
+                        strerror (op_errno));
+
+        mq_journal_wake (this, local->ctx, (op_ret == 0));
+
+        mq_unlock_all (frame, NULL, this, 0, 0);
+
+        return 0;
+}
+
+
+int32_t
+mq_journal_locked (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno)
+{
+        quota_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (op_ret == -1)
+                return mq_journal_marked (frame, NULL, this, -1, op_errno);
+
+        local->locked = 1;
+
+        mq_setdirty (frame, this, &local->loc, 1, mq_journal_marked);
+
+        return 0;
+}
+
+
+static void
+mq_journal_mark (xlator_t *this, inode_t *inode, quota_inode_ctx_t *ctx)
+{
+        int32_t        ret   = -1;
+        call_frame_t  *frame = NULL;
+        quota_local_t *local = NULL;
+
+        frame = create_frame (this, this->ctx->pool);
+        if (frame == NULL)
+                goto err;
+
+        mq_assign_lk_owner (this, frame);
+
+        local = quota_local_new ();
+        if (local == NULL)
+                goto err;
+
+        frame->local = local;
+        mq_batch_get (this, local);
+
+        local->ctx = ctx;
+
+        ret = quota_inode_loc_fill (NULL, inode, &local->loc);
+        if (ret < 0)
+                goto err;
+
+        mq_inodelk (frame, this, &local->loc, F_WRLCK, mq_journal_locked);
+
+        return;
+err:
+        gf_log (this->name, GF_LOG_WARNING,
+                "could not mark the parent of queued updates dirty");
+
+        mq_journal_wake (this, ctx, _gf_false);
+
+        if (frame)
+                QUOTA_STACK_DESTROY (frame, this);
+}
+
+
+/* end of a batched txn, under the inodelk of the parent */
+static void
+mq_leaf_settle (call_frame_t *frame, xlator_t *this)
+{
+        int32_t            ret     = -1;
+        quota_local_t     *local   = NULL;
+        quota_inode_ctx_t *pctx    = NULL;
+        inode_t           *journal = NULL;
+        gf_boolean_t       root    = _gf_false;
+        gf_boolean_t       clean   = _gf_false;
+
+        local = frame->local;
+
+        ret = quota_inode_ctx_get (local->parent_loc.inode, this, &pctx);
+        if (ret < 0)
+                goto unlock;
+
+        root = (strcmp (local->parent_loc.path, "/") == 0);
+
+        LOCK (&local->lock);
+        {
+                if (local->journal == local->parent_loc.inode) {
+                        journal = local->journal;
+                        local->journal = NULL;
+                }
+        }
+        UNLOCK (&local->lock);
+
+        if (!root && local->delta)
+                mq_pending_add_delta (this, local->parent_loc.inode, pctx,
+                                      local->delta);
+
+        LOCK (&pctx->lock);
+        {
+                if (journal && (pctx->pending_children > 0))
+                        pctx->pending_children--;
+
+                /* not queued under it, the txn marked it itself */
+                if (pctx->journal == MQ_JOURNAL_NONE)
+                        pctx->journal = MQ_JOURNAL_HELD;
+
+                clean = __mq_journal_settle (pctx);
+        }
+        UNLOCK (&pctx->lock);
+
+        if (journal)
+                inode_unref (journal);
+
+        if (clean) {
+                mq_setdirty (frame, this, &local->parent_loc, 0,
+                             quota_release_parent_lock);
+                return;
+        }
+unlock:
+        quota_release_parent_lock (frame, NULL, this, 0, 0);
+}
+
+
+/* A flush of directory X takes the inodelk of X, then of its parent P:
+   pending_delta of X goes into its contribution to P and into the size
+   of P, and from there into the pending_delta of P, unless P is the root.
+   Locks are always taken child first. */
+
+static void
+mq_flush_dir_restore (xlator_t *this, quota_local_t *local, int32_t op_errno)
+{
+        quota_inode_ctx_t *ctx = NULL;
+
+        ctx = local->ctx;
+
+        LOCK (&ctx->lock);
+        {
+                ctx->pending_delta += local->delta;
+        }
+        UNLOCK (&ctx->lock);
+
+        local->delta = 0;
+
+        /* a directory gone meanwhile is not retried */
+        if (op_errno != ENOENT)
+                mq_pending_add_delta (this, local->loc.inode, ctx, 0);
+}
+
+
+int32_t
+mq_flush_dir_settle (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno)
+{
+        quota_local_t *local = NULL;
+        gf_boolean_t   clean = _gf_false;
+
+        local = frame->local;
+
+        LOCK (&local->ctx->lock);
+        {
+                clean = __mq_journal_settle (local->ctx);
+        }
+        UNLOCK (&local->ctx->lock);
+
+        if (clean) {
+                mq_setdirty (frame, this, &local->loc, 0, mq_unlock_all);
+                return 0;
+        }
+
+        mq_unlock_all (frame, NULL, this, 0, 0);
+
+        return 0;
+}
+
+
+int32_t
+mq_flush_dir_size_done (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, dict_t *dict)
+{
+        int64_t           *size  = NULL;
+        quota_local_t     *local = NULL;
+        quota_inode_ctx_t *pctx  = NULL;
+        gf_boolean_t       clean = _gf_false;
+
+        local = frame->local;
+
+        if (op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "failed to add %"PRId64
+                        " to the size of %s (%s)", local->delta,
+                        local->parent_loc.path, strerror (op_errno));
+
+                /* the contribution went up but the size did not, leave
+                   the mark to the dirty inode scan */
+                mq_journal_break (this, local->parent_loc.inode);
+                goto settle;
+        }
+
+        if (quota_inode_ctx_get (local->parent_loc.inode, this, &pctx) < 0)
+                goto settle;
+
+        if (dict && (dict_get_bin (dict, QUOTA_SIZE_KEY,
+                                   (void **) &size) < 0))
+                size = NULL;
+
+        if (strcmp (local->parent_loc.path, "/") != 0)
+                mq_pending_add_delta (this, local->parent_loc.inode, pctx,
+                                      local->delta);
+
+        LOCK (&pctx->lock);
+        {
+                if (size)
+                        pctx->size = ntoh64 (*size);
+
+                clean = __mq_journal_settle (pctx);
+        }
+        UNLOCK (&pctx->lock);
+
+        if (clean) {
+                mq_setdirty (frame, this, &local->parent_loc, 0,
+                             mq_flush_dir_settle);
+                return 0;
+        }
+settle:
+        mq_flush_dir_settle (frame, NULL, this, 0, 0);
+
+        return 0;
+}
+
+
+int32_t
+mq_flush_dir_contri_done (call_frame_t *frame, void *cookie, xlator_t *this,
+                          int32_t op_ret, int32_t op_errno, dict_t *dict)
+{
+        quota_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (op_ret == -1) {
+                gf_log (this->name, ((op_errno == ENOENT) ? GF_LOG_DEBUG
+                                     : GF_LOG_WARNING),
+                        "failed to add %"PRId64" to the contribution of %s "
+                        "(%s)", local->delta, local->loc.path,
+                        strerror (op_errno));
+
+                mq_flush_dir_restore (this, local, op_errno);
+                return mq_flush_dir_settle (frame, NULL, this, 0, 0);
+        }
+
+        LOCK (&local->contri->lock);
+        {
+                local->contri->contribution += local->delta;
+        }
+        UNLOCK (&local->contri->lock);
+
+        mq_xattrop_add (frame, this, &local->parent_loc, QUOTA_SIZE_KEY,
+                        local->delta, mq_flush_dir_size_done);
+
+        return 0;
+}
+
+
+int32_t
+mq_flush_dir_parent_dirty (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int32_t op_ret, int32_t op_errno)
+{
+        int32_t            ret              = -1;
+        char               contri_key [512] = {0, };
+        quota_local_t     *local            = NULL;
+        quota_inode_ctx_t *pctx             = NULL;
+
+        local = frame->local;
+
+        if (op_ret == -1) {
+                gf_log (this->name, ((op_errno == ENOENT) ? GF_LOG_DEBUG
+                                     : GF_LOG_WARNING),
+                        "failed to mark %s dirty (%s)",
+                        local->parent_loc.path, strerror (op_errno));
+                goto err;
+        }
+
+        ret = quota_inode_ctx_get (local->parent_loc.inode, this, &pctx);
+        if (ret < 0) {
+                op_errno = EINVAL;
+                goto err;
+        }
+
+        LOCK (&pctx->lock);
+        {
+                if (pctx->journal == MQ_JOURNAL_NONE)
+                        pctx->journal = MQ_JOURNAL_HELD;
+        }
+        UNLOCK (&pctx->lock);
+
+        GET_CONTRI_KEY (contri_key, local->contri->gfid, ret);
+        if (ret < 0) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+
+        mq_xattrop_add (frame, this, &local->loc, contri_key, local->delta,
+                        mq_flush_dir_contri_done);
+
+        return 0;
+err:
+        mq_flush_dir_restore (this, local, op_errno);
+
+        return mq_flush_dir_settle (frame, NULL, this, 0, 0);
+}
+
+
+int32_t
+mq_flush_dir_parent_locked (call_frame_t *frame, void *cookie,
+                            xlator_t *this, int32_t op_ret, int32_t op_errno)
+{
+        quota_local_t     *local = NULL;
+        quota_inode_ctx_t *pctx  = NULL;
+
+        local = frame->local;
+
+        if (op_ret == -1) {
+                gf_log (this->name, ((op_errno == ENOENT) ? GF_LOG_DEBUG
+                                     : GF_LOG_WARNING),
+                        "acquiring lock on %s failed (%s)",
+                        local->parent_loc.path, strerror (op_errno));
+
+                mq_flush_dir_restore (this, local, op_errno);
+                return mq_flush_dir_settle (frame, NULL, this, 0, 0);
+        }
+
+        local->locked = 2;
+
+        if ((quota_inode_ctx_get (local->parent_loc.inode, this, &pctx) == 0)
+            && mq_journal_on_disk (pctx))
+                return mq_flush_dir_parent_dirty (frame, NULL, this, 0, 0);
+
+        mq_setdirty (frame, this, &local->parent_loc, 1,
+                     mq_flush_dir_parent_dirty);
+
+        return 0;
+}
+
+
+int32_t
+mq_flush_dir_locked (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno)
+{
+        quota_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (op_ret == -1) {
+                gf_log (this->name, ((op_errno == ENOENT) ? GF_LOG_DEBUG
+                                     : GF_LOG_WARNING),
+                        "acquiring lock on %s failed (%s)",
+                        local->loc.path, strerror (op_errno));
+
+                mq_flush_dir_restore (this, local, op_errno);
+                return mq_unlock_all (frame, NULL, this, 0, 0);
+        }
+
+        local->locked = 1;
+
+        LOCK (&local->ctx->lock);
+        {
+                local->delta = local->ctx->pending_delta;
+                local->ctx->pending_delta = 0;
+        }
+        UNLOCK (&local->ctx->lock);
+
+        if (local->delta == 0)
+                return mq_flush_dir_settle (frame, NULL, this, 0, 0);
+
+        mq_inodelk (frame, this, &local->parent_loc, F_WRLCK,
+                    mq_flush_dir_parent_locked);
+
+        return 0;
+}
+
+
+static int32_t
+mq_flush_dir (xlator_t *this, inode_t *inode, quota_inode_ctx_t *ctx)
+{
+        int32_t        ret   = -1;
+        call_frame_t  *frame = NULL;
+        quota_local_t *local = NULL;
+
+        frame = create_frame (this, this->ctx->pool);
+        if (frame == NULL)
+                goto err;
+
+        mq_assign_lk_owner (this, frame);
+
+        local = quota_local_new ();
+        if (local == NULL)
+                goto err;
+
+        frame->local = local;
+        mq_batch_get (this, local);
+
+        local->ctx = ctx;
+
+        ret = quota_inode_loc_fill (NULL, inode, &local->loc);
+        if ((ret < 0) || (local->loc.parent == NULL))
+                goto err;
+
+        ret = quota_inode_loc_fill (NULL, local->loc.parent,
+                                    &local->parent_loc);
+        if (ret < 0)
+                goto err;
+
+        local->contri = get_contribution_node (local->loc.parent, ctx);
+        if (local->contri == NULL)
+                goto err;
+
+        mq_inodelk (frame, this, &local->loc, F_WRLCK, mq_flush_dir_locked);
+
+        return 0;
+err:
+        gf_log (this->name, GF_LOG_DEBUG, "cannot flush a directory, its "
+                "pending delta waits for the next update under it");
+
+        if (frame)
+                QUOTA_STACK_DESTROY (frame, this);
+
+        return -1;
+}
+
+
+/* A directory whose size and contribution differ by more than its
+   pending_delta (after a crash, a removal, an inline txn) gets the rest
+   added to pending_delta, under its inodelk. */
+
+int32_t
+mq_recover_dir_marked (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno)
+{
+        quota_local_t *local = NULL;
+
+        local = frame->local;
+
+        if (op_ret == -1) {
+                gf_log (this->name, ((op_errno == ENOENT) ? GF_LOG_DEBUG
+                                     : GF_LOG_WARNING),
+                        "failed to mark %s dirty (%s)", local->loc.path,
+                        strerror (op_errno));
+                goto unlock;
+        }
+
+        LOCK (&local->ctx->lock);
+        {
+                if (local->ctx->journal == MQ_JOURNAL_NONE)
+                        local->ctx->journal = MQ_JOURNAL_HELD;
+        }
+        UNLOCK (&local->ctx->lock);
+
+        mq_pending_add_delta (this, local->loc.inode, local->ctx,
+                              local->delta);
+unlock:
+        mq_unlock_all (frame, NULL, this, 0, 0);
+
+        return 0;
+}
+
+
+int32_t
+mq_recover_dir_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int32_t op_ret, int32_t op_errno, inode_t *inode,
+                           struct iatt *buf, dict_t *dict,
+                           struct iatt *postparent)
+{
+        int32_t        ret              = -1;
+        int64_t       *size             = NULL;
+        int64_t       *contri           = NULL;
+        int64_t        contri_int       = 0;
+        char           contri_key [512] = {0, };
+        quota_local_t *local            = NULL;
+
+        local = frame->local;
+
+        if ((op_ret == -1) || (dict == NULL))
+                goto unlock;
+
+        ret = dict_get_bin (dict, QUOTA_SIZE_KEY, (void **) &size);
+        if (ret < 0)
+                goto unlock;
+
+        GET_CONTRI_KEY (contri_key, local->contri->gfid, ret);
+        if (ret < 0)
+                goto unlock;
+
+        ret = dict_get_bin (dict, contri_key, (void **) &contri);
+        if (ret == 0)
+                contri_int = ntoh64 (*contri);
+
+        LOCK (&local->ctx->lock);
+        {
+                local->delta = ntoh64 (*size) - contri_int
+                        - local->ctx->pending_delta;
+        }
+        UNLOCK (&local->ctx->lock);
+
+        if (local->delta == 0)
+                goto unlock;
+
+        if (mq_journal_on_disk (local->ctx))
+                return mq_recover_dir_marked (frame, NULL, this, 0, 0);
+
+        mq_setdirty (frame, this, &local->loc, 1, mq_recover_dir_marked);
+
+        return 0;
+unlock:
+        mq_unlock_all (frame, NULL, this, 0, 0);
+
+        return 0;
+}
+
+
+int32_t
+mq_recover_dir_locked (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno)
+{
+        int32_t        ret              = -1;
+        char           contri_key [512] = {0, };
+        dict_t        *dict             = NULL;
+        quota_local_t *local            = NULL;
+
+        local = frame->local;
+
+        if (op_ret == -1)
+                goto err;
+
+        local->locked = 1;
+
+        dict = dict_new ();
+        if (dict == NULL)
+                goto err;
+
+        ret = dict_set_int64 (dict, QUOTA_SIZE_KEY, 0);
+        if (ret < 0)
+                goto err;
+
+        GET_CONTRI_KEY (contri_key, local->contri->gfid, ret);
+        if (ret < 0)
+                goto err;
+
+        ret = dict_set_int64 (dict, contri_key, 0);
+        if (ret < 0)
+                goto err;
+
+        STACK_WIND (frame, mq_recover_dir_lookup_cbk,
+                    FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->lookup,
+                    &local->loc, dict);
+
+        dict_unref (dict);
+
+        return 0;
+err:
+        if (dict)
+                dict_unref (dict);
+
+        mq_unlock_all (frame, NULL, this, 0, 0);
+
+        return 0;
+}
+
+
+static int32_t
+mq_recover_dir (xlator_t *this, loc_t *loc, quota_inode_ctx_t *ctx,
+                gf_boolean_t force)
+{
+        int32_t        ret    = -1;
+        call_frame_t  *frame  = NULL;
+        quota_local_t *local  = NULL;
+        gf_boolean_t   queued = _gf_false;
+
+        /* its flush reads the size again anyway */
+        if (!force) {
+                LOCK (&ctx->lock);
+                {
+                        queued = ctx->pending;
+                }
+                UNLOCK (&ctx->lock);
+
+                if (queued)
+                        return 0;
+        }
+
+        frame = create_frame (this, this->ctx->pool);
+        if (frame == NULL)
+                goto err;
+
+        mq_assign_lk_owner (this, frame);
+
+        local = quota_local_new ();
+        if (local == NULL)
+                goto err;
+
+        frame->local = local;
+        mq_batch_get (this, local);
+
+        local->ctx = ctx;
+
+        ret = mq_loc_copy (&local->loc, loc);
+        if (ret < 0)
+                goto err;
+
+        local->contri = get_contribution_node (local->loc.parent, ctx);
+        if (local->contri == NULL)
+                goto err;
+
+        mq_inodelk (frame, this, &local->loc, F_WRLCK, mq_recover_dir_locked);
+
+        return 0;
+err:
+        if (frame)
+                QUOTA_STACK_DESTROY (frame, this);
+
+        return -1;
+}
+
+
+int
+start_quota_txn (xlator_t *this, loc_t *loc,
+                 quota_inode_ctx_t *ctx,
+                 inode_contribution_t *contri, gf_boolean_t batched,
+                 inode_t *journal)
+{
+        int32_t        ret      = -1;
+        call_frame_t  *frame    = NULL;
+        quota_local_t *local    = NULL;
+
+        frame = create_frame (this, this->ctx->pool);
+        if (frame == NULL)
+                goto err;
+
+        mq_assign_lk_owner (this, frame);
+
+        local = quota_local_new ();
+        if (local == NULL)
+                goto fr_destroy;
+
+        frame->local = local;
+
+        /* from here on the local drops the journal hold when it goes */
+        local->journal = journal;
+        journal = NULL;
+
+        if (batched)
+                mq_batch_get (this, local);
+
+        ret = mq_loc_copy (&local->loc, loc);
+        if (ret < 0)
+                goto fr_destroy;
+
+        ret = quota_inode_loc_fill (NULL, local->loc.parent,
+                                    &local->parent_loc);
+        if (ret < 0)
+                goto fr_destroy;
+
+        local->ctx = ctx;
+        local->contri = contri;
+
+        ret = get_lock_on_parent (frame, this);
+        if (ret == -1)
+                goto err;
+
+        return 0;
+
+fr_destroy:
+        QUOTA_STACK_DESTROY (frame, this);
+err:
+        if (journal) {
+                mq_pending_child_done (this, journal);
+                inode_unref (journal);
+        }
+
+        mq_set_ctx_updation_status (ctx, _gf_false);
+
+        return -1;
+}
+
+
+static void
+quota_flush_pending (void *data)
+{
+        xlator_t             *this    = NULL;
+        marker_conf_t        *priv    = NULL;
+        quota_pending_t      *pending = NULL;
+        quota_pending_t      *tmp     = NULL;
+        quota_inode_ctx_t    *ctx     = NULL;
+        inode_contribution_t *contri  = NULL;
+        gf_boolean_t          status  = _gf_false;
+        struct list_head      batch;
+        loc_t                 loc     = {0, };
+        uint64_t              flushed = 0;
+
+        this = data;
+        THIS = this;
+        priv = this->private;
+
+        INIT_LIST_HEAD (&batch);
+
+        LOCK (&priv->lock);
+        {
+                priv->quota_flush_timer = NULL;
+                list_splice_init (&priv->quota_pending, &batch);
+                priv->quota_pending_count = 0;
+        }
+        UNLOCK (&priv->lock);
+
+        list_for_each_entry_safe (pending, tmp, &batch, list) {
+                list_del_init (&pending->list);
+
+                if (quota_inode_ctx_get (pending->inode, this, &ctx) < 0)
+                        goto next;
+
+                if (pending->inode->ia_type == IA_IFDIR) {
+                        /* additions from here on queue it again */
+                        LOCK (&ctx->lock);
+                        {
+                                ctx->pending = _gf_false;
+                        }
+                        UNLOCK (&ctx->lock);
+
+                        if (mq_flush_dir (this, pending->inode, ctx) == 0)
+                                flushed++;
+                        goto next;
+                }
+
+                if (quota_inode_loc_fill (NULL, pending->inode, &loc) < 0)
+                        goto unqueue;
+
+                contri = get_contribution_node (loc.parent, ctx);
+                if (contri == NULL)
+                        goto unqueue;
+
+                status = _gf_true;
+                if (mq_test_and_set_ctx_updation_status (ctx, &status) < 0)
+                        goto unqueue;
+
+                if (status == _gf_true) {
+                        /* a txn on this inode may have read its size
+                           already, take it again next round */
+                        loc_wipe (&loc);
+                        mq_pending_add (this, pending);
+                        continue;
+                }
+
+                /* updates from here on queue it again */
+                LOCK (&ctx->lock);
+                {
+                        ctx->pending = _gf_false;
+                }
+                UNLOCK (&ctx->lock);
+
+                start_quota_txn (this, &loc, ctx, contri, _gf_true,
+                                 pending->parent);
+                pending->parent = NULL;
+                flushed++;
+                goto next;
+unqueue:
+                LOCK (&ctx->lock);
+                {
+                        ctx->pending = _gf_false;
+                }
+                UNLOCK (&ctx->lock);
+next:
+                loc_wipe (&loc);
+                mq_pending_free (this, pending);
+        }
+
+        LOCK (&priv->lock);
+        {
+                priv->quota_flushed += flushed;
+                __quota_flush_arm (this, priv);
+        }
+        UNLOCK (&priv->lock);
+}
+
+
+/* defers the txn of file @loc to the next flush, once its parent is
+   marked dirty. Repeated updates of the file until then cost nothing:
+   its txn moves the whole difference between size and contribution. */
+static int32_t
+quota_txn_enqueue (xlator_t *this, loc_t *loc, quota_inode_ctx_t *ctx)
+{
+        int32_t            ret     = -1;
+        marker_conf_t     *priv    = NULL;
+        quota_pending_t   *pending = NULL;
+        quota_inode_ctx_t *pctx    = NULL;
+        gf_boolean_t       queued  = _gf_false;
+        gf_boolean_t       mark    = _gf_false;
+        gf_boolean_t       wait    = _gf_false;
+
+        priv = this->private;
+
+        LOCK (&ctx->lock);
+        {
+                queued = ctx->pending;
+                ctx->pending = _gf_true;
+        }
+        UNLOCK (&ctx->lock);
+
+        if (queued) {
+                QUOTA_SAFE_INCREMENT (&priv->lock, priv->quota_coalesced);
+                return 0;
+        }
+
+        QUOTA_ALLOC (pending, quota_pending_t, ret);
+        if (ret < 0)
+                goto err;
+
+        INIT_LIST_HEAD (&pending->list);
+        pending->inode = inode_ref (loc->inode);
+
+        if (loc->parent
+            && (quota_inode_ctx_get (loc->parent, this, &pctx) == 0)) {
+                pending->parent = inode_ref (loc->parent);
+
+                LOCK (&pctx->lock);
+                {
+                        switch (pctx->journal) {
+                        case MQ_JOURNAL_NONE:
+                                pctx->journal = MQ_JOURNAL_MARKING;
+                                mark = _gf_true;
+                                /* fall through */
+                        case MQ_JOURNAL_MARKING:
+                                list_add_tail (&pending->list,
+                                               &pctx->journal_waiters);
+                                wait = _gf_true;
+                                break;
+                        default:
+                                pctx->pending_children++;
+                                break;
+                        }
+                }
+                UNLOCK (&pctx->lock);
+        }
+
+        QUOTA_SAFE_INCREMENT (&priv->lock, priv->quota_queued);
+
+        if (mark)
+                mq_journal_mark (this, loc->parent, pctx);
+
+        if (!wait)
+                mq_pending_add (this, pending);
+
+        return 0;
+err:
+        LOCK (&ctx->lock);
+        {
+                ctx->pending = _gf_false;
+        }
+        UNLOCK (&ctx->lock);
+
+        return -1;
+}
+
+
+int
+initiate_quota_txn (xlator_t *this, loc_t *loc)
+{
+        int32_t               ret          = -1;
+        gf_boolean_t          status       = _gf_false;
+        quota_inode_ctx_t    *ctx          = NULL;
+        inode_contribution_t *contribution = NULL;
+        marker_conf_t        *priv         = NULL;
+
+        GF_VALIDATE_OR_GOTO ("marker", this, out);
+        GF_VALIDATE_OR_GOTO ("marker", loc, out);
+        GF_VALIDATE_OR_GOTO ("marker", loc->inode, out);
+
+        priv = this->private;
+
+        ret = quota_inode_ctx_get (loc->inode, this, &ctx);
+        if (ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "inode ctx get failed, aborting quota txn");
+                ret = -1;
+                goto out;
+        }
+
+        contribution = get_contribution_node (loc->parent, ctx);
+        if (contribution == NULL)
+                goto out;
+
+        if (mq_batching (priv)) {
+                if (loc->inode->ia_type == IA_IFDIR)
+                        ret = mq_recover_dir (this, loc, ctx, _gf_false);
+                else
+                        ret = quota_txn_enqueue (this, loc, ctx);
+                goto out;
+        }
+
+        /* To improve performance, donot start another transaction
+         * if one is already in progress for same inode
+         */
+        status = _gf_true;
+
+        ret = mq_test_and_set_ctx_updation_status (ctx, &status);
+        if (ret < 0)
+                goto out;
+
+        if (status == _gf_false) {
+                start_quota_txn (this, loc, ctx, contribution, _gf_false,
+                                 NULL);
+        }
+
+        ret = 0;
+out:
+        return ret;
+}
+
+
+/* int32_t */
+/* validate_inode_size_contribution (xlator_t *this, loc_t *loc, int64_t size, */
+/*                                int64_t contribution) */
+/* { */
+/*   if (size != contribution) { */
+/*     initiate_quota_txn (this, loc); */
+/*   } */
+
+/*   return 0; */
+/* } */
+
+
+int32_t
+inspect_directory_xattr (xlator_t *this,
+                         loc_t *loc,
+                         dict_t *dict,
+                         struct iatt buf)
+{
+        int32_t               ret                 = 0;
+        int8_t                dirty               = -1;
+        int64_t              *size                = NULL, size_int = 0;
+        int64_t              *contri              = NULL, contri_int = 0;
+        char                  contri_key [512]    = {0, };
+        marker_conf_t        *priv                = NULL;
+        gf_boolean_t          not_root            = _gf_false;
+        quota_inode_ctx_t    *ctx                 = NULL;
+        inode_contribution_t *contribution        = NULL;
+
+        priv = this->private;
+
+        ret = quota_inode_ctx_get (loc->inode, this, &ctx);
+        if (ret < 0) {
+                ctx = quota_inode_ctx_new (loc->inode, this);
+                if (ctx == NULL) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "quota_inode_ctx_new failed");
+                        ret = -1;
+                        goto out;
+                }
+        }
+
+        ret = dict_get_bin (dict, QUOTA_SIZE_KEY, (void **) &size);
+        if (ret < 0)
+                goto out;
+
+        ret = dict_get_int8 (dict, QUOTA_DIRTY_KEY, &dirty);
+        if (ret < 0)
+                goto out;
+
+        if (strcmp (loc->path, "/") != 0) {
+                not_root = _gf_true;
+
+                contribution = add_new_contribution_node (this, ctx, loc);
+                if (contribution == NULL) {
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "cannot add a new contributio node");
+                        goto out;
+                }
+
+                GET_CONTRI_KEY (contri_key, contribution->gfid, ret);
+                if (ret < 0)
+                        goto out;
+
+                ret = dict_get_bin (dict, contri_key, (void **) &contri);
+                if (ret < 0)
+                        goto out;
+
+                LOCK (&contribution->lock);
+                {
+                        contribution->contribution = ntoh64 (*contri);
+                        contri_int = contribution->contribution;
+                }
+                UNLOCK (&contribution->lock);
+        }
+
+        LOCK (&ctx->lock);
+        {
+                ctx->size = ntoh64 (*size);
+                ctx->dirty = dirty;
+                size_int = ctx->size;
+        }
+        UNLOCK (&ctx->lock);
+
+        gf_log (this->name, GF_LOG_DEBUG, "size=%"PRId64
+                " contri=%"PRId64, size_int, contri_int);
+
+        /* while the batched engine holds the directory, its dirty mark
+           and the gap between size and contribution are its own */
+        if (mq_journal_busy (ctx)) {
+                ret = 0;
+                goto out;
+        }
+
+        if (dirty) {
+                ret = update_dirty_inode (this, loc, ctx, contribution);
+        }
+
+        if ((!dirty || ret == 0) && (not_root == _gf_true) &&
+            (size_int != contri_int)) {
+                initiate_quota_txn (this, loc);
+        }
+
+        ret = 0;
+out:
+        if (ret)
+                quota_set_inode_xattr (this, loc);
+
+        return 0;
+}
+
+int32_t
+inspect_file_xattr (xlator_t *this,
+                    loc_t *loc,
+                    dict_t *dict,
+                    struct iatt buf)
+{
+        int32_t               ret              = -1;
+        uint64_t              contri_int       = 0, size = 0;
+        int64_t              *contri_ptr       = NULL;
+        char                  contri_key [512] = {0, };
+        marker_conf_t        *priv             = NULL;
+        quota_inode_ctx_t    *ctx              = NULL;
+        inode_contribution_t *contribution     = NULL;
+
+        priv = this->private;
+
+        ret = quota_inode_ctx_get (loc->inode, this, &ctx);
+        if (ret < 0) {
+                ctx = quota_inode_ctx_new (loc->inode, this);
+                if (ctx == NULL) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "quota_inode_ctx_new failed");
+                        ret = -1;
+                        goto out;
+                }
+        }
+
+        contribution = add_new_contribution_node (this, ctx, loc);
+        if (contribution == NULL)
+                goto out;
+
+        LOCK (&ctx->lock);
+        {
+                ctx->size = 512 * buf.ia_blocks;
+                size = ctx->size;
+        }
+        UNLOCK (&ctx->lock);
+
+        list_for_each_entry (contribution, &ctx->contribution_head,
+                             contri_list) {
+                GET_CONTRI_KEY (contri_key, contribution->gfid, ret);
+                if (ret < 0)
+                        continue;
+
+                ret = dict_get_bin (dict, contri_key, (void **) &contri_int);
+                if (ret == 0) {
+                        contri_ptr = (int64_t *)(unsigned long)contri_int;
+
+                        LOCK (&contribution->lock);
+                        {
                                 contribution->contribution = ntoh64 (*contri_ptr);
                                 contri_int = contribution->contribution;
                         }
@@ -2221,7 +3527,12 @@ quota_inode_remove_done (call_frame_t *frame, void *cookie, xlator_t *this,
                 if (ret < 0)
                         goto out;
 
-                start_quota_txn (this, &local->loc, local->ctx, local->contri);
+                if (mq_batching (this->private))
+                        mq_recover_dir (this, &local->loc, local->ctx,
+                                        _gf_true);
+                else
+                        start_quota_txn (this, &local->loc, local->ctx,
+                                         local->contri, _gf_false, NULL);
         }
 out:
         quota_local_unref (this, local);
@@ -2431,9 +3742,68 @@ out:
 
 
 int32_t
-init_quota_priv (xlator_t *this)
+init_quota_priv (xlator_t *this, dict_t *options)
 {
-        return 0;
+        int32_t        ret  = -1;
+        marker_conf_t *priv = NULL;
+
+        priv = this->private;
+
+        ret = xlator_option_reconf_uint32 (this, options,
+                                           "quota-flush-interval",
+                                           &priv->quota_flush_interval);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "invalid value for quota-flush-interval");
+                goto out;
+        }
+
+        /* also called from reconfigure: what is queued goes with the next
+           flush, right away if batching was turned off */
+        LOCK (&priv->lock);
+        {
+                __quota_flush_arm (this, priv);
+        }
+        UNLOCK (&priv->lock);
+
+        ret = 0;
+out:
+        return ret;
+}
+
+
+void
+quota_priv_cleanup (xlator_t *this)
+{
+        marker_conf_t   *priv    = NULL;
+        quota_pending_t *pending = NULL;
+        quota_pending_t *tmp     = NULL;
+        struct list_head batch;
+
+        priv = this->private;
+
+        INIT_LIST_HEAD (&batch);
+
+        LOCK (&priv->lock);
+        {
+                if (priv->quota_flush_timer) {
+                        gf_timer_call_cancel (this->ctx,
+                                              priv->quota_flush_timer);
+                        priv->quota_flush_timer = NULL;
+                }
+
+                list_splice_init (&priv->quota_pending, &batch);
+                priv->quota_pending_count = 0;
+        }
+        UNLOCK (&priv->lock);
+
+        /* the updates still queued are dropped. The directories they were
+           queued under stay marked dirty on disk, and the dirty inode scan
+           brings them up to date on their next lookup. */
+        list_for_each_entry_safe (pending, tmp, &batch, list) {
+                list_del_init (&pending->list);
+                mq_pending_free (this, pending);
+        }
 }
 
 
@@ -87,10 +87,26 @@
                 UNLOCK (lock);                  \
         } while (0)
 
+/* who owns the dirty xattr of a directory, see quota_txn_enqueue() */
+enum {
+        MQ_JOURNAL_NONE = 0,    /* not the batched engine */
+        MQ_JOURNAL_MARKING,     /* dirty=1 being set */
+        MQ_JOURNAL_HELD,        /* dirty=1 on disk, cleared by the engine */
+        MQ_JOURNAL_BROKEN,      /* dirty=1 on disk, left for the dirty scan */
+};
+
 struct quota_inode_ctx {
         int64_t                size;
         int8_t                 dirty;
         gf_boolean_t           updation_status;
+        gf_boolean_t           pending;          /* queued for a flush */
+        int32_t                pending_children; /* queued children counted
+                                                    in this dir's mark */
+        int64_t                pending_delta;    /* in size, not yet sent
+                                                    to the parent */
+        int8_t                 journal;          /* MQ_JOURNAL_* */
+        struct list_head       journal_waiters;  /* children to queue once
+                                                    the mark is on disk */
         gf_lock_t              lock;
         struct list_head       contribution_head;
 };
@@ -117,6 +133,9 @@ struct quota_local {
         fd_t         *fd;
         call_frame_t *frame;
         gf_lock_t     lock;
+        inode_t      *journal;    /* holds a pending_children count on it */
+        int8_t        batched;    /* counted in quota_batch_inflight */
+        int8_t        locked;     /* inodelks held, for the error paths */
 
         loc_t loc;
         loc_t parent_loc;
@@ -126,6 +145,13 @@ struct quota_local {
 };
 typedef struct quota_local quota_local_t;
 
+struct quota_pending {
+        struct list_head list;
+        inode_t         *inode;
+        inode_t         *parent;  /* holds a pending_children count on it */
+};
+typedef struct quota_pending quota_pending_t;
+
 int32_t
 get_lock_on_parent (call_frame_t *, xlator_t *);
 
@@ -133,7 +159,19 @@ int32_t
 quota_req_xattr (xlator_t *, loc_t *, dict_t *);
 
 int32_t
-init_quota_priv (xlator_t *);
+init_quota_priv (xlator_t *, dict_t *);
+
+void
+quota_priv_cleanup (xlator_t *);
+
+void
+mq_journal_release (xlator_t *, quota_local_t *);
+
+void
+mq_batch_put (xlator_t *, quota_local_t *);
+
+gf_boolean_t
+mq_journal_busy (quota_inode_ctx_t *);
 
 int32_t
 quota_xattr_state (xlator_t *, loc_t *, dict_t *, struct iatt);
@@ -30,6 +30,7 @@
 #include "marker-quota-helper.h"
 #include "marker-common.h"
 #include "byte-order.h"
+#include "statedump.h"
 
 void
 fini (xlator_t *this);
@@ -2288,6 +2289,8 @@ marker_priv_cleanup (xlator_t *this)
 
         marker_xtime_priv_cleanup (this);
 
+        quota_priv_cleanup (this);
+
         LOCK_DESTROY (&priv->lock);
 
         GF_FREE (priv);
@@ -2316,7 +2319,7 @@ reconfigure (xlator_t *this, dict_t *options)
         if (data) {
                 ret = gf_string2boolean (data->data, &flag);
                 if (ret == 0 && flag == _gf_true) {
-                        ret = init_quota_priv (this);
+                        ret = init_quota_priv (this, options);
                         if (ret < 0) {
                                 gf_log (this->name, GF_LOG_WARNING,
                                         "failed to initialize quota private");
@@ -2378,11 +2381,13 @@ init (xlator_t *this)
 
         LOCK_INIT (&priv->lock);
 
+        INIT_LIST_HEAD (&priv->quota_pending);
+
         data = dict_get (options, "quota");
         if (data) {
                 ret = gf_string2boolean (data->data, &flag);
                 if (ret == 0 && flag == _gf_true) {
-                        ret = init_quota_priv (this);
+                        ret = init_quota_priv (this, options);
                         if (ret < 0)
                                 goto err;
 
@@ -2436,6 +2441,43 @@ fini (xlator_t *this)
         marker_priv_cleanup (this);
 }
 
+int32_t
+marker_priv_dump (xlator_t *this)
+{
+        marker_conf_t *priv                            = NULL;
+        char           key_prefix[GF_DUMP_MAX_BUF_LEN] = {0, };
+        char           key[GF_DUMP_MAX_BUF_LEN]        = {0, };
+
+        if (!this || !this->private)
+                goto out;
+
+        priv = this->private;
+
+        gf_proc_dump_build_key (key_prefix, "xlator.features.marker", "priv");
+        gf_proc_dump_add_section (key_prefix);
+
+        LOCK (&priv->lock);
+        {
+                gf_proc_dump_build_key (key, key_prefix,
+                                        "quota_flush_interval");
+                gf_proc_dump_write (key, "%u", priv->quota_flush_interval);
+                gf_proc_dump_build_key (key, key_prefix, "quota_pending");
+                gf_proc_dump_write (key, "%u", priv->quota_pending_count);
+                gf_proc_dump_build_key (key, key_prefix,
+                                        "quota_batch_inflight");
+                gf_proc_dump_write (key, "%u", priv->quota_batch_inflight);
+                gf_proc_dump_build_key (key, key_prefix, "quota_queued");
+                gf_proc_dump_write (key, "%"PRIu64, priv->quota_queued);
+                gf_proc_dump_build_key (key, key_prefix, "quota_coalesced");
+                gf_proc_dump_write (key, "%"PRIu64, priv->quota_coalesced);
+                gf_proc_dump_build_key (key, key_prefix, "quota_flushed");
+                gf_proc_dump_write (key, "%"PRIu64, priv->quota_flushed);
+        }
+        UNLOCK (&priv->lock);
+out:
+        return 0;
+}
+
 struct xlator_fops fops = {
         .lookup      = marker_lookup,
         .create      = marker_create,
@@ -2461,10 +2503,25 @@ struct xlator_cbks cbks = {
         .forget = marker_forget
 };
 
+struct xlator_dumpops dumpops = {
+        .priv = marker_priv_dump,
+};
+
 struct volume_options options[] = {
         {.key = {"volume-uuid"}},
         {.key = {"timestamp-file"}},
         {.key = {"quota"}},
         {.key = {"xtime"}},
+        { .key  = {"quota-flush-interval"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 60000,
+          .default_value = "0",
+          .description = "Milliseconds to hold back quota size updates. "
+          "Updates of the same file or directory within one interval are "
+          "propagated to its parent in a single transaction, at the cost "
+          "of sizes lagging by that long. 0 propagates each update right "
+          "away."
+        },
         {.key = {NULL}}
 };
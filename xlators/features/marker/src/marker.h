@@ -29,6 +29,7 @@
 #include "defaults.h"
 #include "uuid.h"
 #include "call-stub.h"
+#include "timer.h"
 
 #define MARKER_XATTR_PREFIX "trusted.glusterfs"
 #define XTIME               "xtime"
@@ -107,6 +108,16 @@ struct marker_conf{
         char        *marker_xattr;
         uint64_t     quota_lk_owner;
         gf_lock_t    lock;
+
+        /* deferred quota propagation, see quota_txn_enqueue() */
+        uint32_t          quota_flush_interval;  /* msec, 0 = inline */
+        struct list_head  quota_pending;
+        uint32_t          quota_pending_count;
+        uint32_t          quota_batch_inflight;  /* frames of the engine */
+        gf_timer_t       *quota_flush_timer;
+        uint64_t          quota_queued;          /* txns deferred */
+        uint64_t          quota_coalesced;       /* updates folded into them */
+        uint64_t          quota_flushed;         /* txns started by a flush */
 };
 typedef struct marker_conf marker_conf_t;
 
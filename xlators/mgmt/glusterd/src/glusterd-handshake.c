@@ -176,6 +176,13 @@ server_getspec (rpcsvc_request_t *req)
                 ret = read (spec_fd, rsp.spec, file_len);
 
                 close (spec_fd);
+
+                /* whom to notify when this volfile changes, see
+                   glusterd_fetchspec_notify_changed () */
+                if (req->trans->xl_private)
+                        GF_FREE (req->trans->xl_private);
+                glusterd_volfile_path_normalize (filename);
+                req->trans->xl_private = gf_strdup (filename);
         }
 
         /* convert to XDR */
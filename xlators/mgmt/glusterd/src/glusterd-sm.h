@@ -42,6 +42,9 @@ struct glusterd_store_handle_ {
         char    *path;
         int     fd;
         FILE    *read;
+        int     tmp_fd;         /* of path.tmp, between mkstemp and rename */
+        dict_t  *kv;            /* keys of path, see retrieve_value */
+        ino_t   kv_ino;
 };
 
 typedef struct glusterd_store_handle_  glusterd_store_handle_t;
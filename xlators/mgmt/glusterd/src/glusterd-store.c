@@ -102,27 +102,178 @@ glusterd_store_mkstemp (glusterd_store_handle_t *shandle)
         if (fd <= 0) {
                 gf_log ("glusterd", GF_LOG_ERROR, "Failed to open %s, "
                         "error: %s", tmppath, strerror (errno));
+        } else {
+                shandle->tmp_fd = fd;
         }
 
         return fd;
 }
 
+static gf_boolean_t
+glusterd_store_is_tmpname (const char *name)
+{
+        size_t  len = 0;
+
+        len = strlen (name);
+
+        return ((len > 4) && !strcmp (name + len - 4, ".tmp"));
+}
+
+/* fsync()s the directory holding path, making a rename into it durable */
+static int32_t
+glusterd_store_sync_dir (const char *path)
+{
+        int32_t         ret = -1;
+        int             fd = -1;
+        char            dir[PATH_MAX] = {0,};
+        char            *ptr = NULL;
+
+        strncpy (dir, path, sizeof (dir) - 1);
+        ptr = strrchr (dir, '/');
+        if (!ptr) {
+                strcpy (dir, ".");
+        } else if (ptr == dir) {
+                ptr[1] = '\0';
+        } else {
+                *ptr = '\0';
+        }
+
+        fd = open (dir, O_RDONLY);
+        if (fd == -1) {
+                gf_log ("glusterd", GF_LOG_ERROR, "Failed to open %s, "
+                        "error: %s", dir, strerror (errno));
+                goto out;
+        }
+
+        ret = fsync (fd);
+        if (ret)
+                gf_log ("glusterd", GF_LOG_ERROR, "Failed to fsync %s, "
+                        "error: %s", dir, strerror (errno));
+        close (fd);
+out:
+        return ret;
+}
+
+/* A file rewritten with the same contents (most brick files, on every
+ * volume set) need not be fsync()ed and renamed again.
+ */
+gf_boolean_t
+glusterd_store_files_equal (const char *path1, const char *path2)
+{
+        gf_boolean_t    equal = _gf_false;
+        int             fd1 = -1;
+        int             fd2 = -1;
+        struct stat     st1 = {0,};
+        struct stat     st2 = {0,};
+        char            buf1[4096];
+        char            buf2[4096];
+        ssize_t         len1 = 0;
+        ssize_t         len2 = 0;
+
+        fd1 = open (path1, O_RDONLY);
+        fd2 = open (path2, O_RDONLY);
+        if ((fd1 == -1) || (fd2 == -1))
+                goto out;
+
+        if (fstat (fd1, &st1) || fstat (fd2, &st2) ||
+            (st1.st_size != st2.st_size))
+                goto out;
+
+        do {
+                len1 = read (fd1, buf1, sizeof (buf1));
+                len2 = read (fd2, buf2, sizeof (buf2));
+                if ((len1 < 0) || (len1 != len2) ||
+                    memcmp (buf1, buf2, len1))
+                        goto out;
+        } while (len1 > 0);
+
+        equal = _gf_true;
+out:
+        if (fd1 != -1)
+                close (fd1);
+        if (fd2 != -1)
+                close (fd2);
+
+        return equal;
+}
+
+static int32_t
+glusterd_store_txn_add (glusterd_conf_t *priv, char *path)
+{
+        glusterd_store_txn_entry_t      *entry = NULL;
+
+        list_for_each_entry (entry, &priv->store_txn, list) {
+                if (!strcmp (entry->path, path))
+                        return 0;
+        }
+
+        entry = GF_CALLOC (1, sizeof (*entry), gf_gld_mt_store_txn_entry_t);
+        if (!entry)
+                return -1;
+
+        entry->path = gf_strdup (path);
+        if (!entry->path) {
+                GF_FREE (entry);
+                return -1;
+        }
+
+        list_add_tail (&entry->list, &priv->store_txn);
+
+        return 0;
+}
+
+/* Moves path.tmp, just written through glusterd_store_mkstemp (), over
+ * path. The data is fsync()ed first and the directory after, so that a
+ * crash leaves either the old or the new file behind. Inside a store
+ * transaction the rename itself waits for glusterd_store_txn_commit ().
+ */
 int32_t
 glusterd_store_rename_tmppath (glusterd_store_handle_t *shandle)
 {
         int32_t         ret = -1;
         char            tmppath[PATH_MAX] = {0,};
+        int             tmp_fd = -1;
+        glusterd_conf_t *priv = NULL;
 
         GF_ASSERT (shandle);
         GF_ASSERT (shandle->path);
 
+        priv = THIS->private;
+
+        tmp_fd = shandle->tmp_fd;
+        shandle->tmp_fd = 0;
+
         snprintf (tmppath, sizeof (tmppath), "%s.tmp", shandle->path);
+
+        if (glusterd_store_files_equal (tmppath, shandle->path)) {
+                gf_log ("glusterd", GF_LOG_DEBUG, "%s unchanged",
+                        shandle->path);
+                unlink (tmppath);
+                ret = 0;
+                goto out;
+        }
+
+        if ((tmp_fd > 0) && fsync (tmp_fd)) {
+                gf_log ("glusterd", GF_LOG_ERROR, "Failed to fsync %s, "
+                        "error: %s", tmppath, strerror (errno));
+                ret = -1;
+                goto out;
+        }
+
+        if (priv && priv->store_txn_depth) {
+                ret = glusterd_store_txn_add (priv, shandle->path);
+                goto out;
+        }
+
         ret = rename (tmppath, shandle->path);
         if (ret) {
                 gf_log ("glusterd", GF_LOG_ERROR, "Failed to mv %s to %s, "
                         "error: %s", tmppath, shandle->path, strerror (errno));
+                goto out;
         }
 
+        ret = glusterd_store_sync_dir (shandle->path);
+out:
         return ret;
 }
 
@@ -135,6 +286,8 @@ glusterd_store_unlink_tmppath (glusterd_store_handle_t *shandle)
         GF_ASSERT (shandle);
         GF_ASSERT (shandle->path);
 
+        shandle->tmp_fd = 0;
+
         snprintf (tmppath, sizeof (tmppath), "%s.tmp", shandle->path);
         ret = unlink (tmppath);
         if (ret && (errno != ENOENT)) {
@@ -147,6 +300,212 @@ glusterd_store_unlink_tmppath (glusterd_store_handle_t *shandle)
         return ret;
 }
 
+void
+glusterd_store_txn_begin ()
+{
+        glusterd_conf_t *priv = NULL;
+
+        priv = THIS->private;
+        GF_ASSERT (priv);
+
+        priv->store_txn_depth++;
+}
+
+static void
+glusterd_store_txn_cleanup (glusterd_conf_t *priv, gf_boolean_t unlink_tmp)
+{
+        glusterd_store_txn_entry_t      *entry = NULL;
+        glusterd_store_txn_entry_t      *tmp = NULL;
+        char                            tmppath[PATH_MAX] = {0,};
+
+        list_for_each_entry_safe (entry, tmp, &priv->store_txn, list) {
+                if (unlink_tmp) {
+                        snprintf (tmppath, sizeof (tmppath), "%s.tmp",
+                                  entry->path);
+                        unlink (tmppath);
+                }
+                list_del_init (&entry->list);
+                GF_FREE (entry->path);
+                GF_FREE (entry);
+        }
+}
+
+/* Lists the files of the transaction in the journal and makes it durable.
+ * Once the journal is in place the renames are bound to happen: if
+ * glusterd dies half way through them, glusterd_store_journal_replay ()
+ * finishes them at the next start.
+ */
+static int32_t
+glusterd_store_journal_write (glusterd_conf_t *priv, char *journal)
+{
+        int32_t                         ret = -1;
+        int                             fd = -1;
+        char                            tmppath[PATH_MAX] = {0,};
+        glusterd_store_txn_entry_t      *entry = NULL;
+        struct iovec                    vector[2];
+
+        snprintf (tmppath, sizeof (tmppath), "%s.tmp", journal);
+        fd = open (tmppath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd == -1) {
+                gf_log ("glusterd", GF_LOG_ERROR, "Failed to open %s, "
+                        "error: %s", tmppath, strerror (errno));
+                goto out;
+        }
+
+        list_for_each_entry (entry, &priv->store_txn, list) {
+                vector[0].iov_base = entry->path;
+                vector[0].iov_len  = strlen (entry->path);
+                vector[1].iov_base = "\n";
+                vector[1].iov_len  = 1;
+
+                if (writev (fd, vector, 2) != (vector[0].iov_len + 1)) {
+                        gf_log ("glusterd", GF_LOG_ERROR, "Failed to write "
+                                "%s, error: %s", tmppath, strerror (errno));
+                        goto out;
+                }
+        }
+
+        if (fsync (fd)) {
+                gf_log ("glusterd", GF_LOG_ERROR, "Failed to fsync %s, "
+                        "error: %s", tmppath, strerror (errno));
+                goto out;
+        }
+
+        ret = rename (tmppath, journal);
+        if (ret) {
+                gf_log ("glusterd", GF_LOG_ERROR, "Failed to mv %s to %s, "
+                        "error: %s", tmppath, journal, strerror (errno));
+                goto out;
+        }
+
+        ret = glusterd_store_sync_dir (journal);
+out:
+        if (fd != -1)
+                close (fd);
+        if (ret)
+                unlink (tmppath);
+
+        return ret;
+}
+
+/* Renames every path.tmp listed in the transaction (or the journal) into
+ * place, then fsync()s each directory involved once.
+ */
+static int32_t
+glusterd_store_txn_apply (glusterd_conf_t *priv)
+{
+        int32_t                         ret = 0;
+        glusterd_store_txn_entry_t      *entry = NULL;
+        glusterd_store_txn_entry_t      *prev = NULL;
+        char                            tmppath[PATH_MAX] = {0,};
+        int                             dirlen = 0;
+        gf_boolean_t                    synced = _gf_false;
+
+        list_for_each_entry (entry, &priv->store_txn, list) {
+                snprintf (tmppath, sizeof (tmppath), "%s.tmp", entry->path);
+                if (rename (tmppath, entry->path) && (errno != ENOENT)) {
+                        gf_log ("glusterd", GF_LOG_ERROR, "Failed to mv %s to "
+                                "%s, error: %s", tmppath, entry->path,
+                                strerror (errno));
+                        ret = -1;
+                }
+        }
+
+        list_for_each_entry (entry, &priv->store_txn, list) {
+                dirlen = strrchr (entry->path, '/') - entry->path;
+
+                synced = _gf_false;
+                list_for_each_entry (prev, &priv->store_txn, list) {
+                        if (prev == entry)
+                                break;
+                        if ((strrchr (prev->path, '/') - prev->path ==
+                             dirlen) &&
+                            !strncmp (prev->path, entry->path, dirlen)) {
+                                synced = _gf_true;
+                                break;
+                        }
+                }
+
+                if (!synced && glusterd_store_sync_dir (entry->path))
+                        ret = -1;
+        }
+
+        return ret;
+}
+
+/* Store transactions group the files written by one operation (the info,
+ * rbstate and brick files of a volume) so they replace the old ones
+ * together: each is fsync()ed as it is written, and at commit the renames
+ * are logged to a journal, applied, and their directories fsync()ed once
+ * each rather than once per file. Transactions nest, only the outermost
+ * commit or abort acts.
+ */
+int32_t
+glusterd_store_txn_commit ()
+{
+        int32_t                         ret = 0;
+        glusterd_conf_t                 *priv = NULL;
+        glusterd_store_txn_entry_t      *entry = NULL;
+        char                            journal[PATH_MAX] = {0,};
+        int                             count = 0;
+
+        priv = THIS->private;
+        GF_ASSERT (priv);
+        GF_ASSERT (priv->store_txn_depth > 0);
+
+        if (--priv->store_txn_depth)
+                goto out;
+
+        list_for_each_entry (entry, &priv->store_txn, list)
+                count++;
+
+        if (!count)
+                goto out;
+
+        /* a single rename is atomic on its own */
+        if (count > 1) {
+                ret = snprintf (journal, sizeof (journal), "%s/%s",
+                                priv->workdir, GLUSTERD_STORE_JOURNAL);
+                if (ret >= sizeof (journal)) {
+                        gf_log ("", GF_LOG_ERROR, "journal path too long "
+                                "under %s", priv->workdir);
+                        glusterd_store_txn_cleanup (priv, _gf_true);
+                        ret = -1;
+                        goto out;
+                }
+                ret = glusterd_store_journal_write (priv, journal);
+                if (ret) {
+                        glusterd_store_txn_cleanup (priv, _gf_true);
+                        goto out;
+                }
+        }
+
+        ret = glusterd_store_txn_apply (priv);
+
+        if (count > 1)
+                unlink (journal);
+
+        glusterd_store_txn_cleanup (priv, _gf_false);
+out:
+        gf_log ("", GF_LOG_DEBUG, "Returning %d", ret);
+        return ret;
+}
+
+void
+glusterd_store_txn_abort ()
+{
+        glusterd_conf_t *priv = NULL;
+
+        priv = THIS->private;
+        GF_ASSERT (priv);
+        GF_ASSERT (priv->store_txn_depth > 0);
+
+        if (--priv->store_txn_depth)
+                return;
+
+        glusterd_store_txn_cleanup (priv, _gf_true);
+}
+
 static void
 glusterd_replace_slash_with_hipen (char *str)
 {
@@ -885,11 +1244,19 @@ glusterd_store_volinfo (glusterd_volinfo_t *volinfo, glusterd_volinfo_ver_ac_t a
         if (ret)
                 goto out;
 
+        /* info, rbstate and brick files go in together */
+        glusterd_store_txn_begin ();
+
         ret = glusterd_store_perform_volume_store (volinfo);
-        if (ret)
+        if (!ret)
+                ret = glusterd_store_perform_rbstate_store (volinfo);
+
+        if (ret) {
+                glusterd_store_txn_abort ();
                 goto out;
+        }
 
-        ret = glusterd_store_perform_rbstate_store (volinfo);
+        ret = glusterd_store_txn_commit ();
         if (ret)
                 goto out;
 
@@ -984,26 +1351,102 @@ out:
 }
 
 
+/* Reads all of path into a NUL terminated buffer, so the store files are
+ * parsed in memory rather than one fscanf () at a time.
+ */
+int32_t
+glusterd_store_read_file (char *path, char **buf, size_t *len)
+{
+        int32_t         ret = -1;
+        int             fd = -1;
+        struct stat     st = {0,};
+        char            *data = NULL;
+        size_t          done = 0;
+        ssize_t         size = 0;
+
+        GF_ASSERT (path);
+        GF_ASSERT (buf);
+
+        fd = open (path, O_RDONLY);
+        if (fd == -1) {
+                gf_log ("", GF_LOG_ERROR, "Unable to open %s, errno: %d",
+                        path, errno);
+                goto out;
+        }
+
+        ret = fstat (fd, &st);
+        if (ret) {
+                gf_log ("", GF_LOG_ERROR, "Unable to stat %s, errno: %d",
+                        path, errno);
+                goto out;
+        }
+
+        data = GF_CALLOC (1, st.st_size + 1, gf_gld_mt_char);
+        if (!data) {
+                ret = -1;
+                goto out;
+        }
+
+        while (done < st.st_size) {
+                size = read (fd, data + done, st.st_size - done);
+                if (size < 0) {
+                        gf_log ("", GF_LOG_ERROR, "Unable to read %s, "
+                                "errno: %d", path, errno);
+                        ret = -1;
+                        goto out;
+                }
+                if (size == 0)
+                        break;
+                done += size;
+        }
+        data[done] = '\0';
+
+        *buf = data;
+        if (len)
+                *len = done;
+        data = NULL;
+        ret = 0;
+out:
+        if (fd != -1)
+                close (fd);
+        if (data)
+                GF_FREE (data);
+
+        return ret;
+}
+
 int
-glusterd_store_read_and_tokenize (FILE *file, char *str,
+glusterd_store_read_and_tokenize (glusterd_store_iter_t *iter,
                                   char **iter_key, char **iter_val,
                                   glusterd_store_op_errno_t *store_errno)
 {
         int32_t  ret = -1;
+        char     *str = NULL;
+        size_t   len = 0;
 
-        GF_ASSERT (file);
-        GF_ASSERT (str);
+        GF_ASSERT (iter);
         GF_ASSERT (iter_key);
         GF_ASSERT (iter_val);
         GF_ASSERT (store_errno);
 
-        ret = fscanf (file, "%s", str);
-        if (ret <= 0 || feof (file)) {
+        /* one whitespace separated word, as fscanf ("%s") would read */
+        while (*iter->pos && isspace (*iter->pos))
+                iter->pos++;
+
+        if (*iter->pos == '\0') {
                 ret = -1;
                 *store_errno = GD_STORE_EOF;
                 goto out;
         }
 
+        while (iter->pos[len] && !isspace (iter->pos[len]))
+                len++;
+
+        str = iter->scan_str;
+        memcpy (str, iter->pos, len);
+        str[len] = '\0';
+        iter->pos += len;
+
         *iter_key = strtok (str, "=");
         if (*iter_key == NULL) {
                 ret = -1;
@@ -1024,77 +1467,118 @@ out:
         return ret;
 }
 
-int32_t
-glusterd_store_retrieve_value (glusterd_store_handle_t *handle,
-                               char *key, char **value)
+static void
+glusterd_store_kv_drop (glusterd_store_handle_t *handle)
 {
-        int32_t         ret = -1;
-        char            *scan_str = NULL;
-        char            *iter_key = NULL;
-        char            *iter_val = NULL;
-        char            *free_str = NULL;
-        struct stat     st        = {0,};
+        if (handle->kv) {
+                dict_unref (handle->kv);
+                handle->kv = NULL;
+        }
+}
+
+/* Parses the whole file into handle->kv, the first value of a key wins */
+static int32_t
+glusterd_store_kv_load (glusterd_store_handle_t *handle)
+{
+        int32_t                   ret = -1;
+        glusterd_store_iter_t     *iter = NULL;
+        char                      *key = NULL;
+        char                      *value = NULL;
+        dict_t                    *kv = NULL;
         glusterd_store_op_errno_t store_errno = GD_STORE_SUCCESS;
 
-        GF_ASSERT (handle);
+        kv = dict_new ();
+        if (!kv)
+                goto out;
 
-        handle->fd = open (handle->path, O_RDWR);
+        ret = glusterd_store_iter_new (handle, &iter);
+        if (ret)
+                goto out;
 
-        if (!handle->read)
-                handle->read = fdopen (handle->fd, "r");
+        do {
+                ret = glusterd_store_iter_get_next (iter, &key, &value,
+                                                    &store_errno);
+                if (ret) {
+                        if ((store_errno == GD_STORE_KEY_NULL) ||
+                            (store_errno == GD_STORE_VALUE_NULL) ||
+                            (store_errno == GD_STORE_KEY_VALUE_NULL))
+                                continue;
+                        break;
+                }
 
-        if (!handle->read) {
-                gf_log ("", GF_LOG_ERROR, "Unable to open file %s errno: %d",
-                        handle->path, errno);
-                goto out;
-        }
+                if (dict_get (kv, key)) {
+                        GF_FREE (value);
+                } else if (dict_set_dynstr (kv, key, value)) {
+                        GF_FREE (value);
+                        GF_FREE (key);
+                        ret = -1;
+                        store_errno = GD_STORE_ENOMEM;
+                        break;
+                }
+                GF_FREE (key);
+                key = NULL;
+                value = NULL;
+        } while (1);
 
-        ret = fstat (handle->fd, &st);
-        if (ret < 0) {
-                gf_log ("glusterd", GF_LOG_WARNING,
-                        "stat on file failed");
-                ret = -1;
-                store_errno = GD_STORE_STAT_FAILED;
-                goto out;
-        }
+        glusterd_store_iter_destroy (iter);
 
-        scan_str = GF_CALLOC (1, st.st_size,
-                              gf_gld_mt_char);
-        if (scan_str == NULL) {
+        if (store_errno != GD_STORE_EOF) {
                 ret = -1;
-                store_errno = GD_STORE_ENOMEM;
                 goto out;
         }
 
-        free_str = scan_str;
+        glusterd_store_kv_drop (handle);
+        handle->kv = kv;
+        kv = NULL;
+        ret = 0;
+out:
+        if (kv)
+                dict_unref (kv);
 
-        do {
-                ret = glusterd_store_read_and_tokenize (handle->read, scan_str,
-                                                        &iter_key, &iter_val,
-                                                        &store_errno);
-                if (ret < 0) {
-                        goto out;
-                }
+        return ret;
+}
 
-                gf_log ("", GF_LOG_DEBUG, "key %s read", iter_key);
+/* Lookups are served from the keys of the file parsed once into the
+ * handle, until the file is replaced (it then has another inode).
+ */
+int32_t
+glusterd_store_retrieve_value (glusterd_store_handle_t *handle,
+                               char *key, char **value)
+{
+        int32_t         ret = -1;
+        char            *str = NULL;
+        struct stat     st  = {0,};
+
+        GF_ASSERT (handle);
+
+        ret = stat (handle->path, &st);
+        if (ret < 0) {
+                gf_log ("glusterd", GF_LOG_WARNING,
+                        "stat on file %s failed", handle->path);
+                goto out;
+        }
 
-                if (!strcmp (key, iter_key)) {
-                        gf_log ("", GF_LOG_DEBUG, "key %s found", key);
-                        ret = 0;
-                        if (iter_val)
-                                *value = gf_strdup (iter_val);
+        if (handle->kv && (handle->kv_ino != st.st_ino))
+                glusterd_store_kv_drop (handle);
+
+        if (!handle->kv) {
+                ret = glusterd_store_kv_load (handle);
+                if (ret)
                         goto out;
-                }
-        } while (1);
-out:
-        if (handle->fd > 0) {
-                close (handle->fd);
-                handle->read = NULL;
+                handle->kv_ino = st.st_ino;
         }
 
-        if (free_str)
-                GF_FREE (free_str);
+        ret = dict_get_str (handle->kv, key, &str);
+        if (ret) {
+                ret = -1;
+                goto out;
+        }
 
+        gf_log ("", GF_LOG_DEBUG, "key %s found", key);
+        *value = gf_strdup (str);
+        if (!*value)
+                ret = -1;
+out:
         return ret;
 }
 
@@ -1102,21 +1586,24 @@ int32_t
 glusterd_store_save_value (int fd, char *key, char *value)
 {
         int32_t         ret = -1;
-        FILE           *fp  = NULL;
+        struct iovec    vector[4];
+        ssize_t         len = 0;
 
         GF_ASSERT (fd > 0);
         GF_ASSERT (key);
         GF_ASSERT (value);
 
-        fp = fdopen (fd, "a+");
-        if (fp == NULL) {
-                gf_log ("", GF_LOG_WARNING, "fdopen failed.");
-                ret = -1;
-                goto out;
-        }
-
-        ret = fprintf (fp, "%s=%s\n", key, value);
-        if (ret < 0) {
+        vector[0].iov_base = key;
+        vector[0].iov_len  = strlen (key);
+        vector[1].iov_base = "=";
+        vector[1].iov_len  = 1;
+        vector[2].iov_base = value;
+        vector[2].iov_len  = strlen (value);
+        vector[3].iov_base = "\n";
+        vector[3].iov_len  = 1;
+
+        len = writev (fd, vector, 4);
+        if (len != (vector[0].iov_len + vector[2].iov_len + 2)) {
                 gf_log ("", GF_LOG_WARNING, "Unable to store key: %s,"
                         "value: %s, error: %s", key, value,
                         strerror (errno));
@@ -1124,15 +1611,6 @@ glusterd_store_save_value (int fd, char *key, char *value)
                 goto out;
         }
 
-        ret = fflush (fp);
-        if (feof (fp)) {
-                gf_log ("", GF_LOG_WARNING,
-                        "fflush failed, error: %s",
-                        strerror (errno));
-                ret = -1;
-                goto out;
-        }
-
         ret = 0;
 out:
 
@@ -1213,6 +1691,8 @@ glusterd_store_handle_destroy (glusterd_store_handle_t *handle)
                 goto out;
         }
 
+        glusterd_store_kv_drop (handle);
+
         GF_FREE (handle->path);
 
         GF_FREE (handle);
@@ -1232,6 +1712,7 @@ glusterd_store_uuid ()
         char            path[PATH_MAX] = {0,};
         int32_t         ret = -1;
         glusterd_store_handle_t *handle = NULL;
+        int             fd = -1;
 
         priv = THIS->private;
 
@@ -1252,12 +1733,12 @@ glusterd_store_uuid ()
                 handle = priv->handle;
         }
 
-        handle->fd = open (handle->path, O_RDWR | O_CREAT | O_TRUNC, 0644);
-        if (handle->fd <= 0) {
+        fd = glusterd_store_mkstemp (handle);
+        if (fd <= 0) {
                 ret = -1;
                 goto out;
         }
-        ret = glusterd_store_save_value (handle->fd, GLUSTERD_STORE_UUID_KEY,
+        ret = glusterd_store_save_value (fd, GLUSTERD_STORE_UUID_KEY,
                                          uuid_utoa (priv->uuid));
 
         if (ret) {
@@ -1266,12 +1747,12 @@ glusterd_store_uuid ()
                 goto out;
         }
 
-
+        ret = glusterd_store_rename_tmppath (handle);
 out:
-        if (handle->fd > 0) {
-                close (handle->fd);
-                handle->fd = 0;
-        }
+        if (ret && (fd > 0))
+                glusterd_store_unlink_tmppath (handle);
+        if (fd > 0)
+                close (fd);
         gf_log ("", GF_LOG_DEBUG, "Returning %d", ret);
         return ret;
 }
@@ -1326,7 +1807,7 @@ glusterd_store_iter_new (glusterd_store_handle_t  *shandle,
 {
         int32_t                 ret = -1;
         glusterd_store_iter_t   *tmp_iter = NULL;
-        int                     fd = -1;
+        size_t                  len = 0;
 
         GF_ASSERT (shandle);
         GF_ASSERT (iter);
@@ -1339,29 +1820,29 @@ glusterd_store_iter_new (glusterd_store_handle_t  *shandle,
                 goto out;
         }
 
-        fd = open (shandle->path, O_RDWR);
-
-        if (fd < 0) {
-                gf_log ("", GF_LOG_ERROR, "Unable to open %s, errno: %d",
-                        shandle->path, errno);
+        ret = glusterd_store_read_file (shandle->path, &tmp_iter->buf, &len);
+        if (ret)
                 goto out;
-        }
-
-        tmp_iter->fd = fd;
-
-        tmp_iter->file = fdopen (tmp_iter->fd, "r");
 
-        if (!tmp_iter->file) {
-                gf_log ("", GF_LOG_ERROR, "Unable to open file %s errno: %d",
-                        shandle->path, errno);
+        /* no word is longer than the file */
+        tmp_iter->scan_str = GF_CALLOC (1, len + 1, gf_gld_mt_char);
+        if (!tmp_iter->scan_str) {
+                ret = -1;
                 goto out;
         }
 
+        tmp_iter->pos = tmp_iter->buf;
         strncpy (tmp_iter->filepath, shandle->path, sizeof (tmp_iter->filepath));
         *iter = tmp_iter;
+        tmp_iter = NULL;
         ret = 0;
 
 out:
+        if (tmp_iter) {
+                if (tmp_iter->buf)
+                        GF_FREE (tmp_iter->buf);
+                GF_FREE (tmp_iter);
+        }
         gf_log ("", GF_LOG_DEBUG, "Returning with %d", ret);
         return ret;
 }
@@ -1406,42 +1887,19 @@ glusterd_store_iter_get_next (glusterd_store_iter_t *iter,
                               glusterd_store_op_errno_t *op_errno)
 {
         int32_t         ret = -1;
-        char            *scan_str = NULL;
-        char            *free_str = NULL;
         char            *iter_key = NULL;
         char            *iter_val = NULL;
-        struct stat     st        = {0,};
         glusterd_store_op_errno_t store_errno = GD_STORE_SUCCESS;
 
         GF_ASSERT (iter);
-        GF_ASSERT (iter->file);
+        GF_ASSERT (iter->buf);
         GF_ASSERT (key);
         GF_ASSERT (value);
 
-        ret = fstat (iter->fd, &st);
-        if (ret < 0) {
-                gf_log ("glusterd", GF_LOG_WARNING,
-                        "stat on file failed");
-                ret = -1;
-                store_errno = GD_STORE_STAT_FAILED;
-                goto out;
-        }
-
-        scan_str = GF_CALLOC (1, st.st_size,
-                              gf_gld_mt_char);
-        if (scan_str == NULL) {
-                ret = -1;
-                store_errno = GD_STORE_ENOMEM;
-                goto out;
-        }
-
         *key = NULL;
         *value = NULL;
 
-        free_str = scan_str;
-
-        ret = glusterd_store_read_and_tokenize (iter->file, scan_str,
-                                                &iter_key, &iter_val,
+        ret = glusterd_store_read_and_tokenize (iter, &iter_key, &iter_val,
                                                 &store_errno);
         if (ret < 0) {
                 goto out;
@@ -1456,7 +1914,7 @@ glusterd_store_iter_get_next (glusterd_store_iter_t *iter,
         *value = gf_strdup (iter_val);
 
         *key   = gf_strdup (iter_key);
-        if (!iter_key || !iter_val) {
+        if (!*key || !*value) {
                 ret = -1;
                 store_errno = GD_STORE_ENOMEM;
                 goto out;
@@ -1475,8 +1933,6 @@ out:
                         *value = NULL;
                 }
         }
-        if (free_str)
-                GF_FREE (free_str);
         if (op_errno)
                 *op_errno = store_errno;
 
@@ -1515,17 +1971,13 @@ glusterd_store_iter_destroy (glusterd_store_iter_t *iter)
         int32_t         ret = -1;
 
         GF_ASSERT (iter);
-        GF_ASSERT (iter->fd > 0);
-
-        ret = fclose (iter->file);
-
-        if (ret) {
-                gf_log ("", GF_LOG_ERROR, "Unable to close fd: %d, ret: %d, "
-                        "errno: %d" ,iter->fd, ret, errno);
-        }
 
+        GF_FREE (iter->buf);
+        GF_FREE (iter->scan_str);
         GF_FREE (iter);
 
+        ret = 0;
+
         return ret;
 }
 
@@ -2245,6 +2697,12 @@ glusterd_store_retrieve_peers (xlator_t *this)
         glusterd_for_each_entry (entry, dir);
 
         while (entry) {
+                /* left behind by a write glusterd did not finish */
+                if (glusterd_store_is_tmpname (entry->d_name)) {
+                        glusterd_for_each_entry (entry, dir);
+                        continue;
+                }
+
                 snprintf (filepath, PATH_MAX, "%s/%s", path, entry->d_name);
                 ret = glusterd_store_handle_retrieve (filepath, &shandle);
                 if (ret)
@@ -2341,6 +2799,62 @@ out:
         return ret;
 }
 
+/* Finishes the renames of a store transaction glusterd died in the middle
+ * of committing (see glusterd_store_txn_commit). A path whose .tmp is gone
+ * was renamed already.
+ */
+static int32_t
+glusterd_store_journal_replay (glusterd_conf_t *priv)
+{
+        int32_t         ret = 0;
+        char            journal[PATH_MAX] = {0,};
+        char            *buf = NULL;
+        char            *path = NULL;
+        char            *saveptr = NULL;
+        int             count = 0;
+
+        ret = snprintf (journal, sizeof (journal), "%s/%s", priv->workdir,
+                        GLUSTERD_STORE_JOURNAL);
+        if (ret >= sizeof (journal)) {
+                gf_log ("", GF_LOG_ERROR, "journal path too long under %s",
+                        priv->workdir);
+                ret = -1;
+                goto out;
+        }
+        ret = 0;
+
+        if (access (journal, F_OK))
+                goto out;
+
+        ret = glusterd_store_read_file (journal, &buf, NULL);
+        if (ret)
+                goto out;
+
+        for (path = strtok_r (buf, "\n", &saveptr); path;
+             path = strtok_r (NULL, "\n", &saveptr)) {
+                ret = glusterd_store_txn_add (priv, path);
+                if (ret)
+                        goto out;
+                count++;
+        }
+
+        ret = glusterd_store_txn_apply (priv);
+        if (ret)
+                goto out;
+
+        gf_log ("glusterd", GF_LOG_INFO, "completed the store update of %d "
+                "files interrupted at the last shutdown", count);
+
+        ret = unlink (journal);
+out:
+        glusterd_store_txn_cleanup (priv, _gf_false);
+        if (buf)
+                GF_FREE (buf);
+
+        gf_log ("", GF_LOG_DEBUG, "Returning %d", ret);
+        return ret;
+}
+
 int32_t
 glusterd_restore ()
 {
@@ -2349,6 +2863,10 @@ glusterd_restore ()
 
         this = THIS;
 
+        ret = glusterd_store_journal_replay (this->private);
+        if (ret)
+                goto out;
+
         ret = glusterd_store_retrieve_volumes (this);
 
         if (ret)
@@ -80,6 +80,12 @@ typedef enum glusterd_store_ver_ac_{
                 }\
         } while (0); \
 
+/* a file of a store transaction, renamed into place at commit */
+typedef struct glusterd_store_txn_entry_ {
+        struct list_head        list;
+        char                    *path;
+} glusterd_store_txn_entry_t;
+
 typedef enum {
         GD_STORE_SUCCESS,
         GD_STORE_KEY_NULL,
@@ -125,9 +131,36 @@ glusterd_store_delete_brick (glusterd_volinfo_t *volinfo,
 int32_t
 glusterd_store_handle_destroy (glusterd_store_handle_t *handle);
 
+int32_t
+glusterd_store_iter_new (glusterd_store_handle_t  *shandle,
+                         glusterd_store_iter_t  **iter);
+
+int32_t
+glusterd_store_iter_get_next (glusterd_store_iter_t *iter,
+                              char  **key, char **value,
+                              glusterd_store_op_errno_t *op_errno);
+
+int32_t
+glusterd_store_iter_destroy (glusterd_store_iter_t *iter);
+
 int32_t
 glusterd_restore ();
 
+void
+glusterd_store_txn_begin ();
+
+int32_t
+glusterd_store_txn_commit ();
+
+void
+glusterd_store_txn_abort ();
+
+int32_t
+glusterd_store_read_file (char *path, char **buf, size_t *len);
+
+gf_boolean_t
+glusterd_store_files_equal (const char *path1, const char *path2);
+
 void
 glusterd_perform_volinfo_version_action (glusterd_volinfo_t *volinfo,
                                          glusterd_volinfo_ver_ac_t ac);
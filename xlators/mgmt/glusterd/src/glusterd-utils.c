@@ -54,6 +54,7 @@
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <rpc/pmap_clnt.h>
+#include <locale.h>
 
 #ifdef GF_SOLARIS_HOST_OS
 #include <sys/sockio.h>
@@ -1258,6 +1259,83 @@ out:
         return ret;
 }
 
+/* sort(1), which used to order the info file before it was checksummed,
+ * collates by the locale of the environment and breaks ties bytewise.
+ * Keep to that so the checksum stays the same across peers.
+ */
+static locale_t glusterd_cksum_locale;
+
+static int
+glusterd_cksum_line_cmp (const void *a, const void *b)
+{
+        const char      *line1 = *(const char **)a;
+        const char      *line2 = *(const char **)b;
+        int             ret = 0;
+
+        if (glusterd_cksum_locale)
+                ret = strcoll_l (line1, line2, glusterd_cksum_locale);
+        if (!ret)
+                ret = strcmp (line1, line2);
+
+        return ret;
+}
+
+/* The checksum of the lines of data (modified in place) sorted */
+static int
+glusterd_sorted_lines_cksum (char *data, size_t len, uint32_t *cksum)
+{
+        int             ret = -1;
+        char            **lines = NULL;
+        char            *sorted = NULL;
+        char            *ptr = NULL;
+        int             count = 0;
+        int             i = 0;
+        size_t          off = 0;
+        size_t          linelen = 0;
+
+        if (!glusterd_cksum_locale)
+                glusterd_cksum_locale = newlocale (LC_COLLATE_MASK, "",
+                                                   (locale_t) 0);
+
+        for (ptr = data; ptr < data + len; ptr++)
+                if (*ptr == '\n')
+                        count++;
+        if (len && (data[len - 1] != '\n'))
+                count++;
+
+        lines = GF_CALLOC (count + 1, sizeof (*lines), gf_gld_mt_char);
+        sorted = GF_CALLOC (1, len + 2, gf_gld_mt_char);
+        if (!lines || !sorted)
+                goto out;
+
+        ptr = data;
+        for (i = 0; i < count; i++) {
+                lines[i] = ptr;
+                ptr = strchr (ptr, '\n');
+                if (!ptr)
+                        break;
+                *ptr++ = '\0';
+        }
+
+        qsort (lines, count, sizeof (*lines), glusterd_cksum_line_cmp);
+
+        for (i = 0; i < count; i++) {
+                linelen = strlen (lines[i]);
+                memcpy (sorted + off, lines[i], linelen);
+                off += linelen;
+                sorted[off++] = '\n';
+        }
+
+        ret = get_checksum_for_buf (sorted, off, cksum);
+out:
+        if (lines)
+                GF_FREE (lines);
+        if (sorted)
+                GF_FREE (sorted);
+
+        return ret;
+}
+
 int
 glusterd_volume_compute_cksum (glusterd_volinfo_t  *volinfo)
 {
@@ -1269,9 +1347,8 @@ glusterd_volume_compute_cksum (glusterd_volinfo_t  *volinfo)
         int                     fd = -1;
         uint32_t                cksum = 0;
         char                    buf[4096] = {0,};
-        char                    sort_filepath[PATH_MAX] = {0};
-        gf_boolean_t            unlink_sortfile = _gf_false;
-        int                     sort_fd = 0;
+        char                    *data = NULL;
+        size_t                  len = 0;
 
         GF_ASSERT (volinfo);
 
@@ -1294,29 +1371,17 @@ glusterd_volume_compute_cksum (glusterd_volinfo_t  *volinfo)
 
         snprintf (filepath, sizeof (filepath), "%s/%s", path,
                   GLUSTERD_VOLUME_INFO_FILE);
-        snprintf (sort_filepath, sizeof (sort_filepath), "/tmp/%s.XXXXXX",
-                  volinfo->volname);
-        sort_fd = mkstemp (sort_filepath);
-        if (sort_fd < 0) {
-                gf_log ("", GF_LOG_ERROR, "Could not generate temp file, "
-                        "reason: %s for volume: %s", strerror (errno),
-                        volinfo->volname);
-                goto out;
-        } else {
-                unlink_sortfile = _gf_true;
-        }
 
-        ret = runcmd ("sort", filepath, "-o", sort_filepath, NULL);
-        if (ret) {
-                gf_log ("", GF_LOG_ERROR, "failed to sort file %s to %s",
-                        filepath, sort_filepath);
+        /* sorted in memory, no sort(1) to fork for every volume */
+        ret = glusterd_store_read_file (filepath, &data, &len);
+        if (ret)
                 goto out;
-        }
-        ret = get_checksum_for_path (sort_filepath, &cksum);
+
+        ret = glusterd_sorted_lines_cksum (data, len, &cksum);
 
         if (ret) {
                 gf_log ("", GF_LOG_ERROR, "Unable to get checksum"
-                        " for path: %s", sort_filepath);
+                        " for path: %s", filepath);
                 goto out;
         }
 
@@ -1338,10 +1403,8 @@ glusterd_volume_compute_cksum (glusterd_volinfo_t  *volinfo)
 out:
         if (fd > 0)
                close (fd);
-        if (sort_fd > 0)
-               close (sort_fd);
-        if (unlink_sortfile)
-               unlink (sort_filepath);
+        if (data)
+               GF_FREE (data);
         gf_log ("", GF_LOG_DEBUG, "Returning with %d", ret);
 
         return ret;
@@ -2359,16 +2422,49 @@ out:
         return ret;
 }
 
+/* Squeezes repeated slashes out of a volfile path, so the path a client
+ * fetched (for a mount of server:/volume, say) compares equal to the one
+ * volgen wrote.
+ */
+void
+glusterd_volfile_path_normalize (char *path)
+{
+        char    *src = path;
+        char    *dst = path;
+
+        while (*src) {
+                *dst++ = *src;
+                if (*src == '/')
+                        while (*src == '/')
+                                src++;
+                else
+                        src++;
+        }
+        *dst = '\0';
+}
+
 int
 glusterd_check_generate_start_nfs ()
 {
-        int ret = -1;
+        int     ret = -1;
+        dict_t *changed = NULL;
 
-        ret = glusterd_create_nfs_volfile ();
+        changed = dict_new ();
+        if (!changed)
+                goto out;
+
+        ret = glusterd_create_nfs_volfile (changed);
         if (ret)
                 goto out;
 
         if (glusterd_is_nfs_started ()) {
+                /* it runs off the volfile it was started with */
+                if (!changed->count) {
+                        gf_log ("", GF_LOG_DEBUG, "nfs volfile unchanged, "
+                                "not restarting the nfs server");
+                        goto out;
+                }
+
                 ret = glusterd_nfs_server_stop ();
                 if (ret)
                         goto out;
@@ -2376,6 +2472,8 @@ glusterd_check_generate_start_nfs ()
 
         ret = glusterd_nfs_server_start ();
 out:
+        if (changed)
+                dict_unref (changed);
         return ret;
 }
 
@@ -161,6 +161,9 @@ glusterd_set_volume_status (glusterd_volinfo_t  *volinfo,
                             glusterd_volume_status status);
 int
 glusterd_check_generate_start_nfs (void);
+
+void
+glusterd_volfile_path_normalize (char *path);
 int32_t
 glusterd_volume_count_get (void);
 int32_t
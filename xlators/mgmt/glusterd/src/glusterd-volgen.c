@@ -42,6 +42,7 @@
 #include "glusterd-volgen.h"
 #include "glusterd-op-sm.h"
 #include "glusterd-utils.h"
+#include "glusterd-store.h"
 
 
 /* dispatch table for VOLUME SET
@@ -109,6 +110,8 @@ static struct volopt_map_entry glusterd_volopt_map[] = {
 
         {"cluster.lookup-unhashed",              "cluster/distribute", NULL, NULL, NO_DOC, 0    },
         {"cluster.min-free-disk",                "cluster/distribute", NULL, NULL, NO_DOC, 0    },
+        {"cluster.readdir-prefetch-subvols",     "cluster/distribute", NULL, NULL, NO_DOC, 0    },
+        {"cluster.readdir-prefetch-size",        "cluster/distribute", NULL, NULL, NO_DOC, 0    },
 
         {"cluster.entry-change-log",             "cluster/replicate",  NULL, NULL, NO_DOC, 0     },
         {"cluster.read-subvolume",               "cluster/replicate",  NULL, NULL, NO_DOC, 0    },
@@ -120,9 +123,11 @@ static struct volopt_map_entry glusterd_volopt_map[] = {
         {"cluster.self-heal-window-size",        "cluster/replicate",         "data-self-heal-window-size", NULL, DOC, 0},
         {"cluster.data-change-log",              "cluster/replicate",  NULL, NULL, NO_DOC, 0     },
         {"cluster.metadata-change-log",          "cluster/replicate",  NULL, NULL, NO_DOC, 0     },
+        {"cluster.compound-fops",                "cluster/replicate",  NULL, NULL, NO_DOC, 0     },
         {"cluster.data-self-heal-algorithm",     "cluster/replicate",         "data-self-heal-algorithm", NULL,DOC, 0},
 
         {"cluster.stripe-block-size",            "cluster/stripe",            "block-size", NULL, DOC, 0},
+        {"cluster.stripe-read-ahead",            "cluster/stripe",            "read-ahead", NULL, DOC, 0},
 
         {VKEY_DIAG_LAT_MEASUREMENT,              "debug/io-stats",     "latency-measurement", "off", NO_DOC, 0      },
         {"diagnostics.dump-fd-stats",            "debug/io-stats",     NULL, NULL, NO_DOC, 0     },
@@ -147,6 +152,14 @@ static struct volopt_map_entry glusterd_volopt_map[] = {
         {"performance.min-free-disk-limit",      "performance/quota",   NULL, NULL, NO_DOC, 0    },
 
         {"performance.write-behind-window-size", "performance/write-behind",  "cache-size", NULL, DOC},
+        {"performance.nl-cache-timeout",         "performance/nl-cache",      "timeout", NULL, DOC, 0},
+        {"performance.nl-cache-limit",           "performance/nl-cache",      "limit", NULL, DOC, 0},
+        {"performance.stat-prefetch-cache-size", "performance/stat-prefetch", "cache-size", NULL, DOC, 0},
+        {"performance.stat-prefetch-timeout",    "performance/stat-prefetch", "cache-timeout", NULL, DOC, 0},
+
+        {"storage.io-uring",                     "storage/posix",             "io-uring", NULL, DOC, 0},
+        {"storage.io-uring-queue-depth",         "storage/posix",             "io-uring-queue-depth", NULL, DOC, 0},
+        {"storage.gfid-handles",                 "storage/posix",             "gfid-handles", NULL, DOC, 0},
 
         {"network.frame-timeout",                "protocol/client",    NULL, NULL, NO_DOC, 0     },
         {"network.ping-timeout",                 "protocol/client",    NULL, NULL, NO_DOC, 0     },
@@ -157,17 +170,24 @@ static struct volopt_map_entry glusterd_volopt_map[] = {
 
         {"transport.keepalive",                   "protocol/server",           "transport.socket.keepalive", NULL, NO_DOC, 0},
         {"server.allow-insecure",                 "protocol/server",          "rpc-auth-allow-insecure", NULL, NO_DOC, 0},
+        {"server.outstanding-rpc-limit",          "protocol/server",          "rpc.outstanding-rpc-limit", NULL, DOC, 0},
+        {"server.fair-queue-limit",               "protocol/server",          "rpc.fair-queue-limit", NULL, DOC, 0},
+        {"server.fair-queue-weight-internal",     "protocol/server",          "rpc.fair-queue-weight-internal", NULL, DOC, 0},
+        {"server.fair-queue-weight-external",     "protocol/server",          "rpc.fair-queue-weight-external", NULL, DOC, 0},
+        {"server.internal-clients",               "protocol/server",          "rpc.internal-clients", NULL, DOC, 0},
 
         {"performance.write-behind",             "performance/write-behind",  "!perf", "on", NO_DOC, 0},
         {"performance.read-ahead",               "performance/read-ahead",    "!perf", "on", NO_DOC, 0},
         {"performance.io-cache",                 "performance/io-cache",      "!perf", "on", NO_DOC, 0},
         {"performance.quick-read",               "performance/quick-read",    "!perf", "on", NO_DOC, 0},
         {VKEY_PERF_STAT_PREFETCH,                "performance/stat-prefetch", "!perf", "on", NO_DOC, 0},
+        {"performance.nl-cache",                 "performance/nl-cache",      "!perf", "off", NO_DOC, 0},
         {"performance.client-io-threads",        "performance/io-threads",    "!perf", "off", NO_DOC, 0},
         {VKEY_MARKER_XTIME,                      "features/marker",           "xtime", "off", NO_DOC, OPT_FLAG_FORCE},
         {VKEY_MARKER_XTIME,                      "features/marker",           "!xtime", "off", NO_DOC, OPT_FLAG_FORCE},
 
         {"nfs.enable-ino32",                     "nfs/server",                "nfs.enable-ino32", NULL, GLOBAL_DOC, 0},
+        {"nfs.nameless-lookup",                  "nfs/server",                "nfs.nameless-lookup", NULL, GLOBAL_DOC, 0},
         {"nfs.mem-factor",                       "nfs/server",                "nfs.mem-factor", NULL, GLOBAL_DOC, 0},
         {"nfs.export-dirs",                      "nfs/server",                "nfs3.export-dirs", NULL, GLOBAL_DOC, 0},
         {"nfs.export-volumes",                   "nfs/server",                "nfs3.export-volumes", NULL, GLOBAL_DOC, 0},
@@ -175,6 +195,14 @@ static struct volopt_map_entry glusterd_volopt_map[] = {
         {"nfs.dynamic-volumes",                  "nfs/server",                "nfs.dynamic-volumes", NULL, GLOBAL_NO_DOC, 0},
         {"nfs.register-with-portmap",            "nfs/server",                "rpc.register-with-portmap", NULL, GLOBAL_DOC, 0},
         {"nfs.port",                             "nfs/server",                "nfs.port", NULL, GLOBAL_DOC, 0},
+        {"nfs.write-gather",                     "nfs/server",                "nfs3.write-gather", NULL, GLOBAL_DOC, 0},
+        {"nfs.write-gather-limit",               "nfs/server",                "nfs3.write-gather-limit", NULL, GLOBAL_DOC, 0},
+        {"nfs.readdir-cache",                    "nfs/server",                "nfs3.readdir-cache", NULL, GLOBAL_DOC, 0},
+        {"nfs.readdir-cache-limit",              "nfs/server",                "nfs3.readdir-cache-limit", NULL, GLOBAL_DOC, 0},
+        {"nfs.drc",                              "nfs/server",                "rpc.drc", NULL, GLOBAL_DOC, 0},
+        {"nfs.outstanding-rpc-limit",            "nfs/server",                "rpc.outstanding-rpc-limit", NULL, GLOBAL_DOC, 0},
+        {"nfs.drc-size",                         "nfs/server",                "rpc.drc-size", NULL, GLOBAL_DOC, 0},
+        {"nfs.drc-limit",                        "nfs/server",                "rpc.drc-limit", NULL, GLOBAL_DOC, 0},
 
         {"nfs.rpc-auth-unix",                    "nfs/server",                "!rpc-auth.auth-unix.*", NULL, DOC, 0},
         {"nfs.rpc-auth-null",                    "nfs/server",                "!rpc-auth.auth.null.*", NULL, DOC, 0},
@@ -192,6 +220,7 @@ static struct volopt_map_entry glusterd_volopt_map[] = {
         {VKEY_FEATURES_QUOTA,                    "features/marker",           "quota", "off", NO_DOC, OPT_FLAG_FORCE},
         {VKEY_FEATURES_LIMIT_USAGE,              "features/quota",            "limit-set", NULL, NO_DOC, 0},
         {"features.quota-timeout",               "features/quota",            "timeout", "0", DOC, 0},
+        {"features.quota-flush-interval",        "features/marker",           "quota-flush-interval", NULL, DOC, 0},
         {NULL,                                                                }
 };
 
@@ -1061,8 +1090,12 @@ volgen_graph_merge_sub (volgen_graph_t *dgraph, volgen_graph_t *sgraph)
         return 0;
 }
 
+/* Writes the volfile only when its content changes, adding filename to
+ * changed (when given) if it did: the processes which fetched any other
+ * volfile need not be told to fetch it again.
+ */
 static int
-volgen_write_volfile (volgen_graph_t *graph, char *filename)
+volgen_write_volfile (volgen_graph_t *graph, char *filename, dict_t *changed)
 {
         char *ftmp = NULL;
         FILE *f = NULL;
@@ -1084,11 +1117,25 @@ volgen_write_volfile (volgen_graph_t *graph, char *filename)
                 goto error;
         f = NULL;
 
+        if (glusterd_store_files_equal (ftmp, filename)) {
+                gf_log ("", GF_LOG_DEBUG, "volfile %s unchanged", filename);
+                unlink (ftmp);
+                GF_FREE (ftmp);
+
+                return 0;
+        }
+
         if (rename (ftmp, filename) == -1)
                 goto error;
 
         GF_FREE (ftmp);
 
+        if (changed) {
+                glusterd_volfile_path_normalize (filename);
+                if (dict_set_str (changed, filename, ""))
+                        goto error;
+        }
+
         return 0;
 
  error:
@@ -2416,7 +2463,8 @@ out:
 
 static int
 glusterd_generate_brick_volfile (glusterd_volinfo_t *volinfo,
-                                 glusterd_brickinfo_t *brickinfo)
+                                 glusterd_brickinfo_t *brickinfo,
+                                 dict_t *changed)
 {
         volgen_graph_t graph = {0,};
         char    filename[PATH_MAX] = {0,};
@@ -2429,7 +2477,7 @@ glusterd_generate_brick_volfile (glusterd_volinfo_t *volinfo,
 
         ret = build_server_graph (&graph, volinfo, NULL, brickinfo->path);
         if (!ret)
-                ret = volgen_write_volfile (&graph, filename);
+                ret = volgen_write_volfile (&graph, filename, changed);
 
         volgen_graph_free (&graph);
 
@@ -2450,8 +2498,8 @@ get_vol_tstamp_file (char *filename, glusterd_volinfo_t *volinfo)
                  PATH_MAX - strlen(filename) - 1);
 }
 
-int
-generate_brick_volfiles (glusterd_volinfo_t *volinfo)
+static int
+volgen_generate_brick_volfiles (glusterd_volinfo_t *volinfo, dict_t *changed)
 {
         glusterd_brickinfo_t    *brickinfo = NULL;
         char                     tstamp_file[PATH_MAX] = {0,};
@@ -2492,7 +2540,8 @@ generate_brick_volfiles (glusterd_volinfo_t *volinfo)
                         "Found a brick - %s:%s", brickinfo->hostname,
                         brickinfo->path);
 
-                ret = glusterd_generate_brick_volfile (volinfo, brickinfo);
+                ret = glusterd_generate_brick_volfile (volinfo, brickinfo,
+                                                       changed);
                 if (ret)
                         goto out;
 
@@ -2505,6 +2554,12 @@ out:
         return ret;
 }
 
+int
+generate_brick_volfiles (glusterd_volinfo_t *volinfo)
+{
+        return volgen_generate_brick_volfiles (volinfo, NULL);
+}
+
 static void
 get_client_filepath (char *filename, glusterd_volinfo_t *volinfo)
 {
@@ -2534,7 +2589,7 @@ get_rdma_client_filepath (char *filename, glusterd_volinfo_t *volinfo)
 }
 
 static int
-generate_client_volfile (glusterd_volinfo_t *volinfo)
+generate_client_volfile (glusterd_volinfo_t *volinfo, dict_t *changed)
 {
         volgen_graph_t graph = {0,};
         char    filename[PATH_MAX] = {0,};
@@ -2554,7 +2609,7 @@ generate_client_volfile (glusterd_volinfo_t *volinfo)
 
         ret = build_client_graph (&graph, volinfo, dict);
         if (!ret)
-                ret = volgen_write_volfile (&graph, filename);
+                ret = volgen_write_volfile (&graph, filename, changed);
 
         volgen_graph_free (&graph);
 
@@ -2570,7 +2625,8 @@ generate_client_volfile (glusterd_volinfo_t *volinfo)
 
                 ret = build_client_graph (&graph, volinfo, dict);
                 if (!ret)
-                        ret = volgen_write_volfile (&graph, filename);
+                        ret = volgen_write_volfile (&graph, filename,
+                                                    changed);
 
                 volgen_graph_free (&graph);
 
@@ -2585,39 +2641,61 @@ int
 glusterd_create_rb_volfiles (glusterd_volinfo_t *volinfo,
                              glusterd_brickinfo_t *brickinfo)
 {
-        int ret = -1;
+        int     ret = -1;
+        dict_t *changed = NULL;
+
+        changed = dict_new ();
+        if (!changed)
+                goto out;
 
-        ret = glusterd_generate_brick_volfile (volinfo, brickinfo);
+        ret = glusterd_generate_brick_volfile (volinfo, brickinfo, changed);
         if (!ret)
-                ret = generate_client_volfile (volinfo);
+                ret = generate_client_volfile (volinfo, changed);
         if (!ret)
-                ret = glusterd_fetchspec_notify (THIS);
+                ret = glusterd_fetchspec_notify_changed (THIS, changed);
 
+        dict_unref (changed);
+out:
         return ret;
 }
 
+/* Regenerates the volfiles of the volume, and has only the processes
+ * whose volfile changed fetch it again (and reconfigure, unless the
+ * graph itself changed). A volume set touching client side options
+ * only leaves every brick alone.
+ */
 int
 glusterd_create_volfiles_and_notify_services (glusterd_volinfo_t *volinfo)
 {
-        int ret = -1;
+        int     ret = -1;
+        dict_t *changed = NULL;
 
-        ret = generate_brick_volfiles (volinfo);
+        changed = dict_new ();
+        if (!changed)
+                goto out;
+
+        ret = volgen_generate_brick_volfiles (volinfo, changed);
         if (ret) {
                 gf_log ("", GF_LOG_ERROR,
                         "Could not generate volfiles for bricks");
                 goto out;
         }
 
-        ret = generate_client_volfile (volinfo);
+        ret = generate_client_volfile (volinfo, changed);
         if (ret) {
                 gf_log ("", GF_LOG_ERROR,
                         "Could not generate volfile for client");
                 goto out;
         }
 
-        ret = glusterd_fetchspec_notify (THIS);
+        gf_log ("", GF_LOG_DEBUG, "%d volfiles of %s changed",
+                changed->count, volinfo->volname);
+
+        ret = glusterd_fetchspec_notify_changed (THIS, changed);
 
 out:
+        if (changed)
+                dict_unref (changed);
         return ret;
 }
 
@@ -2635,7 +2713,7 @@ glusterd_get_nfs_filepath (char *filename)
 }
 
 int
-glusterd_create_nfs_volfile ()
+glusterd_create_nfs_volfile (dict_t *changed)
 {
         volgen_graph_t graph = {0,};
         char    filename[PATH_MAX] = {0,};
@@ -2645,7 +2723,7 @@ glusterd_create_nfs_volfile ()
 
         ret = build_nfs_graph (&graph, NULL);
         if (!ret)
-                ret = volgen_write_volfile (&graph, filename);
+                ret = volgen_write_volfile (&graph, filename, changed);
 
         volgen_graph_free (&graph);
 
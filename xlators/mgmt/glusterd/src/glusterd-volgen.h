@@ -48,7 +48,7 @@ int glusterd_create_volfiles_and_notify_services (glusterd_volinfo_t *volinfo);
 
 void glusterd_get_nfs_filepath (char *filename);
 
-int glusterd_create_nfs_volfile ();
+int glusterd_create_nfs_volfile (dict_t *changed);
 
 int glusterd_delete_volfile (glusterd_volinfo_t *volinfo,
                              glusterd_brickinfo_t *brickinfo);
@@ -127,6 +127,38 @@ glusterd_fetchspec_notify (xlator_t *this)
         return ret;
 }
 
+/* Tells only the processes which fetched one of the volfiles in changed
+ * (keyed by path) to fetch it again. A connection glusterd has not seen
+ * fetch anything (it was up before glusterd restarted) is always told.
+ */
+int
+glusterd_fetchspec_notify_changed (xlator_t *this, dict_t *changed)
+{
+        glusterd_conf_t *priv  = NULL;
+        rpc_transport_t *trans = NULL;
+        int              count = 0;
+
+        priv = this->private;
+
+        if (!changed || !changed->count)
+                goto out;
+
+        list_for_each_entry (trans, &priv->xprt_list, list) {
+                if (trans->xl_private &&
+                    !dict_get (changed, trans->xl_private))
+                        continue;
+
+                rpcsvc_callback_submit (priv->rpc, trans, &glusterd_cbk_prog,
+                                        GF_CBK_FETCHSPEC, NULL, 0);
+                count++;
+        }
+
+out:
+        gf_log (this->name, GF_LOG_DEBUG, "%d processes asked to refetch "
+                "their volfile", count);
+        return 0;
+}
+
 int
 glusterd_priv (xlator_t *this)
 {
@@ -184,6 +216,10 @@ glusterd_rpcsvc_notify (rpcsvc_t *rpc, void *xl, rpcsvc_event_t event,
         case RPCSVC_EVENT_DISCONNECT:
         {
                 list_del (&xprt->list);
+                if (xprt->xl_private) {
+                        GF_FREE (xprt->xl_private);
+                        xprt->xl_private = NULL;
+                }
                 pmap_registry_remove (this, 0, NULL, GF_PMAP_PORT_NONE, xprt);
                 break;
         }
@@ -692,6 +728,7 @@ init (xlator_t *this)
         GF_VALIDATE_OR_GOTO(this->name, conf, out);
         INIT_LIST_HEAD (&conf->peers);
         INIT_LIST_HEAD (&conf->volumes);
+        INIT_LIST_HEAD (&conf->store_txn);
         pthread_mutex_init (&conf->mutex, NULL);
         conf->rpc = rpc;
         conf->gfs_mgmt = &glusterd_glusterfs_3_1_mgmt_prog;
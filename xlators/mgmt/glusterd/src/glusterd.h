@@ -83,8 +83,9 @@ typedef enum glusterd_op_ {
 
 
 struct glusterd_store_iter_ {
-        int     fd;
-        FILE    *file;
+        char    *buf;           /* whole file, read once */
+        char    *pos;
+        char    *scan_str;
         char    filepath[PATH_MAX];
 };
 
@@ -107,6 +108,8 @@ typedef struct {
         struct list_head  volumes;
         struct list_head  xprt_list;
         glusterd_store_handle_t *handle;
+        struct list_head  store_txn;    /* renames awaiting txn commit */
+        int               store_txn_depth;
         gf_timer_t *timer;
         glusterd_sm_tr_log_t op_sm_log;
         struct rpc_clnt_program *gfs_mgmt;
@@ -246,6 +249,7 @@ enum glusterd_vol_comp_status_ {
 #define GLUSTERD_VOLUME_RBSTATE_FILE "rbstate"
 #define GLUSTERD_BRICK_INFO_DIR "bricks"
 #define GLUSTERD_CKSUM_FILE "cksum"
+#define GLUSTERD_STORE_JOURNAL "store.journal"
 
 /*All definitions related to replace brick */
 #define RB_PUMP_START_CMD       "trusted.glusterfs.pump.start"
@@ -486,6 +490,9 @@ glusterd_xfer_cli_deprobe_resp (rpcsvc_request_t *req, int32_t op_ret,
 int
 glusterd_fetchspec_notify (xlator_t *this);
 
+int
+glusterd_fetchspec_notify_changed (xlator_t *this, dict_t *changed);
+
 int
 glusterd_add_volume_detail_to_dict (glusterd_volinfo_t *volinfo,
                                     dict_t  *volumes, int   count);
@@ -224,8 +224,10 @@ nfs_loc_fill (loc_t *loc, inode_t *inode, inode_t *parent, char *path)
         loc->name = strrchr (loc->path, '/');
         if (loc->name)
                 loc->name++;
-        else
+        else if (strncmp (loc->path, INODE_GFID_PATH_PREFIX,
+                          strlen (INODE_GFID_PATH_PREFIX)))
                 goto loc_wipe;
+        /* else an inode known by its gfid alone, no name */
 
         ret = 0;
 loc_wipe:
@@ -249,12 +251,12 @@ nfs_inode_loc_fill (inode_t *inode, loc_t *loc)
         if ((inode) && (inode->ino == 1))
                 goto ignore_parent;
 
+        /* no parent for an inode linked by a nameless lookup, its path
+           is then "<gfid:...>" */
         parent = inode_parent (inode, 0, NULL);
-        if (!parent)
-                goto err;
 
 ignore_parent:
-        ret = inode_path (inode, NULL, &resolvedpath);
+        ret = inode_anchored_path (inode, NULL, &resolvedpath);
         if (ret < 0)
                 goto err;
 
@@ -317,7 +319,7 @@ nfs_parent_inode_loc_fill (inode_t *parent, inode_t *entryinode, char *entry,
         if ((!parent) || (!entry) || (!loc) || (!entryinode))
                 return ret;
 
-        ret = inode_path (parent, entry, &path);
+        ret = inode_anchored_path (parent, entry, &path);
         if (ret < 0)
                 goto err;
 
@@ -379,7 +381,7 @@ nfs_entry_loc_fill (inode_table_t *itable, uuid_t pargfid, char *entry,
                 goto err;
         }
 
-        ret = inode_path (parent, entry, &resolvedpath);
+        ret = inode_anchored_path (parent, entry, &resolvedpath);
         if (ret < 0) {
                 ret = -3;
                 goto err;
@@ -43,6 +43,10 @@ enum gf_nfs_mem_types_ {
         gf_nfs_mt_mnt3_resolve,
         gf_nfs_mt_mnt3_export,
         gf_nfs_mt_inode_q,
+        gf_nfs_mt_nfs3_wgather,
+        gf_nfs_mt_nfs3_wbatch,
+        gf_nfs_mt_nfs3_rddir,
+        gf_nfs_mt_nfs3_rdbatch,
         gf_nfs_mt_end
 };
 #endif
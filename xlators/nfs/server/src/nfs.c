@@ -40,6 +40,7 @@
 #include "nfs3.h"
 #include "nfs-mem-types.h"
 #include "nfs3-helpers.h"
+#include "statedump.h"
 
 /* Every NFS version must call this function with the init function
  * for its particular version.
@@ -373,6 +374,7 @@ nfs_init_subvolumes (struct nfs_state *nfs, xlator_list_t *cl)
         }
 
         LOCK_INIT (&nfs->svinitlock);
+        LOCK_INIT (&nfs->resolvelock);
         nfs->initedxl = GF_CALLOC (svcount, sizeof (xlator_t *),
                                    gf_nfs_mt_xlator_t );
         if (!nfs->initedxl) {
@@ -563,6 +565,26 @@ nfs_init_state (xlator_t *this)
                         nfs->enable_ino32 = 1;
         }
 
+        nfs->nameless_lookup = 0;
+        if (dict_get (this->options, "nfs.nameless-lookup")) {
+                ret = dict_get_str (this->options, "nfs.nameless-lookup",
+                                    &optstr);
+                if (ret < 0) {
+                        gf_log (GF_NFS, GF_LOG_ERROR, "Failed to parse dict");
+                        goto free_foppool;
+                }
+
+                ret = gf_string2boolean (optstr, &boolt);
+                if (ret < 0) {
+                        gf_log (GF_NFS, GF_LOG_ERROR, "Failed to parse bool "
+                                "string");
+                        goto free_foppool;
+                }
+
+                if (boolt == _gf_true)
+                        nfs->nameless_lookup = 1;
+        }
+
         if (dict_get (this->options, "nfs.port")) {
                 ret = dict_get_str (this->options, "nfs.port",
                                     &optstr);
@@ -665,6 +687,17 @@ nfs_init_state (xlator_t *this)
                 }
         }
 
+        /* rpcsvc leaves the limit off, NFS clients do not lock through
+           the connection and are held to it by default */
+        if (!dict_get (this->options, "rpc.outstanding-rpc-limit")) {
+                ret = dict_set_str (this->options, "rpc.outstanding-rpc-limit",
+                                    GF_NFS_DEFAULT_OUTSTANDING_RPC_LIMIT);
+                if (ret == -1) {
+                        gf_log (GF_NFS, GF_LOG_ERROR, "dict_set_str error");
+                        goto free_foppool;
+                }
+        }
+
         nfs->rpcsvc =  rpcsvc_init (this, this->ctx, this->options);
         if (!nfs->rpcsvc) {
                 ret = -1;
@@ -811,10 +844,61 @@ nfs_forget (xlator_t *this, inode_t *inode)
         return 0;
 }
 
+int
+nfs_priv (xlator_t *this)
+{
+        struct nfs_state        *nfs = NULL;
+        struct nfs_initer_list  *version = NULL;
+        char                    key_prefix[GF_DUMP_MAX_BUF_LEN];
+        char                    key[GF_DUMP_MAX_BUF_LEN];
+
+        if (!this || !this->private)
+                return 0;
+
+        nfs = (struct nfs_state *)this->private;
+
+        snprintf (key_prefix, GF_DUMP_MAX_BUF_LEN, "%s.%s", this->type,
+                  this->name);
+        gf_proc_dump_add_section (key_prefix);
+
+        LOCK (&nfs->resolvelock);
+        {
+                gf_proc_dump_build_key (key, key_prefix, "nameless_hits");
+                gf_proc_dump_write (key, "%"PRIu64, nfs->nameless_hits);
+                gf_proc_dump_build_key (key, key_prefix, "nameless_misses");
+                gf_proc_dump_write (key, "%"PRIu64, nfs->nameless_misses);
+                gf_proc_dump_build_key (key, key_prefix, "hard_resolves");
+                gf_proc_dump_write (key, "%"PRIu64, nfs->hard_resolves);
+                gf_proc_dump_build_key (key, key_prefix, "hard_dirs_read");
+                gf_proc_dump_write (key, "%"PRIu64, nfs->hard_dirs_read);
+                gf_proc_dump_build_key (key, key_prefix, "hard_entries_read");
+                gf_proc_dump_write (key, "%"PRIu64, nfs->hard_entries_read);
+        }
+        UNLOCK (&nfs->resolvelock);
+
+        list_for_each_entry (version, &nfs->versions, list) {
+                if ((version->program) &&
+                    (version->program->prognum == NFS_PROGRAM) &&
+                    (version->program->progver == NFS_V3))
+                        nfs3_rdcache_priv_dump (version->program->private,
+                                                key_prefix);
+        }
+
+        rpcsvc_drc_priv_dump (nfs->rpcsvc);
+        rpcsvc_fq_priv_dump (nfs->rpcsvc);
+
+        return 0;
+}
+
+
 struct xlator_cbks cbks = {
         .forget      = nfs_forget,
 };
 
+struct xlator_dumpops dumpops = {
+        .priv        = nfs_priv,
+};
+
 struct xlator_fops fops = { };
 
 /* TODO: If needed, per-volume options below can be extended to be export
@@ -835,6 +919,37 @@ struct volume_options options[] = {
                          " to the Gluster NFSv3 server. Must be a multiple of"
                          " 4KiB."
         },
+        { .key  = {"nfs3.write-gather"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "on",
+          .description = "Buffer adjacent UNSTABLE writes of a file and "
+                         "write them to the volume together, on COMMIT, "
+                         "READ or SETATTR of the file, after a second, or "
+                         "when nfs3.write-gather-limit is reached. Exports "
+                         "with trusted-write set are not gathered."
+        },
+        { .key  = {"nfs3.write-gather-limit"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "64MB",
+          .description = "Total size of the buffers holding UNSTABLE "
+                         "writes, counted in whole buffers of the iobuf "
+                         "page size. Beyond it, writes are acknowledged only "
+                         "after they reach the volume."
+        },
+        { .key  = {"nfs3.readdir-cache"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "on",
+          .description = "Keep the entries read for READDIR and READDIRPLUS "
+                         "requests for a few seconds, share them between "
+                         "clients listing the same directory and read the "
+                         "next batch of entries ahead of the client."
+        },
+        { .key  = {"nfs3.readdir-cache-limit"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "32MB",
+          .description = "Memory used by the directory entries the server "
+                         "keeps for READDIR and READDIRPLUS."
+        },
         { .key  = {"nfs3.readdir-size"},
           .type = GF_OPTION_TYPE_SIZET,
           .description = "Size in which the client should issue directory "
@@ -1009,6 +1124,13 @@ struct volume_options options[] = {
                          "32-bit inode numbers instead. Disabled by default so "
                          "NFS returns 64-bit inode numbers by default."
         },
+        { .key  = {"nfs.nameless-lookup"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .description = "Resolve file handles missing from the inode table "
+                         "by a lookup of their gfid alone before crawling the "
+                         "directories from the root. Needs storage.gfid-"
+                         "handles on every brick of the volume, off by default."
+        },
         { .key  = {"rpc.register-with-portmap"},
           .type = GF_OPTION_TYPE_BOOL,
           .description = "For systems that need to run multiple nfs servers, "
@@ -1016,6 +1138,70 @@ struct volume_options options[] = {
                          "portmap service. Use this option to turn off portmap "
                          "registration for Gluster NFS. On by default"
         },
+        { .key  = {"rpc.drc"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "on",
+          .description = "Keep a duplicate request cache so that NFS "
+                         "retransmits of calls still being served are "
+                         "dropped, and retransmits of modifying calls already "
+                         "answered get the cached reply instead of being "
+                         "executed again."
+        },
+        { .key  = {"rpc.drc-size"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 65536,
+          .default_value = "128",
+          .description = "Number of replies the duplicate request cache keeps "
+                         "for every client."
+        },
+        { .key  = {"rpc.drc-limit"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "32MB",
+          .description = "Total size of the replies the duplicate request "
+                         "cache keeps for all clients together. The least "
+                         "recently used ones are dropped beyond it."
+        },
+        { .key  = {"rpc.outstanding-rpc-limit"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 65536,
+          .default_value = "64",
+          .description = "Number of calls a client may have outstanding. "
+                         "Beyond it, the server stops reading from the "
+                         "client until half of them have been answered. "
+                         "0 disables the limit."
+        },
+        { .key  = {"rpc.fair-queue-limit"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 65536,
+          .default_value = "0",
+          .description = "Number of calls served at once. Calls beyond it "
+                         "are queued per client and served in a weighted "
+                         "round robin. 0 disables fair queuing."
+        },
+        { .key  = {"rpc.fair-queue-weight-internal"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 1024,
+          .default_value = "1",
+          .description = "Calls served in a row for a client listed in "
+                         "rpc.internal-clients."
+        },
+        { .key  = {"rpc.fair-queue-weight-external"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 1024,
+          .default_value = "4",
+          .description = "Calls served in a row for any other client."
+        },
+        { .key  = {"rpc.internal-clients"},
+          .type = GF_OPTION_TYPE_STR,
+          .description = "Comma separated addresses, wildcards allowed, of "
+                         "the clients weighted as internal by the fair "
+                         "queue, such as rebalance or self-heal crawlers."
+        },
         { .key  = {"nfs.port"},
           .type = GF_OPTION_TYPE_INT,
           .description = "Use this option on systems that need Gluster NFS to "
@@ -42,6 +42,8 @@
 #define GF_NFS_MIN_MEMFACTOR            1
 #define GF_NFS_MAX_MEMFACTOR            30
 
+#define GF_NFS_DEFAULT_OUTSTANDING_RPC_LIMIT    "64"
+
 #define GF_NFS_DVM_ON                   1
 #define GF_NFS_DVM_OFF                  2
 
@@ -74,8 +76,21 @@ struct nfs_state {
         int                     subvols_started;
         int                     dynamicvolumes;
         int                     enable_ino32;
+        int                     nameless_lookup;
         unsigned int            override_portnum;
         int                     allow_insecure;
+
+        /* NFSv3 file handle resolution of gfids missing from the inode
+         * table: by a nameless lookup first if nfs.nameless-lookup is on,
+         * by crawling the directories from the root otherwise or when that
+         * fails.
+         */
+        gf_lock_t               resolvelock;
+        uint64_t                nameless_hits;
+        uint64_t                nameless_misses;
+        uint64_t                hard_resolves;
+        uint64_t                hard_dirs_read;
+        uint64_t                hard_entries_read;
 };
 
 #define gf_nfs_dvm_on(nfsstt)   (((struct nfs_state *)nfsstt)->dynamicvolumes == GF_NFS_DVM_ON)
@@ -83,6 +98,7 @@ struct nfs_state {
 #define __gf_nfs_enable_ino32(nfsstt)     (((struct nfs_state *)nfsstt)->enable_ino32)
 #define gf_nfs_this_private     ((struct nfs_state *)((xlator_t *)THIS)->private)
 #define gf_nfs_enable_ino32()     (__gf_nfs_enable_ino32(gf_nfs_this_private))
+#define gf_nfs_nameless_lookup(nfsstt)  (((struct nfs_state *)nfsstt)->nameless_lookup)
 
 /* We have one gid more than the glusterfs maximum since we pass the primary
  * gid as the first element of the array.
@@ -36,6 +36,7 @@
 #include "nfs-mem-types.h"
 #include "iatt.h"
 #include "common-utils.h"
+#include "statedump.h"
 #include <string.h>
 
 extern int
@@ -1937,6 +1938,1217 @@ out:
 }
 
 
+/* UNSTABLE write gathering.
+ *
+ * An UNSTABLE write that is adjacent to the open batch of its file is
+ * copied into that batch and acknowledged right away. A batch is closed
+ * when it is full, when a write does not follow on, on COMMIT, READ or
+ * SETATTR of the file, after GF_NFS3_WGATHER_TIMEOUT seconds, or when
+ * the iobufs of all batches hold more than nfs3->wgather_limit bytes, in
+ * which case the write is only acknowledged once its batch has been
+ * written. The error of a failed flush is kept on the file and makes its
+ * next COMMIT fail. It is dropped when the file is removed, or after
+ * GF_NFS3_WGATHER_ERROR_TIMEOUT seconds without a COMMIT.
+ */
+static struct nfs3_wgather *
+__nfs3_wgather_get (struct nfs3_state *nfs3, inode_t *inode)
+{
+        struct nfs3_wgather     *wg = NULL;
+        int                     bucket = 0;
+
+        bucket = ((uintptr_t)inode >> 6) % GF_NFS3_WGATHER_BUCKETS;
+        list_for_each_entry (wg, &nfs3->wgather_table[bucket], hash) {
+                if (wg->inode == inode)
+                        return wg;
+        }
+
+        return NULL;
+}
+
+
+static struct nfs3_wgather *
+__nfs3_wgather_new (struct nfs3_state *nfs3, nfs3_call_state_t *cs)
+{
+        struct nfs3_wgather     *wg = NULL;
+        int                     bucket = 0;
+
+        wg = GF_CALLOC (1, sizeof (*wg), gf_nfs_mt_nfs3_wgather);
+        if (!wg)
+                return NULL;
+
+        wg->nfs3 = nfs3;
+        wg->inode = inode_ref (cs->fd->inode);
+        wg->fd = fd_ref (cs->fd);
+        wg->vol = cs->vol;
+        INIT_LIST_HEAD (&wg->batches);
+
+        bucket = ((uintptr_t)wg->inode >> 6) % GF_NFS3_WGATHER_BUCKETS;
+        list_add (&wg->hash, &nfs3->wgather_table[bucket]);
+
+        return wg;
+}
+
+
+static void
+nfs3_wgather_destroy (struct nfs3_wgather *wg)
+{
+        if (!wg)
+                return;
+
+        fd_unref (wg->fd);
+        inode_unref (wg->inode);
+        GF_FREE (wg);
+}
+
+
+static struct nfs3_wbatch *
+__nfs3_wgather_tail (struct nfs3_wgather *wg)
+{
+        struct nfs3_wbatch      *batch = NULL;
+
+        if (list_empty (&wg->batches))
+                return NULL;
+
+        batch = list_entry (wg->batches.prev, struct nfs3_wbatch, list);
+        if (batch->closed)
+                return NULL;
+
+        return batch;
+}
+
+
+/* Close the open batch of @wg, if any, and return the last batch. */
+static struct nfs3_wbatch *
+__nfs3_wgather_close (struct nfs3_wgather *wg)
+{
+        struct nfs3_wbatch      *batch = NULL;
+
+        if (list_empty (&wg->batches))
+                return NULL;
+
+        batch = list_entry (wg->batches.prev, struct nfs3_wbatch, list);
+        batch->closed = 1;
+
+        return batch;
+}
+
+
+/* Queue the oldest batch of @wg on @kick if it can be written now, that is
+ * when no other batch of the file is being written.
+ */
+static void
+__nfs3_wgather_pick (struct nfs3_wgather *wg, struct list_head *kick)
+{
+        struct nfs3_wbatch      *batch = NULL;
+
+        if (wg->flushing || list_empty (&wg->batches))
+                return;
+
+        batch = list_entry (wg->batches.next, struct nfs3_wbatch, list);
+        if (!batch->closed)
+                return;
+
+        wg->flushing = 1;
+        list_add_tail (&batch->kickq, kick);
+}
+
+
+static void
+nfs3_wgather_flush_done (struct nfs3_wbatch *batch, int32_t op_ret,
+                         int32_t op_errno);
+
+static void
+__nfs3_wgather_arm_timer (struct nfs3_state *nfs3);
+
+int32_t
+nfs3_wgather_flush_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                        struct iatt *postbuf)
+{
+        nfs3_wgather_flush_done (frame->local, op_ret, op_errno);
+        return 0;
+}
+
+
+static void
+nfs3_wgather_kick (struct list_head *kick)
+{
+        struct nfs3_wbatch      *batch = NULL;
+        struct nfs3_wbatch      *tmp = NULL;
+        struct nfs3_wgather     *wg = NULL;
+        int                     ret = -EFAULT;
+
+        list_for_each_entry_safe (batch, tmp, kick, kickq) {
+                list_del_init (&batch->kickq);
+                wg = batch->wgather;
+
+                batch->vec.iov_base = iobuf_ptr (batch->iob);
+                batch->vec.iov_len = batch->size;
+                ret = nfs_write (wg->nfs3->nfsx, wg->vol, &batch->nfu, wg->fd,
+                                 batch->iobref, &batch->vec, 1, batch->offset,
+                                 nfs3_wgather_flush_cbk, batch);
+                if (ret < 0)
+                        nfs3_wgather_flush_done (batch, -1, -ret);
+        }
+}
+
+
+static void
+nfs3_wgather_resume_waiters (struct list_head *waiters)
+{
+        nfs3_call_state_t       *cs = NULL;
+        nfs3_call_state_t       *tmp = NULL;
+
+        list_for_each_entry_safe (cs, tmp, waiters, flushwait_q) {
+                list_del_init (&cs->flushwait_q);
+                cs->flush_resume (cs);
+        }
+}
+
+
+static void
+nfs3_wgather_flush_done (struct nfs3_wbatch *batch, int32_t op_ret,
+                         int32_t op_errno)
+{
+        struct nfs3_wgather     *wg = NULL;
+        struct nfs3_state       *nfs3 = NULL;
+        struct list_head        waiters;
+        struct list_head        kick;
+        int                     freewg = 0;
+
+        wg = batch->wgather;
+        nfs3 = wg->nfs3;
+        INIT_LIST_HEAD (&waiters);
+        INIT_LIST_HEAD (&kick);
+
+        /* wg stays while it is flushing */
+        nfs3_rdcache_invalidate_parent (nfs3, wg->inode);
+
+        if ((op_ret >= 0) && (op_ret < batch->size)) {
+                op_ret = -1;
+                op_errno = EIO;
+        }
+
+        if (op_ret == -1)
+                gf_log (GF_NFS3, GF_LOG_ERROR, "Flushing %zu gathered bytes "
+                        "at %"PRId64" failed: %s", batch->size,
+                        (int64_t)batch->offset, strerror (op_errno));
+
+        LOCK (&nfs3->wgather_lock);
+        {
+                list_del_init (&batch->list);
+                list_splice_init (&batch->waiters, &waiters);
+                nfs3->wgather_bytes -= batch->bufsize;
+                wg->flushing = 0;
+
+                if (op_ret == -1) {
+                        wg->error = op_errno;
+                        wg->errstamp = time (NULL);
+                        __nfs3_wgather_arm_timer (nfs3);
+                }
+
+                __nfs3_wgather_pick (wg, &kick);
+                if (list_empty (&wg->batches) && !wg->error) {
+                        list_del_init (&wg->hash);
+                        freewg = 1;
+                }
+        }
+        UNLOCK (&nfs3->wgather_lock);
+
+        iobref_unref (batch->iobref);
+        iobuf_unref (batch->iob);
+        GF_FREE (batch);
+
+        if (freewg)
+                nfs3_wgather_destroy (wg);
+
+        nfs3_wgather_kick (&kick);
+        nfs3_wgather_resume_waiters (&waiters);
+}
+
+
+void
+nfs3_wgather_timeout (void *data)
+{
+        struct nfs3_state       *nfs3 = NULL;
+        struct nfs3_wgather     *wg = NULL;
+        struct nfs3_wgather     *tmp = NULL;
+        struct nfs3_wbatch      *batch = NULL;
+        struct timeval          delta = {GF_NFS3_WGATHER_TIMEOUT, 0};
+        struct list_head        kick;
+        struct list_head        reap;
+        time_t                  now = 0;
+        int                     pending = 0;
+        int                     i = 0;
+
+        nfs3 = data;
+        INIT_LIST_HEAD (&kick);
+        INIT_LIST_HEAD (&reap);
+        now = time (NULL);
+
+        LOCK (&nfs3->wgather_lock);
+        {
+                if (nfs3->wgather_timer)
+                        gf_timer_call_cancel (nfs3->nfsx->ctx,
+                                              nfs3->wgather_timer);
+                nfs3->wgather_timer = NULL;
+                for (i = 0; i < GF_NFS3_WGATHER_BUCKETS; i++) {
+                        list_for_each_entry_safe (wg, tmp,
+                                                  &nfs3->wgather_table[i],
+                                                  hash) {
+                                if (wg->error && list_empty (&wg->batches)) {
+                                        if ((now - wg->errstamp) <
+                                            GF_NFS3_WGATHER_ERROR_TIMEOUT) {
+                                                pending = 1;
+                                                continue;
+                                        }
+
+                                        gf_log (GF_NFS3, GF_LOG_WARNING,
+                                                "Dropping the unreported "
+                                                "write error of %s: %s",
+                                                uuid_utoa (wg->inode->gfid),
+                                                strerror (wg->error));
+                                        list_move (&wg->hash, &reap);
+                                        continue;
+                                }
+
+                                batch = __nfs3_wgather_tail (wg);
+                                if (!batch)
+                                        continue;
+
+                                if ((now - batch->stamp) <
+                                    GF_NFS3_WGATHER_TIMEOUT) {
+                                        pending = 1;
+                                        continue;
+                                }
+
+                                batch->closed = 1;
+                                __nfs3_wgather_pick (wg, &kick);
+                        }
+                }
+
+                if (pending)
+                        nfs3->wgather_timer =
+                                gf_timer_call_after (nfs3->nfsx->ctx, delta,
+                                                     nfs3_wgather_timeout,
+                                                     nfs3);
+        }
+        UNLOCK (&nfs3->wgather_lock);
+
+        list_for_each_entry_safe (wg, tmp, &reap, hash) {
+                list_del_init (&wg->hash);
+                nfs3_wgather_destroy (wg);
+        }
+
+        nfs3_wgather_kick (&kick);
+}
+
+
+static void
+__nfs3_wgather_arm_timer (struct nfs3_state *nfs3)
+{
+        struct timeval          delta = {GF_NFS3_WGATHER_TIMEOUT, 0};
+
+        if (nfs3->wgather_timer)
+                return;
+
+        nfs3->wgather_timer = gf_timer_call_after (nfs3->nfsx->ctx, delta,
+                                                   nfs3_wgather_timeout, nfs3);
+}
+
+
+static struct nfs3_wbatch *
+__nfs3_wgather_new_batch (struct nfs3_wgather *wg, nfs3_call_state_t *cs)
+{
+        struct nfs3_wbatch      *batch = NULL;
+        struct nfs3_state       *nfs3 = NULL;
+
+        nfs3 = wg->nfs3;
+
+        batch = GF_CALLOC (1, sizeof (*batch), gf_nfs_mt_nfs3_wbatch);
+        if (!batch)
+                return NULL;
+
+        batch->iob = iobuf_get (nfs3->iobpool);
+        batch->iobref = iobref_new ();
+        if (!batch->iob || !batch->iobref) {
+                if (batch->iob)
+                        iobuf_unref (batch->iob);
+                if (batch->iobref)
+                        iobref_unref (batch->iobref);
+                GF_FREE (batch);
+                return NULL;
+        }
+
+        iobref_add (batch->iobref, batch->iob);
+        /* the whole iobuf is pinned until the flush, whatever the size of
+           the writes gathered into it */
+        batch->bufsize = iobpool_default_pagesize (nfs3->iobpool);
+        nfs3->wgather_bytes += batch->bufsize;
+        batch->wgather = wg;
+        batch->offset = cs->dataoffset;
+        batch->stamp = time (NULL);
+        nfs_request_user_init (&batch->nfu, cs->req);
+        INIT_LIST_HEAD (&batch->waiters);
+        INIT_LIST_HEAD (&batch->kickq);
+        list_add_tail (&batch->list, &wg->batches);
+
+        return batch;
+}
+
+
+/* Gather the WRITE in @cs, whose fd is open. Returns
+ * GF_NFS3_WGATHER_GATHERED when the data was buffered and the write can be
+ * acknowledged as UNSTABLE now, GF_NFS3_WGATHER_QUEUED when @cs has been
+ * queued and will be resumed through @gathered (buffered under memory
+ * pressure) or @drained (a write that is not gathered, once the writes
+ * gathered before it are on the volume), and GF_NFS3_WGATHER_PASS when
+ * the write has to be sent as usual.
+ */
+int
+nfs3_wgather_write (nfs3_call_state_t *cs, nfs3_resume_fn_t gathered,
+                    nfs3_resume_fn_t drained)
+{
+        struct nfs3_state       *nfs3 = NULL;
+        struct nfs3_wgather     *wg = NULL;
+        struct nfs3_wbatch      *batch = NULL;
+        struct list_head        kick;
+        size_t                  pagesize = 0;
+        int                     ret = GF_NFS3_WGATHER_PASS;
+
+        nfs3 = cs->nfs3state;
+        if (!nfs3->wgather)
+                return GF_NFS3_WGATHER_PASS;
+
+        INIT_LIST_HEAD (&kick);
+        pagesize = iobpool_default_pagesize (nfs3->iobpool);
+
+        LOCK (&nfs3->wgather_lock);
+        {
+                wg = __nfs3_wgather_get (nfs3, cs->fd->inode);
+
+                if ((cs->writetype != UNSTABLE) || (wg && wg->error) ||
+                    (cs->datacount > pagesize)) {
+                        batch = wg ? __nfs3_wgather_close (wg) : NULL;
+                        if (!batch)
+                                goto unlock;
+
+                        cs->flush_resume = drained;
+                        list_add_tail (&cs->flushwait_q, &batch->waiters);
+                        __nfs3_wgather_pick (wg, &kick);
+                        ret = GF_NFS3_WGATHER_QUEUED;
+                        goto unlock;
+                }
+
+                if (!wg) {
+                        wg = __nfs3_wgather_new (nfs3, cs);
+                        if (!wg)
+                                goto unlock;
+                }
+
+                batch = __nfs3_wgather_tail (wg);
+                if (batch &&
+                    (((batch->offset + batch->size) != cs->dataoffset) ||
+                     ((batch->size + cs->datacount) > pagesize))) {
+                        batch->closed = 1;
+                        batch = NULL;
+                }
+
+                if (!batch) {
+                        batch = __nfs3_wgather_new_batch (wg, cs);
+                        if (!batch) {
+                                /* write it through, behind the batches */
+                                batch = __nfs3_wgather_close (wg);
+                                if (!batch) {
+                                        list_del_init (&wg->hash);
+                                        nfs3_wgather_destroy (wg);
+                                        goto unlock;
+                                }
+
+                                cs->flush_resume = drained;
+                                list_add_tail (&cs->flushwait_q,
+                                               &batch->waiters);
+                                __nfs3_wgather_pick (wg, &kick);
+                                ret = GF_NFS3_WGATHER_QUEUED;
+                                goto unlock;
+                        }
+                }
+
+                memcpy (iobuf_ptr (batch->iob) + batch->size,
+                        cs->datavec.iov_base, cs->datacount);
+                batch->size += cs->datacount;
+                ret = GF_NFS3_WGATHER_GATHERED;
+
+                if (batch->size == pagesize)
+                        batch->closed = 1;
+
+                if (nfs3->wgather_bytes > nfs3->wgather_limit) {
+                        batch->closed = 1;
+                        cs->flush_resume = gathered;
+                        list_add_tail (&cs->flushwait_q, &batch->waiters);
+                        ret = GF_NFS3_WGATHER_QUEUED;
+                }
+
+                __nfs3_wgather_pick (wg, &kick);
+                if (!batch->closed)
+                        __nfs3_wgather_arm_timer (nfs3);
+        }
+unlock:
+        UNLOCK (&nfs3->wgather_lock);
+
+        nfs3_wgather_kick (&kick);
+        return ret;
+}
+
+
+/* Flush the writes gathered for the file of @cs. Returns 0 when there are
+ * none, or 1 when @cs has been queued and will be resumed through @resume
+ * once they are on the volume.
+ */
+int
+nfs3_wgather_drain (nfs3_call_state_t *cs, nfs3_resume_fn_t resume)
+{
+        struct nfs3_state       *nfs3 = NULL;
+        struct nfs3_wgather     *wg = NULL;
+        struct nfs3_wbatch      *batch = NULL;
+        struct list_head        kick;
+        inode_t                 *inode = NULL;
+        int                     ret = 0;
+
+        nfs3 = cs->nfs3state;
+        inode = cs->fd ? cs->fd->inode : cs->resolvedloc.inode;
+        if (!nfs3->wgather || !inode)
+                return 0;
+
+        INIT_LIST_HEAD (&kick);
+
+        LOCK (&nfs3->wgather_lock);
+        {
+                wg = __nfs3_wgather_get (nfs3, inode);
+                if (!wg)
+                        goto unlock;
+
+                batch = __nfs3_wgather_close (wg);
+                if (!batch)
+                        goto unlock;
+
+                cs->flush_resume = resume;
+                list_add_tail (&cs->flushwait_q, &batch->waiters);
+                __nfs3_wgather_pick (wg, &kick);
+                ret = 1;
+        }
+unlock:
+        UNLOCK (&nfs3->wgather_lock);
+
+        nfs3_wgather_kick (&kick);
+        return ret;
+}
+
+
+/* Return, and forget, the error of a failed flush of the file of @cs. */
+int
+nfs3_wgather_take_error (nfs3_call_state_t *cs)
+{
+        struct nfs3_state       *nfs3 = NULL;
+        struct nfs3_wgather     *wg = NULL;
+        int                     error = 0;
+        int                     freewg = 0;
+
+        nfs3 = cs->nfs3state;
+        if (!nfs3->wgather || !cs->fd)
+                return 0;
+
+        LOCK (&nfs3->wgather_lock);
+        {
+                wg = __nfs3_wgather_get (nfs3, cs->fd->inode);
+                if (!wg)
+                        goto unlock;
+
+                error = wg->error;
+                wg->error = 0;
+                if (list_empty (&wg->batches)) {
+                        list_del_init (&wg->hash);
+                        freewg = 1;
+                }
+        }
+unlock:
+        UNLOCK (&nfs3->wgather_lock);
+
+        if (freewg)
+                nfs3_wgather_destroy (wg);
+
+        return error;
+}
+
+
+/* The file of @inode is gone (REMOVE, RENAME over it), drop its gathering
+ * state unless batches are still to be written.
+ */
+void
+nfs3_wgather_forget (struct nfs3_state *nfs3, inode_t *inode)
+{
+        struct nfs3_wgather     *wg = NULL;
+        int                     freewg = 0;
+
+        if (!nfs3->wgather || !inode)
+                return;
+
+        LOCK (&nfs3->wgather_lock);
+        {
+                wg = __nfs3_wgather_get (nfs3, inode);
+                if (wg && list_empty (&wg->batches)) {
+                        list_del_init (&wg->hash);
+                        freewg = 1;
+                }
+        }
+        UNLOCK (&nfs3->wgather_lock);
+
+        if (freewg)
+                nfs3_wgather_destroy (wg);
+}
+
+
+void
+nfs3_wgather_init (struct nfs3_state *nfs3)
+{
+        int     i = 0;
+
+        LOCK_INIT (&nfs3->wgather_lock);
+        for (i = 0; i < GF_NFS3_WGATHER_BUCKETS; i++)
+                INIT_LIST_HEAD (&nfs3->wgather_table[i]);
+}
+
+
+static int
+nfs3_rdcache_bucket (inode_t *inode)
+{
+        return ((uintptr_t)inode >> 6) % GF_NFS3_RDCACHE_BUCKETS;
+}
+
+
+static struct nfs3_rddir *
+__nfs3_rdcache_get (struct nfs3_state *nfs3, inode_t *inode)
+{
+        struct nfs3_rddir       *dir = NULL;
+        int                     bucket = 0;
+
+        bucket = nfs3_rdcache_bucket (inode);
+        list_for_each_entry (dir, &nfs3->rdcache_table[bucket], hash) {
+                if (dir->inode == inode)
+                        return dir;
+        }
+
+        return NULL;
+}
+
+
+static struct nfs3_rddir *
+__nfs3_rdcache_new (struct nfs3_state *nfs3, nfs3_call_state_t *cs)
+{
+        struct nfs3_rddir       *dir = NULL;
+
+        dir = GF_CALLOC (1, sizeof (*dir), gf_nfs_mt_nfs3_rddir);
+        if (!dir)
+                return NULL;
+
+        dir->nfs3 = nfs3;
+        dir->refcount = 1;              /* The hash table's */
+        dir->hashed = 1;
+        dir->inode = inode_ref (cs->fd->inode);
+        dir->fd = fd_ref (cs->fd);
+        dir->vol = cs->vol;
+        INIT_LIST_HEAD (&dir->batches);
+        list_add (&dir->hash,
+                  &nfs3->rdcache_table[nfs3_rdcache_bucket (dir->inode)]);
+        list_add (&dir->lru, &nfs3->rdcache_lru);
+
+        return dir;
+}
+
+
+static void
+nfs3_rdcache_destroy (struct nfs3_rddir *dir)
+{
+        if (!dir)
+                return;
+
+        fd_unref (dir->fd);
+        inode_unref (dir->inode);
+        GF_FREE (dir);
+}
+
+
+static void
+nfs3_rdbatch_free (struct nfs3_rdbatch *batch)
+{
+        if (!batch)
+                return;
+
+        gf_dirent_free (&batch->entries);
+        GF_FREE (batch);
+}
+
+
+static gf_dirent_t *
+nfs3_rdcache_dirent_dup (gf_dirent_t *entry)
+{
+        gf_dirent_t     *copy = NULL;
+
+        copy = gf_dirent_for_name (entry->d_name);
+        if (!copy)
+                return NULL;
+
+        copy->d_ino = entry->d_ino;
+        copy->d_off = entry->d_off;
+        copy->d_type = entry->d_type;
+        copy->d_stat = entry->d_stat;
+
+        return copy;
+}
+
+
+static struct nfs3_rdbatch *
+nfs3_rdbatch_new (gf_dirent_t *entries, cookie3 cookie, int eof)
+{
+        struct nfs3_rdbatch     *batch = NULL;
+        gf_dirent_t             *entry = NULL;
+        gf_dirent_t             *copy = NULL;
+
+        batch = GF_CALLOC (1, sizeof (*batch), gf_nfs_mt_nfs3_rdbatch);
+        if (!batch)
+                return NULL;
+
+        INIT_LIST_HEAD (&batch->list);
+        INIT_LIST_HEAD (&batch->entries.list);
+        batch->cookie = cookie;
+        batch->eof = eof;
+        batch->stamp = time (NULL);
+        batch->size = sizeof (*batch);
+        list_for_each_entry (entry, &entries->list, list) {
+                copy = nfs3_rdcache_dirent_dup (entry);
+                if (!copy) {
+                        nfs3_rdbatch_free (batch);
+                        return NULL;
+                }
+                list_add_tail (&copy->list, &batch->entries.list);
+                batch->size += sizeof (*copy) + strlen (copy->d_name) + 1;
+        }
+
+        return batch;
+}
+
+
+static void
+__nfs3_rdbatch_del (struct nfs3_rddir *dir, struct nfs3_rdbatch *batch)
+{
+        list_del_init (&batch->list);
+        dir->size -= batch->size;
+        dir->nfs3->rdcache_bytes -= batch->size;
+        nfs3_rdbatch_free (batch);
+}
+
+
+static void
+__nfs3_rdbatch_add (struct nfs3_rddir *dir, struct nfs3_rdbatch *batch)
+{
+        struct nfs3_rdbatch     *old = NULL;
+        struct nfs3_rdbatch     *tmp = NULL;
+
+        list_for_each_entry_safe (old, tmp, &dir->batches, list) {
+                if (old->cookie == batch->cookie)
+                        __nfs3_rdbatch_del (dir, old);
+        }
+
+        list_add_tail (&batch->list, &dir->batches);
+        dir->size += batch->size;
+        dir->nfs3->rdcache_bytes += batch->size;
+}
+
+
+/* Drop every batch of @dir and take it out of the cache. Returns 1 when
+ * the caller dropped the last reference and must destroy @dir.
+ */
+static int
+__nfs3_rdcache_unhash (struct nfs3_rddir *dir)
+{
+        struct nfs3_rdbatch     *batch = NULL;
+        struct nfs3_rdbatch     *tmp = NULL;
+
+        list_for_each_entry_safe (batch, tmp, &dir->batches, list)
+                __nfs3_rdbatch_del (dir, batch);
+
+        list_del_init (&dir->hash);
+        list_del_init (&dir->lru);
+        dir->hashed = 0;
+
+        return (--dir->refcount == 0);
+}
+
+
+/* Bring the cache back under its limit by dropping the least recently
+ * listed directories and then, for a directory larger than the limit on
+ * its own, the batches @keep was served before its last one.
+ */
+static void
+__nfs3_rdcache_prune (struct nfs3_state *nfs3, struct nfs3_rddir *keep,
+                      struct list_head *freeq)
+{
+        struct nfs3_rddir       *dir = NULL;
+        struct nfs3_rdbatch     *batch = NULL;
+
+        while (nfs3->rdcache_bytes > nfs3->rdcache_limit) {
+                dir = list_entry (nfs3->rdcache_lru.prev, struct nfs3_rddir,
+                                  lru);
+                if (dir == keep)
+                        break;
+
+                nfs3->rdcache_evictions++;
+                if (__nfs3_rdcache_unhash (dir))
+                        list_add (&dir->hash, freeq);
+        }
+
+        while ((nfs3->rdcache_bytes > nfs3->rdcache_limit) &&
+               (keep->batches.next != keep->batches.prev)) {
+                batch = list_entry (keep->batches.next, struct nfs3_rdbatch,
+                                    list);
+                nfs3->rdcache_evictions++;
+                __nfs3_rdbatch_del (keep, batch);
+        }
+}
+
+
+static void
+nfs3_rdcache_destroy_list (struct list_head *freeq)
+{
+        struct nfs3_rddir       *dir = NULL;
+        struct nfs3_rddir       *tmp = NULL;
+
+        list_for_each_entry_safe (dir, tmp, freeq, hash) {
+                list_del_init (&dir->hash);
+                nfs3_rdcache_destroy (dir);
+        }
+}
+
+
+static struct nfs3_rdbatch *
+__nfs3_rdcache_batch (struct nfs3_rddir *dir, cookie3 cookie)
+{
+        struct nfs3_rdbatch     *batch = NULL;
+
+        list_for_each_entry (batch, &dir->batches, list) {
+                if (batch->cookie == cookie)
+                        return batch;
+        }
+
+        return NULL;
+}
+
+
+/* Decide whether the batch following @batch should be read ahead and, if
+ * so, take a reference on @dir for the readdirp that will do it.
+ */
+static int
+__nfs3_rdcache_want_prefetch (struct nfs3_rddir *dir,
+                              struct nfs3_rdbatch *batch)
+{
+        gf_dirent_t     *last = NULL;
+
+        if ((batch->eof) || (dir->prefetching) ||
+            (list_empty (&batch->entries.list)))
+                return 0;
+
+        last = list_entry (batch->entries.list.prev, gf_dirent_t, list);
+        if (__nfs3_rdcache_batch (dir, last->d_off))
+                return 0;
+
+        dir->prefetching = 1;
+        dir->prefetch_cookie = last->d_off;
+        dir->refcount++;
+        return 1;
+}
+
+
+static void
+nfs3_rdcache_prefetch_done (struct nfs3_rddir *dir, int32_t op_ret,
+                            int32_t op_errno, gf_dirent_t *entries)
+{
+        struct nfs3_state       *nfs3 = NULL;
+        struct nfs3_rdbatch     *batch = NULL;
+        struct list_head        freeq;
+        int                     destroy = 0;
+
+        nfs3 = dir->nfs3;
+        INIT_LIST_HEAD (&freeq);
+        if (op_ret >= 0)
+                batch = nfs3_rdbatch_new (entries, dir->prefetch_cookie,
+                                          (op_errno == ENOENT));
+        else
+                gf_log (GF_NFS3, GF_LOG_TRACE, "Readdir prefetch failed: %s",
+                        strerror (op_errno));
+
+        LOCK (&nfs3->rdcache_lock);
+        {
+                dir->prefetching = 0;
+                if ((batch) && (dir->hashed)) {
+                        __nfs3_rdbatch_add (dir, batch);
+                        batch = NULL;
+                        nfs3->rdcache_prefetches++;
+                        __nfs3_rdcache_prune (nfs3, dir, &freeq);
+                }
+                destroy = (--dir->refcount == 0);
+        }
+        UNLOCK (&nfs3->rdcache_lock);
+
+        nfs3_rdbatch_free (batch);
+        nfs3_rdcache_destroy_list (&freeq);
+        if (destroy)
+                nfs3_rdcache_destroy (dir);
+}
+
+
+int32_t
+nfs3_rdcache_prefetch_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int32_t op_ret, int32_t op_errno,
+                           gf_dirent_t *entries)
+{
+        nfs3_rdcache_prefetch_done (frame->local, op_ret, op_errno, entries);
+        return 0;
+}
+
+
+static void
+nfs3_rdcache_prefetch (struct nfs3_rddir *dir)
+{
+        nfs_user_t      nfu = {0, };
+        int             ret = -EFAULT;
+
+        /* Batches are only handed out to users allowed to read the
+         * directory, so read ahead as root.
+         */
+        nfs_user_root_create (&nfu);
+        ret = nfs_readdirp (dir->nfs3->nfsx, dir->vol, &nfu, dir->fd,
+                            dir->bufsize, dir->prefetch_cookie,
+                            nfs3_rdcache_prefetch_cbk, dir);
+        if (ret < 0)
+                nfs3_rdcache_prefetch_done (dir, -1, -ret, NULL);
+}
+
+
+/* Batches are shared by all clients, so a hit must only be served to a user
+ * the volume would have let read the directory.
+ */
+static int
+nfs3_rdcache_may_read (nfs3_call_state_t *cs, struct iatt *dirstat)
+{
+        nfs_user_t      nfu = {0, };
+        int             i = 0;
+
+        nfs_request_user_init (&nfu, cs->req);
+        if (nfu.uid == 0)
+                return 1;
+
+        if (nfu.uid == dirstat->ia_uid)
+                return dirstat->ia_prot.owner.read;
+
+        for (i = 0; i < nfu.ngrps; i++) {
+                if (nfu.gids[i] == dirstat->ia_gid)
+                        return dirstat->ia_prot.group.read;
+        }
+
+        return dirstat->ia_prot.other.read;
+}
+
+
+/* Find the position after which a READDIR at @cookie continues: the list
+ * head of the batch read at @cookie, or the entry carrying @cookie inside
+ * a batch. Expired batches are dropped on the way.
+ */
+static gf_dirent_t *
+__nfs3_rdcache_find (struct nfs3_rddir *dir, cookie3 cookie,
+                     struct nfs3_rdbatch **found)
+{
+        struct nfs3_rdbatch     *batch = NULL;
+        struct nfs3_rdbatch     *tmp = NULL;
+        gf_dirent_t             *entry = NULL;
+        time_t                  now = 0;
+
+        now = time (NULL);
+        list_for_each_entry_safe (batch, tmp, &dir->batches, list) {
+                if ((now - batch->stamp) > GF_NFS3_RDCACHE_TIMEOUT) {
+                        __nfs3_rdbatch_del (dir, batch);
+                        continue;
+                }
+
+                if (batch->cookie == cookie) {
+                        *found = batch;
+                        return &batch->entries;
+                }
+
+                list_for_each_entry (entry, &batch->entries.list, list) {
+                        if (entry->d_off != cookie)
+                                continue;
+                        /* The rest of the stream is in the next batch. */
+                        if ((entry->list.next == &batch->entries.list) &&
+                            (!batch->eof))
+                                break;
+                        *found = batch;
+                        return entry;
+                }
+        }
+
+        return NULL;
+}
+
+
+/* Serve a READDIR or READDIRPLUS from the cache. On a hit, the entries that
+ * fit in the reply are copied to cs->entries and 0 is returned.
+ */
+int
+nfs3_rdcache_serve (nfs3_call_state_t *cs, uint64_t *cverf,
+                    struct iatt *dirstat, int *is_eof)
+{
+        struct nfs3_state       *nfs3 = NULL;
+        struct nfs3_rddir       *dir = NULL;
+        struct nfs3_rdbatch     *batch = NULL;
+        gf_dirent_t             *pos = NULL;
+        gf_dirent_t             *entry = NULL;
+        gf_dirent_t             *copy = NULL;
+        struct nfs3_fh          childfh = {{0}, };
+        count3                  count = 0;
+        count3                  filled = 0;
+        count3                  fixed = 0;
+        int                     prefetch = 0;
+        int                     ret = -1;
+
+        if ((!cs) || (!cverf) || (!dirstat) || (!is_eof))
+                return -1;
+
+        nfs3 = cs->nfs3state;
+        if (!nfs3->rdcache)
+                return -1;
+
+        /* Same accounting as nfs3_fill_readdir(p)3res so that it takes every
+         * entry copied here and EOF is only reported with the last one.
+         */
+        if (cs->maxcount) {
+                count = cs->maxcount;
+                childfh = cs->parent;
+                childfh.hashcount++;
+                fixed = NFS3_ENTRYP3_FIXED_SIZE +
+                        nfs3_fh_compute_size (&childfh);
+        } else {
+                count = cs->dircount;
+                fixed = NFS3_ENTRY3_FIXED_SIZE;
+        }
+
+        LOCK (&nfs3->rdcache_lock);
+        {
+                dir = __nfs3_rdcache_get (nfs3, cs->resolvedloc.inode);
+                if (!dir)
+                        goto unlock;
+
+                if (!nfs3_rdcache_may_read (cs, &dir->dirstat))
+                        goto unlock;
+
+                pos = __nfs3_rdcache_find (dir, cs->cookie, &batch);
+                if (!pos)
+                        goto unlock;
+
+                filled = NFS3_READDIR_RESOK_SIZE;
+                entry = pos->next;
+                while ((entry != &batch->entries) && (filled < count)) {
+                        copy = nfs3_rdcache_dirent_dup (entry);
+                        if (!copy)
+                                break;
+                        list_add_tail (&copy->list, &cs->entries.list);
+                        filled += fixed + strlen (entry->d_name);
+                        entry = entry->next;
+                }
+
+                if (!copy && (entry != &batch->entries)) {
+                        gf_dirent_free (&cs->entries);
+                        goto unlock;
+                }
+
+                *is_eof = ((entry == &batch->entries) && (batch->eof));
+                *dirstat = dir->dirstat;
+                *cverf = (uintptr_t)dir->fd;
+                list_move (&dir->lru, &nfs3->rdcache_lru);
+                if (entry == &batch->entries)
+                        prefetch = __nfs3_rdcache_want_prefetch (dir, batch);
+                ret = 0;
+        }
+unlock:
+        if (ret == 0)
+                nfs3->rdcache_hits++;
+        else
+                nfs3->rdcache_misses++;
+        UNLOCK (&nfs3->rdcache_lock);
+
+        if (prefetch)
+                nfs3_rdcache_prefetch (dir);
+
+        return ret;
+}
+
+
+/* Keep a copy of the entries a READDIR read from the volume at cs->cookie
+ * and read the batch that follows ahead of the client asking for it.
+ */
+void
+nfs3_rdcache_fill (nfs3_call_state_t *cs, struct iatt *dirstat, int is_eof)
+{
+        struct nfs3_state       *nfs3 = NULL;
+        struct nfs3_rddir       *dir = NULL;
+        struct nfs3_rdbatch     *batch = NULL;
+        struct list_head        freeq;
+        int                     prefetch = 0;
+
+        if ((!cs) || (!cs->fd) || (!dirstat))
+                return;
+
+        nfs3 = cs->nfs3state;
+        if (!nfs3->rdcache)
+                return;
+
+        batch = nfs3_rdbatch_new (&cs->entries, cs->cookie, is_eof);
+        if (!batch)
+                return;
+
+        INIT_LIST_HEAD (&freeq);
+        LOCK (&nfs3->rdcache_lock);
+        {
+                dir = __nfs3_rdcache_get (nfs3, cs->fd->inode);
+                if (!dir)
+                        dir = __nfs3_rdcache_new (nfs3, cs);
+                if (!dir)
+                        goto unlock;
+
+                dir->dirstat = *dirstat;
+                dir->bufsize = cs->dircount;
+                __nfs3_rdbatch_add (dir, batch);
+                list_move (&dir->lru, &nfs3->rdcache_lru);
+                prefetch = __nfs3_rdcache_want_prefetch (dir, batch);
+                batch = NULL;
+                __nfs3_rdcache_prune (nfs3, dir, &freeq);
+        }
+unlock:
+        UNLOCK (&nfs3->rdcache_lock);
+
+        nfs3_rdbatch_free (batch);
+        nfs3_rdcache_destroy_list (&freeq);
+        if (prefetch)
+                nfs3_rdcache_prefetch (dir);
+}
+
+
+void
+nfs3_rdcache_invalidate (struct nfs3_state *nfs3, inode_t *inode)
+{
+        struct nfs3_rddir       *dir = NULL;
+        int                     destroy = 0;
+
+        if ((!nfs3) || (!inode))
+                return;
+
+        LOCK (&nfs3->rdcache_lock);
+        {
+                dir = __nfs3_rdcache_get (nfs3, inode);
+                if (dir)
+                        destroy = __nfs3_rdcache_unhash (dir);
+        }
+        UNLOCK (&nfs3->rdcache_lock);
+
+        if (destroy)
+                nfs3_rdcache_destroy (dir);
+}
+
+
+/* READDIRPLUS attributes of @inode are cached with the directory it was
+ * listed in, forget that listing once a WRITE or SETATTR changed them.
+ * Only the one parent the inode table knows of is found for a file with
+ * several links.
+ */
+void
+nfs3_rdcache_invalidate_parent (struct nfs3_state *nfs3, inode_t *inode)
+{
+        inode_t                 *parent = NULL;
+
+        if ((!nfs3) || (!inode) || (!nfs3->rdcache))
+                return;
+
+        parent = inode_parent (inode, 0, NULL);
+        if (!parent)
+                return;
+
+        nfs3_rdcache_invalidate (nfs3, parent);
+        inode_unref (parent);
+}
+
+
+/* Forget the cached listings of the directories a namespace operation
+ * changed, or removed, and of the ones listing an inode whose attributes
+ * changed.
+ */
+void
+nfs3_rdcache_invalidate_call (nfs3_call_state_t *cs)
+{
+        if (!cs)
+                return;
+
+        /* a file handle resolves without the parent */
+        if (cs->resolvedloc.parent)
+                nfs3_rdcache_invalidate (cs->nfs3state,
+                                         cs->resolvedloc.parent);
+        else
+                nfs3_rdcache_invalidate_parent (cs->nfs3state,
+                                                cs->resolvedloc.inode);
+        nfs3_rdcache_invalidate (cs->nfs3state, cs->resolvedloc.inode);
+        nfs3_rdcache_invalidate (cs->nfs3state, cs->oploc.parent);
+        nfs3_rdcache_invalidate (cs->nfs3state, cs->oploc.inode);
+}
+
+
+void
+nfs3_rdcache_init (struct nfs3_state *nfs3)
+{
+        int     i = 0;
+
+        LOCK_INIT (&nfs3->rdcache_lock);
+        INIT_LIST_HEAD (&nfs3->rdcache_lru);
+        for (i = 0; i < GF_NFS3_RDCACHE_BUCKETS; i++)
+                INIT_LIST_HEAD (&nfs3->rdcache_table[i]);
+}
+
+
+void
+nfs3_rdcache_priv_dump (struct nfs3_state *nfs3, char *key_prefix)
+{
+        char    key[GF_DUMP_MAX_BUF_LEN];
+
+        if ((!nfs3) || (!key_prefix))
+                return;
+
+        LOCK (&nfs3->rdcache_lock);
+        {
+                gf_proc_dump_build_key (key, key_prefix, "readdir_cache_bytes");
+                gf_proc_dump_write (key, "%"GF_PRI_SIZET, nfs3->rdcache_bytes);
+                gf_proc_dump_build_key (key, key_prefix, "readdir_cache_hits");
+                gf_proc_dump_write (key, "%"PRIu64, nfs3->rdcache_hits);
+                gf_proc_dump_build_key (key, key_prefix,
+                                        "readdir_cache_misses");
+                gf_proc_dump_write (key, "%"PRIu64, nfs3->rdcache_misses);
+                gf_proc_dump_build_key (key, key_prefix,
+                                        "readdir_cache_prefetches");
+                gf_proc_dump_write (key, "%"PRIu64, nfs3->rdcache_prefetches);
+                gf_proc_dump_build_key (key, key_prefix,
+                                        "readdir_cache_evictions");
+                gf_proc_dump_write (key, "%"PRIu64, nfs3->rdcache_evictions);
+        }
+        UNLOCK (&nfs3->rdcache_lock);
+}
+
+
 int32_t
 nfs3_file_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                     int32_t op_ret, int32_t op_errno, fd_t *fd)
@@ -2407,6 +3619,17 @@ nfs3_log_readdir_call (uint32_t xid, struct nfs3_fh *fh, count3 dircount,
 }
 
 
+#define nfs3_fh_resolve_stat_add(cst, field, val)                       \
+        do {                                                            \
+                struct nfs_state *__nfs = (cst)->nfsx->private;         \
+                LOCK (&__nfs->resolvelock);                             \
+                {                                                       \
+                        __nfs->field += (val);                          \
+                }                                                       \
+                UNLOCK (&__nfs->resolvelock);                           \
+        } while (0)
+
+
 int
 nfs3_fh_resolve_inode_done (nfs3_call_state_t *cs, inode_t *inode)
 {
@@ -2649,6 +3872,8 @@ nfs3_fh_resolve_opendir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 gf_log (GF_NFS3, GF_LOG_TRACE, "Reading directory: %s",
                         cs->resolvedloc.path);
 
+        nfs3_fh_resolve_stat_add (cs, hard_dirs_read, 1);
+
         nfs_user_root_create (&nfu);
         /* Keep this directory fd_t around till we have either:
          * a. found the entry,
@@ -2841,6 +4066,7 @@ nfs3_fh_resolve_search_dir (nfs3_call_state_t *cs, gf_dirent_t *entries)
         gf_dirent_t     *candidate = NULL;
         int             ret = GF_NFS3_FHRESOLVE_NOTFOUND;
         off_t           lastoff = 0;
+        int             searched = 0;
 
         if ((!cs) || (!entries))
                 return -EFAULT;
@@ -2849,6 +4075,7 @@ nfs3_fh_resolve_search_dir (nfs3_call_state_t *cs, gf_dirent_t *entries)
                 goto not_found;
 
         list_for_each_entry (candidate, &entries->list, list) {
+                searched++;
                 lastoff = candidate->d_off;
                 gf_log (GF_NFS3, GF_LOG_TRACE, "Candidate: %s, gfid: %s",
                         candidate->d_name,
@@ -2860,6 +4087,7 @@ nfs3_fh_resolve_search_dir (nfs3_call_state_t *cs, gf_dirent_t *entries)
         }
 
 not_found:
+        nfs3_fh_resolve_stat_add (cs, hard_entries_read, searched);
         nfs3_fh_resolve_check_response (cs, candidate, ret, lastoff);
         return ret;
 }
@@ -2909,6 +4137,9 @@ nfs3_fh_resolve_inode_hard (nfs3_call_state_t *cs)
                 goto out;
         }
 
+        if (cs->hashidx == 1)
+                nfs3_fh_resolve_stat_add (cs, hard_resolves, 1);
+
         nfs_user_root_create (&nfu);
         gf_log (GF_NFS3, GF_LOG_TRACE, "FH hard resolution for: gfid 0x%s"
                 ", hashcount: %d, current hashidx %d",
@@ -2933,6 +4164,101 @@ out:
 }
 
 
+int32_t
+nfs3_fh_resolve_nameless_cbk (call_frame_t *frame, void *cookie,
+                              xlator_t *this, int32_t op_ret,
+                              int32_t op_errno, inode_t *inode,
+                              struct iatt *buf, dict_t *xattr,
+                              struct iatt *postparent)
+{
+        nfs3_call_state_t       *cs = NULL;
+        inode_t                 *linked_inode = NULL;
+
+        cs = frame->local;
+
+        if (op_ret == -1) {
+                gf_log (GF_NFS3, GF_LOG_TRACE, "Nameless lookup failed: %s: "
+                        "%s, falling back to hard resolution",
+                        cs->resolvedloc.path, strerror (op_errno));
+                nfs3_fh_resolve_stat_add (cs, nameless_misses, 1);
+                nfs3_fh_resolve_inode_hard (cs);
+                goto err;
+        }
+
+        gf_log (GF_NFS3, GF_LOG_TRACE, "Nameless lookup found: %s",
+                cs->resolvedloc.path);
+        nfs3_fh_resolve_stat_add (cs, nameless_hits, 1);
+
+        linked_inode = inode_link (inode, NULL, NULL, buf);
+        if (!linked_inode) {
+                nfs3_fh_resolve_inode_hard (cs);
+                goto err;
+        }
+        inode_lookup (linked_inode);
+
+        if (cs->resolventry)
+                nfs3_fh_resolve_entry_hard (cs);
+        else if (nfs3_fh_resolve_inode_done (cs, linked_inode) < 0)
+                nfs3_call_resume_estale (cs);
+
+        inode_unref (linked_inode);
+err:
+        return 0;
+}
+
+
+/* Look the handle's gfid up by itself: the bricks reach it through their
+ * gfid handles in one round trip, where the hard resolution crawls the
+ * directories from the root. The gfid is that of the object itself or, for
+ * (fh, basename) resolution, of its parent directory.
+ */
+int
+nfs3_fh_resolve_nameless (nfs3_call_state_t *cs)
+{
+        int             ret = -EFAULT;
+        nfs_user_t      nfu = {0, };
+        inode_t         *inode = NULL;
+        char            *path = NULL;
+
+        if (!cs)
+                return ret;
+
+        cs->resolve_nameless = 1;
+        nfs_loc_wipe (&cs->resolvedloc);
+
+        inode = inode_new (cs->vol->itable);
+        if (!inode)
+                goto err;
+
+        ret = gf_asprintf (&path, INODE_GFID_PATH_PREFIX "%s>",
+                           uuid_utoa (cs->resolvefh.gfid));
+        if (ret < 0)
+                goto err;
+
+        ret = nfs_loc_fill (&cs->resolvedloc, inode, NULL, path);
+        if (ret < 0)
+                goto err;
+        uuid_copy (cs->resolvedloc.gfid, cs->resolvefh.gfid);
+
+        nfs_user_root_create (&nfu);
+        gf_log (GF_NFS3, GF_LOG_TRACE, "FH nameless resolution: %s", path);
+        ret = nfs_lookup (cs->nfsx, cs->vol, &nfu, &cs->resolvedloc,
+                          nfs3_fh_resolve_nameless_cbk, cs);
+
+err:
+        if (path)
+                GF_FREE (path);
+
+        if (inode)
+                inode_unref (inode);
+
+        if (ret < 0)
+                ret = nfs3_fh_resolve_inode_hard (cs);
+
+        return ret;
+}
+
+
 int
 nfs3_fh_resolve_entry_hard (nfs3_call_state_t *cs)
 {
@@ -2966,7 +4292,11 @@ nfs3_fh_resolve_entry_hard (nfs3_call_state_t *cs)
         } else if (ret == -1) {
                 gf_log (GF_NFS3, GF_LOG_TRACE, "Entry needs parent lookup: %s",
                         cs->resolvedloc.path);
-                ret = nfs3_fh_resolve_inode_hard (cs);
+                if (!cs->resolve_nameless
+                    && gf_nfs_nameless_lookup (cs->nfsx->private))
+                        ret = nfs3_fh_resolve_nameless (cs);
+                else
+                        ret = nfs3_fh_resolve_inode_hard (cs);
         } else if (ret == 0) {
                 cs->resolve_ret = 0;
                 nfs3_call_resume (cs);
@@ -2986,7 +4316,9 @@ nfs3_fh_resolve_inode (nfs3_call_state_t *cs)
 
         gf_log (GF_NFS3, GF_LOG_TRACE, "FH needs inode resolution");
         inode = inode_find (cs->vol->itable, cs->resolvefh.gfid);
-        if (!inode)
+        if (!inode && gf_nfs_nameless_lookup (cs->nfsx->private))
+                ret = nfs3_fh_resolve_nameless (cs);
+        else if (!inode)
                 ret = nfs3_fh_resolve_inode_hard (cs);
         else
                 ret = nfs3_fh_resolve_inode_done (cs, inode);
@@ -351,4 +351,46 @@ nfs3_request_to_accessbits (int32_t accbits);
 int
 nfs3_flush_inode_queue (struct inode_op_queue *inode_q, fd_t *openedfd,
                         int32_t call_resume);
+
+#define GF_NFS3_WGATHER_PASS            0
+#define GF_NFS3_WGATHER_GATHERED        1
+#define GF_NFS3_WGATHER_QUEUED          2
+
+extern void
+nfs3_wgather_init (struct nfs3_state *nfs3);
+
+extern int
+nfs3_wgather_write (nfs3_call_state_t *cs, nfs3_resume_fn_t gathered,
+                    nfs3_resume_fn_t drained);
+
+extern int
+nfs3_wgather_drain (nfs3_call_state_t *cs, nfs3_resume_fn_t resume);
+
+extern int
+nfs3_wgather_take_error (nfs3_call_state_t *cs);
+
+extern void
+nfs3_wgather_forget (struct nfs3_state *nfs3, inode_t *inode);
+
+extern void
+nfs3_rdcache_init (struct nfs3_state *nfs3);
+
+extern int
+nfs3_rdcache_serve (nfs3_call_state_t *cs, uint64_t *cverf,
+                    struct iatt *dirstat, int *is_eof);
+
+extern void
+nfs3_rdcache_fill (nfs3_call_state_t *cs, struct iatt *dirstat, int is_eof);
+
+extern void
+nfs3_rdcache_invalidate (struct nfs3_state *nfs3, inode_t *inode);
+
+extern void
+nfs3_rdcache_invalidate_parent (struct nfs3_state *nfs3, inode_t *inode);
+
+extern void
+nfs3_rdcache_invalidate_call (nfs3_call_state_t *cs);
+
+extern void
+nfs3_rdcache_priv_dump (struct nfs3_state *nfs3, char *key_prefix);
 #endif
@@ -825,6 +825,7 @@ nfs3svc_truncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         nfs3_call_state_t       *cs = NULL;
 
         cs = frame->local;
+        nfs3_rdcache_invalidate_call (cs);
         if (op_ret == -1) {
                 stat = nfs3_errno_to_nfsstat3 (op_errno);
                 goto nfs3err;
@@ -862,6 +863,7 @@ nfs3svc_setattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         nfs3_call_state_t       *cs = NULL;
 
         cs = frame->local;
+        nfs3_rdcache_invalidate_call (cs);
         if (op_ret == -1) {
                 stat = nfs3_errno_to_nfsstat3 (op_errno);
                 goto nfs3err;
@@ -964,6 +966,11 @@ nfs3_setattr_resume (void *carg)
 
         cs = (nfs3_call_state_t *)carg;
         nfs3_check_fh_resolve_status (cs, stat, nfs3err);
+        /* A size change has to land after the gathered writes. */
+        if (!cs->flush_resume &&
+            nfs3_wgather_drain (cs, nfs3_setattr_resume))
+                return 0;
+
         nfs_request_user_init (&nfu, cs->req);
         /* If no ctime check is required, head straight to setting the attrs. */
         if (cs->sattrguardcheck)
@@ -1750,6 +1757,11 @@ nfs3_read_fd_resume (void *carg)
 
         cs = (nfs3_call_state_t *)carg;
         nfs3_check_fh_resolve_status (cs, stat, nfs3err);
+        /* The read has to see the writes gathered so far. */
+        if (!cs->flush_resume &&
+            nfs3_wgather_drain (cs, nfs3_read_fd_resume))
+                return 0;
+
         nfs_request_user_init (&nfu, cs->req);
         ret = nfs_read (cs->nfsx, cs->vol, &nfu, cs->fd, cs->datacount,
                         cs->dataoffset, nfs3svc_read_cbk, cs);
@@ -1990,6 +2002,7 @@ nfs3svc_write_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         cs = frame->local;
         nfs3 = rpcsvc_request_program_private (cs->req);
+        nfs3_rdcache_invalidate_call (cs);
         if (op_ret == -1) {
                 stat = nfs3_errno_to_nfsstat3 (op_errno);
                 goto err;
@@ -2062,6 +2075,51 @@ __nfs3_write_resume (nfs3_call_state_t *cs)
 }
 
 
+/* Acknowledge a WRITE whose data has been gathered. */
+int
+nfs3_write_gathered_reply (void *carg)
+{
+        nfs3_call_state_t       *cs = NULL;
+        struct nfs3_state       *nfs3 = NULL;
+
+        cs = (nfs3_call_state_t *)carg;
+        nfs3 = cs->nfs3state;
+
+        nfs3_log_write_res (rpcsvc_request_xid (cs->req), NFS3_OK, 0,
+                            cs->datacount, UNSTABLE, nfs3->serverstart);
+        nfs3_write_reply (cs->req, NFS3_OK, cs->datacount, UNSTABLE,
+                          nfs3->serverstart, NULL, NULL);
+        nfs3_call_state_wipe (cs);
+
+        return 0;
+}
+
+
+/* Send a WRITE that was not gathered once the earlier gathered writes of
+ * the file are on the volume.
+ */
+int
+nfs3_write_drained_resume (void *carg)
+{
+        nfsstat3                stat = NFS3ERR_SERVERFAULT;
+        int                     ret = -EFAULT;
+        nfs3_call_state_t       *cs = NULL;
+
+        cs = (nfs3_call_state_t *)carg;
+        ret = __nfs3_write_resume (cs);
+        if (ret < 0) {
+                stat = nfs3_errno_to_nfsstat3 (-ret);
+                nfs3_log_common_res (rpcsvc_request_xid (cs->req), "WRITE",
+                                     stat, -ret);
+                nfs3_write_reply (cs->req, stat, 0, cs->writetype, 0, NULL,
+                                  NULL);
+                nfs3_call_state_wipe (cs);
+        }
+
+        return ret;
+}
+
+
 int
 nfs3_write_resume (void *carg)
 {
@@ -2075,6 +2133,17 @@ nfs3_write_resume (void *carg)
         cs = (nfs3_call_state_t *)carg;
         nfs3_check_fh_resolve_status (cs, stat, nfs3err);
 
+        /* trusted-write already answers UNSTABLE writes as stable */
+        if (!nfs3_export_write_trusted (cs->nfs3state,
+                                        cs->resolvefh.exportid)) {
+                ret = nfs3_wgather_write (cs, nfs3_write_gathered_reply,
+                                          nfs3_write_drained_resume);
+                if (ret == GF_NFS3_WGATHER_GATHERED)
+                        return nfs3_write_gathered_reply (cs);
+                else if (ret == GF_NFS3_WGATHER_QUEUED)
+                        return 0;
+        }
+
         ret = __nfs3_write_resume (cs);
         if (ret < 0)
                 stat = nfs3_errno_to_nfsstat3 (-ret);
@@ -2296,6 +2365,7 @@ nfs3svc_create_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         nfs3_call_state_t       *cs = NULL;
 
         cs = frame->local;
+        nfs3_rdcache_invalidate_call (cs);
         if (op_ret == -1) {
                 stat = nfs3_errno_to_nfsstat3 (op_errno);
                 goto nfs3err;
@@ -2631,6 +2701,7 @@ nfs3svc_mkdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         nfs3_call_state_t               *cs = NULL;
 
         cs = frame->local;
+        nfs3_rdcache_invalidate_call (cs);
         if (op_ret == -1) {
                 stat = nfs3_errno_to_nfsstat3 (op_errno);
                 goto nfs3err;
@@ -2806,6 +2877,7 @@ nfs3svc_symlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         nfs3_call_state_t               *cs = NULL;
 
         cs = frame->local;
+        nfs3_rdcache_invalidate_call (cs);
         if (op_ret == -1) {
                 stat = nfs3_errno_to_nfsstat3 (op_errno);
                 goto nfs3err;
@@ -2994,6 +3066,7 @@ nfs3svc_mknod_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         nfs3_call_state_t               *cs = NULL;
 
         cs = frame->local;
+        nfs3_rdcache_invalidate_call (cs);
         if (op_ret == -1) {
                 stat = nfs3_errno_to_nfsstat3 (op_errno);
                 goto nfs3err;
@@ -3251,6 +3324,7 @@ nfs3svc_remove_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         struct nfs3_state       *nfs3 = NULL;
 
         cs = frame->local;
+        nfs3_rdcache_invalidate_call (cs);
         if (op_ret == -1) {
                 stat = nfs3_errno_to_nfsstat3 (op_errno);
                 goto do_not_unref_cached_fd;
@@ -3265,6 +3339,7 @@ nfs3svc_remove_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 fd_unref (openfd);
                 nfs3_fdcache_remove (nfs3, openfd);
          }
+         nfs3_wgather_forget (nfs3, cs->resolvedloc.inode);
 
 do_not_unref_cached_fd:
         nfs3_log_common_res (rpcsvc_request_xid (cs->req), "REMOVE", stat,
@@ -3423,6 +3498,7 @@ nfs3svc_rmdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         nfs3_call_state_t       *cs = NULL;
 
         cs = frame->local;
+        nfs3_rdcache_invalidate_call (cs);
         if (op_ret == -1)
                 stat = nfs3_errno_to_nfsstat3 (op_errno);
         else {
@@ -3574,6 +3650,7 @@ nfs3svc_rename_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         fd_t                    *openfd = NULL;
 
         cs = frame->local;
+        nfs3_rdcache_invalidate_call (cs);
         if (op_ret == -1) {
                 stat = nfs3_errno_to_nfsstat3 (op_errno);
                 goto nfs3err;
@@ -3591,6 +3668,7 @@ nfs3svc_rename_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 fd_unref (openfd);
                 nfs3_fdcache_remove (cs->nfs3state, openfd);
         }
+        nfs3_wgather_forget (cs->nfs3state, cs->resolvedloc.inode);
 
 nfs3err:
         nfs3_log_common_res (rpcsvc_request_xid (cs->req), "RENAME", stat,
@@ -3786,6 +3864,7 @@ nfs3svc_link_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         nfs3_call_state_t       *cs = NULL;
 
         cs = frame->local;
+        nfs3_rdcache_invalidate_call (cs);
         if (op_ret == -1)
                 stat = nfs3_errno_to_nfsstat3 (op_errno);
         else
@@ -3983,6 +4062,27 @@ nfs3_readdir_reply (rpcsvc_request_t *req, nfsstat3 stat, struct nfs3_fh *dirfh,
 }
 
 
+static void
+nfs3_readdir_entries_reply (nfs3_call_state_t *cs, nfsstat3 stat,
+                            int32_t op_errno, uint64_t cverf,
+                            struct iatt *dirstat, int is_eof)
+{
+        if (cs->maxcount == 0) {
+                nfs3_log_readdir_res (rpcsvc_request_xid (cs->req), stat,
+                                      op_errno, cverf, cs->dircount, is_eof);
+                nfs3_readdir_reply (cs->req, stat, &cs->parent, cverf, dirstat,
+                                    &cs->entries, cs->dircount, is_eof);
+        } else {
+                nfs3_log_readdirp_res (rpcsvc_request_xid (cs->req), stat,
+                                       op_errno, cverf, cs->dircount,
+                                       cs->maxcount, is_eof);
+                nfs3_readdirp_reply (cs->req, stat, &cs->parent, cverf,
+                                     dirstat, &cs->entries, cs->dircount,
+                                     cs->maxcount, is_eof);
+        }
+}
+
+
 int32_t
 nfs3svc_readdir_fstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                            int32_t op_ret, int32_t op_errno, struct iatt *buf)
@@ -4005,29 +4105,12 @@ nfs3svc_readdir_fstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 is_eof = 1;
         }
 
+        /* Before the reply is built, it rewrites the entries. */
+        nfs3_rdcache_fill (cs, buf, is_eof);
         stat = NFS3_OK;
 nfs3err:
-        if (cs->maxcount == 0) {
-                nfs3_log_readdir_res (rpcsvc_request_xid (cs->req), stat,
-                                      op_errno, (uintptr_t)cs->fd,
-                                      cs->dircount, is_eof);
-                nfs3_readdir_reply (cs->req, stat, &cs->parent,
-                                    (uintptr_t)cs->fd, buf, &cs->entries,
-                                    cs->dircount, is_eof);
-        } else {
-                nfs3_log_readdirp_res (rpcsvc_request_xid (cs->req), stat,
-                                       op_errno, (uintptr_t)cs->fd,
-                                       cs->dircount, cs->maxcount, is_eof);
-                nfs3_readdirp_reply (cs->req, stat, &cs->parent,
-                                     (uintptr_t)cs->fd, buf,
-                                     &cs->entries, cs->dircount,
-                                     cs->maxcount, is_eof);
-        }
-
-        if (is_eof) {
-                /* do nothing */
-        }
-
+        nfs3_readdir_entries_reply (cs, stat, op_errno, (uintptr_t)cs->fd, buf,
+                                    is_eof);
         nfs3_call_state_wipe (cs);
         return 0;
 }
@@ -4147,12 +4230,24 @@ nfs3_readdir_open_resume (void *carg)
         nfsstat3                stat = NFS3ERR_SERVERFAULT;
         int                     ret = -EFAULT;
         nfs3_call_state_t       *cs = NULL;
+        struct iatt             dirstat = {0, };
+        uint64_t                cverf = 0;
+        int                     is_eof = 0;
 
         if (!carg)
                 return ret;
 
         cs = (nfs3_call_state_t *)carg;
         nfs3_check_fh_resolve_status (cs, stat, nfs3err);
+        /* A cookie without a verifier is refused by nfs3_verify_dircookie. */
+        if (((cs->cookie == 0) || (cs->cookieverf != 0)) &&
+            (nfs3_rdcache_serve (cs, &cverf, &dirstat, &is_eof) == 0)) {
+                nfs3_readdir_entries_reply (cs, NFS3_OK, 0, cverf, &dirstat,
+                                            is_eof);
+                nfs3_call_state_wipe (cs);
+                return 0;
+        }
+
         ret = nfs3_dir_open_and_resume (cs, nfs3_readdir_read_resume);
         if (ret < 0)
                 stat = nfs3_errno_to_nfsstat3 (-ret);
@@ -4826,6 +4921,18 @@ nfs3_commit_resume (void *carg)
         cs = (nfs3_call_state_t *)carg;
         nfs3_check_fh_resolve_status (cs, stat, nfs3err);
 
+        if (!cs->flush_resume &&
+            nfs3_wgather_drain (cs, nfs3_commit_resume))
+                return 0;
+
+        /* a gathered write that failed to reach the volume */
+        ret = nfs3_wgather_take_error (cs);
+        if (ret) {
+                stat = nfs3_errno_to_nfsstat3 (ret);
+                ret = -ret;
+                goto nfs3err;
+        }
+
         if (nfs3_export_sync_trusted (cs->nfs3state, cs->resolvefh.exportid)) {
                 ret = -1;
                 stat = NFS3_OK;
@@ -4955,28 +5062,28 @@ rpcerr:
 
 
 rpcsvc_actor_t          nfs3svc_actors[NFS3_PROC_COUNT] = {
-        {"NULL",        NFS3_NULL,      nfs3svc_null,   NULL,   NULL},
-        {"GETATTR",     NFS3_GETATTR,   nfs3svc_getattr,NULL,   NULL},
-        {"SETATTR",     NFS3_SETATTR,   nfs3svc_setattr,NULL,   NULL},
-        {"LOOKUP",      NFS3_LOOKUP,    nfs3svc_lookup, NULL,   NULL},
-        {"ACCESS",      NFS3_ACCESS,    nfs3svc_access, NULL,   NULL},
-        {"READLINK",    NFS3_READLINK,  nfs3svc_readlink,NULL,  NULL},
-        {"READ",        NFS3_READ,      nfs3svc_read,   NULL,   NULL},
-        {"WRITE",       NFS3_WRITE,     nfs3svc_write, nfs3svc_write_vec, nfs3svc_write_vecsizer},
-        {"CREATE",      NFS3_CREATE,    nfs3svc_create, NULL,   NULL},
-        {"MKDIR",       NFS3_MKDIR,     nfs3svc_mkdir,  NULL,   NULL},
-        {"SYMLINK",     NFS3_SYMLINK,   nfs3svc_symlink,NULL,   NULL},
-        {"MKNOD",       NFS3_MKNOD,     nfs3svc_mknod,  NULL,   NULL},
-        {"REMOVE",      NFS3_REMOVE,    nfs3svc_remove, NULL,   NULL},
-        {"RMDIR",       NFS3_RMDIR,     nfs3svc_rmdir,  NULL,   NULL},
-        {"RENAME",      NFS3_RENAME,    nfs3svc_rename, NULL,   NULL},
-        {"LINK",        NFS3_LINK,      nfs3svc_link,   NULL,   NULL},
-        {"READDIR",     NFS3_READDIR,   nfs3svc_readdir,NULL,   NULL},
-        {"READDIRPLUS", NFS3_READDIRP,  nfs3svc_readdirp,NULL,  NULL},
-        {"FSSTAT",      NFS3_FSSTAT,    nfs3svc_fsstat, NULL,   NULL},
-        {"FSINFO",      NFS3_FSINFO,    nfs3svc_fsinfo, NULL,   NULL},
-        {"PATHCONF",    NFS3_PATHCONF,  nfs3svc_pathconf,NULL,  NULL},
-        {"COMMIT",      NFS3_COMMIT,    nfs3svc_commit, NULL,   NULL}
+        {"NULL",        NFS3_NULL,      nfs3svc_null,   NULL,   NULL,   RPCSVC_DRC_NONE},
+        {"GETATTR",     NFS3_GETATTR,   nfs3svc_getattr,NULL,   NULL,   RPCSVC_DRC_INFLIGHT},
+        {"SETATTR",     NFS3_SETATTR,   nfs3svc_setattr,NULL,   NULL,   RPCSVC_DRC_REPLAY},
+        {"LOOKUP",      NFS3_LOOKUP,    nfs3svc_lookup, NULL,   NULL,   RPCSVC_DRC_INFLIGHT},
+        {"ACCESS",      NFS3_ACCESS,    nfs3svc_access, NULL,   NULL,   RPCSVC_DRC_INFLIGHT},
+        {"READLINK",    NFS3_READLINK,  nfs3svc_readlink,NULL,  NULL,   RPCSVC_DRC_INFLIGHT},
+        {"READ",        NFS3_READ,      nfs3svc_read,   NULL,   NULL,   RPCSVC_DRC_INFLIGHT},
+        {"WRITE",       NFS3_WRITE,     nfs3svc_write, nfs3svc_write_vec, nfs3svc_write_vecsizer, RPCSVC_DRC_REPLAY},
+        {"CREATE",      NFS3_CREATE,    nfs3svc_create, NULL,   NULL,   RPCSVC_DRC_REPLAY},
+        {"MKDIR",       NFS3_MKDIR,     nfs3svc_mkdir,  NULL,   NULL,   RPCSVC_DRC_REPLAY},
+        {"SYMLINK",     NFS3_SYMLINK,   nfs3svc_symlink,NULL,   NULL,   RPCSVC_DRC_REPLAY},
+        {"MKNOD",       NFS3_MKNOD,     nfs3svc_mknod,  NULL,   NULL,   RPCSVC_DRC_REPLAY},
+        {"REMOVE",      NFS3_REMOVE,    nfs3svc_remove, NULL,   NULL,   RPCSVC_DRC_REPLAY},
+        {"RMDIR",       NFS3_RMDIR,     nfs3svc_rmdir,  NULL,   NULL,   RPCSVC_DRC_REPLAY},
+        {"RENAME",      NFS3_RENAME,    nfs3svc_rename, NULL,   NULL,   RPCSVC_DRC_REPLAY},
+        {"LINK",        NFS3_LINK,      nfs3svc_link,   NULL,   NULL,   RPCSVC_DRC_REPLAY},
+        {"READDIR",     NFS3_READDIR,   nfs3svc_readdir,NULL,   NULL,   RPCSVC_DRC_INFLIGHT},
+        {"READDIRPLUS", NFS3_READDIRP,  nfs3svc_readdirp,NULL,  NULL,   RPCSVC_DRC_INFLIGHT},
+        {"FSSTAT",      NFS3_FSSTAT,    nfs3svc_fsstat, NULL,   NULL,   RPCSVC_DRC_INFLIGHT},
+        {"FSINFO",      NFS3_FSINFO,    nfs3svc_fsinfo, NULL,   NULL,   RPCSVC_DRC_INFLIGHT},
+        {"PATHCONF",    NFS3_PATHCONF,  nfs3svc_pathconf,NULL,  NULL,   RPCSVC_DRC_INFLIGHT},
+        {"COMMIT",      NFS3_COMMIT,    nfs3svc_commit, NULL,   NULL,   RPCSVC_DRC_INFLIGHT}
 };
 
 
@@ -5082,6 +5189,79 @@ nfs3_init_options (struct nfs3_state *nfs3, xlator_t *nfsx)
 
         /* mem-factor */
         nfs3->memfactor = GF_NFS3_DEFAULT_MEMFACTOR;
+
+        /* nfs3.write-gather */
+        nfs3->wgather = 1;
+        if (dict_get (nfsx->options, "nfs3.write-gather")) {
+                ret = dict_get_str_boolean (nfsx->options, "nfs3.write-gather",
+                                            1);
+                if (ret < 0) {
+                        gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to read "
+                                " option: nfs3.write-gather");
+                        ret = -1;
+                        goto err;
+                }
+                nfs3->wgather = ret;
+        }
+
+        /* nfs3.write-gather-limit */
+        nfs3->wgather_limit = GF_NFS3_WGATHER_DEFAULT_LIMIT;
+        if (dict_get (nfsx->options, "nfs3.write-gather-limit")) {
+                ret = dict_get_str (nfsx->options, "nfs3.write-gather-limit",
+                                    &optstr);
+                if (ret < 0) {
+                        gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to read "
+                                " option: nfs3.write-gather-limit");
+                        ret = -1;
+                        goto err;
+                }
+
+                ret = gf_string2bytesize (optstr, &size64);
+                nfs3->wgather_limit = size64;
+                if (ret == -1) {
+                        gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to format"
+                                " option: nfs3.write-gather-limit");
+                        ret = -1;
+                        goto err;
+                }
+        }
+
+        /* nfs3.readdir-cache */
+        nfs3->rdcache = 1;
+        if (dict_get (nfsx->options, "nfs3.readdir-cache")) {
+                ret = dict_get_str_boolean (nfsx->options, "nfs3.readdir-cache",
+                                            1);
+                if (ret < 0) {
+                        gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to read "
+                                " option: nfs3.readdir-cache");
+                        ret = -1;
+                        goto err;
+                }
+                nfs3->rdcache = ret;
+        }
+
+        /* nfs3.readdir-cache-limit */
+        nfs3->rdcache_limit = GF_NFS3_RDCACHE_DEFAULT_LIMIT;
+        if (dict_get (nfsx->options, "nfs3.readdir-cache-limit")) {
+                ret = dict_get_str (nfsx->options, "nfs3.readdir-cache-limit",
+                                    &optstr);
+                if (ret < 0) {
+                        gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to read "
+                                " option: nfs3.readdir-cache-limit");
+                        ret = -1;
+                        goto err;
+                }
+
+                ret = gf_string2bytesize (optstr, &size64);
+                nfs3->rdcache_limit = size64;
+                if (ret == -1) {
+                        gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to format"
+                                " option: nfs3.readdir-cache-limit");
+                        ret = -1;
+                        goto err;
+                }
+        }
+
         ret = 0;
 err:
         return ret;
@@ -5323,6 +5503,7 @@ nfs3_init_state (xlator_t *nfsx)
         int                     ret = -1;
         unsigned int            localpool = 0;
         struct nfs_state        *nfs = NULL;
+        struct timeval          tv = {0, };
 
         if (!nfsx)
                 return NULL;
@@ -5362,7 +5543,14 @@ nfs3_init_state (xlator_t *nfsx)
                 goto free_localpool;
         }
 
-        nfs3->serverstart = (uint64_t)time (NULL);
+        /* The write verifier, it has to differ across restarts even when
+         * they happen within the same second.
+         */
+        gettimeofday (&tv, NULL);
+        nfs3->serverstart = ((uint64_t)tv.tv_sec << 32) |
+                            ((tv.tv_usec << 12) ^ getpid ());
+        nfs3_wgather_init (nfs3);
+        nfs3_rdcache_init (nfs3);
         INIT_LIST_HEAD (&nfs3->fdlru);
         LOCK_INIT (&nfs3->fdlrulock);
         nfs3->fdcount = 0;
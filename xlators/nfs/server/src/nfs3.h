@@ -34,6 +34,7 @@
 #include "nfs-common.h"
 #include "xdr-nfs3.h"
 #include "mem-pool.h"
+#include "timer.h"
 
 #include <sys/statvfs.h>
 
@@ -93,6 +94,92 @@ struct nfs3_export {
 
 #define GF_NFS3_DEFAULT_VOLACCESS       (GF_NFS3_VOLACCESS_RW)
 
+#define GF_NFS3_WGATHER_BUCKETS         64
+#define GF_NFS3_WGATHER_DEFAULT_LIMIT   (64 * GF_UNIT_MB)
+/* Seconds an UNSTABLE write may sit in an open batch before it is flushed
+ * even without a COMMIT.
+ */
+#define GF_NFS3_WGATHER_TIMEOUT         1
+/* Seconds the error of a failed flush is kept for the next COMMIT of the
+ * file before it is dropped.
+ */
+#define GF_NFS3_WGATHER_ERROR_TIMEOUT   60
+
+/* A run of adjacent UNSTABLE writes, copied into one iobuf and written
+ * to the volume with a single writev.
+ */
+struct nfs3_wbatch {
+        struct list_head        list;           /* in wgather->batches */
+        struct list_head        kickq;          /* batches picked for flush */
+        struct nfs3_wgather     *wgather;
+        struct iobuf            *iob;
+        struct iobref           *iobref;
+        struct iovec            vec;
+        off_t                   offset;
+        size_t                  size;
+        size_t                  bufsize;        /* charged to wgather_bytes */
+        int                     closed;
+        time_t                  stamp;          /* first write gathered */
+        nfs_user_t              nfu;
+        /* Call states resumed once this batch has been written */
+        struct list_head        waiters;
+};
+
+/* Per file UNSTABLE write gathering state. Batches are flushed one at a
+ * time, oldest first, so that writes reach the volume in the order they
+ * were acknowledged: a batch that does not follow on from the previous one
+ * may overwrite part of it. Different files flush in parallel.
+ */
+struct nfs3_wgather {
+        struct list_head        hash;           /* in nfs3->wgather_table */
+        struct nfs3_state       *nfs3;
+        inode_t                 *inode;
+        fd_t                    *fd;
+        xlator_t                *vol;
+        struct list_head        batches;
+        int                     flushing;
+        int                     error;          /* errno of a failed flush */
+        time_t                  errstamp;       /* when error was set */
+};
+
+#define GF_NFS3_RDCACHE_BUCKETS         64
+#define GF_NFS3_RDCACHE_DEFAULT_LIMIT   (32 * GF_UNIT_MB)
+/* Seconds a cached readdir batch is served before the directory is read
+ * from the volume again.
+ */
+#define GF_NFS3_RDCACHE_TIMEOUT         3
+
+/* The entries the volume returned for one readdirp at a cookie. */
+struct nfs3_rdbatch {
+        struct list_head        list;           /* in rddir->batches */
+        cookie3                 cookie;
+        gf_dirent_t             entries;
+        int                     eof;
+        size_t                  size;
+        time_t                  stamp;
+};
+
+/* Per directory readdir cache, shared by every client listing the
+ * directory. Holds the dir fd open so that the batch following the last
+ * one served can be read ahead.
+ */
+struct nfs3_rddir {
+        struct list_head        hash;           /* in nfs3->rdcache_table */
+        struct list_head        lru;            /* in nfs3->rdcache_lru */
+        struct nfs3_state       *nfs3;
+        int                     refcount;
+        int                     hashed;
+        inode_t                 *inode;
+        fd_t                    *fd;
+        xlator_t                *vol;
+        struct iatt             dirstat;
+        count3                  bufsize;        /* readdirp size to prefetch */
+        struct list_head        batches;
+        size_t                  size;
+        int                     prefetching;
+        cookie3                 prefetch_cookie;
+};
+
 /* The NFSv3 protocol state */
 struct nfs3_state {
 
@@ -133,6 +220,26 @@ struct nfs3_state {
         struct list_head        fdlru;
         gf_lock_t               fdlrulock;
         int                     fdcount;
+
+        /* UNSTABLE write gathering */
+        int                     wgather;
+        size_t                  wgather_limit;
+        struct list_head        wgather_table[GF_NFS3_WGATHER_BUCKETS];
+        gf_lock_t               wgather_lock;
+        size_t                  wgather_bytes;  /* iobufs held by batches */
+        gf_timer_t              *wgather_timer;
+
+        /* READDIR/READDIRPLUS batch cache */
+        int                     rdcache;
+        size_t                  rdcache_limit;
+        struct list_head        rdcache_table[GF_NFS3_RDCACHE_BUCKETS];
+        struct list_head        rdcache_lru;
+        gf_lock_t               rdcache_lock;
+        size_t                  rdcache_bytes;
+        uint64_t                rdcache_hits;
+        uint64_t                rdcache_misses;
+        uint64_t                rdcache_prefetches;
+        uint64_t                rdcache_evictions;
 };
 
 typedef enum nfs3_lookup_type {
@@ -203,7 +310,14 @@ struct nfs3_local {
         int                     hashidx;
         fd_t                    *resolve_dir_fd;
         char                    *resolventry;
+        int                     resolve_nameless; /* gfid lookup tried */
         nfs3_lookup_type_t      lookuptype;
+
+        /* The list hook and the resume function of a call state waiting
+         * for the gathered writes of its file to be flushed.
+         */
+        struct list_head        flushwait_q;
+        nfs3_resume_fn_t        flush_resume;
 };
 
 #define nfs3_is_revalidate_lookup(cst) ((cst)->lookuptype == GF_NFS3_REVALIDATE)
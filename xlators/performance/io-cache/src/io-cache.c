@@ -1359,6 +1359,85 @@ ioc_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
         return 0;
 }
 
+/*
+ * ioc_fallocate -
+ *
+ * @frame:
+ * @this:
+ * @fd:
+ * @offset:
+ * @len:
+ *
+ */
+int32_t
+ioc_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+               int32_t keep_size, off_t offset, size_t len)
+{
+        uint64_t ioc_inode = 0;
+
+        inode_ctx_get (fd->inode, this, &ioc_inode);
+
+        if (ioc_inode)
+                ioc_inode_flush ((ioc_inode_t *)(long)ioc_inode);
+
+        STACK_WIND (frame, ioc_ftruncate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->fallocate, fd, keep_size, offset, len);
+        return 0;
+}
+
+/*
+ * ioc_discard -
+ *
+ * @frame:
+ * @this:
+ * @fd:
+ * @offset:
+ * @len:
+ *
+ */
+int32_t
+ioc_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             off_t offset, size_t len)
+{
+        uint64_t ioc_inode = 0;
+
+        inode_ctx_get (fd->inode, this, &ioc_inode);
+
+        if (ioc_inode)
+                ioc_inode_flush ((ioc_inode_t *)(long)ioc_inode);
+
+        STACK_WIND (frame, ioc_ftruncate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->discard, fd, offset, len);
+        return 0;
+}
+
+/*
+ * ioc_zerofill -
+ *
+ * @frame:
+ * @this:
+ * @fd:
+ * @offset:
+ * @len:
+ *
+ */
+int32_t
+ioc_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              int32_t keep_size, off_t offset, size_t len)
+{
+        uint64_t ioc_inode = 0;
+
+        inode_ctx_get (fd->inode, this, &ioc_inode);
+
+        if (ioc_inode)
+                ioc_inode_flush ((ioc_inode_t *)(long)ioc_inode);
+
+        STACK_WIND (frame, ioc_ftruncate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->zerofill, fd, keep_size,
+                    offset, len);
+        return 0;
+}
+
 int32_t
 ioc_lk_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
             int32_t op_errno, struct gf_flock *lock)
@@ -1884,6 +1963,9 @@ struct xlator_fops fops = {
         .writev      = ioc_writev,
         .truncate    = ioc_truncate,
         .ftruncate   = ioc_ftruncate,
+        .fallocate   = ioc_fallocate,
+        .discard     = ioc_discard,
+        .zerofill    = ioc_zerofill,
         .lookup      = ioc_lookup,
         .lk          = ioc_lk,
         .setattr     = ioc_setattr,
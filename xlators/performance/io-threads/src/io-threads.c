@@ -1267,6 +1267,163 @@ out:
 
 
 
+int
+iot_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                   struct iatt *postbuf)
+{
+	STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+	return 0;
+}
+
+
+int
+iot_fallocate_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       int32_t keep_size, off_t offset, size_t len)
+{
+	STACK_WIND (frame, iot_fallocate_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->fallocate,
+		    fd, keep_size, offset, len);
+	return 0;
+}
+
+
+int
+iot_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+               int32_t keep_size, off_t offset, size_t len)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_fallocate_stub (frame, iot_fallocate_wrapper, fd, keep_size, offset, len);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_fallocate call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule_slow (this->private, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (fallocate, frame, -1, -ret, NULL, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
+int
+iot_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf)
+{
+	STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+	return 0;
+}
+
+
+int
+iot_discard_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     off_t offset, size_t len)
+{
+	STACK_WIND (frame, iot_discard_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->discard,
+		    fd, offset, len);
+	return 0;
+}
+
+
+int
+iot_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             off_t offset, size_t len)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_discard_stub (frame, iot_discard_wrapper, fd, offset, len);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_discard call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule_slow (this->private, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (discard, frame, -1, -ret, NULL, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
+int
+iot_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf)
+{
+	STACK_UNWIND_STRICT (zerofill, frame, op_ret, op_errno, prebuf,
+                             postbuf);
+	return 0;
+}
+
+
+int
+iot_zerofill_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                      int32_t keep_size, off_t offset, size_t len)
+{
+	STACK_WIND (frame, iot_zerofill_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->zerofill,
+		    fd, keep_size, offset, len);
+	return 0;
+}
+
+
+int
+iot_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              int32_t keep_size, off_t offset, size_t len)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_zerofill_stub (frame, iot_zerofill_wrapper, fd, keep_size,
+                                  offset, len);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_zerofill call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule_slow (this->private, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (zerofill, frame, -1, -ret, NULL, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
 int
 iot_unlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 		int32_t op_ret, int32_t op_errno, struct iatt *preparent,
@@ -2188,6 +2345,9 @@ struct xlator_fops fops = {
 	.fstat       = iot_fstat,
 	.truncate    = iot_truncate,
 	.ftruncate   = iot_ftruncate,
+	.fallocate   = iot_fallocate,
+	.discard     = iot_discard,
+	.zerofill    = iot_zerofill,
 	.unlink      = iot_unlink,
         .lookup      = iot_lookup,
         .setattr     = iot_setattr,
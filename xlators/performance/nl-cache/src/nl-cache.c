@@ -0,0 +1,835 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+/* nl-cache: remembers the names a lookup found missing (ENOENT), per
+ * parent directory, and answers further lookups of them without going
+ * down the graph until the entry times out. Entries created through
+ * this translator (create, mknod, mkdir, symlink, link, rename) drop the
+ * cached name at once; entries created by other clients become visible
+ * after at most "timeout" seconds.
+ */
+
+#include "nl-cache.h"
+#include "statedump.h"
+
+
+void
+nlc_local_free (nlc_local_t *local)
+{
+        if (local == NULL)
+                return;
+
+        loc_wipe (&local->loc);
+        GF_FREE (local);
+}
+
+
+static nlc_local_t *
+nlc_local_new (loc_t *loc)
+{
+        nlc_local_t *local = NULL;
+
+        local = GF_CALLOC (1, sizeof (*local), gf_nlc_mt_nlc_local_t);
+        if (local == NULL)
+                return NULL;
+
+        if (loc_copy (&local->loc, loc) == -1) {
+                GF_FREE (local);
+                return NULL;
+        }
+
+        return local;
+}
+
+
+static inline uint32_t
+nlc_hash (nlc_ctx_t *ctx, const char *name)
+{
+        uint32_t hash = 0;
+
+        hash = SuperFastHash (name, strlen (name));
+        hash ^= (uint32_t)((unsigned long)ctx >> 4);
+
+        return hash & (NLC_HASH_BUCKETS - 1);
+}
+
+
+static nlc_ne_t *
+__nlc_ne_get (nlc_private_t *priv, nlc_ctx_t *ctx, const char *name)
+{
+        nlc_ne_t *ne = NULL;
+
+        list_for_each_entry (ne, &priv->buckets[nlc_hash (ctx, name)],
+                             hash) {
+                if ((ne->ctx == ctx) && !strcmp (ne->name, name))
+                        return ne;
+        }
+
+        return NULL;
+}
+
+
+static void
+__nlc_ne_destroy (nlc_private_t *priv, nlc_ne_t *ne)
+{
+        list_del (&ne->hash);
+        list_del (&ne->list);
+        list_del (&ne->lru);
+
+        ne->ctx->count--;
+        priv->entries--;
+
+        GF_FREE (ne);
+}
+
+
+/* No entry has its expiry pushed back, so the lru list is also ordered
+ * by expiry time: both expired entries and those over the limit are
+ * taken from its head.
+ */
+static void
+__nlc_prune (nlc_private_t *priv, time_t now)
+{
+        nlc_ne_t *ne = NULL, *tmp = NULL;
+
+        list_for_each_entry_safe (ne, tmp, &priv->lru, lru) {
+                if (ne->expire <= now) {
+                        priv->stats.expired++;
+                } else if (priv->entries > priv->conf.limit) {
+                        priv->stats.evictions++;
+                } else {
+                        break;
+                }
+
+                __nlc_ne_destroy (priv, ne);
+        }
+}
+
+
+static void
+__nlc_ne_add (nlc_private_t *priv, nlc_ctx_t *ctx, const char *name,
+              time_t now)
+{
+        nlc_ne_t *ne  = NULL;
+        size_t    len = 0;
+
+        ne = __nlc_ne_get (priv, ctx, name);
+        if (ne != NULL) {
+                /* a lookup which was already on its way when the entry
+                   got cached */
+                return;
+        }
+
+        len = strlen (name);
+        ne = GF_CALLOC (1, sizeof (*ne) + len + 1, gf_nlc_mt_nlc_ne_t);
+        if (ne == NULL)
+                return;
+
+        memcpy (ne->name, name, len + 1);
+        ne->ctx = ctx;
+        ne->expire = now + priv->conf.timeout;
+
+        list_add (&ne->hash, &priv->buckets[nlc_hash (ctx, name)]);
+        list_add_tail (&ne->list, &ctx->entries);
+        list_add_tail (&ne->lru, &priv->lru);
+
+        ctx->count++;
+        priv->entries++;
+
+        __nlc_prune (priv, now);
+}
+
+
+static nlc_ctx_t *
+nlc_ctx_get (xlator_t *this, inode_t *inode, gf_boolean_t create)
+{
+        nlc_ctx_t *ctx   = NULL;
+        uint64_t   value = 0;
+        int        ret   = -1;
+
+        LOCK (&inode->lock);
+        {
+                ret = __inode_ctx_get (inode, this, &value);
+                if (ret == 0) {
+                        ctx = (nlc_ctx_t *)(long)value;
+                        goto unlock;
+                }
+
+                if (!create)
+                        goto unlock;
+
+                ctx = GF_CALLOC (1, sizeof (*ctx), gf_nlc_mt_nlc_ctx_t);
+                if (ctx == NULL)
+                        goto unlock;
+
+                INIT_LIST_HEAD (&ctx->entries);
+
+                ret = __inode_ctx_put (inode, this, (uint64_t)(long)ctx);
+                if (ret == -1) {
+                        GF_FREE (ctx);
+                        ctx = NULL;
+                }
+        }
+unlock:
+        UNLOCK (&inode->lock);
+
+        return ctx;
+}
+
+
+/* name now exists in parent, or is about to */
+static void
+nlc_invalidate (xlator_t *this, inode_t *parent, const char *name,
+                struct iatt *postparent)
+{
+        nlc_private_t *priv = NULL;
+        nlc_ctx_t     *ctx  = NULL;
+        nlc_ne_t      *ne   = NULL;
+
+        priv = this->private;
+
+        if ((parent == NULL) || (name == NULL))
+                return;
+
+        ctx = nlc_ctx_get (this, parent, _gf_false);
+        if (ctx == NULL)
+                return;
+
+        LOCK (&priv->lock);
+        {
+                ctx->gen++;
+
+                ne = __nlc_ne_get (priv, ctx, name);
+                if (ne != NULL) {
+                        __nlc_ne_destroy (priv, ne);
+                        priv->stats.invalidations++;
+                }
+
+                if (postparent != NULL)
+                        ctx->postparent = *postparent;
+        }
+        UNLOCK (&priv->lock);
+}
+
+
+int32_t
+nlc_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, inode_t *inode,
+                struct iatt *buf, dict_t *dict, struct iatt *postparent)
+{
+        nlc_private_t *priv  = NULL;
+        nlc_local_t   *local = NULL;
+        nlc_ctx_t     *ctx   = NULL;
+
+        priv = this->private;
+        local = frame->local;
+
+        if (local == NULL)
+                goto out;
+
+        if (op_ret == 0) {
+                nlc_invalidate (this, local->loc.parent, local->loc.name,
+                                NULL);
+                goto out;
+        }
+
+        if ((op_errno != ENOENT) || (postparent == NULL))
+                goto out;
+
+        ctx = nlc_ctx_get (this, local->loc.parent, _gf_true);
+        if (ctx == NULL)
+                goto out;
+
+        LOCK (&priv->lock);
+        {
+                if (ctx->gen == local->gen) {
+                        __nlc_ne_add (priv, ctx, local->loc.name,
+                                      time (NULL));
+                        ctx->postparent = *postparent;
+                        priv->stats.misses++;
+                }
+        }
+        UNLOCK (&priv->lock);
+
+out:
+        NLC_STACK_UNWIND (lookup, frame, op_ret, op_errno, inode, buf, dict,
+                          postparent);
+        return 0;
+}
+
+
+int32_t
+nlc_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc,
+            dict_t *xattr_req)
+{
+        nlc_private_t *priv       = NULL;
+        nlc_local_t   *local      = NULL;
+        nlc_ctx_t     *ctx        = NULL;
+        nlc_ne_t      *ne         = NULL;
+        struct iatt    postparent = {0, };
+        gf_boolean_t   hit        = _gf_false;
+        uint64_t       gen        = 0;
+        time_t         now        = 0;
+
+        priv = this->private;
+
+        /* nameless lookups and revalidates of inodes we already know
+           exist go straight down */
+        if ((loc->parent == NULL) || (loc->name == NULL)
+            || (loc->inode && (loc->inode->ia_type != IA_INVAL)))
+                goto wind;
+
+        ctx = nlc_ctx_get (this, loc->parent, _gf_true);
+        if (ctx == NULL)
+                goto wind;
+
+        now = time (NULL);
+
+        LOCK (&priv->lock);
+        {
+                priv->stats.lookups++;
+
+                ne = __nlc_ne_get (priv, ctx, loc->name);
+                if (ne && (ne->expire > now)) {
+                        postparent = ctx->postparent;
+                        priv->stats.hits++;
+                        hit = _gf_true;
+                } else if (ne) {
+                        __nlc_ne_destroy (priv, ne);
+                        priv->stats.expired++;
+                }
+
+                gen = ctx->gen;
+        }
+        UNLOCK (&priv->lock);
+
+        if (hit) {
+                STACK_UNWIND_STRICT (lookup, frame, -1, ENOENT, NULL, NULL,
+                                     NULL, &postparent);
+                return 0;
+        }
+
+        local = nlc_local_new (loc);
+        if (local == NULL) {
+                /* without it the reply is just not cached */
+                goto wind;
+        }
+
+        local->gen = gen;
+        frame->local = local;
+
+wind:
+        STACK_WIND (frame, nlc_lookup_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->lookup, loc, xattr_req);
+        return 0;
+}
+
+
+/* Every fop which makes a name appear drops it from the cache both
+ * before winding, so that a lookup sent after it does not get cached,
+ * and in the callback, for a lookup whose ENOENT arrived in between.
+ */
+
+int32_t
+nlc_new_entry_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, inode_t *inode,
+                   struct iatt *buf, struct iatt *preparent,
+                   struct iatt *postparent)
+{
+        nlc_local_t *local = NULL;
+
+        local = frame->local;
+
+        nlc_invalidate (this, local->loc.parent, local->loc.name,
+                        (op_ret == 0) ? postparent : NULL);
+
+        NLC_STACK_UNWIND (mkdir, frame, op_ret, op_errno, inode, buf,
+                          preparent, postparent);
+        return 0;
+}
+
+
+int32_t
+nlc_create_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, fd_t *fd, inode_t *inode,
+                struct iatt *buf, struct iatt *preparent,
+                struct iatt *postparent)
+{
+        nlc_local_t *local = NULL;
+
+        local = frame->local;
+
+        nlc_invalidate (this, local->loc.parent, local->loc.name,
+                        (op_ret == 0) ? postparent : NULL);
+
+        NLC_STACK_UNWIND (create, frame, op_ret, op_errno, fd, inode, buf,
+                          preparent, postparent);
+        return 0;
+}
+
+
+int32_t
+nlc_create (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+            mode_t mode, fd_t *fd, dict_t *params)
+{
+        nlc_local_t *local = NULL;
+
+        local = nlc_local_new (loc);
+        if (local == NULL) {
+                STACK_UNWIND_STRICT (create, frame, -1, ENOMEM, NULL, NULL,
+                                     NULL, NULL, NULL);
+                return 0;
+        }
+
+        frame->local = local;
+        nlc_invalidate (this, loc->parent, loc->name, NULL);
+
+        STACK_WIND (frame, nlc_create_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->create, loc, flags, mode, fd,
+                    params);
+        return 0;
+}
+
+
+int32_t
+nlc_mknod (call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+           dev_t rdev, dict_t *params)
+{
+        nlc_local_t *local = NULL;
+
+        local = nlc_local_new (loc);
+        if (local == NULL) {
+                STACK_UNWIND_STRICT (mknod, frame, -1, ENOMEM, NULL, NULL,
+                                     NULL, NULL);
+                return 0;
+        }
+
+        frame->local = local;
+        nlc_invalidate (this, loc->parent, loc->name, NULL);
+
+        STACK_WIND (frame, nlc_new_entry_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->mknod, loc, mode, rdev, params);
+        return 0;
+}
+
+
+int32_t
+nlc_mkdir (call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+           dict_t *params)
+{
+        nlc_local_t *local = NULL;
+
+        local = nlc_local_new (loc);
+        if (local == NULL) {
+                STACK_UNWIND_STRICT (mkdir, frame, -1, ENOMEM, NULL, NULL,
+                                     NULL, NULL);
+                return 0;
+        }
+
+        frame->local = local;
+        nlc_invalidate (this, loc->parent, loc->name, NULL);
+
+        STACK_WIND (frame, nlc_new_entry_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->mkdir, loc, mode, params);
+        return 0;
+}
+
+
+int32_t
+nlc_symlink (call_frame_t *frame, xlator_t *this, const char *linkpath,
+             loc_t *loc, dict_t *params)
+{
+        nlc_local_t *local = NULL;
+
+        local = nlc_local_new (loc);
+        if (local == NULL) {
+                STACK_UNWIND_STRICT (symlink, frame, -1, ENOMEM, NULL, NULL,
+                                     NULL, NULL);
+                return 0;
+        }
+
+        frame->local = local;
+        nlc_invalidate (this, loc->parent, loc->name, NULL);
+
+        STACK_WIND (frame, nlc_new_entry_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->symlink, linkpath, loc, params);
+        return 0;
+}
+
+
+int32_t
+nlc_link (call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc)
+{
+        nlc_local_t *local = NULL;
+
+        local = nlc_local_new (newloc);
+        if (local == NULL) {
+                STACK_UNWIND_STRICT (link, frame, -1, ENOMEM, NULL, NULL,
+                                     NULL, NULL);
+                return 0;
+        }
+
+        frame->local = local;
+        nlc_invalidate (this, newloc->parent, newloc->name, NULL);
+
+        STACK_WIND (frame, nlc_new_entry_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->link, oldloc, newloc);
+        return 0;
+}
+
+
+int32_t
+nlc_rename_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *buf,
+                struct iatt *preoldparent, struct iatt *postoldparent,
+                struct iatt *prenewparent, struct iatt *postnewparent)
+{
+        nlc_local_t *local = NULL;
+
+        local = frame->local;
+
+        nlc_invalidate (this, local->loc.parent, local->loc.name,
+                        (op_ret == 0) ? postnewparent : NULL);
+
+        NLC_STACK_UNWIND (rename, frame, op_ret, op_errno, buf, preoldparent,
+                          postoldparent, prenewparent, postnewparent);
+        return 0;
+}
+
+
+int32_t
+nlc_rename (call_frame_t *frame, xlator_t *this, loc_t *oldloc,
+            loc_t *newloc)
+{
+        nlc_local_t *local = NULL;
+
+        local = nlc_local_new (newloc);
+        if (local == NULL) {
+                STACK_UNWIND_STRICT (rename, frame, -1, ENOMEM, NULL, NULL,
+                                     NULL, NULL, NULL);
+                return 0;
+        }
+
+        frame->local = local;
+        nlc_invalidate (this, newloc->parent, newloc->name, NULL);
+
+        STACK_WIND (frame, nlc_rename_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->rename, oldloc, newloc);
+        return 0;
+}
+
+
+int32_t
+nlc_forget (xlator_t *this, inode_t *inode)
+{
+        nlc_private_t *priv  = NULL;
+        nlc_ctx_t     *ctx   = NULL;
+        nlc_ne_t      *ne    = NULL, *tmp = NULL;
+        uint64_t       value = 0;
+
+        priv = this->private;
+
+        inode_ctx_del (inode, this, &value);
+        ctx = (nlc_ctx_t *)(long)value;
+        if (ctx == NULL)
+                return 0;
+
+        LOCK (&priv->lock);
+        {
+                list_for_each_entry_safe (ne, tmp, &ctx->entries, list) {
+                        __nlc_ne_destroy (priv, ne);
+                }
+        }
+        UNLOCK (&priv->lock);
+
+        GF_FREE (ctx);
+        return 0;
+}
+
+
+int32_t
+nlc_inodectx_dump (xlator_t *this, inode_t *inode)
+{
+        nlc_private_t *priv  = NULL;
+        nlc_ctx_t     *ctx   = NULL;
+        uint64_t       value = 0;
+        uint32_t       count = 0;
+        uint64_t       gen   = 0;
+        char           key[GF_DUMP_MAX_BUF_LEN];
+        char           key_prefix[GF_DUMP_MAX_BUF_LEN];
+
+        priv = this->private;
+
+        if (inode_ctx_get (inode, this, &value) != 0)
+                return -1;
+
+        ctx = (nlc_ctx_t *)(long)value;
+        if (ctx == NULL)
+                return -1;
+
+        LOCK (&priv->lock);
+        {
+                count = ctx->count;
+                gen = ctx->gen;
+        }
+        UNLOCK (&priv->lock);
+
+        gf_proc_dump_build_key (key_prefix, "xlator.performance.nl-cache",
+                                "inodectx");
+        gf_proc_dump_add_section (key_prefix);
+
+        gf_proc_dump_build_key (key, key_prefix, "inode.gfid");
+        gf_proc_dump_write (key, "%s", uuid_utoa (inode->gfid));
+        gf_proc_dump_build_key (key, key_prefix, "negative_entries");
+        gf_proc_dump_write (key, "%u", count);
+        gf_proc_dump_build_key (key, key_prefix, "generation");
+        gf_proc_dump_write (key, "%"PRIu64, gen);
+
+        return 0;
+}
+
+
+int32_t
+nlc_priv_dump (xlator_t *this)
+{
+        nlc_private_t *priv    = NULL;
+        nlc_stats_t    stats   = {0, };
+        nlc_conf_t     conf    = {0, };
+        uint32_t       entries = 0;
+        char           key[GF_DUMP_MAX_BUF_LEN];
+        char           key_prefix[GF_DUMP_MAX_BUF_LEN];
+
+        if (!this || !this->private)
+                return -1;
+
+        priv = this->private;
+
+        LOCK (&priv->lock);
+        {
+                stats = priv->stats;
+                conf = priv->conf;
+                entries = priv->entries;
+        }
+        UNLOCK (&priv->lock);
+
+        gf_proc_dump_build_key (key_prefix, "xlator.performance.nl-cache",
+                                "priv");
+        gf_proc_dump_add_section (key_prefix);
+
+        gf_proc_dump_build_key (key, key_prefix, "timeout");
+        gf_proc_dump_write (key, "%d", conf.timeout);
+        gf_proc_dump_build_key (key, key_prefix, "limit");
+        gf_proc_dump_write (key, "%u", conf.limit);
+        gf_proc_dump_build_key (key, key_prefix, "entries");
+        gf_proc_dump_write (key, "%u", entries);
+
+        gf_proc_dump_build_key (key, key_prefix, "lookups");
+        gf_proc_dump_write (key, "%"PRIu64, stats.lookups);
+        gf_proc_dump_build_key (key, key_prefix, "hits");
+        gf_proc_dump_write (key, "%"PRIu64, stats.hits);
+        gf_proc_dump_build_key (key, key_prefix, "misses");
+        gf_proc_dump_write (key, "%"PRIu64, stats.misses);
+        /* hits / (hits + misses): the ENOENT lookups the cache answered,
+           hits / lookups: the named lookups it kept off the network */
+        gf_proc_dump_build_key (key, key_prefix, "hit_ratio");
+        gf_proc_dump_write (key, "%.3f", (stats.hits + stats.misses)
+                            ? (double)stats.hits / (stats.hits + stats.misses)
+                            : 0.0);
+        gf_proc_dump_build_key (key, key_prefix, "lookup_hit_ratio");
+        gf_proc_dump_write (key, "%.3f", stats.lookups
+                            ? (double)stats.hits / stats.lookups : 0.0);
+        gf_proc_dump_build_key (key, key_prefix, "invalidations");
+        gf_proc_dump_write (key, "%"PRIu64, stats.invalidations);
+        gf_proc_dump_build_key (key, key_prefix, "expired");
+        gf_proc_dump_write (key, "%"PRIu64, stats.expired);
+        gf_proc_dump_build_key (key, key_prefix, "evictions");
+        gf_proc_dump_write (key, "%"PRIu64, stats.evictions);
+
+        return 0;
+}
+
+
+int32_t
+mem_acct_init (xlator_t *this)
+{
+        int     ret = -1;
+
+        if (!this)
+                return ret;
+
+        ret = xlator_mem_acct_init (this, gf_nlc_mt_end + 1);
+
+        if (ret != 0) {
+                gf_log (this->name, GF_LOG_ERROR, "Memory accounting init"
+                        "failed");
+                return ret;
+        }
+
+        return ret;
+}
+
+
+int
+reconfigure (xlator_t *this, dict_t *options)
+{
+        nlc_private_t *priv = NULL;
+        nlc_conf_t     conf = {0, };
+        int            ret  = -1;
+
+        GF_VALIDATE_OR_GOTO ("nl-cache", this, out);
+        GF_VALIDATE_OR_GOTO (this->name, this->private, out);
+        GF_VALIDATE_OR_GOTO (this->name, options, out);
+
+        priv = this->private;
+        conf = priv->conf;
+
+        GF_OPTION_RECONF ("timeout", conf.timeout, options, int32, out);
+
+        GF_OPTION_RECONF ("limit", conf.limit, options, uint32, out);
+
+        LOCK (&priv->lock);
+        {
+                priv->conf = conf;
+                __nlc_prune (priv, time (NULL));
+        }
+        UNLOCK (&priv->lock);
+
+        ret = 0;
+out:
+        return ret;
+}
+
+
+int32_t
+init (xlator_t *this)
+{
+        nlc_private_t *priv = NULL;
+        int32_t        ret  = -1;
+        int            i    = 0;
+
+        if (!this->children || this->children->next) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "FATAL: volume (%s) not configured with exactly one "
+                        "child", this->name);
+                return -1;
+        }
+
+        if (!this->parents) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "dangling volume. check volfile ");
+        }
+
+        priv = GF_CALLOC (1, sizeof (*priv), gf_nlc_mt_nlc_private_t);
+        if (priv == NULL)
+                goto out;
+
+        GF_OPTION_INIT ("timeout", priv->conf.timeout, int32, out);
+
+        GF_OPTION_INIT ("limit", priv->conf.limit, uint32, out);
+
+        priv->buckets = GF_CALLOC (NLC_HASH_BUCKETS, sizeof (*priv->buckets),
+                                   gf_nlc_mt_list_head);
+        if (priv->buckets == NULL)
+                goto out;
+
+        for (i = 0; i < NLC_HASH_BUCKETS; i++)
+                INIT_LIST_HEAD (&priv->buckets[i]);
+
+        INIT_LIST_HEAD (&priv->lru);
+        LOCK_INIT (&priv->lock);
+
+        this->private = priv;
+        ret = 0;
+out:
+        if ((ret == -1) && priv) {
+                GF_FREE (priv->buckets);
+                GF_FREE (priv);
+        }
+
+        return ret;
+}
+
+
+void
+fini (xlator_t *this)
+{
+        nlc_private_t *priv = NULL;
+        nlc_ne_t      *ne   = NULL, *tmp = NULL;
+
+        priv = this->private;
+        if (priv == NULL)
+                return;
+
+        /* the ctxs go with the inode table, only the entries are ours */
+        list_for_each_entry_safe (ne, tmp, &priv->lru, lru) {
+                list_del (&ne->lru);
+                GF_FREE (ne);
+        }
+
+        LOCK_DESTROY (&priv->lock);
+        GF_FREE (priv->buckets);
+        GF_FREE (priv);
+        this->private = NULL;
+}
+
+
+struct xlator_fops fops = {
+        .lookup      = nlc_lookup,
+        .create      = nlc_create,
+        .mknod       = nlc_mknod,
+        .mkdir       = nlc_mkdir,
+        .symlink     = nlc_symlink,
+        .link        = nlc_link,
+        .rename      = nlc_rename,
+};
+
+struct xlator_cbks cbks = {
+        .forget      = nlc_forget,
+};
+
+struct xlator_dumpops dumpops = {
+        .priv        = nlc_priv_dump,
+        .inodectx    = nlc_inodectx_dump,
+};
+
+struct volume_options options[] = {
+        { .key  = {"timeout"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 3600,
+          .default_value = "60",
+          .description = "Seconds a name found missing is answered as "
+                         "missing without asking the servers. Names created "
+                         "by other clients are seen after at most this long."
+        },
+        { .key  = {"limit"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 16 * 1048576,
+          .default_value = "131072",
+          .description = "Most missing names remembered, over all "
+                         "directories. The oldest go first."
+        },
+        { .key  = {NULL} },
+};
@@ -0,0 +1,106 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _NL_CACHE_H
+#define _NL_CACHE_H
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "glusterfs.h"
+#include "logging.h"
+#include "dict.h"
+#include "xlator.h"
+#include "inode.h"
+#include "list.h"
+#include "locking.h"
+#include "hashfn.h"
+#include "nl-cache-mem-types.h"
+
+#define NLC_HASH_BUCKETS 16384
+
+struct nlc_ctx;
+
+/* a name known not to exist in a directory */
+struct nlc_ne {
+        struct list_head  hash;          /* in priv->buckets */
+        struct list_head  list;          /* in ctx->entries */
+        struct list_head  lru;           /* in priv->lru, oldest first */
+        struct nlc_ctx   *ctx;
+        time_t            expire;
+        char              name[0];
+};
+typedef struct nlc_ne nlc_ne_t;
+
+/* inode ctx of a directory names were looked up in */
+struct nlc_ctx {
+        struct list_head  entries;
+        uint32_t          count;
+        uint64_t          gen;           /* bumped by every new entry, so
+                                            that lookups which raced with
+                                            one do not cache ENOENT */
+        struct iatt       postparent;    /* answered along with hits */
+};
+typedef struct nlc_ctx nlc_ctx_t;
+
+struct nlc_local {
+        loc_t             loc;
+        uint64_t          gen;
+};
+typedef struct nlc_local nlc_local_t;
+
+struct nlc_conf {
+        int32_t           timeout;
+        uint32_t          limit;
+};
+typedef struct nlc_conf nlc_conf_t;
+
+struct nlc_stats {
+        uint64_t          lookups;       /* named lookups seen */
+        uint64_t          hits;          /* answered ENOENT from the cache */
+        uint64_t          misses;        /* ENOENT from below, now cached */
+        uint64_t          invalidations; /* dropped by an entry created here */
+        uint64_t          expired;
+        uint64_t          evictions;     /* dropped to stay within limit */
+};
+typedef struct nlc_stats nlc_stats_t;
+
+/* ctx fields and all entries are under priv->lock */
+struct nlc_private {
+        gf_lock_t         lock;
+        struct list_head *buckets;
+        struct list_head  lru;
+        uint32_t          entries;
+        nlc_conf_t        conf;
+        nlc_stats_t       stats;
+};
+typedef struct nlc_private nlc_private_t;
+
+void nlc_local_free (nlc_local_t *local);
+
+#define NLC_STACK_UNWIND(op, frame, params ...) do {            \
+                nlc_local_t *__local = frame->local;            \
+                frame->local = NULL;                            \
+                STACK_UNWIND_STRICT (op, frame, params);        \
+                nlc_local_free (__local);                       \
+        } while (0)
+
+#endif  /* #ifndef _NL_CACHE_H */
@@ -30,6 +30,8 @@ enum gf_qr_mem_types_ {
         gf_qr_mt_qr_conf_t,
         gf_qr_mt_qr_priority_t,
         gf_qr_mt_qr_private_t,
+        gf_qr_mt_qr_content_t,
+        gf_qr_mt_char,
         gf_qr_mt_end
 };
 #endif
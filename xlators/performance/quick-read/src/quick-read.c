@@ -217,13 +217,273 @@ out:
 }
 
 
-/* To be called with this-priv->table.lock held */
+static inline qr_inode_table_t *
+qr_inode_table_get (qr_private_t *priv, inode_t *inode)
+{
+        uint64_t key = (unsigned long) inode;
+
+        /* inodes come from a mem-pool, mix the low bits in */
+        key *= 0x9E3779B97F4A7C15ULL;
+
+        return &priv->table[(key >> 32) % QR_INODE_TABLE_SHARDS];
+}
+
+
+static inline qr_content_table_t *
+qr_content_table_get (qr_private_t *priv, uint32_t hash)
+{
+        return &priv->contents[hash % QR_INODE_TABLE_SHARDS];
+}
+
+
+static inline size_t
+qr_content_stored (qr_content_t *content)
+{
+        return content->csize ? content->csize : content->size;
+}
+
+
+#ifdef HAVE_LIBLZ4
+/* To be called with content->lock held */
+static int
+__qr_content_deflate (xlator_t *this, qr_content_t *content)
+{
+        qr_private_t *priv  = NULL;
+        char         *cdata = NULL;
+        int           csize = 0;
+        int           ret   = -1;
+
+        priv = this->private;
+
+        if (content->csize || content->incompressible || !content->size) {
+                goto out;
+        }
+
+        cdata = GF_MALLOC (LZ4_compressBound (content->size), gf_qr_mt_char);
+        if (cdata == NULL) {
+                goto out;
+        }
+
+        csize = LZ4_compress_default (content->data, cdata, content->size,
+                                      LZ4_compressBound (content->size));
+        /* not worth a decompression on every hit */
+        if ((csize <= 0) || (csize > (content->size / 4 * 3))) {
+                content->incompressible = 1;
+                GF_FREE (cdata);
+                goto out;
+        }
+
+        GF_FREE (content->data);
+        content->data = GF_REALLOC (cdata, csize);
+        if (content->data == NULL) {
+                content->data = cdata;
+        }
+        content->csize = csize;
+
+        __sync_fetch_and_sub (&priv->stats.cache_used, content->size - csize);
+        __sync_fetch_and_add (&priv->stats.compressed, 1);
+        ret = 0;
+out:
+        return ret;
+}
+
+
+/* To be called with content->lock held */
+static int
+__qr_content_inflate (xlator_t *this, qr_content_t *content)
+{
+        qr_private_t *priv = NULL;
+        char         *data = NULL;
+        int           ret  = -1;
+
+        priv = this->private;
+
+        data = GF_MALLOC (content->size, gf_qr_mt_char);
+        if (data == NULL) {
+                goto out;
+        }
+
+        ret = LZ4_decompress_safe (content->data, data, content->csize,
+                                   content->size);
+        if (ret != content->size) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "cannot decompress cached content (%d)", ret);
+                GF_FREE (data);
+                ret = -1;
+                goto out;
+        }
+
+        __sync_fetch_and_add (&priv->stats.cache_used,
+                              content->size - content->csize);
+        __sync_fetch_and_sub (&priv->stats.compressed, 1);
+
+        GF_FREE (content->data);
+        content->data = data;
+        content->csize = 0;
+        ret = 0;
+out:
+        return ret;
+}
+#else
+static int
+__qr_content_deflate (xlator_t *this, qr_content_t *content)
+{
+        return -1;
+}
+
+
+static int
+__qr_content_inflate (xlator_t *this, qr_content_t *content)
+{
+        return -1;
+}
+#endif /* HAVE_LIBLZ4 */
+
+
+/* A ref on the cached content equal to @data, allocated if none is */
+qr_content_t *
+qr_content_get (xlator_t *this, const char *data, size_t size)
+{
+        qr_private_t       *priv    = NULL;
+        qr_content_table_t *ctable  = NULL;
+        qr_content_t       *curr    = NULL;
+        qr_content_t       *content = NULL;
+        struct list_head   *bucket  = NULL;
+        uint32_t            hash    = 0;
+        char                equal   = 0;
+
+        priv = this->private;
+
+        hash = SuperFastHash (data, size);
+        ctable = qr_content_table_get (priv, hash);
+        bucket = &ctable->buckets[(hash / QR_INODE_TABLE_SHARDS)
+                                  % QR_CONTENT_BUCKETS];
+
+        LOCK (&ctable->lock);
+        {
+                list_for_each_entry (curr, bucket, hash_list) {
+                        if ((curr->hash != hash) || (curr->size != size)) {
+                                continue;
+                        }
+
+                        LOCK (&curr->lock);
+                        {
+                                /* in use again, no longer cold */
+                                if ((curr->csize == 0)
+                                    || (__qr_content_inflate (this, curr)
+                                        == 0)) {
+                                        equal = !memcmp (curr->data, data,
+                                                         size);
+                                }
+                        }
+                        UNLOCK (&curr->lock);
+
+                        if (equal) {
+                                curr->refcount++;
+                                content = curr;
+                                goto unlock;
+                        }
+                }
+
+                content = GF_CALLOC (1, sizeof (*content),
+                                     gf_qr_mt_qr_content_t);
+                if (content == NULL) {
+                        goto unlock;
+                }
+
+                content->data = GF_MALLOC (size ? size : 1, gf_qr_mt_char);
+                if (content->data == NULL) {
+                        GF_FREE (content);
+                        content = NULL;
+                        goto unlock;
+                }
+
+                memcpy (content->data, data, size);
+                content->size = size;
+                content->hash = hash;
+                content->refcount = 1;
+                LOCK_INIT (&content->lock);
+                list_add (&content->hash_list, bucket);
+
+                __sync_fetch_and_add (&priv->stats.cache_used, size);
+                __sync_fetch_and_add (&priv->stats.unique_bytes, size);
+        }
+unlock:
+        UNLOCK (&ctable->lock);
+
+        return content;
+}
+
+
+void
+qr_content_unref (xlator_t *this, qr_content_t *content)
+{
+        qr_private_t       *priv    = NULL;
+        qr_content_table_t *ctable  = NULL;
+        char                destroy = 0;
+
+        priv = this->private;
+        ctable = qr_content_table_get (priv, content->hash);
+
+        LOCK (&ctable->lock);
+        {
+                if (--content->refcount == 0) {
+                        list_del_init (&content->hash_list);
+                        destroy = 1;
+                }
+        }
+        UNLOCK (&ctable->lock);
+
+        if (!destroy) {
+                goto out;
+        }
+
+        __sync_fetch_and_sub (&priv->stats.cache_used,
+                              qr_content_stored (content));
+        __sync_fetch_and_sub (&priv->stats.unique_bytes, content->size);
+        if (content->csize) {
+                __sync_fetch_and_sub (&priv->stats.compressed, 1);
+        }
+
+        LOCK_DESTROY (&content->lock);
+        GF_FREE (content->data);
+        GF_FREE (content);
+out:
+        return;
+}
+
+
+/* To be called with the inode's table lock held */
+void
+__qr_inode_set_content (xlator_t *this, qr_inode_t *qr_inode,
+                        qr_content_t *content)
+{
+        qr_private_t *priv = NULL;
+
+        priv = this->private;
+
+        if (qr_inode->content) {
+                __sync_fetch_and_sub (&priv->stats.file_bytes,
+                                      qr_inode->content->size);
+                qr_content_unref (this, qr_inode->content);
+        }
+
+        qr_inode->content = content;
+
+        if (content) {
+                __sync_fetch_and_add (&priv->stats.file_bytes, content->size);
+        }
+}
+
+
+/* To be called with the inode's table lock held */
 qr_inode_t *
 __qr_inode_alloc (xlator_t *this, char *path, inode_t *inode)
 {
-        qr_inode_t    *qr_inode = NULL;
-        qr_private_t  *priv     = NULL;
-        int            priority = 0;
+        qr_inode_t       *qr_inode = NULL;
+        qr_private_t     *priv     = NULL;
+        qr_inode_table_t *table    = NULL;
+        int               priority = 0;
 
         GF_VALIDATE_OR_GOTO ("quick-read", this, out);
         GF_VALIDATE_OR_GOTO (this->name, path, out);
@@ -240,8 +500,9 @@ __qr_inode_alloc (xlator_t *this, char *path, inode_t *inode)
         INIT_LIST_HEAD (&qr_inode->lru);
 
         priority = qr_get_priority (&priv->conf, path);
+        table = qr_inode_table_get (priv, inode);
 
-        list_add_tail (&qr_inode->lru, &priv->table.lru[priority]);
+        list_add_tail (&qr_inode->lru, &table->lru[priority]);
 
         qr_inode->inode = inode;
         qr_inode->priority = priority;
@@ -250,15 +511,13 @@ out:
 }
 
 
-/* To be called with qr_inode->table->lock held */
+/* To be called with the inode's table lock held */
 void
-__qr_inode_free (qr_inode_t *qr_inode)
+__qr_inode_free (xlator_t *this, qr_inode_t *qr_inode)
 {
         GF_VALIDATE_OR_GOTO ("quick-read", qr_inode, out);
 
-        if (qr_inode->xattr) {
-                dict_unref (qr_inode->xattr);
-        }
+        __qr_inode_set_content (this, qr_inode, NULL);
 
         list_del (&qr_inode->lru);
 
@@ -267,59 +526,71 @@ out:
         return;
 }
 
-/* To be called with priv->table.lock held */
+
+inline char
+__qr_need_cache_prune (qr_conf_t *conf, qr_private_t *priv)
+{
+        char need_prune = 0;
+
+        GF_VALIDATE_OR_GOTO ("quick-read", conf, out);
+        GF_VALIDATE_OR_GOTO ("quick-read", priv, out);
+
+        need_prune = (priv->stats.cache_used > conf->cache_size);
+
+out:
+        return need_prune;
+}
+
+
+/* To be called with table->lock held. cache-size applies to the whole
+ * cache but only the lru lists of @table are pruned, the table a file
+ * lands in being random, they age alike. Cold contents are compressed
+ * first when compress-cold is on, then files evicted.
+ */
 void
-__qr_cache_prune (xlator_t *this)
+__qr_cache_prune (xlator_t *this, qr_inode_table_t *table)
 {
         qr_private_t     *priv          = NULL;
         qr_conf_t        *conf          = NULL;
-        qr_inode_table_t *table         = NULL;
         qr_inode_t        *curr         = NULL, *next = NULL;
         int32_t           index         = 0;
-        uint64_t          size_to_prune = 0;
-        uint64_t          size_pruned   = 0;
 
         GF_VALIDATE_OR_GOTO ("quick-read", this, out);
         priv = this->private;
         GF_VALIDATE_OR_GOTO (this->name, priv, out);
 
-        table = &priv->table;
         conf = &priv->conf;
 
-        size_to_prune = table->cache_used - conf->cache_size;
+        if (conf->compress) {
+                for (index=0; index < conf->max_pri; index++) {
+                        list_for_each_entry (curr, &table->lru[index], lru) {
+                                if (!__qr_need_cache_prune (conf, priv))
+                                        goto out;
+
+                                LOCK (&curr->content->lock);
+                                {
+                                        __qr_content_deflate (this,
+                                                              curr->content);
+                                }
+                                UNLOCK (&curr->content->lock);
+                        }
+                }
+        }
 
         for (index=0; index < conf->max_pri; index++) {
                 list_for_each_entry_safe (curr, next, &table->lru[index], lru) {
-                        size_pruned += curr->stbuf.ia_size;
+                        if (!__qr_need_cache_prune (conf, priv))
+                                goto out;
+
                         inode_ctx_del (curr->inode, this, NULL);
-                        __qr_inode_free (curr);
-                        if (size_pruned >= size_to_prune)
-                                goto done;
+                        __qr_inode_free (this, curr);
                 }
         }
 
-done:
-        table->cache_used -= size_pruned;
-
 out:
         return;
 }
 
-/* To be called with table->lock held */
-inline char
-__qr_need_cache_prune (qr_conf_t *conf, qr_inode_table_t *table)
-{
-        char need_prune = 0;
-
-        GF_VALIDATE_OR_GOTO ("quick-read", conf, out);
-        GF_VALIDATE_OR_GOTO ("quick-read", table, out);
-
-        need_prune = (table->cache_used > conf->cache_size);
-
-out:
-        return need_prune;
-}
-
 
 int32_t
 qr_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
@@ -327,6 +598,7 @@ qr_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                struct iatt *buf, dict_t *dict, struct iatt *postparent)
 {
         data_t           *content  = NULL;
+        qr_content_t     *cached   = NULL;
         qr_inode_t       *qr_inode = NULL;
         uint64_t          value    = 0;
         int               ret      = -1;
@@ -352,7 +624,6 @@ qr_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         priv = this->private;
         conf = &priv->conf;
-        table = &priv->table;
 
         local = frame->local;
 
@@ -377,6 +648,14 @@ qr_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 goto out;
         }
 
+        /* hashing and copying need no lock, do it before taking one */
+        cached = qr_content_get (this, content->data, content->len);
+        if (cached == NULL) {
+                goto out;
+        }
+
+        table = qr_inode_table_get (priv, inode);
+
         LOCK (&table->lock);
         {
                 ret = inode_ctx_get (inode, this, &value);
@@ -391,7 +670,7 @@ qr_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         ret = inode_ctx_put (inode, this,
                                              (uint64_t)(long)qr_inode);
                         if (ret == -1) {
-                                __qr_inode_free (qr_inode);
+                                __qr_inode_free (this, qr_inode);
                                 qr_inode = NULL;
                                 op_ret = -1;
                                 op_errno = EINVAL;
@@ -414,24 +693,22 @@ qr_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         }
                 }
 
-                if (qr_inode->xattr) {
-                        dict_unref (qr_inode->xattr);
-                        qr_inode->xattr = NULL;
-                        table->cache_used -= qr_inode->stbuf.ia_size;
-                }
-
-                qr_inode->xattr = dict_ref (dict);
+                __qr_inode_set_content (this, qr_inode, cached);
+                cached = NULL;
                 qr_inode->stbuf = *buf;
-                table->cache_used += buf->ia_size;
 
                 gettimeofday (&qr_inode->tv, NULL);
-                if (__qr_need_cache_prune (conf, table)) {
-                        __qr_cache_prune (this);
+                if (__qr_need_cache_prune (conf, priv)) {
+                        __qr_cache_prune (this, table);
                 }
         }
 unlock:
         UNLOCK (&table->lock);
 
+        if (cached) {
+                qr_content_unref (this, cached);
+        }
+
 out:
         /*
          * FIXME: content size in dict can be greater than the size application
@@ -472,7 +749,7 @@ qr_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xattr_req)
                 goto unwind;
         }
 
-        table = &priv->table;
+        table = qr_inode_table_get (priv, loc->inode);
         local = GF_CALLOC (1, sizeof (*local), gf_qr_mt_qr_local_t);
         GF_VALIDATE_OR_GOTO_WITH_ERROR (this->name, local, unwind, op_errno,
                                         ENOMEM);
@@ -488,7 +765,7 @@ qr_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xattr_req)
                 if (op_ret == 0) {
                         qr_inode = (qr_inode_t *)(long)value;
                         if (qr_inode != NULL) {
-                                if (qr_inode->xattr) {
+                                if (qr_inode->content) {
                                         cached = 1;
                                 }
                         }
@@ -571,7 +848,7 @@ qr_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
         GF_ASSERT (frame);
 
         priv = this->private;
-        table = &priv->table;
+        table = qr_inode_table_get (priv, fd->inode);
 
         local = frame->local;
         if (local != NULL) {
@@ -617,7 +894,7 @@ qr_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
                                         qr_inode = (qr_inode_t *)(long) value;
 
                                         if (qr_inode != NULL) {
-                                                __qr_inode_free (qr_inode);
+                                                __qr_inode_free (this, qr_inode);
                                         }
                                 }
                         }
@@ -671,7 +948,7 @@ qr_open (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
         GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
 
         priv = this->private;
-        table = &priv->table;
+        table = qr_inode_table_get (priv, fd->inode);
 
         tmp_fd_ctx = qr_fd_ctx = GF_CALLOC (1, sizeof (*qr_fd_ctx),
                                             gf_qr_mt_qr_fd_ctx_t);
@@ -723,7 +1000,7 @@ qr_open (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
                 if (ret == 0) {
                         qr_inode = (qr_inode_t *)(long) filep;
                         if (qr_inode) {
-                                if (qr_inode->xattr) {
+                                if (qr_inode->content) {
                                         content_cached = 1;
                                 }
                         }
@@ -851,7 +1128,7 @@ qr_validate_cache_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         }
 
         priv = this->private;
-        table = &priv->table;
+        table = qr_inode_table_get (priv, local->fd->inode);
 
         LOCK (&table->lock);
         {
@@ -867,7 +1144,7 @@ qr_validate_cache_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                             || (qr_inode->stbuf.ia_mtime_nsec
                                 != buf->ia_mtime_nsec)) {
                                 inode_ctx_del (local->fd->inode, this, NULL);
-                                __qr_inode_free (qr_inode);
+                                __qr_inode_free (this, qr_inode);
                         }
                 }
         }
@@ -1105,7 +1382,7 @@ qr_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         struct iobuf      *iobuf          = NULL;
         struct iobref     *iobref         = NULL;
         struct iatt        stbuf          = {0, };
-        data_t            *content        = NULL;
+        qr_content_t      *content        = NULL;
         qr_fd_ctx_t       *qr_fd_ctx      = NULL;
         call_stub_t       *stub           = NULL;
         loc_t              loc            = {0, };
@@ -1125,7 +1402,7 @@ qr_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
 
         priv = this->private;
         conf = &priv->conf;
-        table = &priv->table;
+        table = qr_inode_table_get (priv, fd->inode);
 
         local = frame->local;
 
@@ -1151,7 +1428,7 @@ qr_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                 if (ret == 0) {
                         qr_inode = (qr_inode_t *)(long)value;
                         if (qr_inode) {
-                                if (qr_inode->xattr){
+                                if (qr_inode->content) {
                                         if (!just_validated
                                             && qr_need_validation (conf,
                                                                    qr_inode)) {
@@ -1159,23 +1436,31 @@ qr_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                                                 goto unlock;
                                         }
 
-                                        content = dict_get (qr_inode->xattr,
-                                                            GF_CONTENT_KEY);
+                                        /* held till unlock, a prune of
+                                           another table could deflate it */
+                                        content = qr_inode->content;
+                                        LOCK (&content->lock);
+
+                                        if (content->csize
+                                            && __qr_content_inflate (this,
+                                                                     content)) {
+                                                goto unlock;
+                                        }
 
                                         stbuf = qr_inode->stbuf;
                                         content_cached = 1;
                                         list_move_tail (&qr_inode->lru,
                                                         &table->lru[qr_inode->priority]);
 
-                                        if (offset > content->len) {
+                                        if (offset > content->size) {
                                                 op_ret = 0;
-                                                end = content->len;
+                                                end = content->size;
                                         } else {
                                                 if ((offset + size)
-                                                    > content->len) {
-                                                        op_ret = content->len
+                                                    > content->size) {
+                                                        op_ret = content->size
                                                                 - offset;
-                                                        end = content->len;
+                                                        end = content->size;
                                                 } else {
                                                         op_ret = size;
                                                         end =  offset + size;
@@ -1253,9 +1538,21 @@ qr_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                 }
         }
 unlock:
+        if (content != NULL) {
+                UNLOCK (&content->lock);
+
+                /* an inflated hit grows the cache */
+                if (content_cached && __qr_need_cache_prune (conf, priv)) {
+                        __qr_cache_prune (this, table);
+                }
+        }
         UNLOCK (&table->lock);
 
 out:
+        if (content_cached) {
+                __sync_fetch_and_add (&priv->stats.hits, 1);
+        }
+
         if (content_cached || need_unwind) {
                 QR_STACK_UNWIND (readv, frame, op_ret, op_errno, vector,
                                  count, &stbuf, iobref);
@@ -1270,6 +1567,8 @@ out:
 
                 qr_validate_cache (frame, this, fd, stub);
         } else {
+                __sync_fetch_and_add (&priv->stats.misses, 1);
+
                 if (qr_fd_ctx) {
                         LOCK (&qr_fd_ctx->lock);
                         {
@@ -1437,7 +1736,7 @@ qr_writev (call_frame_t *frame, xlator_t *this, fd_t *fd, struct iovec *vector,
         call_frame_t     *open_frame = NULL;
 
         priv = this->private;
-        table = &priv->table;
+        table = qr_inode_table_get (priv, fd->inode);
 
         ret = fd_ctx_get (fd, this, &value);
 
@@ -1452,7 +1751,7 @@ qr_writev (call_frame_t *frame, xlator_t *this, fd_t *fd, struct iovec *vector,
                         qr_inode = (qr_inode_t *)(long)value;
                         if (qr_inode != NULL) {
                                 inode_ctx_del (fd->inode, this, NULL);
-                                __qr_inode_free (qr_inode);
+                                __qr_inode_free (this, qr_inode);
                         }
                 }
         }
@@ -2815,7 +3114,7 @@ qr_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         }
 
         priv = this->private;
-        table = &priv->table;
+        table = qr_inode_table_get (priv, local->fd->inode);
 
         LOCK (&table->lock);
         {
@@ -2828,7 +3127,7 @@ qr_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                                 {
                                         inode_ctx_del (local->fd->inode, this,
                                                        NULL);
-                                        __qr_inode_free (qr_inode);
+                                        __qr_inode_free (this, qr_inode);
                                 }
                         }
                 }
@@ -2993,18 +3292,72 @@ ret:
 
 
 int32_t
-qr_lk_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
-           int32_t op_errno, struct gf_flock *lock)
+qr_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf)
 {
+        int32_t           ret      = 0;
+        uint64_t          value    = 0;
+        qr_inode_t       *qr_inode = NULL;
+        qr_local_t       *local    = NULL;
+        qr_private_t     *priv     = NULL;
+        qr_inode_table_t *table    = NULL;
+
         GF_ASSERT (frame);
-        QR_STACK_UNWIND (lk, frame, op_ret, op_errno, lock);
+
+        if (op_ret == -1) {
+                goto out;
+        }
+
+        local = frame->local;
+        if ((local == NULL) || (local->fd == NULL)
+            || (local->fd->inode == NULL)) {
+                op_ret = -1;
+                op_errno = EINVAL;
+                gf_log (frame->this->name, GF_LOG_WARNING, "cannot get inode");
+                goto out;
+        }
+
+        if ((this == NULL) || (this->private == NULL)) {
+                gf_log (frame->this->name, GF_LOG_WARNING,
+                        (this == NULL) ? "xlator object (this) is NULL"
+                        : "cannot get quick read configuration from xlator "
+                        "object");
+                op_ret = -1;
+                op_errno = EINVAL;
+                goto out;
+        }
+
+        priv = this->private;
+        table = qr_inode_table_get (priv, local->fd->inode);
+
+        LOCK (&table->lock);
+        {
+                ret = inode_ctx_get (local->fd->inode, this, &value);
+                if (ret == 0) {
+                        qr_inode = (qr_inode_t *)(long) value;
+
+                        /* the cached content is no longer what is on
+                         * disk, whatever happened to the size
+                         */
+                        if (qr_inode) {
+                                inode_ctx_del (local->fd->inode, this, NULL);
+                                __qr_inode_free (this, qr_inode);
+                        }
+                }
+        }
+        UNLOCK (&table->lock);
+
+out:
+        QR_STACK_UNWIND (fallocate, frame, op_ret, op_errno, prebuf,
+                         postbuf);
         return 0;
 }
 
 
 int32_t
-qr_lk_helper (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
-              struct gf_flock *lock)
+qr_fallocate_helper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     int32_t keep_size, off_t offset, size_t len)
 {
         qr_local_t  *local    = NULL;
         qr_fd_ctx_t *fdctx    = NULL;
@@ -3028,31 +3381,32 @@ qr_lk_helper (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
                 }
 
                 gf_log (this->name, GF_LOG_WARNING,
-                        "open failed on path (%s) (%s), unwinding lk call",
+                        "open failed on path (%s) (%s), unwinding fallocate "
+                        "call",
                         fdctx ? fdctx->path : NULL, strerror (op_errno));
                 goto unwind;
         }
 
-        STACK_WIND (frame, qr_lk_cbk, FIRST_CHILD(this),
-                    FIRST_CHILD(this)->fops->lk, fd, cmd, lock);
-
+        STACK_WIND (frame, qr_fallocate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->fallocate, fd, keep_size, offset, len);
         return 0;
 
 unwind:
-        QR_STACK_UNWIND (lk, frame, -1, op_errno, NULL);
+        QR_STACK_UNWIND (fallocate, frame, -1, op_errno, NULL, NULL);
         return 0;
 }
 
 
 int32_t
-qr_lk (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
-       struct gf_flock *lock)
+qr_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              int32_t keep_size, off_t offset, size_t len)
 {
         int           flags      = 0;
         uint64_t      value      = 0;
         call_stub_t  *stub       = NULL;
         char         *path       = NULL;
         loc_t         loc        = {0, };
+        qr_local_t   *local      = NULL;
         qr_fd_ctx_t  *qr_fd_ctx  = NULL;
         int32_t       ret        = -1, op_ret = -1, op_errno = EINVAL;
         char          need_open  = 0, can_wind = 0, need_unwind = 0;
@@ -3072,6 +3426,17 @@ qr_lk (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
                 qr_fd_ctx = (qr_fd_ctx_t *)(long)value;
         }
 
+        local = GF_CALLOC (1, sizeof (*local), gf_qr_mt_qr_local_t);
+        if (local == NULL) {
+                op_ret = -1;
+                op_errno = ENOMEM;
+                need_unwind = 1;
+                goto out;
+        }
+
+        local->fd = fd;
+        frame->local = local;
+
         if (qr_fd_ctx) {
                 LOCK (&qr_fd_ctx->lock);
                 {
@@ -3087,10 +3452,11 @@ qr_lk (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
                         if (qr_fd_ctx->opened) {
                                 can_wind = 1;
                         } else {
-                                frame->local = GF_CALLOC (1,
-                                                          sizeof (qr_local_t),
-                                                          gf_qr_mt_qr_local_t);
-                                if (frame->local == NULL) {
+                                stub = fop_fallocate_stub (frame,
+                                                           qr_fallocate_helper,
+                                                           fd, keep_size, offset,
+                                                           len);
+                                if (stub == NULL) {
                                         op_ret = -1;
                                         op_errno = ENOMEM;
                                         need_unwind = 1;
@@ -3098,7 +3464,589 @@ qr_lk (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
                                         goto unlock;
                                 }
 
-                                stub = fop_lk_stub (frame, qr_lk_helper, fd,
+                                list_add_tail (&stub->list,
+                                               &qr_fd_ctx->waiting_ops);
+                        }
+                }
+        unlock:
+                UNLOCK (&qr_fd_ctx->lock);
+        } else {
+                can_wind = 1;
+        }
+
+out:
+        if (need_unwind) {
+                QR_STACK_UNWIND (fallocate, frame, op_ret, op_errno, NULL,
+                                 NULL);
+        } else if (can_wind) {
+                STACK_WIND (frame, qr_fallocate_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->fallocate, fd, keep_size, offset, len);
+        } else if (need_open) {
+                op_ret = qr_loc_fill (&loc, fd->inode, path);
+                if (op_ret == -1) {
+                        qr_resume_pending_ops (qr_fd_ctx, -1, errno);
+                        goto ret;
+                }
+
+                open_frame = create_frame (this, this->ctx->pool);
+                if (open_frame == NULL) {
+                        qr_resume_pending_ops (qr_fd_ctx, -1, ENOMEM);
+                        qr_loc_wipe (&loc);
+                        goto ret;
+                }
+
+                STACK_WIND (open_frame, qr_open_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->open, &loc, flags, fd,
+                            qr_fd_ctx->wbflags);
+
+                qr_loc_wipe (&loc);
+        }
+
+ret:
+        return 0;
+}
+
+
+int32_t
+qr_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                struct iatt *postbuf)
+{
+        int32_t           ret      = 0;
+        uint64_t          value    = 0;
+        qr_inode_t       *qr_inode = NULL;
+        qr_local_t       *local    = NULL;
+        qr_private_t     *priv     = NULL;
+        qr_inode_table_t *table    = NULL;
+
+        GF_ASSERT (frame);
+
+        if (op_ret == -1) {
+                goto out;
+        }
+
+        local = frame->local;
+        if ((local == NULL) || (local->fd == NULL)
+            || (local->fd->inode == NULL)) {
+                op_ret = -1;
+                op_errno = EINVAL;
+                gf_log (frame->this->name, GF_LOG_WARNING, "cannot get inode");
+                goto out;
+        }
+
+        if ((this == NULL) || (this->private == NULL)) {
+                gf_log (frame->this->name, GF_LOG_WARNING,
+                        (this == NULL) ? "xlator object (this) is NULL"
+                        : "cannot get quick read configuration from xlator "
+                        "object");
+                op_ret = -1;
+                op_errno = EINVAL;
+                goto out;
+        }
+
+        priv = this->private;
+        table = qr_inode_table_get (priv, local->fd->inode);
+
+        LOCK (&table->lock);
+        {
+                ret = inode_ctx_get (local->fd->inode, this, &value);
+                if (ret == 0) {
+                        qr_inode = (qr_inode_t *)(long) value;
+
+                        /* the cached content is no longer what is on
+                         * disk, whatever happened to the size
+                         */
+                        if (qr_inode) {
+                                inode_ctx_del (local->fd->inode, this, NULL);
+                                __qr_inode_free (this, qr_inode);
+                        }
+                }
+        }
+        UNLOCK (&table->lock);
+
+out:
+        QR_STACK_UNWIND (discard, frame, op_ret, op_errno, prebuf,
+                         postbuf);
+        return 0;
+}
+
+
+int32_t
+qr_discard_helper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                   off_t offset, size_t len)
+{
+        qr_local_t  *local    = NULL;
+        qr_fd_ctx_t *fdctx    = NULL;
+        uint64_t     value    = 0;
+        int32_t      ret      = 0;
+        int32_t      op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+
+        local = frame->local;
+        GF_VALIDATE_OR_GOTO (frame->this->name, local, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
+
+        if (local->op_ret < 0) {
+                op_errno = local->op_errno;
+
+                ret = fd_ctx_get (fd, this, &value);
+                if (ret == 0) {
+                        fdctx = (qr_fd_ctx_t *)(long) value;
+                }
+
+                gf_log (this->name, GF_LOG_WARNING,
+                        "open failed on path (%s) (%s), unwinding discard "
+                        "call",
+                        fdctx ? fdctx->path : NULL, strerror (op_errno));
+                goto unwind;
+        }
+
+        STACK_WIND (frame, qr_discard_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->discard, fd, offset, len);
+        return 0;
+
+unwind:
+        QR_STACK_UNWIND (discard, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+int32_t
+qr_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+            off_t offset, size_t len)
+{
+        int           flags      = 0;
+        uint64_t      value      = 0;
+        call_stub_t  *stub       = NULL;
+        char         *path       = NULL;
+        loc_t         loc        = {0, };
+        qr_local_t   *local      = NULL;
+        qr_fd_ctx_t  *qr_fd_ctx  = NULL;
+        int32_t       ret        = -1, op_ret = -1, op_errno = EINVAL;
+        char          need_open  = 0, can_wind = 0, need_unwind = 0;
+        call_frame_t *open_frame = NULL;
+
+        GF_ASSERT (frame);
+        if ((this == NULL) || (fd == NULL)) {
+                gf_log (frame->this->name, GF_LOG_WARNING,
+                        (this == NULL) ? "xlator object (this) is NULL"
+                        : "fd is NULL");
+                need_unwind = 1;
+                goto out;
+        }
+
+        ret = fd_ctx_get (fd, this, &value);
+        if (ret == 0) {
+                qr_fd_ctx = (qr_fd_ctx_t *)(long)value;
+        }
+
+        local = GF_CALLOC (1, sizeof (*local), gf_qr_mt_qr_local_t);
+        if (local == NULL) {
+                op_ret = -1;
+                op_errno = ENOMEM;
+                need_unwind = 1;
+                goto out;
+        }
+
+        local->fd = fd;
+        frame->local = local;
+
+        if (qr_fd_ctx) {
+                LOCK (&qr_fd_ctx->lock);
+                {
+                        path = qr_fd_ctx->path;
+                        flags = qr_fd_ctx->flags;
+
+                        if (!(qr_fd_ctx->opened
+                              || qr_fd_ctx->open_in_transit)) {
+                                need_open = 1;
+                                qr_fd_ctx->open_in_transit = 1;
+                        }
+
+                        if (qr_fd_ctx->opened) {
+                                can_wind = 1;
+                        } else {
+                                stub = fop_discard_stub (frame,
+                                                         qr_discard_helper,
+                                                         fd, offset, len);
+                                if (stub == NULL) {
+                                        op_ret = -1;
+                                        op_errno = ENOMEM;
+                                        need_unwind = 1;
+                                        qr_fd_ctx->open_in_transit = 0;
+                                        goto unlock;
+                                }
+
+                                list_add_tail (&stub->list,
+                                               &qr_fd_ctx->waiting_ops);
+                        }
+                }
+        unlock:
+                UNLOCK (&qr_fd_ctx->lock);
+        } else {
+                can_wind = 1;
+        }
+
+out:
+        if (need_unwind) {
+                QR_STACK_UNWIND (discard, frame, op_ret, op_errno, NULL,
+                                 NULL);
+        } else if (can_wind) {
+                STACK_WIND (frame, qr_discard_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->discard, fd, offset, len);
+        } else if (need_open) {
+                op_ret = qr_loc_fill (&loc, fd->inode, path);
+                if (op_ret == -1) {
+                        qr_resume_pending_ops (qr_fd_ctx, -1, errno);
+                        goto ret;
+                }
+
+                open_frame = create_frame (this, this->ctx->pool);
+                if (open_frame == NULL) {
+                        qr_resume_pending_ops (qr_fd_ctx, -1, ENOMEM);
+                        qr_loc_wipe (&loc);
+                        goto ret;
+                }
+
+                STACK_WIND (open_frame, qr_open_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->open, &loc, flags, fd,
+                            qr_fd_ctx->wbflags);
+
+                qr_loc_wipe (&loc);
+        }
+
+ret:
+        return 0;
+}
+
+
+int32_t
+qr_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf)
+{
+        int32_t           ret      = 0;
+        uint64_t          value    = 0;
+        qr_inode_t       *qr_inode = NULL;
+        qr_local_t       *local    = NULL;
+        qr_private_t     *priv     = NULL;
+        qr_inode_table_t *table    = NULL;
+
+        GF_ASSERT (frame);
+
+        if (op_ret == -1) {
+                goto out;
+        }
+
+        local = frame->local;
+        if ((local == NULL) || (local->fd == NULL)
+            || (local->fd->inode == NULL)) {
+                op_ret = -1;
+                op_errno = EINVAL;
+                gf_log (frame->this->name, GF_LOG_WARNING, "cannot get inode");
+                goto out;
+        }
+
+        if ((this == NULL) || (this->private == NULL)) {
+                gf_log (frame->this->name, GF_LOG_WARNING,
+                        (this == NULL) ? "xlator object (this) is NULL"
+                        : "cannot get quick read configuration from xlator "
+                        "object");
+                op_ret = -1;
+                op_errno = EINVAL;
+                goto out;
+        }
+
+        priv = this->private;
+        table = qr_inode_table_get (priv, local->fd->inode);
+
+        LOCK (&table->lock);
+        {
+                ret = inode_ctx_get (local->fd->inode, this, &value);
+                if (ret == 0) {
+                        qr_inode = (qr_inode_t *)(long) value;
+
+                        /* the cached content is no longer what is on
+                         * disk, whatever happened to the size
+                         */
+                        if (qr_inode) {
+                                inode_ctx_del (local->fd->inode, this, NULL);
+                                __qr_inode_free (this, qr_inode);
+                        }
+                }
+        }
+        UNLOCK (&table->lock);
+
+out:
+        QR_STACK_UNWIND (zerofill, frame, op_ret, op_errno, prebuf,
+                         postbuf);
+        return 0;
+}
+
+
+int32_t
+qr_zerofill_helper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                    int32_t keep_size, off_t offset, size_t len)
+{
+        qr_local_t  *local    = NULL;
+        qr_fd_ctx_t *fdctx    = NULL;
+        uint64_t     value    = 0;
+        int32_t      ret      = 0;
+        int32_t      op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+
+        local = frame->local;
+        GF_VALIDATE_OR_GOTO (frame->this->name, local, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
+
+        if (local->op_ret < 0) {
+                op_errno = local->op_errno;
+
+                ret = fd_ctx_get (fd, this, &value);
+                if (ret == 0) {
+                        fdctx = (qr_fd_ctx_t *)(long) value;
+                }
+
+                gf_log (this->name, GF_LOG_WARNING,
+                        "open failed on path (%s) (%s), unwinding zerofill "
+                        "call",
+                        fdctx ? fdctx->path : NULL, strerror (op_errno));
+                goto unwind;
+        }
+
+        STACK_WIND (frame, qr_zerofill_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->zerofill, fd, keep_size,
+                    offset, len);
+        return 0;
+
+unwind:
+        QR_STACK_UNWIND (zerofill, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+int32_t
+qr_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             int32_t keep_size, off_t offset, size_t len)
+{
+        int           flags      = 0;
+        uint64_t      value      = 0;
+        call_stub_t  *stub       = NULL;
+        char         *path       = NULL;
+        loc_t         loc        = {0, };
+        qr_local_t   *local      = NULL;
+        qr_fd_ctx_t  *qr_fd_ctx  = NULL;
+        int32_t       ret        = -1, op_ret = -1, op_errno = EINVAL;
+        char          need_open  = 0, can_wind = 0, need_unwind = 0;
+        call_frame_t *open_frame = NULL;
+
+        GF_ASSERT (frame);
+        if ((this == NULL) || (fd == NULL)) {
+                gf_log (frame->this->name, GF_LOG_WARNING,
+                        (this == NULL) ? "xlator object (this) is NULL"
+                        : "fd is NULL");
+                need_unwind = 1;
+                goto out;
+        }
+
+        ret = fd_ctx_get (fd, this, &value);
+        if (ret == 0) {
+                qr_fd_ctx = (qr_fd_ctx_t *)(long)value;
+        }
+
+        local = GF_CALLOC (1, sizeof (*local), gf_qr_mt_qr_local_t);
+        if (local == NULL) {
+                op_ret = -1;
+                op_errno = ENOMEM;
+                need_unwind = 1;
+                goto out;
+        }
+
+        local->fd = fd;
+        frame->local = local;
+
+        if (qr_fd_ctx) {
+                LOCK (&qr_fd_ctx->lock);
+                {
+                        path = qr_fd_ctx->path;
+                        flags = qr_fd_ctx->flags;
+
+                        if (!(qr_fd_ctx->opened
+                              || qr_fd_ctx->open_in_transit)) {
+                                need_open = 1;
+                                qr_fd_ctx->open_in_transit = 1;
+                        }
+
+                        if (qr_fd_ctx->opened) {
+                                can_wind = 1;
+                        } else {
+                                stub = fop_zerofill_stub (frame,
+                                                          qr_zerofill_helper,
+                                                          fd, keep_size,
+                                                          offset, len);
+                                if (stub == NULL) {
+                                        op_ret = -1;
+                                        op_errno = ENOMEM;
+                                        need_unwind = 1;
+                                        qr_fd_ctx->open_in_transit = 0;
+                                        goto unlock;
+                                }
+
+                                list_add_tail (&stub->list,
+                                               &qr_fd_ctx->waiting_ops);
+                        }
+                }
+        unlock:
+                UNLOCK (&qr_fd_ctx->lock);
+        } else {
+                can_wind = 1;
+        }
+
+out:
+        if (need_unwind) {
+                QR_STACK_UNWIND (zerofill, frame, op_ret, op_errno, NULL,
+                                 NULL);
+        } else if (can_wind) {
+                STACK_WIND (frame, qr_zerofill_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->zerofill, fd, keep_size,
+                            offset, len);
+        } else if (need_open) {
+                op_ret = qr_loc_fill (&loc, fd->inode, path);
+                if (op_ret == -1) {
+                        qr_resume_pending_ops (qr_fd_ctx, -1, errno);
+                        goto ret;
+                }
+
+                open_frame = create_frame (this, this->ctx->pool);
+                if (open_frame == NULL) {
+                        qr_resume_pending_ops (qr_fd_ctx, -1, ENOMEM);
+                        qr_loc_wipe (&loc);
+                        goto ret;
+                }
+
+                STACK_WIND (open_frame, qr_open_cbk, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->open, &loc, flags, fd,
+                            qr_fd_ctx->wbflags);
+
+                qr_loc_wipe (&loc);
+        }
+
+ret:
+        return 0;
+}
+
+
+int32_t
+qr_lk_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+           int32_t op_errno, struct gf_flock *lock)
+{
+        GF_ASSERT (frame);
+        QR_STACK_UNWIND (lk, frame, op_ret, op_errno, lock);
+        return 0;
+}
+
+
+int32_t
+qr_lk_helper (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
+              struct gf_flock *lock)
+{
+        qr_local_t  *local    = NULL;
+        qr_fd_ctx_t *fdctx    = NULL;
+        uint64_t     value    = 0;
+        int32_t      ret      = 0;
+        int32_t      op_errno = EINVAL;
+
+        GF_ASSERT (frame);
+
+        local = frame->local;
+        GF_VALIDATE_OR_GOTO (frame->this->name, local, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
+        GF_VALIDATE_OR_GOTO (frame->this->name, fd, unwind);
+
+        if (local->op_ret < 0) {
+                op_errno = local->op_errno;
+
+                ret = fd_ctx_get (fd, this, &value);
+                if (ret == 0) {
+                        fdctx = (qr_fd_ctx_t *)(long) value;
+                }
+
+                gf_log (this->name, GF_LOG_WARNING,
+                        "open failed on path (%s) (%s), unwinding lk call",
+                        fdctx ? fdctx->path : NULL, strerror (op_errno));
+                goto unwind;
+        }
+
+        STACK_WIND (frame, qr_lk_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->lk, fd, cmd, lock);
+
+        return 0;
+
+unwind:
+        QR_STACK_UNWIND (lk, frame, -1, op_errno, NULL);
+        return 0;
+}
+
+
+int32_t
+qr_lk (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
+       struct gf_flock *lock)
+{
+        int           flags      = 0;
+        uint64_t      value      = 0;
+        call_stub_t  *stub       = NULL;
+        char         *path       = NULL;
+        loc_t         loc        = {0, };
+        qr_fd_ctx_t  *qr_fd_ctx  = NULL;
+        int32_t       ret        = -1, op_ret = -1, op_errno = EINVAL;
+        char          need_open  = 0, can_wind = 0, need_unwind = 0;
+        call_frame_t *open_frame = NULL;
+
+        GF_ASSERT (frame);
+        if ((this == NULL) || (fd == NULL)) {
+                gf_log (frame->this->name, GF_LOG_WARNING,
+                        (this == NULL) ? "xlator object (this) is NULL"
+                        : "fd is NULL");
+                need_unwind = 1;
+                goto out;
+        }
+
+        ret = fd_ctx_get (fd, this, &value);
+        if (ret == 0) {
+                qr_fd_ctx = (qr_fd_ctx_t *)(long)value;
+        }
+
+        if (qr_fd_ctx) {
+                LOCK (&qr_fd_ctx->lock);
+                {
+                        path = qr_fd_ctx->path;
+                        flags = qr_fd_ctx->flags;
+
+                        if (!(qr_fd_ctx->opened
+                              || qr_fd_ctx->open_in_transit)) {
+                                need_open = 1;
+                                qr_fd_ctx->open_in_transit = 1;
+                        }
+
+                        if (qr_fd_ctx->opened) {
+                                can_wind = 1;
+                        } else {
+                                frame->local = GF_CALLOC (1,
+                                                          sizeof (qr_local_t),
+                                                          gf_qr_mt_qr_local_t);
+                                if (frame->local == NULL) {
+                                        op_ret = -1;
+                                        op_errno = ENOMEM;
+                                        need_unwind = 1;
+                                        qr_fd_ctx->open_in_transit = 0;
+                                        goto unlock;
+                                }
+
+                                stub = fop_lk_stub (frame, qr_lk_helper, fd,
                                                     cmd, lock);
                                 if (stub == NULL) {
                                         op_ret = -1;
@@ -3176,26 +4124,28 @@ out:
 int32_t
 qr_forget (xlator_t *this, inode_t *inode)
 {
-        qr_inode_t   *qr_inode = NULL;
-        uint64_t      value     = 0;
-        int32_t       ret       = -1;
-        qr_private_t *priv      = NULL;
+        qr_inode_t       *qr_inode = NULL;
+        uint64_t          value    = 0;
+        int32_t           ret      = -1;
+        qr_private_t     *priv     = NULL;
+        qr_inode_table_t *table    = NULL;
 
         GF_VALIDATE_OR_GOTO ("quick-read", this, out);
         GF_VALIDATE_OR_GOTO (this->name, this->private, out);
         GF_VALIDATE_OR_GOTO (this->name, inode, out);
 
         priv = this->private;
+        table = qr_inode_table_get (priv, inode);
 
-        LOCK (&priv->table.lock);
+        LOCK (&table->lock);
         {
                 ret = inode_ctx_del (inode, this, &value);
                 if (ret == 0) {
                         qr_inode = (qr_inode_t *)(long) value;
-                        __qr_inode_free (qr_inode);
+                        __qr_inode_free (this, qr_inode);
                 }
         }
-        UNLOCK (&priv->table.lock);
+        UNLOCK (&table->lock);
 
 out:
         return 0;
@@ -3234,7 +4184,7 @@ qr_inodectx_dump (xlator_t *this, inode_t *inode)
         gf_proc_dump_write (key, "%ld", inode->ino);
 
         gf_proc_dump_build_key (key, key_prefix, "entire-file-cached");
-        gf_proc_dump_write (key, "%s", qr_inode->xattr ? "yes" : "no");
+        gf_proc_dump_write (key, "%s", qr_inode->content ? "yes" : "no");
 
         tm = localtime (&qr_inode->tv.tv_sec);
         strftime (buf, 256, "%Y-%m-%d %H:%M:%S", tm);
@@ -3332,8 +4282,9 @@ qr_priv_dump (xlator_t *this)
         qr_conf_t        *conf       = NULL;
         qr_private_t     *priv       = NULL;
         qr_inode_table_t *table      = NULL;
+        qr_stats_t        stats      = {0, };
         uint32_t          file_count = 0;
-        uint32_t          i          = 0;
+        uint32_t          i          = 0, j = 0;
         qr_inode_t       *curr       = NULL;
         uint64_t          total_size = 0;
         char              key[GF_DUMP_MAX_BUF_LEN];
@@ -3351,8 +4302,7 @@ qr_priv_dump (xlator_t *this)
                 return -1;
         }
 
-        table = &priv->table;
-
+        stats = priv->stats;
 
         gf_proc_dump_build_key (key_prefix, "xlator.performance.quick-read",
                                 "priv");
@@ -3364,24 +4314,55 @@ qr_priv_dump (xlator_t *this)
         gf_proc_dump_build_key (key, key_prefix, "cache_timeout");
         gf_proc_dump_write (key, "%d", conf->cache_timeout);
 
-        if (!table) {
-                gf_log (this->name, GF_LOG_WARNING, "table is NULL");
-                goto out;
-        } else {
-                for (i = 0; i < conf->max_pri; i++) {
-                        list_for_each_entry (curr, &table->lru[i], lru) {
-                                file_count++;
-                                total_size += curr->stbuf.ia_size;
+        for (j = 0; j < QR_INODE_TABLE_SHARDS; j++) {
+                table = &priv->table[j];
+
+                LOCK (&table->lock);
+                {
+                        for (i = 0; i < conf->max_pri; i++) {
+                                list_for_each_entry (curr, &table->lru[i],
+                                                     lru) {
+                                        file_count++;
+                                        total_size += curr->stbuf.ia_size;
+                                }
                         }
                 }
+                UNLOCK (&table->lock);
         }
 
         gf_proc_dump_build_key (key, key_prefix, "total_files_cached");
         gf_proc_dump_write (key, "%d", file_count);
+        gf_proc_dump_build_key (key, key_prefix, "total_file_size");
+        gf_proc_dump_write (key, "%"PRIu64, total_size);
         gf_proc_dump_build_key (key, key_prefix, "total_cache_used");
-        gf_proc_dump_write (key, "%d", total_size);
+        gf_proc_dump_write (key, "%"PRIu64, stats.cache_used);
+
+        gf_proc_dump_build_key (key, key_prefix, "hits");
+        gf_proc_dump_write (key, "%"PRIu64, stats.hits);
+        gf_proc_dump_build_key (key, key_prefix, "misses");
+        gf_proc_dump_write (key, "%"PRIu64, stats.misses);
+        gf_proc_dump_build_key (key, key_prefix, "hit_ratio");
+        gf_proc_dump_write (key, "%.3f", (stats.hits + stats.misses)
+                            ? (double)stats.hits / (stats.hits + stats.misses)
+                            : 0.0);
+
+        /* file_bytes / unique_bytes: what sharing contents saves,
+           unique_bytes / cache_used: what compressing them saves */
+        gf_proc_dump_build_key (key, key_prefix, "file_bytes");
+        gf_proc_dump_write (key, "%"PRIu64, stats.file_bytes);
+        gf_proc_dump_build_key (key, key_prefix, "unique_bytes");
+        gf_proc_dump_write (key, "%"PRIu64, stats.unique_bytes);
+        gf_proc_dump_build_key (key, key_prefix, "dedup_ratio");
+        gf_proc_dump_write (key, "%.3f", stats.unique_bytes
+                            ? (double)stats.file_bytes / stats.unique_bytes
+                            : 1.0);
+        gf_proc_dump_build_key (key, key_prefix, "compression_ratio");
+        gf_proc_dump_write (key, "%.3f", stats.cache_used
+                            ? (double)stats.unique_bytes / stats.cache_used
+                            : 1.0);
+        gf_proc_dump_build_key (key, key_prefix, "compressed_contents");
+        gf_proc_dump_write (key, "%"PRIu64, stats.compressed);
 
-out:
         return 0;
 }
 
@@ -3429,6 +4410,9 @@ reconfigure (xlator_t *this, dict_t *options)
 
         GF_OPTION_RECONF ("cache-size", conf->cache_size, options, size, out);
 
+        GF_OPTION_RECONF ("compress-cold", conf->compress, options, bool,
+                          out);
+
         ret = 0;
 out:
         return ret;
@@ -3540,9 +4524,10 @@ out:
 int32_t
 init (xlator_t *this)
 {
-        int32_t       ret  = -1, i = 0;
-        qr_private_t *priv = NULL;
-        qr_conf_t    *conf = NULL;
+        int32_t           ret   = -1, i = 0, j = 0;
+        qr_private_t     *priv  = NULL;
+        qr_conf_t        *conf  = NULL;
+        qr_inode_table_t *table = NULL;
 
         if (!this->children || this->children->next) {
                 gf_log (this->name, GF_LOG_ERROR,
@@ -3562,7 +4547,6 @@ init (xlator_t *this)
                 goto out;
         }
 
-        LOCK_INIT (&priv->table.lock);
         conf = &priv->conf;
 
         GF_OPTION_INIT ("max-file-size", conf->max_file_size, size, out);
@@ -3571,6 +4555,14 @@ init (xlator_t *this)
 
         GF_OPTION_INIT ("cache-size", conf->cache_size, size, out);
 
+        GF_OPTION_INIT ("compress-cold", conf->compress, bool, out);
+#ifndef HAVE_LIBLZ4
+        if (conf->compress) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "built without lz4, compress-cold has no effect");
+        }
+#endif
+
         INIT_LIST_HEAD (&conf->priority_list);
         conf->max_pri = 1;
         if (dict_get (this->options, "priority")) {
@@ -3588,15 +4580,29 @@ init (xlator_t *this)
                 conf->max_pri ++;
         }
 
-        priv->table.lru = GF_CALLOC (conf->max_pri, sizeof (*priv->table.lru),
-                                     gf_common_mt_list_head);
-        if (priv->table.lru == NULL) {
-                ret = -1;
-                goto out;
+        for (j = 0; j < QR_INODE_TABLE_SHARDS; j++) {
+                table = &priv->table[j];
+
+                table->lru = GF_CALLOC (conf->max_pri, sizeof (*table->lru),
+                                        gf_common_mt_list_head);
+                if (table->lru == NULL) {
+                        ret = -1;
+                        goto out;
+                }
+
+                for (i = 0; i < conf->max_pri; i++) {
+                        INIT_LIST_HEAD (&table->lru[i]);
+                }
+
+                LOCK_INIT (&table->lock);
         }
 
-        for (i = 0; i < conf->max_pri; i++) {
-                INIT_LIST_HEAD (&priv->table.lru[i]);
+        for (j = 0; j < QR_INODE_TABLE_SHARDS; j++) {
+                for (i = 0; i < QR_CONTENT_BUCKETS; i++) {
+                        INIT_LIST_HEAD (&priv->contents[j].buckets[i]);
+                }
+
+                LOCK_INIT (&priv->contents[j].lock);
         }
 
         ret = 0;
@@ -3604,6 +4610,12 @@ init (xlator_t *this)
         this->private = priv;
 out:
         if ((ret == -1) && priv) {
+                for (j = 0; j < QR_INODE_TABLE_SHARDS; j++) {
+                        if (priv->table[j].lru != NULL) {
+                                GF_FREE (priv->table[j].lru);
+                        }
+                }
+
                 GF_FREE (priv);
         }
 
@@ -3630,6 +4642,9 @@ struct xlator_fops fops = {
         .finodelk    = qr_finodelk,
         .fsync       = qr_fsync,
         .ftruncate   = qr_ftruncate,
+        .fallocate   = qr_fallocate,
+        .discard     = qr_discard,
+        .zerofill    = qr_zerofill,
         .lk          = qr_lk,
         .fsetattr    = qr_fsetattr,
 };
@@ -3668,4 +4683,11 @@ struct volume_options options[] = {
           .max  = 1 * GF_UNIT_KB * 1000,
           .default_value = "64KB",
         },
+        { .key  = {"compress-cold"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Hold the least recently used files compressed "
+                         "(lz4) before evicting any to stay within "
+                         "cache-size. Needs quick-read built with lz4."
+        },
 };
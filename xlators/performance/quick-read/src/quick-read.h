@@ -35,6 +35,7 @@
 #include "common-utils.h"
 #include "call-stub.h"
 #include "defaults.h"
+#include "hashfn.h"
 #include <libgen.h>
 #include <sys/time.h>
 #include <sys/types.h>
@@ -43,6 +44,10 @@
 #include <fnmatch.h>
 #include "quick-read-mem-types.h"
 
+#ifdef HAVE_LIBLZ4
+#include <lz4.h>
+#endif
+
 struct qr_fd_ctx {
         char              opened;
         char              disabled;
@@ -67,8 +72,26 @@ struct qr_local {
 };
 typedef struct qr_local qr_local_t;
 
+/* A cached file body. Files with the same contents share one, found
+ * through the content table by a hash of the data. While cold it may be
+ * held compressed.
+ */
+struct qr_content {
+        uint32_t          hash;
+        size_t            size;         /* of the file contents */
+        char             *data;
+        size_t            csize;        /* bytes of data if compressed,
+                                           0 if data holds the contents
+                                           as is */
+        char              incompressible;
+        int32_t           refcount;     /* qr_inodes using it */
+        gf_lock_t         lock;         /* data and csize */
+        struct list_head  hash_list;
+};
+typedef struct qr_content qr_content_t;
+
 struct qr_inode {
-        dict_t           *xattr;
+        qr_content_t     *content;
         inode_t          *inode;
         int               priority;
         struct iatt       stbuf;
@@ -88,21 +111,48 @@ struct qr_conf {
         uint64_t         max_file_size;
         int32_t          cache_timeout;
         uint64_t         cache_size;
+        gf_boolean_t     compress;
         int              max_pri;
         struct list_head priority_list;
 };
 typedef struct qr_conf qr_conf_t;
 
+/* Inodes are spread over QR_INODE_TABLE_SHARDS tables by address, each
+ * with its own lock and lru lists, so that hits on different files do
+ * not serialize. Contents are spread the same way by hash.
+ */
+#define QR_INODE_TABLE_SHARDS  16
+#define QR_CONTENT_BUCKETS     256      /* per content table */
+
 struct qr_inode_table {
-        uint64_t          cache_used;
         struct list_head *lru;
         gf_lock_t         lock;
 };
 typedef struct qr_inode_table qr_inode_table_t;
 
+struct qr_content_table {
+        struct list_head  buckets[QR_CONTENT_BUCKETS];
+        gf_lock_t         lock;         /* buckets and refcounts */
+};
+typedef struct qr_content_table qr_content_table_t;
+
+struct qr_stats {
+        uint64_t          hits;         /* readv answered from the cache */
+        uint64_t          misses;       /* readv wound down */
+        uint64_t          cache_used;   /* bytes of content data held, this
+                                           is what cache-size limits */
+        uint64_t          file_bytes;   /* sum of the sizes of the cached
+                                           files, duplicates included */
+        uint64_t          unique_bytes; /* same, each content counted once */
+        uint64_t          compressed;   /* contents stored compressed */
+};
+typedef struct qr_stats qr_stats_t;
+
 struct qr_private {
-        qr_conf_t         conf;
-        qr_inode_table_t  table;
+        qr_conf_t           conf;
+        qr_inode_table_t    table[QR_INODE_TABLE_SHARDS];
+        qr_content_table_t  contents[QR_INODE_TABLE_SHARDS];
+        qr_stats_t          stats;      /* updated with atomic ops */
 };
 typedef struct qr_private qr_private_t;
 
@@ -33,13 +33,17 @@ typedef enum {
 void
 sp_inode_ctx_free (xlator_t *this, sp_inode_ctx_t *ctx)
 {
-        call_stub_t *stub = NULL, *tmp = NULL;
+        call_stub_t *stub  = NULL, *tmp = NULL;
+        sp_cache_t  *cache = NULL;
 
         GF_VALIDATE_OR_GOTO ("stat-prefetch", this, out);
         GF_VALIDATE_OR_GOTO (this->name, ctx, out);
 
         LOCK (&ctx->lock);
         {
+                cache = ctx->cache;
+                ctx->cache = NULL;
+
                 if (!list_empty (&ctx->waiting_ops)) {
                         gf_log (this->name, GF_LOG_WARNING, "inode ctx is "
                                 "being freed even when there are file "
@@ -58,6 +62,8 @@ sp_inode_ctx_free (xlator_t *this, sp_inode_ctx_t *ctx)
         }
         UNLOCK (&ctx->lock);
 
+        sp_cache_free (cache);
+
         LOCK_DESTROY (&ctx->lock);
         GF_FREE (ctx);
 
@@ -220,14 +226,15 @@ sp_cache_ref (sp_cache_t *cache)
         UNLOCK (&cache->lock);
 
 out:
-        return cache;;
+        return cache;
 }
 
 
 void
 sp_cache_unref (sp_cache_t *cache)
 {
-        int refcount = 0;
+        sp_private_t *priv     = NULL;
+        int           refcount = 0;
 
         if (cache == NULL) {
                 goto out;
@@ -240,7 +247,18 @@ sp_cache_unref (sp_cache_t *cache)
         UNLOCK (&cache->lock);
 
         if (refcount == 0) {
+                priv = cache->this->private;
+
+                LOCK (&priv->lock);
+                {
+                        list_del_init (&cache->lru);
+                        priv->entries -= cache->entries;
+                        priv->size -= cache->size;
+                }
+                UNLOCK (&priv->lock);
+
                 rbthash_table_destroy (cache->table);
+                LOCK_DESTROY (&cache->lock);
                 GF_FREE (cache);
         }
 
@@ -346,8 +364,12 @@ sp_hashfn (void *data, int len)
 }
 
 
+#define SP_DIRENT_SIZE(dirent) (sizeof (gf_dirent_t) + sizeof (rbthash_entry_t) \
+                                + strlen ((dirent)->d_name) + 1)
+
+
 sp_cache_t *
-sp_cache_init (xlator_t *this)
+sp_cache_init (xlator_t *this, inode_t *inode)
 {
         sp_cache_t      *cache = NULL;
         sp_private_t    *priv  = NULL;
@@ -374,7 +396,10 @@ sp_cache_init (xlator_t *this)
                 }
 
                 LOCK_INIT (&cache->lock);
+                INIT_LIST_HEAD (&cache->lru);
                 cache->this = this;
+                cache->inode = inode;
+                cache->ref = 1;
         }
 
 out:
@@ -392,14 +417,50 @@ sp_local_free (sp_local_t *local)
 }
 
 
+/* Brings priv's totals in line after entries were added to or removed
+ * from cache, and keeps the cache on the lru list exactly while it
+ * holds entries.
+ */
+void
+sp_cache_account (sp_cache_t *cache, int32_t entries, int64_t size)
+{
+        sp_private_t *priv    = NULL;
+        char          present = 0;
+
+        priv = cache->this->private;
+
+        LOCK (&priv->lock);
+        {
+                priv->entries += entries;
+                priv->size += size;
+
+                LOCK (&cache->lock);
+                {
+                        present = (cache->entries != 0)
+                                && (cache->inode != NULL);
+                }
+                UNLOCK (&cache->lock);
+
+                if (!present) {
+                        list_del_init (&cache->lru);
+                } else if (list_empty (&cache->lru)) {
+                        list_add_tail (&cache->lru, &priv->lru);
+                }
+        }
+        UNLOCK (&priv->lock);
+}
+
+
 int32_t
 sp_cache_remove_entry (sp_cache_t *cache, char *name, char remove_all)
 {
-        int32_t          ret   = -1;
-        rbthash_table_t *table = NULL;
-        xlator_t        *this  = NULL;
-        sp_private_t    *priv  = NULL;
-        void            *data  = NULL;
+        int32_t          ret     = -1;
+        rbthash_table_t *table   = NULL;
+        xlator_t        *this    = NULL;
+        sp_private_t    *priv    = NULL;
+        gf_dirent_t     *data    = NULL;
+        int32_t          entries = 0;
+        int64_t          size    = 0;
 
         GF_VALIDATE_OR_GOTO ("stat-prefetch", cache, out);
         if ((name == NULL) && !remove_all) {
@@ -419,57 +480,95 @@ sp_cache_remove_entry (sp_cache_t *cache, char *name, char remove_all)
         LOCK (&cache->lock);
         {
                 if (remove_all) {
+                        if (cache->entries == 0) {
+                                ret = 0;
+                                goto unlock;
+                        }
+
                         table = cache->table;
                         cache->table = rbthash_table_init (GF_SP_CACHE_BUCKETS,
                                                            sp_hashfn, __gf_free,
                                                            0, priv->mem_pool);
                         if (cache->table == NULL) {
                                 cache->table = table;
+                                table = NULL;
                         } else {
-                                rbthash_table_destroy (table);
+                                entries = cache->entries;
+                                size = cache->size;
+                                cache->entries = 0;
+                                cache->size = 0;
                                 ret = 0;
-                                if (priv) {
-                                        LOCK (&priv->lock);
-                                        {
-                                                priv->entries = 0;
-                                        }
-                                        UNLOCK (&priv->lock);
-                                }
                         }
                 } else {
                         data = rbthash_remove (cache->table, name,
                                                strlen (name));
-                        GF_FREE (data);
-                        ret = 0;
-                        if (priv) {
-                                LOCK (&priv->lock);
-                                {
-                                        priv->entries--;
-                                }
-                                UNLOCK (&priv->lock);
+                        if (data != NULL) {
+                                entries = 1;
+                                size = SP_DIRENT_SIZE (data);
+                                cache->entries--;
+                                cache->size -= size;
+                                GF_FREE (data);
                         }
+                        ret = 0;
                 }
         }
+unlock:
         UNLOCK (&cache->lock);
 
+        if (table != NULL) {
+                rbthash_table_destroy (table);
+        }
+
+        if (entries != 0) {
+                sp_cache_account (cache, -entries, -size);
+        }
+
 out:
         return ret;
 }
 
 
+static char
+__sp_cache_is_expired (sp_cache_t *cache, int32_t timeout)
+{
+        struct timeval now     = {0, };
+        int64_t        elapsed = 0;
+
+        gettimeofday (&now, NULL);
+
+        elapsed = (now.tv_sec - cache->tv.tv_sec) * 1000000LL
+                + (now.tv_usec - cache->tv.tv_usec);
+
+        return (elapsed >= timeout * 1000000LL);
+}
+
+
 int32_t
 sp_cache_get_entry (sp_cache_t *cache, char *name, gf_dirent_t **entry)
 {
-        int32_t      ret = -1;
-        gf_dirent_t *tmp = NULL, *new = NULL;
+        int32_t       ret     = -1;
+        gf_dirent_t  *tmp     = NULL, *new = NULL;
+        sp_private_t *priv    = NULL;
+        char          expired = 0;
 
         GF_VALIDATE_OR_GOTO ("stat-prefetch", cache, out);
         GF_VALIDATE_OR_GOTO ("stat-prefetch", cache->this, out);
         GF_VALIDATE_OR_GOTO (cache->this->name, name, out);
         GF_VALIDATE_OR_GOTO (cache->this->name, entry, out);
 
+        priv = cache->this->private;
+
         LOCK (&cache->lock);
         {
+                if (cache->entries == 0) {
+                        goto unlock;
+                }
+
+                if (__sp_cache_is_expired (cache, priv->cache_timeout)) {
+                        expired = 1;
+                        goto unlock;
+                }
+
                 tmp = rbthash_get (cache->table, name, strlen (name));
                 if (tmp != NULL) {
                         new = gf_dirent_for_name (tmp->d_name);
@@ -493,60 +592,32 @@ sp_cache_get_entry (sp_cache_t *cache, char *name, gf_dirent_t **entry)
 unlock:
         UNLOCK (&cache->lock);
 
+        if (expired) {
+                sp_cache_remove_entry (cache, NULL, 1);
+        }
+
 out:
         return ret;
 }
 
 
+/* the inode ctx's reference goes, lookups already holding the cache
+   finish with it */
 void
 sp_cache_free (sp_cache_t *cache)
 {
-        sp_cache_remove_entry (cache, NULL, 1);
-        sp_cache_unref (cache);
-}
-
-
-sp_cache_t *
-__sp_get_cache_fd (xlator_t *this, fd_t *fd)
-{
-        int32_t      ret   = -1;
-        sp_cache_t  *cache = NULL;
-        uint64_t     value = 0;
-        sp_fd_ctx_t *fd_ctx = NULL;
-
-        ret = __fd_ctx_get (fd, this, &value);
-        if (ret == -1) {
-                goto out;
+        if (cache == NULL) {
+                return;
         }
 
-        fd_ctx = (void *)(long) value;
-
-        cache = fd_ctx->cache;
-
-out:
-        return cache;
-}
-
-
-sp_cache_t *
-sp_get_cache_fd (xlator_t *this, fd_t *fd)
-{
-        sp_cache_t  *cache     = NULL;
-
-        GF_VALIDATE_OR_GOTO ("stat-prefetch", this, out);
-        GF_VALIDATE_OR_GOTO (this->name, fd, out);
-
-        LOCK (&fd->lock);
+        LOCK (&cache->lock);
         {
-                cache = __sp_get_cache_fd (this, fd);
-                if (cache != NULL) {
-                        sp_cache_ref (cache);
-                }
+                cache->inode = NULL;
         }
-        UNLOCK (&fd->lock);
+        UNLOCK (&cache->lock);
 
-out:
-        return cache;
+        sp_cache_remove_entry (cache, NULL, 1);
+        sp_cache_unref (cache);
 }
 
 
@@ -567,10 +638,6 @@ sp_fd_ctx_free (sp_fd_ctx_t *fd_ctx)
                 fd_ctx->name = NULL;
         }
 
-        if (fd_ctx->cache) {
-                sp_cache_free (fd_ctx->cache);
-        }
-
         GF_FREE (fd_ctx);
 out:
         return;
@@ -589,7 +656,7 @@ sp_fd_ctx_init (void)
 
 
 sp_fd_ctx_t *
-sp_fd_ctx_new (xlator_t *this, inode_t *parent, char *name, sp_cache_t *cache)
+sp_fd_ctx_new (xlator_t *this, inode_t *parent, char *name)
 {
         sp_fd_ctx_t *fd_ctx = NULL;
 
@@ -611,119 +678,89 @@ sp_fd_ctx_new (xlator_t *this, inode_t *parent, char *name, sp_cache_t *cache)
                 }
         }
 
-        fd_ctx->cache = cache;
-
 out:
         return fd_ctx;
 }
 
 
 sp_cache_t *
-sp_del_cache_fd (xlator_t *this, fd_t *fd)
+sp_get_cache_inode (xlator_t *this, inode_t *inode)
 {
-        sp_cache_t  *cache  = NULL;
-        uint64_t     value  = 0;
-        int32_t      ret    = -1;
-        sp_fd_ctx_t *fd_ctx = NULL;
+        sp_inode_ctx_t *inode_ctx = NULL;
+        sp_cache_t     *cache     = NULL;
+        uint64_t        value     = 0;
+        int32_t         ret       = -1;
 
-        if (fd == NULL) {
+        if (inode == NULL) {
                 goto out;
         }
 
-        LOCK (&fd->lock);
+        ret = inode_ctx_get (inode, this, &value);
+        if ((ret == -1) || (value == 0)) {
+                goto out;
+        }
+
+        inode_ctx = (sp_inode_ctx_t *)(long)value;
+
+        LOCK (&inode_ctx->lock);
         {
-                ret = __fd_ctx_get (fd, this, &value);
-                if (ret == 0) {
-                        fd_ctx = (void *)(long) value;
-                        cache = fd_ctx->cache;
-                        fd_ctx->cache = NULL;
-                }
+                cache = sp_cache_ref (inode_ctx->cache);
         }
-        UNLOCK (&fd->lock);
+        UNLOCK (&inode_ctx->lock);
 
 out:
         return cache;
 }
 
 
+/* the cache of a directory about to be filled by readdirp, created on
+   its first listing */
 sp_cache_t *
-sp_get_cache_inode (xlator_t *this, inode_t *inode, int32_t pid)
+sp_get_or_create_cache_inode (xlator_t *this, inode_t *inode)
 {
-        fd_t       *fd    = NULL;
-        sp_cache_t *cache = NULL;
+        sp_inode_ctx_t *inode_ctx = NULL;
+        sp_cache_t     *cache     = NULL;
 
-        if (inode == NULL) {
+        inode_ctx = sp_check_and_create_inode_ctx (this, inode, SP_DONT_CARE);
+        if (inode_ctx == NULL) {
                 goto out;
         }
 
-        fd = fd_lookup (inode, pid);
-        if (fd == NULL) {
-                goto out;
+        LOCK (&inode_ctx->lock);
+        {
+                if (inode_ctx->cache == NULL) {
+                        inode_ctx->cache = sp_cache_init (this, inode);
+                }
+
+                cache = sp_cache_ref (inode_ctx->cache);
         }
+        UNLOCK (&inode_ctx->lock);
 
-        cache = sp_get_cache_fd (this, fd);
+        if (cache == NULL) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "creation of stat-prefetch cache for directory "
+                        "(ino:%"PRId64", gfid:%s) failed", inode->ino,
+                        uuid_utoa (inode->gfid));
+        }
 
-        fd_unref (fd);
 out:
         return cache;
 }
 
 
-fd_t *
-_fd_ref (fd_t *fd);
-
+/* name (all of them if NULL) changed in directory inode */
 void
-sp_remove_caches_from_all_fds_opened (xlator_t *this, inode_t *inode,
-                                      char *name)
+sp_cache_remove_inode_entry (xlator_t *this, inode_t *inode, char *name)
 {
-        fd_t       *fd    = NULL;
         sp_cache_t *cache = NULL;
-        struct fd_wrapper {
-                fd_t             *fd;
-                struct list_head  list;
-        };
-
-        struct fd_wrapper *wrapper    = NULL, *tmp = NULL;
-        struct list_head   head       = {0, };
-        char               remove_all = 0;
-
-        wrapper = NULL;
-
-        INIT_LIST_HEAD (&head);
 
         GF_VALIDATE_OR_GOTO ("stat-prefetch", this, out);
         GF_VALIDATE_OR_GOTO (this->name, inode, out);
 
-        remove_all = (name == NULL);
-
-        LOCK (&inode->lock);
-        {
-                list_for_each_entry (fd, &inode->fd_list, inode_list) {
-                        wrapper = GF_CALLOC (1, sizeof (*wrapper),
-                                             gf_sp_mt_fd_wrapper_t);
-                        if (wrapper == NULL) {
-                                goto unlock;
-                        }
-
-                        INIT_LIST_HEAD (&wrapper->list);
-
-                        wrapper->fd = _fd_ref (fd);
-                        list_add_tail (&wrapper->list, &head);
-                }
-        }
-unlock:
-        UNLOCK (&inode->lock);
-
-        list_for_each_entry_safe (wrapper, tmp, &head, list) {
-                cache = sp_get_cache_fd (this, wrapper->fd);
-                if (cache) {
-                        sp_cache_remove_entry (cache, name, remove_all);
-                        sp_cache_unref (cache);
-                }
-
-                list_del (&wrapper->list);
-                fd_unref (wrapper->fd);
-                GF_FREE (wrapper);
+        cache = sp_get_cache_inode (this, inode);
+        if (cache) {
+                sp_cache_remove_entry (cache, name, (name == NULL));
+                sp_cache_unref (cache);
         }
 
 out:
@@ -731,81 +768,119 @@ out:
 }
 
 
-inline int32_t
-__sp_put_cache (xlator_t *this, fd_t *fd, sp_cache_t *cache)
+/* Drops whole directories, least recently used first, until the caches
+ * fit in cache-size again.
+ */
+void
+sp_cache_prune (xlator_t *this)
 {
-        sp_fd_ctx_t *fd_ctx = NULL;
-        int32_t      ret    = -1;
-        uint64_t     value  = 0;
+        sp_private_t *priv   = NULL;
+        sp_cache_t   *cache  = NULL;
+        char          pruned = 0;
 
-        ret = __fd_ctx_get (fd, this, &value);
-        if (!ret) {
-                fd_ctx = (void *)(long)value;
-        } else {
-                fd_ctx = sp_fd_ctx_init ();
-                if (fd_ctx == NULL) {
-                        ret = -1;
-                        goto out;
+        priv = this->private;
+
+        for (;;) {
+                LOCK (&priv->lock);
+                {
+                        cache = NULL;
+                        if ((priv->size > priv->cache_size)
+                            && !list_empty (&priv->lru)) {
+                                cache = list_entry (priv->lru.next,
+                                                    sp_cache_t, lru);
+                                list_del_init (&cache->lru);
+
+                                /* skip one whose last reference is being
+                                   dropped right now */
+                                LOCK (&cache->lock);
+                                {
+                                        pruned = (cache->ref != 0);
+                                        if (pruned) {
+                                                cache->ref++;
+                                        }
+                                }
+                                UNLOCK (&cache->lock);
+                        }
                 }
+                UNLOCK (&priv->lock);
 
-                ret = __fd_ctx_set (fd, this, (long)(void *)fd_ctx);
-                if (ret == -1) {
-                        gf_log (this->name, GF_LOG_WARNING,
-                                "cannot set stat-prefetch context in fd (%p) "
-                                "opened on inode (ino:%"PRId64" gfid:%s)",
-                                fd, fd->inode->ino,
-                                uuid_utoa (fd->inode->gfid));
-                        sp_fd_ctx_free (fd_ctx);
-                        goto out;
+                if (cache == NULL) {
+                        break;
                 }
-        }
 
-        if (fd_ctx->cache) {
-                sp_cache_free (fd_ctx->cache);
+                if (pruned) {
+                        sp_cache_remove_entry (cache, NULL, 1);
+                        sp_cache_unref (cache);
+                }
         }
-
-        fd_ctx->cache = cache;
-
-out:
-        return ret;
 }
 
 
-inline int32_t
-sp_put_cache (xlator_t *this, fd_t *fd, sp_cache_t *cache)
+/* lookups answered from a cache and those which were not */
+void
+sp_cache_update_stats (xlator_t *this, sp_cache_t *cache, char hit)
 {
-        int32_t ret = -1;
+        sp_private_t *priv = NULL;
 
-        if (fd != NULL) {
-                LOCK (&fd->lock);
-                {
-                        ret = __sp_put_cache (this, fd, cache);
+        priv = this->private;
+
+        LOCK (&priv->lock);
+        {
+                if (hit) {
+                        priv->hits++;
+                        if (!list_empty (&cache->lru)) {
+                                list_move_tail (&cache->lru, &priv->lru);
+                        }
+                } else {
+                        priv->misses++;
                 }
-                UNLOCK (&fd->lock);
         }
-
-        return ret;
+        UNLOCK (&priv->lock);
 }
 
 
 int32_t
 sp_cache_add_entries (sp_cache_t *cache, gf_dirent_t *entries)
 {
-        gf_dirent_t *entry           = NULL, *new = NULL;
-        int32_t      ret             = -1;
-        uint64_t     expected_offset = 0;
-        xlator_t     *this           = NULL;
-        sp_private_t *priv           = NULL;
+        gf_dirent_t     *entry = NULL, *new = NULL, *old = NULL;
+        rbthash_table_t *table = NULL;
+        int32_t          ret   = -1;
+        xlator_t        *this  = NULL;
+        sp_private_t    *priv  = NULL;
+        int32_t          count = 0;
+        int64_t          size  = 0;
 
         GF_VALIDATE_OR_GOTO ("stat-prefetch", cache, out);
 
         this = cache->this;
-        if (this && this->private) {
-                priv = this->private;
-        }
+        priv = this->private;
 
         LOCK (&cache->lock);
         {
+                if (cache->entries
+                    && __sp_cache_is_expired (cache, priv->cache_timeout)) {
+                        /* too old to be worth keeping next to fresh ones,
+                           start over */
+                        table = cache->table;
+                        cache->table = rbthash_table_init (GF_SP_CACHE_BUCKETS,
+                                                           sp_hashfn, __gf_free,
+                                                           0, priv->mem_pool);
+                        if (cache->table == NULL) {
+                                cache->table = table;
+                                table = NULL;
+                                goto unlock;
+                        }
+
+                        count -= cache->entries;
+                        size -= cache->size;
+                        cache->entries = 0;
+                        cache->size = 0;
+                }
+
+                if (cache->entries == 0) {
+                        gettimeofday (&cache->tv, NULL);
+                }
+
                 list_for_each_entry (entry, &entries->list, list) {
                         if (IA_ISDIR (entry->d_stat.ia_type)) {
                                 continue;
@@ -828,6 +903,19 @@ sp_cache_add_entries (sp_cache_t *cache, gf_dirent_t *entries)
                         new->d_type = entry->d_type;
                         new->d_stat = entry->d_stat;
 
+                        /* another listing of the directory got here first,
+                           keep the newer stat */
+                        old = rbthash_remove (cache->table, new->d_name,
+                                              strlen (new->d_name));
+                        if (old != NULL) {
+                                count--;
+                                size -= SP_DIRENT_SIZE (old);
+                                cache->entries--;
+                                cache->size -= SP_DIRENT_SIZE (old);
+                                GF_FREE (old);
+                                old = NULL;
+                        }
+
                         ret = rbthash_insert (cache->table, new, new->d_name,
                                               strlen (new->d_name));
                         if (ret == -1) {
@@ -839,23 +927,27 @@ sp_cache_add_entries (sp_cache_t *cache, gf_dirent_t *entries)
                                 continue;
                         }
 
-                        expected_offset = new->d_off;
-                        if (priv) {
-                                LOCK (&priv->lock);
-                                {
-                                        priv->entries++;
-                                }
-                                UNLOCK (&priv->lock);
-                        }
+                        count++;
+                        size += SP_DIRENT_SIZE (new);
+                        cache->entries++;
+                        cache->size += SP_DIRENT_SIZE (new);
                 }
 
-                cache->expected_offset = expected_offset;
-
                 ret = 0;
         }
 unlock:
         UNLOCK (&cache->lock);
 
+        if (table != NULL) {
+                rbthash_table_destroy (table);
+        }
+
+        if ((count != 0) || (size != 0)) {
+                sp_cache_account (cache, count, size);
+        }
+
+        sp_cache_prune (this);
+
 out:
         return ret;
 }
@@ -896,8 +988,8 @@ sp_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         /* For '/' Entry is never cached, don't try to remove it */
         if ((op_ret == -1) && local->loc.parent) {
-                sp_remove_caches_from_all_fds_opened (this, local->loc.parent,
-                                                      (char *)local->loc.name);
+                sp_cache_remove_inode_entry (this, local->loc.parent,
+                                             (char *)local->loc.name);
         }
 
         if (local->is_lookup)
@@ -991,8 +1083,7 @@ sp_cache_remove_parent_entry (call_frame_t *frame, xlator_t *this,
                                                         cpy, out, ret,
                                                         -ENOMEM);
                         path = basename (cpy);
-                        sp_remove_caches_from_all_fds_opened (this, inode_gp,
-                                                              path);
+                        sp_cache_remove_inode_entry (this, inode_gp, path);
                         GF_FREE (cpy);
 
                         inode_unref (inode_gp);
@@ -1144,7 +1235,7 @@ sp_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xattr_req)
                 goto wind;
         }
 
-        cache = sp_get_cache_inode (this, loc->parent, frame->root->pid);
+        cache = sp_get_cache_inode (this, loc->parent);
         if (cache) {
                 ret = sp_cache_get_entry (cache, (char *)loc->name, &dirent);
                 if (ret == 0) {
@@ -1170,7 +1261,7 @@ sp_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xattr_req)
                         GF_FREE (dirent);
                 }
         } else if (IA_ISDIR (loc->inode->ia_type)) {
-                cache = sp_get_cache_inode (this, loc->inode, frame->root->pid);
+                cache = sp_get_cache_inode (this, loc->inode);
                 if (cache) {
                         ret = sp_cache_get_entry (cache, ".", &dirent);
                         if (ret == 0) {
@@ -1192,12 +1283,12 @@ sp_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xattr_req)
 wind:
         if (entry_cached) {
                 if (cache) {
-                        cache->hits++;
+                        sp_cache_update_stats (this, cache, 1);
                         sp_cache_unref (cache);
                 }
         } else {
                 if (cache) {
-                        cache->miss++;
+                        sp_cache_update_stats (this, cache, 0);
                         sp_cache_unref (cache);
                 }
 
@@ -1263,8 +1354,6 @@ sp_readdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         sp_local_t      *local       = NULL;
         sp_cache_t      *cache       = NULL;
         fd_t            *fd          = NULL;
-        int32_t          ret         = 0;
-        char             was_present = 1;
         sp_private_t    *priv        = NULL;
 
         GF_ASSERT (frame);
@@ -1305,44 +1394,10 @@ sp_readdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         if (!priv->mem_pool)
                 goto out;
 
-        LOCK (&fd->lock);
-        {
-                cache = __sp_get_cache_fd (this, fd);
-                if (cache == NULL) {
-                        was_present = 0;
-                        cache = sp_cache_init (this);
-                        if (cache == NULL) {
-                                gf_log (this->name, GF_LOG_WARNING,
-                                        "creation of stat-prefetch cache "
-                                        "for fd (%p) opened on inode "
-                                        "(ino:%"PRId64", gfid:%s) failed", fd,
-                                        fd->inode->ino,
-                                        uuid_utoa (fd->inode->gfid));
-                                goto unlock;
-                        }
-
-                        ret = __sp_put_cache (this, fd, cache);
-                        if (ret == -1) {
-                                sp_cache_free (cache);
-                                gf_log (this->name, GF_LOG_WARNING,
-                                        "cannot store cache in fd (%p) opened "
-                                        "on inode (ino:%"PRId64", gfid:%s)", fd,
-                                        fd->inode->ino,
-                                        uuid_utoa (fd->inode->gfid));
-                                goto unlock;
-                        }
-                }
-
-                sp_cache_ref (cache);
-        }
-unlock:
-        UNLOCK (&fd->lock);
-
+        cache = sp_get_or_create_cache_inode (this, fd->inode);
         if (cache != NULL) {
                 sp_cache_add_entries (cache, entries);
-                if (was_present) {
-                        sp_cache_unref (cache);
-                }
+                sp_cache_unref (cache);
         }
 
 out:
@@ -1355,7 +1410,6 @@ int32_t
 sp_readdir (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
             off_t off)
 {
-        sp_cache_t *cache    = NULL;
         sp_local_t *local    = NULL;
         char       *path     = NULL;
         int32_t     ret      = -1, op_errno = EINVAL;
@@ -1364,13 +1418,9 @@ sp_readdir (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         GF_VALIDATE_OR_GOTO (frame->this->name, this, unwind);
         GF_VALIDATE_OR_GOTO (this->name, fd, unwind);
 
-        cache = sp_get_cache_fd (this, fd);
-        if (cache) {
-                if (off != cache->expected_offset) {
-                        sp_cache_remove_entry (cache, NULL, 1);
-                }
-
-                sp_cache_unref (cache);
+        /* a new listing refreshes whatever an earlier one left */
+        if (off == 0) {
+                sp_cache_remove_inode_entry (this, fd->inode, NULL);
         }
 
         ret = inode_path (fd->inode, NULL, &path);
@@ -1480,7 +1530,7 @@ sp_fd_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
         }
 
         fd_ctx = sp_fd_ctx_new (this, local->loc.parent,
-                                (char *)local->loc.name, NULL);
+                                (char *)local->loc.name);
         if (fd_ctx == NULL) {
                 op_ret = -1;
                 op_errno = ENOMEM;
@@ -1665,7 +1715,7 @@ sp_create_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         }
 
         fd_ctx = sp_fd_ctx_new (this, local->loc.parent,
-                                (char *)local->loc.name, NULL);
+                                (char *)local->loc.name);
         if (fd_ctx == NULL) {
                 op_ret = -1;
                 op_errno = ENOMEM;
@@ -2207,8 +2257,8 @@ sp_link (call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc)
                 goto out;
         }
 
-        sp_remove_caches_from_all_fds_opened (this, oldloc->parent,
-                                              (char *)oldloc->name);
+        sp_cache_remove_inode_entry (this, oldloc->parent,
+                                     (char *)oldloc->name);
 
         stub = fop_link_stub (frame, sp_link_helper, oldloc, newloc);
         if (stub == NULL) {
@@ -2299,8 +2349,7 @@ sp_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset)
         GF_VALIDATE_OR_GOTO (this->name, loc, out);
         GF_VALIDATE_OR_GOTO (this->name, loc->name, out);
 
-        sp_remove_caches_from_all_fds_opened (this, loc->parent,
-                                              (char *)loc->name);
+        sp_cache_remove_inode_entry (this, loc->parent, (char *)loc->name);
 
         stub = fop_truncate_stub (frame, sp_truncate_helper, loc, offset);
         if (stub == NULL) {
@@ -2353,7 +2402,7 @@ sp_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset)
         name   = fd_ctx->name;
         parent = fd_ctx->parent_inode;
 
-        sp_remove_caches_from_all_fds_opened (this, parent, (char *)name);
+        sp_cache_remove_inode_entry (this, parent, (char *)name);
 
         STACK_WIND (frame, sp_truncate_cbk, FIRST_CHILD(this),
                     FIRST_CHILD(this)->fops->ftruncate, fd, offset);
@@ -2364,6 +2413,124 @@ unwind:
         return 0;
 }
 
+int32_t
+sp_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              int32_t keep_size, off_t offset, size_t len)
+{
+        sp_fd_ctx_t *fd_ctx = NULL;
+        uint64_t     value  = 0;
+        int32_t      ret    = 0, op_errno = EINVAL;
+        inode_t     *parent = NULL;
+        char        *name   = NULL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this ? frame->this->name : "stat-prefetch",
+                             this, unwind);
+        GF_VALIDATE_OR_GOTO (this->name, fd, unwind);
+
+        ret = fd_ctx_get (fd, this, &value);
+        if (ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "stat-prefetch context not "
+                        "set in fd (%p) opened on inode (ino:%"PRId64", "
+                        "gfid:%s", fd, fd->inode->ino,
+                        uuid_utoa (fd->inode->gfid));
+                goto unwind;
+        }
+
+        fd_ctx = (void *)(long)value;
+        name   = fd_ctx->name;
+        parent = fd_ctx->parent_inode;
+
+        sp_cache_remove_inode_entry (this, parent, (char *)name);
+
+        STACK_WIND (frame, sp_truncate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->fallocate, fd, keep_size, offset, len);
+        return 0;
+
+unwind:
+        SP_STACK_UNWIND (fallocate, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+int32_t
+sp_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+            off_t offset, size_t len)
+{
+        sp_fd_ctx_t *fd_ctx = NULL;
+        uint64_t     value  = 0;
+        int32_t      ret    = 0, op_errno = EINVAL;
+        inode_t     *parent = NULL;
+        char        *name   = NULL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this ? frame->this->name : "stat-prefetch",
+                             this, unwind);
+        GF_VALIDATE_OR_GOTO (this->name, fd, unwind);
+
+        ret = fd_ctx_get (fd, this, &value);
+        if (ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "stat-prefetch context not "
+                        "set in fd (%p) opened on inode (ino:%"PRId64", "
+                        "gfid:%s", fd, fd->inode->ino,
+                        uuid_utoa (fd->inode->gfid));
+                goto unwind;
+        }
+
+        fd_ctx = (void *)(long)value;
+        name   = fd_ctx->name;
+        parent = fd_ctx->parent_inode;
+
+        sp_cache_remove_inode_entry (this, parent, (char *)name);
+
+        STACK_WIND (frame, sp_truncate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->discard, fd, offset, len);
+        return 0;
+
+unwind:
+        SP_STACK_UNWIND (discard, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+int32_t
+sp_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             int32_t keep_size, off_t offset, size_t len)
+{
+        sp_fd_ctx_t *fd_ctx = NULL;
+        uint64_t     value  = 0;
+        int32_t      ret    = 0, op_errno = EINVAL;
+        inode_t     *parent = NULL;
+        char        *name   = NULL;
+
+        GF_ASSERT (frame);
+        GF_VALIDATE_OR_GOTO (frame->this ? frame->this->name : "stat-prefetch",
+                             this, unwind);
+        GF_VALIDATE_OR_GOTO (this->name, fd, unwind);
+
+        ret = fd_ctx_get (fd, this, &value);
+        if (ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "stat-prefetch context not "
+                        "set in fd (%p) opened on inode (ino:%"PRId64", "
+                        "gfid:%s", fd, fd->inode->ino,
+                        uuid_utoa (fd->inode->gfid));
+                goto unwind;
+        }
+
+        fd_ctx = (void *)(long)value;
+        name   = fd_ctx->name;
+        parent = fd_ctx->parent_inode;
+
+        sp_cache_remove_inode_entry (this, parent, (char *)name);
+
+        STACK_WIND (frame, sp_truncate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->zerofill, fd, keep_size,
+                    offset, len);
+        return 0;
+
+unwind:
+        SP_STACK_UNWIND (zerofill, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
 
 int32_t
 sp_setattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
@@ -2441,8 +2608,7 @@ sp_setattr (call_frame_t *frame, xlator_t *this,
         GF_VALIDATE_OR_GOTO (this->name, loc, out);
         GF_VALIDATE_OR_GOTO (this->name, loc->name, out);
 
-        sp_remove_caches_from_all_fds_opened (this, loc->parent,
-                                              (char *)loc->name);
+        sp_cache_remove_inode_entry (this, loc->parent, (char *)loc->name);
 
         stub = fop_setattr_stub (frame, sp_setattr_helper, loc, buf, valid);
         if (stub == NULL) {
@@ -2541,8 +2707,7 @@ sp_readlink (call_frame_t *frame, xlator_t *this, loc_t *loc, size_t size)
         GF_VALIDATE_OR_GOTO (this->name, loc, out);
         GF_VALIDATE_OR_GOTO (this->name, loc->name, out);
 
-        sp_remove_caches_from_all_fds_opened (this, loc->parent,
-                                              (char *)loc->name);
+        sp_cache_remove_inode_entry (this, loc->parent, (char *)loc->name);
 
         stub = fop_readlink_stub (frame, sp_readlink_helper, loc, size);
         if (stub == NULL) {
@@ -2649,8 +2814,7 @@ sp_unlink (call_frame_t *frame, xlator_t *this, loc_t *loc)
         GF_VALIDATE_OR_GOTO (this->name, loc, out);
         GF_VALIDATE_OR_GOTO (this->name, loc->name, out);
 
-        sp_remove_caches_from_all_fds_opened (this, loc->parent,
-                                              (char *)loc->name);
+        sp_cache_remove_inode_entry (this, loc->parent, (char *)loc->name);
 
         ret = sp_cache_remove_parent_entry (frame, this, loc->parent->table,
                                             (char *)loc->path);
@@ -2748,7 +2912,7 @@ sp_rmdir (call_frame_t *frame, xlator_t *this, loc_t *loc, int flags)
         GF_VALIDATE_OR_GOTO (this->name, loc->path, out);
         GF_VALIDATE_OR_GOTO (this->name, loc->inode, out);
 
-        sp_remove_caches_from_all_fds_opened (this, loc->inode, NULL);
+        sp_cache_remove_inode_entry (this, loc->inode, NULL);
 
         ret = sp_cache_remove_parent_entry (frame, this, loc->inode->table,
                                             (char *)loc->path);
@@ -2823,7 +2987,7 @@ sp_readv (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         name   = fd_ctx->name;
         parent = fd_ctx->parent_inode;
 
-        sp_remove_caches_from_all_fds_opened (this, parent, (char *)name);
+        sp_cache_remove_inode_entry (this, parent, (char *)name);
 
         STACK_WIND (frame, sp_readv_cbk, FIRST_CHILD(this),
                     FIRST_CHILD(this)->fops->readv, fd, size, offset);
@@ -2862,7 +3026,7 @@ sp_writev (call_frame_t *frame, xlator_t *this, fd_t *fd, struct iovec *vector,
         name   = fd_ctx->name;
         parent = fd_ctx->parent_inode;
 
-        sp_remove_caches_from_all_fds_opened (this, parent, (char *)name);
+        sp_cache_remove_inode_entry (this, parent, (char *)name);
 
         STACK_WIND (frame, sp_unlink_cbk, FIRST_CHILD(this),
                     FIRST_CHILD(this)->fops->writev, fd, vector, count, off,
@@ -2901,7 +3065,7 @@ sp_fsync (call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t flags)
         name   = fd_ctx->name;
         parent = fd_ctx->parent_inode;
 
-        sp_remove_caches_from_all_fds_opened (this, parent, (char *)name);
+        sp_cache_remove_inode_entry (this, parent, (char *)name);
 
         STACK_WIND (frame, sp_unlink_cbk, FIRST_CHILD(this),
                     FIRST_CHILD(this)->fops->fsync, fd, flags);
@@ -3057,11 +3221,11 @@ sp_rename (call_frame_t *frame, xlator_t *this, loc_t *oldloc,loc_t *newloc)
         GF_VALIDATE_OR_GOTO (this->name, newloc, out);
         GF_VALIDATE_OR_GOTO (this->name, newloc->path, out);
 
-        sp_remove_caches_from_all_fds_opened (this, oldloc->parent,
-                                              (char *)oldloc->name);
+        sp_cache_remove_inode_entry (this, oldloc->parent,
+                                     (char *)oldloc->name);
 
-        sp_remove_caches_from_all_fds_opened (this, newloc->parent,
-                                              (char *)newloc->name);
+        sp_cache_remove_inode_entry (this, newloc->parent,
+                                     (char *)newloc->name);
 
         ret = sp_cache_remove_parent_entry (frame, this, oldloc->parent->table,
                                             (char *)oldloc->path);
@@ -3082,8 +3246,7 @@ sp_rename (call_frame_t *frame, xlator_t *this, loc_t *oldloc,loc_t *newloc)
         }
 
         if (IA_ISDIR (oldloc->inode->ia_type)) {
-                sp_remove_caches_from_all_fds_opened (this, oldloc->inode,
-                                                      NULL);
+                sp_cache_remove_inode_entry (this, oldloc->inode, NULL);
         }
 
         stub = fop_rename_stub (frame, sp_rename_helper, oldloc, newloc);
@@ -3232,8 +3395,7 @@ sp_setxattr (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *dict,
         GF_VALIDATE_OR_GOTO (this->name, loc, out);
         GF_VALIDATE_OR_GOTO (this->name, loc->name, out);
 
-        sp_remove_caches_from_all_fds_opened (this, loc->parent,
-                                              (char *)loc->name);
+        sp_cache_remove_inode_entry (this, loc->parent, (char *)loc->name);
 
         stub = fop_setxattr_stub (frame, sp_setxattr_helper, loc, dict, flags);
         if (stub == NULL) {
@@ -3321,8 +3483,7 @@ sp_removexattr (call_frame_t *frame, xlator_t *this, loc_t *loc,
         GF_VALIDATE_OR_GOTO (this->name, loc, out);
         GF_VALIDATE_OR_GOTO (this->name, loc->name, out);
 
-        sp_remove_caches_from_all_fds_opened (this, loc->parent,
-                                              (char *)loc->name);
+        sp_cache_remove_inode_entry (this, loc->parent, (char *)loc->name);
 
         stub = fop_removexattr_stub (frame, sp_removexattr_helper, loc, name);
         if (stub == NULL) {
@@ -3515,8 +3676,7 @@ sp_xattrop (call_frame_t *frame, xlator_t *this, loc_t *loc,
         GF_VALIDATE_OR_GOTO (this->name, loc, out);
         GF_VALIDATE_OR_GOTO (this->name, loc->name, out);
 
-        sp_remove_caches_from_all_fds_opened (this, loc->parent,
-                                              (char *)loc->name);
+        sp_cache_remove_inode_entry (this, loc->parent, (char *)loc->name);
 
         stub = fop_xattrop_stub (frame, sp_xattrop_helper, loc, flags, dict);
         if (stub == NULL) {
@@ -3569,7 +3729,7 @@ sp_fxattrop (call_frame_t *frame, xlator_t *this, fd_t *fd,
         name   = fd_ctx->name;
         parent = fd_ctx->parent_inode;
 
-        sp_remove_caches_from_all_fds_opened (this, parent, name);
+        sp_cache_remove_inode_entry (this, parent, name);
 
         STACK_WIND (frame, sp_xattrop_cbk, FIRST_CHILD(this),
                     FIRST_CHILD(this)->fops->fxattrop, fd, flags, dict);
@@ -3943,8 +4103,8 @@ out:
 int32_t
 sp_forget (xlator_t *this, inode_t *inode)
 {
-        struct iatt *buf   = NULL;
-        uint64_t     value = 0;
+        sp_inode_ctx_t *inode_ctx = NULL;
+        uint64_t        value     = 0;
 
         GF_VALIDATE_OR_GOTO ("stat-prefetch", this, out);
         GF_VALIDATE_OR_GOTO (this->name, inode, out);
@@ -3952,8 +4112,8 @@ sp_forget (xlator_t *this, inode_t *inode)
         inode_ctx_del (inode, this, &value);
 
         if (value) {
-                buf = (void *)(long)value;
-                GF_FREE (buf);
+                inode_ctx = (void *)(long)value;
+                sp_inode_ctx_free (this, inode_ctx);
         }
 
 out:
@@ -3967,19 +4127,12 @@ sp_release (xlator_t *this, fd_t *fd)
         sp_fd_ctx_t *fd_ctx = NULL;
         uint64_t     value  = 0;
         int32_t      ret    = 0;
-        sp_cache_t  *cache  = NULL;
 
         GF_VALIDATE_OR_GOTO ("stat-prefetch", this, out);
         GF_VALIDATE_OR_GOTO (this->name, fd, out);
         ret = fd_ctx_del (fd, this, &value);
         if (!ret) {
                 fd_ctx = (void *)(long) value;
-                cache = fd_ctx->cache;
-                if (cache) {
-                        gf_log (this->name, GF_LOG_TRACE, "cache hits: %lu, "
-                                "cache miss: %lu", cache->hits, cache->miss);
-                }
-
                 sp_fd_ctx_free (fd_ctx);
         }
 
@@ -4028,67 +4181,6 @@ out:
 }
 
 
-int32_t
-sp_fdctx_dump (xlator_t *this, fd_t *fd)
-{
-        char            key[GF_DUMP_MAX_BUF_LEN]        = {0, };
-        char            key_prefix[GF_DUMP_MAX_BUF_LEN] = {0, };
-        char            uuidbuf[256]                    = {0, };
-        sp_cache_t     *cache                           = NULL;
-        int32_t         ret                             = -1;
-        sp_cache_dump_t *dump                           = NULL;
-        char            *parent                         = NULL;
-
-        cache = sp_get_cache_fd (this, fd);
-        if (cache == NULL) {
-                ret = 0;
-                goto out;
-        }
-
-        dump = GF_CALLOC(1, sizeof (*dump), gf_common_mt_char);
-        if (dump == NULL) {
-                goto out;
-        }
-
-        gf_proc_dump_build_key (key_prefix,
-                                "xlator.performance.stat-prefetch",
-                                "fdctx");
-        gf_proc_dump_add_section (key_prefix);
-        
-        gf_proc_dump_build_key (key, key_prefix, "fd");
-        gf_proc_dump_write (key, "%p", fd);
-
-        ret = __inode_path (fd->inode, NULL, &parent);
-        if (parent != NULL) {
-                gf_proc_dump_build_key (key, key_prefix, "name");
-                gf_proc_dump_write (key, "%s", parent);
-                GF_FREE (parent);
-        }
-
-        uuid_unparse (fd->inode->gfid, uuidbuf);
-        gf_proc_dump_build_key (key, key_prefix, "fd.inode.gfid");
-        gf_proc_dump_write (key, "%s", uuidbuf);
-
-        gf_proc_dump_build_key (key, key_prefix, "fd.inode.ino");
-        gf_proc_dump_write (key, "%ld", fd->inode->ino);
-
-        gf_proc_dump_build_key (key, key_prefix, "miss");
-        gf_proc_dump_write (key, "%lu", cache->miss);
-
-        gf_proc_dump_build_key (key, key_prefix, "hits");
-        gf_proc_dump_write (key, "%lu", cache->hits);
-
-        gf_proc_dump_build_key (key, key_prefix, "cache"); 
-        dump->key_prefix = key;
-        
-        rbthash_table_traverse (cache->table, sp_cache_traverse, dump);
-
-        GF_FREE (dump);
-        ret = 0;
-out:
-        return ret;
-}
-
 int32_t
 sp_inodectx_dump (xlator_t *this, inode_t *inode)
 {
@@ -4097,6 +4189,8 @@ sp_inodectx_dump (xlator_t *this, inode_t *inode)
         char            uuidbuf[256]                    = {0, };
         sp_inode_ctx_t *inode_ctx                       = NULL;
         call_stub_t    *stub                            = NULL;
+        sp_cache_t     *cache                           = NULL;
+        sp_cache_dump_t dump                            = {0, };
         uint64_t        value                           = 0;
         int32_t         ret                             = -1, i = 0;
 
@@ -4158,8 +4252,32 @@ sp_inodectx_dump (xlator_t *this, inode_t *inode)
  
                         i++;
                 }
+
+                cache = sp_cache_ref (inode_ctx->cache);
         }
         UNLOCK (&inode_ctx->lock);
+
+        if (cache == NULL) {
+                goto out;
+        }
+
+        LOCK (&cache->lock);
+        {
+                gf_proc_dump_build_key (key, key_prefix, "cache.entries");
+                gf_proc_dump_write (key, "%u", cache->entries);
+
+                gf_proc_dump_build_key (key, key_prefix, "cache.size");
+                gf_proc_dump_write (key, "%"PRIu64, cache->size);
+
+                gf_proc_dump_build_key (key, key_prefix, "cache");
+                dump.key_prefix = key;
+
+                rbthash_table_traverse (cache->table, sp_cache_traverse,
+                                        &dump);
+        }
+        UNLOCK (&cache->lock);
+
+        sp_cache_unref (cache);
 out:
         return ret;
 }
@@ -4169,6 +4287,7 @@ sp_priv_dump (xlator_t *this)
 {
         sp_private_t            *priv         = NULL;
         uint32_t                total_entries = 0;
+        uint64_t                size          = 0, hits = 0, misses = 0;
         uint32_t                ret           = -1;
         char                    key[GF_DUMP_MAX_BUF_LEN];
         char                    key_prefix[GF_DUMP_MAX_BUF_LEN];
@@ -4178,16 +4297,34 @@ sp_priv_dump (xlator_t *this)
 
         priv = this->private;
 
-        total_entries = priv->entries;
+        LOCK (&priv->lock);
+        {
+                total_entries = priv->entries;
+                size = priv->size;
+                hits = priv->hits;
+                misses = priv->misses;
+        }
+        UNLOCK (&priv->lock);
 
         gf_proc_dump_build_key (key_prefix, "xlator.performance.stat-prefetch",
                                 "priv");
         gf_proc_dump_add_section (key_prefix);
 
-        gf_proc_dump_build_key (key, key_prefix, "max_allowed_entries");
-        gf_proc_dump_write (key, "%lu", GF_SP_CACHE_ENTRIES_EXPECTED);
+        gf_proc_dump_build_key (key, key_prefix, "cache_size");
+        gf_proc_dump_write (key, "%"PRIu64, priv->cache_size);
+        gf_proc_dump_build_key (key, key_prefix, "cache_used");
+        gf_proc_dump_write (key, "%"PRIu64, size);
+        gf_proc_dump_build_key (key, key_prefix, "cache_timeout");
+        gf_proc_dump_write (key, "%d", priv->cache_timeout);
         gf_proc_dump_build_key (key, key_prefix, "num_entries_cached");
         gf_proc_dump_write (key, "%lu",(unsigned long)total_entries);
+        gf_proc_dump_build_key (key, key_prefix, "hits");
+        gf_proc_dump_write (key, "%"PRIu64, hits);
+        gf_proc_dump_build_key (key, key_prefix, "misses");
+        gf_proc_dump_write (key, "%"PRIu64, misses);
+        gf_proc_dump_build_key (key, key_prefix, "hit_ratio");
+        gf_proc_dump_write (key, "%.3f", (hits + misses)
+                            ? (double)hits / (hits + misses) : 0.0);
         ret = 0;
 
 out:
@@ -4232,10 +4369,56 @@ init (xlator_t *this)
         }
 
         priv = GF_CALLOC (1, sizeof(sp_private_t), gf_sp_mt_sp_private_t);
+        if (priv == NULL) {
+                goto out;
+        }
+
+        GF_OPTION_INIT ("cache-size", priv->cache_size, size, out);
+
+        GF_OPTION_INIT ("cache-timeout", priv->cache_timeout, int32, out);
+
         LOCK_INIT (&priv->lock);
+        INIT_LIST_HEAD (&priv->lru);
 
         this->private = priv;
 
+        ret = 0;
+out:
+        if ((ret == -1) && (priv != NULL)) {
+                GF_FREE (priv);
+        }
+
+        return ret;
+}
+
+
+int
+reconfigure (xlator_t *this, dict_t *options)
+{
+        sp_private_t *priv       = NULL;
+        uint64_t      cache_size = 0;
+        int32_t       timeout    = 0;
+        int           ret        = -1;
+
+        GF_VALIDATE_OR_GOTO ("stat-prefetch", this, out);
+        GF_VALIDATE_OR_GOTO (this->name, this->private, out);
+        GF_VALIDATE_OR_GOTO (this->name, options, out);
+
+        priv = this->private;
+
+        GF_OPTION_RECONF ("cache-size", cache_size, options, size, out);
+
+        GF_OPTION_RECONF ("cache-timeout", timeout, options, int32, out);
+
+        LOCK (&priv->lock);
+        {
+                priv->cache_size = cache_size;
+                priv->cache_timeout = timeout;
+        }
+        UNLOCK (&priv->lock);
+
+        sp_cache_prune (this);
+
         ret = 0;
 out:
         return ret;
@@ -4276,6 +4459,9 @@ struct xlator_fops fops = {
         .link        = sp_link,
         .truncate    = sp_truncate,
         .ftruncate   = sp_ftruncate,
+        .fallocate   = sp_fallocate,
+        .discard     = sp_discard,
+        .zerofill    = sp_zerofill,
         .readlink    = sp_readlink,
         .unlink      = sp_unlink,
         .rmdir       = sp_rmdir,
@@ -4304,5 +4490,27 @@ struct xlator_cbks cbks = {
 struct xlator_dumpops dumpops = {
         .priv = sp_priv_dump,
         .inodectx = sp_inodectx_dump,
-        .fdctx = sp_fdctx_dump
+};
+
+struct volume_options options[] = {
+        { .key  = {"cache-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min  = 0,
+          .max  = 1 * GF_UNIT_GB,
+          .default_value = "32MB",
+          .description = "Memory the directory entries prefetched by "
+                         "readdirp may take, over all directories. The "
+                         "least recently used directories are dropped "
+                         "first."
+        },
+        { .key  = {"cache-timeout"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 60,
+          .default_value = "1",
+          .description = "Seconds a directory's prefetched entries answer "
+                         "lookups. Changes made by other clients are seen "
+                         "after at most this long."
+        },
+        { .key  = {NULL} },
 };
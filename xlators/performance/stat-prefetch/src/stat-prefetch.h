@@ -36,21 +36,27 @@
 #include "stat-prefetch-mem-types.h"
 #include <libgen.h>
 
+/* dirents of one directory, as readdirp returned them. It hangs off the
+ * directory's inode ctx, so lookups of its names hit it whichever fd (if
+ * any) the listing was done on.
+ */
 struct sp_cache {
-        rbthash_table_t *table;
-        xlator_t        *this;
-        uint64_t         expected_offset;    /* Offset where the next read will
-                                              * happen.
-                                              */
-        gf_lock_t        lock;
-        unsigned long    miss;
-        unsigned long    hits;
-        uint32_t         ref;
+        rbthash_table_t  *table;
+        xlator_t         *this;
+        inode_t          *inode;            /* not ref'd, the cache goes
+                                             * away in its forget */
+        struct list_head  lru;              /* in priv->lru, empty while the
+                                             * cache holds no entries */
+        struct timeval    tv;               /* when the first of the current
+                                             * entries was added */
+        uint64_t          size;             /* bytes, for cache-size */
+        uint32_t          entries;
+        gf_lock_t         lock;
+        uint32_t          ref;
 };
 typedef struct sp_cache sp_cache_t;
 
 struct sp_fd_ctx {
-        sp_cache_t *cache;
         inode_t    *parent_inode;       /*
                                          * inode corresponding to dirname (path)
                                          */
@@ -77,18 +83,29 @@ struct sp_inode_ctx {
         struct iatt      stbuf;
         gf_lock_t        lock;
         struct list_head waiting_ops;
+        sp_cache_t      *cache;         /* set on directories once listed */
 };
 typedef struct sp_inode_ctx sp_inode_ctx_t;
 
+/* lock order: priv->lock, then a cache's lock */
 struct sp_private {
         struct mem_pool  *mem_pool;
-        uint32_t         entries;
-        gf_lock_t        lock;
+        uint32_t          entries;
+        uint64_t          size;          /* bytes held by all caches */
+        uint64_t          cache_size;    /* what they may hold */
+        int32_t           cache_timeout;
+        struct list_head  lru;           /* caches, least recently used
+                                          * first */
+        uint64_t          hits;
+        uint64_t          misses;
+        gf_lock_t         lock;
 };
 typedef struct sp_private sp_private_t;
 
 void sp_local_free (sp_local_t *local);
 
+void sp_cache_free (sp_cache_t *cache);
+
 #define SP_STACK_UNWIND(op, frame, params ...) do {             \
                 sp_local_t *__local = frame->local;             \
                 frame->local = NULL;                            \
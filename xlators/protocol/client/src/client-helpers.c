@@ -207,6 +207,26 @@ clnt_readdirp_rsp_cleanup (gfs3_readdirp_rsp *rsp)
         return 0;
 }
 
+int
+clnt_compound_rsp_cleanup (gfs3_compound_rsp *rsp)
+{
+        gfs3_compound_op_rsp *prev = NULL;
+        gfs3_compound_op_rsp *trav = NULL;
+
+        trav = rsp->rsps;
+        prev = trav;
+        while (trav) {
+                trav = trav->nextrsp;
+                /* on client, the rpc lib allocates this */
+                if (prev->dict.dict_val)
+                        free (prev->dict.dict_val);
+                free (prev);
+                prev = trav;
+        }
+
+        return 0;
+}
+
 int
 clnt_readdir_rsp_cleanup (gfs3_readdir_rsp *rsp)
 {
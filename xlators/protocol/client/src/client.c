@@ -365,6 +365,141 @@ out:
 
 
 
+int32_t
+client_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  int32_t keep_size, off_t offset, size_t len)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.fd     = fd;
+        args.flags  = keep_size;
+        args.offset = offset;
+        args.size   = len;
+
+        proc = &conf->fops->proctable[GF_FOP_FALLOCATE];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_FALLOCATE]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (fallocate, frame, -1, ENOTCONN, NULL, NULL);
+
+	return 0;
+}
+
+
+int32_t
+client_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                off_t offset, size_t len)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.fd     = fd;
+        args.offset = offset;
+        args.size   = len;
+
+        proc = &conf->fops->proctable[GF_FOP_DISCARD];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_DISCARD]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (discard, frame, -1, ENOTCONN, NULL, NULL);
+
+	return 0;
+}
+
+
+int32_t
+client_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                 int32_t keep_size, off_t offset, size_t len)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.fd     = fd;
+        args.flags  = keep_size;
+        args.offset = offset;
+        args.size   = len;
+
+        proc = &conf->fops->proctable[GF_FOP_ZEROFILL];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_ZEROFILL]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (zerofill, frame, -1, ENOTCONN, NULL, NULL);
+
+	return 0;
+}
+
+
+int32_t
+client_compound (call_frame_t *frame, xlator_t *this, compound_args_t *args)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  cargs = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        cargs.compound = args;
+
+        proc = &conf->fops->proctable[GF_FOP_COMPOUND];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_COMPOUND]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &cargs);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (compound, frame, -1, ENOTCONN, args);
+
+	return 0;
+}
+
+
 int32_t
 client_access (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t mask)
 {
@@ -2256,6 +2391,44 @@ client_priv_dump (xlator_t *this)
                 gf_proc_dump_build_key(key, key_prefix, "total_bytes_written");
                 gf_proc_dump_write(key, "%"PRIu64,
                                    conf->rpc->conn.trans->total_bytes_write);
+
+                gf_proc_dump_build_key(key, key_prefix, "total_read_calls");
+                gf_proc_dump_write(key, "%"PRIu64,
+                                   conf->rpc->conn.trans->total_read_calls);
+
+                gf_proc_dump_build_key(key, key_prefix, "total_msgs_read");
+                gf_proc_dump_write(key, "%"PRIu64,
+                                   conf->rpc->conn.trans->total_msgs_read);
+
+                if (conf->rpc->conn.trans->total_msgs_read) {
+                        gf_proc_dump_build_key(key, key_prefix,
+                                               "read_calls_per_msg");
+                        gf_proc_dump_write(key, "%.2f", (double)
+                                           conf->rpc->conn.trans->total_read_calls /
+                                           conf->rpc->conn.trans->total_msgs_read);
+                }
+
+                gf_proc_dump_build_key(key, key_prefix, "total_write_calls");
+                gf_proc_dump_write(key, "%"PRIu64,
+                                   conf->rpc->conn.trans->total_write_calls);
+
+                gf_proc_dump_build_key(key, key_prefix, "total_msgs_written");
+                gf_proc_dump_write(key, "%"PRIu64,
+                                   conf->rpc->conn.trans->total_msgs_written);
+
+                if (conf->rpc->conn.trans->total_write_calls) {
+                        gf_proc_dump_build_key(key, key_prefix,
+                                               "bytes_per_write_call");
+                        gf_proc_dump_write(key, "%.2f", (double)
+                                           conf->rpc->conn.trans->total_bytes_write /
+                                           conf->rpc->conn.trans->total_write_calls);
+
+                        gf_proc_dump_build_key(key, key_prefix,
+                                               "msgs_per_write_call");
+                        gf_proc_dump_write(key, "%.2f", (double)
+                                           conf->rpc->conn.trans->total_msgs_written /
+                                           conf->rpc->conn.trans->total_write_calls);
+                }
         }
         pthread_mutex_unlock(&conf->lock);
 
@@ -2341,6 +2514,10 @@ struct xlator_fops fops = {
         .setattr     = client_setattr,
         .fsetattr    = client_fsetattr,
         .getspec     = client_getspec,
+        .fallocate   = client_fallocate,
+        .discard     = client_discard,
+        .zerofill    = client_zerofill,
+        .compound    = client_compound,
 };
 
 
@@ -1150,6 +1150,248 @@ out:
         return 0;
 }
 
+int
+client3_1_fallocate_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                         void *myframe)
+{
+        gfs3_fallocate_rsp rsp = {0,};
+        call_frame_t   *frame = NULL;
+        struct iatt  prestat  = {0,};
+        struct iatt  poststat = {0,};
+        int ret = 0;
+        xlator_t         *this       = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_fallocate_rsp (*iov, &rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        if (-1 != rsp.op_ret) {
+                gf_stat_to_iatt (&rsp.statpre, &prestat);
+                gf_stat_to_iatt (&rsp.statpost, &poststat);
+        }
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_INFO, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        STACK_UNWIND_STRICT (fallocate, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), &prestat,
+                             &poststat);
+
+        return 0;
+}
+
+int
+client3_1_discard_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                       void *myframe)
+{
+        gfs3_discard_rsp rsp = {0,};
+        call_frame_t   *frame = NULL;
+        struct iatt  prestat  = {0,};
+        struct iatt  poststat = {0,};
+        int ret = 0;
+        xlator_t         *this       = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_discard_rsp (*iov, &rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        if (-1 != rsp.op_ret) {
+                gf_stat_to_iatt (&rsp.statpre, &prestat);
+                gf_stat_to_iatt (&rsp.statpost, &poststat);
+        }
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_INFO, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        STACK_UNWIND_STRICT (discard, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), &prestat,
+                             &poststat);
+
+        return 0;
+}
+
+int
+client3_1_zerofill_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                        void *myframe)
+{
+        gfs3_zerofill_rsp rsp = {0,};
+        call_frame_t   *frame = NULL;
+        struct iatt  prestat  = {0,};
+        struct iatt  poststat = {0,};
+        int ret = 0;
+        xlator_t         *this       = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_zerofill_rsp (*iov, &rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        if (-1 != rsp.op_ret) {
+                gf_stat_to_iatt (&rsp.statpre, &prestat);
+                gf_stat_to_iatt (&rsp.statpost, &poststat);
+        }
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_INFO, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        STACK_UNWIND_STRICT (zerofill, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), &prestat,
+                             &poststat);
+
+        return 0;
+}
+
+int
+client3_1_compound_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                        void *myframe)
+{
+        gfs3_compound_rsp     rsp      = {0,};
+        gfs3_compound_op_rsp *trav     = NULL;
+        call_frame_t         *frame    = NULL;
+        clnt_local_t         *local    = NULL;
+        compound_args_t      *args     = NULL;
+        compound_rsp_t       *crsp     = NULL;
+        dict_t               *dict     = NULL;
+        char                 *buf      = NULL;
+        int                   i        = 0;
+        int                   ret      = 0;
+        xlator_t             *this     = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+        local = frame->local;
+        frame->local = NULL;
+        args  = local->compound;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+
+        ret = xdr_to_compound_rsp (*iov, &rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        /* the server answers every op, even those it skipped */
+        for (trav = rsp.rsps; trav && (i < args->count);
+             trav = trav->nextrsp, i++) {
+                crsp = &args->rsp[i];
+                crsp->op_ret   = trav->op_ret;
+                crsp->op_errno = gf_error_to_errno (trav->op_errno);
+
+                if (trav->op_ret == -1)
+                        continue;
+
+                gf_stat_to_iatt (&trav->stat, &crsp->stat);
+
+                if (!trav->dict.dict_len)
+                        continue;
+
+                dict = dict_new ();
+                buf  = memdup (trav->dict.dict_val, trav->dict.dict_len);
+                if (!dict || !buf) {
+                        crsp->op_ret   = -1;
+                        crsp->op_errno = ENOMEM;
+                        goto next;
+                }
+
+                ret = dict_unserialize (buf, trav->dict.dict_len, &dict);
+                if (ret < 0) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "failed to unserialize xattr dict of op %d "
+                                "(%s)", i, gf_fop_list[args->ops[i].fop]);
+                        crsp->op_ret   = -1;
+                        crsp->op_errno = EINVAL;
+                        goto next;
+                }
+                dict->extra_free = buf;
+                buf = NULL;
+
+                crsp->dict = dict;
+                dict = NULL;
+        next:
+                if (buf) {
+                        GF_FREE (buf);
+                        buf = NULL;
+                }
+                if (dict) {
+                        dict_unref (dict);
+                        dict = NULL;
+                }
+        }
+
+        if (i < args->count) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "compound reply has %d results for %d ops",
+                        i, args->count);
+                rsp.op_ret   = -1;
+                rsp.op_errno = EPROTO;
+        }
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_INFO, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        STACK_UNWIND_STRICT (compound, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), args);
+
+        clnt_compound_rsp_cleanup (&rsp);
+
+        client_local_wipe (local);
+        return 0;
+}
+
 int
 client3_1_fstat_cbk (struct rpc_req *req, struct iovec *iov, int count,
                      void *myframe)
@@ -2579,7 +2821,8 @@ client3_1_lookup (call_frame_t *frame, xlator_t *this,
         }
 
         req.path          = (char *)args->loc->path;
-        req.bname         = (char *)args->loc->name;
+        /* a nameless lookup (gfid only) carries no basename */
+        req.bname         = (char *)(args->loc->name ? args->loc->name : "");
         req.dict.dict_len = dict_len;
 
         ret = client_submit_request (this, &req, frame, conf->fops,
@@ -2777,6 +3020,480 @@ unwind:
 
 
 
+int32_t
+client3_1_fallocate (call_frame_t *frame, xlator_t *this,
+                     void *data)
+{
+        clnt_args_t        *args     = NULL;
+        clnt_fd_ctx_t      *fdctx    = NULL;
+        clnt_conf_t        *conf     = NULL;
+        gfs3_fallocate_req  req      = {{0,},};
+        int                 op_errno = EINVAL;
+        int                 ret      = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+
+        conf = this->private;
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                fdctx = this_fd_get_ctx (args->fd, this);
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        if (fdctx == NULL) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "(%"PRId64"): failed to get fd ctx. EBADFD",
+                        args->fd->inode->ino);
+                op_errno = EBADFD;
+                goto unwind;
+        }
+
+        if (fdctx->remote_fd == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "(%"PRId64"): failed to get"
+                        " fd ctx. EBADFD", args->fd->inode->ino);
+                op_errno = EBADFD;
+                goto unwind;
+        }
+
+        req.fd     = fdctx->remote_fd;
+        req.flags  = args->flags;
+        req.offset = args->offset;
+        req.size   = args->size;
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_FALLOCATE,
+                                     client3_1_fallocate_cbk, NULL,
+                                     xdr_from_fallocate_req, NULL, 0, NULL, 0,
+                                     NULL);
+        if (ret) {
+                op_errno = ENOTCONN;
+                goto unwind;
+        }
+        return 0;
+unwind:
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
+        STACK_UNWIND_STRICT (fallocate, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+int32_t
+client3_1_discard (call_frame_t *frame, xlator_t *this,
+                   void *data)
+{
+        clnt_args_t        *args     = NULL;
+        clnt_fd_ctx_t      *fdctx    = NULL;
+        clnt_conf_t        *conf     = NULL;
+        gfs3_discard_req    req      = {{0,},};
+        int                 op_errno = EINVAL;
+        int                 ret      = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+
+        conf = this->private;
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                fdctx = this_fd_get_ctx (args->fd, this);
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        if (fdctx == NULL) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "(%"PRId64"): failed to get fd ctx. EBADFD",
+                        args->fd->inode->ino);
+                op_errno = EBADFD;
+                goto unwind;
+        }
+
+        if (fdctx->remote_fd == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "(%"PRId64"): failed to get"
+                        " fd ctx. EBADFD", args->fd->inode->ino);
+                op_errno = EBADFD;
+                goto unwind;
+        }
+
+        req.fd     = fdctx->remote_fd;
+        req.offset = args->offset;
+        req.size   = args->size;
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_DISCARD,
+                                     client3_1_discard_cbk, NULL,
+                                     xdr_from_discard_req, NULL, 0, NULL, 0,
+                                     NULL);
+        if (ret) {
+                op_errno = ENOTCONN;
+                goto unwind;
+        }
+        return 0;
+unwind:
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
+        STACK_UNWIND_STRICT (discard, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+int32_t
+client3_1_zerofill (call_frame_t *frame, xlator_t *this,
+                    void *data)
+{
+        clnt_args_t        *args     = NULL;
+        clnt_fd_ctx_t      *fdctx    = NULL;
+        clnt_conf_t        *conf     = NULL;
+        gfs3_zerofill_req   req      = {{0,},};
+        int                 op_errno = EINVAL;
+        int                 ret      = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+
+        conf = this->private;
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                fdctx = this_fd_get_ctx (args->fd, this);
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        if (fdctx == NULL) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "(%"PRId64"): failed to get fd ctx. EBADFD",
+                        args->fd->inode->ino);
+                op_errno = EBADFD;
+                goto unwind;
+        }
+
+        if (fdctx->remote_fd == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "(%"PRId64"): failed to get"
+                        " fd ctx. EBADFD", args->fd->inode->ino);
+                op_errno = EBADFD;
+                goto unwind;
+        }
+
+        req.fd     = fdctx->remote_fd;
+        req.flags  = args->flags;
+        req.offset = args->offset;
+        req.size   = args->size;
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_ZEROFILL,
+                                     client3_1_zerofill_cbk, NULL,
+                                     xdr_from_zerofill_req, NULL, 0, NULL, 0,
+                                     NULL);
+        if (ret) {
+                op_errno = ENOTCONN;
+                goto unwind;
+        }
+        return 0;
+unwind:
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
+        STACK_UNWIND_STRICT (zerofill, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
+static int
+client3_1_compound_op_fd (xlator_t *this, compound_op_t *op,
+                          gfs3_compound_op *req)
+{
+        clnt_conf_t     *conf  = NULL;
+        clnt_fd_ctx_t   *fdctx = NULL;
+
+        conf = this->private;
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                fdctx = this_fd_get_ctx (op->fd, this);
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        if ((fdctx == NULL) || (fdctx->remote_fd == -1)) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "(%"PRId64"): failed to get fd ctx. EBADFD",
+                        op->fd->inode->ino);
+                return -1;
+        }
+
+        req->fd = fdctx->remote_fd;
+        memcpy (req->gfid, op->fd->inode->gfid, 16);
+
+        return 0;
+}
+
+
+/* Translates one op of the compound into its wire form, the dict it
+ * serializes is freed by the caller.
+ */
+static int
+client3_1_compound_op_build (xlator_t *this, compound_op_t *op,
+                             gfs3_compound_op *req)
+{
+        size_t  dict_len = 0;
+        int32_t gf_cmd   = 0;
+        int32_t gf_type  = 0;
+        int     fd_op    = 0;
+        int     op_errno = EINVAL;
+        int     ret      = 0;
+
+        req->cflags = op->cflags;
+        req->path   = "";
+        req->bname  = "";
+        req->name   = "";
+        req->volume = "";
+        req->fd     = -1;
+
+        switch (op->fop) {
+        case GF_FOP_STAT:
+                req->op = GFS3_OP_STAT;
+                break;
+        case GF_FOP_FSTAT:
+                req->op = GFS3_OP_FSTAT;
+                fd_op = 1;
+                break;
+        case GF_FOP_SETXATTR:
+                req->op = GFS3_OP_SETXATTR;
+                req->flags = op->flags;
+                break;
+        case GF_FOP_FSETXATTR:
+                req->op = GFS3_OP_FSETXATTR;
+                req->flags = op->flags;
+                fd_op = 1;
+                break;
+        case GF_FOP_GETXATTR:
+                req->op = GFS3_OP_GETXATTR;
+                break;
+        case GF_FOP_FGETXATTR:
+                req->op = GFS3_OP_FGETXATTR;
+                fd_op = 1;
+                break;
+        case GF_FOP_XATTROP:
+                req->op = GFS3_OP_XATTROP;
+                req->flags = op->optype;
+                break;
+        case GF_FOP_FXATTROP:
+                req->op = GFS3_OP_FXATTROP;
+                req->flags = op->optype;
+                fd_op = 1;
+                break;
+        case GF_FOP_INODELK:
+                req->op = GFS3_OP_INODELK;
+                break;
+        case GF_FOP_FINODELK:
+                req->op = GFS3_OP_FINODELK;
+                fd_op = 1;
+                break;
+        case GF_FOP_ENTRYLK:
+                req->op = GFS3_OP_ENTRYLK;
+                break;
+        case GF_FOP_FENTRYLK:
+                req->op = GFS3_OP_FENTRYLK;
+                fd_op = 1;
+                break;
+        default:
+                gf_log (this->name, GF_LOG_WARNING,
+                        "%s cannot be part of a compound",
+                        gf_fop_list[op->fop]);
+                goto out;
+        }
+
+        if (fd_op) {
+                if (client3_1_compound_op_fd (this, op, req)) {
+                        op_errno = EBADFD;
+                        goto out;
+                }
+        } else {
+                if (!op->loc.inode) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "%s: no inode in the compound's %s",
+                                op->loc.path, gf_fop_list[op->fop]);
+                        goto out;
+                }
+                memcpy (req->gfid, op->loc.inode->gfid, 16);
+                if (op->loc.path)
+                        req->path = (char *)op->loc.path;
+        }
+
+        if (op->name)
+                req->name = op->name;
+        if (op->volume)
+                req->volume = op->volume;
+        if (op->basename)
+                req->bname = op->basename;
+
+        if ((op->fop == GF_FOP_INODELK) || (op->fop == GF_FOP_FINODELK)) {
+                if (op->cmd == F_GETLK || op->cmd == F_GETLK64)
+                        gf_cmd = GF_LK_GETLK;
+                else if (op->cmd == F_SETLK || op->cmd == F_SETLK64)
+                        gf_cmd = GF_LK_SETLK;
+                else if (op->cmd == F_SETLKW || op->cmd == F_SETLKW64)
+                        gf_cmd = GF_LK_SETLKW;
+                else {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "Unknown cmd (%d)!", op->cmd);
+                        goto out;
+                }
+
+                switch (op->flock.l_type) {
+                case F_RDLCK:
+                        gf_type = GF_LK_F_RDLCK;
+                        break;
+                case F_WRLCK:
+                        gf_type = GF_LK_F_WRLCK;
+                        break;
+                case F_UNLCK:
+                        gf_type = GF_LK_F_UNLCK;
+                        break;
+                }
+
+                req->cmd  = gf_cmd;
+                req->type = gf_type;
+                gf_proto_flock_from_flock (&req->flock, &op->flock);
+        }
+
+        if ((op->fop == GF_FOP_ENTRYLK) || (op->fop == GF_FOP_FENTRYLK)) {
+                req->cmd  = op->entrylk_cmd;
+                req->type = op->entrylk_type;
+        }
+
+        if (op->dict) {
+                ret = dict_allocate_and_serialize (op->dict,
+                                                   &req->dict.dict_val,
+                                                   &dict_len);
+                if (ret < 0) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "failed to get serialized dict");
+                        goto out;
+                }
+                req->dict.dict_len = dict_len;
+        }
+
+        op_errno = 0;
+out:
+        return op_errno;
+}
+
+
+int32_t
+client3_1_compound (call_frame_t *frame, xlator_t *this,
+                    void *data)
+{
+        clnt_args_t       *args       = NULL;
+        clnt_conf_t       *conf       = NULL;
+        compound_args_t   *cargs      = NULL;
+        gfs3_compound_req  req        = {0,};
+        gfs3_compound_op   ops[GF_COMPOUND_MAX_OPS];
+        int                op_errno   = EINVAL;
+        int                ret        = 0;
+        int                i          = 0;
+        int                count      = 0;
+        clnt_local_t      *local      = NULL;
+        struct iobref     *rsp_iobref = NULL;
+        struct iobuf      *rsp_iobuf  = NULL;
+        struct iovec      *rsphdr     = NULL;
+        struct iovec       vector[MAX_IOVEC] = {{0}, };
+
+        memset (ops, 0, sizeof (ops));
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args  = data;
+        conf  = this->private;
+        cargs = args->compound;
+
+        if (!cargs || (cargs->count <= 0) ||
+            (cargs->count > GF_COMPOUND_MAX_OPS))
+                goto unwind;
+
+        for (i = 0; i < cargs->count; i++) {
+                op_errno = client3_1_compound_op_build (this, &cargs->ops[i],
+                                                        &ops[i]);
+                if (op_errno)
+                        goto unwind;
+                if (i)
+                        ops[i - 1].nextop = &ops[i];
+        }
+        req.ops = &ops[0];
+
+        local = GF_CALLOC (1, sizeof (*local),
+                           gf_client_mt_clnt_local_t);
+        if (!local) {
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+        local->compound = cargs;
+        frame->local = local;
+
+        /* the replies of xattrops and getxattrs can be large */
+        rsp_iobref = iobref_new ();
+        if (rsp_iobref == NULL) {
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+
+        rsp_iobuf = iobuf_get (this->ctx->iobuf_pool);
+        if (rsp_iobuf == NULL) {
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+
+        iobref_add (rsp_iobref, rsp_iobuf);
+        iobuf_unref (rsp_iobuf);
+        rsphdr = &vector[0];
+        rsphdr->iov_base = iobuf_ptr (rsp_iobuf);
+        rsphdr->iov_len = iobuf_pagesize (rsp_iobuf);
+        count = 1;
+        rsp_iobuf = NULL;
+        local->iobref = rsp_iobref;
+        rsp_iobref = NULL;
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_COMPOUND,
+                                     client3_1_compound_cbk, NULL,
+                                     xdr_from_compound_req, rsphdr, count,
+                                     NULL, 0, local->iobref);
+        if (ret) {
+                op_errno = ENOTCONN;
+                goto unwind;
+        }
+
+        for (i = 0; i < GF_COMPOUND_MAX_OPS; i++) {
+                if (ops[i].dict.dict_val)
+                        GF_FREE (ops[i].dict.dict_val);
+        }
+
+        return 0;
+unwind:
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
+        local = frame->local;
+        frame->local = NULL;
+
+        STACK_UNWIND_STRICT (compound, frame, -1, op_errno, cargs);
+
+        for (i = 0; i < GF_COMPOUND_MAX_OPS; i++) {
+                if (ops[i].dict.dict_val)
+                        GF_FREE (ops[i].dict.dict_val);
+        }
+
+        client_local_wipe (local);
+
+        if (rsp_iobref)
+                iobref_unref (rsp_iobref);
+
+        return 0;
+}
+
+
 int32_t
 client3_1_access (call_frame_t *frame, xlator_t *this,
                   void *data)
@@ -5486,6 +6203,10 @@ rpc_clnt_procedure_t clnt3_1_fop_actors[GF_FOP_MAXVALUE] = {
         [GF_FOP_RELEASE]     = { "RELEASE",     client3_1_release },
         [GF_FOP_RELEASEDIR]  = { "RELEASEDIR",  client3_1_releasedir },
         [GF_FOP_GETSPEC]     = { "GETSPEC",     client3_getspec },
+        [GF_FOP_FALLOCATE]   = { "FALLOCATE",   client3_1_fallocate },
+        [GF_FOP_DISCARD]     = { "DISCARD",     client3_1_discard },
+        [GF_FOP_ZEROFILL]    = { "ZEROFILL",    client3_1_zerofill },
+        [GF_FOP_COMPOUND]    = { "COMPOUND",    client3_1_compound },
 };
 
 /* Used From RPC-CLNT library to log proper name of procedure based on number */
@@ -5533,6 +6254,10 @@ char *clnt3_1_fop_names[GFS3_OP_MAXVALUE] = {
         [GFS3_OP_READDIRP]    = "READDIRP",
         [GFS3_OP_RELEASE]     = "RELEASE",
         [GFS3_OP_RELEASEDIR]  = "RELEASEDIR",
+        [GFS3_OP_FALLOCATE]   = "FALLOCATE",
+        [GFS3_OP_DISCARD]     = "DISCARD",
+        [GFS3_OP_ZEROFILL]    = "ZEROFILL",
+        [GFS3_OP_COMPOUND]    = "COMPOUND",
 };
 
 rpc_clnt_prog_t clnt3_1_fop_prog = {
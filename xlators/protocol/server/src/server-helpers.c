@@ -94,6 +94,22 @@ server_resolve_wipe (server_resolve_t *resolve)
 }
 
 
+void
+server_compound_wipe (server_compound_t *compound)
+{
+        int i = 0;
+
+        for (i = 0; i < compound->count; i++) {
+                if (compound->rsps[i].dict.dict_val)
+                        GF_FREE (compound->rsps[i].dict.dict_val);
+        }
+
+        xdr_free ((xdrproc_t)xdr_gfs3_compound_req, (char *)&compound->req);
+
+        GF_FREE (compound);
+}
+
+
 void
 free_state (server_state_t *state)
 {
@@ -143,6 +159,9 @@ free_state (server_state_t *state)
         server_resolve_wipe (&state->resolve);
         server_resolve_wipe (&state->resolve2);
 
+        if (state->compound)
+                server_compound_wipe (state->compound);
+
         GF_FREE (state);
 }
 
@@ -35,6 +35,29 @@ resolve_inode_simple (call_frame_t *frame);
 int
 resolve_path_simple (call_frame_t *frame);
 
+/* fill @gfid from the "<gfid:X>" anchor of @path, see inode_path() */
+int
+resolve_gfid_anchor (const char *path, uuid_t gfid)
+{
+        char   uuid_str[40];
+        size_t len = 0;
+
+        len = strlen (INODE_GFID_PATH_PREFIX);
+
+        if (!path || strncmp (path, INODE_GFID_PATH_PREFIX, len))
+                return -1;
+
+        if ((strlen (path) < INODE_GFID_PATH_LEN) ||
+            (path[INODE_GFID_PATH_LEN - 1] != '>'))
+                return -1;
+
+        memcpy (uuid_str, path + len, 36);
+        uuid_str[36] = '\0';
+
+        return uuid_parse (uuid_str, gfid);
+}
+
+
 int
 component_count (const char *path)
 {
@@ -80,6 +103,14 @@ prepare_components (call_frame_t *frame)
         components[0].gen      = 0;
         components[0].inode    = state->itable->root;
 
+        if (!resolve_gfid_anchor (resolve->path, resolve->anchor)) {
+                /* "<gfid:X>/a/b" walks from X instead of the root,
+                   looked up by gfid alone if not yet in the table */
+                components[0].ino   = 0;
+                components[0].inode = inode_find (state->itable,
+                                                  resolve->anchor);
+        }
+
         i = 1;
         for (trav = resolved; *trav; trav++) {
                 if (*trav == '/') {
@@ -209,6 +240,13 @@ resolve_deep_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 inode_lookup (link_inode);
                 components[i].inode  = link_inode;
                 link_inode = NULL;
+        } else if (!components[0].inode) {
+                /* gfid anchor found by a nameless lookup */
+                link_inode = inode_link (inode, NULL, NULL, buf);
+                if (link_inode)
+                        inode_lookup (link_inode);
+                components[0].inode = link_inode;
+                link_inode = NULL;
         }
 
         loc_wipe (&resolve->deep_loc);
@@ -257,10 +295,23 @@ resolve_path_deep (call_frame_t *frame)
 
         prepare_components (frame);
 
-        /* start from the root */
-        resolve->deep_loc.inode = state->itable->root;
-        resolve->deep_loc.path  = gf_strdup ("/");
-        resolve->deep_loc.name  = "";
+        if (resolve->components && !resolve->components[0].ino) {
+                /* start from the gfid anchor, prepare_components() left
+                   it alone in resolve->resolved */
+                if (resolve->components[0].inode)
+                        resolve->deep_loc.inode =
+                                inode_ref (resolve->components[0].inode);
+                else
+                        resolve->deep_loc.inode = inode_new (state->itable);
+                resolve->deep_loc.path  = gf_strdup (resolve->resolved);
+                resolve->deep_loc.name  = NULL;
+                uuid_copy (resolve->deep_loc.gfid, resolve->anchor);
+        } else {
+                /* start from the root */
+                resolve->deep_loc.inode = state->itable->root;
+                resolve->deep_loc.path  = gf_strdup ("/");
+                resolve->deep_loc.name  = "";
+        }
 
         if (frame && frame->root->state && BOUND_XL (frame)) {
                 STACK_WIND_COOKIE (frame, resolve_deep_cbk, (void *) (long) i,
@@ -492,14 +543,31 @@ int
 server_resolve_inode (call_frame_t *frame)
 {
         server_state_t     *state = NULL;
+        server_resolve_t   *resolve = NULL;
         int                 ret = 0;
         loc_t              *loc = NULL;
 
         state = CALL_STATE (frame);
         loc  = state->loc_now;
+        resolve = state->resolve_now;
 
         ret = resolve_inode_simple (frame);
 
+        if ((ret > 0) && (frame->root->op == GF_FOP_LOOKUP) &&
+            !resolve_gfid_anchor (resolve->path, resolve->anchor) &&
+            !uuid_compare (resolve->anchor, resolve->gfid)) {
+                /* nameless lookup of an inode not in the table: the
+                   lookup itself does the resolution */
+                loc_wipe (loc);
+                loc->path = gf_strdup (resolve->path);
+                uuid_copy (loc->gfid, resolve->gfid);
+                resolve->op_ret   = 0;
+                resolve->op_errno = 0;
+
+                server_resolve_all (frame);
+                return 0;
+        }
+
         if (ret > 0) {
                 loc_wipe (loc);
                 resolve_path_deep (frame);
@@ -236,6 +236,10 @@ server_priv (xlator_t *this)
         char              key[GF_DUMP_MAX_BUF_LEN] = {0,};
         uint64_t          total_read = 0;
         uint64_t          total_write = 0;
+        uint64_t          total_read_calls = 0;
+        uint64_t          total_msgs_read = 0;
+        uint64_t          total_write_calls = 0;
+        uint64_t          total_msgs_written = 0;
         int32_t           ret  = -1;
 
         GF_VALIDATE_OR_GOTO ("server", this, out);
@@ -247,6 +251,10 @@ server_priv (xlator_t *this)
         list_for_each_entry (xprt, &conf->xprt_list, list) {
                 total_read  += xprt->total_bytes_read;
                 total_write += xprt->total_bytes_write;
+                total_read_calls += xprt->total_read_calls;
+                total_msgs_read  += xprt->total_msgs_read;
+                total_write_calls += xprt->total_write_calls;
+                total_msgs_written += xprt->total_msgs_written;
         }
 
         gf_proc_dump_build_key(key, "server", "total-bytes-read");
@@ -255,6 +263,36 @@ server_priv (xlator_t *this)
         gf_proc_dump_build_key(key, "server", "total-bytes-write");
         gf_proc_dump_write(key, "%"PRIu64, total_write);
 
+        gf_proc_dump_build_key(key, "server", "total-read-calls");
+        gf_proc_dump_write(key, "%"PRIu64, total_read_calls);
+
+        gf_proc_dump_build_key(key, "server", "total-msgs-read");
+        gf_proc_dump_write(key, "%"PRIu64, total_msgs_read);
+
+        if (total_msgs_read) {
+                gf_proc_dump_build_key(key, "server", "read-calls-per-msg");
+                gf_proc_dump_write(key, "%.2f", (double)total_read_calls /
+                                   total_msgs_read);
+        }
+
+        gf_proc_dump_build_key(key, "server", "total-write-calls");
+        gf_proc_dump_write(key, "%"PRIu64, total_write_calls);
+
+        gf_proc_dump_build_key(key, "server", "total-msgs-written");
+        gf_proc_dump_write(key, "%"PRIu64, total_msgs_written);
+
+        if (total_write_calls) {
+                gf_proc_dump_build_key(key, "server", "bytes-per-write-call");
+                gf_proc_dump_write(key, "%.2f", (double)total_write /
+                                   total_write_calls);
+
+                gf_proc_dump_build_key(key, "server", "msgs-per-write-call");
+                gf_proc_dump_write(key, "%.2f", (double)total_msgs_written /
+                                   total_write_calls);
+        }
+
+        rpcsvc_fq_priv_dump (conf->rpc);
+
         ret = 0;
 out:
         return ret;
@@ -28,6 +28,7 @@
 #include "protocol-common.h"
 #include "server-mem-types.h"
 #include "glusterfs3.h"
+#include "compound-fop.h"
 
 #define DEFAULT_BLOCK_SIZE         4194304   /* 4MB */
 #define DEFAULT_VOLUME_FILE_PATH   CONFDIR "/glusterfs.vol"
@@ -130,6 +131,8 @@ typedef struct {
         char                  *path;
         char                  *bname;
         char                  *resolved;
+        uuid_t                 anchor;   /* gfid a "<gfid:X>/.." path
+                                            starts from */
         int                    op_ret;
         int                    op_errno;
         loc_t                  deep_loc;
@@ -140,6 +143,19 @@ typedef struct {
 
 typedef int (*server_resume_fn_t) (call_frame_t *frame, xlator_t *bound_xl);
 
+/* a compound request, its ops are resolved and run one after the other
+ * on the same frame and answered in a single reply
+ */
+typedef struct {
+        gfs3_compound_req     req;
+        gfs3_compound_op     *ops[GF_COMPOUND_MAX_OPS];
+        gfs3_compound_op_rsp  rsps[GF_COMPOUND_MAX_OPS];
+        int                   count;
+        int                   index;      /* op being run */
+        int                   failed;
+        int                   op_errno;   /* of the first op which failed */
+} server_compound_t;
+
 int
 resolve_and_resume (call_frame_t *frame, server_resume_fn_t fn);
 
@@ -187,6 +203,7 @@ struct _server_state {
         struct gf_flock      flock;
         const char       *volume;
         dir_entry_t      *entry;
+        server_compound_t *compound;
 };
 
 extern struct rpcsvc_program gluster_handshake_prog;
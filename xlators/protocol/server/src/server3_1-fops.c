@@ -1153,6 +1153,105 @@ server_ftruncate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         return 0;
 }
 
+int
+server_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                      struct iatt *postbuf)
+{
+        gfs3_fallocate_rsp  rsp   = {0};
+        server_state_t     *state = NULL;
+        rpcsvc_request_t   *req   = NULL;
+
+        req           = frame->local;
+
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        state = CALL_STATE (frame);
+
+        if (op_ret == 0) {
+                gf_stat_from_iatt (&rsp.statpre, prebuf);
+                gf_stat_from_iatt (&rsp.statpost, postbuf);
+        } else {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": FALLOCATE %"PRId64" (%"PRId64") ==> %"PRId32" (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        state->fd ? state->fd->inode->ino : 0, op_ret,
+                        strerror (op_errno));
+        }
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             xdr_serialize_fallocate_rsp);
+
+        return 0;
+}
+
+int
+server_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                    struct iatt *postbuf)
+{
+        gfs3_discard_rsp    rsp   = {0};
+        server_state_t     *state = NULL;
+        rpcsvc_request_t   *req   = NULL;
+
+        req           = frame->local;
+
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        state = CALL_STATE (frame);
+
+        if (op_ret == 0) {
+                gf_stat_from_iatt (&rsp.statpre, prebuf);
+                gf_stat_from_iatt (&rsp.statpost, postbuf);
+        } else {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": DISCARD %"PRId64" (%"PRId64") ==> %"PRId32" (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        state->fd ? state->fd->inode->ino : 0, op_ret,
+                        strerror (op_errno));
+        }
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             xdr_serialize_discard_rsp);
+
+        return 0;
+}
+
+int
+server_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                     struct iatt *postbuf)
+{
+        gfs3_zerofill_rsp   rsp   = {0};
+        server_state_t     *state = NULL;
+        rpcsvc_request_t   *req   = NULL;
+
+        req           = frame->local;
+
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        state = CALL_STATE (frame);
+
+        if (op_ret == 0) {
+                gf_stat_from_iatt (&rsp.statpre, prebuf);
+                gf_stat_from_iatt (&rsp.statpost, postbuf);
+        } else {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": ZEROFILL %"PRId64" (%"PRId64") ==> %"PRId32" (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        state->fd ? state->fd->inode->ino : 0, op_ret,
+                        strerror (op_errno));
+        }
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             xdr_serialize_zerofill_rsp);
+
+        return 0;
+}
+
 int
 server_flush_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                   int32_t op_ret, int32_t op_errno)
@@ -2414,6 +2513,72 @@ err:
 }
 
 
+int
+server_fallocate_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t    *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_fallocate_cbk,
+                    bound_xl, bound_xl->fops->fallocate,
+                    state->fd, state->flags, state->offset, state->size);
+        return 0;
+err:
+        server_fallocate_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                              state->resolve.op_errno, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+server_discard_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t    *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_discard_cbk,
+                    bound_xl, bound_xl->fops->discard,
+                    state->fd, state->offset, state->size);
+        return 0;
+err:
+        server_discard_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                            state->resolve.op_errno, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+server_zerofill_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t    *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_zerofill_cbk,
+                    bound_xl, bound_xl->fops->zerofill,
+                    state->fd, state->flags, state->offset, state->size);
+        return 0;
+err:
+        server_zerofill_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                             state->resolve.op_errno, NULL, NULL);
+
+        return 0;
+}
+
+
 int
 server_flush_resume (call_frame_t *frame, xlator_t *bound_xl)
 {
@@ -3319,6 +3484,715 @@ out:
 }
 
 
+int
+server_fallocate (rpcsvc_request_t *req)
+{
+        server_state_t     *state = NULL;
+        call_frame_t       *frame = NULL;
+        gfs3_fallocate_req  args  = {{0,},};
+        int                 ret   = -1;
+
+        if (!req)
+                return ret;
+
+        if (!xdr_to_fallocate_req (req->msg[0], &args)) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_FALLOCATE;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
+        state->flags          = args.flags;
+        state->offset         = args.offset;
+        state->size           = args.size;
+
+        ret = 0;
+        resolve_and_resume (frame, server_fallocate_resume);
+out:
+        return ret;
+}
+
+
+int
+server_discard (rpcsvc_request_t *req)
+{
+        server_state_t     *state = NULL;
+        call_frame_t       *frame = NULL;
+        gfs3_discard_req    args  = {{0,},};
+        int                 ret   = -1;
+
+        if (!req)
+                return ret;
+
+        if (!xdr_to_discard_req (req->msg[0], &args)) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_DISCARD;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
+        state->offset         = args.offset;
+        state->size           = args.size;
+
+        ret = 0;
+        resolve_and_resume (frame, server_discard_resume);
+out:
+        return ret;
+}
+
+
+int
+server_zerofill (rpcsvc_request_t *req)
+{
+        server_state_t     *state = NULL;
+        call_frame_t       *frame = NULL;
+        gfs3_zerofill_req   args  = {{0,},};
+        int                 ret   = -1;
+
+        if (!req)
+                return ret;
+
+        if (!xdr_to_zerofill_req (req->msg[0], &args)) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_ZEROFILL;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
+        state->flags          = args.flags;
+        state->offset         = args.offset;
+        state->size           = args.size;
+
+        ret = 0;
+        resolve_and_resume (frame, server_zerofill_resume);
+out:
+        return ret;
+}
+
+
+static int
+server_compound_next (call_frame_t *frame);
+
+
+/* records the result of the op being run and moves on to the next one */
+static int
+server_compound_op_done (call_frame_t *frame, int32_t op_ret,
+                         int32_t op_errno, struct iatt *stbuf, dict_t *dict)
+{
+        server_state_t       *state    = NULL;
+        server_compound_t    *compound = NULL;
+        gfs3_compound_op_rsp *rsp      = NULL;
+        int32_t               len      = 0;
+        int                   ret      = 0;
+        gf_loglevel_t         loglevel = GF_LOG_INFO;
+
+        state    = CALL_STATE (frame);
+        compound = state->compound;
+        rsp      = &compound->rsps[compound->index];
+
+        if ((op_ret >= 0) && stbuf)
+                gf_stat_from_iatt (&rsp->stat, stbuf);
+
+        if ((op_ret >= 0) && dict) {
+                len = dict_serialized_length (dict);
+                if (len < 0) {
+                        op_ret   = -1;
+                        op_errno = EINVAL;
+                        goto out;
+                }
+                rsp->dict.dict_val = GF_CALLOC (1, len,
+                                                gf_server_mt_rsp_buf_t);
+                if (!rsp->dict.dict_val) {
+                        op_ret   = -1;
+                        op_errno = ENOMEM;
+                        goto out;
+                }
+                ret = dict_serialize (dict, rsp->dict.dict_val);
+                if (ret < 0) {
+                        GF_FREE (rsp->dict.dict_val);
+                        rsp->dict.dict_val = NULL;
+                        op_ret   = -1;
+                        op_errno = EINVAL;
+                        goto out;
+                }
+                rsp->dict.dict_len = len;
+        }
+
+out:
+        if (op_ret < 0) {
+                if (op_errno == ENOENT)
+                        loglevel = GF_LOG_DEBUG;
+                gf_log (frame->this->name, loglevel,
+                        "%"PRId64": COMPOUND op %d (%s) %s ==> %"PRId32" (%s)",
+                        frame->root->unique, compound->index,
+                        gf_fop_list[frame->root->op],
+                        state->loc.path ? state->loc.path : "",
+                        op_ret, strerror (op_errno));
+                if (!compound->failed) {
+                        compound->failed   = 1;
+                        compound->op_errno = op_errno;
+                }
+        }
+
+        rsp->op_ret   = op_ret;
+        rsp->op_errno = gf_errno_to_error (op_errno);
+
+        compound->index++;
+        server_compound_next (frame);
+
+        return 0;
+}
+
+
+static int
+server_compound_stat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                          int32_t op_ret, int32_t op_errno, struct iatt *buf)
+{
+        return server_compound_op_done (frame, op_ret, op_errno, buf, NULL);
+}
+
+
+static int
+server_compound_dict_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                          int32_t op_ret, int32_t op_errno, dict_t *dict)
+{
+        return server_compound_op_done (frame, op_ret, op_errno, NULL, dict);
+}
+
+
+static int
+server_compound_common_cbk (call_frame_t *frame, void *cookie,
+                            xlator_t *this, int32_t op_ret, int32_t op_errno)
+{
+        return server_compound_op_done (frame, op_ret, op_errno, NULL, NULL);
+}
+
+
+/* the lock fops keep the connection's lock table up to date, exactly as
+ * server_[f]inodelk_cbk and server_[f]entrylk_cbk do
+ */
+static int
+server_compound_lk_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno)
+{
+        server_connection_t *conn   = NULL;
+        server_state_t      *state  = NULL;
+        glusterfs_fop_t      type   = GF_FOP_INODELK;
+        int                  unlock = 0;
+        loc_t               *loc    = NULL;
+
+        if (op_ret < 0)
+                goto out;
+
+        conn  = SERVER_CONNECTION (frame);
+        state = CALL_STATE (frame);
+
+        switch (frame->root->op) {
+        case GF_FOP_INODELK:
+        case GF_FOP_FINODELK:
+                unlock = (state->flock.l_type == F_UNLCK);
+                break;
+        case GF_FOP_ENTRYLK:
+        case GF_FOP_FENTRYLK:
+                type   = GF_FOP_ENTRYLK;
+                unlock = (state->cmd == ENTRYLK_UNLOCK);
+                break;
+        default:
+                goto out;
+        }
+
+        if (!state->fd)
+                loc = &state->loc;
+
+        if (unlock)
+                gf_del_locker (conn->ltable, state->volume, loc, state->fd,
+                               frame->root->lk_owner, type);
+        else
+                gf_add_locker (conn->ltable, state->volume, loc, state->fd,
+                               frame->root->pid, frame->root->lk_owner, type);
+out:
+        return server_compound_op_done (frame, op_ret, op_errno, NULL, NULL);
+}
+
+
+static int
+server_compound_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        switch (frame->root->op) {
+        case GF_FOP_STAT:
+                STACK_WIND (frame, server_compound_stat_cbk,
+                            bound_xl, bound_xl->fops->stat, &state->loc);
+                break;
+        case GF_FOP_FSTAT:
+                STACK_WIND (frame, server_compound_stat_cbk,
+                            bound_xl, bound_xl->fops->fstat, state->fd);
+                break;
+        case GF_FOP_SETXATTR:
+                STACK_WIND (frame, server_compound_common_cbk,
+                            bound_xl, bound_xl->fops->setxattr,
+                            &state->loc, state->dict, state->flags);
+                break;
+        case GF_FOP_FSETXATTR:
+                STACK_WIND (frame, server_compound_common_cbk,
+                            bound_xl, bound_xl->fops->fsetxattr,
+                            state->fd, state->dict, state->flags);
+                break;
+        case GF_FOP_GETXATTR:
+                STACK_WIND (frame, server_compound_dict_cbk,
+                            bound_xl, bound_xl->fops->getxattr,
+                            &state->loc, state->name);
+                break;
+        case GF_FOP_FGETXATTR:
+                STACK_WIND (frame, server_compound_dict_cbk,
+                            bound_xl, bound_xl->fops->fgetxattr,
+                            state->fd, state->name);
+                break;
+        case GF_FOP_XATTROP:
+                STACK_WIND (frame, server_compound_dict_cbk,
+                            bound_xl, bound_xl->fops->xattrop,
+                            &state->loc, state->flags, state->dict);
+                break;
+        case GF_FOP_FXATTROP:
+                STACK_WIND (frame, server_compound_dict_cbk,
+                            bound_xl, bound_xl->fops->fxattrop,
+                            state->fd, state->flags, state->dict);
+                break;
+        case GF_FOP_INODELK:
+                STACK_WIND (frame, server_compound_lk_cbk,
+                            bound_xl, bound_xl->fops->inodelk,
+                            state->volume, &state->loc, state->cmd,
+                            &state->flock);
+                break;
+        case GF_FOP_FINODELK:
+                STACK_WIND (frame, server_compound_lk_cbk,
+                            bound_xl, bound_xl->fops->finodelk,
+                            state->volume, state->fd, state->cmd,
+                            &state->flock);
+                break;
+        case GF_FOP_ENTRYLK:
+                STACK_WIND (frame, server_compound_lk_cbk,
+                            bound_xl, bound_xl->fops->entrylk,
+                            state->volume, &state->loc, state->name,
+                            state->cmd, state->type);
+                break;
+        case GF_FOP_FENTRYLK:
+                STACK_WIND (frame, server_compound_lk_cbk,
+                            bound_xl, bound_xl->fops->fentrylk,
+                            state->volume, state->fd, state->name,
+                            state->cmd, state->type);
+                break;
+        default:
+                server_compound_op_done (frame, -1, EOPNOTSUPP, NULL, NULL);
+                break;
+        }
+
+        return 0;
+err:
+        server_compound_op_done (frame, state->resolve.op_ret,
+                                 state->resolve.op_errno, NULL, NULL);
+        return 0;
+}
+
+
+/* drops what the previous op resolved and decoded into the state */
+static void
+server_compound_state_reset (server_state_t *state)
+{
+        server_loc_wipe (&state->loc);
+        server_loc_wipe (&state->loc2);
+        memset (&state->loc, 0, sizeof (state->loc));
+        memset (&state->loc2, 0, sizeof (state->loc2));
+
+        server_resolve_wipe (&state->resolve);
+        server_resolve_wipe (&state->resolve2);
+        memset (&state->resolve, 0, sizeof (state->resolve));
+        memset (&state->resolve2, 0, sizeof (state->resolve2));
+        state->resolve.fd_no  = -1;
+        state->resolve2.fd_no = -1;
+        state->resolve_now    = NULL;
+        state->loc_now        = NULL;
+
+        if (state->fd) {
+                fd_unref (state->fd);
+                state->fd = NULL;
+        }
+        if (state->dict) {
+                dict_unref (state->dict);
+                state->dict = NULL;
+        }
+        if (state->volume) {
+                GF_FREE ((void *)state->volume);
+                state->volume = NULL;
+        }
+        if (state->name) {
+                GF_FREE (state->name);
+                state->name = NULL;
+        }
+
+        state->flags = 0;
+        state->cmd   = 0;
+        state->type  = 0;
+        memset (&state->flock, 0, sizeof (state->flock));
+}
+
+
+/* decodes one op of the compound into the state, the same way the
+ * request handler of the plain fop does
+ */
+static int
+server_compound_op_decode (call_frame_t *frame, gfs3_compound_op *op)
+{
+        server_state_t *state    = NULL;
+        dict_t         *dict     = NULL;
+        char           *buf      = NULL;
+        int             fd_op    = 0;
+        int             op_errno = EINVAL;
+        int             ret      = 0;
+
+        state = CALL_STATE (frame);
+
+        switch (op->op) {
+        case GFS3_OP_STAT:
+                frame->root->op = GF_FOP_STAT;
+                break;
+        case GFS3_OP_FSTAT:
+                frame->root->op = GF_FOP_FSTAT;
+                fd_op = 1;
+                break;
+        case GFS3_OP_SETXATTR:
+                frame->root->op = GF_FOP_SETXATTR;
+                break;
+        case GFS3_OP_FSETXATTR:
+                frame->root->op = GF_FOP_FSETXATTR;
+                fd_op = 1;
+                break;
+        case GFS3_OP_GETXATTR:
+                frame->root->op = GF_FOP_GETXATTR;
+                break;
+        case GFS3_OP_FGETXATTR:
+                frame->root->op = GF_FOP_FGETXATTR;
+                fd_op = 1;
+                break;
+        case GFS3_OP_XATTROP:
+                frame->root->op = GF_FOP_XATTROP;
+                break;
+        case GFS3_OP_FXATTROP:
+                frame->root->op = GF_FOP_FXATTROP;
+                fd_op = 1;
+                break;
+        case GFS3_OP_INODELK:
+                frame->root->op = GF_FOP_INODELK;
+                break;
+        case GFS3_OP_FINODELK:
+                frame->root->op = GF_FOP_FINODELK;
+                fd_op = 1;
+                break;
+        case GFS3_OP_ENTRYLK:
+                frame->root->op = GF_FOP_ENTRYLK;
+                break;
+        case GFS3_OP_FENTRYLK:
+                frame->root->op = GF_FOP_FENTRYLK;
+                fd_op = 1;
+                break;
+        default:
+                op_errno = EOPNOTSUPP;
+                goto out;
+        }
+
+        state->resolve.type = RESOLVE_MUST;
+        if (fd_op) {
+                state->resolve.fd_no = op->fd;
+        } else {
+                memcpy (state->resolve.gfid, op->gfid, 16);
+                if (op->path && op->path[0])
+                        state->resolve.path = gf_strdup (op->path);
+        }
+
+        state->flags = op->flags;
+
+        if (op->name && op->name[0])
+                state->name = gf_strdup (op->name);
+
+        if (op->volume && op->volume[0])
+                state->volume = gf_strdup (op->volume);
+
+        switch (frame->root->op) {
+        case GF_FOP_INODELK:
+        case GF_FOP_FINODELK:
+                if (frame->root->op == GF_FOP_INODELK)
+                        state->resolve.type = RESOLVE_EXACT;
+
+                switch (op->cmd) {
+                case GF_LK_GETLK:
+                        state->cmd = F_GETLK;
+                        break;
+                case GF_LK_SETLK:
+                        state->cmd = F_SETLK;
+                        break;
+                case GF_LK_SETLKW:
+                        state->cmd = F_SETLKW;
+                        break;
+                }
+
+                gf_proto_flock_to_flock (&op->flock, &state->flock);
+
+                switch (op->type) {
+                case GF_LK_F_RDLCK:
+                        state->flock.l_type = F_RDLCK;
+                        break;
+                case GF_LK_F_WRLCK:
+                        state->flock.l_type = F_WRLCK;
+                        break;
+                case GF_LK_F_UNLCK:
+                        state->flock.l_type = F_UNLCK;
+                        break;
+                }
+                break;
+        case GF_FOP_ENTRYLK:
+        case GF_FOP_FENTRYLK:
+                if (frame->root->op == GF_FOP_ENTRYLK)
+                        state->resolve.type = RESOLVE_EXACT;
+
+                state->cmd  = op->cmd;
+                state->type = op->type;
+                if (state->name)
+                        GF_FREE (state->name);
+                state->name = NULL;
+                if (op->bname && op->bname[0])
+                        state->name = gf_strdup (op->bname);
+                break;
+        default:
+                break;
+        }
+
+        if (op->dict.dict_len) {
+                dict = dict_new ();
+                buf  = memdup (op->dict.dict_val, op->dict.dict_len);
+                if (!dict || !buf) {
+                        op_errno = ENOMEM;
+                        goto out;
+                }
+
+                ret = dict_unserialize (buf, op->dict.dict_len, &dict);
+                if (ret < 0) {
+                        gf_log (frame->this->name, GF_LOG_ERROR,
+                                "%"PRId64": failed to unserialize the dict "
+                                "of compound op (%s)", frame->root->unique,
+                                gf_fop_list[frame->root->op]);
+                        goto out;
+                }
+                dict->extra_free = buf;
+                buf = NULL;
+
+                state->dict = dict;
+                dict = NULL;
+        }
+
+        op_errno = 0;
+out:
+        if (buf)
+                GF_FREE (buf);
+        if (dict)
+                dict_unref (dict);
+
+        return op_errno;
+}
+
+
+static int
+server_compound_done (call_frame_t *frame)
+{
+        server_state_t    *state    = NULL;
+        server_compound_t *compound = NULL;
+        rpcsvc_request_t  *req      = NULL;
+        gfs3_compound_rsp  rsp      = {0,};
+        int                i        = 0;
+
+        req      = frame->local;
+        state    = CALL_STATE (frame);
+        compound = state->compound;
+
+        for (i = 1; i < compound->count; i++)
+                compound->rsps[i - 1].nextrsp = &compound->rsps[i];
+
+        rsp.op_ret   = compound->failed ? -1 : 0;
+        rsp.op_errno = gf_errno_to_error (compound->op_errno);
+        rsp.rsps     = &compound->rsps[0];
+
+        /* the state, and with it the compound, goes away with the reply */
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             xdr_serialize_compound_rsp);
+
+        return 0;
+}
+
+
+static int
+server_compound_next (call_frame_t *frame)
+{
+        server_state_t    *state    = NULL;
+        server_compound_t *compound = NULL;
+        gfs3_compound_op  *op       = NULL;
+        int                op_errno = 0;
+
+        state    = CALL_STATE (frame);
+        compound = state->compound;
+
+        for (; compound->index < compound->count; compound->index++) {
+                op = compound->ops[compound->index];
+                if (!compound->failed || (op->cflags & GF_COMPOUND_ALWAYS))
+                        break;
+
+                compound->rsps[compound->index].op_ret   = -1;
+                compound->rsps[compound->index].op_errno =
+                        gf_errno_to_error (ECANCELED);
+        }
+
+        if (compound->index == compound->count) {
+                frame->root->op = GF_FOP_COMPOUND;
+                server_compound_done (frame);
+                return 0;
+        }
+
+        server_compound_state_reset (state);
+
+        op_errno = server_compound_op_decode (frame, op);
+        if (op_errno) {
+                server_compound_op_done (frame, -1, op_errno, NULL, NULL);
+                return 0;
+        }
+
+        resolve_and_resume (frame, server_compound_resume);
+
+        return 0;
+}
+
+
+int
+server_compound (rpcsvc_request_t *req)
+{
+        server_state_t    *state    = NULL;
+        call_frame_t      *frame    = NULL;
+        server_compound_t *compound = NULL;
+        gfs3_compound_op  *trav     = NULL;
+        int                ret      = -1;
+
+        if (!req)
+                return ret;
+
+        compound = GF_CALLOC (1, sizeof (*compound),
+                              gf_server_mt_compound_t);
+        if (!compound) {
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        if (!xdr_to_compound_req (req->msg[0], &compound->req)) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        for (trav = compound->req.ops; trav; trav = trav->nextop) {
+                if (compound->count == GF_COMPOUND_MAX_OPS)
+                        break;
+                compound->ops[compound->count++] = trav;
+        }
+
+        if (trav || !compound->count) {
+                gf_log ("server", GF_LOG_WARNING,
+                        "compound request with %s ops",
+                        trav ? "too many" : "no");
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_COMPOUND;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->compound = compound;
+        compound = NULL;
+
+        ret = 0;
+        server_compound_next (frame);
+out:
+        if (compound) {
+                /* the counted ops have no reply buffers yet */
+                compound->count = 0;
+                server_compound_wipe (compound);
+        }
+
+        return ret;
+}
+
+
 int
 server_fstat (rpcsvc_request_t *req)
 {
@@ -5192,13 +6066,13 @@ rpcsvc_actor_t glusterfs3_1_fop_actors[] = {
         [GFS3_OP_CREATE]      = { "CREATE",     GFS3_OP_CREATE, server_create, NULL, NULL },
         [GFS3_OP_FTRUNCATE]   = { "FTRUNCATE",  GFS3_OP_FTRUNCATE, server_ftruncate, NULL, NULL },
         [GFS3_OP_FSTAT]       = { "FSTAT",      GFS3_OP_FSTAT, server_fstat, NULL, NULL },
-        [GFS3_OP_LK]          = { "LK",         GFS3_OP_LK, server_lk, NULL, NULL },
+        [GFS3_OP_LK]          = { "LK",         GFS3_OP_LK, server_lk, NULL, NULL, RPCSVC_DRC_NONE, 1 },
         [GFS3_OP_LOOKUP]      = { "LOOKUP",     GFS3_OP_LOOKUP, server_lookup, NULL, NULL },
         [GFS3_OP_READDIR]     = { "READDIR",    GFS3_OP_READDIR, server_readdir, NULL, NULL },
-        [GFS3_OP_INODELK]     = { "INODELK",    GFS3_OP_INODELK, server_inodelk, NULL, NULL },
-        [GFS3_OP_FINODELK]    = { "FINODELK",   GFS3_OP_FINODELK, server_finodelk, NULL, NULL },
-        [GFS3_OP_ENTRYLK]     = { "ENTRYLK",    GFS3_OP_ENTRYLK, server_entrylk, NULL, NULL },
-        [GFS3_OP_FENTRYLK]    = { "FENTRYLK",   GFS3_OP_FENTRYLK, server_fentrylk, NULL, NULL },
+        [GFS3_OP_INODELK]     = { "INODELK",    GFS3_OP_INODELK, server_inodelk, NULL, NULL, RPCSVC_DRC_NONE, 1 },
+        [GFS3_OP_FINODELK]    = { "FINODELK",   GFS3_OP_FINODELK, server_finodelk, NULL, NULL, RPCSVC_DRC_NONE, 1 },
+        [GFS3_OP_ENTRYLK]     = { "ENTRYLK",    GFS3_OP_ENTRYLK, server_entrylk, NULL, NULL, RPCSVC_DRC_NONE, 1 },
+        [GFS3_OP_FENTRYLK]    = { "FENTRYLK",   GFS3_OP_FENTRYLK, server_fentrylk, NULL, NULL, RPCSVC_DRC_NONE, 1 },
         [GFS3_OP_XATTROP]     = { "XATTROP",    GFS3_OP_XATTROP, server_xattrop, NULL, NULL },
         [GFS3_OP_FXATTROP]    = { "FXATTROP",   GFS3_OP_FXATTROP, server_fxattrop, NULL, NULL },
         [GFS3_OP_FGETXATTR]   = { "FGETXATTR",  GFS3_OP_FGETXATTR, server_fgetxattr, NULL, NULL },
@@ -5209,6 +6083,10 @@ rpcsvc_actor_t glusterfs3_1_fop_actors[] = {
         [GFS3_OP_READDIRP]    = { "READDIRP",   GFS3_OP_READDIRP, server_readdirp, NULL, NULL },
         [GFS3_OP_RELEASE]     = { "RELEASE",    GFS3_OP_RELEASE, server_release, NULL, NULL },
         [GFS3_OP_RELEASEDIR]  = { "RELEASEDIR", GFS3_OP_RELEASEDIR, server_releasedir, NULL, NULL },
+        [GFS3_OP_FALLOCATE]   = { "FALLOCATE",  GFS3_OP_FALLOCATE, server_fallocate, NULL, NULL },
+        [GFS3_OP_DISCARD]     = { "DISCARD",    GFS3_OP_DISCARD, server_discard, NULL, NULL },
+        [GFS3_OP_ZEROFILL]    = { "ZEROFILL",   GFS3_OP_ZEROFILL, server_zerofill, NULL, NULL },
+        [GFS3_OP_COMPOUND]    = { "COMPOUND",   GFS3_OP_COMPOUND, server_compound, NULL, NULL },
 };
 
 
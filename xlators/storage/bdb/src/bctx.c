@@ -20,6 +20,7 @@
 #include <list.h>
 #include <bdb.h>
 #include <libgen.h> /* for dirname */
+#include "hashfn.h"
 
 static void
 __destroy_bctx (bctx_t *bctx)
@@ -39,41 +40,33 @@ __unhash_bctx (bctx_t *bctx)
         list_del_init (&bctx->b_hash);
 }
 
-static int32_t
-bctx_table_prune (bctx_table_t *table)
+/* move the bctx_t over the lru limit to @purge, to be called with
+ * table->lock held. their databases are closed by bctx_purge(), without
+ * the lock */
+static void
+__bctx_table_prune (bctx_table_t *table, struct list_head *purge)
 {
-        int32_t ret = 0;
-        struct list_head purge = {0,};
-        struct list_head *next = NULL;
         bctx_t *entry = NULL;
-        bctx_t *del = NULL, *tmp = NULL;
 
-        if (!table)
-                return 0;
+        while (table->lru_limit && (table->lru_size > table->lru_limit)) {
+                entry = list_entry (table->b_lru.next, bctx_t, list);
 
-        INIT_LIST_HEAD (&purge);
+                list_move_tail (&entry->list, purge);
+                __unhash_bctx (entry);
 
-        LOCK (&table->lock);
-        {
-                if ((table->lru_limit) &&
-                    (table->lru_size > table->lru_limit)) {
-                        while (table->lru_size > table->lru_limit) {
-                                next = table->b_lru.next;
-                                entry = list_entry (next, bctx_t, list);
+                table->lru_size--;
+        }
 
-                                list_move_tail (next, &table->purge);
-                                __unhash_bctx (entry);
+        list_splice_init (&table->purge, purge);
+}
 
-                                table->lru_size--;
-                                ret++;
-                        }
-                }
-                list_move_tail (&purge, &table->purge);
-                list_del_init (&table->purge);
-        }
-        UNLOCK (&table->lock);
+static void
+bctx_purge (bctx_table_t *table, struct list_head *purge)
+{
+        int32_t ret = 0;
+        bctx_t *del = NULL, *tmp = NULL;
 
-        list_for_each_entry_safe (del, tmp, &purge, list) {
+        list_for_each_entry_safe (del, tmp, purge, list) {
                 list_del_init (&del->list);
                 if (del->primary) {
                         ret = del->primary->close (del->primary, 0);
@@ -105,53 +98,41 @@ bctx_table_prune (bctx_table_t *table)
                 }
                 __destroy_bctx (del);
         }
-
-        return ret;
 }
 
 
 /* struct bdb_ctx related */
+
+/* hash of the whole directory path, not of its basename: every 'src' or
+ * 'tmp' of a volume would land in one chain otherwise */
 static inline uint32_t
-bdb_key_hash (char *key, uint32_t hash_size)
+bdb_key_hash (const char *key, uint32_t hash_size)
 {
-        uint32_t hash = 0;
-
-        hash = *key;
-
-        if (hash) {
-                for (key += 1; *key != '\0'; key++) {
-                        hash = (hash << 5) - hash + *key;
-                }
-        }
-
-        return (hash + *key) % hash_size;
+        return SuperFastHash (key, strlen (key)) % hash_size;
 }
 
 static void
 __hash_bctx (bctx_t *bctx)
 {
         bctx_table_t *table = NULL;
-        char *key = NULL;
 
         table = bctx->table;
 
-        MAKE_KEY_FROM_PATH (key, bctx->directory);
-        bctx->key_hash = bdb_key_hash (key, table->hash_size);
+        bctx->key_hash = bdb_key_hash (bctx->directory, table->hash_size);
 
         list_del_init (&bctx->b_hash);
         list_add (&bctx->b_hash, &table->b_hash[bctx->key_hash]);
 }
 
+/* a bctx_t whose databases were never opened goes to the lru as well:
+ * destroying it would only have the next fop on the directory allocate
+ * and hash it again */
 static inline bctx_t *
 __bctx_passivate (bctx_t *bctx)
 {
-        if (bctx->primary) {
-                list_move_tail (&bctx->list, &(bctx->table->b_lru));
-                bctx->table->lru_size++;
-        } else {
-                list_move_tail (&bctx->list, &bctx->table->purge);
-                __unhash_bctx (bctx);
-        }
+        list_move_tail (&bctx->list, &(bctx->table->b_lru));
+        bctx->table->lru_size++;
+
         return bctx;
 }
 
@@ -181,20 +162,24 @@ __bdb_ctx_unref (bctx_t *bctx)
 bctx_t *
 bctx_unref (bctx_t *bctx)
 {
-        bctx_table_t *table = NULL;
+        bctx_table_t     *table = NULL;
+        struct list_head  purge;
 
-        if (!bctx && !bctx->table)
+        if (!bctx || !bctx->table)
                 return NULL;
 
         table = bctx->table;
+        INIT_LIST_HEAD (&purge);
 
         LOCK (&table->lock);
         {
                 bctx = __bdb_ctx_unref (bctx);
+                __bctx_table_prune (table, &purge);
         }
         UNLOCK (&table->lock);
 
-        bctx_table_prune (table);
+        if (!list_empty (&purge))
+                bctx_purge (table, &purge);
 
         return bctx;
 }
@@ -273,7 +258,6 @@ bctx_t *
 bctx_lookup (bctx_table_t *table,
              const char *directory)
 {
-        char    *key = NULL;
         uint32_t key_hash = 0;
         bctx_t  *trav = NULL, *bctx = NULL, *tmp = NULL;
         int32_t  need_break = 0;
@@ -281,8 +265,7 @@ bctx_lookup (bctx_table_t *table,
         GF_VALIDATE_OR_GOTO ("bctx", table, out);
         GF_VALIDATE_OR_GOTO ("bctx", directory, out);
 
-        MAKE_KEY_FROM_PATH (key, directory);
-        key_hash = bdb_key_hash (key, table->hash_size);
+        key_hash = bdb_key_hash (directory, table->hash_size);
 
         LOCK (&table->lock);
         {
@@ -327,15 +310,14 @@ bctx_parent (bctx_table_t *table,
         GF_VALIDATE_OR_GOTO ("bctx", table, out);
         GF_VALIDATE_OR_GOTO ("bctx", path, out);
 
-        pathname = gf_strdup (path);
-        GF_VALIDATE_OR_GOTO ("bctx", pathname, out);
+        /* called by nearly every fop, keep it off the heap */
+        pathname = alloca (strlen (path) + 1);
+        strcpy (pathname, path);
         directory = dirname (pathname);
 
         bctx = bctx_lookup (table, directory);
         GF_VALIDATE_OR_GOTO ("bctx", bctx, out);
 
 out:
-        if (pathname)
-                free (pathname);
         return bctx;
 }
@@ -727,7 +727,7 @@ bdb_db_put (bctx_t *bctx,
                         need_break = 1;
                 } else {
                         /* successfully wrote */
-                        ret = 0;
+                        ret = bdb_group_commit (bctx->table);
                         need_break = 1;
                 }
         } while (!need_break);
@@ -832,7 +832,7 @@ bdb_db_del (bctx_t *bctx,
                                 "_BDB_DB_DEL %s - %s"
                                 "(successfully deleted entry from database)",
                                 bctx->directory, key_string);
-                        ret = 0;
+                        ret = bdb_group_commit (bctx->table);
                         need_break = 1;
                 } else {
                         gf_log ("bdb-ll", GF_LOG_DEBUG,
@@ -854,6 +854,162 @@ bdb_db_iremove (bctx_t *bctx,
         return bdb_db_del (bctx, NULL, key);
 }
 
+/* bdb_group_commit - make the transactions committed so far durable.
+ *
+ * with 'option group-commit on' the environment commits with
+ * DB_TXN_WRITE_NOSYNC: the log record is written, not synced. a writer
+ * then takes a ticket and waits here for bdb_group_commit_proc(), whose
+ * one DB_ENV->log_flush() covers every commit made before it started.
+ * concurrent creates and writes thus share a sync of the log instead of
+ * paying one each.
+ *
+ * return: 0 once the commit is on disk, -1 if the flush failed. does
+ * nothing when group commit is off.
+ */
+int32_t
+bdb_group_commit (bctx_table_t *table)
+{
+        uint64_t ticket = 0;
+        int32_t  ret    = 0;
+
+        if (!table->group_commit)
+                goto out;
+
+        pthread_mutex_lock (&table->gc_mutex);
+        {
+                ticket = ++table->gc_requested;
+                pthread_cond_broadcast (&table->gc_cond);
+
+                while (table->gc_active && (table->gc_flushed < ticket))
+                        pthread_cond_wait (&table->gc_cond, &table->gc_mutex);
+
+                if (table->gc_error)
+                        ret = -1;
+        }
+        pthread_mutex_unlock (&table->gc_mutex);
+
+out:
+        return ret;
+}
+
+static void *
+bdb_group_commit_proc (void *data)
+{
+        bctx_table_t *table  = NULL;
+        DB_ENV       *dbenv  = NULL;
+        uint64_t      target = 0;
+        int32_t       ret    = 0;
+
+        table = data;
+        dbenv = table->dbenv;
+
+        pthread_mutex_lock (&table->gc_mutex);
+        while (table->gc_active) {
+                if (table->gc_flushed == table->gc_requested) {
+                        pthread_cond_wait (&table->gc_cond, &table->gc_mutex);
+                        continue;
+                }
+                pthread_mutex_unlock (&table->gc_mutex);
+
+                /* let the writers behind the first one commit too */
+                if (table->gc_window)
+                        usleep (table->gc_window);
+
+                pthread_mutex_lock (&table->gc_mutex);
+                target = table->gc_requested;
+                pthread_mutex_unlock (&table->gc_mutex);
+
+                ret = dbenv->log_flush (dbenv, NULL);
+                if (ret != 0) {
+                        gf_log ("bdb-ll", GF_LOG_ERROR,
+                                "_BDB_GROUP_COMMIT: %s"
+                                "(failed to flush transaction log)",
+                                db_strerror (ret));
+                }
+
+                pthread_mutex_lock (&table->gc_mutex);
+                table->gc_error = ret;
+                table->gc_flushed = target;
+                pthread_cond_broadcast (&table->gc_cond);
+        }
+
+        /* nobody is left waiting for a flush that will not come */
+        table->gc_flushed = table->gc_requested;
+        pthread_cond_broadcast (&table->gc_cond);
+        pthread_mutex_unlock (&table->gc_mutex);
+
+        return NULL;
+}
+
+static int32_t
+bdb_group_commit_init (bctx_table_t *table)
+{
+        int32_t ret = -1;
+
+        pthread_mutex_init (&table->gc_mutex, NULL);
+        pthread_cond_init (&table->gc_cond, NULL);
+        table->gc_active = 1;
+
+        ret = pthread_create (&table->gc_thread, NULL, bdb_group_commit_proc,
+                              table);
+        if (ret != 0) {
+                gf_log ("bdb-ll", GF_LOG_ERROR,
+                        "could not start group commit thread (%s). every "
+                        "commit will sync the transaction log.",
+                        strerror (ret));
+                table->gc_active = 0;
+                goto out;
+        }
+
+        table->group_commit = 1;
+out:
+        return ret;
+}
+
+void
+bdb_group_commit_fini (bctx_table_t *table)
+{
+        if (!table->group_commit)
+                return;
+
+        pthread_mutex_lock (&table->gc_mutex);
+        {
+                table->gc_active = 0;
+                pthread_cond_broadcast (&table->gc_cond);
+        }
+        pthread_mutex_unlock (&table->gc_mutex);
+
+        pthread_join (table->gc_thread, NULL);
+        table->group_commit = 0;
+}
+
+
+/* bdb_lru_limit - how many unused databases can be kept open in @memory
+ * bytes, 0 meaning the share of physical memory set aside for them */
+static uint32_t
+bdb_lru_limit (uint64_t memory)
+{
+        long     pages    = 0;
+        long     pagesize = 0;
+        uint64_t limit    = 0;
+
+        if (memory == 0) {
+                pages = sysconf (_SC_PHYS_PAGES);
+                pagesize = sysconf (_SC_PAGESIZE);
+                if ((pages > 0) && (pagesize > 0))
+                        memory = ((uint64_t)pages * pagesize)
+                                / BDB_OPEN_DB_MEMORY_SHARE;
+        }
+
+        limit = memory / BDB_OPEN_DB_COST;
+        if (limit < BDB_DEFAULT_LRU_LIMIT)
+                limit = BDB_DEFAULT_LRU_LIMIT;
+        if (limit > BDB_MAX_LRU_LIMIT)
+                limit = BDB_MAX_LRU_LIMIT;
+
+        return limit;
+}
+
 /* NOTE: bdb version compatibility wrapper */
 int32_t
 bdb_cursor_get (DBC *cursorp,
@@ -984,6 +1140,19 @@ bdb_dbenv_init (xlator_t *this,
         if (private->transaction) {
                 ret = dbenv->set_flags(dbenv, DB_AUTO_COMMIT, 1);
 
+                if ((ret == 0) && private->group_commit) {
+                        /* bdb_group_commit() does the syncing */
+                        ret = dbenv->set_flags (dbenv, DB_TXN_WRITE_NOSYNC, 1);
+                        if (ret != 0) {
+                                gf_log ("bdb-ll", GF_LOG_WARNING,
+                                        "could not configure deferred log "
+                                        "sync (%s). group commit disabled.",
+                                        db_strerror (ret));
+                                private->group_commit = 0;
+                                ret = 0;
+                        }
+                }
+
                 if (ret != 0) {
                         gf_log ("bdb-ll", GF_LOG_DEBUG,
                                 "configuration of auto-commit failed for "
@@ -1164,6 +1333,9 @@ bdb_db_init (xlator_t *this,
         char *checkpoint_interval_str = NULL;
         char *page_size_str           = NULL;
         char *lru_limit_str           = NULL;
+        char *open_db_memory_str      = NULL;
+        char *group_commit_str        = NULL;
+        char *window_str              = NULL;
         char *timeout_str             = NULL;
         char *access_mode             = NULL;
         char *endptr    = NULL;
@@ -1175,6 +1347,7 @@ bdb_db_init (xlator_t *this,
         int   ret = -1;
         int   idx = 0;
         struct stat stbuf = {0,};
+        uint64_t    open_db_memory = 0;
 
         private = this->private;
 
@@ -1273,6 +1446,22 @@ bdb_db_init (xlator_t *this,
                                 goto err;
                         }
                 }
+
+                private->group_commit = _gf_true;
+                ret = dict_get_str (options, "group-commit",
+                                    &group_commit_str);
+                if (ret == 0) {
+                        ret = gf_string2boolean (group_commit_str,
+                                                 &private->group_commit);
+                        if (ret < 0) {
+                                gf_log (this->name, GF_LOG_ERROR,
+                                        "\"%s\" is an invalid parameter to "
+                                        "\"option group-commit\". please "
+                                        "specify on or off and retry.",
+                                        group_commit_str);
+                                goto err;
+                        }
+                }
         }
 
         ret = dict_get_str (options, "file-mode", &mode_str);
@@ -1332,22 +1521,52 @@ bdb_db_init (xlator_t *this,
         table->dbflags = private->dbflags;
         table->this    = this;
 
-        ret = dict_get_str (options, "lru-limit",
+        table->gc_window = BDB_DEFAULT_GROUP_COMMIT_WINDOW;
+        ret = dict_get_str (options, "group-commit-window", &window_str);
+        if (ret == 0) {
+                ret = gf_string2uint32 (window_str, &table->gc_window);
+                if (ret < 0) {
+                        gf_log ("bdb-ll", GF_LOG_ERROR,
+                                "\"%s\" is an invalid parameter to "
+                                "\"option group-commit-window\". please "
+                                "specify a number of microseconds and retry.",
+                                window_str);
+                        goto err;
+                }
+        }
+
+        ret = dict_get_str (options, "open-db-memory", &open_db_memory_str);
+        if (ret == 0) {
+                ret = gf_string2bytesize (open_db_memory_str,
+                                          &open_db_memory);
+                if (ret < 0) {
+                        gf_log ("bdb-ll", GF_LOG_ERROR,
+                                "\"%s\" is an invalid parameter to "
+                                "\"option open-db-memory\". please specify "
+                                "a valid size and retry.",
+                                open_db_memory_str);
+                        goto err;
+                }
+        }
+
+        ret = dict_get_str (options, "open-db-lru-limit",
                             &lru_limit_str);
+        if (ret < 0)
+                ret = dict_get_str (options, "lru-limit", &lru_limit_str);
 
         /* TODO: set max lockers and max txns to accomodate
          * for more than lru_limit */
         if (ret == 0) {
                 ret = gf_string2uint32 (lru_limit_str,
                                         &table->lru_limit);
-                gf_log ("bdb-ll", GF_LOG_DEBUG,
-                        "setting lru limit of 'storage/bdb' internal context"
-                        "table to %d. maximum of %d unused databases can be "
-                        "open at any given point of time.",
-                        table->lru_limit, table->lru_limit);
         } else {
-                table->lru_limit = BDB_DEFAULT_LRU_LIMIT;
+                table->lru_limit = bdb_lru_limit (open_db_memory);
         }
+        gf_log ("bdb-ll", GF_LOG_DEBUG,
+                "setting lru limit of 'storage/bdb' internal context"
+                "table to %d. maximum of %d unused databases can be "
+                "open at any given point of time.",
+                table->lru_limit, table->lru_limit);
 
         ret = dict_get_str (options, "page-size",
                             &page_size_str);
@@ -1378,10 +1597,17 @@ bdb_db_init (xlator_t *this,
                 table->page_size = BDB_LL_PAGE_SIZE_DEFAULT;
         }
 
-        table->hash_size = BDB_DEFAULT_HASH_SIZE;
-        table->b_hash = GF_CALLOC (BDB_DEFAULT_HASH_SIZE,
+        /* about one directory per chain when the lru is full */
+        table->hash_size = gf_roundup_power_of_two (table->lru_limit);
+        table->b_hash = GF_CALLOC (table->hash_size,
                                    sizeof (struct list_head),
                                    gf_bdb_mt_list_head);
+        if (table->b_hash == NULL) {
+                gf_log ("bdb-ll", GF_LOG_CRITICAL,
+                        "memory allocation for 'storage/bdb' internal "
+                        "context table failed.");
+                goto err;
+        }
 
         for (idx = 0; idx < table->hash_size; idx++)
                 INIT_LIST_HEAD(&(table->b_hash[idx]));
@@ -1442,6 +1668,9 @@ bdb_db_init (xlator_t *this,
                                 UNLOCK (&private->active_lock);
                                 pthread_create (&private->checkpoint_thread,
                                                 NULL, bdb_checkpoint, this);
+
+                                if (private->group_commit)
+                                        bdb_group_commit_init (table);
                         }
                 }
         }
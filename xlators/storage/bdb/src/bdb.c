@@ -2781,14 +2781,28 @@ gf_dirent_for_namen (const char *name,
         return gf_dirent_for_name (tmp_name);
 }
 
-int32_t
-bdb_readdir (call_frame_t *frame,
-             xlator_t *this,
-             fd_t *fd,
-             size_t size,
-             off_t off)
+/* bdb_do_readdir - readdir and readdirp.
+ *
+ * regular files are read from the directory's database with one cursor
+ * scan, subdirectories and symlinks from the directory itself. for
+ * readdirp the cursor brings each file's record along with its key, so
+ * the size in the returned stat costs no get of its own, and the rest of
+ * the stat comes from a single lstat() of the database file.
+ */
+static int32_t
+bdb_do_readdir (call_frame_t *frame,
+                xlator_t *this,
+                fd_t *fd,
+                size_t size,
+                off_t off,
+                int whichop)
 {
+        struct bdb_private *private = NULL;
         struct bdb_dir *bfd        = NULL;
+        struct stat     db_stbuf   = {0,};
+        struct stat     stbuf      = {0,};
+        char           *db_path    = NULL;
+        char            entry_path[PATH_MAX] = {0,};
         int32_t         op_ret     = -1;
         int32_t         op_errno   = EINVAL;
         size_t          filled     = 0;
@@ -2807,6 +2821,8 @@ bdb_readdir (call_frame_t *frame,
 
         INIT_LIST_HEAD (&entries.list);
 
+        private = this->private;
+
         BDB_FCTX_GET (fd, this, &bfd);
         if (bfd == NULL) {
                 gf_log (this->name, GF_LOG_DEBUG,
@@ -2828,6 +2844,13 @@ bdb_readdir (call_frame_t *frame,
                 goto out;
         }
 
+        if (whichop == GF_FOP_READDIRP) {
+                MAKE_REAL_PATH_TO_STORAGE_DB (db_path, this,
+                                              bfd->ctx->directory);
+                /* ENOENT: no file created in here yet */
+                lstat (db_path, &db_stbuf);
+        }
+
         if (off) {
                 DBT sec = {0,}, pri = {0,}, val = {0,};
                 sec.data = &(off);
@@ -2851,9 +2874,15 @@ bdb_readdir (call_frame_t *frame,
 
                 sec.flags = DB_DBT_MALLOC;
                 pri.flags = DB_DBT_MALLOC;
-                val.dlen = 0;
-                val.doff = 0;
-                val.flags = DB_DBT_PARTIAL;
+                if (whichop == GF_FOP_READDIRP) {
+                        /* small files: the whole record is cheaper than a
+                         * second get for its size */
+                        val.flags = DB_DBT_MALLOC;
+                } else {
+                        val.dlen = 0;
+                        val.doff = 0;
+                        val.flags = DB_DBT_PARTIAL;
+                }
                 op_ret = bdb_cursor_get (cursorp, &sec, &pri, &val, DB_NEXT);
 
                 if (op_ret == DB_NOTFOUND) {
@@ -2881,8 +2910,11 @@ bdb_readdir (call_frame_t *frame,
                 }/* if(key.data)...else */
                 count++;
                 this_size = bdb_dirent_size (&pri);
-                if (this_size + filled > size)
+                if (this_size + filled > size) {
+                        if (val.data)
+                                free (val.data);
                         break;
+                }
                 /* TODO - consider endianness here */
                 this_entry = gf_dirent_for_namen ((const char *)pri.data,
                                                   pri.size);
@@ -2894,6 +2926,20 @@ bdb_readdir (call_frame_t *frame,
                 this_entry->d_type = 0;
                 this_entry->d_len = pri.size + 1;
 
+                if (whichop == GF_FOP_READDIRP) {
+                        stbuf = db_stbuf;
+                        stbuf.st_mode = private->file_mode;
+                        stbuf.st_size = val.size;
+                        stbuf.st_blocks = BDB_COUNT_BLOCKS (stbuf.st_size,
+                                                            stbuf.st_blksize);
+                        stbuf.st_ino = this_entry->d_ino;
+                        iatt_from_stat (&this_entry->d_stat, &stbuf);
+
+                        /* DB_DBT_MALLOC memory is libdb's malloc() */
+                        if (val.data)
+                                free (val.data);
+                }
+
                 if (sec.data) {
                         GF_FREE (sec.data);
                 }
@@ -2949,6 +2995,18 @@ dir_read:
                 this_entry->d_type = entry->d_type;
                 this_entry->d_len = entry->d_reclen;
 
+                if (whichop == GF_FOP_READDIRP) {
+                        snprintf (entry_path, sizeof (entry_path), "%s/%s",
+                                  bfd->path, entry->d_name);
+
+                        if (lstat (entry_path, &stbuf) == 0) {
+                                if (S_ISDIR (stbuf.st_mode))
+                                        stbuf.st_mode = private->dir_mode;
+                                else
+                                        stbuf.st_mode = private->symlink_mode;
+                                iatt_from_stat (&this_entry->d_stat, &stbuf);
+                        }
+                }
 
                 list_add_tail (&this_entry->list, &entries.list);
 
@@ -2972,6 +3030,30 @@ out:
 }
 
 
+int32_t
+bdb_readdir (call_frame_t *frame,
+             xlator_t *this,
+             fd_t *fd,
+             size_t size,
+             off_t off)
+{
+        bdb_do_readdir (frame, this, fd, size, off, GF_FOP_READDIR);
+        return 0;
+}
+
+
+int32_t
+bdb_readdirp (call_frame_t *frame,
+              xlator_t *this,
+              fd_t *fd,
+              size_t size,
+              off_t off)
+{
+        bdb_do_readdir (frame, this, fd, size, off, GF_FOP_READDIRP);
+        return 0;
+}
+
+
 int32_t
 bdb_stats (call_frame_t *frame,
            xlator_t *this,
@@ -3460,6 +3542,8 @@ fini (xlator_t *this)
                                         "operations");
                         }
 
+                        bdb_group_commit_fini (B_TABLE(this));
+
                         BDB_ENV(this)->close (BDB_ENV(this), 0);
                 } else {
                         /* impossible to reach here */
@@ -3477,6 +3561,7 @@ struct xlator_fops fops = {
         .stat        = bdb_stat,
         .opendir     = bdb_opendir,
         .readdir     = bdb_readdir,
+        .readdirp    = bdb_readdirp,
         .readlink    = bdb_readlink,
         .mknod       = bdb_mknod,
         .mkdir       = bdb_mkdir,
@@ -3552,12 +3637,34 @@ struct volume_options options[] = {
                          "block size of exported filesystem for "
                          "optimal performance"
         },
-        { .key  = { "open-db-lru-limit" },
+        { .key  = { "open-db-lru-limit", "lru-limit" },
           .type = GF_OPTION_TYPE_INT,
           .min  = 1,
-          .max  = 2048,
+          .max  = BDB_MAX_LRU_LIMIT,
           .description = "maximum number of per directory databases that can "
-                         "be kept open. NOTE: for _advanced_ users only."
+                         "be kept open. NOTE: for _advanced_ users only. "
+                         "when not given, it is derived from open-db-memory."
+        },
+        { .key  = { "open-db-memory" },
+          .type = GF_OPTION_TYPE_SIZET,
+          .description = "memory to spend on keeping unused per directory "
+                         "databases open. defaults to 1/32 of physical "
+                         "memory, at about 256KB a directory."
+        },
+        { .key  = { "group-commit" },
+          .type = GF_OPTION_TYPE_BOOL,
+          .description = "on: a transaction commit does not sync the log "
+                         "itself, one log flush makes the commits of all "
+                         "concurrent writers durable. the fop still returns "
+                         "only once its commit is on disk. valid only when "
+                         "'option mode=\"persistent\"' is set. default on."
+        },
+        { .key  = { "group-commit-window" },
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 100000,
+          .description = "microseconds a log flush waits for more commits "
+                         "to join it. default 500."
         },
         { .key  = { "lock-timeout" },
           .type = GF_OPTION_TYPE_TIME,
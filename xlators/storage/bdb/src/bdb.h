@@ -63,8 +63,20 @@
 #define ON  1
 #define OFF 0
 
-#define BDB_DEFAULT_LRU_LIMIT 100
-#define BDB_DEFAULT_HASH_SIZE 100
+/* unused open databases are kept in an lru of bctx_t. unless 'option
+ * open-db-lru-limit' is given, its limit is what 'option open-db-memory'
+ * (by default 1/BDB_OPEN_DB_MEMORY_SHARE of physical memory) can hold at
+ * BDB_OPEN_DB_COST bytes per directory, within BDB_DEFAULT_LRU_LIMIT and
+ * BDB_MAX_LRU_LIMIT. the hash of bctx_t is sized to match.
+ */
+#define BDB_DEFAULT_LRU_LIMIT    100
+#define BDB_MAX_LRU_LIMIT        65536
+#define BDB_OPEN_DB_MEMORY_SHARE 32
+#define BDB_OPEN_DB_COST         (256 * GF_UNIT_KB)
+
+/* microseconds the group commit thread waits for more commits to join
+ * the one that woke it up, before flushing the log */
+#define BDB_DEFAULT_GROUP_COMMIT_WINDOW 500
 
 #define BDB_ENOSPC_THRESHOLD 25600
 
@@ -251,6 +263,19 @@ struct bctx_table {
 
         /* page-size of DB, DB->set_pagesize(), should be set before DB->open */
         uint64_t            page_size;
+
+        /* group commit, see bdb_group_commit(). gc_requested counts the
+         * commits waiting to be made durable, gc_flushed how many of them
+         * a log flush covered */
+        char                group_commit;
+        char                gc_active;
+        uint32_t            gc_window;
+        uint64_t            gc_requested;
+        uint64_t            gc_flushed;
+        int32_t             gc_error;
+        pthread_mutex_t     gc_mutex;
+        pthread_cond_t      gc_cond;
+        pthread_t           gc_thread;
 };
 
 struct bdb_ctx {
@@ -407,6 +432,10 @@ struct bdb_private {
         /* DB_AUTO_LOG_REMOVE flag for DB_ENV*/
         uint32_t            log_auto_remove;
         uint32_t            log_region_max;
+
+        /* commit with DB_TXN_WRITE_NOSYNC and flush the log once for all
+         * concurrent writers (option group-commit on|off) */
+        gf_boolean_t        group_commit;
 };
 
 
@@ -475,6 +504,12 @@ int32_t
 bdb_db_iremove (struct bdb_ctx *bctx,
                 const char *key);
 
+int32_t
+bdb_group_commit (struct bctx_table *table);
+
+void
+bdb_group_commit_fini (struct bctx_table *table);
+
 ino_t
 bdb_inode_transform (ino_t parent,
                      const char *name,
@@ -0,0 +1,291 @@
+/*
+   Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+   This file is part of GlusterFS.
+
+   GlusterFS is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published
+   by the Free Software Foundation; either version 3 of the License,
+   or (at your option) any later version.
+
+   GlusterFS is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see
+   <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <limits.h>
+
+#include "glusterfs.h"
+#include "logging.h"
+#include "common-utils.h"
+#include "syscall.h"
+#include "posix.h"
+#include "posix-handle.h"
+
+
+static int
+posix_handle_mkdir_hashes (xlator_t *this, uuid_t gfid)
+{
+        struct posix_private *priv = NULL;
+        char                  path[PATH_MAX];
+        int                   ret = 0;
+
+        priv = this->private;
+
+        snprintf (path, sizeof (path), "%s/%s/%02x", priv->base_path,
+                  GF_HIDDEN_PATH, gfid[0]);
+        ret = mkdir (path, 0700);
+        if ((ret == -1) && (errno != EEXIST))
+                goto err;
+
+        snprintf (path, sizeof (path), "%s/%s/%02x/%02x", priv->base_path,
+                  GF_HIDDEN_PATH, gfid[0], gfid[1]);
+        ret = mkdir (path, 0700);
+        if ((ret == -1) && (errno != EEXIST))
+                goto err;
+
+        return 0;
+err:
+        gf_log (this->name, GF_LOG_ERROR,
+                "could not create handle directory %s: %s", path,
+                strerror (errno));
+        return -1;
+}
+
+
+int
+posix_handle_path (xlator_t *this, uuid_t gfid, char *buf, size_t len)
+{
+        struct posix_private *priv = NULL;
+
+        priv = this->private;
+
+        return snprintf (buf, len, "%s/%s/%02x/%02x/%s", priv->base_path,
+                         GF_HIDDEN_PATH, gfid[0], gfid[1], uuid_utoa (gfid));
+}
+
+
+/* turn "<gfid:uuid>[/rest]" into "<handle>[/rest]". @buf is sized by
+   MAKE_REAL_PATH(). Returns -1 when @path is not a gfid path, and the
+   caller then builds the plain <export>/path. */
+int
+posix_handle_real_path (xlator_t *this, const char *path, char *buf)
+{
+        struct posix_private *priv = NULL;
+        const char           *rest = NULL;
+        char                  uuid_str[40];
+        uuid_t                gfid = {0, };
+        uuid_t                dirgfid = {0, };
+        struct stat           st = {0, };
+        int                   len = 0;
+
+        priv = this->private;
+
+        if (!priv->gfid_handles || (path[0] != '<') || !POSIX_GFID_PATH (path))
+                return -1;
+
+        rest = path + strlen (INODE_GFID_PATH_PREFIX);
+        if ((strlen (rest) < 37) || (rest[36] != '>'))
+                return -1;
+
+        memcpy (uuid_str, rest, 36);
+        uuid_str[36] = '\0';
+        if (uuid_parse (uuid_str, gfid))
+                return -1;
+
+        rest += 37;
+
+        len = sprintf (buf, "%s/%s/%02x/%02x/%s", priv->base_path,
+                       GF_HIDDEN_PATH, gfid[0], gfid[1], uuid_str);
+        if (*rest) {
+                strcpy (buf + len, rest);
+                return 0;
+        }
+
+        /* a directory handle is a symlink, step through it so that the
+           lstat()s of the fops see the directory itself. A symlink
+           handle whose target merely is a directory keeps its own gfid
+           on the link, not on the target. */
+        if ((lstat (buf, &st) == 0) && S_ISLNK (st.st_mode)) {
+                strcpy (buf + len, "/.");
+                if ((sys_lgetxattr (buf, GFID_XATTR_KEY, dirgfid, 16) != 16)
+                    || uuid_compare (dirgfid, gfid))
+                        buf[len] = '\0';
+        }
+
+        return 0;
+}
+
+
+/* create the handle of the object just created or found at @loc. With
+   @replace, a directory handle pointing elsewhere is repointed (rename). */
+int
+posix_handle_create (xlator_t *this, const char *real_path, loc_t *loc,
+                     struct iatt *stbuf, int replace)
+{
+        struct posix_private *priv = NULL;
+        unsigned char        *pargfid = NULL;
+        char                  handle[PATH_MAX];
+        char                  target[PATH_MAX];
+        int                   ret = -1;
+
+        priv = this->private;
+
+        if (!priv->gfid_handles || uuid_is_null (stbuf->ia_gfid) ||
+            __is_root_gfid (stbuf->ia_gfid))
+                return 0;
+
+        pargfid = loc->parent ? loc->parent->gfid : loc->pargfid;
+
+        if (IA_ISDIR (stbuf->ia_type) &&
+            (uuid_is_null (pargfid) || !loc->name))
+                return -1;
+
+        ret = posix_handle_mkdir_hashes (this, stbuf->ia_gfid);
+        if (ret)
+                return -1;
+
+        posix_handle_path (this, stbuf->ia_gfid, handle, sizeof (handle));
+
+        if (!IA_ISDIR (stbuf->ia_type)) {
+                ret = link (real_path, handle);
+                if ((ret == -1) && (errno == EEXIST))
+                        return 0;
+                goto out;
+        }
+
+        snprintf (target, sizeof (target), "../../%02x/%02x/%s/%s",
+                  pargfid[0], pargfid[1], uuid_utoa (pargfid), loc->name);
+
+        ret = symlink (target, handle);
+        if ((ret == -1) && (errno == EEXIST)) {
+                if (!replace)
+                        return 0;
+
+                /* directory moved, repoint the handle at its new parent */
+                ret = unlink (handle);
+                if (ret == 0)
+                        ret = symlink (target, handle);
+        }
+out:
+        if (ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "could not create handle %s for %s: %s", handle,
+                        real_path, strerror (errno));
+                return -1;
+        }
+
+        LOCK (&priv->lock);
+        {
+                priv->handles_created++;
+        }
+        UNLOCK (&priv->lock);
+
+        return 0;
+}
+
+
+int
+posix_handle_unset (xlator_t *this, uuid_t gfid)
+{
+        struct posix_private *priv = NULL;
+        char                  handle[PATH_MAX];
+        int                   ret = 0;
+
+        priv = this->private;
+
+        if (!priv->gfid_handles || uuid_is_null (gfid))
+                return 0;
+
+        posix_handle_path (this, gfid, handle, sizeof (handle));
+
+        ret = unlink (handle);
+        if ((ret == -1) && (errno != ENOENT)) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "could not remove handle %s: %s", handle,
+                        strerror (errno));
+                return -1;
+        }
+
+        return 0;
+}
+
+
+/* the handle of a non-directory is one more hardlink to it. Take it out of
+   @stbuf->ia_nlink, so that the link count is the number of names again,
+   and return 1 if @st has a handle, 0 otherwise. */
+int
+posix_handle_nlink_hide (xlator_t *this, struct stat *st, struct iatt *stbuf)
+{
+        struct posix_private *priv = NULL;
+        char                  handle[PATH_MAX];
+        struct stat           hst = {0, };
+
+        priv = this->private;
+
+        if (!priv->gfid_handles || S_ISDIR (st->st_mode) ||
+            (st->st_nlink < 2) || uuid_is_null (stbuf->ia_gfid))
+                return 0;
+
+        posix_handle_path (this, stbuf->ia_gfid, handle, sizeof (handle));
+
+        /* a handle left behind by an earlier object with this gfid is not
+           one of our links */
+        if ((lstat (handle, &hst) == -1) || (hst.st_ino != st->st_ino) ||
+            (hst.st_dev != st->st_dev))
+                return 0;
+
+        stbuf->ia_nlink--;
+
+        return 1;
+}
+
+
+int
+posix_handle_init (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+        char                  path[PATH_MAX];
+        uuid_t                rootgfid = {0, };
+        int                   ret = 0;
+
+        priv = this->private;
+
+        snprintf (path, sizeof (path), "%s/%s", priv->base_path,
+                  GF_HIDDEN_PATH);
+        ret = mkdir (path, 0700);
+        if ((ret == -1) && (errno != EEXIST)) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "could not create %s: %s", path, strerror (errno));
+                return -1;
+        }
+
+        /* the root has no parent to point into, its handle leads back
+           to the export directory */
+        rootgfid[15] = 1;
+        ret = posix_handle_mkdir_hashes (this, rootgfid);
+        if (ret)
+                return -1;
+
+        posix_handle_path (this, rootgfid, path, sizeof (path));
+        ret = symlink ("../../..", path);
+        if ((ret == -1) && (errno != EEXIST)) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "could not create root handle %s: %s", path,
+                        strerror (errno));
+                return -1;
+        }
+
+        return 0;
+}
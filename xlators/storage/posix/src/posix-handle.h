@@ -0,0 +1,48 @@
+/*
+   Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+   This file is part of GlusterFS.
+
+   GlusterFS is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published
+   by the Free Software Foundation; either version 3 of the License,
+   or (at your option) any later version.
+
+   GlusterFS is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see
+   <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _POSIX_HANDLE_H
+#define _POSIX_HANDLE_H
+
+#include "xlator.h"
+#include "inode.h"
+#include "iatt.h"
+
+/* gfid handles live in <export>/.glusterfs/ab/cd/<gfid>: a hardlink for
+   everything but directories, a symlink to <parent handle>/<name> for
+   directories, so that a gfid alone reaches the object. */
+
+/* bytes MAKE_REAL_PATH() needs beyond base path + path for a gfid path:
+   "/.glusterfs/ab/cd/" + uuid + "/." + '\0' in place of "<gfid:uuid>" */
+#define POSIX_HANDLE_PATH_EXTRA 16
+
+#define POSIX_GFID_PATH(path)                                           \
+        (!strncmp (path, INODE_GFID_PATH_PREFIX,                        \
+                   strlen (INODE_GFID_PATH_PREFIX)))
+
+int posix_handle_init (xlator_t *this);
+int posix_handle_path (xlator_t *this, uuid_t gfid, char *buf, size_t len);
+int posix_handle_real_path (xlator_t *this, const char *path, char *buf);
+int posix_handle_create (xlator_t *this, const char *real_path, loc_t *loc,
+                         struct iatt *stbuf, int replace);
+int posix_handle_unset (xlator_t *this, uuid_t gfid);
+int posix_handle_nlink_hide (xlator_t *this, struct stat *st,
+                             struct iatt *stbuf);
+
+#endif /* !_POSIX_HANDLE_H */
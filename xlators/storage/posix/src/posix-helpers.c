@@ -57,15 +57,42 @@
 #include "hashfn.h"
 
 
+/* most xattr names lists and values fit in these, the rare larger ones
+   take an extra size query */
+#define POSIX_XATTR_LIST_SIZE   4096
+#define POSIX_XATTR_VALUE_SIZE  4096
+
 typedef struct {
         xlator_t    *this;
         const char  *real_path;
         dict_t      *xattr;
         struct iatt *stbuf;
         loc_t       *loc;
+        char        *list;       /* names present on the file */
+        ssize_t      list_size;  /* -1 if the list could not be fetched */
+        char        *valbuf;     /* scratch buffer reused for every key */
+        int          syscalls;   /* xattr syscalls issued for this lookup */
 } posix_xattr_filler_t;
 
 
+static gf_boolean_t
+posix_xattr_listed (posix_xattr_filler_t *filler, const char *key)
+{
+        ssize_t offset = 0;
+
+        if (filler->list_size < 0)
+                return _gf_true;
+
+        while (offset < filler->list_size) {
+                if (!strcmp (filler->list + offset, key))
+                        return _gf_true;
+                offset += strlen (filler->list + offset) + 1;
+        }
+
+        return _gf_false;
+}
+
+
 static void
 _posix_xattr_get_set (dict_t *xattr_req,
                       char *key,
@@ -155,24 +182,53 @@ _posix_xattr_get_set (dict_t *xattr_req,
                                         key);
                 }
         } else {
-                xattr_size = sys_lgetxattr (filler->real_path, key, NULL, 0);
+                /* keys the file does not carry cost no syscall at all */
+                if (!posix_xattr_listed (filler, key))
+                        return;
+
+                xattr_size = sys_lgetxattr (filler->real_path, key,
+                                            filler->valbuf,
+                                            POSIX_XATTR_VALUE_SIZE);
+                filler->syscalls++;
+
+                if ((xattr_size == -1) && (errno == ERANGE)) {
+                        xattr_size = sys_lgetxattr (filler->real_path, key,
+                                                    NULL, 0);
+                        filler->syscalls++;
+                        if (xattr_size <= 0)
+                                return;
 
-                if (xattr_size > 0) {
                         value = GF_CALLOC (1, xattr_size + 1,
                                            gf_posix_mt_char);
                         if (!value)
                                 return;
 
-                        sys_lgetxattr (filler->real_path, key, value,
-                                       xattr_size);
+                        xattr_size = sys_lgetxattr (filler->real_path, key,
+                                                    value, xattr_size);
+                        filler->syscalls++;
+                        if (xattr_size <= 0) {
+                                GF_FREE (value);
+                                return;
+                        }
+                } else if (xattr_size > 0) {
+                        value = GF_CALLOC (1, xattr_size + 1,
+                                           gf_posix_mt_char);
+                        if (!value)
+                                return;
 
+                        memcpy (value, filler->valbuf, xattr_size);
+                }
+
+                if (xattr_size > 0) {
                         value[xattr_size] = '\0';
                         ret = dict_set_bin (filler->xattr, key,
                                             value, xattr_size);
-                        if (ret < 0)
+                        if (ret < 0) {
                                 gf_log (filler->this->name, GF_LOG_DEBUG,
                                         "dict set failed. path: %s, key: %s",
                                         filler->real_path, key);
+                                GF_FREE (value);
+                        }
                 }
         }
 }
@@ -227,13 +283,17 @@ posix_fill_ino_from_gfid (xlator_t *this, struct iatt *buf)
         buf->ia_ino = temp_ino;
 }
 
+/* like posix_lstat_with_gfid(), and tells in @handled whether the entry has
+   a gfid handle, whose link is not counted in ia_nlink */
 int
-posix_lstat_with_gfid (xlator_t *this, const char *path, struct iatt *stbuf_p)
+posix_lstat_with_handle (xlator_t *this, const char *path,
+                         struct iatt *stbuf_p, int *handled)
 {
         struct posix_private  *priv    = NULL;
         int                    ret     = 0;
         struct stat            lstatbuf = {0, };
         struct iatt            stbuf = {0, };
+        int                    linked = 0;
 
         priv = this->private;
 
@@ -249,6 +309,10 @@ posix_lstat_with_gfid (xlator_t *this, const char *path, struct iatt *stbuf_p)
 
         posix_fill_ino_from_gfid (this, &stbuf);
 
+        linked = posix_handle_nlink_hide (this, &lstatbuf, &stbuf);
+        if (handled)
+                *handled = linked;
+
         if (stbuf_p)
                 *stbuf_p = stbuf;
 out:
@@ -256,6 +320,13 @@ out:
 }
 
 
+int
+posix_lstat_with_gfid (xlator_t *this, const char *path, struct iatt *stbuf_p)
+{
+        return posix_lstat_with_handle (this, path, stbuf_p, NULL);
+}
+
+
 int
 posix_fstat_with_gfid (xlator_t *this, int fd, struct iatt *stbuf_p)
 {
@@ -278,6 +349,8 @@ posix_fstat_with_gfid (xlator_t *this, int fd, struct iatt *stbuf_p)
 
         posix_fill_ino_from_gfid (this, &stbuf);
 
+        posix_handle_nlink_hide (this, &fstatbuf, &stbuf);
+
         if (stbuf_p)
                 *stbuf_p = stbuf;
 
@@ -292,6 +365,12 @@ posix_lookup_xattr_fill (xlator_t *this, const char *real_path, loc_t *loc,
 {
         dict_t     *xattr             = NULL;
         posix_xattr_filler_t filler   = {0, };
+        struct posix_private *priv    = NULL;
+        char        list[POSIX_XATTR_LIST_SIZE];
+        char        valbuf[POSIX_XATTR_VALUE_SIZE];
+        char       *biglist           = NULL;
+
+        priv = this->private;
 
         xattr = get_new_dict();
         if (!xattr) {
@@ -303,8 +382,45 @@ posix_lookup_xattr_fill (xlator_t *this, const char *real_path, loc_t *loc,
         filler.xattr     = xattr;
         filler.stbuf     = buf;
         filler.loc       = loc;
+        filler.valbuf    = valbuf;
+        filler.list_size = -1;
+
+#ifdef GF_LINUX_HOST_OS
+        /* fetch the names once so that only keys actually present on the
+           file are looked up, each with a single getxattr */
+        filler.list      = list;
+        filler.list_size = sys_llistxattr (real_path, list, sizeof (list));
+        filler.syscalls++;
+        if ((filler.list_size == -1) && (errno == ERANGE)) {
+                filler.list_size = sys_llistxattr (real_path, NULL, 0);
+                filler.syscalls++;
+                /* up to XATTR_LIST_MAX, too much for an io-thread stack */
+                if (filler.list_size > 0)
+                        biglist = GF_CALLOC (1, filler.list_size,
+                                             gf_posix_mt_char);
+                if (biglist) {
+                        filler.list = biglist;
+                        filler.list_size = sys_llistxattr (real_path,
+                                                           filler.list,
+                                                           filler.list_size);
+                        filler.syscalls++;
+                } else if (filler.list_size > 0) {
+                        filler.list_size = -1;
+                }
+        }
+#endif
 
         dict_foreach (xattr_req, _posix_xattr_get_set, &filler);
+
+        LOCK (&priv->lock);
+        {
+                priv->lookup_xattr_fills++;
+                priv->lookup_xattr_syscalls += filler.syscalls;
+        }
+        UNLOCK (&priv->lock);
+
+        if (biglist)
+                GF_FREE (biglist);
 out:
         return xattr;
 }
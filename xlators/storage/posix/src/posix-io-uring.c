@@ -0,0 +1,890 @@
+/*
+   Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+   This file is part of GlusterFS.
+
+   GlusterFS is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published
+   by the Free Software Foundation; either version 3 of the License,
+   or (at your option) any later version.
+
+   GlusterFS is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see
+   <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/sysmacros.h>
+
+#include "glusterfs.h"
+#include "xlator.h"
+#include "logging.h"
+#include "common-utils.h"
+#include "syscall.h"
+#include "posix.h"
+#include "posix-io-uring.h"
+
+#ifdef HAVE_LIBURING
+
+/* sqe data of an entry withdrawn after a failed submit, its completion is
+   dropped */
+static char posix_uring_withdrawn;
+
+/* the sqes a fop queues: the I/O itself, the fsync of 'option flush-writes'
+   linked behind a write, and the statx giving the post-op attributes */
+enum posix_uring_part_kind {
+        POSIX_URING_IO = 0,
+        POSIX_URING_FLUSH,
+        POSIX_URING_STAT,
+        POSIX_URING_MAXPART,
+};
+
+struct posix_uring_cb;
+
+struct posix_uring_part {
+        struct posix_uring_cb *cb;
+        int                    queued;
+        int                    res;
+};
+
+struct posix_uring_cb {
+        call_frame_t   *frame;
+        xlator_t       *this;
+        fd_t           *fd;
+        int             _fd;
+        glusterfs_fop_t op;
+        off_t           offset;
+        size_t          size;
+        int             flushwrites;
+        int             datasync;
+        struct iovec   *vector;   /* private copy of the caller's iovec */
+        int             count;
+        struct iobuf   *iobuf;
+        struct iobref  *iobref;
+        struct iatt     prebuf;
+        int             pending;  /* completions still to come */
+        struct posix_uring_part part[POSIX_URING_MAXPART];
+        struct statx    stx;
+};
+
+
+static struct posix_uring_cb *
+posix_uring_cb_new (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                    glusterfs_fop_t op)
+{
+        struct posix_uring_cb *cb      = NULL;
+        struct posix_fd       *pfd     = NULL;
+        uint64_t               tmp_pfd = 0;
+        int                    ret     = -1;
+        int                    i       = 0;
+
+        ret = fd_ctx_get (fd, this, &tmp_pfd);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pfd is NULL from fd=%p", fd);
+                return NULL;
+        }
+        pfd = (struct posix_fd *)(long)tmp_pfd;
+
+        /* the O_DIRECT write path needs aligned bounce buffers, which
+           only the synchronous code knows how to do */
+        if ((op == GF_FOP_WRITE) && (pfd->flags & O_DIRECT))
+                return NULL;
+
+        cb = GF_CALLOC (1, sizeof (*cb), gf_posix_mt_io_uring_cb);
+        if (!cb)
+                return NULL;
+
+        cb->frame       = frame;
+        cb->this        = this;
+        cb->fd          = fd_ref (fd);
+        cb->_fd         = pfd->fd;
+        cb->op          = op;
+        cb->flushwrites = pfd->flushwrites;
+
+        for (i = 0; i < POSIX_URING_MAXPART; i++)
+                cb->part[i].cb = cb;
+
+        return cb;
+}
+
+
+static void
+posix_uring_cb_destroy (struct posix_uring_cb *cb)
+{
+        if (!cb)
+                return;
+
+        if (cb->fd)
+                fd_unref (cb->fd);
+        if (cb->iobuf)
+                iobuf_unref (cb->iobuf);
+        if (cb->iobref)
+                iobref_unref (cb->iobref);
+        if (cb->vector)
+                GF_FREE (cb->vector);
+
+        GF_FREE (cb);
+}
+
+
+/* fill @sqe for part @kind of @cb, linking it to the next sqe if @link */
+static void
+posix_uring_part_prep (struct io_uring_sqe *sqe, struct posix_uring_cb *cb,
+                       int kind, int link)
+{
+        struct posix_uring_part *part = NULL;
+
+        part = &cb->part[kind];
+
+        switch (kind) {
+        case POSIX_URING_FLUSH:
+                io_uring_prep_fsync (sqe, cb->_fd, 0);
+                break;
+        case POSIX_URING_STAT:
+                io_uring_prep_statx (sqe, cb->_fd, "", AT_EMPTY_PATH,
+                                     STATX_BASIC_STATS, &cb->stx);
+                break;
+        }
+
+        if (link)
+                io_uring_sqe_set_flags (sqe, IOSQE_IO_LINK);
+        io_uring_sqe_set_data (sqe, part);
+
+        part->queued = 1;
+        part->res    = -ECANCELED;
+        cb->pending++;
+}
+
+
+/* queue the I/O of @cb, which @prep fills in, followed by the fsync of
+   'option flush-writes' when @flush and the post-op statx when @stat. The
+   followers are linked behind the I/O when @link, so that they see its
+   result. Returns 0 once queued, 1 if the ring is full even after flushing
+   or is being torn down (the caller runs the synchronous fop instead), or
+   -errno if the kernel refused the submit (the caller unwinds with it). */
+static int
+posix_uring_submit (xlator_t *this, struct posix_uring_cb *cb,
+                    void (*prep) (struct io_uring_sqe *,
+                                  struct posix_uring_cb *),
+                    int flush, int link)
+{
+        struct posix_private *priv = NULL;
+        struct io_uring_sqe  *sqe[POSIX_URING_MAXPART] = {NULL, };
+        int                   kinds[POSIX_URING_MAXPART] = {0, };
+        int                   nsqe = 0;
+        int                   i    = 0;
+        int                   ret  = 1;
+
+        priv = this->private;
+
+        kinds[nsqe++] = POSIX_URING_IO;
+        if (flush)
+                kinds[nsqe++] = POSIX_URING_FLUSH;
+        if (priv->io_uring_statx)
+                kinds[nsqe++] = POSIX_URING_STAT;
+
+        LOCK (&priv->io_uring_lock);
+        {
+                if (!priv->io_uring_capable)
+                        goto unlock;
+
+                if (io_uring_sq_space_left (&priv->ring) < nsqe)
+                        io_uring_submit (&priv->ring);
+                if (io_uring_sq_space_left (&priv->ring) < nsqe) {
+                        priv->io_uring_fallbacks++;
+                        goto unlock;
+                }
+
+                for (i = 0; i < nsqe; i++)
+                        sqe[i] = io_uring_get_sqe (&priv->ring);
+
+                prep (sqe[0], cb);
+                for (i = 0; i < nsqe; i++)
+                        posix_uring_part_prep (sqe[i], cb, kinds[i],
+                                               link && (i < nsqe - 1));
+
+                ret = io_uring_submit (&priv->ring);
+                if (ret < 0) {
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "io_uring_submit failed: %s",
+                                strerror (-ret));
+                        /* the kernel has not consumed the sqes yet, turn
+                           them into NOPs so that they cannot complete @cb
+                           once the caller has unwound and freed it */
+                        for (i = 0; i < nsqe; i++) {
+                                io_uring_prep_nop (sqe[i]);
+                                io_uring_sqe_set_data (sqe[i],
+                                                       &posix_uring_withdrawn);
+                        }
+                        goto unlock;
+                }
+                ret = 0;
+                priv->io_uring_submitted++;
+        }
+unlock:
+        UNLOCK (&priv->io_uring_lock);
+
+        return ret;
+}
+
+
+/* post-op attributes of @cb: from the statx queued with the I/O when it
+   went through, otherwise (no statx support, or the link was broken by a
+   short write) from a synchronous fstat */
+static int
+posix_uring_poststat (struct posix_uring_cb *cb, struct iatt *buf)
+{
+        xlator_t       *this = NULL;
+        struct statx   *stx  = NULL;
+        struct stat     st   = {0, };
+        inode_t        *inode = NULL;
+
+        this = cb->this;
+
+        if (!cb->part[POSIX_URING_STAT].queued ||
+            (cb->part[POSIX_URING_STAT].res < 0))
+                return posix_fstat_with_gfid (this, cb->_fd, buf);
+
+        stx = &cb->stx;
+
+        st.st_dev          = makedev (stx->stx_dev_major, stx->stx_dev_minor);
+        st.st_ino          = stx->stx_ino;
+        st.st_mode         = stx->stx_mode;
+        st.st_nlink        = stx->stx_nlink;
+        st.st_uid          = stx->stx_uid;
+        st.st_gid          = stx->stx_gid;
+        st.st_rdev         = makedev (stx->stx_rdev_major,
+                                      stx->stx_rdev_minor);
+        st.st_size         = stx->stx_size;
+        st.st_blksize      = stx->stx_blksize;
+        st.st_blocks       = stx->stx_blocks;
+        st.st_atim.tv_sec  = stx->stx_atime.tv_sec;
+        st.st_atim.tv_nsec = stx->stx_atime.tv_nsec;
+        st.st_mtim.tv_sec  = stx->stx_mtime.tv_sec;
+        st.st_mtim.tv_nsec = stx->stx_mtime.tv_nsec;
+        st.st_ctim.tv_sec  = stx->stx_ctime.tv_sec;
+        st.st_ctim.tv_nsec = stx->stx_ctime.tv_nsec;
+
+        iatt_from_stat (buf, &st);
+
+        /* the gfid of an open fd cannot change, take the one the inode
+           was linked with instead of reading the xattr again */
+        inode = cb->fd->inode;
+        if (inode && !uuid_is_null (inode->gfid))
+                uuid_copy (buf->ia_gfid, inode->gfid);
+        else
+                posix_fill_gfid_fd (this, cb->_fd, buf);
+
+        posix_fill_ino_from_gfid (this, buf);
+        posix_handle_nlink_hide (this, &st, buf);
+
+        return 0;
+}
+
+
+static void
+posix_uring_readv_prep (struct io_uring_sqe *sqe, struct posix_uring_cb *cb)
+{
+        io_uring_prep_read (sqe, cb->_fd, cb->iobuf->ptr, cb->size,
+                            cb->offset);
+}
+
+
+static void
+posix_uring_readv_complete (struct posix_uring_cb *cb, int res)
+{
+        xlator_t             *this     = NULL;
+        struct posix_private *priv     = NULL;
+        struct iovec          vec      = {0,};
+        struct iatt           stbuf    = {0,};
+        struct iobref        *iobref   = NULL;
+        int32_t               op_ret   = -1;
+        int32_t               op_errno = 0;
+
+        DECLARE_OLD_FS_ID_VAR;
+
+        this = cb->this;
+        priv = this->private;
+
+        SET_FS_ID (cb->frame->root->uid, cb->frame->root->gid);
+
+        if (res < 0) {
+                op_errno = -res;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "read failed on fd=%p: %s", cb->fd,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        LOCK (&priv->lock);
+        {
+                priv->read_value += res;
+        }
+        UNLOCK (&priv->lock);
+
+        vec.iov_base = cb->iobuf->ptr;
+        vec.iov_len  = res;
+
+        iobref = iobref_new ();
+        if (!iobref) {
+                op_errno = ENOMEM;
+                goto out;
+        }
+        iobref_add (iobref, cb->iobuf);
+
+        op_ret = posix_uring_poststat (cb, &stbuf);
+        if (op_ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "fstat failed on fd=%p: %s", cb->fd,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        /* Hack to notify higher layers of EOF. */
+        if (stbuf.ia_size == 0)
+                op_errno = ENOENT;
+        else if ((cb->offset + vec.iov_len) == stbuf.ia_size)
+                op_errno = ENOENT;
+        else if (cb->offset > stbuf.ia_size)
+                op_errno = ENOENT;
+
+        op_ret = vec.iov_len;
+out:
+        SET_TO_OLD_FS_ID ();
+
+        STACK_UNWIND_STRICT (readv, cb->frame, op_ret, op_errno,
+                             &vec, 1, &stbuf, iobref);
+
+        if (iobref)
+                iobref_unref (iobref);
+}
+
+
+int32_t
+posix_io_uring_readv (call_frame_t *frame, xlator_t *this,
+                      fd_t *fd, size_t size, off_t offset)
+{
+        struct posix_uring_cb *cb  = NULL;
+        int                    ret = -1;
+
+        if (!size)
+                goto sync;
+
+        cb = posix_uring_cb_new (frame, this, fd, GF_FOP_READ);
+        if (!cb)
+                goto sync;
+
+        cb->iobuf = iobuf_get (this->ctx->iobuf_pool);
+        if (!cb->iobuf)
+                goto sync;
+
+        cb->size   = min (size, this->ctx->page_size);
+        cb->offset = offset;
+
+        /* the statx needs not wait for the read, and a short read at EOF
+           would cancel it if it did */
+        ret = posix_uring_submit (this, cb, posix_uring_readv_prep, 0, 0);
+        if (ret > 0)
+                goto sync;
+        if (ret < 0) {
+                STACK_UNWIND_STRICT (readv, frame, -1, -ret,
+                                     NULL, 0, NULL, NULL);
+                posix_uring_cb_destroy (cb);
+        }
+        return 0;
+sync:
+        posix_uring_cb_destroy (cb);
+        return -1;
+}
+
+
+static void
+posix_uring_writev_prep (struct io_uring_sqe *sqe, struct posix_uring_cb *cb)
+{
+        io_uring_prep_writev (sqe, cb->_fd, cb->vector, cb->count,
+                              cb->offset);
+}
+
+
+static void
+posix_uring_writev_complete (struct posix_uring_cb *cb, int res)
+{
+        xlator_t             *this     = NULL;
+        struct posix_private *priv     = NULL;
+        struct iatt           postbuf  = {0,};
+        int32_t               op_ret   = -1;
+        int32_t               op_errno = 0;
+        int                   idx      = 0;
+        size_t                skip     = 0;
+        int                   retval   = 0;
+
+        DECLARE_OLD_FS_ID_VAR;
+
+        this = cb->this;
+        priv = this->private;
+
+        SET_FS_ID (cb->frame->root->uid, cb->frame->root->gid);
+
+        if (res < 0) {
+                op_errno = -res;
+                gf_log (this->name, GF_LOG_ERROR, "write failed: offset %"
+                        PRIu64", %s", cb->offset, strerror (op_errno));
+                goto out;
+        }
+
+        if (res < cb->size) {
+                /* short write: push the remainder out synchronously, as
+                   __posix_pwritev would have done. It broke the link, so
+                   the queued fsync and statx were cancelled. */
+                skip = res;
+                for (idx = 0; idx < cb->count; idx++) {
+                        if (skip >= cb->vector[idx].iov_len) {
+                                skip -= cb->vector[idx].iov_len;
+                                continue;
+                        }
+                        cb->vector[idx].iov_base += skip;
+                        cb->vector[idx].iov_len  -= skip;
+                        break;
+                }
+
+                retval = __posix_pwritev (cb->_fd, &cb->vector[idx],
+                                          cb->count - idx,
+                                          cb->offset + res);
+                if (retval < 0) {
+                        op_errno = -retval;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "write failed: offset %"PRIu64", %s",
+                                cb->offset + res, strerror (op_errno));
+                        goto out;
+                }
+                res += retval;
+
+                if (cb->flushwrites) {
+                        /* NOTE: ignore the error, if one occurs at this
+                           point */
+                        fsync (cb->_fd);
+                }
+        }
+
+        LOCK (&priv->lock);
+        {
+                priv->write_value += res;
+        }
+        UNLOCK (&priv->lock);
+
+        op_ret = posix_uring_poststat (cb, &postbuf);
+        if (op_ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "post-operation fstat failed on fd=%p: %s",
+                        cb->fd, strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = res;
+out:
+        SET_TO_OLD_FS_ID ();
+
+        STACK_UNWIND_STRICT (writev, cb->frame, op_ret, op_errno,
+                             &cb->prebuf, &postbuf);
+}
+
+
+int32_t
+posix_io_uring_writev (call_frame_t *frame, xlator_t *this,
+                       fd_t *fd, struct iovec *vector, int32_t count,
+                       off_t offset, struct iobref *iobref)
+{
+        struct posix_uring_cb *cb  = NULL;
+        int                    ret = -1;
+
+        if (!vector)
+                goto sync;
+
+        cb = posix_uring_cb_new (frame, this, fd, GF_FOP_WRITE);
+        if (!cb)
+                goto sync;
+
+        if (posix_fstat_with_gfid (this, cb->_fd, &cb->prebuf) == -1)
+                goto sync;
+
+        /* the caller is free to release its iovec and iobref once we
+           return, but the kernel reads them until completion */
+        cb->vector = iov_dup (vector, count);
+        if (!cb->vector)
+                goto sync;
+
+        cb->count  = count;
+        cb->size   = iov_length (vector, count);
+        cb->offset = offset;
+        if (iobref)
+                cb->iobref = iobref_ref (iobref);
+
+        /* errors of the fsync of 'option flush-writes' are ignored, as
+           in the synchronous writev */
+        ret = posix_uring_submit (this, cb, posix_uring_writev_prep,
+                                  cb->flushwrites, 1);
+        if (ret > 0)
+                goto sync;
+        if (ret < 0) {
+                STACK_UNWIND_STRICT (writev, frame, -1, -ret, NULL, NULL);
+                posix_uring_cb_destroy (cb);
+        }
+        return 0;
+sync:
+        posix_uring_cb_destroy (cb);
+        return -1;
+}
+
+
+static void
+posix_uring_fsync_prep (struct io_uring_sqe *sqe, struct posix_uring_cb *cb)
+{
+        io_uring_prep_fsync (sqe, cb->_fd,
+                             cb->datasync ? IORING_FSYNC_DATASYNC : 0);
+}
+
+
+static void
+posix_uring_fsync_complete (struct posix_uring_cb *cb, int res)
+{
+        xlator_t    *this     = NULL;
+        struct iatt  postbuf  = {0,};
+        int32_t      op_ret   = -1;
+        int32_t      op_errno = 0;
+
+        DECLARE_OLD_FS_ID_VAR;
+
+        this = cb->this;
+
+        SET_FS_ID (cb->frame->root->uid, cb->frame->root->gid);
+
+        if (res < 0) {
+                op_errno = -res;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "%s on fd=%p failed: %s",
+                        cb->datasync ? "fdatasync" : "fsync",
+                        cb->fd, strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = posix_uring_poststat (cb, &postbuf);
+        if (op_ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_WARNING,
+                        "post-operation fstat failed on fd=%p: %s",
+                        cb->fd, strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = 0;
+out:
+        SET_TO_OLD_FS_ID ();
+
+        STACK_UNWIND_STRICT (fsync, cb->frame, op_ret, op_errno,
+                             &cb->prebuf, &postbuf);
+}
+
+
+int32_t
+posix_io_uring_fsync (call_frame_t *frame, xlator_t *this,
+                      fd_t *fd, int32_t datasync)
+{
+        struct posix_uring_cb *cb  = NULL;
+        int                    ret = -1;
+
+        cb = posix_uring_cb_new (frame, this, fd, GF_FOP_FSYNC);
+        if (!cb)
+                goto sync;
+
+        if (posix_fstat_with_gfid (this, cb->_fd, &cb->prebuf) == -1)
+                goto sync;
+
+        cb->datasync = datasync;
+
+        ret = posix_uring_submit (this, cb, posix_uring_fsync_prep, 0, 1);
+        if (ret > 0)
+                goto sync;
+        if (ret < 0) {
+                STACK_UNWIND_STRICT (fsync, frame, -1, -ret, NULL, NULL);
+                posix_uring_cb_destroy (cb);
+        }
+        return 0;
+sync:
+        posix_uring_cb_destroy (cb);
+        return -1;
+}
+
+
+static void *
+posix_io_uring_thread_proc (void *data)
+{
+        xlator_t                *this = NULL;
+        struct posix_private    *priv = NULL;
+        struct io_uring_cqe     *cqe  = NULL;
+        struct posix_uring_cb   *cb   = NULL;
+        struct posix_uring_part *part = NULL;
+        void                    *udata = NULL;
+        int                      ret  = 0;
+
+        this = data;
+        priv = this->private;
+
+        THIS = this;
+
+        for (;;) {
+                ret = io_uring_wait_cqe (&priv->ring, &cqe);
+                if (ret < 0) {
+                        if (ret == -EINTR)
+                                continue;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "io_uring_wait_cqe failed: %s",
+                                strerror (-ret));
+                        break;
+                }
+
+                udata = io_uring_cqe_get_data (cqe);
+                if (udata && (udata != (void *)&posix_uring_withdrawn)) {
+                        part = udata;
+                        part->res = cqe->res;
+                }
+                io_uring_cqe_seen (&priv->ring, cqe);
+
+                /* a NOP without a callback is the shutdown marker, it is
+                   drained behind everything queued before it */
+                if (!udata)
+                        break;
+                if (udata == (void *)&posix_uring_withdrawn)
+                        continue;
+
+                cb = part->cb;
+                if (--cb->pending > 0)
+                        continue;
+
+                ret = cb->part[POSIX_URING_IO].res;
+
+                switch (cb->op) {
+                case GF_FOP_READ:
+                        posix_uring_readv_complete (cb, ret);
+                        break;
+                case GF_FOP_WRITE:
+                        posix_uring_writev_complete (cb, ret);
+                        break;
+                case GF_FOP_FSYNC:
+                        posix_uring_fsync_complete (cb, ret);
+                        break;
+                default:
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "unexpected fop %d completed", cb->op);
+                        break;
+                }
+
+                posix_uring_cb_destroy (cb);
+
+                LOCK (&priv->io_uring_lock);
+                {
+                        priv->io_uring_completed++;
+                }
+                UNLOCK (&priv->io_uring_lock);
+        }
+
+        return NULL;
+}
+
+
+static int
+posix_io_uring_init (xlator_t *this)
+{
+        struct posix_private *priv  = NULL;
+        struct io_uring_probe *probe = NULL;
+        int                   ret   = -1;
+
+        priv = this->private;
+
+        ret = io_uring_queue_init (priv->io_uring_depth, &priv->ring, 0);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "io_uring_queue_init (depth %u) failed: %s",
+                        priv->io_uring_depth, strerror (-ret));
+                return -1;
+        }
+
+        /* without IORING_OP_STATX (before 5.6) the post-op attributes are
+           fetched with a plain fstat on the completion thread */
+        priv->io_uring_statx = _gf_false;
+        probe = io_uring_get_probe_ring (&priv->ring);
+        if (probe) {
+                if (io_uring_opcode_supported (probe, IORING_OP_STATX))
+                        priv->io_uring_statx = _gf_true;
+                io_uring_free_probe (probe);
+        }
+        if (!priv->io_uring_statx)
+                gf_log (this->name, GF_LOG_INFO,
+                        "io_uring cannot statx, post-op attributes are "
+                        "read synchronously");
+
+        ret = pthread_create (&priv->io_uring_thread, NULL,
+                              posix_io_uring_thread_proc, this);
+        if (ret != 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "spawning io_uring completion thread failed: %s",
+                        strerror (ret));
+                io_uring_queue_exit (&priv->ring);
+                return -1;
+        }
+
+        priv->io_uring_capable = _gf_true;
+
+        return 0;
+}
+
+
+static void
+posix_io_uring_fini (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+        struct io_uring_sqe  *sqe  = NULL;
+        uint64_t              inflight = 0;
+
+        priv = this->private;
+
+        LOCK (&priv->io_uring_lock);
+        {
+                /* fops arriving from now on are served synchronously */
+                priv->io_uring_capable = _gf_false;
+
+                sqe = io_uring_get_sqe (&priv->ring);
+                if (!sqe) {
+                        io_uring_submit (&priv->ring);
+                        sqe = io_uring_get_sqe (&priv->ring);
+                }
+                if (sqe) {
+                        /* completions are not ordered, the drain flag holds
+                           the marker back until everything queued before
+                           it has completed */
+                        io_uring_prep_nop (sqe);
+                        io_uring_sqe_set_flags (sqe, IOSQE_IO_DRAIN);
+                        io_uring_sqe_set_data (sqe, NULL);
+                        if (io_uring_submit (&priv->ring) < 0)
+                                sqe = NULL;
+                }
+        }
+        UNLOCK (&priv->io_uring_lock);
+
+        if (sqe) {
+                pthread_join (priv->io_uring_thread, NULL);
+        } else {
+                /* no marker could be queued, wait for the fops in flight
+                   to be unwound before pulling the ring from under them */
+                for (;;) {
+                        LOCK (&priv->io_uring_lock);
+                        {
+                                inflight = priv->io_uring_submitted -
+                                        priv->io_uring_completed;
+                        }
+                        UNLOCK (&priv->io_uring_lock);
+
+                        if (!inflight)
+                                break;
+                        usleep (10000);
+                }
+                pthread_cancel (priv->io_uring_thread);
+                pthread_join (priv->io_uring_thread, NULL);
+        }
+
+        io_uring_queue_exit (&priv->ring);
+}
+
+
+int
+posix_io_uring_on (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+
+        priv = this->private;
+
+        if (!priv->io_uring_capable && posix_io_uring_init (this) != 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "io_uring unavailable, using synchronous I/O");
+                return -1;
+        }
+
+        gf_log (this->name, GF_LOG_INFO,
+                "io_uring enabled (queue depth %u)", priv->io_uring_depth);
+
+        return 0;
+}
+
+
+int
+posix_io_uring_off (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+
+        priv = this->private;
+
+        if (priv->io_uring_capable)
+                posix_io_uring_fini (this);
+
+        return 0;
+}
+
+#else /* !HAVE_LIBURING */
+
+int
+posix_io_uring_on (xlator_t *this)
+{
+        gf_log (this->name, GF_LOG_WARNING,
+                "io_uring not supported in this build, "
+                "using synchronous I/O");
+
+        return -1;
+}
+
+
+int
+posix_io_uring_off (xlator_t *this)
+{
+        return 0;
+}
+
+
+int32_t
+posix_io_uring_readv (call_frame_t *frame, xlator_t *this,
+                      fd_t *fd, size_t size, off_t offset)
+{
+        return -1;
+}
+
+
+int32_t
+posix_io_uring_writev (call_frame_t *frame, xlator_t *this,
+                       fd_t *fd, struct iovec *vector, int32_t count,
+                       off_t offset, struct iobref *iobref)
+{
+        return -1;
+}
+
+
+int32_t
+posix_io_uring_fsync (call_frame_t *frame, xlator_t *this,
+                      fd_t *fd, int32_t datasync)
+{
+        return -1;
+}
+
+#endif /* HAVE_LIBURING */
@@ -0,0 +1,39 @@
+/*
+   Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+   This file is part of GlusterFS.
+
+   GlusterFS is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published
+   by the Free Software Foundation; either version 3 of the License,
+   or (at your option) any later version.
+
+   GlusterFS is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see
+   <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _POSIX_IO_URING_H
+#define _POSIX_IO_URING_H
+
+#include "xlator.h"
+
+int posix_io_uring_on (xlator_t *this);
+int posix_io_uring_off (xlator_t *this);
+
+/* called by the posix fops while priv->io_uring_capable is set. Return 0
+   when the fop was taken (queued, or unwound with an error), -1 when the
+   caller has to serve it synchronously. */
+int32_t posix_io_uring_readv (call_frame_t *frame, xlator_t *this,
+                              fd_t *fd, size_t size, off_t offset);
+int32_t posix_io_uring_writev (call_frame_t *frame, xlator_t *this,
+                               fd_t *fd, struct iovec *vector, int32_t count,
+                               off_t offset, struct iobref *iobref);
+int32_t posix_io_uring_fsync (call_frame_t *frame, xlator_t *this,
+                              fd_t *fd, int32_t datasync);
+
+#endif /* !_POSIX_IO_URING_H */
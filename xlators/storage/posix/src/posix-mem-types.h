@@ -30,6 +30,7 @@ enum gf_posix_mem_types_ {
         gf_posix_mt_int32_t,
         gf_posix_mt_posix_dev_t,
         gf_posix_mt_trash_path,
+        gf_posix_mt_io_uring_cb,
         gf_posix_mt_end
 };
 #endif
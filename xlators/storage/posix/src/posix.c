@@ -37,9 +37,9 @@
 #include <alloca.h>
 #endif /* GF_BSD_HOST_OS */
 
-#ifdef HAVE_LINKAT
+#if defined(HAVE_LINKAT) || defined(HAVE_FALLOCATE)
 #include <fcntl.h>
-#endif /* HAVE_LINKAT */
+#endif /* HAVE_LINKAT || HAVE_FALLOCATE */
 
 #include "glusterfs.h"
 #include "md5.h"
@@ -47,6 +47,7 @@
 #include "dict.h"
 #include "logging.h"
 #include "posix.h"
+#include "posix-io-uring.h"
 #include "xlator.h"
 #include "defaults.h"
 #include "common-utils.h"
@@ -60,30 +61,6 @@
 #include "glusterfs3-xdr.h"
 #include "hashfn.h"
 
-
-#undef HAVE_SET_FSID
-#ifdef HAVE_SET_FSID
-
-#define DECLARE_OLD_FS_ID_VAR uid_t old_fsuid; gid_t old_fsgid;
-
-#define SET_FS_ID(uid, gid) do {                \
-                old_fsuid = setfsuid (uid);     \
-                old_fsgid = setfsgid (gid);     \
-        } while (0)
-
-#define SET_TO_OLD_FS_ID() do {                 \
-                setfsuid (old_fsuid);           \
-                setfsgid (old_fsgid);           \
-        } while (0)
-
-#else
-
-#define DECLARE_OLD_FS_ID_VAR
-#define SET_FS_ID(uid, gid)
-#define SET_TO_OLD_FS_ID()
-
-#endif
-
 int
 posix_forget (xlator_t *this, inode_t *inode)
 {
@@ -109,21 +86,49 @@ posix_lookup (call_frame_t *frame, xlator_t *this,
         char *      pathdup            = NULL;
         char *      parentpath         = NULL;
         struct iatt postparent         = {0,};
+        struct posix_private *priv     = NULL;
+        int         nameless           = 0;
 
         VALIDATE_OR_GOTO (frame, out);
         VALIDATE_OR_GOTO (this, out);
         VALIDATE_OR_GOTO (loc, out);
         VALIDATE_OR_GOTO (loc->path, out);
 
+        priv = this->private;
+
         MAKE_REAL_PATH (real_path, this, loc->path);
 
-        posix_gfid_set (this, real_path, xattr_req);
+        /* nameless lookup: only the gfid is known, reached through its
+           handle */
+        nameless = (!loc->parent && POSIX_GFID_PATH (loc->path));
+
+        if (!nameless)
+                posix_gfid_set (this, real_path, xattr_req);
 
         op_ret   = posix_lstat_with_gfid (this, real_path, &buf);
         op_errno = errno;
 
+        if (nameless) {
+                if ((op_ret == 0) && !uuid_is_null (loc->gfid) &&
+                    uuid_compare (loc->gfid, buf.ia_gfid)) {
+                        /* handle points at another object by now */
+                        op_ret   = -1;
+                        op_errno = ESTALE;
+                } else if ((op_ret == -1) && (op_errno == ENOENT)) {
+                        op_errno = ESTALE;
+                }
+
+                LOCK (&priv->lock);
+                {
+                        priv->nameless_lookups++;
+                        if (op_ret == -1)
+                                priv->nameless_misses++;
+                }
+                UNLOCK (&priv->lock);
+        }
+
         if (op_ret == -1) {
-                if (op_errno != ENOENT) {
+                if ((op_errno != ENOENT) && (op_errno != ESTALE)) {
                         gf_log (this->name, GF_LOG_ERROR,
                                 "lstat on %s failed: %s",
                                 loc->path, strerror (op_errno));
@@ -133,6 +138,10 @@ posix_lookup (call_frame_t *frame, xlator_t *this,
                 goto parent;
         }
 
+        /* first lookup of an entry that predates its handle */
+        if (!nameless && loc->inode && uuid_is_null (loc->inode->gfid))
+                posix_handle_create (this, real_path, loc, &buf, 0);
+
         if (xattr_req && (op_ret == 0)) {
                 xattr = posix_lookup_xattr_fill (this, real_path, loc,
                                                  xattr_req, &buf);
@@ -852,6 +861,8 @@ posix_mknod (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        posix_handle_create (this, real_path, loc, &stbuf, 0);
+
         op_ret = posix_lstat_with_gfid (this, parentpath, &postparent);
         if (op_ret == -1) {
                 op_errno = errno;
@@ -985,6 +996,8 @@ posix_mkdir (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        posix_handle_create (this, real_path, loc, &stbuf, 0);
+
         op_ret = posix_lstat_with_gfid (this, parentpath, &postparent);
         if (op_ret == -1) {
                 op_errno = errno;
@@ -1026,6 +1039,8 @@ posix_unlink (call_frame_t *frame, xlator_t *this,
         struct posix_private    *priv      = NULL;
         struct iatt            preparent = {0,};
         struct iatt            postparent = {0,};
+        struct iatt            stbuf = {0,};
+        int                    handled = 0;
 
         DECLARE_OLD_FS_ID_VAR;
 
@@ -1052,6 +1067,9 @@ posix_unlink (call_frame_t *frame, xlator_t *this,
         }
 
         priv = this->private;
+        if (priv->gfid_handles)
+                posix_lstat_with_handle (this, real_path, &stbuf, &handled);
+
         if (priv->background_unlink) {
                 if (IA_ISREG (loc->inode->ia_type)) {
                         fd = open (real_path, O_RDONLY);
@@ -1075,6 +1093,10 @@ posix_unlink (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        /* the last name is gone, only the handle links the inode now */
+        if (handled && (stbuf.ia_nlink == 1))
+                posix_handle_unset (this, stbuf.ia_gfid);
+
         op_ret = posix_lstat_with_gfid (this, parentpath, &postparent);
         if (op_ret == -1) {
                 op_errno = errno;
@@ -1174,6 +1196,9 @@ posix_rmdir (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        if (loc->inode)
+                posix_handle_unset (this, loc->inode->gfid);
+
         op_ret = posix_lstat_with_gfid (this, parentpath, &postparent);
         if (op_ret == -1) {
                 op_errno = errno;
@@ -1304,6 +1329,8 @@ posix_symlink (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        posix_handle_create (this, real_path, loc, &stbuf, 0);
+
         op_ret = posix_lstat_with_gfid (this, parentpath, &postparent);
         if (op_ret == -1) {
                 op_errno = errno;
@@ -1351,6 +1378,8 @@ posix_rename (call_frame_t *frame, xlator_t *this,
         struct iatt           postoldparent = {0, };
         struct iatt           prenewparent  = {0, };
         struct iatt           postnewparent = {0, };
+        struct iatt           victim        = {0, };
+        int                   victim_handled = 0;
         char                  olddirid[64];
         char                  newdirid[64];
 
@@ -1398,10 +1427,12 @@ posix_rename (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
-        op_ret = posix_lstat_with_gfid (this, real_newpath, &stbuf);
+        op_ret = posix_lstat_with_handle (this, real_newpath, &stbuf,
+                                          &victim_handled);
         if ((op_ret == -1) && (errno == ENOENT)){
                 was_present = 0;
         }
+        victim = stbuf;
 
         if (was_present && IA_ISDIR(stbuf.ia_type) && !newloc->inode) {
                 gf_log (this->name, GF_LOG_WARNING,
@@ -1443,6 +1474,14 @@ posix_rename (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        if (was_present && uuid_compare (victim.ia_gfid, stbuf.ia_gfid) &&
+            (IA_ISDIR (victim.ia_type) ||
+             (victim_handled && (victim.ia_nlink == 1))))
+                posix_handle_unset (this, victim.ia_gfid);
+
+        if (IA_ISDIR (stbuf.ia_type))
+                posix_handle_create (this, real_newpath, newloc, &stbuf, 1);
+
         op_ret = posix_lstat_with_gfid (this, oldparentpath, &postoldparent);
         if (op_ret == -1) {
                 op_errno = errno;
@@ -1774,6 +1813,8 @@ posix_create (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        posix_handle_create (this, real_path, loc, &stbuf, 0);
+
         op_ret = posix_lstat_with_gfid (this, parentpath, &postparent);
         if (op_ret == -1) {
                 op_errno = errno;
@@ -1945,7 +1986,7 @@ out:
 #define ALIGN_BUF(ptr,bound) ((void *)((unsigned long)(ptr + bound - 1) & \
                                        (unsigned long)(~(bound - 1))))
 
-int
+int32_t
 posix_readv (call_frame_t *frame, xlator_t *this,
              fd_t *fd, size_t size, off_t offset)
 {
@@ -1970,6 +2011,10 @@ posix_readv (call_frame_t *frame, xlator_t *this,
         priv = this->private;
         VALIDATE_OR_GOTO (priv, out);
 
+        if (priv->io_uring_capable &&
+            posix_io_uring_readv (frame, this, fd, size, offset) == 0)
+                return 0;
+
         ret = fd_ctx_get (fd, this, &tmp_pfd);
         if (ret < 0) {
                 op_errno = -ret;
@@ -2163,6 +2208,11 @@ posix_writev (call_frame_t *frame, xlator_t *this,
 
         VALIDATE_OR_GOTO (priv, out);
 
+        if (priv->io_uring_capable &&
+            posix_io_uring_writev (frame, this, fd, vector, count, offset,
+                                   iobref) == 0)
+                return 0;
+
         ret = fd_ctx_get (fd, this, &tmp_pfd);
         if (ret < 0) {
                 gf_log (this->name, GF_LOG_WARNING,
@@ -2366,6 +2416,7 @@ posix_fsync (call_frame_t *frame, xlator_t *this,
         uint64_t          tmp_pfd  = 0;
         struct iatt       preop = {0,};
         struct iatt       postop = {0,};
+        struct posix_private *priv = NULL;
 
         DECLARE_OLD_FS_ID_VAR;
 
@@ -2373,6 +2424,11 @@ posix_fsync (call_frame_t *frame, xlator_t *this,
         VALIDATE_OR_GOTO (this, out);
         VALIDATE_OR_GOTO (fd, out);
 
+        priv = this->private;
+        if (priv->io_uring_capable &&
+            posix_io_uring_fsync (frame, this, fd, datasync) == 0)
+                return 0;
+
         SET_FS_ID (frame->root->uid, frame->root->gid);
 
 #ifdef GF_DARWIN_HOST_OS
@@ -3255,6 +3311,266 @@ out:
         return 0;
 }
 
+/* Space management fops. Each one is a single fallocate(2) call on the
+ * backend file where the filesystem supports the mode; zerofill falls
+ * back to writing zeros, discard and fallocate have no such fallback.
+ */
+enum posix_space_op {
+        POSIX_SPACE_ALLOCATE,
+        POSIX_SPACE_DISCARD,
+        POSIX_SPACE_ZEROFILL,
+};
+
+/* the writes hold an io-thread for as long as they take, a larger range
+   is refused and left to the application to zero */
+#define POSIX_WRITE_ZEROS_MAX (16 * GF_UNIT_MB)
+
+static int32_t
+posix_write_zeros (xlator_t *this, int _fd, off_t offset, size_t len,
+                   int32_t keep_size, struct iatt *preop)
+{
+        struct iobuf *iobuf   = NULL;
+        size_t        bufsize = 0;
+        size_t        chunk   = 0;
+        ssize_t       ret     = 0;
+        int32_t       op_ret  = -1;
+
+        /* writing cannot allocate past EOF without moving it, and past
+           EOF there is nothing to zero */
+        if (keep_size) {
+                if (offset >= (off_t) preop->ia_size)
+                        return 0;
+                len = min (len, preop->ia_size - offset);
+        }
+
+        if (len > POSIX_WRITE_ZEROS_MAX) {
+                errno = EOPNOTSUPP;
+                goto out;
+        }
+
+        iobuf = iobuf_get (this->ctx->iobuf_pool);
+        if (!iobuf) {
+                errno = ENOMEM;
+                goto out;
+        }
+
+        bufsize = iobuf_pagesize (iobuf);
+        memset (iobuf->ptr, 0, bufsize);
+
+        while (len > 0) {
+                chunk = min (len, bufsize);
+                ret = pwrite (_fd, iobuf->ptr, chunk, offset);
+                if (ret <= 0) {
+                        if (ret == 0)
+                                errno = EIO;
+                        goto out;
+                }
+
+                offset += ret;
+                len    -= ret;
+        }
+
+        op_ret = 0;
+out:
+        if (iobuf)
+                iobuf_unref (iobuf);
+
+        return op_ret;
+}
+
+static int32_t
+posix_do_space_op (xlator_t *this, fd_t *fd, enum posix_space_op op,
+                   int32_t keep_size, off_t offset, size_t len,
+                   struct iatt *preop, struct iatt *postop)
+{
+        int32_t               op_ret  = -1;
+        int                   _fd     = -1;
+        struct posix_fd      *pfd     = NULL;
+        int                   ret     = -1;
+        uint64_t              tmp_pfd = 0;
+        int                   mode    = 0;
+        const char           *opname  = NULL;
+
+        ret = fd_ctx_get (fd, this, &tmp_pfd);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pfd is NULL, fd=%p", fd);
+                errno = -ret;
+                goto out;
+        }
+        pfd = (struct posix_fd *)(long)tmp_pfd;
+
+        _fd = pfd->fd;
+
+        op_ret = posix_fstat_with_gfid (this, _fd, preop);
+        if (op_ret == -1) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "pre-operation fstat failed on fd=%p: %s", fd,
+                        strerror (errno));
+                goto out;
+        }
+
+        switch (op) {
+        case POSIX_SPACE_ALLOCATE:
+                opname = "fallocate";
+#ifdef HAVE_FALLOCATE
+                if (keep_size)
+                        mode = FALLOC_FL_KEEP_SIZE;
+                op_ret = fallocate (_fd, mode, offset, len);
+#else
+                if (keep_size) {
+                        errno  = EOPNOTSUPP;
+                        op_ret = -1;
+                } else {
+                        op_ret = posix_fallocate (_fd, offset, len);
+                        if (op_ret != 0) {
+                                errno  = op_ret;
+                                op_ret = -1;
+                        }
+                }
+#endif
+                break;
+
+        case POSIX_SPACE_DISCARD:
+                opname = "discard";
+#if defined(HAVE_FALLOCATE) && defined(FALLOC_FL_PUNCH_HOLE)
+                mode   = FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE;
+                op_ret = fallocate (_fd, mode, offset, len);
+#else
+                errno  = EOPNOTSUPP;
+                op_ret = -1;
+#endif
+                break;
+
+        case POSIX_SPACE_ZEROFILL:
+                opname = "zerofill";
+                op_ret = -1;
+                errno  = EOPNOTSUPP;
+#if defined(HAVE_FALLOCATE) && defined(FALLOC_FL_ZERO_RANGE)
+                mode   = FALLOC_FL_ZERO_RANGE;
+                if (keep_size)
+                        mode |= FALLOC_FL_KEEP_SIZE;
+                op_ret = fallocate (_fd, mode, offset, len);
+#endif
+                /* filesystems without ZERO_RANGE get the zeros written */
+                if ((op_ret == -1) &&
+                    ((errno == EOPNOTSUPP) || (errno == ENOSYS)))
+                        op_ret = posix_write_zeros (this, _fd, offset, len,
+                                                    keep_size, preop);
+                break;
+        }
+
+        if (op_ret == -1) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "%s failed on fd=%p (offset=%"PRId64", len=%zu): %s",
+                        opname, fd, (int64_t) offset, len, strerror (errno));
+                goto out;
+        }
+
+        op_ret = posix_fstat_with_gfid (this, _fd, postop);
+        if (op_ret == -1) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "post-operation fstat failed on fd=%p: %s",
+                        fd, strerror (errno));
+                goto out;
+        }
+
+        op_ret = 0;
+out:
+        return op_ret;
+}
+
+
+/* named so as not to clash with posix_fallocate(3) */
+int32_t
+posix_glfallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                   int32_t keep_size, off_t offset, size_t len)
+{
+        int32_t               op_ret   = -1;
+        int32_t               op_errno = 0;
+        struct iatt           preop    = {0,};
+        struct iatt           postop   = {0,};
+
+        DECLARE_OLD_FS_ID_VAR;
+        SET_FS_ID (frame->root->uid, frame->root->gid);
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        op_ret = posix_do_space_op (this, fd, POSIX_SPACE_ALLOCATE, keep_size,
+                                    offset, len, &preop, &postop);
+        if (op_ret == -1)
+                op_errno = errno;
+out:
+        SET_TO_OLD_FS_ID ();
+
+        STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, &preop,
+                             &postop);
+
+        return 0;
+}
+
+
+int32_t
+posix_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+               off_t offset, size_t len)
+{
+        int32_t               op_ret   = -1;
+        int32_t               op_errno = 0;
+        struct iatt           preop    = {0,};
+        struct iatt           postop   = {0,};
+
+        DECLARE_OLD_FS_ID_VAR;
+        SET_FS_ID (frame->root->uid, frame->root->gid);
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        op_ret = posix_do_space_op (this, fd, POSIX_SPACE_DISCARD, 0,
+                                    offset, len, &preop, &postop);
+        if (op_ret == -1)
+                op_errno = errno;
+out:
+        SET_TO_OLD_FS_ID ();
+
+        STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno, &preop,
+                             &postop);
+
+        return 0;
+}
+
+
+int32_t
+posix_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                int32_t keep_size, off_t offset, size_t len)
+{
+        int32_t               op_ret   = -1;
+        int32_t               op_errno = 0;
+        struct iatt           preop    = {0,};
+        struct iatt           postop   = {0,};
+
+        DECLARE_OLD_FS_ID_VAR;
+        SET_FS_ID (frame->root->uid, frame->root->gid);
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        op_ret = posix_do_space_op (this, fd, POSIX_SPACE_ZEROFILL, keep_size,
+                                    offset, len, &preop, &postop);
+        if (op_ret == -1)
+                op_errno = errno;
+out:
+        SET_TO_OLD_FS_ID ();
+
+        STACK_UNWIND_STRICT (zerofill, frame, op_ret, op_errno, &preop,
+                             &postop);
+
+        return 0;
+}
+
 
 int32_t
 posix_fstat (call_frame_t *frame, xlator_t *this,
@@ -3637,6 +3953,36 @@ posix_priv (xlator_t *this)
         gf_proc_dump_write(key,"%d", priv->write_value);
         gf_proc_dump_build_key(key, key_prefix, "nr_files");
         gf_proc_dump_write(key,"%ld", priv->nr_files);
+        gf_proc_dump_build_key(key, key_prefix, "lookup_xattr_fills");
+        gf_proc_dump_write(key,"%"PRIu64, priv->lookup_xattr_fills);
+        gf_proc_dump_build_key(key, key_prefix, "lookup_xattr_syscalls");
+        gf_proc_dump_write(key,"%"PRIu64, priv->lookup_xattr_syscalls);
+        gf_proc_dump_build_key(key, key_prefix, "xattr_syscalls_per_lookup");
+        gf_proc_dump_write(key,"%.2f", priv->lookup_xattr_fills ?
+                           ((double) priv->lookup_xattr_syscalls /
+                            priv->lookup_xattr_fills) : 0.0);
+        gf_proc_dump_build_key(key, key_prefix, "io_uring");
+        gf_proc_dump_write(key,"%s", priv->io_uring_capable ? "on" : "off");
+        if (priv->io_uring_capable) {
+                gf_proc_dump_build_key(key, key_prefix, "io_uring_depth");
+                gf_proc_dump_write(key,"%u", priv->io_uring_depth);
+                gf_proc_dump_build_key(key, key_prefix, "io_uring_submitted");
+                gf_proc_dump_write(key,"%"PRIu64, priv->io_uring_submitted);
+                gf_proc_dump_build_key(key, key_prefix, "io_uring_completed");
+                gf_proc_dump_write(key,"%"PRIu64, priv->io_uring_completed);
+                gf_proc_dump_build_key(key, key_prefix, "io_uring_fallbacks");
+                gf_proc_dump_write(key,"%"PRIu64, priv->io_uring_fallbacks);
+        }
+        gf_proc_dump_build_key(key, key_prefix, "gfid_handles");
+        gf_proc_dump_write(key,"%s", priv->gfid_handles ? "on" : "off");
+        if (priv->gfid_handles) {
+                gf_proc_dump_build_key(key, key_prefix, "handles_created");
+                gf_proc_dump_write(key,"%"PRIu64, priv->handles_created);
+                gf_proc_dump_build_key(key, key_prefix, "nameless_lookups");
+                gf_proc_dump_write(key,"%"PRIu64, priv->nameless_lookups);
+                gf_proc_dump_build_key(key, key_prefix, "nameless_misses");
+                gf_proc_dump_write(key,"%"PRIu64, priv->nameless_misses);
+        }
 
         return 0;
 }
@@ -4050,13 +4396,36 @@ init (xlator_t *this)
                 }
         }
 #endif
+        LOCK_INIT (&_private->io_uring_lock);
+
+        GF_OPTION_INIT ("io-uring", _private->io_uring_configured, bool, out);
+        GF_OPTION_INIT ("io-uring-queue-depth", _private->io_uring_depth,
+                        uint32, out);
+        GF_OPTION_INIT ("gfid-handles", _private->gfid_handles, bool, out);
+
         this->private = (void *)_private;
 
+        if (_private->gfid_handles) {
+                ret = posix_handle_init (this);
+                if (ret) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "gfid handles unavailable, lookups by gfid "
+                                "alone will fail");
+                        _private->gfid_handles = _gf_false;
+                        ret = 0;
+                }
+        }
+
         pthread_mutex_init (&_private->janitor_lock, NULL);
         pthread_cond_init (&_private->janitor_cond, NULL);
         INIT_LIST_HEAD (&_private->janitor_fds);
 
         posix_spawn_janitor_thread (this);
+
+        if (_private->io_uring_configured) {
+                /* on failure we keep serving through the synchronous fops */
+                posix_io_uring_on (this);
+        }
 out:
         return ret;
 }
@@ -4067,6 +4436,7 @@ fini (xlator_t *this)
         struct posix_private *priv = this->private;
         if (!priv)
                 return;
+        posix_io_uring_off (this);
         this->private = NULL;
         GF_FREE (priv);
         return;
@@ -4118,6 +4488,9 @@ struct xlator_fops fops = {
         .fxattrop    = posix_fxattrop,
         .setattr     = posix_setattr,
         .fsetattr    = posix_fsetattr,
+        .fallocate   = posix_glfallocate,
+        .discard     = posix_discard,
+        .zerofill    = posix_zerofill,
 };
 
 struct xlator_cbks cbks = {
@@ -4143,5 +4516,29 @@ struct volume_options options[] = {
           .type = GF_OPTION_TYPE_INT },
         { .key  = {"volume-id"},
           .type = GF_OPTION_TYPE_ANY },
+        { .key  = {"io-uring"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Submit reads, writes and fsyncs "
+                         "through io_uring and complete them from a "
+                         "completion thread, instead of blocking the "
+                         "calling thread."
+        },
+        { .key  = {"io-uring-queue-depth"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 4096,
+          .default_value = "256",
+          .description = "Number of submission queue entries of the "
+                         "io_uring instance."
+        },
+        { .key  = {"gfid-handles"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Keep a handle for every file and directory under "
+                         ".glusterfs/, keyed by gfid, so that a lookup by "
+                         "gfid alone (nameless lookup) resolves without "
+                         "the path."
+        },
         { .key  = {NULL} }
 };
@@ -52,6 +52,34 @@
 #include "compat.h"
 #include "timer.h"
 #include "posix-mem-types.h"
+#include "posix-handle.h"
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+#undef HAVE_SET_FSID
+#ifdef HAVE_SET_FSID
+
+#define DECLARE_OLD_FS_ID_VAR uid_t old_fsuid; gid_t old_fsgid;
+
+#define SET_FS_ID(uid, gid) do {                \
+                old_fsuid = setfsuid (uid);     \
+                old_fsgid = setfsgid (gid);     \
+        } while (0)
+
+#define SET_TO_OLD_FS_ID() do {                 \
+                setfsuid (old_fsuid);           \
+                setfsgid (old_fsgid);           \
+        } while (0)
+
+#else
+
+#define DECLARE_OLD_FS_ID_VAR
+#define SET_FS_ID(uid, gid)
+#define SET_TO_OLD_FS_ID()
+
+#endif
 
 /**
  * posix_fd - internal structure common to file and directory fd's
@@ -88,6 +116,8 @@ struct posix_private {
 	int64_t read_value;    /* Total read, from init */
 	int64_t write_value;   /* Total write, from init */
         int64_t nr_files;
+        uint64_t lookup_xattr_fills;     /* lookups that fetched xattrs */
+        uint64_t lookup_xattr_syscalls;  /* xattr syscalls they issued */
 /*
    In some cases, two exported volumes may reside on the same
    partition on the server. Sending statvfs info for both
@@ -114,6 +144,36 @@ struct posix_private {
         pthread_t       janitor;
         gf_boolean_t    janitor_present;
         char *          trash_path;
+
+/*
+   io_uring engine: readv, writev and fsync are submitted to a
+   ring and unwound from a completion thread instead of blocking the
+   caller. Falls back to the synchronous fops when the ring cannot be set
+   up (old kernel, no liburing at build time). The xattr fops are not
+   offloaded, they stay on the synchronous path.
+*/
+        gf_boolean_t    io_uring_configured;
+        gf_boolean_t    io_uring_capable;
+        uint32_t        io_uring_depth;
+        gf_lock_t       io_uring_lock;   /* serializes sqe submission */
+        uint64_t        io_uring_submitted;
+        uint64_t        io_uring_completed;
+        uint64_t        io_uring_fallbacks;
+        gf_boolean_t    io_uring_statx;  /* post-op stat through the ring */
+#ifdef HAVE_LIBURING
+        struct io_uring ring;
+        pthread_t       io_uring_thread;
+#endif
+
+/*
+   gfid handles under .glusterfs, they let a lookup by gfid alone
+   (nameless lookup) reach the object without knowing its path. The
+   handle's hardlink is left out of the ia_nlink we return.
+*/
+        gf_boolean_t    gfid_handles;
+        uint64_t        handles_created;
+        uint64_t        nameless_lookups;
+        uint64_t        nameless_misses;
 };
 
 #define POSIX_BASE_PATH(this) (((struct posix_private *)this->private)->base_path)
@@ -121,9 +181,12 @@ struct posix_private {
 #define POSIX_BASE_PATH_LEN(this) (((struct posix_private *)this->private)->base_path_length)
 
 #define MAKE_REAL_PATH(var, this, path) do {                            \
-		var = alloca (strlen (path) + POSIX_BASE_PATH_LEN(this) + 2); \
-                strcpy (var, POSIX_BASE_PATH(this));			\
-                strcpy (&var[POSIX_BASE_PATH_LEN(this)], path);		\
+		var = alloca (strlen (path) + POSIX_BASE_PATH_LEN(this) + \
+                              POSIX_HANDLE_PATH_EXTRA);                 \
+                if (posix_handle_real_path (this, path, var) != 0) {    \
+                        strcpy (var, POSIX_BASE_PATH(this));            \
+                        strcpy (&var[POSIX_BASE_PATH_LEN(this)], path); \
+                }                                                       \
         } while (0)
 
 
@@ -131,7 +194,11 @@ struct posix_private {
 int setgid_override (xlator_t *this, char *real_path, gid_t *gid);
 int posix_gfid_set (xlator_t *this, const char *path, dict_t *xattr_req);
 int posix_fstat_with_gfid (xlator_t *this, int fd, struct iatt *stbuf_p);
+int posix_fill_gfid_fd (xlator_t *this, int fd, struct iatt *iatt);
+void posix_fill_ino_from_gfid (xlator_t *this, struct iatt *buf);
 int posix_lstat_with_gfid (xlator_t *this, const char *path, struct iatt *buf);
+int posix_lstat_with_handle (xlator_t *this, const char *path,
+                             struct iatt *buf, int *handled);
 dict_t *posix_lookup_xattr_fill (xlator_t *this, const char *path,
                                  loc_t *loc, dict_t *xattr, struct iatt *buf);
 int posix_handle_pair (xlator_t *this, const char *real_path,
@@ -147,5 +214,9 @@ int posix_gfid_heal (xlator_t *this, const char *path, dict_t *xattr_req);
 int posix_entry_create_xattr_set (xlator_t *this, const char *path,
                                   dict_t *dict);
 
+/* also finishes the short writes of the io_uring engine */
+int32_t __posix_pwritev (int fd, struct iovec *vector, int count,
+                         off_t offset);
+
 
 #endif /* _POSIX_H */